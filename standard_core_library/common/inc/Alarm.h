@@ -30,6 +30,10 @@
 
 #include <Thread.h>
 #include <LSFSemaphore.h>
+#include <Mutex.h>
+#include <Reactor.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <signal.h>
 
 #include <alljoyn/Status.h>
@@ -55,47 +59,60 @@ class AlarmListener {
 
 /**
  * Class used to implement an Alarm that is
- * capable of handling time in seconds.
+ * capable of handling time in milliseconds. \n
+ * The alarm is a timerfd of a Reactor, the shared one by default, and the
+ * listener is called on a thread of the reactor, so that idle alarms do not
+ * hold a thread each.
  */
-class Alarm : public Thread {
+class Alarm : public ReactorHandler {
   public:
 
     /**
      * Contructor that accepts an alarmListener
+     *
+     * @param alarmListener The listener
+     * @param reactor       The reactor that calls the listener
      */
-    Alarm(AlarmListener* alarmListener);
+    Alarm(AlarmListener* alarmListener, Reactor& reactor = Reactor::GetShared());
 
     /**
-     * Destructor
+     * Destructor. Stops the Alarm
      */
     ~Alarm();
 
     /**
      * Set an Alarm
      *
-     * @param timeInSecs Alarm time in seconds
+     * @param timeInSecs Alarm time in seconds. 0 cancels the alarm
      */
     void SetAlarm(uint8_t timeInSecs);
 
     /**
-     * Start the Alarm thread
+     * Set an Alarm
+     *
+     * @param timeInMs Alarm time in milliseconds. 0 cancels the alarm
      */
-    void Run(void);
+    void SetAlarmInMs(uint32_t timeInMs);
 
     /**
-     * Stop the Alarm thread
+     * Stop the Alarm. It cannot be set again
      */
     void Stop(void);
 
     /**
-     * Join the Alarm thread
+     * Wait until the listener is not being called, after Stop
      */
     void Join(void);
 
+    /**
+     * Invoked by the reactor when the timer expires
+     */
+    virtual void HandleEvents(uint32_t events);
+
   private:
 
     /*
-     * Indicates if the Alarm thread is running
+     * Indicates if the Alarm may be set
      */
     volatile sig_atomic_t isRunning;
 
@@ -105,19 +122,19 @@ class Alarm : public Thread {
     AlarmListener* alarmListener;
 
     /*
-     * Internal variable used to track progress in time
+     * Protects deadline
      */
-    volatile sig_atomic_t progressInTime;
+    Mutex alarmMutex;
 
     /*
-     * Internal holder of the Alarm time
+     * Time in milliseconds on the monotonic clock at which the alarm
+     * fires. 0 if the alarm is not set
      */
-    volatile sig_atomic_t timeToTrack;
+    uint64_t deadline;
 
-    /*
-     * Indicates if the Alarm time is reset
-     */
-    volatile sig_atomic_t alarmReset;
+    Reactor& reactor;
+
+    ReactorTimer timer;
 };
 
 }
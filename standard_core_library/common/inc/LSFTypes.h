@@ -105,6 +105,28 @@ extern const char* ControllerServiceSceneInterfaceName;
  */
 extern const char* ControllerServiceMasterSceneInterfaceName;
 
+/**
+ * Controller Service Diagnostics Interface Name
+ */
+extern const char* ControllerServiceDiagnosticsInterfaceName;
+
+/**
+ * Name of the error a follower replies with to a method call that only the leader
+ * can serve. The error message is the bus name of the current leader, if known
+ */
+extern const char* ControllerServiceNotLeaderErrorName;
+
+/**
+ * Name of the error the Controller Service replies with to a method call when
+ * too many calls of the same kind are already waiting to be served
+ */
+extern const char* ControllerServiceBusyErrorName;
+
+/**
+ * Staleness reported by a read replica whose stores are not synchronized with a leader
+ */
+extern const uint32_t ReadReplicaUnsynchronized;
+
 /**
  * Controller Service Session Port
  */
@@ -140,6 +162,11 @@ extern const uint32_t ControllerServiceSceneInterfaceVersion;
  */
 extern const uint32_t ControllerServiceMasterSceneInterfaceVersion;
 
+/**
+ * Controller Service Diagnostics Interface Version
+ */
+extern const uint32_t ControllerServiceDiagnosticsInterfaceVersion;
+
 /**
  * Controller Service Leader Election And State Sync Interface Version
  */
@@ -160,6 +187,13 @@ extern const char* LampServiceInterfaceName;
  */
 extern const char* LampServiceStateInterfaceName;
 
+/**
+ * Lamp Service Packed State Interface Name. \n
+ * Lamps that implement it accept and return the Lamp State as a
+ * LAMP_STATE_PACKED_SIGNATURE struct instead of an a{sv} dictionary
+ */
+extern const char* LampServicePackedStateInterfaceName;
+
 /**
  * Lamp Service Parameters Interface Name
  */
@@ -240,6 +274,11 @@ extern const char* ApplySceneEventActionObjectPath;
  */
 uint64_t GetTimestampInMs(void);
 
+/**
+ * Returns the current system timestamp in us
+ */
+uint64_t GetTimestampInUs(void);
+
 /**
  * Returns the current system timestamp in seconds
  */
@@ -285,6 +324,100 @@ void CreateUniqueList(LSFStringList& uniqueList, ajn::MsgArg* idsArray, size_t i
  */
 char* strdupnew(const char* str);
 
+/**
+ * Marshal a list of strings into an as MsgArg. \n
+ * The MsgArg references the strings of the list, so the list must outlive it.
+ * Lists of up to STRING_LIST_ARG_STACK_LEN strings need no temporary array on the heap
+ *
+ * @param strings List of strings
+ * @param arg     MsgArg to populate
+ *
+ * @return None
+ */
+void CreateStringListArg(const LSFStringList& strings, ajn::MsgArg& arg);
+
+/**
+ * Number of strings that CreateStringListArg marshals from the stack
+ */
+#define STRING_LIST_ARG_STACK_LEN 64
+
+/**
+ * Signature of the packed Lamp State: a mask of the LAMP_STATE_PACKED_*
+ * fields that carry a value, followed by OnOff, Hue, Saturation, ColorTemp
+ * and Brightness. Fields absent from the mask are marshalled as zero
+ */
+#define LAMP_STATE_PACKED_SIGNATURE "(ybuuuu)"
+
+/**
+ * OnOff is present in the packed Lamp State
+ */
+#define LAMP_STATE_PACKED_ON_OFF      0x01
+
+/**
+ * Hue is present in the packed Lamp State
+ */
+#define LAMP_STATE_PACKED_HUE         0x02
+
+/**
+ * Saturation is present in the packed Lamp State
+ */
+#define LAMP_STATE_PACKED_SATURATION  0x04
+
+/**
+ * Color Temperature is present in the packed Lamp State
+ */
+#define LAMP_STATE_PACKED_COLOR_TEMP  0x08
+
+/**
+ * Brightness is present in the packed Lamp State
+ */
+#define LAMP_STATE_PACKED_BRIGHTNESS  0x10
+
+/**
+ * All the fields are present in the packed Lamp State
+ */
+#define LAMP_STATE_PACKED_ALL_FIELDS  0x1F
+
+/**
+ * Convert a Lamp State dictionary, which may hold only some of the fields,
+ * into its packed form
+ *
+ * @param dict   MsgArg holding an a{sv} dictionary
+ * @param packed MsgArg to populate with a LAMP_STATE_PACKED_SIGNATURE struct
+ *
+ * @return ER_OK if the dictionary only holds known Lamp State fields
+ */
+QStatus CreatePackedLampStateArg(const ajn::MsgArg& dict, ajn::MsgArg& packed);
+
+/**
+ * Storage of the MsgArgs of a marshalled Lamp State. \n
+ * The dictionary layout is built once by the constructor and LampState::Get
+ * only writes the values into it, so that marshalling a Lamp State does not
+ * allocate the entries of the dictionary. The storage must outlive the MsgArg
+ * it was used for, and can be reused for the next Lamp State once that MsgArg
+ * has been sent
+ */
+class LampStateMsgArgs {
+  public:
+    /**
+     * Constructor
+     */
+    LampStateMsgArgs();
+
+  private:
+    friend class LampState;
+
+    static const size_t NUM_FIELDS = 5;
+
+    LampStateMsgArgs(const LampStateMsgArgs&);
+    LampStateMsgArgs& operator=(const LampStateMsgArgs&);
+
+    ajn::MsgArg keys[NUM_FIELDS];
+    ajn::MsgArg values[NUM_FIELDS];
+    ajn::MsgArg variants[NUM_FIELDS];
+    ajn::MsgArg entries[NUM_FIELDS];
+};
+
 /**
  * Class defining the Lamp State \n
  * Lamp State is the state information that the Lamp persists through power cycle that includes End-User set state attributes such as Hue, Saturation, Color Temperature, and Brightness.
@@ -351,6 +484,29 @@ class LampState {
      */
     void Get(ajn::MsgArg* arg, bool ownership = false) const;
 
+    /**
+     * Get the Lamp State as a MsgArg, without allocating the dictionary
+     *
+     * @param arg*       Msgarg holding a dictionary. It references storage
+     * @param storage    Storage of the entries of the dictionary
+     */
+    void Get(ajn::MsgArg* arg, LampStateMsgArgs& storage) const;
+
+    /**
+     * Set the Lamp State from its packed form. \n
+     * A packed state with an empty field mask is a NULL state
+     *
+     * @param arg Msgarg holding a LAMP_STATE_PACKED_SIGNATURE struct
+     */
+    void SetPacked(const ajn::MsgArg& arg);
+
+    /**
+     * Get the Lamp State in its packed form
+     *
+     * @param arg*       Msgarg holding a LAMP_STATE_PACKED_SIGNATURE struct
+     */
+    void GetPacked(ajn::MsgArg* arg) const;
+
     /**
      * ON/OFF
      */
@@ -392,6 +548,35 @@ class LampState {
  */
 typedef std::map<LSFString, std::pair<LSFString, LampState> > PresetMap;
 
+/**
+ * Typedef for LampStateMap type. \n
+ * The key of the map is the lamp id. \n
+ * The value of the map is the current state of the lamp
+ */
+typedef std::map<LSFString, LampState> LampStateMap;
+
+/**
+ * Marshal a LampStateMap into an a{sa{sv}} MsgArg. \n
+ * The string keys of the MsgArg reference the keys of the map, so the map
+ * must outlive the MsgArg or the MsgArg must be stabilized
+ *
+ * @param lampStates Map of lamp id to lamp state
+ * @param arg        MsgArg to populate
+ *
+ * @return None
+ */
+void CreateLampStateMapArg(const LampStateMap& lampStates, ajn::MsgArg& arg);
+
+/**
+ * Unmarshal an a{sa{sv}} MsgArg into a LampStateMap
+ *
+ * @param lampStates Container to return the lamp states in
+ * @param arg        MsgArg to parse
+ *
+ * @return None
+ */
+void CreateLampStateMap(LampStateMap& lampStates, const ajn::MsgArg& arg);
+
 /**
  * Class defining the Lamp Parameters \n
  * Lamp parameters are read-only volatile parameters that are read from the Lamp hardware. This consists of parameters like Lamp Output and Power Draw.
@@ -27,9 +27,53 @@
  */
 #include <pthread.h>
 #include <errno.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
 #include <alljoyn/Status.h>
 
 namespace lsf {
+
+/**
+ * Contention of a named mutex, as recorded by the LockProfiler
+ */
+typedef struct _LockStats {
+    std::string name;           /**< Name of the mutex */
+    uint32_t acquisitions;      /**< Times the mutex was locked, not counting the recursive locks */
+    uint32_t contended;         /**< Times the mutex was held by another thread when it was locked */
+    uint64_t totalWaitTime;     /**< Time spent waiting for the mutex, in us */
+    uint64_t maxWaitTime;       /**< Longest wait for the mutex, in us */
+    uint64_t maxHoldTime;       /**< Longest time the mutex was held, in us */
+} LockStats;
+
+/**
+ * Records the contention of the named mutexes. \n
+ * The profiler is compiled in only when LSF_LOCK_PROFILING is defined, and is
+ * then off until Enable is called. Without LSF_LOCK_PROFILING, Mutex is a
+ * plain pthread mutex and GetStats returns no locks. \n
+ * The time a mutex is released by pthread_cond_wait is not seen by the
+ * profiler, so a hold that spans a wait on a condition is not recorded.
+ */
+class LockProfiler {
+  public:
+    /**
+     * Turn profiling on or off. Does nothing without LSF_LOCK_PROFILING
+     */
+    static void Enable(bool enable);
+    /**
+     * Is profiling on
+     */
+    static bool IsEnabled(void);
+    /**
+     * Get the stats of the named mutexes that exist, the longest total wait first. \n
+     * The stats are read without locking the mutexes, so they may be slightly behind
+     */
+    static void GetStats(std::vector<LockStats>& stats);
+    /**
+     * Get the stats as text, one "lock.<name>.<stat> value" line per stat
+     */
+    static std::string GetStatsText(void);
+};
 /**
  * a wrapper class to mutex. \n
  * Use a mutex when thread wants to execute code that should not be executed by any other thread at the same time. \n
@@ -39,8 +83,10 @@ class Mutex {
   public:
     /**
      * Mutex constructor
+     * @param name  Name under which the LockProfiler reports the mutex. Must outlive
+     *              the mutex. NULL for a mutex that is not profiled
      */
-    Mutex();
+    Mutex(const char* name = NULL);
     /**
      * Mutex destructor
      */
@@ -62,6 +108,35 @@ class Mutex {
 
     pthread_mutex_t mutex;
 
+#ifdef LSF_LOCK_PROFILING
+    /*
+     * A copy would corrupt the list of the named mutexes
+     */
+    Mutex(const Mutex&);
+    Mutex& operator=(const Mutex&);
+
+    friend class LockProfiler;
+
+    QStatus ProfiledLock(void);
+
+    void ProfiledUnlock(void);
+
+    const char* name;
+    Mutex* prev;
+    Mutex* next;
+
+    /*
+     * Written while the mutex is held
+     */
+    pthread_t owner;
+    uint32_t depth;
+    uint64_t holdStart;
+    uint32_t acquisitions;
+    uint32_t contended;
+    uint64_t totalWaitTime;
+    uint64_t maxWaitTime;
+    uint64_t maxHoldTime;
+#endif
 };
 
 }
@@ -0,0 +1,211 @@
+#ifndef _REACTOR_H_
+#define _REACTOR_H_
+/**
+ * \ingroup Common
+ */
+/**
+ * \file  common/inc/Reactor.h
+ * This file provides definitions for the event loop shared by the subsystems
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <Thread.h>
+#include <Mutex.h>
+
+#include <pthread.h>
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <vector>
+
+#include <alljoyn/Status.h>
+
+/**
+ * Number of threads of the shared reactor
+ */
+#ifndef LSF_REACTOR_THREADS
+#define LSF_REACTOR_THREADS 2
+#endif
+
+namespace lsf {
+
+class Reactor;
+
+/**
+ * A subsystem that runs on a Reactor. \n
+ * Its events are bits of a mask that the subsystem defines. Posting an event
+ * that is already pending does nothing, and the handler receives all the
+ * events posted since its last run at once. A handler never runs on two
+ * threads at the same time.
+ */
+class ReactorHandler {
+  public:
+    /**
+     * class constructor
+     */
+    ReactorHandler() : pendingEvents(0), queued(false), running(false) { }
+    /**
+     * Virtual destructor for derivable class
+     */
+    virtual ~ReactorHandler() { }
+    /**
+     * Invoked on a thread of the reactor
+     * @param events    The events posted since the last run
+     */
+    virtual void HandleEvents(uint32_t events) = 0;
+
+  private:
+
+    friend class Reactor;
+
+    /*
+     * Protected by the lock of the reactor
+     */
+    uint32_t pendingEvents;
+    bool queued;
+    bool running;
+    pthread_t runner;
+};
+
+/**
+ * Posts an event to a handler when it expires. One-shot
+ */
+class ReactorTimer {
+  public:
+    /**
+     * class constructor
+     * @param reactor   The reactor that runs the handler
+     * @param handler   The handler
+     * @param event     The event posted on expiry
+     */
+    ReactorTimer(Reactor& reactor, ReactorHandler* handler, uint32_t event);
+    /**
+     * class destructor
+     */
+    ~ReactorTimer();
+    /**
+     * Arm the timer
+     * @param timeInMs  Time to expiry in ms. 0 disarms the timer
+     */
+    void SetInMs(uint32_t timeInMs);
+
+  private:
+
+    ReactorTimer(const ReactorTimer&);
+    ReactorTimer& operator=(const ReactorTimer&);
+
+    friend class Reactor;
+
+    Reactor& reactor;
+    ReactorHandler* handler;
+    uint32_t event;
+    int timerFd;
+    uint64_t id;
+};
+
+/**
+ * Runs the handlers of the subsystems on a few threads. \n
+ * The threads wait in epoll for an eventfd, written when a handler has events
+ * to run, and for the timerfds of the timers, so that an idle reactor does
+ * not wake up.
+ */
+class Reactor {
+  public:
+    /**
+     * class constructor
+     * @param numThreads    Number of threads that run the handlers
+     */
+    Reactor(uint32_t numThreads);
+    /**
+     * class destructor. Stops and joins the threads
+     */
+    ~Reactor();
+    /**
+     * Start the threads
+     */
+    QStatus Start(void);
+    /**
+     * Stop the threads. The events that are still pending are not handled
+     */
+    void Stop(void);
+    /**
+     * Join the threads after Stop
+     */
+    void Join(void);
+    /**
+     * Post events to a handler
+     * @param handler   The handler
+     * @param events    Mask of the events
+     */
+    void Post(ReactorHandler* handler, uint32_t events);
+    /**
+     * Drop the events that are pending for a handler
+     */
+    void Cancel(ReactorHandler* handler);
+    /**
+     * Wait until a handler is not running. Returns at once when called by the handler
+     */
+    void WaitIdle(ReactorHandler* handler);
+    /**
+     * Get the reactor shared by the subsystems of the process. Started on first use
+     */
+    static Reactor& GetShared(void);
+
+  private:
+
+    Reactor(const Reactor&);
+    Reactor& operator=(const Reactor&);
+
+    friend class ReactorTimer;
+
+    class ReactorThread : public Thread {
+      public:
+        ReactorThread(Reactor& reactor) : Thread("Reactor"), reactor(reactor) { }
+        virtual void Run() { reactor.RunThread(); }
+        virtual void Stop() { }
+      private:
+        Reactor& reactor;
+    };
+
+    void RunThread(void);
+
+    /*
+     * Must be called with lock held
+     */
+    void Queue(ReactorHandler* handler, uint32_t events);
+
+    void Wake(void);
+
+    uint64_t AddTimer(ReactorTimer* timer);
+
+    void RemoveTimer(ReactorTimer* timer);
+
+    Mutex lock;
+    pthread_cond_t idleCondition;
+    int epollFd;
+    int eventFd;
+    bool running;
+    uint32_t numThreads;
+    std::list<ReactorHandler*> readyHandlers;
+    std::map<uint64_t, ReactorTimer*> timers;
+    uint64_t nextTimerId;
+    std::vector<ReactorThread*> threads;
+};
+
+}
+
+#endif
@@ -26,19 +26,49 @@
  * \ingroup Common
  */
 #include <pthread.h>
+#include <sys/types.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
 
 #include <alljoyn/Status.h>
 
+/**
+ * Maximum length of the name of a thread, including the terminating NUL. The
+ * limit of pthread_setname_np
+ */
+#define LSF_THREAD_NAME_LEN 16
+
 namespace lsf {
+
+/**
+ * CPU time and wakeups of a running thread
+ */
+typedef struct _ThreadStats {
+    std::string name;               /**< Name of the thread */
+    uint32_t tid;                   /**< Kernel ID of the thread, as shown by top -H */
+    uint64_t cpuTime;               /**< CPU time used since the thread started, in us */
+    uint32_t wakeups;               /**< Times the thread returned from waiting for work */
+    uint32_t usefulWakeups;         /**< Wakeups that found work to do */
+    uint32_t voluntarySwitches;     /**< Times the thread blocked, from the kernel. 0 if unknown */
+    uint32_t involuntarySwitches;   /**< Times the thread was preempted, from the kernel. 0 if unknown */
+} ThreadStats;
+
 /**
- * abstraction class to thread
+ * abstraction class to thread \n
+ * The thread is named, so that it can be told apart in top and in the
+ * debugger, and may be bound to some CPUs and given a nice value. The running
+ * threads account for their CPU time and for their wakeups, which the loops
+ * report with RecordWakeup. A wakeup that finds no work is wasted, which is
+ * what to look for on the boxes that run on batteries.
  */
 class Thread {
   public:
     /**
      * class constructor
+     * @param name  Name of the thread. Truncated to LSF_THREAD_NAME_LEN - 1 characters
      */
-    Thread();
+    Thread(const char* name = "lsf");
     /**
      * class destructor
      */
@@ -61,12 +91,64 @@ class Thread {
      * Join running thread until it exits
      */
     void Join();
+    /**
+     * Change the name of the thread. Takes effect on the next Start
+     * @param name  Name of the thread. Truncated to LSF_THREAD_NAME_LEN - 1 characters
+     */
+    void SetName(const char* name);
+    /**
+     * Bind the thread to some CPUs. Takes effect on the next Start
+     * @param cpuMask   Bit n set for CPU n. 0 for the default of SetDefaultAffinity
+     */
+    void SetAffinity(uint32_t cpuMask);
+    /**
+     * Set the nice value of the thread. Takes effect on the next Start. \n
+     * A value below the nice value of the process needs CAP_SYS_NICE
+     * @param niceValue From -20, the highest priority, to 19
+     */
+    void SetPriority(int niceValue);
+    /**
+     * Bind the threads that have no affinity of their own to some CPUs.
+     * Takes effect on the threads started afterwards
+     * @param cpuMask   Bit n set for CPU n. 0 for any CPU
+     */
+    static void SetDefaultAffinity(uint32_t cpuMask);
+    /**
+     * Count a wakeup of the calling thread. Does nothing if the calling thread
+     * is not a Thread
+     * @param useful    true if the thread found work to do
+     */
+    static void RecordWakeup(bool useful);
+    /**
+     * Get the stats of the threads that are running, in the order they started
+     */
+    static void GetStats(std::vector<ThreadStats>& stats);
+    /**
+     * Get the stats as text, one "thread.<name>.<tid>.<stat> value" line per stat
+     */
+    static std::string GetStatsText(void);
 
   private:
 
     static void* RunThread(void* data);
 
+    void ApplySchedule(void);
+
     pthread_t thread;
+    char name[LSF_THREAD_NAME_LEN];
+    uint32_t cpuMask;
+    int niceValue;
+    bool hasPriority;
+
+    /*
+     * Set by the thread while it runs. The list of the running threads is
+     * protected by a lock of its own
+     */
+    pid_t tid;
+    volatile uint32_t wakeups;
+    volatile uint32_t usefulWakeups;
+    Thread* prev;
+    Thread* next;
 };
 
 }
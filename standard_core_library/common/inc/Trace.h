@@ -0,0 +1,180 @@
+#ifndef _TRACE_H_
+#define _TRACE_H_
+/**
+ * \ingroup Common
+ */
+/**
+ * \file  common/inc/Trace.h
+ * This file provides definitions for the tracing of requests across threads
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <alljoyn/Status.h>
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * Number of spans kept by the trace buffer. Must be a power of two
+ */
+#define LSF_TRACE_BUFFER_SIZE 4096
+
+/**
+ * Maximum length of the name of a span, including the terminating NUL
+ */
+#define LSF_TRACE_NAME_LEN 64
+
+namespace lsf {
+
+/**
+ * A span recorded by the Tracer
+ */
+typedef struct _TraceEvent {
+    uint32_t traceId;               /**< Request the span belongs to. 0 if it belongs to none */
+    uint32_t threadId;              /**< Thread that recorded the span, numbered from 1 in the order the threads first recorded */
+    uint64_t start;                 /**< Start of the span, in us */
+    uint64_t duration;              /**< Duration of the span, in us */
+    uint32_t arg;                   /**< A number that qualifies the span, e.g. the lamps it covers */
+    char name[LSF_TRACE_NAME_LEN];  /**< Name of the span */
+} TraceEvent;
+
+/**
+ * Records the spans of the requests in a fixed-size ring buffer. \n
+ * A request gets a trace ID when it is received. The ID is the current trace
+ * of the thread that handles the request and is copied into the queued
+ * calls, so that the spans that the other threads record on its behalf carry
+ * it too. Recording does not take a lock: when the buffer is full, the oldest
+ * spans are overwritten. \n
+ * Tracing is off until Enable is called; when it is off, the spans cost a
+ * test of a flag.
+ */
+class Tracer {
+  public:
+    /**
+     * Turn tracing on or off
+     */
+    static void Enable(bool enable);
+    /**
+     * Is tracing on
+     */
+    static bool IsEnabled(void);
+    /**
+     * Get a trace ID for a new request
+     * @return 0 if tracing is off
+     */
+    static uint32_t StartTrace(void);
+    /**
+     * Get the trace of the request that the calling thread is handling
+     * @return 0 if there is none
+     */
+    static uint32_t GetCurrentTraceId(void);
+    /**
+     * Get the time the request that the calling thread is handling was received, in us
+     * @return 0 if there is none
+     */
+    static uint64_t GetCurrentTraceStart(void);
+    /**
+     * Record a span
+     * @param traceId   Request the span belongs to
+     * @param name      Name of the span. Copied, and truncated to LSF_TRACE_NAME_LEN - 1 characters
+     * @param start     Start of the span, from GetTimestampInUs
+     * @param end       End of the span, from GetTimestampInUs
+     * @param arg       A number that qualifies the span
+     */
+    static void Record(uint32_t traceId, const char* name, uint64_t start, uint64_t end, uint32_t arg = 0);
+    /**
+     * Get the spans in the buffer, oldest first
+     */
+    static void GetEvents(std::vector<TraceEvent>& events);
+    /**
+     * Get the spans in the buffer in the JSON format of the Chrome trace viewer
+     */
+    static void GetChromeTrace(std::string& json);
+    /**
+     * Write the spans in the buffer to a file in the JSON format of the Chrome trace viewer
+     * @param filePath  Path of the file
+     */
+    static QStatus WriteChromeTrace(const std::string& filePath);
+    /**
+     * Drop the spans in the buffer
+     */
+    static void Clear(void);
+
+  private:
+
+    friend class TraceContext;
+
+    static void SetCurrentTrace(uint32_t traceId, uint64_t traceStart);
+};
+
+/**
+ * Makes a request the current trace of the calling thread for the lifetime
+ * of the object, e.g. while a worker runs a queued call
+ */
+class TraceContext {
+  public:
+    /**
+     * class constructor
+     * @param traceId       The request
+     * @param traceStart    Time the request was received, in us. 0 for now
+     */
+    TraceContext(uint32_t traceId, uint64_t traceStart = 0);
+    /**
+     * class destructor. Restores the previous trace of the thread
+     */
+    ~TraceContext();
+
+  private:
+
+    TraceContext(const TraceContext&);
+    TraceContext& operator=(const TraceContext&);
+
+    uint32_t previousTraceId;
+    uint64_t previousTraceStart;
+};
+
+/**
+ * Records a span of the current trace of the calling thread from its
+ * construction to its destruction
+ */
+class TraceSpan {
+  public:
+    /**
+     * class constructor
+     * @param name  Name of the span. Must outlive the span
+     * @param arg   A number that qualifies the span
+     */
+    TraceSpan(const char* name, uint32_t arg = 0);
+    /**
+     * class destructor
+     */
+    ~TraceSpan();
+
+  private:
+
+    TraceSpan(const TraceSpan&);
+    TraceSpan& operator=(const TraceSpan&);
+
+    const char* name;
+    uint32_t arg;
+    uint64_t start;
+};
+
+}
+
+#endif
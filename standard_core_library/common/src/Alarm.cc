@@ -17,67 +17,86 @@
 #include <Alarm.h>
 #include <qcc/Debug.h>
 
+#include <time.h>
+
 using namespace lsf;
 
 #define QCC_MODULE "LSF_ALARM"
 
-Alarm::Alarm(AlarmListener* alarmListener) :
+static uint64_t GetMonotonicTimeInMs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (static_cast<uint64_t>(now.tv_sec) * 1000) + (now.tv_nsec / 1000000);
+}
+
+/*
+ * The only event of an Alarm
+ */
+#define ALARM_EVENT_EXPIRED 0x1
+
+Alarm::Alarm(AlarmListener* alarmListener, Reactor& reactor) :
     isRunning(true),
     alarmListener(alarmListener),
-    progressInTime(0),
-    timeToTrack(0),
-    alarmReset(false)
+    deadline(0),
+    reactor(reactor),
+    timer(reactor, this, ALARM_EVENT_EXPIRED)
 {
     QCC_DbgPrintf(("%s", __func__));
-    Thread::Start();
 }
 
 Alarm::~Alarm()
 {
     QCC_DbgPrintf(("%s", __func__));
+    Stop();
+    Join();
 }
 
-void Alarm::Run()
+void Alarm::HandleEvents(uint32_t events)
 {
-    QCC_DbgPrintf(("%s", __func__));
-
-    while (isRunning) {
-        QCC_DbgPrintf(("%s", __func__));
-        usleep(1000000);
-        if (alarmReset) {
-            QCC_DbgPrintf(("%s: Alarm Reloaded", __func__));
-            progressInTime = 0;
-            alarmReset = false;
-        } else {
-            if (timeToTrack) {
-                progressInTime++;
-                if (progressInTime == timeToTrack) {
-                    QCC_DbgPrintf(("%s: Calling AlarmTriggered", __func__));
-                    progressInTime = 0;
-                    timeToTrack = 0;
-                    alarmListener->AlarmTriggered();
-                }
-            }
-        }
+    alarmMutex.Lock();
+    /*
+     * The timer may have expired just before it was reset or cancelled
+     */
+    if (!isRunning || (deadline == 0) || (GetMonotonicTimeInMs() < deadline)) {
+        alarmMutex.Unlock();
+        return;
     }
+    deadline = 0;
+    alarmMutex.Unlock();
+
+    QCC_DbgPrintf(("%s: Calling AlarmTriggered", __func__));
+    alarmListener->AlarmTriggered();
 }
 
 void Alarm::Join()
 {
     QCC_DbgPrintf(("%s", __func__));
-    Thread::Join();
+    reactor.WaitIdle(this);
 }
 
 void Alarm::Stop()
 {
+    alarmMutex.Lock();
     isRunning = false;
-    progressInTime = 0;
-    timeToTrack = 0;
-    alarmReset = false;
+    deadline = 0;
+    timer.SetInMs(0);
+    alarmMutex.Unlock();
+    reactor.Cancel(this);
 }
 
 void Alarm::SetAlarm(uint8_t timeInSecs)
 {
-    timeToTrack = timeInSecs;
-    alarmReset = true;
+    SetAlarmInMs(static_cast<uint32_t>(timeInSecs) * 1000);
+}
+
+void Alarm::SetAlarmInMs(uint32_t timeInMs)
+{
+    alarmMutex.Lock();
+    QCC_DbgPrintf(("%s: Alarm Reloaded with %u ms", __func__, timeInMs));
+    if (isRunning) {
+        deadline = (timeInMs) ? (GetMonotonicTimeInMs() + timeInMs) : 0;
+        timer.SetInMs(timeInMs);
+    }
+    alarmMutex.Unlock();
 }
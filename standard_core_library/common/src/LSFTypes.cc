@@ -44,19 +44,25 @@ const char* ControllerServiceLampGroupInterfaceName = "org.allseen.LSF.Controlle
 const char* ControllerServicePresetInterfaceName = "org.allseen.LSF.ControllerService.Preset";
 const char* ControllerServiceSceneInterfaceName = "org.allseen.LSF.ControllerService.Scene";
 const char* ControllerServiceMasterSceneInterfaceName = "org.allseen.LSF.ControllerService.MasterScene";
+const char* ControllerServiceDiagnosticsInterfaceName = "org.allseen.LSF.ControllerService.Diagnostics";
+const char* ControllerServiceNotLeaderErrorName = "org.allseen.LSF.ControllerService.Error.NotLeader";
+const char* ControllerServiceBusyErrorName = "org.allseen.LSF.ControllerService.Error.Busy";
+const uint32_t ReadReplicaUnsynchronized = 0xFFFFFFFF;
 ajn::SessionPort ControllerServiceSessionPort = 43;
 
-const uint32_t ControllerServiceInterfaceVersion = 1;
-const uint32_t ControllerServiceLampInterfaceVersion = 1;
-const uint32_t ControllerServiceLampGroupInterfaceVersion = 1;
-const uint32_t ControllerServicePresetInterfaceVersion = 1;
-const uint32_t ControllerServiceSceneInterfaceVersion = 1;
-const uint32_t ControllerServiceMasterSceneInterfaceVersion = 1;
-const uint32_t LeaderElectionAndStateSyncInterfaceVersion = 1;
+const uint32_t ControllerServiceInterfaceVersion = 2;
+const uint32_t ControllerServiceLampInterfaceVersion = 3;
+const uint32_t ControllerServiceLampGroupInterfaceVersion = 2;
+const uint32_t ControllerServicePresetInterfaceVersion = 2;
+const uint32_t ControllerServiceSceneInterfaceVersion = 2;
+const uint32_t ControllerServiceMasterSceneInterfaceVersion = 2;
+const uint32_t ControllerServiceDiagnosticsInterfaceVersion = 1;
+const uint32_t LeaderElectionAndStateSyncInterfaceVersion = 5;
 
 const char* LampServiceObjectPath = "/org/allseen/LSF/Lamp";
 const char* LampServiceInterfaceName = "org.allseen.LSF.LampService";
 const char* LampServiceStateInterfaceName = "org.allseen.LSF.LampState";
+const char* LampServicePackedStateInterfaceName = "org.allseen.LSF.LampStatePacked";
 const char* LampServiceParametersInterfaceName = "org.allseen.LSF.LampParameters";
 const char* LampServiceDetailsInterfaceName = "org.allseen.LSF.LampDetails";
 ajn::SessionPort LampServiceSessionPort = 42;
@@ -109,6 +115,19 @@ uint64_t GetTimestampInMs(void)
     return ret;
 }
 
+uint64_t GetTimestampInUs(void)
+{
+    struct timespec ts;
+    uint64_t ret;
+
+    platform_gettime(&ts);
+
+    ret = ((uint64_t)(ts.tv_sec)) * 1000000;
+    ret += (uint64_t)ts.tv_nsec / 1000;
+
+    return ret;
+}
+
 uint32_t GetTimestampInSeconds(void)
 {
     struct timespec ts;
@@ -144,6 +163,28 @@ void CreateUniqueList(LSFStringList& uniqueList, ajn::MsgArg* idsArray, size_t i
 
 }
 
+void CreateStringListArg(const LSFStringList& strings, ajn::MsgArg& arg)
+{
+    size_t size = strings.size();
+    if (size == 0) {
+        arg.Set("as", (size_t)0, NULL);
+        return;
+    }
+
+    const char* stackStrs[STRING_LIST_ARG_STACK_LEN];
+    const char** strs = (size <= STRING_LIST_ARG_STACK_LEN) ? stackStrs : new const char*[size];
+    size_t i = 0;
+    for (LSFStringList::const_iterator it = strings.begin(); it != strings.end(); ++it, ++i) {
+        strs[i] = it->c_str();
+    }
+
+    arg.Set("as", size, strs);
+
+    if (strs != stackStrs) {
+        delete [] strs;
+    }
+}
+
 char* strdupnew(const char* str) {
     char* d = new char[strlen(str) + 1];
     if (d) {
@@ -255,13 +296,144 @@ void LampState::Set(const ajn::MsgArg& arg)
     QCC_DbgPrintf(("%s: %s", __func__, this->c_str()));
 }
 
+/*
+ * Keys of the Lamp State dictionary, in the order they are marshalled
+ */
+static const char* const LampStateFieldNames[] = { "OnOff", "Hue", "Saturation", "Brightness", "ColorTemp" };
+
+LampStateMsgArgs::LampStateMsgArgs()
+{
+    /*
+     * entries[i] = { keys[i], variants[i] = v(values[i]) }. None of them owns
+     * the others, so only the values change from one Lamp State to the next
+     */
+    for (size_t i = 0; i < NUM_FIELDS; i++) {
+        keys[i].Set("s", LampStateFieldNames[i]);
+        if (i == 0) {
+            values[i].Set("b", false);
+        } else {
+            values[i].Set("u", 0);
+        }
+        variants[i].typeId = ALLJOYN_VARIANT;
+        variants[i].v_variant.val = &values[i];
+        entries[i].typeId = ALLJOYN_DICT_ENTRY;
+        entries[i].v_dictEntry.key = &keys[i];
+        entries[i].v_dictEntry.val = &variants[i];
+    }
+}
+
+void LampState::Get(ajn::MsgArg* arg, LampStateMsgArgs& storage) const
+{
+    QCC_DbgPrintf(("%s", __func__));
+    if (nullState) {
+        arg->Set("a{sv}", (size_t)0, NULL);
+    } else {
+        storage.values[0].v_bool = onOff;
+        storage.values[1].v_uint32 = hue;
+        storage.values[2].v_uint32 = saturation;
+        storage.values[3].v_uint32 = brightness;
+        storage.values[4].v_uint32 = colorTemp;
+        arg->Set("a{sv}", (size_t)LampStateMsgArgs::NUM_FIELDS, storage.entries);
+    }
+}
+
+void LampState::SetPacked(const ajn::MsgArg& arg)
+{
+    uint8_t fields = 0;
+    bool packedOnOff = false;
+    uint32_t packedHue = 0, packedSaturation = 0, packedColorTemp = 0, packedBrightness = 0;
+
+    QStatus status = arg.Get(LAMP_STATE_PACKED_SIGNATURE, &fields, &packedOnOff, &packedHue,
+                             &packedSaturation, &packedColorTemp, &packedBrightness);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Invalid packed Lamp State", __func__));
+        fields = 0;
+    }
+
+    /*
+     * Like Set, fields absent from the state keep their value
+     */
+    if (fields & LAMP_STATE_PACKED_ON_OFF) {
+        onOff = packedOnOff;
+    }
+    if (fields & LAMP_STATE_PACKED_HUE) {
+        hue = packedHue;
+    }
+    if (fields & LAMP_STATE_PACKED_SATURATION) {
+        saturation = packedSaturation;
+    }
+    if (fields & LAMP_STATE_PACKED_COLOR_TEMP) {
+        colorTemp = packedColorTemp;
+    }
+    if (fields & LAMP_STATE_PACKED_BRIGHTNESS) {
+        brightness = packedBrightness;
+    }
+    nullState = (fields == 0);
+
+    QCC_DbgPrintf(("%s: %s", __func__, this->c_str()));
+}
+
+void LampState::GetPacked(ajn::MsgArg* arg) const
+{
+    QCC_DbgPrintf(("%s", __func__));
+    if (nullState) {
+        arg->Set(LAMP_STATE_PACKED_SIGNATURE, (uint8_t)0, false, 0, 0, 0, 0);
+    } else {
+        arg->Set(LAMP_STATE_PACKED_SIGNATURE, (uint8_t)LAMP_STATE_PACKED_ALL_FIELDS, onOff, hue, saturation, colorTemp, brightness);
+    }
+}
+
+QStatus CreatePackedLampStateArg(const ajn::MsgArg& dict, ajn::MsgArg& packed)
+{
+    MsgArg* args;
+    size_t numArgs;
+    uint8_t fields = 0;
+    bool onOff = false;
+    uint32_t values[4] = { 0, 0, 0, 0 };
+
+    QStatus status = dict.Get("a{sv}", &numArgs, &args);
+    for (size_t i = 0; (status == ER_OK) && (i < numArgs); i++) {
+        char* field;
+        MsgArg* value;
+        status = args[i].Get("{sv}", &field, &value);
+        if (status != ER_OK) {
+            break;
+        }
+
+        if (0 == strcmp(field, "OnOff")) {
+            status = value->Get("b", &onOff);
+            fields |= LAMP_STATE_PACKED_ON_OFF;
+        } else if (0 == strcmp(field, "Hue")) {
+            status = value->Get("u", &values[0]);
+            fields |= LAMP_STATE_PACKED_HUE;
+        } else if (0 == strcmp(field, "Saturation")) {
+            status = value->Get("u", &values[1]);
+            fields |= LAMP_STATE_PACKED_SATURATION;
+        } else if (0 == strcmp(field, "ColorTemp")) {
+            status = value->Get("u", &values[2]);
+            fields |= LAMP_STATE_PACKED_COLOR_TEMP;
+        } else if (0 == strcmp(field, "Brightness")) {
+            status = value->Get("u", &values[3]);
+            fields |= LAMP_STATE_PACKED_BRIGHTNESS;
+        } else {
+            status = ER_BUS_BAD_VALUE;
+        }
+    }
+
+    if (status == ER_OK) {
+        packed.Set(LAMP_STATE_PACKED_SIGNATURE, fields, onOff, values[0], values[1], values[2], values[3]);
+    }
+
+    return status;
+}
+
 void LampState::Get(ajn::MsgArg* arg, bool ownership) const
 {
     QCC_DbgPrintf(("%s", __func__));
     if (nullState) {
         arg->Set("a{sv}", (size_t)0, NULL);
     } else {
-        const char* str[] = { "OnOff", "Hue", "Saturation", "Brightness", "ColorTemp" };
+        const char* const* str = LampStateFieldNames;
         MsgArg* dict = new MsgArg[5];
 
         MsgArg* var = new MsgArg("b", onOff);
@@ -291,6 +463,50 @@ void LampState::Get(ajn::MsgArg* arg, bool ownership) const
     }
 }
 
+void CreateLampStateMapArg(const LampStateMap& lampStates, ajn::MsgArg& arg)
+{
+    QCC_DbgPrintf(("%s: numLamps=%d", __func__, lampStates.size()));
+    if (lampStates.empty()) {
+        arg.Set("a{sa{sv}}", (size_t)0, NULL);
+        return;
+    }
+
+    MsgArg* entries = new MsgArg[lampStates.size()];
+    size_t i = 0;
+    for (LampStateMap::const_iterator it = lampStates.begin(); it != lampStates.end(); it++, i++) {
+        MsgArg state;
+        it->second.Get(&state);
+        MsgArg* stateArgs;
+        size_t stateArgsSize;
+        state.Get("a{sv}", &stateArgsSize, &stateArgs);
+        entries[i].Set("{sa{sv}}", it->first.c_str(), stateArgsSize, stateArgs);
+        entries[i].SetOwnershipFlags(MsgArg::OwnsArgs, true);
+    }
+
+    arg.Set("a{sa{sv}}", lampStates.size(), entries);
+    arg.SetOwnershipFlags(MsgArg::OwnsArgs, true);
+}
+
+void CreateLampStateMap(LampStateMap& lampStates, const ajn::MsgArg& arg)
+{
+    MsgArg* entries;
+    size_t numEntries;
+    arg.Get("a{sa{sv}}", &numEntries, &entries);
+
+    QCC_DbgPrintf(("%s: numEntries=%d", __func__, numEntries));
+
+    for (size_t i = 0; i < numEntries; i++) {
+        char* lampID;
+        MsgArg* stateArgs;
+        size_t stateArgsSize;
+        entries[i].Get("{sa{sv}}", &lampID, &stateArgsSize, &stateArgs);
+
+        MsgArg state;
+        state.Set("a{sv}", stateArgsSize, stateArgs);
+        lampStates[LSFString(lampID)] = LampState(state);
+    }
+}
+
 LampParameters::LampParameters() :
     energyUsageMilliwatts(0),
     lumens(0)
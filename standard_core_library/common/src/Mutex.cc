@@ -15,27 +15,94 @@
  ******************************************************************************/
 
 #include <Mutex.h>
+#include <qcc/Debug.h>
+
+#include <stdio.h>
+#include <time.h>
+#include <algorithm>
 
 using namespace lsf;
 
 #define QCC_MODULE "MUTEX"
 
-Mutex::Mutex()
+#ifdef LSF_LOCK_PROFILING
+
+/*
+ * The named mutexes, linked through their prev and next pointers
+ */
+static pthread_mutex_t namedMutexesLock = PTHREAD_MUTEX_INITIALIZER;
+static Mutex* namedMutexes = NULL;
+static volatile bool lockProfilingEnabled = false;
+
+static uint64_t GetTimeInNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (static_cast<uint64_t>(now.tv_sec) * 1000000000) + now.tv_nsec;
+}
+
+#endif
+
+Mutex::Mutex(const char* name)
 {
     pthread_mutexattr_t attr;
     pthread_mutexattr_init(&attr);
     pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
     pthread_mutex_init(&mutex, &attr);
     pthread_mutexattr_destroy(&attr);
+
+#ifdef LSF_LOCK_PROFILING
+    this->name = name;
+    prev = NULL;
+    next = NULL;
+    depth = 0;
+    holdStart = 0;
+    acquisitions = 0;
+    contended = 0;
+    totalWaitTime = 0;
+    maxWaitTime = 0;
+    maxHoldTime = 0;
+
+    if (name) {
+        pthread_mutex_lock(&namedMutexesLock);
+        next = namedMutexes;
+        if (next) {
+            next->prev = this;
+        }
+        namedMutexes = this;
+        pthread_mutex_unlock(&namedMutexesLock);
+    }
+#else
+    (void) name;
+#endif
 }
 
 Mutex::~Mutex()
 {
+#ifdef LSF_LOCK_PROFILING
+    if (name) {
+        pthread_mutex_lock(&namedMutexesLock);
+        if (prev) {
+            prev->next = next;
+        } else {
+            namedMutexes = next;
+        }
+        if (next) {
+            next->prev = prev;
+        }
+        pthread_mutex_unlock(&namedMutexesLock);
+    }
+#endif
     pthread_mutex_destroy(&mutex);
 }
 
 QStatus Mutex::Lock()
 {
+#ifdef LSF_LOCK_PROFILING
+    if (name) {
+        return ProfiledLock();
+    }
+#endif
     int ret = pthread_mutex_lock(&mutex);
 
     if (ret == 0) {
@@ -49,6 +116,11 @@ QStatus Mutex::Lock()
 
 QStatus Mutex::Unlock()
 {
+#ifdef LSF_LOCK_PROFILING
+    if (name) {
+        ProfiledUnlock();
+    }
+#endif
     int ret = pthread_mutex_unlock(&mutex);
 
     if (ret == 0) {
@@ -57,3 +129,140 @@ QStatus Mutex::Unlock()
         return ER_FAIL;
     }
 }
+
+#ifdef LSF_LOCK_PROFILING
+
+QStatus Mutex::ProfiledLock(void)
+{
+    bool enabled = lockProfilingEnabled;
+    bool wasContended = false;
+    uint64_t waitStart = 0;
+
+    int ret = pthread_mutex_trylock(&mutex);
+    if (ret == EBUSY) {
+        wasContended = true;
+        if (enabled) {
+            waitStart = GetTimeInNs();
+        }
+        ret = pthread_mutex_lock(&mutex);
+    }
+
+    if (ret != 0) {
+        return ((ret == EBUSY) || (ret == EAGAIN)) ? ER_WOULDBLOCK : ER_FAIL;
+    }
+
+    /*
+     * The owner may be stale if the previous holder left the mutex in
+     * pthread_cond_wait, so a depth only counts for the same thread
+     */
+    pthread_t self = pthread_self();
+    if (depth && pthread_equal(owner, self)) {
+        depth++;
+        return ER_OK;
+    }
+
+    owner = self;
+    depth = 1;
+    holdStart = 0;
+    if (enabled) {
+        uint64_t now = GetTimeInNs();
+        acquisitions++;
+        if (wasContended) {
+            uint64_t waitTime = now - waitStart;
+            contended++;
+            totalWaitTime += waitTime;
+            maxWaitTime = std::max(maxWaitTime, waitTime);
+        }
+        holdStart = now;
+    }
+
+    return ER_OK;
+}
+
+void Mutex::ProfiledUnlock(void)
+{
+    if (!depth || !pthread_equal(owner, pthread_self())) {
+        return;
+    }
+
+    depth--;
+    if (!depth && holdStart) {
+        maxHoldTime = std::max(maxHoldTime, GetTimeInNs() - holdStart);
+        holdStart = 0;
+    }
+}
+
+#endif
+
+void LockProfiler::Enable(bool enable)
+{
+#ifdef LSF_LOCK_PROFILING
+    QCC_DbgPrintf(("%s: enable=%d", __func__, enable));
+    lockProfilingEnabled = enable;
+#else
+    (void) enable;
+    QCC_DbgPrintf(("%s: Not built with LSF_LOCK_PROFILING", __func__));
+#endif
+}
+
+bool LockProfiler::IsEnabled(void)
+{
+#ifdef LSF_LOCK_PROFILING
+    return lockProfilingEnabled;
+#else
+    return false;
+#endif
+}
+
+static bool LongerTotalWait(const LockStats& first, const LockStats& second)
+{
+    return first.totalWaitTime > second.totalWaitTime;
+}
+
+void LockProfiler::GetStats(std::vector<LockStats>& stats)
+{
+    stats.clear();
+
+#ifdef LSF_LOCK_PROFILING
+    pthread_mutex_lock(&namedMutexesLock);
+    for (Mutex* mutex = namedMutexes; mutex; mutex = mutex->next) {
+        LockStats lockStats;
+        lockStats.name = mutex->name;
+        lockStats.acquisitions = mutex->acquisitions;
+        lockStats.contended = mutex->contended;
+        lockStats.totalWaitTime = mutex->totalWaitTime / 1000;
+        lockStats.maxWaitTime = mutex->maxWaitTime / 1000;
+        lockStats.maxHoldTime = mutex->maxHoldTime / 1000;
+        stats.push_back(lockStats);
+    }
+    pthread_mutex_unlock(&namedMutexesLock);
+#endif
+
+    std::stable_sort(stats.begin(), stats.end(), &LongerTotalWait);
+}
+
+std::string LockProfiler::GetStatsText(void)
+{
+    std::vector<LockStats> stats;
+    GetStats(stats);
+
+    std::string text;
+    for (size_t i = 0; i < stats.size(); i++) {
+        const LockStats& lockStats = stats[i];
+        const char* name = lockStats.name.c_str();
+        char lines[512];
+        snprintf(lines, sizeof(lines),
+                 "lock.%s.acquisitions %u\n"
+                 "lock.%s.contended %u\n"
+                 "lock.%s.totalWaitTime %llu\n"
+                 "lock.%s.maxWaitTime %llu\n"
+                 "lock.%s.maxHoldTime %llu\n",
+                 name, lockStats.acquisitions,
+                 name, lockStats.contended,
+                 name, (unsigned long long) lockStats.totalWaitTime,
+                 name, (unsigned long long) lockStats.maxWaitTime,
+                 name, (unsigned long long) lockStats.maxHoldTime);
+        text += lines;
+    }
+    return text;
+}
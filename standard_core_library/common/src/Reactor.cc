@@ -0,0 +1,354 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <Reactor.h>
+#include <qcc/Debug.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace lsf;
+
+#define QCC_MODULE "LSF_REACTOR"
+
+/*
+ * Key of the eventfd in epoll. The timers use their ID, which starts at 1
+ */
+#define REACTOR_EVENTFD_KEY 0
+
+#define REACTOR_MAX_EPOLL_EVENTS 8
+
+Reactor::Reactor(uint32_t numThreads) :
+    lock("Reactor.lock"),
+    epollFd(-1),
+    eventFd(-1),
+    running(false),
+    numThreads(numThreads ? numThreads : 1),
+    nextTimerId(REACTOR_EVENTFD_KEY + 1)
+{
+    QCC_DbgPrintf(("%s: numThreads=%u", __func__, numThreads));
+    pthread_cond_init(&idleCondition, NULL);
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if ((epollFd == -1) || (eventFd == -1)) {
+        QCC_LogError(ER_OS_ERROR, ("%s: Unable to create the epoll instance: %s", __func__, strerror(errno)));
+        return;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u64 = REACTOR_EVENTFD_KEY;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, eventFd, &event) == -1) {
+        QCC_LogError(ER_OS_ERROR, ("%s: Unable to watch the eventfd: %s", __func__, strerror(errno)));
+    }
+}
+
+Reactor::~Reactor()
+{
+    QCC_DbgTrace(("%s", __func__));
+    Stop();
+    Join();
+    if (eventFd != -1) {
+        close(eventFd);
+    }
+    if (epollFd != -1) {
+        close(epollFd);
+    }
+    pthread_cond_destroy(&idleCondition);
+}
+
+QStatus Reactor::Start(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    if ((epollFd == -1) || (eventFd == -1)) {
+        return ER_OS_ERROR;
+    }
+
+    lock.Lock();
+    if (running) {
+        lock.Unlock();
+        return ER_OK;
+    }
+    running = true;
+    lock.Unlock();
+
+    for (uint32_t i = 0; i < numThreads; i++) {
+        ReactorThread* thread = new ReactorThread(*this);
+        char name[LSF_THREAD_NAME_LEN];
+        snprintf(name, sizeof(name), "Reactor%u", i);
+        thread->SetName(name);
+        if (thread->Start() != ER_OK) {
+            delete thread;
+            QCC_LogError(ER_FAIL, ("%s: Failed to start thread %u", __func__, i));
+            break;
+        }
+        threads.push_back(thread);
+    }
+
+    if (threads.empty()) {
+        lock.Lock();
+        running = false;
+        lock.Unlock();
+        return ER_FAIL;
+    }
+
+    return ER_OK;
+}
+
+void Reactor::Stop(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    lock.Lock();
+    running = false;
+    for (std::list<ReactorHandler*>::iterator it = readyHandlers.begin(); it != readyHandlers.end(); ++it) {
+        (*it)->pendingEvents = 0;
+        (*it)->queued = false;
+    }
+    readyHandlers.clear();
+    lock.Unlock();
+    Wake();
+}
+
+void Reactor::Join(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    for (std::vector<ReactorThread*>::iterator it = threads.begin(); it != threads.end(); ++it) {
+        (*it)->Join();
+        delete *it;
+    }
+    threads.clear();
+}
+
+void Reactor::Wake(void)
+{
+    uint64_t one = 1;
+    if (write(eventFd, &one, sizeof(one)) != sizeof(one)) {
+        /*
+         * The counter is saturated, so the threads are awake anyway
+         */
+        QCC_DbgPrintf(("%s: write failed: %s", __func__, strerror(errno)));
+    }
+}
+
+void Reactor::Queue(ReactorHandler* handler, uint32_t events)
+{
+    handler->pendingEvents |= events;
+    /*
+     * A running handler is queued again by its thread when it returns
+     */
+    if (!handler->queued && !handler->running) {
+        readyHandlers.push_back(handler);
+        handler->queued = true;
+    }
+}
+
+void Reactor::Post(ReactorHandler* handler, uint32_t events)
+{
+    if (!handler || !events) {
+        return;
+    }
+
+    lock.Lock();
+    bool wasQueued = handler->queued;
+    Queue(handler, events);
+    bool wake = handler->queued && !wasQueued;
+    lock.Unlock();
+
+    if (wake) {
+        Wake();
+    }
+}
+
+void Reactor::Cancel(ReactorHandler* handler)
+{
+    lock.Lock();
+    handler->pendingEvents = 0;
+    if (handler->queued) {
+        readyHandlers.remove(handler);
+        handler->queued = false;
+    }
+    lock.Unlock();
+}
+
+void Reactor::WaitIdle(ReactorHandler* handler)
+{
+    lock.Lock();
+    while (handler->running && !pthread_equal(handler->runner, pthread_self())) {
+        pthread_cond_wait(&idleCondition, lock.GetMutex());
+    }
+    lock.Unlock();
+}
+
+void Reactor::RunThread(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    struct epoll_event events[REACTOR_MAX_EPOLL_EVENTS];
+
+    lock.Lock();
+    while (running) {
+        if (!readyHandlers.empty()) {
+            ReactorHandler* handler = readyHandlers.front();
+            readyHandlers.pop_front();
+            uint32_t handlerEvents = handler->pendingEvents;
+            handler->pendingEvents = 0;
+            handler->queued = false;
+            handler->running = true;
+            handler->runner = pthread_self();
+            bool more = !readyHandlers.empty();
+            lock.Unlock();
+
+            /*
+             * Let another thread take the next handler
+             */
+            if (more) {
+                Wake();
+            }
+            handler->HandleEvents(handlerEvents);
+
+            lock.Lock();
+            handler->running = false;
+            if (handler->pendingEvents && running) {
+                readyHandlers.push_back(handler);
+                handler->queued = true;
+            }
+            pthread_cond_broadcast(&idleCondition);
+            continue;
+        }
+        lock.Unlock();
+
+        int numEvents = epoll_wait(epollFd, events, REACTOR_MAX_EPOLL_EVENTS, -1);
+        if ((numEvents == -1) && (errno != EINTR)) {
+            QCC_LogError(ER_OS_ERROR, ("%s: epoll_wait failed: %s", __func__, strerror(errno)));
+        }
+
+        lock.Lock();
+        for (int i = 0; i < numEvents; i++) {
+            uint64_t value;
+            if (events[i].data.u64 == REACTOR_EVENTFD_KEY) {
+                /*
+                 * Another thread may have reset the counter already
+                 */
+                if (read(eventFd, &value, sizeof(value)) != sizeof(value)) {
+                    continue;
+                }
+            } else {
+                std::map<uint64_t, ReactorTimer*>::iterator it = timers.find(events[i].data.u64);
+                if ((it != timers.end()) && (read(it->second->timerFd, &value, sizeof(value)) == sizeof(value))) {
+                    Queue(it->second->handler, it->second->event);
+                }
+            }
+        }
+
+        /*
+         * The eventfd wakes all the threads, and only one of them gets the handler
+         */
+        if (numEvents > 0) {
+            Thread::RecordWakeup(!readyHandlers.empty() || !running);
+        }
+    }
+    lock.Unlock();
+
+    /*
+     * Pass the stop on to a thread that is still waiting
+     */
+    Wake();
+    QCC_DbgPrintf(("%s: Exited", __func__));
+}
+
+uint64_t Reactor::AddTimer(ReactorTimer* timer)
+{
+    lock.Lock();
+    uint64_t id = nextTimerId++;
+    timers.insert(std::make_pair(id, timer));
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u64 = id;
+    if ((timer->timerFd == -1) || (epoll_ctl(epollFd, EPOLL_CTL_ADD, timer->timerFd, &event) == -1)) {
+        QCC_LogError(ER_OS_ERROR, ("%s: Unable to watch the timerfd: %s", __func__, strerror(errno)));
+    }
+    lock.Unlock();
+    return id;
+}
+
+void Reactor::RemoveTimer(ReactorTimer* timer)
+{
+    lock.Lock();
+    timers.erase(timer->id);
+    if (timer->timerFd != -1) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, timer->timerFd, NULL);
+    }
+    lock.Unlock();
+}
+
+static Reactor* sharedReactor = NULL;
+static pthread_once_t sharedReactorOnce = PTHREAD_ONCE_INIT;
+
+static void CreateSharedReactor(void)
+{
+    /*
+     * Lives as long as the process, as do the subsystems that use it
+     */
+    sharedReactor = new Reactor(LSF_REACTOR_THREADS);
+    QStatus status = sharedReactor->Start();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to start the shared reactor", __func__));
+    }
+}
+
+Reactor& Reactor::GetShared(void)
+{
+    pthread_once(&sharedReactorOnce, &CreateSharedReactor);
+    return *sharedReactor;
+}
+
+ReactorTimer::ReactorTimer(Reactor& reactor, ReactorHandler* handler, uint32_t event) :
+    reactor(reactor),
+    handler(handler),
+    event(event),
+    timerFd(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+    id(0)
+{
+    id = reactor.AddTimer(this);
+}
+
+ReactorTimer::~ReactorTimer()
+{
+    reactor.RemoveTimer(this);
+    if (timerFd != -1) {
+        close(timerFd);
+    }
+}
+
+void ReactorTimer::SetInMs(uint32_t timeInMs)
+{
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = timeInMs / 1000;
+    spec.it_value.tv_nsec = (timeInMs % 1000) * 1000000;
+    if ((timerFd == -1) || (timerfd_settime(timerFd, 0, &spec, NULL) == -1)) {
+        QCC_LogError(ER_OS_ERROR, ("%s: Unable to set the timer: %s", __func__, strerror(errno)));
+    }
+}
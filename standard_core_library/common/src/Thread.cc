@@ -17,21 +17,85 @@
 #include <Thread.h>
 #include <qcc/Debug.h>
 
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
 using namespace lsf;
 
 #define QCC_MODULE "LSF_THREAD"
 
+/*
+ * The running threads, linked through their prev and next pointers, oldest
+ * last. Each thread also finds itself through thread-specific data
+ */
+static pthread_mutex_t runningThreadsLock = PTHREAD_MUTEX_INITIALIZER;
+static Thread* runningThreads = NULL;
+static pthread_key_t currentThreadKey;
+static pthread_once_t currentThreadKeyOnce = PTHREAD_ONCE_INIT;
+static volatile uint32_t defaultCpuMask = 0;
+
+static void CreateCurrentThreadKey(void)
+{
+    pthread_key_create(&currentThreadKey, NULL);
+}
+
 void* Thread::RunThread(void* data)
 {
     QCC_DbgPrintf(("%s", __func__));
     Thread* thread = static_cast<Thread*>(data);
+
+    thread->tid = static_cast<pid_t>(syscall(SYS_gettid));
+    thread->wakeups = 0;
+    thread->usefulWakeups = 0;
+    thread->ApplySchedule();
+
+    pthread_once(&currentThreadKeyOnce, &CreateCurrentThreadKey);
+    pthread_setspecific(currentThreadKey, thread);
+
+    pthread_mutex_lock(&runningThreadsLock);
+    thread->prev = NULL;
+    thread->next = runningThreads;
+    if (runningThreads) {
+        runningThreads->prev = thread;
+    }
+    runningThreads = thread;
+    pthread_mutex_unlock(&runningThreadsLock);
+
     thread->Run();
+
+    pthread_mutex_lock(&runningThreadsLock);
+    if (thread->prev) {
+        thread->prev->next = thread->next;
+    } else {
+        runningThreads = thread->next;
+    }
+    if (thread->next) {
+        thread->next->prev = thread->prev;
+    }
+    pthread_mutex_unlock(&runningThreadsLock);
+
+    pthread_setspecific(currentThreadKey, NULL);
     return NULL;
 }
 
-Thread::Thread()
+Thread::Thread(const char* name) :
+    cpuMask(0),
+    niceValue(0),
+    hasPriority(false),
+    tid(0),
+    wakeups(0),
+    usefulWakeups(0),
+    prev(NULL),
+    next(NULL)
 {
     QCC_DbgPrintf(("%s", __func__));
+    SetName(name);
 }
 
 Thread::~Thread()
@@ -41,7 +105,7 @@ Thread::~Thread()
 
 QStatus Thread::Start()
 {
-    QCC_DbgPrintf(("%s", __func__));
+    QCC_DbgPrintf(("%s: %s", __func__, name));
     int ret = pthread_create(&thread, NULL, &Thread::RunThread, this);
     return ret == 0 ? ER_OK : ER_FAIL;
 }
@@ -52,3 +116,146 @@ void Thread::Join()
     pthread_join(thread, NULL);
 }
 
+void Thread::SetName(const char* name)
+{
+    strncpy(this->name, name ? name : "lsf", LSF_THREAD_NAME_LEN - 1);
+    this->name[LSF_THREAD_NAME_LEN - 1] = '\0';
+}
+
+void Thread::SetAffinity(uint32_t cpuMask)
+{
+    this->cpuMask = cpuMask;
+}
+
+void Thread::SetPriority(int niceValue)
+{
+    this->niceValue = niceValue;
+    hasPriority = true;
+}
+
+void Thread::SetDefaultAffinity(uint32_t cpuMask)
+{
+    QCC_DbgPrintf(("%s: cpuMask=0x%x", __func__, cpuMask));
+    defaultCpuMask = cpuMask;
+}
+
+void Thread::ApplySchedule(void)
+{
+    pthread_setname_np(pthread_self(), name);
+
+    uint32_t mask = cpuMask ? cpuMask : defaultCpuMask;
+    if (mask) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (uint32_t cpu = 0; cpu < 32; cpu++) {
+            if (mask & (1U << cpu)) {
+                CPU_SET(cpu, &cpus);
+            }
+        }
+        int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        if (ret != 0) {
+            QCC_LogError(ER_OS_ERROR, ("%s: Unable to bind %s to the CPUs 0x%x: %s", __func__, name, mask, strerror(ret)));
+        }
+    }
+
+    /*
+     * On Linux the nice value of a thread is set through its tid
+     */
+    if (hasPriority && (setpriority(PRIO_PROCESS, tid, niceValue) == -1)) {
+        QCC_LogError(ER_OS_ERROR, ("%s: Unable to set the nice value of %s to %d: %s", __func__, name, niceValue, strerror(errno)));
+    }
+}
+
+void Thread::RecordWakeup(bool useful)
+{
+    pthread_once(&currentThreadKeyOnce, &CreateCurrentThreadKey);
+    Thread* thread = static_cast<Thread*>(pthread_getspecific(currentThreadKey));
+    if (thread) {
+        thread->wakeups++;
+        if (useful) {
+            thread->usefulWakeups++;
+        }
+    }
+}
+
+/*
+ * Read the context switches of a thread from procfs
+ */
+static void GetContextSwitches(pid_t tid, uint32_t& voluntarySwitches, uint32_t& involuntarySwitches)
+{
+    voluntarySwitches = 0;
+    involuntarySwitches = 0;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/status", static_cast<int>(tid));
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        return;
+    }
+
+    char line[128];
+    unsigned int value;
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "voluntary_ctxt_switches: %u", &value) == 1) {
+            voluntarySwitches = value;
+        } else if (sscanf(line, "nonvoluntary_ctxt_switches: %u", &value) == 1) {
+            involuntarySwitches = value;
+        }
+    }
+    fclose(file);
+}
+
+void Thread::GetStats(std::vector<ThreadStats>& stats)
+{
+    stats.clear();
+
+    pthread_mutex_lock(&runningThreadsLock);
+    for (Thread* thread = runningThreads; thread; thread = thread->next) {
+        ThreadStats threadStats;
+        threadStats.name = thread->name;
+        threadStats.tid = static_cast<uint32_t>(thread->tid);
+        threadStats.cpuTime = 0;
+        threadStats.wakeups = thread->wakeups;
+        threadStats.usefulWakeups = thread->usefulWakeups;
+
+        /*
+         * The thread cannot exit while it is in the list
+         */
+        clockid_t clock;
+        struct timespec cpuTime;
+        if ((pthread_getcpuclockid(thread->thread, &clock) == 0) && (clock_gettime(clock, &cpuTime) == 0)) {
+            threadStats.cpuTime = (static_cast<uint64_t>(cpuTime.tv_sec) * 1000000) + (cpuTime.tv_nsec / 1000);
+        }
+        GetContextSwitches(thread->tid, threadStats.voluntarySwitches, threadStats.involuntarySwitches);
+
+        stats.insert(stats.begin(), threadStats);
+    }
+    pthread_mutex_unlock(&runningThreadsLock);
+}
+
+std::string Thread::GetStatsText(void)
+{
+    std::vector<ThreadStats> stats;
+    GetStats(stats);
+
+    std::string text;
+    for (size_t i = 0; i < stats.size(); i++) {
+        const ThreadStats& threadStats = stats[i];
+        const char* name = threadStats.name.c_str();
+        unsigned int tid = threadStats.tid;
+        char lines[512];
+        snprintf(lines, sizeof(lines),
+                 "thread.%s.%u.cpuTime %llu\n"
+                 "thread.%s.%u.wakeups %u\n"
+                 "thread.%s.%u.usefulWakeups %u\n"
+                 "thread.%s.%u.voluntarySwitches %u\n"
+                 "thread.%s.%u.involuntarySwitches %u\n",
+                 name, tid, (unsigned long long) threadStats.cpuTime,
+                 name, tid, threadStats.wakeups,
+                 name, tid, threadStats.usefulWakeups,
+                 name, tid, threadStats.voluntarySwitches,
+                 name, tid, threadStats.involuntarySwitches);
+        text += lines;
+    }
+    return text;
+}
@@ -0,0 +1,276 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <Trace.h>
+#include <LSFTypes.h>
+#include <qcc/Debug.h>
+#include <qcc/atomic.h>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
+using namespace lsf;
+
+#define QCC_MODULE "LSF_TRACE"
+
+/*
+ * A slot holds a span and the ticket of the Record that wrote it. The
+ * sequence is 0 while the span is being written, so a reader that sees the
+ * same non-zero sequence before and after copying the span got a whole one.
+ */
+struct TraceSlot {
+    volatile uint32_t sequence;
+    TraceEvent event;
+};
+
+static TraceSlot traceSlots[LSF_TRACE_BUFFER_SIZE];
+static volatile int32_t nextTicket = 0;
+static volatile int32_t nextTraceId = 0;
+static volatile int32_t nextThreadId = 0;
+static volatile bool tracingEnabled = false;
+
+/*
+ * The trace of each thread is kept in thread-specific data
+ */
+struct ThreadTrace {
+    uint32_t threadId;
+    uint32_t traceId;
+    uint64_t traceStart;
+};
+
+static pthread_key_t threadTraceKey;
+static pthread_once_t threadTraceKeyOnce = PTHREAD_ONCE_INIT;
+
+static void DeleteThreadTrace(void* threadTrace)
+{
+    delete static_cast<ThreadTrace*>(threadTrace);
+}
+
+static void CreateThreadTraceKey(void)
+{
+    pthread_key_create(&threadTraceKey, &DeleteThreadTrace);
+}
+
+static ThreadTrace* GetThreadTrace(void)
+{
+    pthread_once(&threadTraceKeyOnce, &CreateThreadTraceKey);
+    ThreadTrace* threadTrace = static_cast<ThreadTrace*>(pthread_getspecific(threadTraceKey));
+    if (!threadTrace) {
+        threadTrace = new ThreadTrace;
+        threadTrace->threadId = static_cast<uint32_t>(qcc::IncrementAndFetch(&nextThreadId));
+        threadTrace->traceId = 0;
+        threadTrace->traceStart = 0;
+        pthread_setspecific(threadTraceKey, threadTrace);
+    }
+    return threadTrace;
+}
+
+void Tracer::Enable(bool enable)
+{
+    QCC_DbgPrintf(("%s: enable=%d", __func__, enable));
+    tracingEnabled = enable;
+}
+
+bool Tracer::IsEnabled(void)
+{
+    return tracingEnabled;
+}
+
+uint32_t Tracer::StartTrace(void)
+{
+    if (!tracingEnabled) {
+        return 0;
+    }
+
+    uint32_t traceId = static_cast<uint32_t>(qcc::IncrementAndFetch(&nextTraceId));
+    if (traceId == 0) {
+        traceId = static_cast<uint32_t>(qcc::IncrementAndFetch(&nextTraceId));
+    }
+    return traceId;
+}
+
+uint32_t Tracer::GetCurrentTraceId(void)
+{
+    return tracingEnabled ? GetThreadTrace()->traceId : 0;
+}
+
+uint64_t Tracer::GetCurrentTraceStart(void)
+{
+    return tracingEnabled ? GetThreadTrace()->traceStart : 0;
+}
+
+void Tracer::SetCurrentTrace(uint32_t traceId, uint64_t traceStart)
+{
+    ThreadTrace* threadTrace = GetThreadTrace();
+    threadTrace->traceId = traceId;
+    threadTrace->traceStart = traceStart;
+}
+
+void Tracer::Record(uint32_t traceId, const char* name, uint64_t start, uint64_t end, uint32_t arg)
+{
+    if (!tracingEnabled) {
+        return;
+    }
+
+    uint32_t ticket = static_cast<uint32_t>(qcc::IncrementAndFetch(&nextTicket));
+    TraceSlot& slot = traceSlots[ticket & (LSF_TRACE_BUFFER_SIZE - 1)];
+
+    slot.sequence = 0;
+    __sync_synchronize();
+
+    TraceEvent& event = slot.event;
+    event.traceId = traceId;
+    event.threadId = GetThreadTrace()->threadId;
+    event.start = start;
+    event.duration = (end > start) ? (end - start) : 0;
+    event.arg = arg;
+    strncpy(event.name, name ? name : "", LSF_TRACE_NAME_LEN - 1);
+    event.name[LSF_TRACE_NAME_LEN - 1] = '\0';
+
+    __sync_synchronize();
+    slot.sequence = ticket;
+}
+
+static bool EventStartsBefore(const TraceEvent& first, const TraceEvent& second)
+{
+    return first.start < second.start;
+}
+
+void Tracer::GetEvents(std::vector<TraceEvent>& events)
+{
+    events.clear();
+    events.reserve(LSF_TRACE_BUFFER_SIZE);
+
+    for (uint32_t i = 0; i < LSF_TRACE_BUFFER_SIZE; i++) {
+        const TraceSlot& slot = traceSlots[i];
+        uint32_t before = slot.sequence;
+        if (before == 0) {
+            continue;
+        }
+        __sync_synchronize();
+        TraceEvent event = slot.event;
+        __sync_synchronize();
+        if (slot.sequence == before) {
+            events.push_back(event);
+        }
+    }
+
+    std::sort(events.begin(), events.end(), &EventStartsBefore);
+}
+
+static void AppendJsonString(std::string& json, const char* str)
+{
+    json += '"';
+    for (; *str; str++) {
+        if ((*str == '"') || (*str == '\\')) {
+            json += '\\';
+            json += *str;
+        } else if (static_cast<unsigned char>(*str) < 0x20) {
+            json += ' ';
+        } else {
+            json += *str;
+        }
+    }
+    json += '"';
+}
+
+void Tracer::GetChromeTrace(std::string& json)
+{
+    std::vector<TraceEvent> events;
+    GetEvents(events);
+
+    unsigned int pid = static_cast<unsigned int>(getpid());
+    json = "{\"traceEvents\":[";
+    for (size_t i = 0; i < events.size(); i++) {
+        const TraceEvent& event = events[i];
+        char fields[192];
+        json += (i == 0) ? "\n{\"name\":" : ",\n{\"name\":";
+        AppendJsonString(json, event.name);
+        snprintf(fields, sizeof(fields), ",\"cat\":\"lsf\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%u,\"tid\":%u,\"args\":{\"traceId\":%u,\"arg\":%u}}",
+                 (unsigned long long) event.start, (unsigned long long) event.duration, pid, event.threadId, event.traceId, event.arg);
+        json += fields;
+    }
+    json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
+QStatus Tracer::WriteChromeTrace(const std::string& filePath)
+{
+    std::string json;
+    GetChromeTrace(json);
+
+    FILE* file = fopen(filePath.c_str(), "w");
+    if (!file) {
+        QCC_LogError(ER_OS_ERROR, ("%s: Unable to open %s", __func__, filePath.c_str()));
+        return ER_OS_ERROR;
+    }
+
+    bool written = (fwrite(json.c_str(), 1, json.size(), file) == json.size());
+    written = (fclose(file) == 0) && written;
+    if (!written) {
+        QCC_LogError(ER_OS_ERROR, ("%s: Unable to write %s", __func__, filePath.c_str()));
+        return ER_OS_ERROR;
+    }
+
+    QCC_DbgPrintf(("%s: Wrote %u bytes to %s", __func__, (uint32_t) json.size(), filePath.c_str()));
+    return ER_OK;
+}
+
+void Tracer::Clear(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    for (uint32_t i = 0; i < LSF_TRACE_BUFFER_SIZE; i++) {
+        traceSlots[i].sequence = 0;
+    }
+}
+
+TraceContext::TraceContext(uint32_t traceId, uint64_t traceStart) :
+    previousTraceId(0),
+    previousTraceStart(0)
+{
+    if (tracingEnabled) {
+        ThreadTrace* threadTrace = GetThreadTrace();
+        previousTraceId = threadTrace->traceId;
+        previousTraceStart = threadTrace->traceStart;
+        if (traceId && !traceStart) {
+            traceStart = GetTimestampInUs();
+        }
+        Tracer::SetCurrentTrace(traceId, traceStart);
+    }
+}
+
+TraceContext::~TraceContext()
+{
+    if (tracingEnabled) {
+        Tracer::SetCurrentTrace(previousTraceId, previousTraceStart);
+    }
+}
+
+TraceSpan::TraceSpan(const char* name, uint32_t arg) :
+    name(name),
+    arg(arg),
+    start(tracingEnabled ? GetTimestampInUs() : 0)
+{
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (start) {
+        Tracer::Record(Tracer::GetCurrentTraceId(), name, start, GetTimestampInUs(), arg);
+    }
+}
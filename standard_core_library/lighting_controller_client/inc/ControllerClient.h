@@ -87,6 +87,17 @@ class ControllerClientCallback {
      *  @param errorCodeList   List of Error Codes
      */
     virtual void ControllerClientErrorCB(const ErrorCodeList& errorCodeList) { }
+
+    /**
+     * Indicates the staleness a read replica reported. \n
+     * Only called once the read replicas were enabled with ControllerClient::SetReadReplicaMaxStaleness
+     *
+     * @param controllerServiceDeviceID   Device ID of the read replica
+     * @param controllerServiceName       Name of the read replica
+     * @param staleness                   How far behind the leader the read replica may be, in ms.
+     *                                    ReadReplicaUnsynchronized if it is not synchronized with a leader
+     */
+    virtual void ReadReplicaStalenessCB(const LSFString& controllerServiceDeviceID, const LSFString& controllerServiceName, const uint32_t& staleness) { }
 };
 
 /**
@@ -149,8 +160,26 @@ class ControllerClient : public ajn::MessageReceiver {
      */
     ControllerClientStatus Start(void);
 
+    /**
+     *  Spread the read-only Lamp Group, Preset, Scene and Master Scene
+     *  method calls across the leader and the Controller Service followers
+     *  that serve as read replicas. Every other method call keeps going to the
+     *  leader. A read replica only gets reads while the staleness it last
+     *  reported is at most maxStaleness; the staleness is queried again when
+     *  it is older than READ_REPLICA_STALENESS_REFRESH_MS and reported in
+     *  ControllerClientCallback::ReadReplicaStalenessCB
+     *
+     *  @param maxStaleness   Maximum staleness of the read replicas in ms. 0 to only read from the leader
+     */
+    void SetReadReplicaMaxStaleness(uint32_t maxStaleness);
+
   private:
 
+    /**
+     * Time after which the staleness reported by a read replica is queried again
+     */
+    static const uint32_t READ_REPLICA_STALENESS_REFRESH_MS = 1000;
+
     void DoLeaveSessionAsync(ajn::SessionId sessionId);
 
     void LeaveSessionAsyncReplyHandler(ajn::Message& message, void* context);
@@ -169,12 +198,48 @@ class ControllerClient : public ajn::MessageReceiver {
 
     void OnSessionMemberRemoved(ajn::SessionId sessionId, const char* uniqueName);
 
+    /**
+     * Internal callback invoked when an announcement is received from a Controller
+     * Service follower. Only used when the read replicas are enabled
+     */
+    void OnReadReplicaAnnounced(ajn::SessionPort port, const char* busName, const char* deviceID, const char* deviceName, Rank rank);
+
+    /**
+     * Internal callback invoked when a session is lost
+     * @return true if it was the session with a read replica
+     */
+    bool OnReadReplicaSessionLost(ajn::SessionId sessionId);
+
+    /**
+     * Drop a read replica and leave its session. \n
+     * Called with readReplicasLock held
+     */
+    void RemoveReadReplica(const Rank& rank);
+
+    /**
+     * Query the staleness of a read replica. \n
+     * Called with readReplicasLock held
+     */
+    void QueryReadReplicaStaleness(const Rank& rank);
+
+    void OnReadReplicaStalenessReply(ajn::Message& message, void* context);
+
+    /**
+     * Pick the target of a read-only method call, in turn the leader and each read
+     * replica that is fresh enough
+     * @param proxy   Proxy of the read replica
+     * @return false if the call should go to the leader
+     */
+    bool GetReadReplicaProxy(const char* methodName, ajn::ProxyBusObject& proxy);
+
     void SignalWithArgDispatcher(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& message);
 
     void NameChangedSignalDispatcher(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& message);
 
     void StateChangedSignalDispatcher(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& message);
 
+    void LampStatesSignalDispatcher(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& message);
+
     void SignalWithoutArgDispatcher(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& message);
 
     void HandlerForMethodReplyWithResponseCodeAndListOfIDs(ajn::Message& message, void* context);
@@ -282,6 +347,7 @@ class ControllerClient : public ajn::MessageReceiver {
         LSFString deviceID;
         LSFString deviceName;
         uint64_t announcementTimestamp;
+        bool readReplica;
 
         void Clear(void) {
             busName.clear();
@@ -290,6 +356,7 @@ class ControllerClient : public ajn::MessageReceiver {
             deviceID.clear();
             deviceName.clear();
             announcementTimestamp = 0;
+            readReplica = false;
         }
     };
 
@@ -313,6 +380,30 @@ class ControllerClient : public ajn::MessageReceiver {
     CurrentLeader currentLeader;
     Mutex currentLeaderLock;
 
+    /*
+     * A Controller Service follower that serves the read-only method calls
+     */
+    struct ReadReplica {
+        ControllerEntry controllerDetails;
+        ajn::ProxyBusObject proxyObject;
+        ajn::SessionId sessionId;
+        uint32_t staleness; /**< staleness it last reported */
+        uint64_t stalenessTimestamp; /**< when it last reported its staleness. 0 if it never did */
+        bool stalenessQueried; /**< a staleness query is in flight */
+    };
+
+    typedef std::map<Rank, ReadReplica> ReadReplicas;
+
+    ReadReplicas readReplicasMap;
+    Mutex readReplicasLock;
+    volatile uint32_t readReplicaMaxStaleness;
+    uint32_t nextReadTarget; /**< round-robin index of the next read. Protected by readReplicasLock */
+
+    /**
+     * Internal callback invoked when a session is joined with a read replica
+     */
+    void OnReadReplicaSessionJoined(QStatus status, ajn::SessionId sessionId, const ControllerEntry& joined);
+
     bool JoinSessionWithAnotherLeader(Rank currentLeaderRank = Rank(), uint64_t timestamp = 0);
 
     /**
@@ -561,6 +652,59 @@ class ControllerClient : public ajn::MessageReceiver {
         stateChangedSignalHandlers.clear();
     }
 
+    template <typename OBJ>
+    void AddLampStatesSignalHandler(const std::string& signalName, OBJ* obj, void (OBJ::* signal)(LampStateMap &))
+    {
+        LampStatesSignalHandlerBase* handler = new LampStatesSignalHandler<OBJ>(obj, signal);
+        std::pair<LampStatesSignalDispatcherMap::iterator, bool> ins = lampStatesSignalHandlers.insert(std::make_pair(signalName, handler));
+        if (ins.second == false) {
+            // if this was already there, overwrite and delete the old handler
+            delete ins.first->second;
+            ins.first->second = handler;
+        }
+    }
+
+    class LampStatesSignalHandlerBase {
+      public:
+        virtual ~LampStatesSignalHandlerBase() { }
+        virtual void Handle(LampStateMap& states) = 0;
+    };
+
+    template <typename OBJ>
+    class LampStatesSignalHandler : public LampStatesSignalHandlerBase {
+        typedef void (OBJ::* HandlerFunction)(LampStateMap&);
+
+      public:
+        LampStatesSignalHandler(OBJ* obj, HandlerFunction handleFunc) :
+            object(obj), handler(handleFunc) { }
+
+        virtual ~LampStatesSignalHandler() { }
+
+        virtual void Handle(LampStateMap& states) {
+            (object->*(handler))(states);
+        }
+
+        OBJ* object;
+        HandlerFunction handler;
+    };
+
+    typedef std::map<std::string, LampStatesSignalHandlerBase*> LampStatesSignalDispatcherMap;
+    LampStatesSignalDispatcherMap lampStatesSignalHandlers;
+
+    void DeleteLampStatesSignalHandlers(void)
+    {
+        for (LampStatesSignalDispatcherMap::iterator it = lampStatesSignalHandlers.begin(); it != lampStatesSignalHandlers.end(); it++) {
+            delete it->second;
+        }
+        lampStatesSignalHandlers.clear();
+    }
+
+    /*
+     * Set once the leader sent a LampsStateChanged signal. The LampStateChanged
+     * signals it sends for the older apps are ignored from then on
+     */
+    volatile sig_atomic_t lampsStateChangedReceived;
+
     template <typename OBJ>
     void AddNoArgSignalHandler(const std::string& signalName, OBJ* obj, void (OBJ::* signal)(void))
     {
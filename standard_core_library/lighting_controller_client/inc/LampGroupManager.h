@@ -108,6 +108,15 @@ class LampGroupManagerCallback {
      */
     virtual void GetLampGroupReplyCB(const LSFResponseCode& responseCode, const LSFString& lampGroupID, const LampGroup& lampGroup) { }
 
+    /**
+     * Indicates that a reply has been received for the GetAllLampGroups method call.
+     *
+     * @param responseCode    The response code
+     * @param language        The language of the Lamp Group names
+     * @param lampGroups      All the Lamp Groups keyed by ID, with their names
+     */
+    virtual void GetAllLampGroupsReplyCB(const LSFResponseCode& responseCode, const LSFString& language, const LampGroupMap& lampGroups) { }
+
     /**
      * Indicates that a reply has been received for the DeleteLampGroup method call.
      *
@@ -350,6 +359,18 @@ class LampGroupManager : public Manager {
      */
     ControllerClientStatus GetLampGroup(const LSFString& lampGroupID);
 
+    /**
+     * Get the name and information of every Lamp Group in a single call. \n
+     * Response in LampGroupManagerCallback::GetAllLampGroupsReplyCB
+     *
+     * @param language       The language of the Lamp Group names
+     * @return
+     *      - CONTROLLER_CLIENT_OK if successful
+     *      - An error status otherwise
+     *
+     */
+    ControllerClientStatus GetAllLampGroups(const LSFString& language = LSFString("en"));
+
     /**
      * Delete a Lamp Group. \n
      * Response in LampGroupManagerCallback::DeleteLampGroupReplyCB
@@ -617,6 +638,11 @@ class LampGroupManager : public Manager {
      */
     void GetLampGroupReply(ajn::Message& message);
 
+    /**
+     * Method Reply Handler for the signal GetAllLampGroups
+     */
+    void GetAllLampGroupsReply(ajn::Message& message);
+
     /**
      * Method Reply Handler for the signal DeleteLampGroup
      */
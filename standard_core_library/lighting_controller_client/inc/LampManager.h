@@ -36,6 +36,29 @@ namespace lsf {
 
 class ControllerClient;
 
+/**
+ * A single element of a batched lamp transition
+ */
+typedef struct _LampTransition {
+    /**
+     * _LampTransition CTOR
+     * @param id - Lamp ID
+     * @param lampState - target state
+     * @param period - transition period in milliseconds
+     */
+    _LampTransition(const LSFString& id, const LampState& lampState, uint32_t period = 0) :
+        lampID(id), state(lampState), transitionPeriod(period) { }
+
+    LSFString lampID;           /**< Lamp ID */
+    LampState state;            /**< target state */
+    uint32_t transitionPeriod;  /**< transition period in milliseconds */
+} LampTransition;
+
+/**
+ * Typedef for a list of batched lamp transitions
+ */
+typedef std::list<LampTransition> LampTransitionList;
+
 /**
  * Abstract base class implemented by User Application Developers.
  * The callbacks defined in this class allow the User Application
@@ -155,6 +178,22 @@ class LampManagerCallback {
      */
     virtual void GetLampStateReplyCB(const LSFResponseCode& responseCode, const LSFString& lampID, const LampState& lampState) { }
 
+    /**
+     * Indicates that a reply has been received for the GetAllLampStates method call
+     *
+     * @param responseCode    The response code
+     * @param lampStates      Map of Lamp ID to Lamp State
+     */
+    virtual void GetAllLampStatesReplyCB(const LSFResponseCode& responseCode, const LampStateMap& lampStates) { }
+
+    /**
+     * Indicates that a reply has been received for the GetLampStates method call
+     *
+     * @param responseCode    The response code
+     * @param lampStates      Map of Lamp ID to Lamp State
+     */
+    virtual void GetLampStatesReplyCB(const LSFResponseCode& responseCode, const LampStateMap& lampStates) { }
+
     /**
      * Indicates that a reply has been received for the GetLampStateOnOffField method call
      *
@@ -216,6 +255,21 @@ class LampManagerCallback {
      */
     virtual void LampStateChangedCB(const LSFString& lampID, const LampState& lampState) { }
 
+    /**
+     *  Indicates that the signal LampsStateChanged has been received. \n
+     *  A Controller Service that sends it aggregates the state changes of a
+     *  short window into one signal, and the LampStateChanged signals it also
+     *  sends for older apps are not delivered. By default, LampStateChangedCB
+     *  is invoked for each lamp
+     *
+     *  @param lampStates  The new state of each lamp
+     */
+    virtual void LampsStateChangedCB(const LampStateMap& lampStates) {
+        for (LampStateMap::const_iterator it = lampStates.begin(); it != lampStates.end(); ++it) {
+            LampStateChangedCB(it->first, it->second);
+        }
+    }
+
     /**
      * Indicates that a reply has been received for the TransitionLampState method call
      *
@@ -224,6 +278,13 @@ class LampManagerCallback {
      */
     virtual void TransitionLampStateReplyCB(const LSFResponseCode& responseCode, const LSFString& lampID) { }
 
+    /**
+     * Indicates that a reply has been received for the TransitionLampsToStates method call
+     *
+     * @param responseCode    The aggregated response code for all the lamps in the batch
+     */
+    virtual void TransitionLampsToStatesReplyCB(const LSFResponseCode& responseCode) { }
+
     /**
      * Indicates that a reply has been received for the PulseLampWithState method call
      *
@@ -484,6 +545,25 @@ class LampManager : public Manager {
      */
     ControllerClientStatus GetLampState(const LSFString& lampID);
 
+    /**
+     * Get the full state of all the Lamps in a single reply \n
+     * Calling interface org.allseen.LSF.ControllerService.Lamp  method GetAllLampStates. \n
+     * Response in LampManagerCallback::GetAllLampStatesReplyCB
+     *
+     * @return ControllerClientStatus
+     */
+    ControllerClientStatus GetAllLampStates(void);
+
+    /**
+     * Get the full state of the given Lamps in a single reply \n
+     * Calling interface org.allseen.LSF.ControllerService.Lamp  method GetLampStates. \n
+     * Response in LampManagerCallback::GetLampStatesReplyCB
+     *
+     * @param lampIDs   The Lamp ids
+     * @return ControllerClientStatus
+     */
+    ControllerClientStatus GetLampStates(const LSFStringList& lampIDs);
+
     /**
      * Get the Lamp's state param - OnOff field \n
      * align interface org.allseen.LSF.ControllerService.Lamp  method GetLampStateField \n
@@ -629,6 +709,17 @@ class LampManager : public Manager {
      */
     ControllerClientStatus TransitionLampState(const LSFString& lampID, const LampState& lampState, const uint32_t& transitionPeriod = 0);
 
+    /**
+     * Transition each Lamp in the list to its own state in a single call \n
+     * Calling to interface 'org.allseen.LSF.ControllerService.Lamp' to function 'TransitionLampsToStates' \n
+     * All the transitions are started with the same timestamp and the Controller Service
+     * replies once with the aggregated result. \n
+     * Response in LampManagerCallback::TransitionLampsToStatesReplyCB
+     * @param transitions - list of lamp ID, target state and transition period
+     * @return ControllerClientStatus
+     */
+    ControllerClientStatus TransitionLampsToStates(const LampTransitionList& transitions);
+
     /**
      * Transition the Lamp to a given state \n
      * Response in LampManagerCallback::PulseLampWithStateReplyCB \n
@@ -802,6 +893,10 @@ class LampManager : public Manager {
         callback.LampStateChangedCB(id, state);
     }
 
+    void LampsStateChanged(LampStateMap& states) {
+        callback.LampsStateChangedCB(states);
+    }
+
     void LampsFound(LSFStringList& idList) {
         callback.LampsFoundCB(idList);
     }
@@ -828,6 +923,8 @@ class LampManager : public Manager {
     }
 
     void GetLampStateReply(ajn::Message& message);
+    void GetAllLampStatesReply(ajn::Message& message);
+    void GetLampStatesReply(ajn::Message& message);
     void GetLampStateFieldReply(ajn::Message& message);
 
     void ResetLampStateReply(LSFResponseCode& responseCode, LSFString& lsfId) {
@@ -840,6 +937,8 @@ class LampManager : public Manager {
         callback.TransitionLampStateReplyCB(responseCode, lsfId);
     }
 
+    void TransitionLampsToStatesReply(ajn::Message& message);
+
     void PulseLampWithStateReply(LSFResponseCode& responseCode, LSFString& lsfId) {
         callback.PulseLampWithStateReplyCB(responseCode, lsfId);
     }
@@ -98,6 +98,15 @@ class MasterSceneManagerCallback {
      */
     virtual void GetMasterSceneReplyCB(const LSFResponseCode& responseCode, const LSFString& masterSceneID, const MasterScene& masterScene) { }
 
+    /**
+     * Response to MasterSceneManager::GetAllMasterScenes
+     *
+     * @param responseCode    The response code
+     * @param language    The language of the masterScene names
+     * @param masterScenes    All the masterScenes keyed by id, with their names
+     */
+    virtual void GetAllMasterScenesReplyCB(const LSFResponseCode& responseCode, const LSFString& language, const MasterSceneMap& masterScenes) { }
+
     /**
      * Response to MasterSceneManager::DeleteMasterScene
      *
@@ -207,6 +216,14 @@ class MasterSceneManager : public Manager {
      */
     ControllerClientStatus GetMasterScene(const LSFString& masterSceneID);
 
+    /**
+     * Get the name and information of every masterScene in a single call. \n
+     * Response in MasterSceneManagerCallback::GetAllMasterScenesReplyCB
+     *
+     * @param language    The language of the masterScene names
+     */
+    ControllerClientStatus GetAllMasterScenes(const LSFString& language = LSFString("en"));
+
     /**
      * Delete a Lamp masterScene. \n
      * Response in MasterSceneManagerCallback::DeleteMasterSceneReplyCB
@@ -282,6 +299,8 @@ class MasterSceneManager : public Manager {
 
     void GetMasterSceneReply(ajn::Message& message);
 
+    void GetAllMasterScenesReply(ajn::Message& message);
+
     void DeleteMasterSceneReply(LSFResponseCode& responseCode, LSFString& lsfId) {
         callback.DeleteMasterSceneReplyCB(responseCode, lsfId);
     }
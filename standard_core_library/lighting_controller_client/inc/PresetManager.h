@@ -55,6 +55,16 @@ class PresetManagerCallback {
      */
     virtual void GetPresetReplyCB(const LSFResponseCode& responseCode, const LSFString& presetID, const LampState& preset) { }
 
+    /**
+     * Response to PresetManager::GetAllPresets. \n
+     * response code LSF_OK on success. \n
+     * @param responseCode    The return code
+     * @param language    The language of the pre-set names
+     * @param presets    All the pre-sets keyed by id, with their names
+     *
+     */
+    virtual void GetAllPresetsReplyCB(const LSFResponseCode& responseCode, const LSFString& language, const PresetMap& presets) { }
+
     /**
      * Response to PresetManager::GetAllPresetIDs. \n
      * response code LSF_OK on success. \n
@@ -196,6 +206,14 @@ class PresetManager : public Manager {
      */
     ControllerClientStatus GetPreset(const LSFString& presetID);
 
+    /**
+     * Get the name and state of every pre-set in a single call. \n
+     * Response in PresetManagerCallback::GetAllPresetsReplyCB. \n
+     * @param language type LSFString which is the language of the pre-set names. \n
+     * @return CONTROLLER_CLIENT_OK on success to send the request. \n
+     */
+    ControllerClientStatus GetAllPresets(const LSFString& language = LSFString("en"));
+
     /**
      * Get the name of a Preset. \n
      * Response in PresetManagerCallback::GetPresetNameReplyCB. \n
@@ -312,6 +330,8 @@ class PresetManager : public Manager {
 
     void GetPresetReply(ajn::Message& message);
 
+    void GetAllPresetsReply(ajn::Message& message);
+
     void GetPresetNameReply(LSFResponseCode& responseCode, LSFString& lsfId, LSFString& language, LSFString& lsfName) {
         callback.GetPresetNameReplyCB(responseCode, lsfId, language, lsfName);
     }
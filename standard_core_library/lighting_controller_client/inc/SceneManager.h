@@ -143,6 +143,17 @@ class SceneManagerCallback {
      */
     virtual void GetSceneReplyCB(const LSFResponseCode& responseCode, const LSFString& sceneID, const Scene& data) { }
 
+    /**
+     * Response to SceneManager::GetAllScenes.
+     *
+     * @param responseCode    The response code: \n
+     *  return LSF_OK \n
+     *  return LSF_ERR_INVALID_ARGS - language not supported \n
+     * @param language    The language of the scene names
+     * @param scenes  All the scenes keyed by id, with their names
+     */
+    virtual void GetAllScenesReplyCB(const LSFResponseCode& responseCode, const LSFString& language, const SceneMap& scenes) { }
+
     /**
      * Response to SceneManager::ApplyScene.
      *
@@ -237,6 +248,14 @@ class SceneManager : public Manager {
      */
     ControllerClientStatus GetScene(const LSFString& sceneID);
 
+    /**
+     * Get the name and data of every scene in a single call. \n
+     * Response in SceneManagerCallback::GetAllScenesReplyCB
+     *
+     * @param language    The language of the scene names
+     */
+    ControllerClientStatus GetAllScenes(const LSFString& language = LSFString("en"));
+
     /**
      * Apply a scene. \n
      * Activate an already created scene. Make it happen. \n
@@ -285,6 +304,8 @@ class SceneManager : public Manager {
 
     void GetSceneReply(ajn::Message& message);
 
+    void GetAllScenesReply(ajn::Message& message);
+
     void ApplySceneReply(LSFResponseCode& responseCode, LSFString& lsfId) {
         callback.ApplySceneReplyCB(responseCode, lsfId);
     }
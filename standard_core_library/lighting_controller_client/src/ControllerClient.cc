@@ -15,6 +15,7 @@
  ******************************************************************************/
 
 #include <algorithm>
+#include <vector>
 
 #include <alljoyn/about/AnnounceHandler.h>
 #include <alljoyn/about/AnnouncementRegistrar.h>
@@ -23,6 +24,7 @@
 
 #include <ControllerClient.h>
 #include <AllJoynStd.h>
+#include <Trace.h>
 
 using namespace qcc;
 using namespace ajn;
@@ -222,12 +224,38 @@ void ControllerClient::ControllerClientBusHandler::Announce(
                        busName, port, deviceID, deviceName, rank.c_str(), isLeader));
         if (isLeader) {
             controllerClient.OnAnnounced(port, busName, deviceID, deviceName, rank);
+        } else if (controllerClient.readReplicaMaxStaleness) {
+            controllerClient.OnReadReplicaAnnounced(port, busName, deviceID, deviceName, rank);
         } else {
             QCC_DbgPrintf(("%s: Received a non-leader announcement", __func__));
         }
     }
 }
 
+/*
+ * Method calls that a read replica serves
+ */
+static const char* readReplicaMethods[] =
+{
+    "GetAllLampGroupIDs",
+    "GetLampGroupName",
+    "GetLampGroup",
+    "GetAllLampGroups",
+    "GetDefaultLampState",
+    "GetAllPresetIDs",
+    "GetPresetName",
+    "GetPreset",
+    "GetAllPresets",
+    "GetAllSceneIDs",
+    "GetSceneName",
+    "GetScene",
+    "GetAllScenes",
+    "GetAllMasterSceneIDs",
+    "GetMasterSceneName",
+    "GetMasterScene",
+    "GetAllMasterScenes"
+};
+
 static const char* interfaces[] =
 {
     ControllerServiceInterfaceName,
@@ -252,8 +280,11 @@ ControllerClient::ControllerClient(
     presetManagerPtr(NULL),
     sceneManagerPtr(NULL),
     masterSceneManagerPtr(NULL),
+    lampsStateChangedReceived(false),
     stopped(true),
-    timeStopped(0)
+    timeStopped(0),
+    readReplicaMaxStaleness(0),
+    nextReadTarget(0)
 {
     currentLeader.Clear();
     bus.RegisterBusListener(*busHandler);
@@ -410,6 +441,10 @@ void ControllerClient::OnSessionLost(ajn::SessionId sessionID)
 {
     QCC_DbgPrintf(("OnSessionLost(%u)\n", sessionID));
 
+    if (OnReadReplicaSessionLost(sessionID)) {
+        return;
+    }
+
     LSFString deviceName;
     LSFString deviceID;
     Rank currentLeaderRank;
@@ -524,6 +559,11 @@ void ControllerClient::StateChangedSignalDispatcher(const ajn::InterfaceDescript
         return;
     }
 
+    if (lampsStateChangedReceived && (0 == strcmp(message->GetMemberName(), "LampStateChanged"))) {
+        QCC_DbgPrintf(("%s: The state change was received in a LampsStateChanged signal", __func__));
+        return;
+    }
+
     StateChangedSignalDispatcherMap::iterator it = stateChangedSignalHandlers.find(message->GetMemberName());
     if (it != stateChangedSignalHandlers.end()) {
         StateChangedSignalHandlerBase* handler = it->second;
@@ -547,6 +587,38 @@ void ControllerClient::StateChangedSignalDispatcher(const ajn::InterfaceDescript
     }
 }
 
+void ControllerClient::LampStatesSignalDispatcher(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& message)
+{
+    bus.EnableConcurrentCallbacks();
+
+    QCC_DbgPrintf(("%s: Received Signal %s", __func__, message->GetMemberName()));
+
+    if (stopped) {
+        QCC_DbgPrintf(("%s: Controller Client stopped", __func__));
+        return;
+    }
+
+    lampsStateChangedReceived = true;
+
+    LampStatesSignalDispatcherMap::iterator it = lampStatesSignalHandlers.find(message->GetMemberName());
+    if (it != lampStatesSignalHandlers.end()) {
+        LampStatesSignalHandlerBase* handler = it->second;
+
+        size_t numInputArgs;
+        const MsgArg* inputArgs;
+        message->GetArgs(numInputArgs, inputArgs);
+
+        if (CheckNumArgsInMessage(numInputArgs, 1) != LSF_OK) {
+            return;
+        }
+
+        LampStateMap states;
+        CreateLampStateMap(states, inputArgs[0]);
+
+        handler->Handle(states);
+    }
+}
+
 void ControllerClient::SignalWithoutArgDispatcher(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& message)
 {
     bus.EnableConcurrentCallbacks();
@@ -575,6 +647,12 @@ void ControllerClient::OnSessionJoined(QStatus status, ajn::SessionId sessionId,
 
     ControllerEntry* joined = static_cast<ControllerEntry*>(context);
 
+    if (joined && joined->readReplica) {
+        OnReadReplicaSessionJoined(status, sessionId, *joined);
+        delete joined;
+        return;
+    }
+
     LSFString deviceName;
     deviceName.clear();
 
@@ -672,6 +750,16 @@ void ControllerClient::OnAnnounced(SessionPort port, const char* busName, const
     entry.rank = rank;
     entry.busName = busName;
     entry.announcementTimestamp = GetTimestampInMs();
+    entry.readReplica = false;
+
+    /*
+     * The leader serves the reads itself
+     */
+    readReplicasLock.Lock();
+    if (readReplicasMap.find(rank) != readReplicasMap.end()) {
+        RemoveReadReplica(rank);
+    }
+    readReplicasLock.Unlock();
 
     currentLeaderLock.Lock();
     // if the name of the current CS has changed...
@@ -719,6 +807,268 @@ void ControllerClient::OnAnnounced(SessionPort port, const char* busName, const
     }
 }
 
+void ControllerClient::SetReadReplicaMaxStaleness(uint32_t maxStaleness)
+{
+    QCC_DbgPrintf(("%s: maxStaleness=%u", __func__, maxStaleness));
+    readReplicaMaxStaleness = maxStaleness;
+
+    if (!maxStaleness) {
+        readReplicasLock.Lock();
+        while (!readReplicasMap.empty()) {
+            RemoveReadReplica(readReplicasMap.begin()->first);
+        }
+        readReplicasLock.Unlock();
+    }
+}
+
+void ControllerClient::OnReadReplicaAnnounced(SessionPort port, const char* busName, const char* deviceID, const char* deviceName, Rank rank)
+{
+    QCC_DbgPrintf(("%s: port=%u, busName=%s, deviceID=%s, deviceName=%s, rank=%s", __func__, port, busName, deviceID, deviceName, rank.c_str()));
+
+    if (stopped) {
+        QCC_DbgPrintf(("%s: Controller Client is stopped. Returning without processing announcement.", __func__));
+        return;
+    }
+
+    ControllerEntry entry;
+    entry.port = port;
+    entry.deviceID = deviceID;
+    entry.deviceName = deviceName;
+    entry.rank = rank;
+    entry.busName = busName;
+    entry.announcementTimestamp = GetTimestampInMs();
+    entry.readReplica = true;
+
+    readReplicasLock.Lock();
+    ReadReplicas::iterator it = readReplicasMap.find(rank);
+    if (it != readReplicasMap.end()) {
+        if (it->second.controllerDetails.busName == entry.busName) {
+            it->second.controllerDetails.deviceName = entry.deviceName;
+            readReplicasLock.Unlock();
+            return;
+        }
+        QCC_DbgPrintf(("%s: Read replica %s restarted", __func__, rank.c_str()));
+        RemoveReadReplica(rank);
+    }
+
+    ReadReplica& replica = readReplicasMap[rank];
+    replica.controllerDetails = entry;
+    replica.sessionId = 0;
+    replica.staleness = ReadReplicaUnsynchronized;
+    replica.stalenessTimestamp = 0;
+    replica.stalenessQueried = false;
+
+    ControllerEntry* context = new ControllerEntry;
+    *context = entry;
+
+    /*
+     * Reads go over a point-to-point session. The signals keep coming
+     * from the multipoint session with the leader
+     */
+    SessionOpts opts;
+    opts.isMultipoint = false;
+    QStatus status = bus.JoinSessionAsync(entry.busName.c_str(), entry.port, busHandler, opts, busHandler, context);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: JoinSessionAsync with read replica failed", __func__));
+        delete context;
+        readReplicasMap.erase(rank);
+    }
+    readReplicasLock.Unlock();
+}
+
+void ControllerClient::OnReadReplicaSessionJoined(QStatus status, ajn::SessionId sessionId, const ControllerEntry& joined)
+{
+    QCC_DbgPrintf(("%s: sessionId= %u status=%s rank=%s\n", __func__, sessionId, QCC_StatusText(status), joined.rank.c_str()));
+
+    bool leaveSession = (status == ER_OK);
+
+    readReplicasLock.Lock();
+    ReadReplicas::iterator it = readReplicasMap.find(joined.rank);
+    if ((it != readReplicasMap.end()) && (it->second.controllerDetails.announcementTimestamp == joined.announcementTimestamp)) {
+        if (status == ER_OK) {
+            it->second.proxyObject = ProxyBusObject(bus, joined.busName.c_str(), ControllerServiceObjectPath, sessionId);
+            status = it->second.proxyObject.IntrospectRemoteObject();
+            if (status == ER_OK) {
+                it->second.sessionId = sessionId;
+                leaveSession = false;
+                QueryReadReplicaStaleness(joined.rank);
+            } else {
+                QCC_LogError(status, ("%s: IntrospectRemoteObject failed", __func__));
+            }
+        }
+
+        if (status != ER_OK) {
+            readReplicasMap.erase(it);
+        }
+    }
+    readReplicasLock.Unlock();
+
+    if (leaveSession) {
+        DoLeaveSessionAsync(sessionId);
+    }
+}
+
+bool ControllerClient::OnReadReplicaSessionLost(ajn::SessionId sessionId)
+{
+    bool found = false;
+
+    readReplicasLock.Lock();
+    for (ReadReplicas::iterator it = readReplicasMap.begin(); it != readReplicasMap.end(); ++it) {
+        if (it->second.sessionId == sessionId) {
+            QCC_DbgPrintf(("%s: Lost read replica %s", __func__, it->first.c_str()));
+            readReplicasMap.erase(it);
+            found = true;
+            break;
+        }
+    }
+    readReplicasLock.Unlock();
+
+    return found;
+}
+
+void ControllerClient::RemoveReadReplica(const Rank& rank)
+{
+    ReadReplicas::iterator it = readReplicasMap.find(rank);
+    if (it != readReplicasMap.end()) {
+        QCC_DbgPrintf(("%s: Removing read replica %s", __func__, rank.c_str()));
+        if (it->second.sessionId) {
+            DoLeaveSessionAsync(it->second.sessionId);
+        }
+        readReplicasMap.erase(it);
+    }
+}
+
+void ControllerClient::QueryReadReplicaStaleness(const Rank& rank)
+{
+    ReadReplicas::iterator it = readReplicasMap.find(rank);
+    if ((it == readReplicasMap.end()) || !it->second.sessionId || it->second.stalenessQueried) {
+        return;
+    }
+
+    ControllerEntry* context = new ControllerEntry;
+    *context = it->second.controllerDetails;
+
+    QStatus status = it->second.proxyObject.MethodCallAsync(
+        ControllerServiceInterfaceName,
+        "GetReadReplicaStaleness",
+        this,
+        static_cast<ajn::MessageReceiver::ReplyHandler>(&ControllerClient::OnReadReplicaStalenessReply),
+        NULL,
+        0,
+        context);
+    if (status == ER_OK) {
+        it->second.stalenessQueried = true;
+    } else {
+        /*
+         * A Controller Service that predates the read replicas; do not ask again before the next refresh
+         */
+        QCC_LogError(status, ("%s: GetReadReplicaStaleness method call failed", __func__));
+        it->second.staleness = ReadReplicaUnsynchronized;
+        it->second.stalenessTimestamp = GetTimestampInMs();
+        delete context;
+    }
+}
+
+void ControllerClient::OnReadReplicaStalenessReply(ajn::Message& message, void* context)
+{
+    bus.EnableConcurrentCallbacks();
+
+    ControllerEntry* replicaDetails = static_cast<ControllerEntry*>(context);
+    uint32_t staleness = ReadReplicaUnsynchronized;
+    bool found = false;
+
+    QCC_DbgPrintf(("%s: Method Reply for GetReadReplicaStaleness:%s", __func__, (MESSAGE_METHOD_RET == message->GetType()) ? message->ToString().c_str() : "ERROR"));
+
+    if (message->GetType() == ajn::MESSAGE_METHOD_RET) {
+        size_t numInputArgs;
+        const MsgArg* inputArgs;
+        message->GetArgs(numInputArgs, inputArgs);
+
+        if (CheckNumArgsInMessage(numInputArgs, 3) == LSF_OK) {
+            LSFResponseCode responseCode;
+            bool isLeader;
+            inputArgs[0].Get("u", &responseCode);
+            inputArgs[1].Get("b", &isLeader);
+            if (responseCode == LSF_OK) {
+                inputArgs[2].Get("u", &staleness);
+            }
+        }
+    }
+
+    readReplicasLock.Lock();
+    ReadReplicas::iterator it = readReplicasMap.find(replicaDetails->rank);
+    if ((it != readReplicasMap.end()) && (it->second.controllerDetails.announcementTimestamp == replicaDetails->announcementTimestamp)) {
+        it->second.staleness = staleness;
+        it->second.stalenessTimestamp = GetTimestampInMs();
+        it->second.stalenessQueried = false;
+        found = true;
+    }
+    readReplicasLock.Unlock();
+
+    if (found && !stopped) {
+        QCC_DbgPrintf(("%s: calling to ReadReplicaStalenessCB(%s,%s,%u)\n", __func__, replicaDetails->deviceID.c_str(), replicaDetails->deviceName.c_str(), staleness));
+        callback.ReadReplicaStalenessCB(replicaDetails->deviceID, replicaDetails->deviceName, staleness);
+    }
+
+    delete replicaDetails;
+}
+
+bool ControllerClient::GetReadReplicaProxy(const char* methodName, ajn::ProxyBusObject& proxy)
+{
+    uint32_t maxStaleness = readReplicaMaxStaleness;
+    if (!maxStaleness) {
+        return false;
+    }
+
+    bool readOnly = false;
+    for (size_t i = 0; i < (sizeof(readReplicaMethods) / sizeof(readReplicaMethods[0])); i++) {
+        if (0 == strcmp(methodName, readReplicaMethods[i])) {
+            readOnly = true;
+            break;
+        }
+    }
+    if (!readOnly) {
+        return false;
+    }
+
+    bool found = false;
+    uint64_t now = GetTimestampInMs();
+    std::vector<ReadReplicas::iterator> targets;
+
+    readReplicasLock.Lock();
+    for (ReadReplicas::iterator it = readReplicasMap.begin(); it != readReplicasMap.end(); ++it) {
+        ReadReplica& replica = it->second;
+        if (!replica.sessionId) {
+            continue;
+        }
+
+        uint64_t reportAge = now - replica.stalenessTimestamp;
+        if (!replica.stalenessTimestamp || (reportAge > READ_REPLICA_STALENESS_REFRESH_MS)) {
+            QueryReadReplicaStaleness(it->first);
+        }
+
+        /*
+         * Keep using a report that is due for a refresh until the refresh is late
+         */
+        if (replica.stalenessTimestamp && (reportAge <= (2 * READ_REPLICA_STALENESS_REFRESH_MS)) && (replica.staleness <= maxStaleness)) {
+            targets.push_back(it);
+        }
+    }
+
+    /*
+     * The leader takes its turn after the read replicas
+     */
+    uint32_t target = nextReadTarget++ % (targets.size() + 1);
+    if (target < targets.size()) {
+        proxy = targets[target]->second.proxyObject;
+        found = true;
+        QCC_DbgPrintf(("%s: Sending %s to read replica %s", __func__, methodName, targets[target]->first.c_str()));
+    }
+    readReplicasLock.Unlock();
+
+    return found;
+}
+
 ControllerClientStatus ControllerClient::MethodCallAsyncHelper(
     const char* ifaceName,
     const char* methodName,
@@ -729,6 +1079,24 @@ ControllerClientStatus ControllerClient::MethodCallAsyncHelper(
     void* context)
 {
     ControllerClientStatus status = CONTROLLER_CLIENT_OK;
+    TraceSpan traceSpan(methodName);
+
+    ProxyBusObject replica;
+    if (GetReadReplicaProxy(methodName, replica)) {
+        QStatus ajStatus = replica.MethodCallAsync(
+            ifaceName,
+            methodName,
+            handler,
+            callback,
+            args,
+            numArgs,
+            context);
+        if (ajStatus == ER_OK) {
+            return status;
+        }
+        QCC_LogError(ajStatus, ("%s method call to read replica failed. Calling the leader", methodName));
+    }
+
     currentLeaderLock.Lock();
 
     if (currentLeader.sessionId) {
@@ -1159,6 +1527,12 @@ ControllerClientStatus ControllerClient::Stop(void)
     leadersMap.clear();
     leadersMapLock.Unlock();
 
+    readReplicasLock.Lock();
+    while (!readReplicasMap.empty()) {
+        RemoveReadReplica(readReplicasMap.begin()->first);
+    }
+    readReplicasLock.Unlock();
+
     ControllerClientStatus clientStatus = CONTROLLER_CLIENT_OK;
     QStatus status = services::AnnouncementRegistrar::UnRegisterAnnounceHandler(bus, *busHandler, interfaces, sizeof(interfaces) / sizeof(interfaces[0]));
     QCC_DbgPrintf(("%s: UnRegisterAnnounceHandler: %s\n", __func__, QCC_StatusText(status)));
@@ -1181,6 +1555,7 @@ void ControllerClient::AddMethodHandlers()
     if (lampManagerPtr) {
         AddNameChangedSignalHandler("LampNameChanged", lampManagerPtr, &LampManager::LampNameChanged);
         AddStateChangedSignalHandler("LampStateChanged", lampManagerPtr, &LampManager::LampStateChanged);
+        AddLampStatesSignalHandler("LampsStateChanged", lampManagerPtr, &LampManager::LampsStateChanged);
         AddSignalHandler("LampsFound", lampManagerPtr, &LampManager::LampsFound);
         AddSignalHandler("LampsLost", lampManagerPtr, &LampManager::LampsLost);
 
@@ -1293,6 +1668,7 @@ void ControllerClient::AddSignalHandlers()
         { controllerServiceInterface->GetMember("ControllerServiceLightingReset"), static_cast<MessageReceiver::SignalHandler>(&ControllerClient::SignalWithoutArgDispatcher) },
         { controllerServiceLampInterface->GetMember("LampNameChanged"), static_cast<MessageReceiver::SignalHandler>(&ControllerClient::NameChangedSignalDispatcher) },
         { controllerServiceLampInterface->GetMember("LampStateChanged"), static_cast<MessageReceiver::SignalHandler>(&ControllerClient::StateChangedSignalDispatcher) },
+        { controllerServiceLampInterface->GetMember("LampsStateChanged"), static_cast<MessageReceiver::SignalHandler>(&ControllerClient::LampStatesSignalDispatcher) },
         { controllerServiceLampInterface->GetMember("LampsFound"), static_cast<MessageReceiver::SignalHandler>(&ControllerClient::SignalWithArgDispatcher) },
         { controllerServiceLampInterface->GetMember("LampsLost"), static_cast<MessageReceiver::SignalHandler>(&ControllerClient::SignalWithArgDispatcher) },
         { controllerServiceLampGroupInterface->GetMember("LampGroupsNameChanged"), static_cast<MessageReceiver::SignalHandler>(&ControllerClient::SignalWithArgDispatcher) },
@@ -1319,7 +1695,18 @@ void ControllerClient::AddSignalHandlers()
     // must call UnregisterAllHandlers in order to prevent multiple registrations for the same signal
     bus.UnregisterAllHandlers(this);
 
+    /*
+     * Until this leader sends a LampsStateChanged signal, it may be one that only sends LampStateChanged
+     */
+    lampsStateChangedReceived = false;
+
     for (size_t i = 0; i < (sizeof(signalEntries) / sizeof(SignalEntry)); ++i) {
+        /*
+         * A leader with an older Lamp interface does not have the newer signals
+         */
+        if (!signalEntries[i].member) {
+            continue;
+        }
         bus.RegisterSignalHandler(
             this,
             signalEntries[i].handler,
@@ -1334,6 +1721,7 @@ void ControllerClient::RemoveSignalHandlers()
     DeleteNoArgSignalHandlers();
     DeleteNameChangedSignalHandlers();
     DeleteStateChangedSignalHandlers();
+    DeleteLampStatesSignalHandlers();
 }
 
 LSFResponseCode ControllerClient::CheckNumArgsInMessage(uint32_t receivedNumArgs, uint32_t expectedNumArgs)
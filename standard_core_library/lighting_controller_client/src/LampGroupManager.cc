@@ -132,6 +132,50 @@ void LampGroupManager::GetLampGroupReply(Message& message)
     callback.GetLampGroupReplyCB(responseCode, lampGroupID, lampGroup);
 }
 
+ControllerClientStatus LampGroupManager::GetAllLampGroups(const LSFString& language)
+{
+    QCC_DbgPrintf(("%s: language=%s", __func__, language.c_str()));
+    MsgArg arg;
+    arg.Set("s", language.c_str());
+
+    return controllerClient.MethodCallAsync(
+               ControllerServiceLampGroupInterfaceName,
+               "GetAllLampGroups",
+               this,
+               &LampGroupManager::GetAllLampGroupsReply,
+               &arg,
+               1);
+}
+
+void LampGroupManager::GetAllLampGroupsReply(Message& message)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerClient.CheckNumArgsInMessage(numArgs, 3) != LSF_OK) {
+        return;
+    }
+
+    LSFResponseCode responseCode = static_cast<LSFResponseCode>(args[0].v_uint32);
+    LSFString language = static_cast<LSFString>(args[1].v_string.str);
+
+    LampGroupMap lampGroups;
+    size_t numLampGroups;
+    MsgArg* lampGroupArray;
+    args[2].Get("a(ssasas)", &numLampGroups, &lampGroupArray);
+    for (size_t i = 0; i < numLampGroups; i++) {
+        const MsgArg* members = lampGroupArray[i].v_struct.members;
+        LSFString lampGroupID = static_cast<LSFString>(members[0].v_string.str);
+        LSFString lampGroupName = static_cast<LSFString>(members[1].v_string.str);
+        LampGroup lampGroup(members[2], members[3]);
+        lampGroups.insert(std::make_pair(lampGroupID, std::make_pair(lampGroupName, lampGroup)));
+    }
+
+    callback.GetAllLampGroupsReplyCB(responseCode, language, lampGroups);
+}
+
 ControllerClientStatus LampGroupManager::DeleteLampGroup(const LSFString& lampGroupID)
 {
     QCC_DbgPrintf(("%s: lampGroupID=%s", __func__, lampGroupID.c_str()));
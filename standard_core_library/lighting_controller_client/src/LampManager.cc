@@ -188,6 +188,82 @@ void LampManager::GetLampStateReply(Message& message)
     callback.GetLampStateReplyCB(responseCode, lampID, state);
 }
 
+ControllerClientStatus LampManager::GetAllLampStates(void)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    return controllerClient.MethodCallAsync(
+               ControllerServiceLampInterfaceName,
+               "GetAllLampStates",
+               this,
+               &LampManager::GetAllLampStatesReply);
+}
+
+void LampManager::GetAllLampStatesReply(Message& message)
+{
+    QCC_DbgPrintf(("%s: Method Reply %s", __func__, (MESSAGE_METHOD_RET == message->GetType()) ? message->ToString().c_str() : "ERROR"));
+
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerClient.CheckNumArgsInMessage(numArgs, 2) != LSF_OK) {
+        return;
+    }
+
+    LSFResponseCode responseCode = static_cast<LSFResponseCode>(args[0].v_uint32);
+    LampStateMap lampStates;
+    CreateLampStateMap(lampStates, args[1]);
+
+    callback.GetAllLampStatesReplyCB(responseCode, lampStates);
+}
+
+ControllerClientStatus LampManager::GetLampStates(const LSFStringList& lampIDs)
+{
+    QCC_DbgPrintf(("%s", __func__));
+
+    MsgArg arg;
+    size_t idsVecSize = lampIDs.size();
+    if (idsVecSize) {
+        const char** idsVec = new const char*[idsVecSize];
+        size_t i = 0;
+        for (LSFStringList::const_iterator it = lampIDs.begin(); it != lampIDs.end(); it++) {
+            idsVec[i++] = it->c_str();
+        }
+        arg.Set("as", idsVecSize, idsVec);
+        delete [] idsVec;
+        arg.SetOwnershipFlags(MsgArg::OwnsArgs);
+    } else {
+        arg.Set("as", 0, NULL);
+    }
+
+    return controllerClient.MethodCallAsync(
+               ControllerServiceLampInterfaceName,
+               "GetLampStates",
+               this,
+               &LampManager::GetLampStatesReply,
+               &arg,
+               1);
+}
+
+void LampManager::GetLampStatesReply(Message& message)
+{
+    QCC_DbgPrintf(("%s: Method Reply %s", __func__, (MESSAGE_METHOD_RET == message->GetType()) ? message->ToString().c_str() : "ERROR"));
+
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerClient.CheckNumArgsInMessage(numArgs, 2) != LSF_OK) {
+        return;
+    }
+
+    LSFResponseCode responseCode = static_cast<LSFResponseCode>(args[0].v_uint32);
+    LampStateMap lampStates;
+    CreateLampStateMap(lampStates, args[1]);
+
+    callback.GetLampStatesReplyCB(responseCode, lampStates);
+}
+
 ControllerClientStatus LampManager::ResetLampState(const LSFString& lampID)
 {
     QCC_DbgPrintf(("\n%s: %s\n", __func__, lampID.c_str()));
@@ -221,6 +297,55 @@ ControllerClientStatus LampManager::TransitionLampState(
                3);
 }
 
+ControllerClientStatus LampManager::TransitionLampsToStates(const LampTransitionList& transitions)
+{
+    QCC_DbgPrintf(("%s", __func__));
+
+    MsgArg arg;
+    size_t numTransitions = transitions.size();
+    if (numTransitions) {
+        MsgArg* transitionArgs = new MsgArg[numTransitions];
+        size_t i = 0;
+        for (LampTransitionList::const_iterator it = transitions.begin(); it != transitions.end(); it++, i++) {
+            MsgArg state;
+            it->state.Get(&state);
+            MsgArg* stateArgs;
+            size_t stateArgsSize;
+            state.Get("a{sv}", &stateArgsSize, &stateArgs);
+            transitionArgs[i].Set("(sa{sv}u)", it->lampID.c_str(), stateArgsSize, stateArgs, it->transitionPeriod);
+            transitionArgs[i].SetOwnershipFlags(MsgArg::OwnsArgs, true);
+        }
+        arg.Set("a(sa{sv}u)", numTransitions, transitionArgs);
+        arg.SetOwnershipFlags(MsgArg::OwnsArgs, true);
+    } else {
+        arg.Set("a(sa{sv}u)", 0, NULL);
+    }
+
+    return controllerClient.MethodCallAsync(
+               ControllerServiceLampInterfaceName,
+               "TransitionLampsToStates",
+               this,
+               &LampManager::TransitionLampsToStatesReply,
+               &arg,
+               1);
+}
+
+void LampManager::TransitionLampsToStatesReply(Message& message)
+{
+    QCC_DbgPrintf(("%s: Method Reply %s", __func__, (MESSAGE_METHOD_RET == message->GetType()) ? message->ToString().c_str() : "ERROR"));
+
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerClient.CheckNumArgsInMessage(numArgs, 1) != LSF_OK) {
+        return;
+    }
+
+    LSFResponseCode responseCode = static_cast<LSFResponseCode>(args[0].v_uint32);
+    callback.TransitionLampsToStatesReplyCB(responseCode);
+}
+
 ControllerClientStatus LampManager::PulseLampWithState(
     const LSFString& lampID,
     const LampState& toLampState,
@@ -133,6 +133,50 @@ void MasterSceneManager::GetMasterSceneReply(Message& message)
     callback.GetMasterSceneReplyCB(responseCode, masterSceneID, masterScene);
 }
 
+ControllerClientStatus MasterSceneManager::GetAllMasterScenes(const LSFString& language)
+{
+    QCC_DbgPrintf(("%s: language=%s", __func__, language.c_str()));
+    MsgArg arg;
+    arg.Set("s", language.c_str());
+
+    return controllerClient.MethodCallAsync(
+               ControllerServiceMasterSceneInterfaceName,
+               "GetAllMasterScenes",
+               this,
+               &MasterSceneManager::GetAllMasterScenesReply,
+               &arg,
+               1);
+}
+
+void MasterSceneManager::GetAllMasterScenesReply(Message& message)
+{
+    QCC_DbgPrintf(("%s: Method Reply %s", __func__, (MESSAGE_METHOD_RET == message->GetType()) ? message->ToString().c_str() : "ERROR"));
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerClient.CheckNumArgsInMessage(numArgs, 3) != LSF_OK) {
+        return;
+    }
+
+    LSFResponseCode responseCode = static_cast<LSFResponseCode>(args[0].v_uint32);
+    LSFString language = static_cast<LSFString>(args[1].v_string.str);
+
+    MasterSceneMap masterScenes;
+    size_t numMasterScenes;
+    MsgArg* masterSceneArray;
+    args[2].Get("a(ssas)", &numMasterScenes, &masterSceneArray);
+    for (size_t i = 0; i < numMasterScenes; i++) {
+        const MsgArg* members = masterSceneArray[i].v_struct.members;
+        LSFString masterSceneID = static_cast<LSFString>(members[0].v_string.str);
+        LSFString masterSceneName = static_cast<LSFString>(members[1].v_string.str);
+        MasterScene masterScene(members[2]);
+        masterScenes.insert(std::make_pair(masterSceneID, std::make_pair(masterSceneName, masterScene)));
+    }
+
+    callback.GetAllMasterScenesReplyCB(responseCode, language, masterScenes);
+}
+
 ControllerClientStatus MasterSceneManager::DeleteMasterScene(const LSFString& masterSceneID)
 {
     QCC_DbgPrintf(("%s: masterSceneID=%s", __func__, masterSceneID.c_str()));
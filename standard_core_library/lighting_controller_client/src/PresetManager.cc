@@ -72,6 +72,50 @@ void PresetManager::GetPresetReply(Message& message)
     callback.GetPresetReplyCB(responseCode, presetID, preset);
 }
 
+ControllerClientStatus PresetManager::GetAllPresets(const LSFString& language)
+{
+    QCC_DbgPrintf(("%s: language=%s", __func__, language.c_str()));
+    MsgArg arg;
+    arg.Set("s", language.c_str());
+
+    return controllerClient.MethodCallAsync(
+               ControllerServicePresetInterfaceName,
+               "GetAllPresets",
+               this,
+               &PresetManager::GetAllPresetsReply,
+               &arg,
+               1);
+}
+
+void PresetManager::GetAllPresetsReply(Message& message)
+{
+    QCC_DbgPrintf(("%s: Method Reply %s", __func__, (MESSAGE_METHOD_RET == message->GetType()) ? message->ToString().c_str() : "ERROR"));
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerClient.CheckNumArgsInMessage(numArgs, 3) != LSF_OK) {
+        return;
+    }
+
+    LSFResponseCode responseCode = static_cast<LSFResponseCode>(args[0].v_uint32);
+    LSFString language = static_cast<LSFString>(args[1].v_string.str);
+
+    PresetMap presets;
+    size_t numPresets;
+    MsgArg* presetArray;
+    args[2].Get("a(ssa{sv})", &numPresets, &presetArray);
+    for (size_t i = 0; i < numPresets; i++) {
+        const MsgArg* members = presetArray[i].v_struct.members;
+        LSFString presetID = static_cast<LSFString>(members[0].v_string.str);
+        LSFString presetName = static_cast<LSFString>(members[1].v_string.str);
+        LampState preset(members[2]);
+        presets.insert(std::make_pair(presetID, std::make_pair(presetName, preset)));
+    }
+
+    callback.GetAllPresetsReplyCB(responseCode, language, presets);
+}
+
 ControllerClientStatus PresetManager::GetPresetName(const LSFString& presetID, const LSFString& language)
 {
     QCC_DbgPrintf(("%s: presetID=%s", __func__, presetID.c_str()));
@@ -145,6 +145,50 @@ void SceneManager::GetSceneReply(Message& message)
     callback.GetSceneReplyCB(responseCode, sceneID, scene);
 }
 
+ControllerClientStatus SceneManager::GetAllScenes(const LSFString& language)
+{
+    QCC_DbgPrintf(("%s: language=%s", __func__, language.c_str()));
+    MsgArg arg;
+    arg.Set("s", language.c_str());
+
+    return controllerClient.MethodCallAsync(
+               ControllerServiceSceneInterfaceName,
+               "GetAllScenes",
+               this,
+               &SceneManager::GetAllScenesReply,
+               &arg,
+               1);
+}
+
+void SceneManager::GetAllScenesReply(Message& message)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerClient.CheckNumArgsInMessage(numArgs, 3) != LSF_OK) {
+        return;
+    }
+
+    LSFResponseCode responseCode = static_cast<LSFResponseCode>(args[0].v_uint32);
+    LSFString language = static_cast<LSFString>(args[1].v_string.str);
+
+    SceneMap scenes;
+    size_t numScenes;
+    MsgArg* sceneArray;
+    args[2].Get("a(ssa(asasa{sv}u)a(asassu)a(asasa{sv}a{sv}uuu)a(asasssuuu))", &numScenes, &sceneArray);
+    for (size_t i = 0; i < numScenes; i++) {
+        const MsgArg* members = sceneArray[i].v_struct.members;
+        LSFString sceneID = static_cast<LSFString>(members[0].v_string.str);
+        LSFString sceneName = static_cast<LSFString>(members[1].v_string.str);
+        Scene scene(members[2], members[3], members[4], members[5]);
+        scenes.insert(std::make_pair(sceneID, std::make_pair(sceneName, scene)));
+    }
+
+    callback.GetAllScenesReplyCB(responseCode, language, scenes);
+}
+
 ControllerClientStatus SceneManager::DeleteScene(const LSFString& sceneID)
 {
     QCC_DbgPrintf(("%s: sceneID=%s", __func__, sceneID.c_str()));
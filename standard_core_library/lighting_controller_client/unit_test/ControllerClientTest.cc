@@ -165,6 +165,8 @@ class LampManagerCallbackHandler : public LampManagerCallback {
         getLampStateReplyCBStatus(LSF_ERR_UNEXPECTED),
         getLampStateReplyCBLampID(),
         getLampStateReplyCBLampState(),
+        getAllLampStatesReplyCBStatus(LSF_ERR_UNEXPECTED),
+        getAllLampStatesReplyCBLampStates(),
         getLampStateOnOffFieldReplyCBStatus(LSF_ERR_UNEXPECTED),
         getLampStateOnOffFieldReplyCBLampID(),
         getLampStateOnOffFieldReplyCBOnOff(),
@@ -196,6 +198,7 @@ class LampManagerCallbackHandler : public LampManagerCallback {
         lampStateChangedCBLampState(),
         transitionLampStateReplyCBStatus(LSF_ERR_UNEXPECTED),
         transitionLampStateReplyCBLampID(),
+        transitionLampsToStatesReplyCBStatus(LSF_ERR_UNEXPECTED),
         transitionLampStateOnOffFieldReplyCBStatus(LSF_ERR_UNEXPECTED),
         transitionLampStateOnOffFieldReplyCBLampID(),
         transitionLampStateHueFieldReplyCBStatus(LSF_ERR_UNEXPECTED),
@@ -314,6 +317,12 @@ class LampManagerCallbackHandler : public LampManagerCallback {
         getLampDataSetState = true;
     }
 
+    void GetAllLampStatesReplyCB(const LSFResponseCode& responseCode, const LampStateMap& lampStates) {
+        getAllLampStatesReplyCBStatus = responseCode;
+        getAllLampStatesReplyCBLampStates = lampStates;
+        replyReceivedFlag = true;
+    }
+
     void GetLampStateOnOffFieldReplyCB(const LSFResponseCode& responseCode, const LSFString& lampID, const bool& onOff) {
         getLampStateOnOffFieldReplyCBStatus = responseCode;
         getLampStateOnOffFieldReplyCBLampID = lampID;
@@ -367,6 +376,11 @@ class LampManagerCallbackHandler : public LampManagerCallback {
         replyReceivedFlag = true;
     }
 
+    void TransitionLampsToStatesReplyCB(const LSFResponseCode& responseCode) {
+        transitionLampsToStatesReplyCBStatus = responseCode;
+        replyReceivedFlag = true;
+    }
+
     void PulseLampWithStateReplyCB(const LSFResponseCode& responseCode, const LSFString& lampID) {
         pulseLampWithStateReplyCBStatus = responseCode;
         pulseLampWithStateReplyCBLampID = lampID;
@@ -494,6 +508,8 @@ class LampManagerCallbackHandler : public LampManagerCallback {
     LSFResponseCode getLampStateReplyCBStatus;
     LSFString getLampStateReplyCBLampID;
     LampState getLampStateReplyCBLampState;
+    LSFResponseCode getAllLampStatesReplyCBStatus;
+    LampStateMap getAllLampStatesReplyCBLampStates;
     LSFResponseCode getLampStateOnOffFieldReplyCBStatus;
     LSFString getLampStateOnOffFieldReplyCBLampID;
     bool getLampStateOnOffFieldReplyCBOnOff;
@@ -525,6 +541,7 @@ class LampManagerCallbackHandler : public LampManagerCallback {
     LampState lampStateChangedCBLampState;
     LSFResponseCode transitionLampStateReplyCBStatus;
     LSFString transitionLampStateReplyCBLampID;
+    LSFResponseCode transitionLampsToStatesReplyCBStatus;
     LSFResponseCode transitionLampStateOnOffFieldReplyCBStatus;
     LSFString transitionLampStateOnOffFieldReplyCBLampID;
     LSFResponseCode transitionLampStateHueFieldReplyCBStatus;
@@ -586,6 +603,9 @@ class LampGroupManagerCallbackHandler : public LampGroupManagerCallback {
         getLampGroupReplyCBStatus(LSF_ERR_UNEXPECTED),
         getLampGroupReplyCBLampGroupID(),
         getLampGroupReplyCBLampGroup(),
+        getAllLampGroupsReplyCBStatus(LSF_ERR_UNEXPECTED),
+        getAllLampGroupsReplyCBLanguage(),
+        getAllLampGroupsReplyCBLampGroups(),
         lampGroupList(),
         lampGroupNameChangedList(),
         lampGroupUpdatedList(),
@@ -629,6 +649,13 @@ class LampGroupManagerCallbackHandler : public LampGroupManagerCallback {
         getLampGroupDataSetGroup = true;
     }
 
+    void GetAllLampGroupsReplyCB(const LSFResponseCode& responseCode, const LSFString& language, const LampGroupMap& lampGroups) {
+        getAllLampGroupsReplyCBStatus = responseCode;
+        getAllLampGroupsReplyCBLanguage = language;
+        getAllLampGroupsReplyCBLampGroups = lampGroups;
+        replyReceivedFlag = true;
+    }
+
     void GetAllLampGroupIDsReplyCB(const LSFResponseCode& responseCode, const LSFStringList& lampGroupIDs) {
         getAllLampGroupIDsReplyCBStatus = responseCode;
         lampGroupList = lampGroupIDs;
@@ -796,6 +823,9 @@ class LampGroupManagerCallbackHandler : public LampGroupManagerCallback {
     LSFResponseCode getLampGroupReplyCBStatus;
     LSFString getLampGroupReplyCBLampGroupID;
     LampGroup getLampGroupReplyCBLampGroup;
+    LSFResponseCode getAllLampGroupsReplyCBStatus;
+    LSFString getAllLampGroupsReplyCBLanguage;
+    LampGroupMap getAllLampGroupsReplyCBLampGroups;
     LSFStringList lampGroupList;
     LSFStringList lampGroupNameChangedList;
     LSFStringList lampGroupUpdatedList;
@@ -857,6 +887,9 @@ class PresetManagerCallbackHandler : public PresetManagerCallback {
         getPresetReplyCBStatus(LSF_ERR_UNEXPECTED),
         getPresetReplyCBPresetID(),
         getPresetReplyCBPreset(),
+        getAllPresetsReplyCBStatus(LSF_ERR_UNEXPECTED),
+        getAllPresetsReplyCBLanguage(),
+        getAllPresetsReplyCBPresets(),
         presetList(),
         presetNameChangedList(),
         presetUpdatedList(),
@@ -870,6 +903,13 @@ class PresetManagerCallbackHandler : public PresetManagerCallback {
         getPresetDataSetPreset = true;
     }
 
+    void GetAllPresetsReplyCB(const LSFResponseCode& responseCode, const LSFString& language, const PresetMap& presets) {
+        getAllPresetsReplyCBStatus = responseCode;
+        getAllPresetsReplyCBLanguage = language;
+        getAllPresetsReplyCBPresets = presets;
+        replyReceivedFlag = true;
+    }
+
     void GetAllPresetIDsReplyCB(const LSFResponseCode& responseCode, const LSFStringList& presetIDs) {
         getAllPresetIDsReplyCBStatus = responseCode;
         presetList = presetIDs;
@@ -967,6 +1007,9 @@ class PresetManagerCallbackHandler : public PresetManagerCallback {
     LSFResponseCode getPresetReplyCBStatus;
     LSFString getPresetReplyCBPresetID;
     LampState getPresetReplyCBPreset;
+    LSFResponseCode getAllPresetsReplyCBStatus;
+    LSFString getAllPresetsReplyCBLanguage;
+    PresetMap getAllPresetsReplyCBPresets;
     LSFStringList presetList;
     LSFStringList presetNameChangedList;
     LSFStringList presetUpdatedList;
@@ -994,6 +1037,9 @@ class SceneManagerCallbackHandler : public SceneManagerCallback {
         getSceneReplyCBStatus(LSF_ERR_UNEXPECTED),
         getSceneReplyCBSceneID(),
         getSceneReplyCBScene(),
+        getAllScenesReplyCBStatus(LSF_ERR_UNEXPECTED),
+        getAllScenesReplyCBLanguage(),
+        getAllScenesReplyCBScenes(),
         applySceneReplyCBStatus(LSF_ERR_UNEXPECTED),
         applySceneReplyCBSceneID(),
         sceneList(),
@@ -1010,6 +1056,13 @@ class SceneManagerCallbackHandler : public SceneManagerCallback {
         getSceneDataSetScene = true;
     }
 
+    void GetAllScenesReplyCB(const LSFResponseCode& responseCode, const LSFString& language, const SceneMap& scenes) {
+        getAllScenesReplyCBStatus = responseCode;
+        getAllScenesReplyCBLanguage = language;
+        getAllScenesReplyCBScenes = scenes;
+        replyReceivedFlag = true;
+    }
+
     void GetAllSceneIDsReplyCB(const LSFResponseCode& responseCode, const LSFStringList& sceneIDs) {
         getAllSceneIDsReplyCBStatus = responseCode;
         sceneList = sceneIDs;
@@ -1098,6 +1151,9 @@ class SceneManagerCallbackHandler : public SceneManagerCallback {
     LSFResponseCode getSceneReplyCBStatus;
     LSFString getSceneReplyCBSceneID;
     Scene getSceneReplyCBScene;
+    LSFResponseCode getAllScenesReplyCBStatus;
+    LSFString getAllScenesReplyCBLanguage;
+    SceneMap getAllScenesReplyCBScenes;
     LSFResponseCode applySceneReplyCBStatus;
     LSFString applySceneReplyCBSceneID;
     LSFStringList sceneList;
@@ -1128,6 +1184,9 @@ class MasterSceneManagerCallbackHandler : public MasterSceneManagerCallback {
         getMasterSceneReplyCBStatus(LSF_ERR_UNEXPECTED),
         getMasterSceneReplyCBMasterSceneID(),
         getMasterSceneReplyCBMasterScene(),
+        getAllMasterScenesReplyCBStatus(LSF_ERR_UNEXPECTED),
+        getAllMasterScenesReplyCBLanguage(),
+        getAllMasterScenesReplyCBMasterScenes(),
         applyMasterSceneReplyCBStatus(LSF_ERR_UNEXPECTED),
         applyMasterSceneReplyCBMasterSceneID(),
         masterSceneList(),
@@ -1144,6 +1203,13 @@ class MasterSceneManagerCallbackHandler : public MasterSceneManagerCallback {
         getMasterSceneDataSetMasterScene = true;
     }
 
+    void GetAllMasterScenesReplyCB(const LSFResponseCode& responseCode, const LSFString& language, const MasterSceneMap& masterScenes) {
+        getAllMasterScenesReplyCBStatus = responseCode;
+        getAllMasterScenesReplyCBLanguage = language;
+        getAllMasterScenesReplyCBMasterScenes = masterScenes;
+        replyReceivedFlag = true;
+    }
+
     void GetAllMasterSceneIDsReplyCB(const LSFResponseCode& responseCode, const LSFStringList& masterSceneIDs) {
         getAllMasterSceneIDsReplyCBStatus = responseCode;
         masterSceneList = masterSceneIDs;
@@ -1232,6 +1298,9 @@ class MasterSceneManagerCallbackHandler : public MasterSceneManagerCallback {
     LSFResponseCode getMasterSceneReplyCBStatus;
     LSFString getMasterSceneReplyCBMasterSceneID;
     MasterScene getMasterSceneReplyCBMasterScene;
+    LSFResponseCode getAllMasterScenesReplyCBStatus;
+    LSFString getAllMasterScenesReplyCBLanguage;
+    MasterSceneMap getAllMasterScenesReplyCBMasterScenes;
     LSFResponseCode applyMasterSceneReplyCBStatus;
     LSFString applyMasterSceneReplyCBMasterSceneID;
     LSFStringList masterSceneList;
@@ -1877,6 +1946,71 @@ TEST_F(ControllerClientTest, Controller_Client_GetLampState) {
     EXPECT_EQ(state.brightness, lampManagerCBHandler.getLampStateReplyCBLampState.brightness);
 }
 
+TEST_F(ControllerClientTest, Controller_Client_GetAllLampStates) {
+    replyReceivedFlag = false;
+
+    ControllerClientStatus localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = client.Start();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive a callback from the controller client
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, controllerClientCBHandler.connectedToControllerServiceCBStatus);
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = lampManager.GetAllLampIDs();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, lampManagerCBHandler.getAllLampIDsReplyCBStatus);
+
+    size_t listSize = 1;
+    EXPECT_EQ(listSize, lampManagerCBHandler.lampList.size());
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    LSFString lampID = lampManagerCBHandler.lampList.front();
+    localStatus = lampManager.GetAllLampStates();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, lampManagerCBHandler.getAllLampStatesReplyCBStatus);
+    EXPECT_EQ(listSize, lampManagerCBHandler.getAllLampStatesReplyCBLampStates.size());
+
+    LampStateMap::const_iterator it = lampManagerCBHandler.getAllLampStatesReplyCBLampStates.find(lampID);
+    ASSERT_TRUE(it != lampManagerCBHandler.getAllLampStatesReplyCBLampStates.end());
+
+    LampState state(1, 0, 0, 0, 0);
+    EXPECT_EQ(state.onOff, it->second.onOff);
+    EXPECT_EQ(state.hue, it->second.hue);
+    EXPECT_EQ(state.saturation, it->second.saturation);
+    EXPECT_EQ(state.colorTemp, it->second.colorTemp);
+    EXPECT_EQ(state.brightness, it->second.brightness);
+}
+
 TEST_F(ControllerClientTest, Controller_Client_GetLampStateOnOffField) {
     replyReceivedFlag = false;
 
@@ -2678,6 +2812,80 @@ TEST_F(ControllerClientTest, Controller_Client_TransitionLampState) {
     EXPECT_EQ(state.brightness, lampManagerCBHandler.lampStateChangedCBLampState.brightness);
 }
 
+TEST_F(ControllerClientTest, Controller_Client_TransitionLampsToStates) {
+    replyReceivedFlag = false;
+
+    ControllerClientStatus localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = client.Start();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive a callback from the controller client
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, controllerClientCBHandler.connectedToControllerServiceCBStatus);
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = lampManager.GetAllLampIDs();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, lampManagerCBHandler.getAllLampIDsReplyCBStatus);
+
+    size_t listSize = 1;
+    EXPECT_EQ(listSize, lampManagerCBHandler.lampList.size());
+
+    replyReceivedFlag = false;
+    signalReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    LSFString lampID = lampManagerCBHandler.lampList.front();
+    LampState state(false, 7, 7, 7, 7);
+    LampTransitionList transitions;
+    transitions.push_back(LampTransition(lampID, state));
+    localStatus = lampManager.TransitionLampsToStates(transitions);
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, lampManagerCBHandler.transitionLampsToStatesReplyCBStatus);
+
+    //wait to receive signal
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (signalReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(lampID, lampManagerCBHandler.lampStateChangedCBLampID);
+
+    EXPECT_EQ(state.onOff, lampManagerCBHandler.lampStateChangedCBLampState.onOff);
+    EXPECT_EQ(state.hue, lampManagerCBHandler.lampStateChangedCBLampState.hue);
+    EXPECT_EQ(state.saturation, lampManagerCBHandler.lampStateChangedCBLampState.saturation);
+    EXPECT_EQ(state.colorTemp, lampManagerCBHandler.lampStateChangedCBLampState.colorTemp);
+    EXPECT_EQ(state.brightness, lampManagerCBHandler.lampStateChangedCBLampState.brightness);
+}
+
 TEST_F(ControllerClientTest, Controller_Client_TransitionLampStateOnOffField) {
     replyReceivedFlag = false;
 
@@ -4320,6 +4528,63 @@ TEST_F(ControllerClientTest, Controller_Client_GetPreset) {
     EXPECT_EQ(state.brightness, presetManagerCBHandler.getPresetReplyCBPreset.brightness);
 }
 
+TEST_F(ControllerClientTest, Controller_Client_GetAllPresets) {
+    replyReceivedFlag = false;
+
+    ControllerClientStatus localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = client.Start();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive a callback from the controller client
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, controllerClientCBHandler.connectedToControllerServiceCBStatus);
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = presetManager.GetAllPresetIDs();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, presetManagerCBHandler.getAllPresetIDsReplyCBStatus);
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    LSFString language = LSFString("en");
+    localStatus = presetManager.GetAllPresets(language);
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, presetManagerCBHandler.getAllPresetsReplyCBStatus);
+    EXPECT_EQ(language, presetManagerCBHandler.getAllPresetsReplyCBLanguage);
+    EXPECT_EQ(presetManagerCBHandler.presetList.size(), presetManagerCBHandler.getAllPresetsReplyCBPresets.size());
+
+    for (LSFStringList::iterator it = presetManagerCBHandler.presetList.begin(); it != presetManagerCBHandler.presetList.end(); it++) {
+        EXPECT_TRUE(presetManagerCBHandler.getAllPresetsReplyCBPresets.find(*it) != presetManagerCBHandler.getAllPresetsReplyCBPresets.end());
+    }
+}
+
 TEST_F(ControllerClientTest, Controller_Client_CreateLampGroup) {
     replyReceivedFlag = false;
 
@@ -5825,6 +6090,63 @@ TEST_F(ControllerClientTest, Controller_Client_GetAllLampGroupIDs) {
     EXPECT_EQ(listSize, lampGroupManagerCBHandler.lampGroupList.size());
 }
 
+TEST_F(ControllerClientTest, Controller_Client_GetAllLampGroups) {
+    replyReceivedFlag = false;
+
+    ControllerClientStatus localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = client.Start();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive a callback from the controller client
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, controllerClientCBHandler.connectedToControllerServiceCBStatus);
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = lampGroupManager.GetAllLampGroupIDs();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, lampGroupManagerCBHandler.getAllLampGroupIDsReplyCBStatus);
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    LSFString language = LSFString("en");
+    localStatus = lampGroupManager.GetAllLampGroups(language);
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, lampGroupManagerCBHandler.getAllLampGroupsReplyCBStatus);
+    EXPECT_EQ(language, lampGroupManagerCBHandler.getAllLampGroupsReplyCBLanguage);
+    EXPECT_EQ(lampGroupManagerCBHandler.lampGroupList.size(), lampGroupManagerCBHandler.getAllLampGroupsReplyCBLampGroups.size());
+
+    for (LSFStringList::iterator it = lampGroupManagerCBHandler.lampGroupList.begin(); it != lampGroupManagerCBHandler.lampGroupList.end(); it++) {
+        EXPECT_TRUE(lampGroupManagerCBHandler.getAllLampGroupsReplyCBLampGroups.find(*it) != lampGroupManagerCBHandler.getAllLampGroupsReplyCBLampGroups.end());
+    }
+}
+
 TEST_F(ControllerClientTest, Controller_Client_GetLampGroupDataSet) {
     replyReceivedFlag = false;
 
@@ -6568,6 +6890,63 @@ TEST_F(ControllerClientTest, Controller_Client_GetAllSceneIDs) {
     EXPECT_EQ(listSize, sceneManagerCBHandler.sceneList.size());
 }
 
+TEST_F(ControllerClientTest, Controller_Client_GetAllScenes) {
+    replyReceivedFlag = false;
+
+    ControllerClientStatus localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = client.Start();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive a callback from the controller client
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, controllerClientCBHandler.connectedToControllerServiceCBStatus);
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = sceneManager.GetAllSceneIDs();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, sceneManagerCBHandler.getAllSceneIDsReplyCBStatus);
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    LSFString language = LSFString("en");
+    localStatus = sceneManager.GetAllScenes(language);
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, sceneManagerCBHandler.getAllScenesReplyCBStatus);
+    EXPECT_EQ(language, sceneManagerCBHandler.getAllScenesReplyCBLanguage);
+    EXPECT_EQ(sceneManagerCBHandler.sceneList.size(), sceneManagerCBHandler.getAllScenesReplyCBScenes.size());
+
+    for (LSFStringList::iterator it = sceneManagerCBHandler.sceneList.begin(); it != sceneManagerCBHandler.sceneList.end(); it++) {
+        EXPECT_TRUE(sceneManagerCBHandler.getAllScenesReplyCBScenes.find(*it) != sceneManagerCBHandler.getAllScenesReplyCBScenes.end());
+    }
+}
+
 TEST_F(ControllerClientTest, Controller_Client_GetSceneName) {
     replyReceivedFlag = false;
 
@@ -8707,6 +9086,63 @@ TEST_F(ControllerClientTest, Controller_Client_GetAllMasterSceneIDs) {
     EXPECT_EQ(listSize, masterSceneManagerCBHandler.masterSceneList.size());
 }
 
+TEST_F(ControllerClientTest, Controller_Client_GetAllMasterScenes) {
+    replyReceivedFlag = false;
+
+    ControllerClientStatus localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = client.Start();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive a callback from the controller client
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, controllerClientCBHandler.connectedToControllerServiceCBStatus);
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    localStatus = masterSceneManager.GetAllMasterSceneIDs();
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, masterSceneManagerCBHandler.getAllMasterSceneIDsReplyCBStatus);
+
+    replyReceivedFlag = false;
+
+    localStatus = CONTROLLER_CLIENT_OK;
+    LSFString language = LSFString("en");
+    localStatus = masterSceneManager.GetAllMasterScenes(language);
+    ASSERT_EQ(CONTROLLER_CLIENT_OK, localStatus) << "  Actual Status: " << ControllerClientStatusText(localStatus);
+
+    //wait to receive reply
+    for (size_t msecs = 0; msecs < 2100; msecs += 5) {
+        if (replyReceivedFlag) {
+            break;
+        }
+        sleep(2);
+    }
+
+    EXPECT_EQ(LSF_OK, masterSceneManagerCBHandler.getAllMasterScenesReplyCBStatus);
+    EXPECT_EQ(language, masterSceneManagerCBHandler.getAllMasterScenesReplyCBLanguage);
+    EXPECT_EQ(masterSceneManagerCBHandler.masterSceneList.size(), masterSceneManagerCBHandler.getAllMasterScenesReplyCBMasterScenes.size());
+
+    for (LSFStringList::iterator it = masterSceneManagerCBHandler.masterSceneList.begin(); it != masterSceneManagerCBHandler.masterSceneList.end(); it++) {
+        EXPECT_TRUE(masterSceneManagerCBHandler.getAllMasterScenesReplyCBMasterScenes.find(*it) != masterSceneManagerCBHandler.getAllMasterScenesReplyCBMasterScenes.end());
+    }
+}
+
 TEST_F(ControllerClientTest, Controller_Client_GetMasterSceneName) {
     replyReceivedFlag = false;
 
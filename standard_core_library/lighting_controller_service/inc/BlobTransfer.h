@@ -0,0 +1,133 @@
+#ifndef _BLOB_TRANSFER_H_
+#define _BLOB_TRANSFER_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the compressed and chunked blob transfer
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <map>
+
+#include <Mutex.h>
+
+namespace lsf {
+
+/**
+ * One chunk of a compressed blob, as carried by the BlobChunk signal
+ */
+typedef struct _BlobChunk {
+    uint32_t type;          /**< LSFBlobType of the blob */
+    uint32_t transferId;    /**< Identifies the transfer among the transfers of the sender */
+    uint32_t index;         /**< Index of the chunk, starting at 0 */
+    uint32_t numChunks;     /**< Number of chunks of the transfer */
+    uint32_t blobLength;    /**< Length of the uncompressed blob */
+    uint32_t checksum;      /**< Adler-32 checksum of the uncompressed blob */
+    uint64_t timestamp;     /**< Age of the blob */
+    const uint8_t* data;    /**< Compressed data of the chunk */
+    size_t dataLength;      /**< Length of data */
+} BlobChunk;
+
+/**
+ * Compression and chunking of the blobs exchanged between Controller Services. \n
+ * A blob used to travel as a single string argument, so that a store could not
+ * grow past the maximum AllJoyn message size. Blobs longer than INLINE_BLOB_LEN
+ * are now compressed with an LZ77 codec that writes the LZ4 block format, and
+ * split in chunks of at most CHUNK_LEN bytes sent in order.
+ */
+class BlobTransfer {
+  public:
+
+    static const size_t INLINE_BLOB_LEN = 1024 * 64; /**< Blobs up to this length are sent uncompressed in one message */
+    static const size_t CHUNK_LEN = 1024 * 64; /**< Max compressed bytes in one chunk */
+    static const size_t MAX_BLOB_LEN = 1024 * 1024 * 8; /**< Longest blob accepted from a sender */
+
+    /**
+     * Compress a blob
+     *
+     * @param input     The blob
+     * @param output    The compressed blob
+     */
+    static void Compress(const std::string& input, std::string& output);
+
+    /**
+     * Decompress a blob
+     *
+     * @param data          The compressed blob
+     * @param len           Length of data
+     * @param blobLength    Length of the uncompressed blob
+     * @param output        The uncompressed blob
+     * @return              false if data is malformed or does not decompress to blobLength bytes
+     */
+    static bool Decompress(const uint8_t* data, size_t len, size_t blobLength, std::string& output);
+
+    /**
+     * Get the number of chunks needed to send compressed data
+     */
+    static uint32_t GetNumChunks(size_t compressedLength) {
+        return (compressedLength == 0) ? 1 : static_cast<uint32_t>((compressedLength + CHUNK_LEN - 1) / CHUNK_LEN);
+    }
+};
+
+/**
+ * Reassembles the chunked blobs received from other Controller Services. \n
+ * Chunks of a transfer arrive in order on a session; a chunk that does not
+ * follow the previous one drops the transfer, and chunk 0 starts a new one.
+ */
+class BlobReassembler {
+  public:
+    /**
+     * Add a received chunk
+     *
+     * @param sender    Unique name of the sender
+     * @param chunk     The chunk
+     * @param blob      The uncompressed blob once the last chunk is added
+     * @return          true if the blob is complete and its checksum verified
+     */
+    bool AddChunk(const std::string& sender, const BlobChunk& chunk, std::string& blob);
+
+    /**
+     * Drop all the pending transfers
+     */
+    void Clear(void);
+
+  private:
+
+    typedef struct _PendingTransfer {
+        uint32_t transferId;
+        uint32_t numChunks;
+        uint32_t nextChunk;
+        uint32_t blobLength;
+        uint32_t checksum;
+        std::string data;
+    } PendingTransfer;
+
+    typedef std::map<std::pair<std::string, uint32_t>, PendingTransfer> PendingTransferMap;
+
+    Mutex transfersLock;
+    PendingTransferMap transfers;
+};
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef _CLIENT_RATE_LIMITER_H_
+#define _CLIENT_RATE_LIMITER_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the per-app admission control of the method calls of the Controller Service
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <LSFTypes.h>
+#include <Mutex.h>
+#include <MethodExecutor.h>
+#include <OEM_CS_Config.h>
+
+#include <map>
+
+namespace lsf {
+
+/**
+ * Admission control of the method calls of the apps. \n
+ * Each app, identified by the unique bus name of the sender of its calls, has
+ * a token bucket per method lane. A call takes a token of the bucket of its
+ * lane and is rejected when the bucket is empty; the buckets refill at the
+ * rate of their lane up to its burst.
+ */
+class ClientRateLimiter {
+  public:
+    /**
+     * Usage of the Controller Service by an app
+     */
+    typedef struct _ClientUsage {
+        uint32_t admitted[METHOD_LANE_LAST_VALUE];  /**< Calls admitted, per lane */
+        uint32_t rejected[METHOD_LANE_LAST_VALUE];  /**< Calls rejected because the app exceeded the rate of the lane, per lane */
+        uint64_t firstCallTimestamp;                /**< Time of the first call of the app, in ms */
+        uint64_t lastCallTimestamp;                 /**< Time of the last call of the app, in ms */
+    } ClientUsage;
+
+    /**
+     * Typedef for the usage of all the tracked apps, by unique bus name
+     */
+    typedef std::map<LSFString, ClientUsage> ClientUsageMap;
+
+    /**
+     * class constructor
+     * @param maxClients    Maximum number of apps tracked
+     */
+    ClientRateLimiter(uint32_t maxClients = OEM_CS_RATE_LIMITER_MAX_CLIENTS);
+    /**
+     * class destructor
+     */
+    ~ClientRateLimiter();
+    /**
+     * Set the rate of a lane. Applies to the buckets of all the apps
+     * @param lane          The lane
+     * @param ratePerSec    Calls per second that an app may make in the lane. 0 does not limit the lane
+     * @param burst         Calls an app may make at once after being idle
+     */
+    void SetLaneRate(MethodLane lane, uint32_t ratePerSec, uint32_t burst);
+    /**
+     * Take a token for a call
+     * @param sender    Unique bus name of the caller
+     * @param lane      The lane of the call
+     * @return false if the caller exceeded the rate of the lane
+     */
+    bool Admit(const char* sender, MethodLane lane);
+    /**
+     * Forget an app, when it leaves the session
+     * @param sender    Unique bus name of the app
+     */
+    void RemoveClient(const char* sender);
+    /**
+     * Forget all the apps
+     */
+    void Reset(void);
+    /**
+     * Get the usage of the tracked apps
+     */
+    void GetClientUsage(ClientUsageMap& usage);
+
+  private:
+
+    struct Bucket {
+        uint64_t milliTokens;
+        uint64_t lastRefill;
+    };
+
+    struct Client {
+        Bucket buckets[METHOD_LANE_LAST_VALUE];
+        ClientUsage usage;
+    };
+
+    struct LaneRate {
+        uint32_t ratePerSec;
+        uint32_t burst;
+    };
+
+    typedef std::map<LSFString, Client> ClientMap;
+
+    /*
+     * Must be called with lock held
+     */
+    Client& GetClient(const char* sender, uint64_t now);
+
+    Mutex lock;
+    LaneRate rates[METHOD_LANE_LAST_VALUE];
+    ClientMap clients;
+    uint32_t maxClients;
+};
+
+}
+
+#endif
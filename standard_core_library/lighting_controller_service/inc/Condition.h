@@ -28,6 +28,7 @@
  ******************************************************************************/
 
 #include <pthread.h>
+#include <stdint.h>
 
 namespace lsf {
 
@@ -57,6 +58,11 @@ class Condition {
      * wait on condition
      */
     void Wait(Mutex& mutex);
+    /**
+     * wait on condition for at most timeoutMs milliseconds
+     * @return false if the wait timed out
+     */
+    bool TimedWait(Mutex& mutex, uint32_t timeoutMs);
 
   private:
 
@@ -39,6 +39,7 @@
 #include <Mutex.h>
 
 #include <PersistenceThread.h>
+#include <StoreLoaderThread.h>
 #include <LSFPropertyStore.h>
 #include <LampManager.h>
 #include <LampGroupManager.h>
@@ -48,6 +49,11 @@
 #include <LeaderElectionObject.h>
 #include <LampClients.h>
 #include <ControllerServiceRank.h>
+#include <MethodDispatchTable.h>
+#include <MethodExecutor.h>
+#include <LampStateSignalBatcher.h>
+#include <ClientRateLimiter.h>
+#include <Diagnostics.h>
 
 namespace lsf {
 
@@ -62,6 +68,26 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
     friend class LeaderElectionObject;
   public:
 
+    /**
+     * Timing of the startup stages, in ms since Start was called. \n
+     * A stage that was not reached is 0
+     */
+    typedef struct _StartupMetrics {
+        uint64_t startTimestamp;        /**< Time Start was called */
+        uint32_t busStarted;            /**< The AllJoyn bus is started and the stores start loading */
+        uint32_t busConnected;          /**< The AllJoyn bus is connected */
+        uint32_t interfacesReady;       /**< The interfaces and method handlers are set up */
+        uint32_t lampDiscoveryStarted;  /**< The Lamp Clients look for lamps */
+        uint32_t aboutReady;            /**< About is initialized */
+        uint32_t storesLoaded;          /**< All the persistent stores are loaded */
+        uint32_t lampGroupStoreLoad;    /**< Time it took to load the Lamp Group store */
+        uint32_t presetStoreLoad;       /**< Time it took to load the Preset store */
+        uint32_t sceneStoreLoad;        /**< Time it took to load the Scene store */
+        uint32_t masterSceneStoreLoad;  /**< Time it took to load the Master Scene store */
+        uint32_t servicesRegistered;    /**< The Controller Service is registered on the bus and the election is started */
+        volatile uint32_t firstRequestServed; /**< The first method call is dispatched */
+    } StartupMetrics;
+
     /**
      * Constructor
      * @param factoryConfigFile - path of factory config file
@@ -112,7 +138,9 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
      */
     QStatus Start(const char* keyStoreFileLocation);
     /**
-     * Register Method Handlers
+     * Register Method Handlers. \n
+     * The dispatch table is built and sealed on the first call, and the
+     * method calls are dispatched from it without taking a lock
      */
     QStatus RegisterMethodHandlers(void);
 
@@ -241,6 +269,22 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
      */
     QStatus SendStateChangedSignal(const char* ifaceName, const char* signalName, const LSFString& lampID, const LampState& lampState);
 
+    /**
+     * Send the LampsStateChanged signal
+     * @param lampStates - The new state of each lamp
+     * @return QStatus
+     */
+    QStatus SendLampsStateChangedSignal(const LampStateMap& lampStates);
+
+    /**
+     * Queue the new state of a lamp for the next LampsStateChanged signal
+     * @param lampId     - The Lamp ID
+     * @param lampState  - The Lamp State
+     */
+    void QueueLampStateChangedSignal(const LSFString& lampID, const LampState& lampState) {
+        lampStateSignalBatcher.LampStateChanged(lampID, lampState);
+    }
+
     /**
      * Send Signal Without Arg - just an empty signal
      * @param ifaceName - interface that the signal is located
@@ -260,9 +304,10 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
      * Schedule File Read Write \n
      * a trigger to synchronize all lighting service meta data with persistent storage.\n
      * Meta data includes lamp groups, scenes, master scenes and pre-sets.
-     * @param manager - parameter not in use
+     * @param manager - the manager whose store must be read or written
+     * @param urgent - true to skip the debounce window of the persistence thread
      */
-    void ScheduleFileReadWrite(Manager* manager);
+    void ScheduleFileReadWrite(Manager* manager, bool urgent = false);
     /**
      * Send Blob Update \n
      * Updating the leader controller service about the current controller service meta data \n
@@ -271,7 +316,22 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
      * @param checksum
      * @param timestamp
      */
-    QStatus SendBlobUpdate(LSFBlobType type, std::string blob, uint32_t checksum, uint64_t timestamp);
+    QStatus SendBlobUpdate(LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp);
+    /**
+     * Send Blob Delta \n
+     * Updating the follower controller services with the entities that changed \n
+     * @param type - which kind of meta data is this
+     * @param changes - the created, updated and deleted entities
+     * @param checksum - checksum of the whole blob after the changes
+     * @param timestamp
+     */
+    QStatus SendBlobDelta(LSFBlobType type, const StoreChangeSet& changes, uint32_t checksum, uint64_t timestamp);
+    /**
+     * Send Heartbeat \n
+     * Tell the follower controller services that the leader is alive. \n
+     * Nothing is sent while no follower is in the session
+     */
+    QStatus SendHeartbeat(void);
     /**
      * Send Get Blob Reply \n
      * Replay to Get blob request \n
@@ -281,7 +341,7 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
      * @param checksum
      * @param timestamp
      */
-    void SendGetBlobReply(ajn::Message& message, LSFBlobType type, std::string blob, uint32_t checksum, uint64_t timestamp);
+    void SendGetBlobReply(ajn::Message& message, LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp);
     /**
      * Is Running
      */
@@ -320,6 +380,42 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
      */
     void LeaveSessionAsyncReplyHandler(ajn::Message& message, void* context);
 
+    /**
+     * Get the timing of the startup stages
+     */
+    const StartupMetrics& GetStartupMetrics(void) const {
+        return startupMetrics;
+    }
+
+    /**
+     * Get the queue depth and the other metrics of a lane of the method executor
+     */
+    void GetMethodLaneMetrics(MethodLane lane, MethodExecutor::LaneMetrics& metrics) {
+        methodExecutor.GetLaneMetrics(lane, metrics);
+    }
+
+    /**
+     * Get the number of calls admitted and rejected for each app, per lane
+     */
+    void GetClientUsage(ClientRateLimiter::ClientUsageMap& usage) {
+        clientRateLimiter.GetClientUsage(usage);
+    }
+
+    /**
+     * Get a snapshot of the runtime state of the Controller Service, as served
+     * by the Diagnostics interface
+     */
+    void GetDiagnosticsSnapshot(DiagnosticsSnapshot& snapshot);
+
+    /**
+     * Write the diagnostics snapshot to a local file at a regular interval
+     * @param filePath      Path of the file
+     * @param intervalMs    Time between two writes
+     */
+    QStatus StartDiagnosticsDump(const std::string& filePath, uint32_t intervalMs) {
+        return diagnosticsDumper.Start(filePath, intervalMs);
+    }
+
     /**
      * Get Leader Election Obj
      */
@@ -335,7 +431,16 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
 
   private:
 
-    void Initialize();
+    /**
+     * Connect to the bus, set up the interfaces, start the lamp discovery and
+     * initialize About. Runs while the stores are loaded
+     */
+    QStatus StartBusAndInterfaces(const char* keyStoreFileLocation);
+
+    /**
+     * Get the time elapsed since Start was called
+     */
+    uint32_t GetStartupTime(void) const;
 
     uint32_t GetControllerServiceInterfaceVersion(void);
 
@@ -413,24 +518,54 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
     void GetControllerServiceVersion(ajn::Message& msg);
 
     /*
-     * This function is not thread safe. it should not be called without locking messageHandlersLock
+     * Tell whether we are the leader and, for a follower, how far behind the leader its stores may be
+     */
+    void GetReadReplicaStaleness(ajn::Message& msg);
+
+    /*
+     * Reply with the diagnostics snapshot
+     */
+    void GetDiagnostics(ajn::Message& msg);
+
+    /*
+     * Reply LSF_ERR_BUSY to a call, echoing its leading arguments as the regular reply would
+     */
+    void SendBusyReply(const ajn::InterfaceDescription::Member* member, const ajn::Message& msg);
+
+    /*
+     * This function is not thread safe. it can only be called before the dispatch table is sealed
+     * readOnly handlers may be served by a follower when OEM_CS_READ_REPLICA is set
+     * the calls are run by the method executor on the given lane
+     * the calls of the apps are rate limited per lane, except the ones of the Controller Service
+     * interface whose replies do not all start with a response code
+     * @return false if the member is missing in the interface
      */
     template <typename OBJ>
-    void AddMethodHandler(const std::string& methodName, OBJ* obj, void (OBJ::* methodCall)(ajn::Message &))
+    bool AddMethodHandler(const ajn::InterfaceDescription::Member* member, OBJ* obj, void (OBJ::* methodCall)(ajn::Message &), bool readOnly = false, MethodLane lane = METHOD_LANE_CONFIG)
     {
-        MethodHandlerBase* handler = new MethodHandler<OBJ>(obj, methodCall);
-        std::pair<DispatcherMap::iterator, bool> ins = messageHandlers.insert(std::make_pair(methodName, handler));
-        if (ins.second == false) {
-            // if this was already there, overwrite and delete the old handler
-            delete ins.first->second;
-            ins.first->second = handler;
+        if (!member) {
+            return false;
         }
+        bool rateLimited = (strcmp(member->iface->GetName(), ControllerServiceInterfaceName) != 0);
+        return dispatchTable.Add(member, new MethodHandler<OBJ>(*this, member, obj, methodCall, readOnly, lane, rateLimited));
     }
 
-    class MethodHandlerBase {
+    class MethodHandlerBase : public MethodExecutor::Handler {
       public:
+        MethodHandlerBase(ControllerService& service, const ajn::InterfaceDescription::Member* member, bool readOnly, MethodLane lane, bool rateLimited) :
+            service(service), member(member), readOnly(readOnly), lane(lane), rateLimited(rateLimited), callCount(0) { }
         virtual ~MethodHandlerBase() { }
-        virtual void Handle(ajn::Message& msg) = 0;
+
+        virtual void Reject(ajn::Message& msg) {
+            service.SendBusyReply(member, msg);
+        }
+
+        ControllerService& service;
+        const ajn::InterfaceDescription::Member* member;
+        bool readOnly;
+        MethodLane lane;
+        bool rateLimited;
+        volatile int32_t callCount;
     };
 
     template <typename OBJ>
@@ -438,8 +573,8 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
         typedef void (OBJ::* HandlerFunction)(ajn::Message&);
 
       public:
-        MethodHandler(OBJ* obj, HandlerFunction handleFunc) :
-            object(obj), handler(handleFunc) { }
+        MethodHandler(ControllerService& service, const ajn::InterfaceDescription::Member* member, OBJ* obj, HandlerFunction handleFunc, bool readOnly, MethodLane lane, bool rateLimited) :
+            MethodHandlerBase(service, member, readOnly, lane, rateLimited), object(obj), handler(handleFunc) { }
 
         virtual ~MethodHandler() { }
 
@@ -451,12 +586,18 @@ class ControllerService : public ajn::BusObject, public ajn::services::ConfigSer
         HandlerFunction handler;
     };
 
-    typedef std::map<std::string, MethodHandlerBase*> DispatcherMap;
-    DispatcherMap messageHandlers;
-    Mutex messageHandlersLock;
+    typedef MethodDispatchTable<const ajn::InterfaceDescription::Member*, MethodHandlerBase> DispatchTable;
+    DispatchTable dispatchTable;
+    volatile int32_t methodCallCount;
+    MethodExecutor methodExecutor;
+    LampStateSignalBatcher lampStateSignalBatcher;
+    ClientRateLimiter clientRateLimiter;
+    DiagnosticsDumper diagnosticsDumper;
 
 
     PersistenceThread fileWriterThread;
+
+    StartupMetrics startupMetrics;
     bool firstAnnouncementSent;
 
     ControllerServiceRank rank;
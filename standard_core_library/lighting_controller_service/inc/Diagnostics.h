@@ -0,0 +1,118 @@
+#ifndef _DIAGNOSTICS_H_
+#define _DIAGNOSTICS_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the runtime diagnostics of the Controller Service
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <LSFTypes.h>
+#include <Mutex.h>
+#include <Alarm.h>
+#include <LampClients.h>
+#include <PersistenceThread.h>
+#include <LeaderElectionObject.h>
+
+#include <map>
+#include <string>
+
+namespace lsf {
+
+class ControllerService;
+
+/**
+ * Snapshot of the runtime state of the Controller Service
+ */
+struct DiagnosticsSnapshot {
+    uint64_t uptime;                                    /**< Time since the Controller Service started, in ms */
+    uint32_t methodCallCount;                           /**< Method calls received since the Controller Service started */
+    std::map<LSFString, uint32_t> methodCallCounts;     /**< Method calls received per member, as interface.member */
+    LampClients::LampClientsDiagnostics lampClients;    /**< Lamp connections and requests */
+    PersistenceThread::PersistenceMetrics persistence;  /**< Commits to the persistent store */
+    LeaderElectionObject::ElectionState election;       /**< Leader election */
+};
+
+/**
+ * Get a snapshot as the a{sv} dictionary of the Diagnostics interface. \n
+ * The MsgArg references the strings of the snapshot, so the snapshot must outlive it
+ *
+ * @param snapshot  The snapshot
+ * @param arg       MsgArg to populate
+ */
+void DiagnosticsSnapshotToMsgArg(const DiagnosticsSnapshot& snapshot, ajn::MsgArg& arg);
+
+/**
+ * Get a snapshot as text, one "name value" line per field, with the names of
+ * the Diagnostics interface dictionary
+ *
+ * @param snapshot  The snapshot
+ * @return The text
+ */
+std::string DiagnosticsSnapshotToString(const DiagnosticsSnapshot& snapshot);
+
+/**
+ * Writes the diagnostics of the Controller Service to a local file at a regular
+ * interval, so that they can be collected without joining the bus. The file is
+ * replaced as a whole on each write
+ */
+class DiagnosticsDumper : public AlarmListener {
+  public:
+    /**
+     * class constructor
+     * @param service   The Controller Service
+     */
+    DiagnosticsDumper(ControllerService& service);
+    /**
+     * class destructor
+     */
+    ~DiagnosticsDumper();
+    /**
+     * Start writing the diagnostics
+     * @param filePath      Path of the file
+     * @param intervalMs    Time between two writes
+     */
+    QStatus Start(const std::string& filePath, uint32_t intervalMs);
+    /**
+     * Invoked when it is time to write the diagnostics
+     */
+    virtual void AlarmTriggered(void);
+    /**
+     * Stop writing the diagnostics
+     */
+    void Stop(void);
+    /**
+     * Join after Stop
+     */
+    void Join(void);
+
+  private:
+
+    QStatus Dump(void);
+
+    ControllerService& service;
+    Mutex lock;
+    std::string path;
+    uint32_t interval;
+    Alarm alarm;
+};
+
+}
+
+#endif
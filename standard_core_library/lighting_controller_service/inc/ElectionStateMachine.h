@@ -0,0 +1,382 @@
+#ifndef _ELECTION_STATE_MACHINE_H_
+#define _ELECTION_STATE_MACHINE_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the rules of the leader election
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/String.h>
+
+#include <Mutex.h>
+#include <Rank.h>
+#include <FailureDetector.h>
+
+#include <list>
+#include <map>
+
+/**
+ * Time a follower waits for more announcements before it starts looking for a leader
+ */
+#define ELECTION_INTERVAL_IN_M_SEC 1000
+
+/**
+ * Time the announcements of higher ranked Controller Services hold back the election
+ */
+#define LEADER_ANNOUNCEMENT_WAIT_INTERVAL_IN_M_SEC 2000
+
+/**
+ * Time given to an upcoming leader to complete its coup
+ */
+#define OVERTHROW_TIMEOUT_IN_M_SEC 5000
+
+namespace lsf {
+
+/**
+ * Rules of the leader election. \n
+ * Keeps the view of the election of one Controller Service: the Controller
+ * Services that announced themselves, the current, outgoing and upcoming
+ * leaders and the replies that are waiting to be looked at. The events are
+ * recorded by the On* methods, which ask for a wake up, and Run goes through
+ * the rules once woken up. \n
+ * The state machine does not know about the bus: it talks to the rest of the
+ * Controller Service through Bus and tells the time through Clock, so that
+ * LeaderElectionObject drives it on AllJoyn and the election simulator drives
+ * it on a virtual clock and a simulated bus. \n
+ * All the methods are thread-safe. The Bus callbacks are made with the state
+ * locked, so they must not block on another call into the state machine
+ */
+class ElectionStateMachine {
+  public:
+
+    /**
+     * A Controller Service as seen in its About announcement
+     */
+    struct ControllerEntry {
+        uint16_t port;                  /**< Session port of the Controller Service */
+        qcc::String busName;            /**< Bus name of the Controller Service */
+        qcc::String deviceId;           /**< Device ID of the Controller Service */
+        Rank rank;                      /**< Rank of the Controller Service */
+        bool isLeader;                  /**< The Controller Service announced itself as the leader */
+        uint64_t announcementTimestamp; /**< Time the announcement was received */
+
+        ControllerEntry() {
+            Clear();
+        }
+
+        void Clear() {
+            busName = "";
+            deviceId = "";
+            rank = Rank();
+            isLeader = false;
+            port = 0;
+            announcementTimestamp = 0;
+        }
+    };
+
+    /**
+     * What the election does to the rest of the Controller Service
+     */
+    class Bus {
+      public:
+        virtual ~Bus() { }
+        /**
+         * Announce whether we are the leader
+         */
+        virtual void SetIsLeader(bool isLeader) = 0;
+        /**
+         * Allow or refuse the updates of the stores
+         */
+        virtual void SetAllowUpdates(bool allow) = 0;
+        /**
+         * Connect to the lamps once we are the leader
+         */
+        virtual void ConnectToLamps(void) = 0;
+        /**
+         * Disconnect from the lamps once we are no longer the leader
+         */
+        virtual void DisconnectFromLamps(void) = 0;
+        /**
+         * Put the lamp connections in hot standby, or take them out of it
+         */
+        virtual void UpdateHotStandby(bool standby) = 0;
+        /**
+         * Leave the session we host as the leader
+         */
+        virtual void LeaveSession(void) = 0;
+        /**
+         * Start joining the session of a leader. The reply comes in through OnSessionJoined
+         * @return false if the join could not be started
+         */
+        virtual bool JoinSession(const ControllerEntry& leader) = 0;
+        /**
+         * Leave a session we joined
+         */
+        virtual void LeaveSessionAsync(uint32_t sessionId) = 0;
+        /**
+         * The session with the current leader is up. Start the state sync with it,
+         * ending with an Overthrow call when overthrow is set. The end of a
+         * state sync with an outgoing leader comes in through OnOverthrowReply
+         * @return false if the state sync could not be started
+         */
+        virtual bool OnLeaderSessionJoined(const ControllerEntry& leader, uint32_t sessionId, bool overthrow) = 0;
+        /**
+         * The session with the current leader is no longer used
+         */
+        virtual void OnLeaderSessionCleared(void) = 0;
+        /**
+         * Reply to an Overthrow call
+         */
+        virtual void SendOverthrowReply(uint32_t callId, bool accepted) = 0;
+        /**
+         * Set the election alarm, which calls AlarmTriggered. 0 cancels it
+         */
+        virtual void SetAlarmInMs(uint32_t timeInMs) = 0;
+        /**
+         * Have Run called
+         */
+        virtual void Wake(void) = 0;
+        /**
+         * Send a heartbeat to the followers
+         */
+        virtual void SendHeartbeat(void) = 0;
+    };
+
+    /**
+     * Time source of the election
+     */
+    class Clock {
+      public:
+        virtual ~Clock() { }
+        /**
+         * Get the time in ms
+         */
+        virtual uint64_t GetTimestampInMs(void) = 0;
+    };
+
+    /**
+     * ElectionStateMachine constructor
+     */
+    ElectionStateMachine(Bus& bus, Clock& clock);
+
+    /**
+     * Set our rank
+     */
+    void SetRank(const Rank& rank);
+
+    /**
+     * Get our rank
+     */
+    Rank GetRank(void);
+
+    /**
+     * Record an About announcement. The announcements of the Controller
+     * Services that rank lower than us are ignored unless they are the leader
+     */
+    void OnAnnounced(const ControllerEntry& entry);
+
+    /**
+     * Record the reply to JoinSession
+     */
+    void OnSessionJoined(QStatus status, uint32_t sessionId, const ControllerEntry& leader);
+
+    /**
+     * Record a lost session
+     */
+    void OnSessionLost(uint32_t sessionId);
+
+    /**
+     * Record that a member left a session
+     */
+    void OnSessionMemberRemoved(uint32_t sessionId, const char* uniqueName);
+
+    /**
+     * Record an Overthrow call. It is answered through Bus::SendOverthrowReply
+     */
+    void OnOverthrow(const char* sender, uint32_t callId);
+
+    /**
+     * Record the end of a coup: the outgoing leader replied to Overthrow, or
+     * the state sync before the Overthrow call failed or found nothing to fetch
+     */
+    void OnOverthrowReply(void);
+
+    /**
+     * Give more time to the upcoming leader when it synchronizes with us
+     */
+    void ExtendOverthrowAlarm(const char* sender);
+
+    /**
+     * Election alarm callback
+     */
+    void AlarmTriggered(void);
+
+    /**
+     * Heartbeat timer callback. \n
+     * The leader sends a heartbeat and a follower checks that the heartbeats
+     * of its leader keep coming in. A leader that is suspected to have failed
+     * is handled as if the session with it was lost, which starts a new election
+     */
+    void OnHeartbeatTimer(void);
+
+    /**
+     * Record a heartbeat. Only the heartbeats of the current leader on its session count
+     * @return true if the heartbeat is from the current leader
+     */
+    bool OnHeartbeat(uint32_t sessionId, const char* sender);
+
+    /**
+     * Go through the election rules
+     */
+    void Run(void);
+
+    /**
+     * Announce self as non-leader and drop the state of the election. The
+     * election starts over on the next Run
+     */
+    void Shutdown(void);
+
+    /**
+     * Are we the leader
+     */
+    bool IsLeader(void);
+
+    /**
+     * Is an election about to start
+     */
+    bool IsElectionPending(void);
+
+    /**
+     * Are we taking over from an outgoing leader
+     */
+    bool IsOverthrowing(void);
+
+    /**
+     * Get the current leader of a follower
+     * @param leader     Current leader. Cleared if there is none
+     * @param sessionId  Session with the current leader. 0 while it is not joined
+     */
+    void GetCurrentLeader(ControllerEntry& leader, uint32_t& sessionId);
+
+    /**
+     * Get the number of Controller Services that announced themselves and are tracked
+     */
+    uint32_t GetNumControllers(void);
+
+  private:
+
+    typedef std::map<Rank, ControllerEntry> ControllersMap;
+    typedef std::list<std::pair<qcc::String, uint32_t> > OverThrowList;
+    typedef std::map<Rank, std::pair<ControllerEntry, uint32_t> > SuccessfulJoinSessionReplies;
+    typedef std::list<ControllerEntry> FailedJoinSessionReplies;
+    typedef std::list<uint32_t> SessionLostList;
+    typedef std::map<uint32_t, qcc::String> SessionMemberRemovedMap;
+
+    /**
+     * Announce self as leader
+     */
+    void BecomeLeader(void);
+
+    /**
+     * Announce self as non-leader
+     */
+    void StepDown(void);
+
+    /**
+     * Forget the current leader, and the session with it
+     */
+    void ClearCurrentLeader(void);
+
+    /**
+     * Remove a leader from controllersMap, unless it announced itself again since
+     */
+    void EraseLeaderEntry(ControllerEntry& entry);
+
+    /**
+     * Take over from the outgoing leader
+     */
+    void CompleteOverthrow(void);
+
+    /**
+     * Put the lamp connections in hot standby if we are the highest-ranked
+     * follower, and take them out of hot standby otherwise
+     */
+    void UpdateHotStandby(void);
+
+    /**
+     * Give the Controller Services that rank higher than us and did not announce
+     * themselves as the leader some time to take over from the leader we lost.
+     * They take over one after the other by rank, so we wait one
+     * OEM_CS_LEADER_TAKEOVER_WAIT_MS for each of them
+     */
+    void StartTakeoverWait(void);
+
+    /**
+     * Time left before the takeover wait ends. 0 if there is none
+     */
+    uint32_t GetTakeoverWaitLeft(void);
+
+    /**
+     * Once the takeover wait ends, remove from controllersMap the Controller
+     * Services that rank higher than our leader, or all of them if we have none,
+     * and did not announce themselves since we lost the previous leader. A live
+     * one would have taken over by then, so they crashed or are partitioned
+     * from us
+     */
+    void ExpireControllers(void);
+
+    void RunAsLeader(bool& loopBack);
+    void LookForALeader(void);
+    void ConnectToLeader(bool& loopBack);
+    void CheckLeader(bool& loopBack);
+
+    Bus& bus;
+    Clock& clock;
+
+    Mutex electionMutex;
+
+    Rank myRank;
+
+    ControllersMap controllersMap;
+    ControllerEntry currentLeader;
+    uint32_t leaderSession; /**< 0 while the session with the current leader is not joined */
+    FailureDetector leaderMonitor; /**< heartbeats of the current leader */
+    ControllerEntry outGoingLeader;
+    ControllerEntry upComingLeader;
+    uint64_t leaderLostTimestamp; /**< time we lost our previous leader */
+    uint64_t takeoverDeadline; /**< end of the takeover wait. 0 if there is none */
+
+    OverThrowList overThrowList;
+    FailedJoinSessionReplies failedJoinSessions;
+    FailedJoinSessionReplies sessionAlreadyJoinedReplies;
+    SuccessfulJoinSessionReplies successfulJoinSessions;
+    SessionLostList sessionLostList;
+    SessionMemberRemovedMap sessionMemberRemoved;
+
+    bool alarmTriggered;
+    bool isLeader;
+    bool startElection;
+    bool okToSetAlarm;
+    bool gotOverthrowReply;
+};
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef _FAILURE_DETECTOR_H_
+#define _FAILURE_DETECTOR_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the detector of the failure of the leader
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <stdint.h>
+
+namespace lsf {
+
+/**
+ * Heartbeat based failure detector. \n
+ * The monitored controller is suspected once it missed missedThreshold
+ * heartbeats in a row or, when phiThreshold is set, once the phi-accrual
+ * suspicion level goes above phiThreshold. Phi is computed from the mean of
+ * the last SAMPLE_WINDOW intervals between heartbeats, assuming they are
+ * exponentially distributed. \n
+ * Nothing is suspected before the first heartbeat, so that a controller that
+ * does not send heartbeats is never suspected. \n
+ * The detector is not thread-safe. Times are in milliseconds
+ */
+class FailureDetector {
+  public:
+
+    static const uint32_t SAMPLE_WINDOW = 32; /**< Number of intervals the mean is computed over */
+
+    /**
+     * FailureDetector constructor
+     * @param intervalMs        Expected interval between heartbeats
+     * @param missedThreshold   Number of heartbeats that can be missed
+     * @param phiThreshold      Suspicion level. 0 to use missedThreshold
+     */
+    FailureDetector(uint32_t intervalMs, uint32_t missedThreshold, double phiThreshold = 0);
+
+    /**
+     * Start monitoring a new controller. The samples of the previous one are dropped
+     */
+    void Reset(void);
+
+    /**
+     * Record a heartbeat
+     * @param now   Time of the heartbeat
+     */
+    void Heartbeat(uint64_t now);
+
+    /**
+     * Has a heartbeat been received since the last Reset
+     */
+    bool IsArmed(void) const { return (lastHeartbeat != 0); }
+
+    /**
+     * Get the time elapsed since the last heartbeat. 0 if not armed
+     */
+    uint64_t GetElapsed(uint64_t now) const;
+
+    /**
+     * Get the phi-accrual suspicion level. 0 if not armed
+     */
+    double GetPhi(uint64_t now) const;
+
+    /**
+     * Is the monitored controller suspected to have failed
+     */
+    bool IsSuspected(uint64_t now) const;
+
+  private:
+
+    uint32_t intervalMs;
+    uint32_t missedThreshold;
+    double phiThreshold;
+
+    uint64_t lastHeartbeat;
+    uint64_t samples[SAMPLE_WINDOW];
+    uint32_t numSamples;
+    uint32_t nextSample;
+    uint64_t samplesSum;
+};
+
+}
+
+#endif
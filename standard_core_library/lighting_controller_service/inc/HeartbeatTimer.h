@@ -0,0 +1,86 @@
+#ifndef _HEARTBEAT_TIMER_H_
+#define _HEARTBEAT_TIMER_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the timer that drives the heartbeats between controllers
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+
+#include <Reactor.h>
+#include <Mutex.h>
+
+#include <stdint.h>
+
+namespace lsf {
+
+class LeaderElectionObject;
+
+/**
+ * Timer that calls LeaderElectionObject::OnHeartbeatTimer every interval. \n
+ * The leader sends a heartbeat and the followers check the failure detector
+ * of the leader on each tick. The ticks run on a Reactor rather than on a
+ * thread of their own
+ */
+class HeartbeatTimer : public ReactorHandler {
+  public:
+    /**
+     * class constructor
+     * @param elector       The LeaderElectionObject
+     * @param intervalMs    Interval between the ticks
+     * @param reactor       The reactor that runs the ticks
+     */
+    HeartbeatTimer(LeaderElectionObject& elector, uint32_t intervalMs, Reactor& reactor = Reactor::GetShared());
+    /**
+     * class destructor
+     */
+    virtual ~HeartbeatTimer();
+    /**
+     * Start the ticks
+     */
+    QStatus Start(void);
+    /**
+     * Stop the ticks
+     */
+    void Stop(void);
+    /**
+     * Wait for a tick that is still running after Stop
+     */
+    void Join(void);
+    /**
+     * Invoked by the reactor on each tick
+     */
+    virtual void HandleEvents(uint32_t events);
+
+  private:
+
+    LeaderElectionObject& elector;
+    uint32_t intervalMs;
+    Reactor& reactor;
+    ReactorTimer timer;
+    bool running;
+    Mutex runningLock;
+    uint64_t nextTick; /**< Protected by runningLock */
+};
+
+}
+
+
+#endif
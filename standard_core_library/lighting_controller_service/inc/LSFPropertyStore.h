@@ -26,9 +26,8 @@
 #include <stdio.h>
 #include <iostream>
 #include <string>
-#include <Thread.h>
 #include <Mutex.h>
-#include <Condition.h>
+#include <Reactor.h>
 #include <Rank.h>
 
 #include <alljoyn/about/AboutServiceApi.h>
@@ -39,9 +38,9 @@ namespace lsf {
 
 /**
  * class PropertyStoreImpl. \n
- * Property store implementation
+ * Property store implementation. The config files are written on the shared Reactor
  */
-class LSFPropertyStore : public ajn::services::PropertyStore, public Thread {
+class LSFPropertyStore : public ajn::services::PropertyStore, public ReactorHandler {
 
   public:
     /**
@@ -150,13 +149,17 @@ class LSFPropertyStore : public ajn::services::PropertyStore, public Thread {
     bool IsLeader();
 
     /**
-     * Stop all threads
+     * Stop writing the config files
      */
-    virtual void Stop();
+    void Stop();
     /**
-     * join the stopping threads
+     * Wait for a write that is still running after Stop
      */
-    virtual void Join();
+    void Join();
+    /**
+     * Invoked by the reactor to write the config files
+     */
+    virtual void HandleEvents(uint32_t events);
     /**
      * set true if that controller is a leader
      * @param leader - true or false
@@ -272,7 +275,7 @@ class LSFPropertyStore : public ajn::services::PropertyStore, public Thread {
      */
     PropertyMap properties;
     Mutex propsLock;
-    Condition propsCond;
+    Reactor& reactor;
     AsyncTasks asyncTasks;
     bool running;
 
@@ -288,8 +291,6 @@ class LSFPropertyStore : public ajn::services::PropertyStore, public Thread {
 
     StringMap obsSettings;
 
-    virtual void Run();
-
     /**
      * m_PropertyStoreName
      */
@@ -33,6 +33,7 @@
 #include <Thread.h>
 #include <LSFSemaphore.h>
 #include <Alarm.h>
+#include <Trace.h>
 
 #include <string>
 #include <map>
@@ -40,6 +41,11 @@
 
 #define INITIAL_PASSCODE "000000"
 
+/**
+ * Number of arguments of a lamp method reply that are marshalled from the stack
+ */
+#define LAMP_METHOD_REPLY_STACK_ARGS 8
+
 namespace lsf {
 /**
  * struct is used to contain a list of lamps and the requested field state details
@@ -120,6 +126,17 @@ typedef std::list<PulseStateParams> PulseStateParamsList;
 class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncCB, public ajn::SessionListener,
     public ajn::ProxyBusObject::Listener, public lsf::Thread, public AlarmListener {
   public:
+    /**
+     * State of the connections with the lamps and of the queued requests
+     */
+    typedef struct _LampClientsDiagnostics {
+        uint32_t queueDepth;            /**< Method calls waiting to be sent to the lamps */
+        uint32_t pendingResponses;      /**< Method calls sent to the lamps and waiting for their replies */
+        uint32_t connectedLamps;        /**< Lamps with a session */
+        uint32_t blacklistedLamps;      /**< Lamps whose session failed or was lost */
+        uint32_t retryingLamps;         /**< Lamps whose session is being joined or will be joined again */
+    } LampClientsDiagnostics;
+
     /**
      * LampClients constructor
      * @param controllerSvc - ControllerService
@@ -221,6 +238,29 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
      */
     void GetLampState(const LSFString& lampID, ajn::Message& inMsg);
 
+    /**
+     * Get the state of all the connected lamps in a single reply
+     *
+     * @param inMsg     The original message that led to this call
+     *
+     * States known to the Controller Service are served from the lamp state cache.
+     * The remaining lamps are queried in parallel and the results are aggregated
+     * into one a{sa{sv}} reply
+     */
+    void GetAllLampStates(ajn::Message& inMsg);
+
+    /**
+     * Get the state of the given lamps in a single reply
+     *
+     * @param lampIDs   The lamp ids
+     * @param inMsg     The original message that led to this call
+     *
+     * States known to the Controller Service are served from the lamp state cache.
+     * The remaining lamps are queried in parallel and the results are aggregated
+     * into one a{sa{sv}} reply
+     */
+    void GetLampStates(const LSFStringList& lampIDs, ajn::Message& inMsg);
+
     /**
      * Get the Lamp's details
      *
@@ -281,6 +321,15 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
     void ChangeLampState(const ajn::Message& inMsg, bool groupOperation, bool sceneOperation, TransitionStateParamsList& transitionStateParams,
                          TransitionStateFieldParamsList& transitionStateFieldparams, PulseStateParamsList& pulseParams, LSFString sceneOrMasterSceneID = LSFString());
 
+    /**
+     * Transition a set of lamps to individual states using a single queued
+     * method call with one element per lamp and one aggregated reply
+     *
+     * @param inMsg                 The original message that led to this call
+     * @param transitionStateParams One entry per lamp with its target state and period
+     */
+    void TransitionLampsToStates(const ajn::Message& inMsg, TransitionStateParamsList& transitionStateParams);
+
     /**
      * Get the lamp faults
      *
@@ -330,6 +379,20 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
      * disconnect from lamps
      */
     void DisconnectFromLamps(void);
+    /**
+     * Keep the lamp sessions warm without serving requests. \n
+     * Used by the hot-standby follower: the sessions with the lamps are joined
+     * and introspected and the lamp states are mirrored into the cache, so that
+     * ConnectToLamps serves requests right away when it is promoted.
+     * No command is sent to the lamps and no signal is sent to the apps
+     */
+    void StandbyForLamps(void);
+    /**
+     * Is the lamp manager in hot standby
+     */
+    bool IsInStandby(void) {
+        return standbyForLamps;
+    }
 
     /**
      * register announce handler
@@ -341,8 +404,19 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
      */
     void AlarmTriggered(void);
 
+    /**
+     * Get the state of the connections with the lamps and of the queued requests
+     */
+    void GetDiagnostics(LampClientsDiagnostics& diagnostics);
+
   private:
 
+    /*
+     * Publish the number of lamps in each connection state. Called by the
+     * LampClients thread, which owns activeLamps
+     */
+    void UpdateLampCounts(void);
+
     void HandleAboutAnnounce(LSFString& lampID, LSFString& lampName, uint16_t& port, LSFString& busName);
 
     void LampStateChangedSignalHandler(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& msg);
@@ -351,8 +425,9 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
 
     struct ResponseCounter {
         ResponseCounter() :
-            numWaiting(0), successCount(0), failCount(0), notFoundCount(0), total(0) {
+            numWaiting(0), successCount(0), failCount(0), notFoundCount(0), total(0), aggregateLampStates(false) {
             sceneOrMasterSceneID.clear();
+            lampStates.clear();
         }
 
         void AddLamps(uint32_t numLamps)
@@ -370,6 +445,8 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
         std::list<ajn::MsgArg> standardReplyArgs;
         std::list<ajn::MsgArg> customReplyArgs;
         LSFString sceneOrMasterSceneID;
+        bool aggregateLampStates;
+        LampStateMap lampStates;
     };
 
     struct QueuedMethodCallElement {
@@ -387,19 +464,43 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
             lamps.push_back(lamp);
         }
 
+        /*
+         * Build packedArgs from args, with every Lamp State dictionary in its
+         * packed form, for the lamps that implement the packed state interface.
+         * packedArgs is left empty if one of the dictionaries cannot be packed
+         */
+        void PackLampStates(void) {
+            packedArgs = args;
+            for (size_t i = 0; i < packedArgs.size(); i++) {
+                if (packedArgs[i].typeId == ajn::ALLJOYN_ARRAY) {
+                    if (ER_OK != CreatePackedLampStateArg(args[i], packedArgs[i])) {
+                        packedArgs.clear();
+                        return;
+                    }
+                }
+            }
+        }
+
         LSFStringList lamps;
         std::string interface;
         std::string method;
         std::vector<ajn::MsgArg> args;
+        std::vector<ajn::MsgArg> packedArgs;
     };
 
     typedef std::list<QueuedMethodCallElement> QueuedMethodCallElementList;
 
     struct QueuedMethodCall {
         QueuedMethodCall(const ajn::Message& msg, ajn::MessageReceiver::ReplyHandler replyHandler) :
-            inMsg(msg), replyFunc(replyHandler), responseID(qcc::RandHexString(8).c_str()), responseCounter(), methodCallCount(0) {
+            inMsg(msg), replyFunc(replyHandler), responseID(qcc::RandHexString(8).c_str()), responseCounter(), methodCallCount(0),
+            traceId(Tracer::GetCurrentTraceId()), traceStart(Tracer::GetCurrentTraceStart()), traceQueued(0) {
         }
 
+        /*
+         * Records the span of the request, from its receipt to its reply
+         */
+        ~QueuedMethodCall();
+
         void AddMethodCallElement(QueuedMethodCallElement& element) {
             methodCallElements.push_back(element);
             responseCounter.AddLamps(element.lamps.size());
@@ -411,19 +512,34 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
         ResponseCounter responseCounter;
         QueuedMethodCallElementList methodCallElements;
         uint32_t methodCallCount;
+        uint32_t traceId;
+        uint64_t traceStart;
+        uint64_t traceQueued;
     };
 
     struct QueuedMethodCallContext {
         QueuedMethodCallContext(LSFString lampId, QueuedMethodCall* qCallPtr, LSFString met) :
-            lampID(lampId), queuedCallPtr(qCallPtr), method(met), timeSent(0) { }
+            lampID(lampId), queuedCallPtr(qCallPtr), method(met), timeSent(0), traceId(qCallPtr->traceId), traceSent(0) { }
 
         QueuedMethodCallContext(LSFString lampId, LSFString met) :
-            lampID(lampId), queuedCallPtr(NULL), method(met), timeSent(0) { }
+            lampID(lampId), queuedCallPtr(NULL), method(met), timeSent(0), traceId(Tracer::GetCurrentTraceId()), traceSent(0) { }
+
+        /*
+         * Records the span of the call to the lamp, from its sending to its reply
+         */
+        ~QueuedMethodCallContext();
+
+        void SetTimeSent(void) {
+            timeSent = GetTimestampInMs();
+            traceSent = Tracer::IsEnabled() ? GetTimestampInUs() : 0;
+        }
 
         LSFString lampID;
         QueuedMethodCall* queuedCallPtr;
         LSFString method;
         uint64_t timeSent;
+        uint32_t traceId;
+        uint64_t traceSent;
     };
 
     void SendMethodReply(LSFResponseCode responseCode, ajn::Message msg, std::list<ajn::MsgArg>& stdArgs, std::list<ajn::MsgArg>& custArgs);
@@ -437,11 +553,44 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
     void HandleReplyWithLampResponseCode(ajn::Message& msg, void* context);
     void HandleGetReply(ajn::Message& msg, void* context);
     void HandleGetLampStateReply(ajn::Message& msg, void* context);
+    void HandleGetLampStatesReply(ajn::Message& msg, void* context);
     void HandleReplyWithVariant(ajn::Message& msg, void* context);
     void HandleReplyWithKeyValuePairs(ajn::Message& msg, void* context);
 
     void DecrementWaitingAndSendResponse(QueuedMethodCall* queuedCall, uint32_t success, uint32_t failure, uint32_t notFound, const ajn::MsgArg* arg = NULL);
 
+    struct LampStatesRequest {
+        LampStatesRequest(const ajn::Message& msg, const LSFStringList& lampList, bool all) :
+            inMsg(msg), lamps(lampList), allLamps(all) { }
+
+        ajn::Message inMsg;
+        LSFStringList lamps;
+        bool allLamps;
+    };
+
+    void QueueLampStatesRequest(LampStatesRequest& request);
+
+    void DoGetLampStates(LampStatesRequest& request);
+
+    void UpdateLampStateCache(const LSFString& lampID, const LampState& state);
+
+    void InvalidateLampStateCache(const LSFString& lampID);
+
+    void ClearLampStateCache(void);
+
+    /**
+     * Are the sessions with the lamps to be kept, i.e. is the lamp manager
+     * connected to the lamps or in hot standby
+     */
+    bool MaintainsLampSessions(void) {
+        return (connectToLamps || standbyForLamps);
+    }
+
+    /**
+     * Drop the queued requests. Only the lamp manager of the leader serves requests
+     */
+    void ClearQueuedRequests(void);
+
     typedef enum _LampConnectionState {
         DISCONNECTED = 0,
         JOIN_SESSION_IN_PROGRESS,
@@ -474,6 +623,7 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
             configObject = ajn::ProxyBusObject();
             aboutObject = ajn::ProxyBusObject();
             connectionState = DISCONNECTED;
+            packedState = false;
         }
 
         void Clear(void) {
@@ -516,6 +666,10 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
         uint32_t pendingMethodCallCount;
         LampConnectionState connectionState;
         bool replaced;
+        /*
+         * The lamp implements LampServicePackedStateInterfaceName
+         */
+        bool packedState;
     };
 
     typedef std::map<LSFString, LampConnection*> LampMap;
@@ -555,15 +709,26 @@ class LampClients : public Manager, public ajn::BusAttachment::JoinSessionAsyncC
     std::list<ajn::Message> getAllLampIDsRequests;
     Mutex getAllLampIDsLock;
 
+    std::list<LampStatesRequest> lampStatesRequests;
+    Mutex lampStatesRequestsLock;
+
+    LampStateMap lampStateCache;
+    Mutex lampStateCacheLock;
+
     LSFSemaphore wakeUp;
 
     volatile sig_atomic_t connectToLamps;
+    volatile sig_atomic_t standbyForLamps;
 
     uint32_t disconnectFromLampsTimestamp;
 
     volatile sig_atomic_t alarmTriggered;
 
     Alarm retryAlarm;
+
+    volatile uint32_t connectedLampCount;
+    volatile uint32_t blacklistedLampCount;
+    volatile uint32_t retryingLampCount;
 };
 
 }
@@ -180,6 +180,13 @@ class LampGroupManager : public Manager {
      * @return LSF_OK - on success
      */
     LSFResponseCode GetAllLampGroups(LampGroupMap& lampGroupMap);
+    /**
+     * Get All Lamp Groups with their names and details in a single reply. \n
+     * @param message contains MsgArg with the requested language. \n
+     * Return asynchronously response code, language and an array of (id, name, lamp ids, lamp group ids). \n
+     *   LSF_OK - on success
+     */
+    void GetAllLampGroups(ajn::Message& message);
     /**
      * Update persistent data
      */
@@ -198,23 +205,101 @@ class LampGroupManager : public Manager {
      */
     void GetBlobInfo(uint32_t& checksum, uint64_t& timestamp) {
         lampGroupsLock.Lock();
+        BuildHashTree();
         GetBlobInfoInternal(checksum, timestamp);
         lampGroupsLock.Unlock();
     }
+    /**
+     * Get the blob sequence number and the store hash sent in the heartbeats of the leader
+     */
+    void GetStoreSequence(uint32_t& sequence, uint32_t& checksum) {
+        lampGroupsLock.Lock();
+        GetStoreSequenceInternal(sequence, checksum);
+        lampGroupsLock.Unlock();
+    }
+    /**
+     * Compare the store with the one of the leader, as sent in its heartbeat
+     */
+    void HandleLeaderStore(uint32_t sequence, uint32_t checksum) {
+        lampGroupsLock.Lock();
+        CheckLeaderStore(sequence, checksum);
+        lampGroupsLock.Unlock();
+    }
+    /**
+     * Get the time since the store last matched the store of the leader
+     * @return false if the store is not synchronized with the leader
+     */
+    bool GetReplicaAge(uint64_t& age) {
+        lampGroupsLock.Lock();
+        bool synchronized = GetReplicaAgeInternal(age);
+        lampGroupsLock.Unlock();
+        return synchronized;
+    }
+    /**
+     * Get the hashes of the children of nodes of the hash tree
+     * @param level - level of the nodes
+     * @param nodes - indexes of the nodes in the level
+     * @param hashes - StoreHashTree::FANOUT hashes per node
+     */
+    void GetHashTreeNodes(uint32_t level, const std::vector<uint32_t>& nodes, std::vector<uint64_t>& hashes) {
+        lampGroupsLock.Lock();
+        BuildHashTree();
+        hashTree.GetChildHashes(level, nodes, hashes);
+        lampGroupsLock.Unlock();
+    }
+    /**
+     * Get the IDs and hashes of the entities in buckets of the hash tree
+     * @param buckets - indexes of the buckets
+     * @param entities - the entities in those buckets
+     */
+    void GetEntityHashes(const std::vector<uint32_t>& buckets, StoreEntityHashList& entities) {
+        lampGroupsLock.Lock();
+        BuildHashTree();
+        hashTree.GetEntityHashes(buckets, entities);
+        lampGroupsLock.Unlock();
+    }
+    /**
+     * Get entities in the store format
+     * @param ids - IDs of the entities
+     * @param records - the entities found
+     */
+    void GetEntities(const LSFStringList& ids, StoreJournalRecordList& records) {
+        lampGroupsLock.Lock();
+        GetEntityRecords(ids, records);
+        lampGroupsLock.Unlock();
+    }
+    /**
+     * Handle the entities fetched from another controller to reconcile the stores
+     * @param records - the fetched entities and the entities to delete
+     */
+    void HandleReconciledEntities(const StoreJournalRecordList& records);
     /**
      * Handle Received Blob
      */
     void HandleReceivedBlob(const std::string& blob, uint32_t checksum, uint64_t timestamp);
+    /**
+     * Handle a delta received from the leader. \n
+     * The whole blob is requested from the leader if a change was missed
+     * @param changes - the created, updated and deleted entities
+     * @param checksum - store hash of the leader after the changes
+     */
+    void HandleReceivedDelta(const StoreChangeSet& changes, uint32_t checksum);
 
   protected:
     /**
      * Replace Map
      */
-    void ReplaceMap(std::istringstream& stream);
+    void ReplaceMap(std::istream& stream, bool merge = false);
+
+    virtual void ApplyJournalRecord(const StoreJournalRecord& record);
+
+    virtual void BuildHashTree(void);
+
+    virtual void GetEntityRecords(const LSFStringList& ids, StoreJournalRecordList& records);
     /**
      * Get String
      */
-    virtual bool GetString(std::string& output, uint32_t& checksum, uint64_t& timestamp);
+    virtual bool GetString(std::string& output, StoreChangeSet& changes, uint32_t& checksum, uint64_t& timestamp);
     /**
      * Get all lamps in the mentioned groups
      * @param lampGroupList - groups ids of those who needed to be searched.
@@ -254,6 +254,20 @@ class LampManager : public Manager {
      */
     void GetLampState(ajn::Message& message);
 
+    /**
+     * Process an AllJoyn call to org.allseen.LSF.ControllerService.GetAllLampStates
+     *
+     * @param message   The params
+     */
+    void GetAllLampStates(ajn::Message& message);
+
+    /**
+     * Process an AllJoyn call to org.allseen.LSF.ControllerService.GetLampStates
+     *
+     * @param message   The params
+     */
+    void GetLampStates(ajn::Message& message);
+
     /**
      * Process an AllJoyn call to org.allseen.LSF.ControllerService.GetLampStateField
      *
@@ -268,6 +282,13 @@ class LampManager : public Manager {
      */
     void TransitionLampState(ajn::Message& message);
 
+    /**
+     * Process an AllJoyn call to org.allseen.LSF.ControllerService.TransitionLampsToStates
+     *
+     * @param message   The params
+     */
+    void TransitionLampsToStates(ajn::Message& message);
+
     /**
      * Process an AllJoyn call to org.allseen.LSF.ControllerService.PulseLampWithState
      *
@@ -325,6 +346,24 @@ class LampManager : public Manager {
     void DisconnectFromLamps(void) {
         lampClients.DisconnectFromLamps();
     }
+    /**
+     * Keep the lamp sessions warm without serving requests
+     */
+    void StandbyForLamps(void) {
+        lampClients.StandbyForLamps();
+    }
+    /**
+     * Is the lamp manager in hot standby
+     */
+    bool IsInStandby(void) {
+        return lampClients.IsInStandby();
+    }
+    /**
+     * Get the state of the connections with the lamps and of the queued requests
+     */
+    void GetLampClientsDiagnostics(LampClients::LampClientsDiagnostics& diagnostics) {
+        lampClients.GetDiagnostics(diagnostics);
+    }
 
   private:
 
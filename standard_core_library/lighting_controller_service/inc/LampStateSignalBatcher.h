@@ -0,0 +1,92 @@
+#ifndef _LAMP_STATE_SIGNAL_BATCHER_H_
+#define _LAMP_STATE_SIGNAL_BATCHER_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the batching of the lamp state signals of the Controller Service
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <LSFTypes.h>
+#include <Mutex.h>
+#include <Alarm.h>
+#include <OEM_CS_Config.h>
+
+namespace lsf {
+
+class ControllerService;
+
+/**
+ * Aggregates the lamp state changes into LampsStateChanged signals. \n
+ * The first change starts a batching window; the changes received within the
+ * window are sent in one signal when it expires, with the last state of each lamp.
+ * When OEM_CS_SEND_PER_LAMP_STATE_SIGNAL is set, a LampStateChanged signal per
+ * lamp follows the batch for the apps that do not know LampsStateChanged.
+ */
+class LampStateSignalBatcher : public AlarmListener {
+  public:
+    /**
+     * class constructor
+     * @param service   The Controller Service
+     * @param windowMs  Batching window. 0 sends every change immediately
+     */
+    LampStateSignalBatcher(ControllerService& service, uint32_t windowMs = OEM_CS_LAMP_STATE_SIGNAL_BATCH_WINDOW_MS);
+    /**
+     * class destructor
+     */
+    ~LampStateSignalBatcher();
+    /**
+     * Queue the new state of a lamp
+     */
+    void LampStateChanged(const LSFString& lampID, const LampState& state);
+    /**
+     * Change the batching window
+     * @param windowMs  Batching window. 0 sends every change immediately
+     */
+    void SetWindow(uint32_t windowMs);
+    /**
+     * Send the queued changes now
+     */
+    void Flush(void);
+    /**
+     * Invoked when the batching window expires
+     */
+    virtual void AlarmTriggered(void);
+    /**
+     * Send the queued changes and stop the batching
+     */
+    void Stop(void);
+    /**
+     * Join after Stop
+     */
+    void Join(void);
+
+  private:
+
+    ControllerService& service;
+    Mutex flushLock;
+    Mutex pendingLock;
+    LampStateMap pendingStates;
+    uint32_t window;
+    Alarm alarm;
+};
+
+}
+
+#endif
@@ -32,17 +32,38 @@
 #include <Alarm.h>
 #include <OEM_CS_Config.h>
 #include <Rank.h>
+#include <ElectionStateMachine.h>
+#include <StoreJournal.h>
+#include <BlobTransfer.h>
+#include <StoreHashTree.h>
+#include <HeartbeatTimer.h>
+
+#include <vector>
 
 namespace lsf {
 
 class ControllerService;
 /**
  * LeaderElectionObject class. \n
- * Implementing the algorithm of leader election. \n
- * Implementing the election behavior of the entity as a leader and also as a follower. \n
+ * Runs the leader election of ElectionStateMachine on the bus, and the state
+ * sync of the entity as a leader and also as a follower. \n
  */
 class LeaderElectionObject : public ajn::BusObject, public Thread, public AlarmListener, public OEM_CS_NetworkCallback {
   public:
+    /**
+     * State of the leader election, as seen by this Controller Service
+     */
+    typedef struct _ElectionState {
+        bool isLeader;                  /**< This Controller Service is the leader */
+        qcc::String leaderBusName;      /**< Bus name of the current leader of a follower. Empty if there is none */
+        uint64_t leaderRankHigherBits;  /**< Rank of the current leader of a follower */
+        uint64_t leaderRankLowerBits;   /**< Rank of the current leader of a follower */
+        bool storesSynchronized;        /**< The stores of a follower are synchronized with its leader */
+        uint32_t replicaStaleness;      /**< See GetReplicaStaleness */
+        uint32_t knownControllers;      /**< Other Controller Services that announced themselves */
+        bool electionPending;           /**< An election is about to start */
+    } ElectionState;
+
     /**
      * constructor
      */
@@ -71,17 +92,56 @@ class LeaderElectionObject : public ajn::BusObject, public Thread, public AlarmL
      * get blob reply. \n
      * Get data and metadata about lamps
      */
-    void SendGetBlobReply(ajn::Message& message, LSFBlobType type, std::string blob, uint32_t checksum, uint64_t timestamp);
+    void SendGetBlobReply(ajn::Message& message, LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp);
     /**
      * Send blob update. \n
      * Get data and metadata about lamps
      */
-    QStatus SendBlobUpdate(ajn::SessionId session, LSFBlobType type, std::string blob, uint32_t checksum, uint64_t timestamp);
+    QStatus SendBlobUpdate(ajn::SessionId session, LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp);
     /**
      * send blob update. \n
      * Send data and metadata about lamps
      */
-    QStatus SendBlobUpdate(LSFBlobType type, std::string blob, uint32_t checksum, uint64_t timestamp);
+    QStatus SendBlobUpdate(LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp);
+    /**
+     * send blob delta. \n
+     * Send the entities that changed since the previous update to the followers
+     */
+    QStatus SendBlobDelta(ajn::SessionId session, LSFBlobType type, const StoreChangeSet& changes, uint32_t checksum, uint64_t timestamp);
+    /**
+     * Send a heartbeat to the followers. \n
+     * Called by the leader on every tick of the heartbeat timer
+     */
+    QStatus SendHeartbeat(ajn::SessionId session);
+    /**
+     * Heartbeat timer callback. \n
+     * The leader sends a heartbeat and a follower checks that the heartbeats
+     * of its leader keep coming in. A leader that is suspected to have failed
+     * is handled as if the session with it was lost, which starts a new election
+     */
+    void OnHeartbeatTimer(void);
+    /**
+     * Request the whole blob from the leader. \n
+     * Used by a follower that missed a delta
+     */
+    QStatus RequestBlob(LSFBlobType type);
+    /**
+     * Get how far behind the leader the stores of this follower may be. \n
+     * The heartbeats of the leader carry the blob sequence number and the store
+     * hash of the last change it sent. A store is synchronized once the state
+     * sync with the current leader completed, it has no pending resync and it
+     * matched a heartbeat. The leader commits the changes it accepts within a
+     * debounce window before it sends them, so the staleness is the time since
+     * the stores last matched the leader plus OEM_CS_PERSISTENCE_DEBOUNCE_WINDOW_MS
+     * @param staleness      Staleness in milliseconds. ReadReplicaUnsynchronized if the stores are not synchronized
+     * @param leaderBusName  Bus name of the current leader. Empty if there is none
+     * @return false if the stores are not synchronized with a leader
+     */
+    bool GetReplicaStaleness(uint32_t& staleness, qcc::String& leaderBusName);
+    /**
+     * Get the state of the leader election
+     */
+    void GetElectionState(ElectionState& state);
     /**
      * On session member removed
      */
@@ -97,8 +157,8 @@ class LeaderElectionObject : public ajn::BusObject, public Thread, public AlarmL
     /**
      * Get my rank
      */
-    Rank& GetRank(void) {
-        return myRank;
+    Rank GetRank(void) {
+        return election.GetRank();
     }
 
     void Connected(void);
@@ -107,15 +167,22 @@ class LeaderElectionObject : public ajn::BusObject, public Thread, public AlarmL
 
   private:
 
-    /**
-     * Clear the state of the LeaderElectionObject
-     */
-    void ClearState(void);
-
     struct Synchronization {
         volatile int32_t numWaiting;
     };
 
+    /**
+     * State of the reconciliation of one store with the store of the current leader
+     */
+    struct Reconciliation {
+        LSFBlobType type;
+        Synchronization* sync;
+        uint32_t level; /**< level of the nodes being compared. StoreHashTree::DEPTH once the buckets are found */
+        std::vector<uint32_t> nodes; /**< nodes of the level whose hashes differ */
+        LSFStringList ids; /**< IDs of the entities being fetched */
+        StoreJournalRecordList deletes; /**< entities the leader does not have */
+    };
+
     void GetChecksumAndModificationTimestamp(const ajn::InterfaceDescription::Member* member, ajn::Message& msg);
     void OnGetChecksumAndModificationTimestampReply(ajn::Message& message, void* context);
 
@@ -125,98 +192,123 @@ class LeaderElectionObject : public ajn::BusObject, public Thread, public AlarmL
     void GetBlob(const ajn::InterfaceDescription::Member* member, ajn::Message& msg);
     void OnGetBlobReply(ajn::Message& message, void* context);
 
+    void GetHashTreeNodes(const ajn::InterfaceDescription::Member* member, ajn::Message& msg);
+    void OnGetHashTreeNodesReply(ajn::Message& message, void* context);
+
+    void GetEntityHashes(const ajn::InterfaceDescription::Member* member, ajn::Message& msg);
+    void OnGetEntityHashesReply(ajn::Message& message, void* context);
+
+    void GetEntities(const ajn::InterfaceDescription::Member* member, ajn::Message& msg);
+    void OnGetEntitiesReply(ajn::Message& message, void* context);
+
+    /**
+     * Set up the session with the current leader and start the state sync with it
+     */
+    bool StartStateSync(const ElectionStateMachine::ControllerEntry& leader, ajn::SessionId sessionId, bool overthrow);
+
+    /**
+     * Call a state sync method on the current leader
+     */
+    QStatus CallLeaderMethod(const char* method, ajn::MessageReceiver::ReplyHandler handler, const ajn::MsgArg* args, size_t numArgs, void* context);
+
+    /**
+     * Reconcile a store with the store of the current leader. \n
+     * The hash trees of the stores are compared level by level down to the
+     * buckets that differ, then only the entities that differ are fetched. This
+     * takes StoreHashTree::DEPTH + 2 round trips whatever the size of the store
+     */
+    QStatus StartReconciliation(LSFBlobType type, Synchronization* sync);
+
+    /**
+     * Request the next step of a reconciliation from the current leader
+     */
+    QStatus ContinueReconciliation(Reconciliation* reconciliation);
+
+    /**
+     * End a reconciliation. The whole blob is fetched if it failed
+     */
+    void FinishReconciliation(Reconciliation* reconciliation, bool fetchBlob);
+
+    /**
+     * Send Overthrow once all the stores are synchronized
+     */
+    void FinishSynchronization(Synchronization* sync);
+
+    /**
+     * Get the hashes of the children of nodes of the hash tree of a store
+     */
+    bool GetLocalHashTreeNodes(LSFBlobType type, uint32_t level, const std::vector<uint32_t>& nodes, std::vector<uint64_t>& hashes);
+
+    /**
+     * Get the IDs and hashes of the entities in buckets of the hash tree of a store
+     */
+    bool GetLocalEntityHashes(LSFBlobType type, const std::vector<uint32_t>& buckets, StoreEntityHashList& entities);
+
+    /**
+     * Get entities of a store in the store format
+     */
+    bool GetLocalEntities(LSFBlobType type, const LSFStringList& ids, StoreJournalRecordList& records);
+
+    /**
+     * Pass the entities fetched during a reconciliation to the manager of the store
+     */
+    void HandleReconciledEntities(LSFBlobType type, const StoreJournalRecordList& records);
+
     void OnBlobChanged(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& msg);
 
+    void OnBlobDelta(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& msg);
+
+    void OnBlobChunk(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& msg);
+
+    void OnHeartbeat(const ajn::InterfaceDescription::Member* member, const char* sourcePath, ajn::Message& msg);
+
+    /**
+     * Send a blob compressed in BlobChunk signals
+     */
+    QStatus SendBlobChunks(const char* destination, ajn::SessionId session, LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp);
+
+    /**
+     * Pass a blob received from another Controller Service to its manager
+     */
+    void HandleReceivedBlob(LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp);
+
     ControllerService& controller;
     BusAttachment& bus;
 
     class Handler;
     Handler* handler;
 
-    // everything below is related to leader election
-    struct ControllerEntry {
-      public:
-        ajn::SessionPort port;
-        qcc::String busName;
-        qcc::String deviceId;
-        Rank rank;
-        bool isLeader;
-        uint64_t announcementTimestamp;
-
-        void Clear() {
-            busName = "";
-            deviceId = "";
-            rank = Rank();
-            isLeader = false;
-            port = 0;
-            announcementTimestamp = 0;
-        }
-    };
-
     void OnSessionLost(SessionId sessionId);
     void OnSessionJoined(QStatus status, SessionId sessionId, void* context);
 
-    typedef std::list<ajn::Message> OverThrowList;
-    typedef std::map<Rank, ControllerEntry> ControllersMap;
-    typedef std::map<Rank, std::pair<ControllerEntry, uint32_t> > SuccessfulJoinSessionReplies;
-    typedef std::list<ControllerEntry> FailedJoinSessionReplies;
-    typedef std::list<uint32_t> SessionLostList;
-    typedef std::map<uint32_t, const char*> SessionMemberRemovedMap;
-    typedef struct _CurrentLeader {
-        ControllerEntry controllerDetails;
-        ajn::ProxyBusObject proxyObj;
-
-        void Clear(void) {
-            controllerDetails.Clear();
-            proxyObj = ProxyBusObject();
-        }
-    } CurrentLeader;
+    ElectionStateMachine election;
 
     Mutex currentLeaderMutex;
-    CurrentLeader currentLeader;
-
-    Mutex failedJoinSessionMutex;
-    FailedJoinSessionReplies failedJoinSessions;
-
-    Mutex sessionAlreadyJoinedRepliesMutex;
-    FailedJoinSessionReplies sessionAlreadyJoinedReplies;
-
-    Mutex successfulJoinSessionMutex;
-    SuccessfulJoinSessionReplies successfulJoinSessions;
-
-    Mutex sessionLostMutex;
-    SessionLostList sessionLostList;
+    ajn::ProxyBusObject leaderProxy; /**< state sync object of the current leader. Invalid while there is none */
+    bool storesSynchronized; /**< true once the state sync with the current leader completed. Protected by currentLeaderMutex */
 
-    Mutex sessionMemberRemovedMutex;
-    SessionMemberRemovedMap sessionMemberRemoved;
-
-    Mutex controllersMapMutex;
-    ControllersMap controllersMap;
+    HeartbeatTimer heartbeatTimer;
+    volatile int32_t heartbeatSequence;
 
     Mutex overThrowListMutex;
-    OverThrowList overThrowList;
-
-    Rank myRank;
+    std::map<uint32_t, ajn::Message> overThrowCalls; /**< Overthrow calls waiting for their reply, by call ID */
+    uint32_t nextOverthrowCallId;
 
     Mutex connectionStateMutex;
     volatile sig_atomic_t isRunning;
 
     const ajn::InterfaceDescription::Member* blobChangedSignal;
+    const ajn::InterfaceDescription::Member* blobDeltaSignal;
+    const ajn::InterfaceDescription::Member* blobChunkSignal;
+    const ajn::InterfaceDescription::Member* heartbeatSignal;
+
+    volatile int32_t nextTransferId;
+    BlobReassembler blobReassembler;
 
     LSFSemaphore wakeSem;
 
     Mutex electionAlarmMutex;
     Alarm electionAlarm;
-
-    volatile sig_atomic_t alarmTriggered;
-    volatile sig_atomic_t isLeader;
-    volatile sig_atomic_t startElection;
-    volatile sig_atomic_t okToSetAlarm;
-    volatile sig_atomic_t gotOverthrowReply;
-    Mutex outGoingLeaderMutex;
-    ControllerEntry outGoingLeader;
-    Mutex upComingLeaderMutex;
-    ControllerEntry upComingLeader;
 };
 
 }
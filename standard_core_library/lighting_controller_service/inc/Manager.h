@@ -29,11 +29,15 @@
 
 #include <LSFResponseCodes.h>
 #include <LSFTypes.h>
+#include <StoreFile.h>
+#include <StoreJournal.h>
+#include <StoreHashTree.h>
 
 #include <iostream>
 #include <sstream>
 #include <string>
 #include <vector>
+#include <map>
 #include <Mutex.h>
 #include <signal.h>
 
@@ -49,7 +53,8 @@ class Manager : public ajn::MessageReceiver {
     static const size_t ID_STR_LEN = 8;
 
   protected:
-    static const size_t MAX_FILE_LEN = 1024 * 127; /**< Max file len */
+    static const size_t MAX_FILE_LEN = 1024 * 1024 * 4; /**< Max file len. Longer blobs than BlobTransfer::INLINE_BLOB_LEN are sent compressed in chunks */
+    static const size_t JOURNAL_COMPACTION_THRESHOLD = 1024 * 64; /**< Journal length that triggers a new snapshot */
 
   public:
     /**
@@ -68,6 +73,29 @@ class Manager : public ajn::MessageReceiver {
      * Schedule File Write
      */
     void ScheduleFileWrite(bool blobUpdate = false, bool initState = false);
+    /**
+     * Schedule a journal write for a created or modified entity. \n
+     * Must be called with the lock of the derived manager held
+     * @param id        ID of the entity
+     * @param entity    The entity serialized in the store format
+     */
+    void ScheduleEntityWrite(const LSFString& id, const std::string& entity);
+    /**
+     * Schedule a journal write for a deleted entity. \n
+     * Must be called with the lock of the derived manager held
+     * @param id        ID of the entity
+     */
+    void ScheduleEntityDelete(const LSFString& id);
+    /**
+     * Commit the pending changes and serve the pending blob reads. \n
+     * Called on the persistence thread
+     */
+    virtual void ReadWriteFile(void) { };
+    /**
+     * Load the persistent store at startup. \n
+     * Called on a StoreLoaderThread, before the Controller Service serves requests
+     */
+    virtual void ReadSavedData(void) { };
 
     //protected:
     /**
@@ -84,13 +112,14 @@ class Manager : public ajn::MessageReceiver {
 
     const std::string filePath; /**< the file location */
     /**
-     * Reading from file
+     * Map and validate the persistent store and record its checksum and timestamp. \n
+     * A store still in the legacy text format is rewritten in the binary format.
      */
-    bool ValidateFileAndRead(std::istringstream& filestream);
+    bool ValidateFileAndRead(StoreFile& file);
     /**
-     * Reading from file
+     * Map and validate the persistent store
      */
-    bool ValidateFileAndReadInternal(uint32_t& checksum, uint64_t& timestamp, std::istringstream& filestream);
+    bool ValidateFileAndReadInternal(uint32_t& checksum, uint64_t& timestamp, StoreFile& file);
     /**
      * Get checksum of file
      */
@@ -98,20 +127,137 @@ class Manager : public ajn::MessageReceiver {
     /**
      * Get string from file
      */
-    virtual bool GetString(std::string& output, uint32_t& checksum, uint64_t& timestamp) { return false; };
+    virtual bool GetString(std::string& output, StoreChangeSet& changes, uint32_t& checksum, uint64_t& timestamp) { return false; };
     /**
      * Get file information \n
-     * Answer returns synchronously by the reference parameters
+     * Answer returns synchronously by the reference parameters. \n
+     * The checksum is the root of the hash tree folded to 32 bits, so that it
+     * only depends on the entities and not on the order they were serialized in.
+     * BuildHashTree must have been called
      * @param checksum
      * @param time
      */
     void GetBlobInfoInternal(uint32_t& checksum, uint64_t& time);
+    /**
+     * Build the hash tree of the store if it is not up to date. \n
+     * Must be called with the lock of the derived manager held
+     */
+    virtual void BuildHashTree(void) { };
+    /**
+     * Get entities of the store in the store format. \n
+     * Must be called with the lock of the derived manager held. Unknown IDs are skipped
+     * @param ids       IDs of the entities
+     * @param records   One RECORD_UPDATE record per entity found
+     */
+    virtual void GetEntityRecords(const LSFStringList& ids, StoreJournalRecordList& records) { };
+    /**
+     * Apply the entities fetched from another controller during a reconciliation
+     * to the map of the derived manager. \n
+     * Must be called with the lock of the derived manager held. The entities
+     * replace the local ones whatever their versions, so the blob sequence
+     * number is unknown afterwards
+     * @param records   RECORD_UPDATE records of the fetched entities and
+     *                  RECORD_DELETE records of the entities the other controller does not have
+     */
+    void ApplyReconciledEntities(const StoreJournalRecordList& records);
     /**
      * Write File With Checksum And Timestamp
+     * @return false if the file could not be written
+     */
+    bool WriteFileWithChecksumAndTimestamp(const std::string& str, uint32_t checksum, uint64_t timestamp);
+    /**
+     * Take the entity changes scheduled since the last write. \n
+     * Must be called with the lock of the derived manager held. The records are
+     * left empty when the next write must be a full snapshot. Local changes get
+     * the next blob sequence number, which is also the new version of each entity
+     * @return true if the write is a full snapshot: there are no records, the
+     *         journal is not open or it grew past JOURNAL_COMPACTION_THRESHOLD.
+     *         Otherwise only the records are written and the store need not be serialized
+     */
+    bool TakeStoreChanges(StoreChangeSet& changes);
+    /**
+     * Persist a change. The changes are appended to the journal when str is
+     * empty; a full snapshot is written and the journal is reset otherwise
+     * @param str       The whole store serialized in the store format, or empty
+     *                  if TakeStoreChanges did not ask for a snapshot
+     * @param changes   Changes from TakeStoreChanges
+     * @param checksum  Checksum of str
+     * @param timestamp Timestamp of the change
+     * @return false if the changes could not be journalled or the snapshot could
+     *         not be written, and a snapshot must be scheduled
+     */
+    bool CommitToStore(const std::string& str, const StoreChangeSet& changes, uint32_t checksum, uint64_t timestamp);
+    /**
+     * Send a committed change to the followers. \n
+     * Only the changed entities are sent when there are some and they are smaller
+     * than the whole blob; the whole blob is sent otherwise
+     * @param type      The blob type of the derived manager
+     * @param str       The whole store serialized in the store format, or empty
+     *                  if the change was only journalled
+     * @param changes   Changes from TakeStoreChanges
+     * @param checksum  Checksum of str
+     * @param timestamp Timestamp of the change
+     * @return false if the whole blob must be sent but str is empty
+     */
+    bool SendBlobUpdate(LSFBlobType type, const std::string& str, const StoreChangeSet& changes, uint32_t checksum, uint64_t timestamp);
+    /**
+     * Apply a delta received from the leader to the map of the derived manager. \n
+     * Must be called with the lock of the derived manager held. The delta is only
+     * applied if it starts at the blob sequence number of this store or, when the
+     * sequence number is unknown after a full blob, at the store hash of this store
+     * @return false if the delta does not apply and the whole blob must be fetched
+     */
+    bool ApplyStoreChanges(const StoreChangeSet& changes);
+    /**
+     * Finish applying a delta received from the leader. \n
+     * Must be called with the lock of the derived manager held
+     * @param checksum  Store hash of the store of the leader
+     * @return false if the store diverged from the leader and the whole blob must be fetched
      */
-    void WriteFileWithChecksumAndTimestamp(const std::string& str, uint32_t checksum, uint64_t timestamp);
+    bool CompleteStoreChanges(uint32_t checksum);
+    /**
+     * Is a blob received from another controller to replace this store. \n
+     * Must be called with the lock of the derived manager held
+     * @param checksum  Checksum of the received blob
+     * @param timestamp Age of the received blob
+     */
+    bool AcceptReceivedBlob(uint32_t checksum, uint64_t timestamp);
+    /**
+     * Get the blob sequence number and the store hash of the last change sent
+     * to the followers. \n
+     * Must be called with the lock of the derived manager held
+     */
+    void GetStoreSequenceInternal(uint32_t& sequence, uint32_t& checksum);
+    /**
+     * Compare the store with the store of the leader, as sent in its heartbeat. \n
+     * Must be called with the lock of the derived manager held. A store that
+     * matches records the time it did. A store received whole takes the blob
+     * sequence number of the leader once their store hashes match
+     * @param sequence  Blob sequence number of the store of the leader
+     * @param checksum  Store hash of the store of the leader
+     */
+    void CheckLeaderStore(uint32_t sequence, uint32_t checksum);
+    /**
+     * Get the time since the store last matched the store of the leader. \n
+     * Must be called with the lock of the derived manager held
+     * @return false while the whole blob is requested from the leader, the blob
+     *         sequence number is unknown or the store never matched the leader
+     */
+    bool GetReplicaAgeInternal(uint64_t& age);
+    /**
+     * Replay the journal on top of the snapshot loaded by ValidateFileAndRead,
+     * and build the hash tree of the loaded store. \n
+     * Never call this when the ControllerService is up; it isn't thread-safe!
+     * @return true if entity changes were replayed
+     */
+    bool ReplayJournal(void);
+    /**
+     * Apply a replayed journal record to the map of the derived manager
+     */
+    virtual void ApplyJournalRecord(const StoreJournalRecord& record) { };
 
     uint32_t checkSum; /**< checkSum of the file */
+    bool checkSumValid; /**< false once changes were only journalled, until the store is serialized again */
     uint64_t timeStamp; /**< timestamp of the file */
     bool blobUpdateCycle; /**< blob Update Cycle */
     bool initialState; /**< initial state */
@@ -119,6 +265,18 @@ class Manager : public ajn::MessageReceiver {
     std::list<ajn::Message> readBlobMessages; /**< Read blob messages */
 
     volatile sig_atomic_t sendUpdate; /**< send update */
+
+    StoreJournal journal; /**< journal of the changes since the last snapshot */
+    StoreJournalRecordList pendingChanges; /**< entity changes waiting for the next write */
+    bool snapshotRequired; /**< true if the next write must be a full snapshot */
+
+    uint32_t blobSequence; /**< sequence number of the last change of the blob */
+    bool blobSequenceValid; /**< false if the blob was received whole and its sequence number is unknown */
+    bool resyncRequested; /**< true if the whole blob was requested from the leader */
+    std::map<LSFString, uint32_t> entityVersions; /**< sequence number of the last change of each entity */
+    StoreHashTree hashTree; /**< hash tree of the entities, compared with other controllers to find the differing ones */
+    uint32_t storeHash; /**< store hash after the last write, which the next delta applies to */
+    uint64_t syncedTimestamp; /**< time the store last matched the heartbeat of the leader. 0 if it never did */
 };
 
 }
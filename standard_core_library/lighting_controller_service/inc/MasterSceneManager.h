@@ -122,6 +122,13 @@ class MasterSceneManager : public Manager {
      * @return LSF_OK on succedd.
      */
     LSFResponseCode GetAllMasterScenes(MasterSceneMap& masterSceneMap);
+    /**
+     * Get All master scenes with their names and scene lists in a single reply. \n
+     * @param message - contains the requested language. \n
+     * Return asynchronously response code, language and an array of (id, name, scene ids). \n
+     *   LSF_OK - on success
+     */
+    void GetAllMasterScenes(ajn::Message& message);
     /**
      * Read Saved Data. \n
      * Reads saved info from persistent data
@@ -144,7 +151,7 @@ class MasterSceneManager : public Manager {
      * @param checksum - of the output
      * @param timestamp - current time
      */
-    virtual bool GetString(std::string& output, uint32_t& checksum, uint64_t& timestamp);
+    virtual bool GetString(std::string& output, StoreChangeSet& changes, uint32_t& checksum, uint64_t& timestamp);
     /**
      * Get file information. \n
      * Derived from Manager class. \n
@@ -154,9 +161,74 @@ class MasterSceneManager : public Manager {
      */
     void GetBlobInfo(uint32_t& checksum, uint64_t& timestamp) {
         masterScenesLock.Lock();
+        BuildHashTree();
         GetBlobInfoInternal(checksum, timestamp);
         masterScenesLock.Unlock();
     }
+    /**
+     * Get the blob sequence number and the store hash sent in the heartbeats of the leader
+     */
+    void GetStoreSequence(uint32_t& sequence, uint32_t& checksum) {
+        masterScenesLock.Lock();
+        GetStoreSequenceInternal(sequence, checksum);
+        masterScenesLock.Unlock();
+    }
+    /**
+     * Compare the store with the one of the leader, as sent in its heartbeat
+     */
+    void HandleLeaderStore(uint32_t sequence, uint32_t checksum) {
+        masterScenesLock.Lock();
+        CheckLeaderStore(sequence, checksum);
+        masterScenesLock.Unlock();
+    }
+    /**
+     * Get the time since the store last matched the store of the leader
+     * @return false if the store is not synchronized with the leader
+     */
+    bool GetReplicaAge(uint64_t& age) {
+        masterScenesLock.Lock();
+        bool synchronized = GetReplicaAgeInternal(age);
+        masterScenesLock.Unlock();
+        return synchronized;
+    }
+    /**
+     * Get the hashes of the children of nodes of the hash tree
+     * @param level - level of the nodes
+     * @param nodes - indexes of the nodes in the level
+     * @param hashes - StoreHashTree::FANOUT hashes per node
+     */
+    void GetHashTreeNodes(uint32_t level, const std::vector<uint32_t>& nodes, std::vector<uint64_t>& hashes) {
+        masterScenesLock.Lock();
+        BuildHashTree();
+        hashTree.GetChildHashes(level, nodes, hashes);
+        masterScenesLock.Unlock();
+    }
+    /**
+     * Get the IDs and hashes of the entities in buckets of the hash tree
+     * @param buckets - indexes of the buckets
+     * @param entities - the entities in those buckets
+     */
+    void GetEntityHashes(const std::vector<uint32_t>& buckets, StoreEntityHashList& entities) {
+        masterScenesLock.Lock();
+        BuildHashTree();
+        hashTree.GetEntityHashes(buckets, entities);
+        masterScenesLock.Unlock();
+    }
+    /**
+     * Get entities in the store format
+     * @param ids - IDs of the entities
+     * @param records - the entities found
+     */
+    void GetEntities(const LSFStringList& ids, StoreJournalRecordList& records) {
+        masterScenesLock.Lock();
+        GetEntityRecords(ids, records);
+        masterScenesLock.Unlock();
+    }
+    /**
+     * Handle the entities fetched from another controller to reconcile the stores
+     * @param records - the fetched entities and the entities to delete
+     */
+    void HandleReconciledEntities(const StoreJournalRecordList& records);
     /**
      * Write the blob containing scene information to persistent data. \n
      * @param blob - string containing scenes information.
@@ -164,10 +236,23 @@ class MasterSceneManager : public Manager {
      * @param timestamp
      */
     void HandleReceivedBlob(const std::string& blob, uint32_t checksum, uint64_t timestamp);
+    /**
+     * Handle a delta received from the leader. \n
+     * The whole blob is requested from the leader if a change was missed
+     * @param changes - the created, updated and deleted entities
+     * @param checksum - store hash of the leader after the changes
+     */
+    void HandleReceivedDelta(const StoreChangeSet& changes, uint32_t checksum);
 
   private:
 
-    void ReplaceMap(std::istringstream& stream);
+    void ReplaceMap(std::istream& stream, bool merge = false);
+
+    virtual void ApplyJournalRecord(const StoreJournalRecord& record);
+
+    virtual void BuildHashTree(void);
+
+    virtual void GetEntityRecords(const LSFStringList& ids, StoreJournalRecordList& records);
 
     MasterSceneMap masterScenes;
     Mutex masterScenesLock;
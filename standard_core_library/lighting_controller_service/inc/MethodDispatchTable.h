@@ -0,0 +1,167 @@
+#ifndef _METHOD_DISPATCH_TABLE_H_
+#define _METHOD_DISPATCH_TABLE_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the method dispatch table of the Controller Service
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <vector>
+
+namespace lsf {
+
+/**
+ * Table of method handlers keyed by the interface member that AllJoyn
+ * dispatches the method call for. \n
+ * The handlers are added at startup and the table is then sealed. A sealed
+ * table is immutable, so lookups take no lock: they hash the address of the
+ * member into an open-addressing table that is kept at most half full. \n
+ * The table owns the handlers
+ */
+template <typename KEY, typename HANDLER>
+class MethodDispatchTable {
+  public:
+    /**
+     * MethodDispatchTable constructor
+     */
+    MethodDispatchTable() : sealed(false), mask(0) { }
+
+    /**
+     * MethodDispatchTable destructor
+     */
+    ~MethodDispatchTable() {
+        for (typename std::vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+            delete it->handler;
+        }
+    }
+
+    /**
+     * Add a handler. A handler already added for the member is replaced. \n
+     * Not thread-safe. The handler is deleted if the table is sealed
+     * @return false if the table is sealed
+     */
+    bool Add(KEY member, HANDLER* handler) {
+        if (sealed) {
+            delete handler;
+            return false;
+        }
+        for (typename std::vector<Entry>::iterator it = entries.begin(); it != entries.end(); ++it) {
+            if (it->member == member) {
+                delete it->handler;
+                it->handler = handler;
+                return true;
+            }
+        }
+        Entry entry;
+        entry.member = member;
+        entry.handler = handler;
+        entries.push_back(entry);
+        return true;
+    }
+
+    /**
+     * Build the hash table. No handler can be added afterwards. \n
+     * Must happen before the table is shared with the threads that look it up
+     */
+    void Seal(void) {
+        if (sealed) {
+            return;
+        }
+        size_t size = 8;
+        while (size < (2 * entries.size())) {
+            size <<= 1;
+        }
+        mask = size - 1;
+        slots.assign(size, -1);
+        for (size_t i = 0; i < entries.size(); i++) {
+            size_t slot = Hash(entries[i].member);
+            while (slots[slot] != -1) {
+                slot = (slot + 1) & mask;
+            }
+            slots[slot] = static_cast<int32_t>(i);
+        }
+        sealed = true;
+    }
+
+    /**
+     * Is the table sealed
+     */
+    bool IsSealed(void) const { return sealed; }
+
+    /**
+     * Find the handler of a member. Lock-free once the table is sealed
+     * @return NULL if there is none, or if the table is not sealed
+     */
+    HANDLER* Find(KEY member) const {
+        if (!sealed) {
+            return NULL;
+        }
+        size_t slot = Hash(member);
+        while (slots[slot] != -1) {
+            const Entry& entry = entries[slots[slot]];
+            if (entry.member == member) {
+                return entry.handler;
+            }
+            slot = (slot + 1) & mask;
+        }
+        return NULL;
+    }
+
+    /**
+     * Number of handlers
+     */
+    size_t Size(void) const { return entries.size(); }
+
+    /**
+     * Member of the handler at index, in the order the handlers were added
+     */
+    KEY GetMember(size_t index) const { return entries[index].member; }
+
+  private:
+
+    struct Entry {
+        KEY member;
+        HANDLER* handler;
+    };
+
+    /*
+     * Members are heap objects: drop the alignment bits and mix the rest
+     */
+    size_t Hash(KEY member) const {
+        uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(member)) >> 4;
+        key *= 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(key >> 32) & mask;
+    }
+
+    MethodDispatchTable(const MethodDispatchTable&);
+    MethodDispatchTable& operator=(const MethodDispatchTable&);
+
+    std::vector<Entry> entries;
+    std::vector<int32_t> slots;
+    bool sealed;
+    size_t mask;
+};
+
+}
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef _METHOD_EXECUTOR_H_
+#define _METHOD_EXECUTOR_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the executor of the method calls of the Controller Service
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <alljoyn/Message.h>
+
+#include <Thread.h>
+#include <Mutex.h>
+#include <Condition.h>
+#include <Trace.h>
+#include <OEM_CS_Config.h>
+
+#include <list>
+#include <vector>
+
+namespace lsf {
+
+/**
+ * Priority lanes of the method calls, from the highest priority to the lowest
+ */
+typedef enum _MethodLane {
+    /** Transitions, pulses and resets of the state of lamps and lamp groups */
+    METHOD_LANE_LAMP_CONTROL = 0,
+    /** Scene and master scene applications */
+    METHOD_LANE_SCENE_APPLY = 1,
+    /** Everything else: queries and changes of the configuration and of the stores */
+    METHOD_LANE_CONFIG = 2,
+    /** Number of lanes */
+    METHOD_LANE_LAST_VALUE = 3
+} MethodLane;
+
+/**
+ * Runs the method calls of the Controller Service on its own worker threads,
+ * so that the AllJoyn callback threads only queue them. \n
+ * Each lane has a bounded queue and a limit on the number of its calls that
+ * run at the same time. A free worker runs the oldest call of the highest
+ * priority lane that is under its limit, so a flood of calls of a lane can
+ * neither fill the queues of the other lanes nor take all the workers.
+ */
+class MethodExecutor {
+  public:
+    /**
+     * Handler of a method call
+     */
+    class Handler {
+      public:
+        virtual ~Handler() { }
+        /**
+         * Handle the method call. Called on a worker thread
+         */
+        virtual void Handle(ajn::Message& msg) = 0;
+        /**
+         * Turn away a queued method call that Stop dropped, so that its
+         * caller does not wait for the method call timeout. Called on the
+         * thread that stops the executor
+         */
+        virtual void Reject(ajn::Message& msg) = 0;
+    };
+
+    /**
+     * Metrics of a lane
+     */
+    typedef struct _LaneMetrics {
+        uint32_t queueDepth;            /**< Calls waiting for a worker */
+        uint32_t peakQueueDepth;        /**< Highest queueDepth since Start */
+        uint32_t running;               /**< Calls running on a worker */
+        uint32_t submitted;             /**< Calls queued since Start */
+        uint32_t rejected;              /**< Calls rejected because the queue was full, or dropped by Stop */
+        uint32_t completed;             /**< Calls handled since Start */
+        uint64_t totalQueueTime;        /**< Time the completed calls waited for a worker, in ms */
+        uint32_t maxQueueTime;          /**< Longest time a call waited for a worker, in ms */
+    } LaneMetrics;
+
+    /**
+     * class constructor
+     * @param numThreads    Number of worker threads
+     */
+    MethodExecutor(uint32_t numThreads = OEM_CS_METHOD_EXECUTOR_THREADS);
+    /**
+     * class destructor
+     */
+    ~MethodExecutor();
+    /**
+     * Set the limits of a lane
+     * @param lane          The lane
+     * @param concurrency   Maximum number of calls of the lane that run at the same time
+     * @param queueDepth    Maximum number of calls of the lane that wait for a worker
+     */
+    void SetLaneLimits(MethodLane lane, uint32_t concurrency, uint32_t queueDepth);
+    /**
+     * Start the worker threads. Resets the metrics
+     */
+    QStatus Start(void);
+    /**
+     * Queue a method call. The call keeps the current trace of the calling thread
+     * @param lane      The lane of the call
+     * @param handler   The handler of the call. Must outlive the executor
+     * @param msg       The method call
+     * @return false if the queue of the lane is full or the executor is stopped
+     */
+    bool Submit(MethodLane lane, Handler* handler, const ajn::Message& msg);
+    /**
+     * Stop the worker threads. The calls still waiting are dropped and
+     * rejected through their handler; the running ones complete
+     */
+    void Stop(void);
+    /**
+     * Join the worker threads after Stop
+     */
+    void Join(void);
+    /**
+     * Get the metrics of a lane
+     */
+    void GetLaneMetrics(MethodLane lane, LaneMetrics& metrics);
+
+  private:
+
+    class WorkerThread : public Thread {
+      public:
+        WorkerThread(MethodExecutor& executor) : Thread("MethodWorker"), executor(executor) { }
+        virtual void Run() { executor.RunWorker(); }
+        virtual void Stop() { }
+      private:
+        MethodExecutor& executor;
+    };
+
+    struct QueuedCall {
+        QueuedCall(Handler* handler, const ajn::Message& msg) :
+            handler(handler), msg(msg), timestamp(GetTimestampInMs()),
+            traceId(Tracer::GetCurrentTraceId()), traceStart(Tracer::GetCurrentTraceStart()),
+            traceQueued(traceId ? GetTimestampInUs() : 0) { }
+        Handler* handler;
+        ajn::Message msg;
+        uint64_t timestamp;
+        uint32_t traceId;
+        uint64_t traceStart;
+        uint64_t traceQueued;
+    };
+
+    struct Lane {
+        std::list<QueuedCall> queue;
+        uint32_t concurrency;
+        uint32_t queueDepth;
+        LaneMetrics metrics;
+    };
+
+    void RunWorker(void);
+
+    /*
+     * Must be called with lock held
+     * @return METHOD_LANE_LAST_VALUE if no lane has a call that may run
+     */
+    MethodLane GetNextLane(void);
+
+    Mutex lock;
+    Condition condition;
+    bool running;
+    Lane lanes[METHOD_LANE_LAST_VALUE];
+    uint32_t numThreads;
+    std::vector<WorkerThread*> workers;
+};
+
+}
+
+#endif
@@ -53,6 +53,148 @@ namespace lsf {
  */
 #define OEM_CS_TIMEOUT_MS_CONNECTED_TO_ROUTING_NODE 5000
 
+/**
+ * Time in milliseconds that the persistent store waits after a change before
+ * committing it to flash, so that a burst of changes results in a single write.
+ * Set to 0 to commit every change immediately
+ */
+#define OEM_CS_PERSISTENCE_DEBOUNCE_WINDOW_MS 100
+
+/**
+ * Interval in milliseconds between the heartbeats that the leader sends to
+ * the followers
+ */
+#define OEM_CS_LEADER_HEARTBEAT_INTERVAL_MS 100
+
+/**
+ * Number of consecutive heartbeats a follower may miss before it considers
+ * the leader lost and starts a new election
+ */
+#define OEM_CS_LEADER_HEARTBEAT_MISSED_THRESHOLD 3
+
+/**
+ * Phi-accrual suspicion level above which a follower considers the leader
+ * lost. When non-zero, this replaces OEM_CS_LEADER_HEARTBEAT_MISSED_THRESHOLD
+ * so that the detector adapts to the observed jitter of the heartbeats.
+ * A level of 1 means a 10% chance of a false suspicion, 2 a 1% chance, etc
+ */
+#define OEM_CS_LEADER_FAILURE_PHI_THRESHOLD 0
+
+/**
+ * Time in milliseconds that a follower that lost its leader gives each
+ * higher-ranked Controller Service to take over before it considers it gone.
+ * The followers wait one such interval per higher-ranked Controller Service
+ * they know of, so that they take over one after the other by rank. Keep it
+ * well above OEM_CS_LEADER_HEARTBEAT_INTERVAL_MS and above the time an About
+ * announcement takes to reach the other Controller Services
+ */
+#define OEM_CS_LEADER_TAKEOVER_WAIT_MS 200
+
+/**
+ * Set to 1 to keep the highest-ranked follower in hot standby: it keeps its
+ * sessions with the lamps and mirrors their state, so that it serves lamp
+ * requests as soon as it takes over as the leader. Set to 0 to save the lamp
+ * sessions of the follower
+ */
+#define OEM_CS_LAMP_HOT_STANDBY 1
+
+/**
+ * Set to 1 to let the followers serve as read replicas: they accept sessions
+ * from the apps and answer the read-only Lamp Group, Preset, Scene and Master
+ * Scene method calls from their synced copies of the stores. Any other method
+ * call is rejected with the ControllerServiceNotLeaderErrorName error, which
+ * carries the bus name of the leader. Set to 0 to only let the leader serve apps
+ */
+#define OEM_CS_READ_REPLICA 0
+
+/**
+ * Number of threads that run the method calls of the apps. The AllJoyn
+ * callback threads only queue the calls on the lanes of the executor
+ */
+#define OEM_CS_METHOD_EXECUTOR_THREADS 4
+
+/**
+ * Maximum number of lamp control calls (transitions, pulses and resets of
+ * lamps and lamp groups) that run at the same time, and that wait for a
+ * thread. A call that does not fit in the queue gets its normal reply with the
+ * LSF_ERR_BUSY response code. Lamp control calls have the highest priority
+ */
+#define OEM_CS_LAMP_CONTROL_LANE_CONCURRENCY 3
+#define OEM_CS_LAMP_CONTROL_LANE_QUEUE_DEPTH 64
+
+/**
+ * Maximum number of scene and master scene applications that run at the same
+ * time, and that wait for a thread
+ */
+#define OEM_CS_SCENE_APPLY_LANE_CONCURRENCY 1
+#define OEM_CS_SCENE_APPLY_LANE_QUEUE_DEPTH 16
+
+/**
+ * Maximum number of the other calls that run at the same time, and that wait
+ * for a thread. Keep OEM_CS_SCENE_APPLY_LANE_CONCURRENCY plus this below
+ * OEM_CS_METHOD_EXECUTOR_THREADS so that a thread is always left for lamp control
+ */
+#define OEM_CS_CONFIG_LANE_CONCURRENCY 2
+#define OEM_CS_CONFIG_LANE_QUEUE_DEPTH 32
+
+/**
+ * Time in milliseconds during which the lamp state changes are aggregated
+ * into one LampsStateChanged signal, so that applying a scene to many lamps
+ * does not send a signal per lamp to every app. Set to 0 to send each change
+ * immediately
+ */
+#define OEM_CS_LAMP_STATE_SIGNAL_BATCH_WINDOW_MS 50
+
+/**
+ * Maximum number of lamps in a LampsStateChanged signal. A batch that reaches
+ * it is sent before the end of the window
+ */
+#define OEM_CS_LAMP_STATE_SIGNAL_BATCH_MAX_LAMPS 100
+
+/**
+ * Set to 1 to also send a LampStateChanged signal per lamp after each
+ * LampsStateChanged signal, for the apps built against an older Controller
+ * Client. Set to 0 once all the apps handle LampsStateChanged
+ */
+#define OEM_CS_SEND_PER_LAMP_STATE_SIGNAL 1
+
+/**
+ * Number of method calls per second, and burst, that each app may make in
+ * each lane before its calls are rejected with LSF_ERR_BUSY, so that one app
+ * cannot take the lamps from the others. A rate of 0 does not limit the lane
+ */
+#define OEM_CS_LAMP_CONTROL_RATE_PER_SEC 20
+#define OEM_CS_LAMP_CONTROL_RATE_BURST 40
+#define OEM_CS_SCENE_APPLY_RATE_PER_SEC 5
+#define OEM_CS_SCENE_APPLY_RATE_BURST 10
+#define OEM_CS_CONFIG_RATE_PER_SEC 20
+#define OEM_CS_CONFIG_RATE_BURST 50
+
+/**
+ * Maximum number of apps whose call rates are tracked. When an unknown app
+ * calls with all the entries in use, the app that called least recently is forgotten
+ */
+#define OEM_CS_RATE_LIMITER_MAX_CLIENTS 64
+
+/**
+ * Default time between two writes of the diagnostics file, in ms, when the
+ * Controller Service is started with a diagnostics file
+ */
+#define OEM_CS_DIAGNOSTICS_DUMP_INTERVAL_MS 10000
+
+/**
+ * CPUs that the threads of the Controller Service run on, bit n for CPU n.
+ * 0 lets them run on any CPU
+ */
+#define OEM_CS_THREAD_CPU_AFFINITY_MASK 0
+
+/**
+ * Nice value of the threads that run the method calls of the apps, from -20
+ * to 19. 0 keeps the nice value of the process. A value below the nice value
+ * of the process needs CAP_SYS_NICE
+ */
+#define OEM_CS_METHOD_EXECUTOR_THREAD_NICE 0
+
 /**
  * Returns the factory set value of the default lamp state. The
  * PresetManager will use this value to initialize the default
@@ -23,46 +23,96 @@
  *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
  ******************************************************************************/
 
-#include <Thread.h>
-#include <LSFSemaphore.h>
+#include <Mutex.h>
+#include <Reactor.h>
+#include <OEM_CS_Config.h>
+
+#include <list>
 
 namespace lsf {
 
 class ControllerService;
+class Manager;
 /**
- * Thread dedicated for persisted data
+ * Writer of the persisted data. \n
+ * Only the managers that signalled a change are committed, and writes are
+ * delayed by a debounce window so that a burst of changes is committed once.
+ * The commits run on a Reactor rather than on a thread of their own.
  */
-class PersistenceThread : public Thread {
+class PersistenceThread : public ReactorHandler {
   public:
+    /**
+     * Counts and durations of the commits to the persistent store
+     */
+    typedef struct _PersistenceMetrics {
+        uint32_t signals;               /**< Changes signalled by the managers */
+        uint32_t writes;                /**< Stores committed */
+        uint32_t commits;               /**< Commits, each writing one or more stores */
+        uint64_t totalCommitTime;       /**< Time spent committing, in ms */
+        uint32_t maxCommitTime;         /**< Longest commit, in ms */
+        uint32_t lastCommitTime;        /**< Duration of the last commit, in ms */
+    } PersistenceMetrics;
+
     /**
      * class constructor
+     * @param service           The Controller Service
+     * @param debounceWindowMs  Time to wait after the first change before committing it
+     * @param reactor           The reactor that runs the commits
      */
-    PersistenceThread(ControllerService& service);
+    PersistenceThread(ControllerService& service, uint32_t debounceWindowMs = OEM_CS_PERSISTENCE_DEBOUNCE_WINDOW_MS, Reactor& reactor = Reactor::GetShared());
     /**
      * class destructor
      */
     virtual ~PersistenceThread();
     /**
      * Signal to the thread to be active
+     * @param manager   The manager that has data to read or write
+     * @param urgent    true to skip the debounce window, e.g. for pending blob reads
+     */
+    void SignalReadWrite(Manager* manager, bool urgent = false);
+    /**
+     * Change the debounce window
+     * @param debounceWindowMs  Time to wait after the first change before committing it. 0 disables debouncing
      */
-    void SignalReadWrite();
+    void SetDebounceWindow(uint32_t debounceWindowMs);
     /**
-     * Thread run method
+     * Start committing the changes, including the ones signalled before Start
      */
-    virtual void Run();
+    QStatus Start(void);
     /**
-     * Stop thread
+     * Stop committing in the background. Commits the changes that are still pending
      */
-    virtual void Stop();
+    void Stop(void);
     /**
-     * Join thread after stopped
+     * Wait for a commit that is still running after Stop
      */
-    virtual void Join();
+    void Join(void);
+    /**
+     * Invoked by the reactor to commit
+     */
+    virtual void HandleEvents(uint32_t events);
+    /**
+     * Get the counts and durations of the commits
+     */
+    void GetMetrics(PersistenceMetrics& metrics);
 
   private:
+
+    void CommitDirtyManagers(void);
+
     ControllerService& service;
+    Reactor& reactor;
+    ReactorTimer debounceTimer;
     bool running;
-    LSFSemaphore semaphore;
+    Mutex commitLock;
+    Mutex dirtyLock;
+    std::list<Manager*> dirtyManagers;
+    bool urgent;
+    uint64_t firstChangeTimestamp;
+    uint32_t debounceWindow;
+    uint32_t numSignals;
+    uint32_t numCommits;
+    PersistenceMetrics metrics; /**< Protected by dirtyLock */
 };
 
 }
@@ -156,6 +156,13 @@ class PresetManager : public Manager {
      * response code LSF_OK on success. \n
      */
     LSFResponseCode GetAllPresets(PresetMap& presetMap);
+    /**
+     * Get all presets with their names and states in a single reply. \n
+     * @param msg - contains the requested language. \n
+     * Return asynchronously response code, language and an array of (id, name, state). \n
+     *   LSF_OK - on success
+     */
+    void GetAllPresets(ajn::Message& msg);
     /**
      * Get default lamp state who's preset name is 'DefaultLampState'. \n
      * @param state - Requested information  of type LampState. Filled synchronously.
@@ -176,6 +183,13 @@ class PresetManager : public Manager {
      * Getting the blob string and wrting it to the file. \n
      */
     void HandleReceivedBlob(const std::string& blob, uint32_t checksum, uint64_t timestamp);
+    /**
+     * Handle a delta received from the leader. \n
+     * The whole blob is requested from the leader if a change was missed
+     * @param changes - the created, updated and deleted entities
+     * @param checksum - store hash of the leader after the changes
+     */
+    void HandleReceivedDelta(const StoreChangeSet& changes, uint32_t checksum);
     /**
      * Get Controller Service Preset Interface Version. \n
      * @return 32 unsigned integer version. \n
@@ -185,19 +199,90 @@ class PresetManager : public Manager {
      * Get the presets information as a string. \n
      * @return true if data is written to file
      */
-    virtual bool GetString(std::string& output, uint32_t& checksum, uint64_t& timestamp);
+    virtual bool GetString(std::string& output, StoreChangeSet& changes, uint32_t& checksum, uint64_t& timestamp);
     /**
      * Get blob information about checksum and time stamp.
      */
     void GetBlobInfo(uint32_t& checksum, uint64_t& timestamp) {
         presetsLock.Lock();
+        BuildHashTree();
         GetBlobInfoInternal(checksum, timestamp);
         presetsLock.Unlock();
     }
+    /**
+     * Get the blob sequence number and the store hash sent in the heartbeats of the leader
+     */
+    void GetStoreSequence(uint32_t& sequence, uint32_t& checksum) {
+        presetsLock.Lock();
+        GetStoreSequenceInternal(sequence, checksum);
+        presetsLock.Unlock();
+    }
+    /**
+     * Compare the store with the one of the leader, as sent in its heartbeat
+     */
+    void HandleLeaderStore(uint32_t sequence, uint32_t checksum) {
+        presetsLock.Lock();
+        CheckLeaderStore(sequence, checksum);
+        presetsLock.Unlock();
+    }
+    /**
+     * Get the time since the store last matched the store of the leader
+     * @return false if the store is not synchronized with the leader
+     */
+    bool GetReplicaAge(uint64_t& age) {
+        presetsLock.Lock();
+        bool synchronized = GetReplicaAgeInternal(age);
+        presetsLock.Unlock();
+        return synchronized;
+    }
+    /**
+     * Get the hashes of the children of nodes of the hash tree
+     * @param level - level of the nodes
+     * @param nodes - indexes of the nodes in the level
+     * @param hashes - StoreHashTree::FANOUT hashes per node
+     */
+    void GetHashTreeNodes(uint32_t level, const std::vector<uint32_t>& nodes, std::vector<uint64_t>& hashes) {
+        presetsLock.Lock();
+        BuildHashTree();
+        hashTree.GetChildHashes(level, nodes, hashes);
+        presetsLock.Unlock();
+    }
+    /**
+     * Get the IDs and hashes of the entities in buckets of the hash tree
+     * @param buckets - indexes of the buckets
+     * @param entities - the entities in those buckets
+     */
+    void GetEntityHashes(const std::vector<uint32_t>& buckets, StoreEntityHashList& entities) {
+        presetsLock.Lock();
+        BuildHashTree();
+        hashTree.GetEntityHashes(buckets, entities);
+        presetsLock.Unlock();
+    }
+    /**
+     * Get entities in the store format
+     * @param ids - IDs of the entities
+     * @param records - the entities found
+     */
+    void GetEntities(const LSFStringList& ids, StoreJournalRecordList& records) {
+        presetsLock.Lock();
+        GetEntityRecords(ids, records);
+        presetsLock.Unlock();
+    }
+    /**
+     * Handle the entities fetched from another controller to reconcile the stores
+     * @param records - the fetched entities and the entities to delete
+     */
+    void HandleReconciledEntities(const StoreJournalRecordList& records);
 
   private:
 
-    void ReplaceMap(std::istringstream& stream);
+    void ReplaceMap(std::istream& stream, bool merge = false);
+
+    virtual void ApplyJournalRecord(const StoreJournalRecord& record);
+
+    virtual void BuildHashTree(void);
+
+    virtual void GetEntityRecords(const LSFStringList& ids, StoreJournalRecordList& records);
 
     LSFResponseCode SetDefaultLampStateInternal(LampState& state);
 
@@ -169,6 +169,13 @@ class SceneManager : public Manager {
      * @return LSF_OK on succedd.
      */
     LSFResponseCode GetAllScenes(SceneMap& sceneMap);
+    /**
+     * Get All Scenes with their names and components in a single reply. \n
+     * @param message - contains the requested language. \n
+     * Return asynchronously response code, language and an array of (id, name, scene components). \n
+     *   LSF_OK - on success
+     */
+    void GetAllScenes(ajn::Message& message);
     /**
      * Read Write File \n
      * Reading scenes information from the persistent data and might update other interested controller services by sending blob messages.
@@ -191,7 +198,7 @@ class SceneManager : public Manager {
      * @param checksum - of the output
      * @param timestamp - current time
      */
-    virtual bool GetString(std::string& output, uint32_t& checksum, uint64_t& timestamp);
+    virtual bool GetString(std::string& output, StoreChangeSet& changes, uint32_t& checksum, uint64_t& timestamp);
     /**
      * Get file information. \n
      * Derived from Manager class. \n
@@ -201,9 +208,74 @@ class SceneManager : public Manager {
      */
     void GetBlobInfo(uint32_t& checksum, uint64_t& timestamp) {
         scenesLock.Lock();
+        BuildHashTree();
         GetBlobInfoInternal(checksum, timestamp);
         scenesLock.Unlock();
     }
+    /**
+     * Get the blob sequence number and the store hash sent in the heartbeats of the leader
+     */
+    void GetStoreSequence(uint32_t& sequence, uint32_t& checksum) {
+        scenesLock.Lock();
+        GetStoreSequenceInternal(sequence, checksum);
+        scenesLock.Unlock();
+    }
+    /**
+     * Compare the store with the one of the leader, as sent in its heartbeat
+     */
+    void HandleLeaderStore(uint32_t sequence, uint32_t checksum) {
+        scenesLock.Lock();
+        CheckLeaderStore(sequence, checksum);
+        scenesLock.Unlock();
+    }
+    /**
+     * Get the time since the store last matched the store of the leader
+     * @return false if the store is not synchronized with the leader
+     */
+    bool GetReplicaAge(uint64_t& age) {
+        scenesLock.Lock();
+        bool synchronized = GetReplicaAgeInternal(age);
+        scenesLock.Unlock();
+        return synchronized;
+    }
+    /**
+     * Get the hashes of the children of nodes of the hash tree
+     * @param level - level of the nodes
+     * @param nodes - indexes of the nodes in the level
+     * @param hashes - StoreHashTree::FANOUT hashes per node
+     */
+    void GetHashTreeNodes(uint32_t level, const std::vector<uint32_t>& nodes, std::vector<uint64_t>& hashes) {
+        scenesLock.Lock();
+        BuildHashTree();
+        hashTree.GetChildHashes(level, nodes, hashes);
+        scenesLock.Unlock();
+    }
+    /**
+     * Get the IDs and hashes of the entities in buckets of the hash tree
+     * @param buckets - indexes of the buckets
+     * @param entities - the entities in those buckets
+     */
+    void GetEntityHashes(const std::vector<uint32_t>& buckets, StoreEntityHashList& entities) {
+        scenesLock.Lock();
+        BuildHashTree();
+        hashTree.GetEntityHashes(buckets, entities);
+        scenesLock.Unlock();
+    }
+    /**
+     * Get entities in the store format
+     * @param ids - IDs of the entities
+     * @param records - the entities found
+     */
+    void GetEntities(const LSFStringList& ids, StoreJournalRecordList& records) {
+        scenesLock.Lock();
+        GetEntityRecords(ids, records);
+        scenesLock.Unlock();
+    }
+    /**
+     * Handle the entities fetched from another controller to reconcile the stores
+     * @param records - the fetched entities and the entities to delete
+     */
+    void HandleReconciledEntities(const StoreJournalRecordList& records);
     /**
      * Write the blob containing scene information to persistent data. \n
      * @param blob - string containing scenes information.
@@ -211,10 +283,23 @@ class SceneManager : public Manager {
      * @param timestamp
      */
     void HandleReceivedBlob(const std::string& blob, uint32_t checksum, uint64_t timestamp);
+    /**
+     * Handle a delta received from the leader. \n
+     * The whole blob is requested from the leader if a change was missed
+     * @param changes - the created, updated and deleted entities
+     * @param checksum - store hash of the leader after the changes
+     */
+    void HandleReceivedDelta(const StoreChangeSet& changes, uint32_t checksum);
 
   private:
 
-    void ReplaceMap(std::istringstream& stream);
+    void ReplaceMap(std::istream& stream, bool merge = false);
+
+    virtual void ApplyJournalRecord(const StoreJournalRecord& record);
+
+    virtual void BuildHashTree(void);
+
+    virtual void GetEntityRecords(const LSFStringList& ids, StoreJournalRecordList& records);
 
     LSFResponseCode ApplySceneInternal(ajn::Message message, LSFStringList& sceneList, LSFString sceneOrMasterSceneId);
 
@@ -33,6 +33,7 @@ extern const std::string ControllerServiceLampGroupDescription;
 extern const std::string ControllerServicePresetDescription;
 extern const std::string ControllerServiceSceneDescription;
 extern const std::string ControllerServiceMasterSceneDescription;
+extern const std::string ControllerServiceDiagnosticsDescription;
 extern const std::string LeaderElectionAndStateSyncDescription;
 
 }
@@ -0,0 +1,204 @@
+#ifndef _STORE_FILE_H_
+#define _STORE_FILE_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the persistent store file format
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+#include <streambuf>
+
+namespace lsf {
+
+/**
+ * Version of the binary store file format written by this Controller Service
+ */
+extern const uint32_t StoreFileFormatVersion;
+
+/**
+ * Compute the Adler-32 checksum of a buffer
+ *
+ * @param data  The data
+ * @param len   The length of the data
+ * @return      The checksum
+ */
+uint32_t GetAdler32Checksum(const uint8_t* data, size_t len);
+
+/**
+ * Write a whole buffer to a file descriptor, retrying on partial writes
+ *
+ * @param fd    The file descriptor
+ * @param data  The data
+ * @param len   The length of the data
+ * @return      true if all the data was written
+ */
+bool WriteToFile(int fd, const char* data, size_t len);
+
+/**
+ * Sync the directory that holds a file, so that a rename to that file
+ * survives a power failure
+ *
+ * @param path  The file location
+ * @return      true if the directory was synced
+ */
+bool SyncParentDirectory(const std::string& path);
+
+/**
+ * Read-only view of a persistent store file (LampGroups.lsf, Presets.lsf, Scenes.lsf,
+ * MasterScenes.lsf). \n
+ * The file is mapped into memory and its payload is validated and parsed in place. \n
+ * Binary layout, in host byte order: \n
+ *     magic "LSFB" | version u32 | header length u32 | record count u32 | payload length u32 |
+ *     timestamp u64 | payload checksum u32 | header checksum u32 |
+ *     record lengths u32[record count] | payload \n
+ * The payload is the same text serialization that is exchanged as a blob between
+ * Controller Services, so the payload checksum is also the blob checksum. \n
+ * Files in the legacy text format ("timestamp checksum payload") are also accepted
+ * so that they can be migrated on first load.
+ */
+class StoreFile {
+  public:
+    /**
+     * StoreFile constructor
+     */
+    StoreFile();
+
+    /**
+     * StoreFile destructor. Unmaps the file
+     */
+    ~StoreFile();
+
+    /**
+     * Map and parse the header of a store file
+     *
+     * @param path  The file location
+     * @return      true if the file was mapped and its header is well formed
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * Unmap the file
+     */
+    void Close(void);
+
+    /**
+     * Check that the payload matches the stored checksum
+     */
+    bool IsValid(void) const;
+
+    /**
+     * Is the file in the legacy text format
+     */
+    bool IsLegacyFormat(void) const { return legacyFormat; }
+
+    /**
+     * Get the timestamp stored in the file
+     */
+    uint64_t GetTimestamp(void) const { return timestamp; }
+
+    /**
+     * Get the checksum stored in the file
+     */
+    uint32_t GetChecksum(void) const { return checksum; }
+
+    /**
+     * Get a pointer to the payload inside the mapping
+     */
+    const char* GetPayload(void) const { return payload; }
+
+    /**
+     * Get the length of the payload
+     */
+    size_t GetPayloadLength(void) const { return payloadLength; }
+
+    /**
+     * Get the number of records in the payload. Legacy files have no record table
+     */
+    uint32_t GetNumRecords(void) const { return static_cast<uint32_t>(recordOffsets.size()); }
+
+    /**
+     * Get a record from the payload without copying it
+     *
+     * @param index     The record index
+     * @param record    Pointer to the record inside the mapping
+     * @param length    Length of the record
+     * @return          false if the index is out of range
+     */
+    bool GetRecord(uint32_t index, const char*& record, size_t& length) const;
+
+    /**
+     * Write a store file in the binary format. \n
+     * Every line of the payload is stored as one record. The file is written and
+     * synced to a temporary file that is then renamed over the destination, so the
+     * store is never left half written and readers that still map the old file are
+     * not affected. The directory is synced after the rename.
+     *
+     * @param path      The file location
+     * @param data      The payload
+     * @param checksum  The payload checksum
+     * @param timestamp The timestamp
+     * @return          true if the file was written
+     */
+    static bool Write(const std::string& path, const std::string& data, uint32_t checksum, uint64_t timestamp);
+
+  private:
+
+    StoreFile(const StoreFile& other);
+    StoreFile& operator=(const StoreFile& other);
+
+    bool ParseBinary(void);
+    bool ParseLegacy(void);
+
+    const char* mapping;
+    size_t mappingLength;
+    const char* payload;
+    size_t payloadLength;
+    uint64_t timestamp;
+    uint32_t checksum;
+    bool legacyFormat;
+    std::vector<size_t> recordOffsets;
+};
+
+/**
+ * Stream buffer that reads directly from a memory region without copying it. \n
+ * Used to run the existing stream parsers over a mapped StoreFile payload.
+ */
+class MemoryStreamBuf : public std::streambuf {
+  public:
+    /**
+     * MemoryStreamBuf constructor
+     *
+     * @param data      The memory region. Must outlive the stream buffer
+     * @param length    The length of the memory region
+     */
+    MemoryStreamBuf(const char* data, size_t length) {
+        char* begin = const_cast<char*>(data);
+        setg(begin, begin, begin + length);
+    }
+};
+
+}
+
+#endif
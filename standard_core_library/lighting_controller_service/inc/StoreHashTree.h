@@ -0,0 +1,150 @@
+#ifndef _STORE_HASH_TREE_H_
+#define _STORE_HASH_TREE_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the hash tree of the entities of a persistent store
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+
+namespace lsf {
+
+/**
+ * ID and hash of an entity
+ */
+typedef std::pair<std::string, uint64_t> StoreEntityHash;
+
+/**
+ * List of entity hashes
+ */
+typedef std::list<StoreEntityHash> StoreEntityHashList;
+
+/**
+ * Hash tree of the entities of a persistent store, used by two Controller
+ * Services to find the entities their stores disagree on. \n
+ * Each entity is hashed with its ID and its serialized form, and falls in one
+ * of NUM_BUCKETS buckets according to the hash of its ID. The buckets are the
+ * leaves of a tree of FANOUT children per node and DEPTH levels below the root.
+ * The hash of a node is the sum of the hashes of the entities below it, so that
+ * a change to one entity updates one node per level. \n
+ * Two stores are compared top down: each level only descends into the nodes
+ * whose hashes differ, so that DEPTH + 1 exchanges find the differing buckets,
+ * and then the differing entities.
+ */
+class StoreHashTree {
+  public:
+
+    static const uint32_t FANOUT = 16; /**< Children per node */
+    static const uint32_t DEPTH = 3; /**< Levels below the root. The buckets are at level DEPTH */
+    static const uint32_t NUM_BUCKETS = 16 * 16 * 16; /**< FANOUT to the power of DEPTH */
+
+    /**
+     * StoreHashTree constructor. The tree starts unbuilt
+     */
+    StoreHashTree();
+
+    /**
+     * Is the tree up to date with the store
+     */
+    bool IsBuilt(void) const { return built; }
+
+    /**
+     * Drop all the entities and mark the tree as unbuilt. \n
+     * Used when the whole store is replaced
+     */
+    void Invalidate(void);
+
+    /**
+     * Drop all the entities and mark the tree as built, before adding the
+     * entities of the store one by one
+     */
+    void Reset(void);
+
+    /**
+     * Add or replace an entity. Ignored while the tree is unbuilt
+     *
+     * @param id        ID of the entity
+     * @param entity    The entity serialized in the store format
+     */
+    void Update(const std::string& id, const std::string& entity);
+
+    /**
+     * Remove an entity. Ignored while the tree is unbuilt
+     *
+     * @param id        ID of the entity
+     */
+    void Remove(const std::string& id);
+
+    /**
+     * Get the hash of the root, i.e. of the whole store. 0 for an empty store
+     */
+    uint64_t GetRootHash(void) const { return levels[0][0]; }
+
+    /**
+     * Get the hash of the root folded to 32 bits. 0 for an empty store
+     */
+    uint32_t GetFoldedRootHash(void) const;
+
+    /**
+     * Get the hashes of the children of nodes of a level
+     *
+     * @param level     Level of the nodes, below DEPTH
+     * @param nodes     Indexes of the nodes in the level
+     * @param hashes    FANOUT hashes per node, in order. Nodes out of range get 0 hashes
+     */
+    void GetChildHashes(uint32_t level, const std::vector<uint32_t>& nodes, std::vector<uint64_t>& hashes) const;
+
+    /**
+     * Get the IDs and hashes of the entities in buckets
+     *
+     * @param buckets   Indexes of the buckets
+     * @param entities  The entities in those buckets
+     */
+    void GetEntityHashes(const std::vector<uint32_t>& buckets, StoreEntityHashList& entities) const;
+
+    /**
+     * Get the bucket of an entity
+     */
+    static uint32_t GetBucket(const std::string& id);
+
+    /**
+     * Get the hash of an entity
+     */
+    static uint64_t GetEntityHash(const std::string& id, const std::string& entity);
+
+  private:
+
+    void Add(uint32_t bucket, uint64_t hash, bool remove);
+
+    bool built;
+    std::vector<uint64_t> levels[DEPTH + 1];
+    std::map<std::string, uint64_t> entities;
+};
+
+}
+
+#endif
@@ -0,0 +1,166 @@
+#ifndef _STORE_JOURNAL_H_
+#define _STORE_JOURNAL_H_
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the persistent store journal
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <string>
+#include <list>
+
+namespace lsf {
+
+/**
+ * An entity-level change read back from a StoreJournal
+ */
+typedef struct _StoreJournalRecord {
+    char type;          /**< StoreJournal::RECORD_UPDATE, RECORD_DELETE or RECORD_COMMIT */
+    std::string id;     /**< ID of the entity. Empty for commit records */
+    std::string data;   /**< Serialized entity for update records */
+    uint32_t checksum;  /**< Store hash after the batch. Commit records only */
+    uint64_t timestamp; /**< Blob timestamp after the batch. Commit records only */
+    uint32_t version;   /**< Version of the entity used by the blob sync. Not persisted */
+} StoreJournalRecord;
+
+/**
+ * List of journal records
+ */
+typedef std::list<StoreJournalRecord> StoreJournalRecordList;
+
+/**
+ * Entity changes committed by one write of a store, and the sequence numbers
+ * used to send them from the leader to the followers as a delta. \n
+ * Changes are identified by the store hash, i.e. the root of the StoreHashTree
+ * folded to 32 bits, which is kept up to date entity by entity, rather than by
+ * the checksum of the whole serialized blob.
+ */
+typedef struct _StoreChangeSet {
+    StoreJournalRecordList records; /**< Created, updated and deleted entities. Empty when a full snapshot is written */
+    uint32_t baseChecksum;          /**< Store hash the changes apply to */
+    uint32_t checksum;              /**< Store hash after the changes */
+    uint32_t fromSequence;          /**< Blob sequence number the changes apply to */
+    uint32_t toSequence;            /**< Blob sequence number after the changes */
+} StoreChangeSet;
+
+/**
+ * Append-only journal of the entity changes made since the last snapshot
+ * of a persistent store file. \n
+ * Layout, in host byte order: \n
+ *     magic "LSFJ" | version u32 | base checksum u32 | base timestamp u64 | header checksum u32 |
+ *     (body length u32 | body checksum u32 | type u8 | id length u32 | id | data)* \n
+ * The base checksum and timestamp identify the snapshot the journal applies to. \n
+ * Records are written in batches terminated by a commit record that carries the
+ * store hash and blob timestamp after the batch. On replay only committed batches
+ * are returned, and a torn tail left by an interrupted append is truncated.
+ */
+class StoreJournal {
+  public:
+
+    static const char RECORD_UPDATE = 'U'; /**< An entity was created or modified */
+    static const char RECORD_DELETE = 'D'; /**< An entity was deleted */
+    static const char RECORD_COMMIT = 'C'; /**< End of a batch */
+
+    /**
+     * StoreJournal constructor
+     *
+     * @param path  The journal file location. The journal is disabled if empty
+     */
+    StoreJournal(const std::string& path);
+
+    /**
+     * Read the committed records of the journal
+     *
+     * @param baseChecksum  Checksum of the snapshot the journal must apply to
+     * @param baseTimestamp Timestamp of the snapshot the journal must apply to
+     * @param records       The committed records, in order
+     * @return              false if there is no journal for this snapshot
+     */
+    bool Replay(uint32_t baseChecksum, uint64_t baseTimestamp, StoreJournalRecordList& records);
+
+    /**
+     * Start an empty journal on top of a new snapshot. \n
+     * The journal is replaced through a temporary file and a rename, and the
+     * directory is synced after the rename.
+     *
+     * @param baseChecksum  Checksum of the snapshot
+     * @param baseTimestamp Timestamp of the snapshot
+     * @return              true if the journal was written and the rename synced
+     */
+    bool Reset(uint32_t baseChecksum, uint64_t baseTimestamp);
+
+    /**
+     * Append encoded records at the end of the journal
+     *
+     * @param records   Records built with EncodeRecord and EncodeCommit
+     * @return          true if all the records were written
+     */
+    bool Append(const std::string& records);
+
+    /**
+     * Is the journal ready for appends, i.e. was it replayed or reset
+     */
+    bool IsOpen(void) const { return open; }
+
+    /**
+     * Does the journal hold no records
+     */
+    bool IsEmpty(void) const { return (numRecords == 0); }
+
+    /**
+     * Get the length of the journal file
+     */
+    size_t GetLength(void) const { return length; }
+
+    /**
+     * Encode an update or delete record
+     *
+     * @param output    The record is appended to this buffer
+     * @param type      RECORD_UPDATE or RECORD_DELETE
+     * @param id        ID of the entity
+     * @param data      Serialized entity. Empty for deletes
+     */
+    static void EncodeRecord(std::string& output, char type, const std::string& id, const std::string& data = std::string());
+
+    /**
+     * Encode a commit record
+     *
+     * @param output    The record is appended to this buffer
+     * @param checksum  Store hash after the batch
+     * @param timestamp Blob timestamp after the batch
+     */
+    static void EncodeCommit(std::string& output, uint32_t checksum, uint64_t timestamp);
+
+  private:
+
+    bool Truncate(size_t newLength);
+
+    const std::string path;
+    bool open;
+    size_t length;
+    uint32_t numRecords;
+};
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef STORE_LOADER_THREAD_H
+#define STORE_LOADER_THREAD_H
+/**
+ * \ingroup ControllerService
+ */
+/**
+ * @file
+ * This file provides definitions for the thread that loads a persistent store at startup
+ */
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <Thread.h>
+
+#include <stdint.h>
+
+namespace lsf {
+
+class Manager;
+/**
+ * Thread that loads a persistent store at startup. \n
+ * The Controller Service loads its stores in parallel with each other and
+ * with the setup of the AllJoyn bus, and joins the loaders before it starts
+ * serving requests.
+ */
+class StoreLoaderThread : public Thread {
+  public:
+    /**
+     * class constructor
+     * @param manager   The manager of the store
+     */
+    StoreLoaderThread(Manager& manager);
+    /**
+     * class destructor
+     */
+    virtual ~StoreLoaderThread();
+    /**
+     * Start loading the store. \n
+     * The store is loaded on the calling thread if the thread cannot be created
+     */
+    void StartLoading(void);
+    /**
+     * Wait until the store is loaded
+     * @return time it took to load the store in ms
+     */
+    uint32_t WaitUntilLoaded(void);
+    /**
+     * Thread run method
+     */
+    virtual void Run();
+    /**
+     * Stop thread. Loading a store cannot be interrupted
+     */
+    virtual void Stop() { };
+
+  private:
+
+    Manager& manager;
+    bool started;
+    uint32_t loadTime;
+};
+
+}
+
+
+#endif
@@ -0,0 +1,270 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <BlobTransfer.h>
+#include <StoreFile.h>
+
+#include <alljoyn/Status.h>
+#include <qcc/Debug.h>
+
+#include <string.h>
+#include <vector>
+
+#define QCC_MODULE "BLOB_TRANSFER"
+
+namespace lsf {
+
+const size_t BlobTransfer::INLINE_BLOB_LEN;
+const size_t BlobTransfer::CHUNK_LEN;
+const size_t BlobTransfer::MAX_BLOB_LEN;
+
+/*
+ * Parameters of the LZ4 block format
+ */
+static const size_t MIN_MATCH = 4;
+static const size_t LAST_LITERALS = 5;
+static const size_t MATCH_FIND_LIMIT = 12;
+static const size_t MAX_OFFSET = 65535;
+static const uint32_t RUN_MASK = 15;
+
+static const uint32_t HASH_BITS = 12;
+
+static inline uint32_t Read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static inline uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static void AppendLength(std::string& output, size_t len)
+{
+    while (len >= 255) {
+        output.push_back(static_cast<char>(255));
+        len -= 255;
+    }
+    output.push_back(static_cast<char>(len));
+}
+
+static bool ReadLength(const uint8_t* data, size_t len, size_t& offset, size_t& length)
+{
+    uint8_t byte;
+    do {
+        if (offset >= len) {
+            return false;
+        }
+        byte = data[offset++];
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+/*
+ * Append a sequence: a token, the literals and, unless this is the last
+ * sequence, the offset and the length of the match
+ */
+static void AppendSequence(std::string& output, const uint8_t* literals, size_t literalLength, size_t offset, size_t matchLength)
+{
+    size_t tokenPos = output.length();
+    output.push_back(0);
+    uint8_t token = static_cast<uint8_t>(((literalLength >= RUN_MASK) ? RUN_MASK : literalLength) << 4);
+    if (literalLength >= RUN_MASK) {
+        AppendLength(output, literalLength - RUN_MASK);
+    }
+    output.append(reinterpret_cast<const char*>(literals), literalLength);
+
+    if (offset) {
+        output.push_back(static_cast<char>(offset & 0xFF));
+        output.push_back(static_cast<char>(offset >> 8));
+        size_t length = matchLength - MIN_MATCH;
+        token |= static_cast<uint8_t>((length >= RUN_MASK) ? RUN_MASK : length);
+        if (length >= RUN_MASK) {
+            AppendLength(output, length - RUN_MASK);
+        }
+    }
+    output[tokenPos] = static_cast<char>(token);
+}
+
+void BlobTransfer::Compress(const std::string& input, std::string& output)
+{
+    QCC_DbgTrace(("%s: len=%u", __func__, (uint32_t) input.length()));
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(input.data());
+    size_t len = input.length();
+    size_t anchor = 0;
+
+    output.clear();
+    output.reserve((len / 2) + 16);
+
+    if (len > MATCH_FIND_LIMIT) {
+        /*
+         * Positions are stored plus one so that 0 marks an empty slot
+         */
+        std::vector<uint32_t> table(1 << HASH_BITS, 0);
+        size_t limit = len - MATCH_FIND_LIMIT;
+        size_t pos = 0;
+
+        while (pos < limit) {
+            uint32_t sequence = Read32(src + pos);
+            uint32_t hash = Hash(sequence);
+            size_t candidate = table[hash];
+            table[hash] = static_cast<uint32_t>(pos + 1);
+
+            if (!candidate || ((pos - (candidate - 1)) > MAX_OFFSET) || (Read32(src + candidate - 1) != sequence)) {
+                pos++;
+                continue;
+            }
+
+            size_t matchPos = candidate - 1;
+            size_t matchLength = MIN_MATCH;
+            size_t maxLength = len - LAST_LITERALS - pos;
+            while ((matchLength < maxLength) && (src[matchPos + matchLength] == src[pos + matchLength])) {
+                matchLength++;
+            }
+
+            AppendSequence(output, src + anchor, pos - anchor, pos - matchPos, matchLength);
+            pos += matchLength;
+            anchor = pos;
+        }
+    }
+
+    AppendSequence(output, src + anchor, len - anchor, 0, 0);
+}
+
+bool BlobTransfer::Decompress(const uint8_t* data, size_t len, size_t blobLength, std::string& output)
+{
+    QCC_DbgTrace(("%s: len=%u blobLength=%u", __func__, (uint32_t) len, (uint32_t) blobLength));
+    output.clear();
+    if (blobLength > MAX_BLOB_LEN) {
+        return false;
+    }
+    output.resize(blobLength);
+
+    size_t in = 0;
+    size_t out = 0;
+    while (in < len) {
+        uint8_t token = data[in++];
+
+        size_t literalLength = token >> 4;
+        if ((literalLength == RUN_MASK) && !ReadLength(data, len, in, literalLength)) {
+            return false;
+        }
+        if ((literalLength > (len - in)) || (literalLength > (blobLength - out))) {
+            return false;
+        }
+        if (literalLength) {
+            memcpy(&output[out], data + in, literalLength);
+        }
+        in += literalLength;
+        out += literalLength;
+
+        if (in == len) {
+            break;
+        }
+
+        if ((len - in) < 2) {
+            return false;
+        }
+        size_t offset = data[in] | (data[in + 1] << 8);
+        in += 2;
+        if ((offset == 0) || (offset > out)) {
+            return false;
+        }
+
+        size_t matchLength = token & RUN_MASK;
+        if ((matchLength == RUN_MASK) && !ReadLength(data, len, in, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > (blobLength - out)) {
+            return false;
+        }
+
+        if (offset >= matchLength) {
+            memcpy(&output[out], &output[out - offset], matchLength);
+        } else {
+            /*
+             * The match overlaps the bytes it produces
+             */
+            for (size_t i = 0; i < matchLength; i++) {
+                output[out + i] = output[out - offset + i];
+            }
+        }
+        out += matchLength;
+    }
+
+    return (out == blobLength);
+}
+
+bool BlobReassembler::AddChunk(const std::string& sender, const BlobChunk& chunk, std::string& blob)
+{
+    QCC_DbgTrace(("%s: sender=%s type=%u transfer=%u chunk=%u/%u", __func__, sender.c_str(), chunk.type, chunk.transferId, chunk.index, chunk.numChunks));
+    bool complete = false;
+    std::pair<std::string, uint32_t> key(sender, chunk.type);
+
+    transfersLock.Lock();
+    if (chunk.index == 0) {
+        PendingTransfer& transfer = transfers[key];
+        transfer.transferId = chunk.transferId;
+        transfer.numChunks = chunk.numChunks;
+        transfer.nextChunk = 0;
+        transfer.blobLength = chunk.blobLength;
+        transfer.checksum = chunk.checksum;
+        transfer.data.clear();
+    }
+
+    PendingTransferMap::iterator it = transfers.find(key);
+    if (it == transfers.end()) {
+        transfersLock.Unlock();
+        return false;
+    }
+
+    PendingTransfer& transfer = it->second;
+    if ((transfer.transferId != chunk.transferId) || (transfer.nextChunk != chunk.index) || (transfer.numChunks != chunk.numChunks) ||
+        (chunk.blobLength > BlobTransfer::MAX_BLOB_LEN) || ((transfer.data.length() + chunk.dataLength) > BlobTransfer::MAX_BLOB_LEN)) {
+        QCC_LogError(ER_FAIL, ("%s: Dropping transfer %u of blob type %u from %s", __func__, transfer.transferId, chunk.type, sender.c_str()));
+        transfers.erase(it);
+        transfersLock.Unlock();
+        return false;
+    }
+
+    transfer.data.append(reinterpret_cast<const char*>(chunk.data), chunk.dataLength);
+    transfer.nextChunk++;
+
+    if (transfer.nextChunk == transfer.numChunks) {
+        complete = BlobTransfer::Decompress(reinterpret_cast<const uint8_t*>(transfer.data.data()), transfer.data.length(), transfer.blobLength, blob) &&
+                   (GetAdler32Checksum(reinterpret_cast<const uint8_t*>(blob.data()), blob.length()) == transfer.checksum);
+        if (!complete) {
+            QCC_LogError(ER_FAIL, ("%s: Transfer %u of blob type %u from %s is corrupted", __func__, transfer.transferId, chunk.type, sender.c_str()));
+        }
+        transfers.erase(it);
+    }
+    transfersLock.Unlock();
+
+    return complete;
+}
+
+void BlobReassembler::Clear(void)
+{
+    transfersLock.Lock();
+    transfers.clear();
+    transfersLock.Unlock();
+}
+
+}
@@ -0,0 +1,161 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/Debug.h>
+#include <ClientRateLimiter.h>
+
+#include <string.h>
+
+using namespace lsf;
+
+#define QCC_MODULE "CLIENT_RATE_LIMITER"
+
+/*
+ * The buckets count thousandths of a token so that a rate in calls per second
+ * refills them exactly from an elapsed time in ms
+ */
+#define MILLI_TOKENS_PER_CALL 1000
+
+ClientRateLimiter::ClientRateLimiter(uint32_t maxClients)
+    : lock("ClientRateLimiter.lock"),
+    maxClients(maxClients ? maxClients : 1)
+{
+    QCC_DbgTrace(("%s", __func__));
+    SetLaneRate(METHOD_LANE_LAMP_CONTROL, OEM_CS_LAMP_CONTROL_RATE_PER_SEC, OEM_CS_LAMP_CONTROL_RATE_BURST);
+    SetLaneRate(METHOD_LANE_SCENE_APPLY, OEM_CS_SCENE_APPLY_RATE_PER_SEC, OEM_CS_SCENE_APPLY_RATE_BURST);
+    SetLaneRate(METHOD_LANE_CONFIG, OEM_CS_CONFIG_RATE_PER_SEC, OEM_CS_CONFIG_RATE_BURST);
+}
+
+ClientRateLimiter::~ClientRateLimiter()
+{
+    QCC_DbgTrace(("%s", __func__));
+}
+
+void ClientRateLimiter::SetLaneRate(MethodLane lane, uint32_t ratePerSec, uint32_t burst)
+{
+    QCC_DbgPrintf(("%s: lane=%d ratePerSec=%u burst=%u", __func__, lane, ratePerSec, burst));
+    if (lane >= METHOD_LANE_LAST_VALUE) {
+        return;
+    }
+
+    lock.Lock();
+    rates[lane].ratePerSec = ratePerSec;
+    /*
+     * A bucket that cannot hold a token would reject every call
+     */
+    rates[lane].burst = burst ? burst : 1;
+    lock.Unlock();
+}
+
+ClientRateLimiter::Client& ClientRateLimiter::GetClient(const char* sender, uint64_t now)
+{
+    ClientMap::iterator it = clients.find(sender);
+    if (it != clients.end()) {
+        return it->second;
+    }
+
+    if (clients.size() >= maxClients) {
+        ClientMap::iterator oldest = clients.begin();
+        for (ClientMap::iterator cit = clients.begin(); cit != clients.end(); ++cit) {
+            if (cit->second.usage.lastCallTimestamp < oldest->second.usage.lastCallTimestamp) {
+                oldest = cit;
+            }
+        }
+        QCC_DbgPrintf(("%s: Forgetting %s to track %s", __func__, oldest->first.c_str(), sender));
+        clients.erase(oldest);
+    }
+
+    /*
+     * A new app starts with full buckets
+     */
+    Client client;
+    memset(&client.usage, 0, sizeof(client.usage));
+    client.usage.firstCallTimestamp = now;
+    for (uint32_t i = 0; i < METHOD_LANE_LAST_VALUE; i++) {
+        client.buckets[i].milliTokens = (uint64_t) rates[i].burst * MILLI_TOKENS_PER_CALL;
+        client.buckets[i].lastRefill = now;
+    }
+    return clients.insert(std::make_pair(LSFString(sender), client)).first->second;
+}
+
+bool ClientRateLimiter::Admit(const char* sender, MethodLane lane)
+{
+    if (!sender || (lane >= METHOD_LANE_LAST_VALUE)) {
+        return true;
+    }
+
+    uint64_t now = GetTimestampInMs();
+    bool admitted = true;
+
+    lock.Lock();
+    Client& client = GetClient(sender, now);
+    client.usage.lastCallTimestamp = now;
+
+    const LaneRate& rate = rates[lane];
+    if (rate.ratePerSec) {
+        Bucket& bucket = client.buckets[lane];
+        uint64_t capacity = (uint64_t) rate.burst * MILLI_TOKENS_PER_CALL;
+        if (now > bucket.lastRefill) {
+            bucket.milliTokens += (now - bucket.lastRefill) * rate.ratePerSec;
+            bucket.lastRefill = now;
+        }
+        if (bucket.milliTokens > capacity) {
+            bucket.milliTokens = capacity;
+        }
+
+        if (bucket.milliTokens >= MILLI_TOKENS_PER_CALL) {
+            bucket.milliTokens -= MILLI_TOKENS_PER_CALL;
+        } else {
+            admitted = false;
+        }
+    }
+
+    if (admitted) {
+        client.usage.admitted[lane]++;
+    } else {
+        client.usage.rejected[lane]++;
+        QCC_DbgPrintf(("%s: %s exceeded the rate of lane %d; rejected %u calls", __func__, sender, lane, client.usage.rejected[lane]));
+    }
+    lock.Unlock();
+
+    return admitted;
+}
+
+void ClientRateLimiter::RemoveClient(const char* sender)
+{
+    QCC_DbgPrintf(("%s: sender=%s", __func__, sender));
+    lock.Lock();
+    clients.erase(sender);
+    lock.Unlock();
+}
+
+void ClientRateLimiter::Reset(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    lock.Lock();
+    clients.clear();
+    lock.Unlock();
+}
+
+void ClientRateLimiter::GetClientUsage(ClientUsageMap& usage)
+{
+    usage.clear();
+    lock.Lock();
+    for (ClientMap::const_iterator it = clients.begin(); it != clients.end(); ++it) {
+        usage.insert(std::make_pair(it->first, it->second.usage));
+    }
+    lock.Unlock();
+}
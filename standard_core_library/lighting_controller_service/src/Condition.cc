@@ -17,6 +17,9 @@
 #include <Condition.h>
 #include <Mutex.h>
 
+#include <time.h>
+#include <errno.h>
+
 using namespace lsf;
 
 Condition::Condition()
@@ -43,3 +46,16 @@ void Condition::Wait(Mutex& mutex)
 {
     pthread_cond_wait(&condition, mutex.GetMutex());
 }
+
+bool Condition::TimedWait(Mutex& mutex, uint32_t timeoutMs)
+{
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += (timeoutMs % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    return (pthread_cond_timedwait(&condition, mutex.GetMutex(), &deadline) != ETIMEDOUT);
+}
@@ -19,6 +19,7 @@
 #include <qcc/Debug.h>
 #include <LSFTypes.h>
 #include <OEM_CS_Config.h>
+#include <Trace.h>
 
 #include <ControllerService.h>
 #include <ServiceDescription.h>
@@ -26,7 +27,9 @@
 #include <AllJoynStd.h>
 
 #include <alljoyn/notification/NotificationService.h>
+#include <qcc/atomic.h>
 #include <string>
+#include <string.h>
 #include <alljoyn/services_common/GuidUtil.h>
 
 using namespace lsf;
@@ -56,6 +59,15 @@ class ControllerService::ControllerListener :
         QCC_DbgTrace(("%s: (sessionPort=%u, joiner=%s)", __func__, sessionPort, joiner));
 
         bool acceptStatus = (sessionPort == ControllerServiceSessionPort && controller->IsLeader());
+#if OEM_CS_READ_REPLICA
+        /*
+         * A follower serves the reads of the apps on point-to-point sessions. The multipoint
+         * session that carries the signals stays with the leader
+         */
+        if ((sessionPort == ControllerServiceSessionPort) && !opts.isMultipoint) {
+            acceptStatus = true;
+        }
+#endif
         if (acceptStatus && opts.isMultipoint) {
             controller->OnAccepMultipointSessionJoiner(joiner);
         }
@@ -84,6 +96,7 @@ class ControllerService::ControllerListener :
         QCC_DbgTrace(("%s: (sessionId=%u, uniqueName=%s)", __func__, sessionId, uniqueName));
         controller->bus.EnableConcurrentCallbacks();
         controller->elector.OnSessionMemberRemoved(sessionId, uniqueName);
+        controller->clientRateLimiter.RemoveClient(uniqueName);
     }
 
     virtual void Announce(uint16_t version, uint16_t port, const char* busName, const ObjectDescriptions& objectDescs, const AboutData& aboutData) {
@@ -209,6 +222,7 @@ ControllerService::ControllerService(
     updatesAllowed(false),
     bus("LightingServiceController", true),
     elector(*this),
+    serviceSessionMutex("ControllerService.serviceSessionMutex"),
     serviceSession(0),
     listener(new ControllerListener(this)),
     lampManager(*this, presetManager),
@@ -225,11 +239,15 @@ ControllerService::ControllerService(
     obsObject(NULL),
     isObsObjectReady(false),
     isRunning(true),
+    methodCallCount(0),
+    lampStateSignalBatcher(*this),
+    diagnosticsDumper(*this),
     fileWriterThread(*this),
     firstAnnouncementSent(false),
     rank()
 {
     QCC_DbgTrace(("%s:factoryConfigFile=%s, configFile=%s, lampGroupFile=%s, presetFile=%s, sceneFile=%s, masterSceneFile=%s", __func__, factoryConfigFile.c_str(), configFile.c_str(), lampGroupFile.c_str(), presetFile.c_str(), sceneFile.c_str(), masterSceneFile.c_str()));
+    memset(&startupMetrics, 0, sizeof(startupMetrics));
 }
 
 ControllerService::ControllerService(
@@ -243,6 +261,7 @@ ControllerService::ControllerService(
     updatesAllowed(false),
     bus("LightingServiceController", true),
     elector(*this),
+    serviceSessionMutex("ControllerService.serviceSessionMutex"),
     serviceSession(0),
     listener(new ControllerListener(this)),
     lampManager(*this, presetManager),
@@ -259,11 +278,15 @@ ControllerService::ControllerService(
     obsObject(NULL),
     isObsObjectReady(false),
     isRunning(true),
+    methodCallCount(0),
+    lampStateSignalBatcher(*this),
+    diagnosticsDumper(*this),
     fileWriterThread(*this),
     firstAnnouncementSent(false),
     rank()
 {
     QCC_DbgTrace(("%s:factoryConfigFile=%s, configFile=%s, lampGroupFile=%s, presetFile=%s, sceneFile=%s, masterSceneFile=%s", __func__, factoryConfigFile.c_str(), configFile.c_str(), lampGroupFile.c_str(), presetFile.c_str(), sceneFile.c_str(), masterSceneFile.c_str()));
+    memset(&startupMetrics, 0, sizeof(startupMetrics));
     internalPropertyStore.Initialize();
 }
 
@@ -286,79 +309,6 @@ void ControllerService::FoundLocalOnboardingService(const char* busName, Session
     }
 }
 
-void ControllerService::Initialize()
-{
-    QCC_DbgTrace(("%s", __func__));
-    lampGroupManager.ReadSavedData();
-    presetManager.ReadSavedData();
-    sceneManager.ReadSavedData();
-    masterSceneManager.ReadSavedData();
-
-    messageHandlersLock.Lock();
-    AddMethodHandler("LightingResetControllerService", this, &ControllerService::LightingResetControllerService);
-    AddMethodHandler("GetControllerServiceVersion", this, &ControllerService::GetControllerServiceVersion);
-    AddMethodHandler("GetAllLampIDs", &lampManager, &LampManager::GetAllLampIDs);
-    AddMethodHandler("GetLampSupportedLanguages", &lampManager, &LampManager::GetLampSupportedLanguages);
-    AddMethodHandler("GetLampManufacturer", &lampManager, &LampManager::GetLampManufacturer);
-    AddMethodHandler("GetLampName", &lampManager, &LampManager::GetLampName);
-    AddMethodHandler("SetLampName", &lampManager, &LampManager::SetLampName);
-    AddMethodHandler("GetLampDetails", &lampManager, &LampManager::GetLampDetails);
-    AddMethodHandler("GetLampParameters", &lampManager, &LampManager::GetLampParameters);
-    AddMethodHandler("GetLampParametersField", &lampManager, &LampManager::GetLampParametersField);
-    AddMethodHandler("GetLampState", &lampManager, &LampManager::GetLampState);
-    AddMethodHandler("GetLampStateField", &lampManager, &LampManager::GetLampStateField);
-    AddMethodHandler("TransitionLampState", &lampManager, &LampManager::TransitionLampState);
-    AddMethodHandler("PulseLampWithState", &lampManager, &LampManager::PulseLampWithState);
-    AddMethodHandler("PulseLampWithPreset", &lampManager, &LampManager::PulseLampWithPreset);
-    AddMethodHandler("TransitionLampStateToPreset", &lampManager, &LampManager::TransitionLampStateToPreset);
-    AddMethodHandler("TransitionLampGroupState", &lampGroupManager, &LampGroupManager::TransitionLampGroupState);
-    AddMethodHandler("PulseLampGroupWithState", &lampGroupManager, &LampGroupManager::PulseLampGroupWithState);
-    AddMethodHandler("PulseLampGroupWithPreset", &lampGroupManager, &LampGroupManager::PulseLampGroupWithPreset);
-    AddMethodHandler("TransitionLampGroupStateToPreset", &lampGroupManager, &LampGroupManager::TransitionLampGroupStateToPreset);
-    AddMethodHandler("TransitionLampStateField", &lampManager, &LampManager::TransitionLampStateField);
-    AddMethodHandler("TransitionLampGroupStateField", &lampGroupManager, &LampGroupManager::TransitionLampGroupStateField);
-    AddMethodHandler("ResetLampState", &lampManager, &LampManager::ResetLampState);
-    AddMethodHandler("ResetLampGroupState", &lampGroupManager, &LampGroupManager::ResetLampGroupState);
-    AddMethodHandler("ResetLampStateField", &lampManager, &LampManager::ResetLampStateField);
-    AddMethodHandler("ResetLampGroupStateField", &lampGroupManager, &LampGroupManager::ResetLampGroupStateField);
-    AddMethodHandler("GetLampFaults", &lampManager, &LampManager::GetLampFaults);
-    AddMethodHandler("ClearLampFault", &lampManager, &LampManager::ClearLampFault);
-    AddMethodHandler("GetLampServiceVersion", &lampManager, &LampManager::GetLampServiceVersion);
-    AddMethodHandler("GetAllLampGroupIDs", &lampGroupManager, &LampGroupManager::GetAllLampGroupIDs);
-    AddMethodHandler("GetLampGroupName", &lampGroupManager, &LampGroupManager::GetLampGroupName);
-    AddMethodHandler("SetLampGroupName", &lampGroupManager, &LampGroupManager::SetLampGroupName);
-    AddMethodHandler("CreateLampGroup", &lampGroupManager, &LampGroupManager::CreateLampGroup);
-    AddMethodHandler("UpdateLampGroup", &lampGroupManager, &LampGroupManager::UpdateLampGroup);
-    AddMethodHandler("DeleteLampGroup", &lampGroupManager, &LampGroupManager::DeleteLampGroup);
-    AddMethodHandler("GetLampGroup", &lampGroupManager, &LampGroupManager::GetLampGroup);
-    AddMethodHandler("GetDefaultLampState", &presetManager, &PresetManager::GetDefaultLampState);
-    AddMethodHandler("SetDefaultLampState", &presetManager, &PresetManager::SetDefaultLampState);
-    AddMethodHandler("GetAllPresetIDs", &presetManager, &PresetManager::GetAllPresetIDs);
-    AddMethodHandler("GetPresetName", &presetManager, &PresetManager::GetPresetName);
-    AddMethodHandler("SetPresetName", &presetManager, &PresetManager::SetPresetName);
-    AddMethodHandler("CreatePreset", &presetManager, &PresetManager::CreatePreset);
-    AddMethodHandler("UpdatePreset", &presetManager, &PresetManager::UpdatePreset);
-    AddMethodHandler("DeletePreset", &presetManager, &PresetManager::DeletePreset);
-    AddMethodHandler("GetPreset", &presetManager, &PresetManager::GetPreset);
-    AddMethodHandler("GetAllSceneIDs", &sceneManager, &SceneManager::GetAllSceneIDs);
-    AddMethodHandler("GetSceneName", &sceneManager, &SceneManager::GetSceneName);
-    AddMethodHandler("SetSceneName", &sceneManager, &SceneManager::SetSceneName);
-    AddMethodHandler("CreateScene", &sceneManager, &SceneManager::CreateScene);
-    AddMethodHandler("UpdateScene", &sceneManager, &SceneManager::UpdateScene);
-    AddMethodHandler("DeleteScene", &sceneManager, &SceneManager::DeleteScene);
-    AddMethodHandler("GetScene", &sceneManager, &SceneManager::GetScene);
-    AddMethodHandler("ApplyScene", &sceneManager, &SceneManager::ApplyScene);
-    AddMethodHandler("GetAllMasterSceneIDs", &masterSceneManager, &MasterSceneManager::GetAllMasterSceneIDs);
-    AddMethodHandler("GetMasterSceneName", &masterSceneManager, &MasterSceneManager::GetMasterSceneName);
-    AddMethodHandler("SetMasterSceneName", &masterSceneManager, &MasterSceneManager::SetMasterSceneName);
-    AddMethodHandler("CreateMasterScene", &masterSceneManager, &MasterSceneManager::CreateMasterScene);
-    AddMethodHandler("UpdateMasterScene", &masterSceneManager, &MasterSceneManager::UpdateMasterScene);
-    AddMethodHandler("DeleteMasterScene", &masterSceneManager, &MasterSceneManager::DeleteMasterScene);
-    AddMethodHandler("GetMasterScene", &masterSceneManager, &MasterSceneManager::GetMasterScene);
-    AddMethodHandler("ApplyMasterScene", &masterSceneManager, &MasterSceneManager::ApplyMasterScene);
-    messageHandlersLock.Unlock();
-}
-
 ControllerService::~ControllerService()
 {
     QCC_DbgTrace(("%s", __func__));
@@ -385,16 +335,6 @@ ControllerService::~ControllerService()
         services::NotificationService::getInstance()->shutdown();
         notificationSender = NULL;
     }
-
-    DispatcherMap localCopy;
-    messageHandlersLock.Lock();
-    localCopy = messageHandlers;
-    messageHandlers.clear();
-    messageHandlersLock.Unlock();
-
-    for (DispatcherMap::iterator it = localCopy.begin(); it != localCopy.end(); it++) {
-        delete it->second;
-    }
 }
 
 QStatus ControllerService::CreateAndAddInterface(std::string interfaceDescription, const char* interfaceName) {
@@ -445,75 +385,102 @@ QStatus ControllerService::RegisterMethodHandlers(void)
     const InterfaceDescription* controllerServicePresetInterface = bus.GetInterface(ControllerServicePresetInterfaceName);
     const InterfaceDescription* controllerServiceSceneInterface = bus.GetInterface(ControllerServiceSceneInterfaceName);
     const InterfaceDescription* controllerServiceMasterSceneInterface = bus.GetInterface(ControllerServiceMasterSceneInterfaceName);
+    const InterfaceDescription* controllerServiceDiagnosticsInterface = bus.GetInterface(ControllerServiceDiagnosticsInterfaceName);
+
+    /*
+     * The handlers and the interface members live as long as the Controller Service, so
+     * the dispatch table is only built once even if the Controller Service is restarted
+     */
+    if (!dispatchTable.IsSealed()) {
+        bool added = true;
+        added &= AddMethodHandler(controllerServiceInterface->GetMember("LightingResetControllerService"), this, &ControllerService::LightingResetControllerService);
+        added &= AddMethodHandler(controllerServiceInterface->GetMember("GetControllerServiceVersion"), this, &ControllerService::GetControllerServiceVersion, true);
+        added &= AddMethodHandler(controllerServiceInterface->GetMember("GetReadReplicaStaleness"), this, &ControllerService::GetReadReplicaStaleness, true);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetAllLampIDs"), &lampManager, &LampManager::GetAllLampIDs);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampSupportedLanguages"), &lampManager, &LampManager::GetLampSupportedLanguages);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampManufacturer"), &lampManager, &LampManager::GetLampManufacturer);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampName"), &lampManager, &LampManager::GetLampName);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("SetLampName"), &lampManager, &LampManager::SetLampName);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampDetails"), &lampManager, &LampManager::GetLampDetails);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampParameters"), &lampManager, &LampManager::GetLampParameters);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampParametersField"), &lampManager, &LampManager::GetLampParametersField);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampState"), &lampManager, &LampManager::GetLampState);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetAllLampStates"), &lampManager, &LampManager::GetAllLampStates);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampStates"), &lampManager, &LampManager::GetLampStates);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampStateField"), &lampManager, &LampManager::GetLampStateField);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("TransitionLampState"), &lampManager, &LampManager::TransitionLampState, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("TransitionLampsToStates"), &lampManager, &LampManager::TransitionLampsToStates, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("PulseLampWithState"), &lampManager, &LampManager::PulseLampWithState, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("PulseLampWithPreset"), &lampManager, &LampManager::PulseLampWithPreset, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("TransitionLampStateToPreset"), &lampManager, &LampManager::TransitionLampStateToPreset, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("TransitionLampStateField"), &lampManager, &LampManager::TransitionLampStateField, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("ResetLampState"), &lampManager, &LampManager::ResetLampState, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("ResetLampStateField"), &lampManager, &LampManager::ResetLampStateField, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampFaults"), &lampManager, &LampManager::GetLampFaults);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("ClearLampFault"), &lampManager, &LampManager::ClearLampFault);
+        added &= AddMethodHandler(controllerServiceLampInterface->GetMember("GetLampServiceVersion"), &lampManager, &LampManager::GetLampServiceVersion);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("GetAllLampGroupIDs"), &lampGroupManager, &LampGroupManager::GetAllLampGroupIDs, true);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("GetLampGroupName"), &lampGroupManager, &LampGroupManager::GetLampGroupName, true);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("SetLampGroupName"), &lampGroupManager, &LampGroupManager::SetLampGroupName);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("CreateLampGroup"), &lampGroupManager, &LampGroupManager::CreateLampGroup);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("UpdateLampGroup"), &lampGroupManager, &LampGroupManager::UpdateLampGroup);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("DeleteLampGroup"), &lampGroupManager, &LampGroupManager::DeleteLampGroup);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("GetLampGroup"), &lampGroupManager, &LampGroupManager::GetLampGroup, true);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("GetAllLampGroups"), &lampGroupManager, &LampGroupManager::GetAllLampGroups, true);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("TransitionLampGroupState"), &lampGroupManager, &LampGroupManager::TransitionLampGroupState, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("PulseLampGroupWithState"), &lampGroupManager, &LampGroupManager::PulseLampGroupWithState, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("PulseLampGroupWithPreset"), &lampGroupManager, &LampGroupManager::PulseLampGroupWithPreset, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("TransitionLampGroupStateToPreset"), &lampGroupManager, &LampGroupManager::TransitionLampGroupStateToPreset, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("TransitionLampGroupStateField"), &lampGroupManager, &LampGroupManager::TransitionLampGroupStateField, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("ResetLampGroupState"), &lampGroupManager, &LampGroupManager::ResetLampGroupState, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServiceLampGroupInterface->GetMember("ResetLampGroupStateField"), &lampGroupManager, &LampGroupManager::ResetLampGroupStateField, false, METHOD_LANE_LAMP_CONTROL);
+        added &= AddMethodHandler(controllerServicePresetInterface->GetMember("GetDefaultLampState"), &presetManager, &PresetManager::GetDefaultLampState, true);
+        added &= AddMethodHandler(controllerServicePresetInterface->GetMember("SetDefaultLampState"), &presetManager, &PresetManager::SetDefaultLampState);
+        added &= AddMethodHandler(controllerServicePresetInterface->GetMember("GetAllPresetIDs"), &presetManager, &PresetManager::GetAllPresetIDs, true);
+        added &= AddMethodHandler(controllerServicePresetInterface->GetMember("GetPresetName"), &presetManager, &PresetManager::GetPresetName, true);
+        added &= AddMethodHandler(controllerServicePresetInterface->GetMember("SetPresetName"), &presetManager, &PresetManager::SetPresetName);
+        added &= AddMethodHandler(controllerServicePresetInterface->GetMember("CreatePreset"), &presetManager, &PresetManager::CreatePreset);
+        added &= AddMethodHandler(controllerServicePresetInterface->GetMember("UpdatePreset"), &presetManager, &PresetManager::UpdatePreset);
+        added &= AddMethodHandler(controllerServicePresetInterface->GetMember("DeletePreset"), &presetManager, &PresetManager::DeletePreset);
+        added &= AddMethodHandler(controllerServicePresetInterface->GetMember("GetPreset"), &presetManager, &PresetManager::GetPreset, true);
+        added &= AddMethodHandler(controllerServicePresetInterface->GetMember("GetAllPresets"), &presetManager, &PresetManager::GetAllPresets, true);
+        added &= AddMethodHandler(controllerServiceSceneInterface->GetMember("GetAllSceneIDs"), &sceneManager, &SceneManager::GetAllSceneIDs, true);
+        added &= AddMethodHandler(controllerServiceSceneInterface->GetMember("GetSceneName"), &sceneManager, &SceneManager::GetSceneName, true);
+        added &= AddMethodHandler(controllerServiceSceneInterface->GetMember("SetSceneName"), &sceneManager, &SceneManager::SetSceneName);
+        added &= AddMethodHandler(controllerServiceSceneInterface->GetMember("CreateScene"), &sceneManager, &SceneManager::CreateScene);
+        added &= AddMethodHandler(controllerServiceSceneInterface->GetMember("UpdateScene"), &sceneManager, &SceneManager::UpdateScene);
+        added &= AddMethodHandler(controllerServiceSceneInterface->GetMember("DeleteScene"), &sceneManager, &SceneManager::DeleteScene);
+        added &= AddMethodHandler(controllerServiceSceneInterface->GetMember("GetScene"), &sceneManager, &SceneManager::GetScene, true);
+        added &= AddMethodHandler(controllerServiceSceneInterface->GetMember("GetAllScenes"), &sceneManager, &SceneManager::GetAllScenes, true);
+        added &= AddMethodHandler(controllerServiceSceneInterface->GetMember("ApplyScene"), &sceneManager, &SceneManager::ApplyScene, false, METHOD_LANE_SCENE_APPLY);
+        added &= AddMethodHandler(controllerServiceMasterSceneInterface->GetMember("GetAllMasterSceneIDs"), &masterSceneManager, &MasterSceneManager::GetAllMasterSceneIDs, true);
+        added &= AddMethodHandler(controllerServiceMasterSceneInterface->GetMember("GetMasterSceneName"), &masterSceneManager, &MasterSceneManager::GetMasterSceneName, true);
+        added &= AddMethodHandler(controllerServiceMasterSceneInterface->GetMember("SetMasterSceneName"), &masterSceneManager, &MasterSceneManager::SetMasterSceneName);
+        added &= AddMethodHandler(controllerServiceMasterSceneInterface->GetMember("CreateMasterScene"), &masterSceneManager, &MasterSceneManager::CreateMasterScene);
+        added &= AddMethodHandler(controllerServiceMasterSceneInterface->GetMember("UpdateMasterScene"), &masterSceneManager, &MasterSceneManager::UpdateMasterScene);
+        added &= AddMethodHandler(controllerServiceMasterSceneInterface->GetMember("DeleteMasterScene"), &masterSceneManager, &MasterSceneManager::DeleteMasterScene);
+        added &= AddMethodHandler(controllerServiceMasterSceneInterface->GetMember("GetMasterScene"), &masterSceneManager, &MasterSceneManager::GetMasterScene, true);
+        added &= AddMethodHandler(controllerServiceMasterSceneInterface->GetMember("GetAllMasterScenes"), &masterSceneManager, &MasterSceneManager::GetAllMasterScenes, true);
+        added &= AddMethodHandler(controllerServiceMasterSceneInterface->GetMember("ApplyMasterScene"), &masterSceneManager, &MasterSceneManager::ApplyMasterScene, false, METHOD_LANE_SCENE_APPLY);
+        added &= AddMethodHandler(controllerServiceDiagnosticsInterface->GetMember("GetDiagnostics"), this, &ControllerService::GetDiagnostics, true);
+
+        if (!added) {
+            QCC_LogError(ER_BUS_INTERFACE_NO_SUCH_MEMBER, ("%s: Methods missing in the interfaces", __func__));
+        }
+        dispatchTable.Seal();
+        QCC_DbgPrintf(("%s: Dispatch table of %u methods", __func__, (uint32_t) dispatchTable.Size()));
+    }
 
     /*
      * Add method handlers for the various Controller Service interface methods
      */
-    const MethodEntry methodEntries[] = {
-        { controllerServiceInterface->GetMember("LightingResetControllerService"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceInterface->GetMember("GetControllerServiceVersion"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetAllLampIDs"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetLampSupportedLanguages"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetLampManufacturer"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetLampName"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("SetLampName"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetLampDetails"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetLampParameters"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetLampParametersField"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetLampState"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetLampStateField"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("TransitionLampState"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("PulseLampWithState"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("PulseLampWithPreset"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("TransitionLampStateToPreset"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("TransitionLampStateField"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("ResetLampState"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("ResetLampStateField"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetLampFaults"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("ClearLampFault"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampInterface->GetMember("GetLampServiceVersion"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("GetAllLampGroupIDs"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("GetLampGroupName"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("SetLampGroupName"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("CreateLampGroup"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("UpdateLampGroup"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("DeleteLampGroup"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("GetLampGroup"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("TransitionLampGroupState"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("PulseLampGroupWithState"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("PulseLampGroupWithPreset"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("TransitionLampGroupStateToPreset"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("TransitionLampGroupStateField"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("ResetLampGroupState"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceLampGroupInterface->GetMember("ResetLampGroupStateField"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServicePresetInterface->GetMember("GetDefaultLampState"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServicePresetInterface->GetMember("SetDefaultLampState"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServicePresetInterface->GetMember("GetAllPresetIDs"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServicePresetInterface->GetMember("GetPresetName"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServicePresetInterface->GetMember("SetPresetName"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServicePresetInterface->GetMember("CreatePreset"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServicePresetInterface->GetMember("UpdatePreset"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServicePresetInterface->GetMember("DeletePreset"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServicePresetInterface->GetMember("GetPreset"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceSceneInterface->GetMember("GetAllSceneIDs"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceSceneInterface->GetMember("GetSceneName"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceSceneInterface->GetMember("SetSceneName"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceSceneInterface->GetMember("CreateScene"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceSceneInterface->GetMember("UpdateScene"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceSceneInterface->GetMember("DeleteScene"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceSceneInterface->GetMember("GetScene"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceSceneInterface->GetMember("ApplyScene"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceMasterSceneInterface->GetMember("GetAllMasterSceneIDs"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceMasterSceneInterface->GetMember("GetMasterSceneName"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceMasterSceneInterface->GetMember("SetMasterSceneName"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceMasterSceneInterface->GetMember("CreateMasterScene"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceMasterSceneInterface->GetMember("UpdateMasterScene"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceMasterSceneInterface->GetMember("DeleteMasterScene"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceMasterSceneInterface->GetMember("GetMasterScene"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-        { controllerServiceMasterSceneInterface->GetMember("ApplyMasterScene"), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) },
-    };
+    std::vector<MethodEntry> methodEntries;
+    for (size_t i = 0; i < dispatchTable.Size(); i++) {
+        MethodEntry entry = { dispatchTable.GetMember(i), static_cast<MessageReceiver::MethodHandler>(&ControllerService::MethodCallDispatcher) };
+        methodEntries.push_back(entry);
+    }
 
-    status = AddMethodHandlers(methodEntries, sizeof(methodEntries) / sizeof(MethodEntry));
+    status = AddMethodHandlers(&methodEntries[0], methodEntries.size());
     if (status != ER_OK) {
         QCC_LogError(status, ("%s: Failed to AddMethodHandlers", __func__));
     }
@@ -526,6 +493,16 @@ QStatus ControllerService::Start(const char* keyStoreFileLocation)
     QCC_DbgPrintf(("%s:%s", __func__, keyStoreFileLocation));
     QStatus status = ER_OK;
 
+    memset(&startupMetrics, 0, sizeof(startupMetrics));
+    methodCallCount = 0;
+    for (size_t i = 0; i < dispatchTable.Size(); i++) {
+        MethodHandlerBase* handler = dispatchTable.Find(dispatchTable.GetMember(i));
+        if (handler) {
+            handler->callCount = 0;
+        }
+    }
+    startupMetrics.startTimestamp = GetTimestampInMs();
+
     /*
      * Start the OEM firmware
      */
@@ -555,82 +532,61 @@ QStatus ControllerService::Start(const char* keyStoreFileLocation)
     }
 
     bus.RegisterBusListener(*listener);
+    startupMetrics.busStarted = GetStartupTime();
 
     /*
-     * Connect to the AllJoyn Bus
+     * Loading a store may schedule a write
      */
-    status = bus.Connect();
+    status = fileWriterThread.Start();
     if (status != ER_OK) {
-        QCC_LogError(status, ("%s: Failed to connect to the bus\n", __func__));
+        QCC_LogError(status, ("%s: Failed to start file writer thread", __func__));
         return status;
     }
 
     /*
-     * Create and Add the Controller Service Interfaces to the AllJoyn Bus
+     * The method calls are served once the bus object is registered
      */
-    const InterfaceEntry interfaceEntries[] = {
-        { ControllerServiceDescription, ControllerServiceInterfaceName },
-        { ControllerServiceLampDescription, ControllerServiceLampInterfaceName },
-        { ControllerServiceLampGroupDescription, ControllerServiceLampGroupInterfaceName },
-        { ControllerServicePresetDescription, ControllerServicePresetInterfaceName },
-        { ControllerServiceSceneDescription, ControllerServiceSceneInterfaceName },
-        { ControllerServiceMasterSceneDescription, ControllerServiceMasterSceneInterfaceName }
-    };
-
-    status = CreateAndAddInterfaces(interfaceEntries, sizeof(interfaceEntries) / sizeof(InterfaceEntry));
+    clientRateLimiter.Reset();
+    status = methodExecutor.Start();
     if (status != ER_OK) {
-        QCC_LogError(status, ("%s: Failed to CreateAndAddInterfaces", __func__));
+        QCC_LogError(status, ("%s: Failed to start the method executor", __func__));
         return status;
     }
 
-    status = RegisterMethodHandlers();
-    if (status != ER_OK) {
-        QCC_LogError(status, ("%s: Failed to RegisterMethodHandlers", __func__));
-        return status;
-    }
+    /*
+     * Load the persistent stores in parallel with each other and with the rest
+     * of the bus setup. The stores must be loaded before the Controller Service
+     * serves requests and takes part in the election
+     */
+    StoreLoaderThread lampGroupLoader(lampGroupManager);
+    StoreLoaderThread presetLoader(presetManager);
+    StoreLoaderThread masterSceneLoader(masterSceneManager);
+    lampGroupLoader.StartLoading();
+    presetLoader.StartLoading();
+    masterSceneLoader.StartLoading();
 
-    status = fileWriterThread.Start();
-    if (status != ER_OK) {
-        QCC_LogError(status, ("%s: Failed to start file writer thread", __func__));
-        return status;
-    }
+    status = StartBusAndInterfaces(keyStoreFileLocation);
 
     /*
-     * Initialize About
+     * Once registered on the connected bus, the SceneObjects of the Scene store
+     * add themselves to the About announcement: load the scenes once About is
+     * set up and the main thread is done with its object descriptions
      */
-    services::AboutServiceApi::Init(bus, propertyStore);
-    aboutService = services::AboutServiceApi::getInstance();
-    if (aboutService) {
-        std::vector<qcc::String> ifaces;
-        ifaces.push_back(qcc::String(ControllerServiceInterfaceName));
-        ifaces.push_back(qcc::String(ControllerServiceLampInterfaceName));
-        ifaces.push_back(qcc::String(ControllerServiceLampGroupInterfaceName));
-        ifaces.push_back(qcc::String(ControllerServicePresetInterfaceName));
-        ifaces.push_back(qcc::String(ControllerServiceSceneInterfaceName));
-        ifaces.push_back(qcc::String(ControllerServiceMasterSceneInterfaceName));
-        aboutService->AddObjectDescription(ControllerServiceObjectPath, ifaces);
-
-        ifaces.clear();
-        ifaces.push_back(AboutIconInterfaceName);
-        aboutService->AddObjectDescription(AboutIconObjectPath, ifaces);
+    StoreLoaderThread sceneLoader(sceneManager);
+    if (status == ER_OK) {
+        sceneLoader.StartLoading();
+    }
 
-        ifaces.clear();
-        ifaces.push_back(ConfigServiceInterfaceName);
-        aboutService->AddObjectDescription(ConfigServiceObjectPath, ifaces);
+    startupMetrics.lampGroupStoreLoad = lampGroupLoader.WaitUntilLoaded();
+    startupMetrics.presetStoreLoad = presetLoader.WaitUntilLoaded();
+    startupMetrics.sceneStoreLoad = sceneLoader.WaitUntilLoaded();
+    startupMetrics.masterSceneStoreLoad = masterSceneLoader.WaitUntilLoaded();
+    startupMetrics.storesLoaded = GetStartupTime();
 
-        status = aboutService->Register(ControllerServiceSessionPort);
-        if (status != ER_OK) {
-            QCC_LogError(status, ("%s: Failed to AddMethodHandlers", __func__));
-            return status;
-        }
-    } else {
-        status = ER_FAIL;
-        QCC_LogError(status, ("%s: Failed to initialize About", __func__));
+    if (status != ER_OK) {
         return status;
     }
 
-    Initialize();
-
     /*
      * Register the Config Service on the AllJoyn bus
      */
@@ -684,23 +640,116 @@ QStatus ControllerService::Start(const char* keyStoreFileLocation)
         QCC_LogError(status, ("%s: Failed to register BusObject for the Controller Service", __func__));
         return status;
     }
+    startupMetrics.servicesRegistered = GetStartupTime();
+
+    status = services::AnnouncementRegistrar::RegisterAnnounceHandler(bus, *listener, OnboardingInterfaces, 2);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to register Announce Handler", __func__));
+    }
+
+    QCC_DbgPrintf(("%s: Startup stages in ms: bus started %u, bus connected %u, interfaces ready %u, lamp discovery started %u, About ready %u, "
+                   "stores loaded %u (lamp groups %u, presets %u, scenes %u, master scenes %u), services registered %u", __func__,
+                   startupMetrics.busStarted, startupMetrics.busConnected, startupMetrics.interfacesReady, startupMetrics.lampDiscoveryStarted,
+                   startupMetrics.aboutReady, startupMetrics.storesLoaded, startupMetrics.lampGroupStoreLoad, startupMetrics.presetStoreLoad,
+                   startupMetrics.sceneStoreLoad, startupMetrics.masterSceneStoreLoad, startupMetrics.servicesRegistered));
 
+    return status;
+}
+
+QStatus ControllerService::StartBusAndInterfaces(const char* keyStoreFileLocation)
+{
+    QCC_DbgTrace(("%s", __func__));
     /*
-     * Start the Lamp Manager
+     * Connect to the AllJoyn Bus
+     */
+    QStatus status = bus.Connect();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to connect to the bus\n", __func__));
+        return status;
+    }
+    startupMetrics.busConnected = GetStartupTime();
+
+    /*
+     * Create and Add the Controller Service Interfaces to the AllJoyn Bus
+     */
+    const InterfaceEntry interfaceEntries[] = {
+        { ControllerServiceDescription, ControllerServiceInterfaceName },
+        { ControllerServiceLampDescription, ControllerServiceLampInterfaceName },
+        { ControllerServiceLampGroupDescription, ControllerServiceLampGroupInterfaceName },
+        { ControllerServicePresetDescription, ControllerServicePresetInterfaceName },
+        { ControllerServiceSceneDescription, ControllerServiceSceneInterfaceName },
+        { ControllerServiceMasterSceneDescription, ControllerServiceMasterSceneInterfaceName },
+        { ControllerServiceDiagnosticsDescription, ControllerServiceDiagnosticsInterfaceName }
+    };
+
+    status = CreateAndAddInterfaces(interfaceEntries, sizeof(interfaceEntries) / sizeof(InterfaceEntry));
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to CreateAndAddInterfaces", __func__));
+        return status;
+    }
+
+    status = RegisterMethodHandlers();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to RegisterMethodHandlers", __func__));
+        return status;
+    }
+
+    startupMetrics.interfacesReady = GetStartupTime();
+
+    /*
+     * Start the Lamp Manager. Lamps are discovered while the stores load; no
+     * client can be told about them before the Controller Service is registered
      */
     status = lampManager.Start(keyStoreFileLocation);
     if (status != ER_OK) {
         QCC_LogError(status, ("%s: Failed to start the LampManager", __func__));
+    } else {
+        startupMetrics.lampDiscoveryStarted = GetStartupTime();
     }
 
-    status = services::AnnouncementRegistrar::RegisterAnnounceHandler(bus, *listener, OnboardingInterfaces, 2);
-    if (status != ER_OK) {
-        QCC_LogError(status, ("%s: Failed to register Announce Handler", __func__));
+    /*
+     * Initialize About
+     */
+    services::AboutServiceApi::Init(bus, propertyStore);
+    aboutService = services::AboutServiceApi::getInstance();
+    if (aboutService) {
+        std::vector<qcc::String> ifaces;
+        ifaces.push_back(qcc::String(ControllerServiceInterfaceName));
+        ifaces.push_back(qcc::String(ControllerServiceLampInterfaceName));
+        ifaces.push_back(qcc::String(ControllerServiceLampGroupInterfaceName));
+        ifaces.push_back(qcc::String(ControllerServicePresetInterfaceName));
+        ifaces.push_back(qcc::String(ControllerServiceSceneInterfaceName));
+        ifaces.push_back(qcc::String(ControllerServiceMasterSceneInterfaceName));
+        aboutService->AddObjectDescription(ControllerServiceObjectPath, ifaces);
+
+        ifaces.clear();
+        ifaces.push_back(AboutIconInterfaceName);
+        aboutService->AddObjectDescription(AboutIconObjectPath, ifaces);
+
+        ifaces.clear();
+        ifaces.push_back(ConfigServiceInterfaceName);
+        aboutService->AddObjectDescription(ConfigServiceObjectPath, ifaces);
+
+        status = aboutService->Register(ControllerServiceSessionPort);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("%s: Failed to AddMethodHandlers", __func__));
+            return status;
+        }
+    } else {
+        status = ER_FAIL;
+        QCC_LogError(status, ("%s: Failed to initialize About", __func__));
+        return status;
     }
+    startupMetrics.aboutReady = GetStartupTime();
 
     return status;
 }
 
+uint32_t ControllerService::GetStartupTime(void) const
+{
+    return static_cast<uint32_t>(GetTimestampInMs() - startupMetrics.startTimestamp);
+}
+
 QStatus ControllerService::Stop(void)
 {
     QCC_DbgPrintf(("%s", __func__));
@@ -721,6 +770,12 @@ QStatus ControllerService::Stop(void)
 
     LeaveSession();
 
+    methodExecutor.Stop();
+
+    lampStateSignalBatcher.Stop();
+
+    diagnosticsDumper.Stop();
+
     elector.Stop();
 
     lampManager.Stop();
@@ -770,6 +825,12 @@ QStatus ControllerService::Stop(void)
 
 QStatus ControllerService::Join(void)
 {
+    methodExecutor.Join();
+
+    lampStateSignalBatcher.Join();
+
+    diagnosticsDumper.Join();
+
     elector.Join();
 
     lampManager.Join();
@@ -795,17 +856,8 @@ QStatus ControllerService::SendSignal(const char* ifaceName, const char* signalN
     QCC_DbgTrace(("%s:ifaceName=%s signalName=%s", __func__, ifaceName, signalName));
     QStatus status = ER_BUS_NO_SESSION;
 
-    size_t arraySize = idList.size();
     MsgArg arg;
-    if (arraySize) {
-        const char** ids = new const char*[arraySize];
-        size_t i = 0;
-        for (LSFStringList::const_iterator it = idList.begin(); it != idList.end(); ++it, ++i) {
-            ids[i] = it->c_str();
-        }
-        arg.Set("as", arraySize, ids);
-        delete [] ids;
-    }
+    CreateStringListArg(idList, arg);
 
 
 
@@ -875,9 +927,10 @@ QStatus ControllerService::SendStateChangedSignal(const char* ifaceName, const c
     QStatus status = ER_BUS_NO_SESSION;
 
     MsgArg args[2];
+    LampStateMsgArgs stateArgs;
 
     args[0].Set("s", lampID.c_str());
-    lampState.Get(&args[1]);
+    lampState.Get(&args[1], stateArgs);
 
     serviceSessionMutex.Lock();
     if (serviceSession != 0) {
@@ -901,6 +954,33 @@ QStatus ControllerService::SendStateChangedSignal(const char* ifaceName, const c
     return status;
 }
 
+QStatus ControllerService::SendLampsStateChangedSignal(const LampStateMap& lampStates)
+{
+    QCC_DbgTrace(("%s: %u lamps", __func__, (uint32_t) lampStates.size()));
+    QStatus status = ER_BUS_NO_SESSION;
+
+    MsgArg arg;
+    CreateLampStateMapArg(lampStates, arg);
+
+    serviceSessionMutex.Lock();
+    if (serviceSession != 0) {
+        const InterfaceDescription* interface = bus.GetInterface(ControllerServiceLampInterfaceName);
+        if (interface) {
+            const InterfaceDescription::Member* signal = interface->GetMember("LampsStateChanged");
+            if (signal) {
+                status = Signal(NULL, serviceSession, *signal, &arg, 1, 0);
+            }
+        }
+    }
+    serviceSessionMutex.Unlock();
+
+    if (ER_OK != status) {
+        QCC_LogError(status, ("%s: Failed to send signal", __func__));
+    }
+
+    return status;
+}
+
 QStatus ControllerService::SendSignalWithoutArg(const char* ifaceName, const char* signalName)
 {
     QCC_DbgTrace(("%s:ifaceName=%s signalName=%s", __func__, ifaceName, signalName));
@@ -1107,37 +1187,207 @@ void ControllerService::GetControllerServiceVersion(Message& msg)
     SendMethodReplyWithUint32Value(msg, version);
 }
 
-lsf::Mutex methodCallCountMutex;
-uint32_t methodCallCount = 0;
+void ControllerService::GetReadReplicaStaleness(Message& msg)
+{
+    QCC_DbgPrintf(("%s:%s", __func__, msg->ToString().c_str()));
+
+    LSFResponseCode responseCode = LSF_OK;
+    bool leader = IsLeader();
+    uint32_t staleness = 0;
+
+    if (!leader) {
+        qcc::String leaderBusName;
+        if (!elector.GetReplicaStaleness(staleness, leaderBusName)) {
+            responseCode = LSF_ERR_BUSY;
+        }
+    }
+
+    MsgArg replyArgs[3];
+    replyArgs[0].Set("u", responseCode);
+    replyArgs[1].Set("b", leader);
+    replyArgs[2].Set("u", staleness);
+    SendMethodReply(msg, replyArgs, 3);
+}
+
+void ControllerService::GetDiagnosticsSnapshot(DiagnosticsSnapshot& snapshot)
+{
+    snapshot.uptime = GetTimestampInMs() - startupMetrics.startTimestamp;
+    snapshot.methodCallCount = static_cast<uint32_t>(methodCallCount);
+
+    snapshot.methodCallCounts.clear();
+    for (size_t i = 0; i < dispatchTable.Size(); i++) {
+        const InterfaceDescription::Member* member = dispatchTable.GetMember(i);
+        MethodHandlerBase* handler = dispatchTable.Find(member);
+        if (handler) {
+            LSFString name = LSFString(member->iface->GetName()) + "." + member->name.c_str();
+            snapshot.methodCallCounts[name] = static_cast<uint32_t>(handler->callCount);
+        }
+    }
+
+    lampManager.GetLampClientsDiagnostics(snapshot.lampClients);
+    fileWriterThread.GetMetrics(snapshot.persistence);
+    elector.GetElectionState(snapshot.election);
+}
+
+void ControllerService::GetDiagnostics(Message& msg)
+{
+    QCC_DbgPrintf(("%s:%s", __func__, msg->ToString().c_str()));
+
+    DiagnosticsSnapshot snapshot;
+    GetDiagnosticsSnapshot(snapshot);
+
+    MsgArg replyArgs[2];
+    replyArgs[0].Set("u", LSF_OK);
+    DiagnosticsSnapshotToMsgArg(snapshot, replyArgs[1]);
+    SendMethodReply(msg, replyArgs, 2);
+}
 
 void ControllerService::MethodCallDispatcher(const InterfaceDescription::Member* member, Message& msg)
 {
     bus.EnableConcurrentCallbacks();
 
+    /*
+     * The trace of the call is copied into the queued call by Submit
+     */
+    TraceContext traceContext(Tracer::StartTrace());
+    TraceSpan traceSpan("MethodCallDispatcher");
+
     QCC_DbgPrintf(("%s: Received Method call %s from interface %s", __func__, msg->GetMemberName(), msg->GetInterface()));
-    uint32_t tempMethodCallCount = 0;
+    uint32_t tempMethodCallCount = static_cast<uint32_t>(qcc::IncrementAndFetch(&methodCallCount));
 
-    methodCallCountMutex.Lock();
-    methodCallCount++;
-    tempMethodCallCount = methodCallCount;
-    methodCallCountMutex.Unlock();
+    if (tempMethodCallCount == 1) {
+        startupMetrics.firstRequestServed = GetStartupTime();
+        QCC_DbgPrintf(("%s: Time to first request: %u ms", __func__, startupMetrics.firstRequestServed));
+    }
 
 
     QCC_DbgPrintf(("%s: Received Method call %s with method call count %u", __func__, msg->GetMemberName(), tempMethodCallCount));
 
-    MethodHandlerBase* handler = NULL;
-
-    messageHandlersLock.Lock();
-    DispatcherMap::iterator it = messageHandlers.find(msg->GetMemberName());
-    if (it != messageHandlers.end()) {
-        handler = it->second;
-    } else {
+    /*
+     * The dispatch table is sealed before the method handlers are registered
+     */
+    MethodHandlerBase* handler = dispatchTable.Find(member);
+    if (!handler) {
         QCC_LogError(ER_FAIL, ("%s: Could not find handler for method call", __func__));
+    } else {
+        qcc::IncrementAndFetch(&handler->callCount);
     }
-    messageHandlersLock.Unlock();
 
-    if (handler) {
-        handler->Handle(msg);
+#if OEM_CS_READ_REPLICA
+    if (handler && !handler->readOnly && !IsLeader()) {
+        uint32_t staleness;
+        qcc::String leaderBusName;
+        elector.GetReplicaStaleness(staleness, leaderBusName);
+        QCC_DbgPrintf(("%s: Only the leader %s serves %s", __func__, leaderBusName.c_str(), msg->GetMemberName()));
+        QStatus status = ajn::BusObject::MethodReply(msg, ControllerServiceNotLeaderErrorName, leaderBusName.c_str());
+        if (status != ER_OK) {
+            QCC_LogError(status, ("%s: Error sending reply", __func__));
+        }
+        return;
+    }
+#endif
+
+    /*
+     * An app over the rate of the lane is turned away before its call takes a
+     * place in the queues that the other apps share
+     */
+    if (handler && handler->rateLimited && !clientRateLimiter.Admit(msg->GetSender(), handler->lane)) {
+        QCC_DbgPrintf(("%s: %s exceeded its rate; rejecting %s", __func__, msg->GetSender(), msg->GetMemberName()));
+        SendBusyReply(member, msg);
+        return;
+    }
+
+    if (handler && !methodExecutor.Submit(handler->lane, handler, msg)) {
+        QCC_DbgPrintf(("%s: Too many calls queued to serve %s", __func__, msg->GetMemberName()));
+        SendBusyReply(member, msg);
+    }
+}
+
+/*
+ * Length of the complete type at the start of a signature
+ */
+static size_t GetCompleteTypeLength(const char* signature)
+{
+    if (*signature == 'a') {
+        return 1 + GetCompleteTypeLength(signature + 1);
+    }
+
+    if ((*signature == '(') || (*signature == '{')) {
+        size_t depth = 0;
+        const char* end = signature;
+        do {
+            if ((*end == '(') || (*end == '{')) {
+                depth++;
+            } else if ((*end == ')') || (*end == '}')) {
+                depth--;
+            }
+            end++;
+        } while (depth && *end);
+        return end - signature;
+    }
+
+    return (*signature) ? 1 : 0;
+}
+
+/*
+ * Number of reply arguments that SendBusyReply marshals
+ */
+#define BUSY_REPLY_MAX_ARGS 8
+
+void ControllerService::SendBusyReply(const InterfaceDescription::Member* member, const ajn::Message& msg)
+{
+    QCC_DbgPrintf(("%s: Busy reply for %s", __func__, msg->GetMemberName()));
+
+    size_t numInArgs = 0;
+    const MsgArg* inArgs = NULL;
+    msg->GetArgs(numInArgs, inArgs);
+
+    /*
+     * The replies start with the response code and then echo the leading
+     * arguments of the call, typically the IDs it was about. The arguments
+     * that the call does not provide get an empty value
+     */
+    MsgArg replyArgs[BUSY_REPLY_MAX_ARGS];
+    const char* signature = member->returnSignature.c_str();
+    size_t numReplyArgs = 0;
+    bool supported = (*signature == 'u');
+
+    while (supported && *signature) {
+        size_t length = GetCompleteTypeLength(signature);
+        std::string type(signature, length);
+        signature += length;
+
+        if (numReplyArgs == BUSY_REPLY_MAX_ARGS) {
+            supported = false;
+        } else if (numReplyArgs == 0) {
+            replyArgs[0].Set("u", LSF_ERR_BUSY);
+        } else if ((numReplyArgs - 1 < numInArgs) && inArgs[numReplyArgs - 1].HasSignature(type.c_str())) {
+            replyArgs[numReplyArgs] = inArgs[numReplyArgs - 1];
+        } else if (type[0] == 'a') {
+            replyArgs[numReplyArgs].Set(type.c_str(), (size_t)0, NULL);
+        } else if (type == "s") {
+            replyArgs[numReplyArgs].Set("s", "");
+        } else if (type == "u") {
+            replyArgs[numReplyArgs].Set("u", 0);
+        } else if (type == "b") {
+            replyArgs[numReplyArgs].Set("b", false);
+        } else if (type == "v") {
+            replyArgs[numReplyArgs].Set("v", new MsgArg("u", 0));
+            replyArgs[numReplyArgs].SetOwnershipFlags(MsgArg::OwnsArgs);
+        } else {
+            supported = false;
+        }
+        numReplyArgs++;
+    }
+
+    QStatus status;
+    if (supported) {
+        status = ajn::BusObject::MethodReply(msg, replyArgs, numReplyArgs);
+    } else {
+        status = ajn::BusObject::MethodReply(msg, ControllerServiceBusyErrorName, msg->GetMemberName());
+    }
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Error sending reply", __func__));
     }
 }
 
@@ -1160,20 +1410,8 @@ void ControllerService::SendMethodReplyWithResponseCodeAndListOfIDs(const ajn::M
 
     replyArgs[0].Set("u", responseCode);
 
-    size_t arraySize = idList.size();
-    if (arraySize) {
-        const char** ids = new const char*[arraySize];
-        size_t i = 0;
-        for (LSFStringList::const_iterator it = idList.begin(); it != idList.end(); ++it, ++i) {
-            ids[i] = it->c_str();
-        }
-
-        replyArgs[1].Set("as", arraySize, ids);
-        delete [] ids;
-        QCC_DbgPrintf(("%s: Sending method reply with %d entries", __func__, arraySize));
-    } else {
-        replyArgs[1].Set("as", 0, NULL);
-    }
+    CreateStringListArg(idList, replyArgs[1]);
+    QCC_DbgPrintf(("%s: Sending method reply with %d entries", __func__, idList.size()));
 
     QStatus status = ajn::BusObject::MethodReply(msg, replyArgs, sizeof(replyArgs) / sizeof(MsgArg));
     if (status == ER_OK) {
@@ -1252,10 +1490,10 @@ void ControllerService::SendMethodReplyWithResponseCodeIDLanguageAndName(const a
     }
 }
 
-void ControllerService::ScheduleFileReadWrite(Manager* manager)
+void ControllerService::ScheduleFileReadWrite(Manager* manager, bool urgent)
 {
     QCC_DbgTrace(("%s", __func__));
-    fileWriterThread.SignalReadWrite();
+    fileWriterThread.SignalReadWrite(manager, urgent);
 }
 
 uint32_t ControllerService::GetControllerServiceInterfaceVersion(void)
@@ -1282,6 +1520,8 @@ QStatus ControllerService::Get(const char*ifcName, const char*propName, MsgArg&
             status = val.Set("u", sceneManager.GetControllerServiceSceneInterfaceVersion());
         } else if (0 == strcmp(ifcName, ControllerServiceMasterSceneInterfaceName)) {
             status = val.Set("u", masterSceneManager.GetControllerServiceMasterSceneInterfaceVersion());
+        } else if (0 == strcmp(ifcName, ControllerServiceDiagnosticsInterfaceName)) {
+            status = val.Set("u", ControllerServiceDiagnosticsInterfaceVersion);
         } else if (0 == strcmp(ifcName, LeaderElectionAndStateSyncInterfaceName)) {
             //TODO: Add support to return LSFTypes::LeaderElectionAndStateSyncInterfaceVersion
         } else {
@@ -1294,7 +1534,7 @@ QStatus ControllerService::Get(const char*ifcName, const char*propName, MsgArg&
     return status;
 }
 
-QStatus ControllerService::SendBlobUpdate(LSFBlobType type, std::string blob, uint32_t checksum, uint64_t timestamp)
+QStatus ControllerService::SendBlobUpdate(LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp)
 {
     QCC_DbgTrace(("%s: (type=%d blob=%s checksum=%d timestamp=%llu)", __func__, type, blob.c_str(), checksum, timestamp));
     SessionId session = 0;
@@ -1310,7 +1550,35 @@ QStatus ControllerService::SendBlobUpdate(LSFBlobType type, std::string blob, ui
     }
 }
 
-void ControllerService::SendGetBlobReply(ajn::Message& message, LSFBlobType type, std::string blob, uint32_t checksum, uint64_t timestamp)
+QStatus ControllerService::SendBlobDelta(LSFBlobType type, const StoreChangeSet& changes, uint32_t checksum, uint64_t timestamp)
+{
+    QCC_DbgTrace(("%s: (type=%d changes=%u checksum=%d timestamp=%llu)", __func__, type, (uint32_t) changes.records.size(), checksum, timestamp));
+    SessionId session = 0;
+    serviceSessionMutex.Lock();
+    session = serviceSession;
+    serviceSessionMutex.Unlock();
+    if (session != 0) {
+        QCC_DbgPrintf(("%s: Sending over Session ID = %u", __func__, session));
+        return elector.SendBlobDelta(session, type, changes, checksum, timestamp);
+    } else {
+        QCC_LogError(ER_FAIL, ("%s: session = 0", __func__));
+        return ER_FAIL;
+    }
+}
+
+QStatus ControllerService::SendHeartbeat(void)
+{
+    SessionId session = 0;
+    serviceSessionMutex.Lock();
+    session = serviceSession;
+    serviceSessionMutex.Unlock();
+    if (session != 0) {
+        return elector.SendHeartbeat(session);
+    }
+    return ER_OK;
+}
+
+void ControllerService::SendGetBlobReply(ajn::Message& message, LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp)
 {
     QCC_DbgTrace(("%s:type=%d blob=%s checksum=%d timestamp=%llu", __func__, type, blob.c_str(), checksum, timestamp));
     elector.SendGetBlobReply(message, type, blob, checksum, timestamp);
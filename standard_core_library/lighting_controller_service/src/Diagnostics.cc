@@ -0,0 +1,253 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/Debug.h>
+#include <Diagnostics.h>
+#include <ControllerService.h>
+
+#include <stdio.h>
+#include <vector>
+
+using namespace lsf;
+
+#define QCC_MODULE "DIAGNOSTICS"
+
+/*
+ * Walks the fields of a snapshot, so that the bus dictionary and the dump
+ * file use the same names
+ */
+template <typename VISITOR>
+static void VisitSnapshot(const DiagnosticsSnapshot& snapshot, VISITOR& visitor)
+{
+    visitor.Add("uptime", snapshot.uptime);
+    visitor.Add("methodCallCount", snapshot.methodCallCount);
+    visitor.Add("methodCallCounts", snapshot.methodCallCounts);
+
+    visitor.Add("lampClientsQueueDepth", snapshot.lampClients.queueDepth);
+    visitor.Add("lampClientsPendingResponses", snapshot.lampClients.pendingResponses);
+    visitor.Add("connectedLamps", snapshot.lampClients.connectedLamps);
+    visitor.Add("blacklistedLamps", snapshot.lampClients.blacklistedLamps);
+    visitor.Add("retryingLamps", snapshot.lampClients.retryingLamps);
+
+    visitor.Add("persistenceSignals", snapshot.persistence.signals);
+    visitor.Add("persistenceWrites", snapshot.persistence.writes);
+    visitor.Add("persistenceCommits", snapshot.persistence.commits);
+    visitor.Add("persistenceTotalCommitTime", snapshot.persistence.totalCommitTime);
+    visitor.Add("persistenceMaxCommitTime", snapshot.persistence.maxCommitTime);
+    visitor.Add("persistenceLastCommitTime", snapshot.persistence.lastCommitTime);
+
+    visitor.Add("isLeader", snapshot.election.isLeader);
+    visitor.Add("leaderBusName", snapshot.election.leaderBusName.c_str());
+    visitor.Add("leaderRankHigherBits", snapshot.election.leaderRankHigherBits);
+    visitor.Add("leaderRankLowerBits", snapshot.election.leaderRankLowerBits);
+    visitor.Add("storesSynchronized", snapshot.election.storesSynchronized);
+    visitor.Add("replicaStaleness", snapshot.election.replicaStaleness);
+    visitor.Add("knownControllers", snapshot.election.knownControllers);
+    visitor.Add("electionPending", snapshot.election.electionPending);
+}
+
+class MsgArgBuilder {
+  public:
+    void Add(const char* name, uint32_t value) {
+        AddEntry(name, new MsgArg("u", value));
+    }
+
+    void Add(const char* name, uint64_t value) {
+        AddEntry(name, new MsgArg("t", value));
+    }
+
+    void Add(const char* name, bool value) {
+        AddEntry(name, new MsgArg("b", value));
+    }
+
+    void Add(const char* name, const char* value) {
+        AddEntry(name, new MsgArg("s", value));
+    }
+
+    void Add(const char* name, const std::map<LSFString, uint32_t>& counts) {
+        MsgArg* countArgs = counts.empty() ? NULL : new MsgArg[counts.size()];
+        size_t i = 0;
+        for (std::map<LSFString, uint32_t>::const_iterator it = counts.begin(); it != counts.end(); ++it, ++i) {
+            countArgs[i].Set("{su}", it->first.c_str(), it->second);
+        }
+        AddEntry(name, new MsgArg("a{su}", counts.size(), countArgs));
+    }
+
+    void Get(MsgArg& arg) {
+        MsgArg* dict = new MsgArg[entries.size()];
+        for (size_t i = 0; i < entries.size(); i++) {
+            dict[i].Set("{sv}", entries[i].first, entries[i].second);
+        }
+        arg.Set("a{sv}", entries.size(), dict);
+        arg.SetOwnershipFlags(MsgArg::OwnsArgs, true);
+    }
+
+  private:
+    void AddEntry(const char* name, MsgArg* value) {
+        entries.push_back(std::make_pair(name, value));
+    }
+
+    std::vector<std::pair<const char*, MsgArg*> > entries;
+};
+
+class TextBuilder {
+  public:
+    void Add(const char* name, uint32_t value) {
+        char line[128];
+        snprintf(line, sizeof(line), "%s %u\n", name, value);
+        text += line;
+    }
+
+    void Add(const char* name, uint64_t value) {
+        char line[128];
+        snprintf(line, sizeof(line), "%s %llu\n", name, (unsigned long long) value);
+        text += line;
+    }
+
+    void Add(const char* name, bool value) {
+        Add(name, static_cast<uint32_t>(value ? 1 : 0));
+    }
+
+    void Add(const char* name, const char* value) {
+        text += name;
+        text += " ";
+        text += value;
+        text += "\n";
+    }
+
+    void Add(const char* name, const std::map<LSFString, uint32_t>& counts) {
+        for (std::map<LSFString, uint32_t>::const_iterator it = counts.begin(); it != counts.end(); ++it) {
+            Add((std::string(name) + "." + it->first).c_str(), it->second);
+        }
+    }
+
+    std::string text;
+};
+
+void lsf::DiagnosticsSnapshotToMsgArg(const DiagnosticsSnapshot& snapshot, ajn::MsgArg& arg)
+{
+    MsgArgBuilder builder;
+    VisitSnapshot(snapshot, builder);
+    builder.Get(arg);
+}
+
+std::string lsf::DiagnosticsSnapshotToString(const DiagnosticsSnapshot& snapshot)
+{
+    TextBuilder builder;
+    VisitSnapshot(snapshot, builder);
+    return builder.text;
+}
+
+DiagnosticsDumper::DiagnosticsDumper(ControllerService& service)
+    : service(service),
+    interval(0),
+    alarm(this)
+{
+    QCC_DbgTrace(("%s", __func__));
+}
+
+DiagnosticsDumper::~DiagnosticsDumper()
+{
+    QCC_DbgTrace(("%s", __func__));
+}
+
+QStatus DiagnosticsDumper::Start(const std::string& filePath, uint32_t intervalMs)
+{
+    QCC_DbgPrintf(("%s: filePath=%s intervalMs=%u", __func__, filePath.c_str(), intervalMs));
+    if (filePath.empty() || (intervalMs == 0)) {
+        return ER_BAD_ARG_1;
+    }
+
+    lock.Lock();
+    path = filePath;
+    interval = intervalMs;
+    lock.Unlock();
+
+    /*
+     * Write a first snapshot now so that a bad path is reported to the caller
+     */
+    QStatus status = Dump();
+    alarm.SetAlarmInMs(intervalMs);
+    return status;
+}
+
+void DiagnosticsDumper::AlarmTriggered(void)
+{
+    Dump();
+
+    lock.Lock();
+    uint32_t nextDump = interval;
+    lock.Unlock();
+
+    if (nextDump) {
+        alarm.SetAlarmInMs(nextDump);
+    }
+}
+
+QStatus DiagnosticsDumper::Dump(void)
+{
+    lock.Lock();
+    std::string filePath = path;
+    lock.Unlock();
+
+    if (filePath.empty()) {
+        return ER_OK;
+    }
+
+    DiagnosticsSnapshot snapshot;
+    service.GetDiagnosticsSnapshot(snapshot);
+    std::string text = DiagnosticsSnapshotToString(snapshot);
+    text += Thread::GetStatsText();
+    if (LockProfiler::IsEnabled()) {
+        text += LockProfiler::GetStatsText();
+    }
+
+    /*
+     * Write a temporary file and rename it so that a reader never sees a partial snapshot
+     */
+    std::string tempPath = filePath + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "w");
+    if (!file) {
+        QCC_LogError(ER_OS_ERROR, ("%s: Unable to open %s", __func__, tempPath.c_str()));
+        return ER_OS_ERROR;
+    }
+
+    bool written = (fwrite(text.c_str(), 1, text.size(), file) == text.size());
+    written = (fclose(file) == 0) && written;
+    if (!written || (rename(tempPath.c_str(), filePath.c_str()) != 0)) {
+        QCC_LogError(ER_OS_ERROR, ("%s: Unable to write %s", __func__, filePath.c_str()));
+        remove(tempPath.c_str());
+        return ER_OS_ERROR;
+    }
+
+    return ER_OK;
+}
+
+void DiagnosticsDumper::Stop(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    lock.Lock();
+    interval = 0;
+    path.clear();
+    lock.Unlock();
+    alarm.Stop();
+}
+
+void DiagnosticsDumper::Join(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    alarm.Join();
+}
@@ -0,0 +1,783 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <ElectionStateMachine.h>
+#include <OEM_CS_Config.h>
+#include <qcc/Debug.h>
+
+#include <algorithm>
+
+#define QCC_MODULE "LEADER_ELECTION"
+
+using namespace lsf;
+
+ElectionStateMachine::ElectionStateMachine(Bus& bus, Clock& clock)
+    : bus(bus),
+    clock(clock),
+    electionMutex("ElectionStateMachine.electionMutex"),
+    myRank(),
+    leaderSession(0),
+    leaderMonitor(OEM_CS_LEADER_HEARTBEAT_INTERVAL_MS, OEM_CS_LEADER_HEARTBEAT_MISSED_THRESHOLD, OEM_CS_LEADER_FAILURE_PHI_THRESHOLD),
+    leaderLostTimestamp(0),
+    takeoverDeadline(0),
+    alarmTriggered(false),
+    isLeader(false),
+    startElection(true),
+    okToSetAlarm(true),
+    gotOverthrowReply(false)
+{
+    QCC_DbgTrace(("%s", __func__));
+}
+
+void ElectionStateMachine::SetRank(const Rank& rank)
+{
+    electionMutex.Lock();
+    myRank = rank;
+    electionMutex.Unlock();
+}
+
+Rank ElectionStateMachine::GetRank(void)
+{
+    electionMutex.Lock();
+    Rank rank = myRank;
+    electionMutex.Unlock();
+    return rank;
+}
+
+void ElectionStateMachine::OnAnnounced(const ControllerEntry& entry)
+{
+    QCC_DbgPrintf(("%s: (%u, %s, %s, %s)", __func__, entry.port, entry.busName.c_str(), (entry.isLeader ? "true" : "false"), entry.rank.c_str()));
+
+    electionMutex.Lock();
+    if (!entry.isLeader && !(entry.rank > myRank)) {
+        /*
+         * A lower ranked leader that stepped down is no longer tracked
+         */
+        ControllersMap::iterator it = controllersMap.find(entry.rank);
+        if ((it != controllersMap.end()) && (it->second.isLeader) && (it->second.rank != currentLeader.rank)) {
+            QCC_DbgPrintf(("%s: Removed leader with rank %s that stepped down", __func__, entry.rank.c_str()));
+            controllersMap.erase(it);
+            bus.Wake();
+        }
+        electionMutex.Unlock();
+        return;
+    }
+
+    ControllerEntry newEntry = entry;
+    newEntry.announcementTimestamp = clock.GetTimestampInMs();
+
+    Rank lastTrackedRank = myRank;
+    if (controllersMap.size()) {
+        lastTrackedRank = (controllersMap.rbegin())->first;
+        QCC_DbgPrintf(("%s: Last tracked rank set to %s", __func__, lastTrackedRank.c_str()));
+    }
+    controllersMap[newEntry.rank] = newEntry;
+
+    if (okToSetAlarm && (!newEntry.isLeader)) {
+        if ((newEntry.rank > lastTrackedRank) || (newEntry.rank == lastTrackedRank)) {
+            QCC_DbgPrintf(("%s: Reloading alarm", __func__));
+            bus.SetAlarmInMs(LEADER_ANNOUNCEMENT_WAIT_INTERVAL_IN_M_SEC);
+        }
+    } else {
+        bus.Wake();
+    }
+    electionMutex.Unlock();
+}
+
+void ElectionStateMachine::OnSessionJoined(QStatus status, uint32_t sessionId, const ControllerEntry& leader)
+{
+    QCC_DbgPrintf(("%s: (status=%s sessionId=%u rank=%s)", __func__, QCC_StatusText(status), sessionId, leader.rank.c_str()));
+
+    electionMutex.Lock();
+    if (status == ER_OK) {
+        successfulJoinSessions.insert(std::make_pair(leader.rank, std::make_pair(leader, sessionId)));
+    } else if (status == ER_ALLJOYN_JOINSESSION_REPLY_ALREADY_JOINED) {
+        sessionAlreadyJoinedReplies.push_back(leader);
+    } else {
+        failedJoinSessions.push_back(leader);
+    }
+    bus.Wake();
+    electionMutex.Unlock();
+}
+
+void ElectionStateMachine::OnSessionLost(uint32_t sessionId)
+{
+    QCC_DbgTrace(("%s: (%u)", __func__, sessionId));
+    electionMutex.Lock();
+    sessionLostList.push_back(sessionId);
+    bus.Wake();
+    electionMutex.Unlock();
+}
+
+void ElectionStateMachine::OnSessionMemberRemoved(uint32_t sessionId, const char* uniqueName)
+{
+    QCC_DbgTrace(("%s: (%u, %s)", __func__, sessionId, uniqueName));
+    electionMutex.Lock();
+    sessionMemberRemoved.insert(std::make_pair(sessionId, qcc::String(uniqueName)));
+    bus.Wake();
+    electionMutex.Unlock();
+}
+
+void ElectionStateMachine::OnOverthrow(const char* sender, uint32_t callId)
+{
+    QCC_DbgTrace(("%s: (%s)", __func__, sender));
+    electionMutex.Lock();
+    ExtendOverthrowAlarm(sender);
+    overThrowList.push_back(std::make_pair(qcc::String(sender), callId));
+    bus.Wake();
+    electionMutex.Unlock();
+}
+
+void ElectionStateMachine::OnOverthrowReply(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    electionMutex.Lock();
+    gotOverthrowReply = true;
+    bus.Wake();
+    electionMutex.Unlock();
+}
+
+void ElectionStateMachine::ExtendOverthrowAlarm(const char* sender)
+{
+    electionMutex.Lock();
+    if (upComingLeader.busName == sender) {
+        QCC_DbgPrintf(("%s: Extended overthrow alarm", __func__));
+        bus.SetAlarmInMs(OVERTHROW_TIMEOUT_IN_M_SEC);
+    }
+    electionMutex.Unlock();
+}
+
+void ElectionStateMachine::AlarmTriggered(void)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    electionMutex.Lock();
+    alarmTriggered = true;
+    bus.Wake();
+    electionMutex.Unlock();
+}
+
+void ElectionStateMachine::OnHeartbeatTimer(void)
+{
+    electionMutex.Lock();
+    if (isLeader) {
+        electionMutex.Unlock();
+        bus.SendHeartbeat();
+        return;
+    }
+
+    uint64_t now = clock.GetTimestampInMs();
+    if (leaderSession && leaderMonitor.IsSuspected(now)) {
+        QCC_LogError(ER_TIMEOUT, ("%s: No heartbeat from leader %s for %llu ms", __func__,
+                                  currentLeader.busName.c_str(), leaderMonitor.GetElapsed(now)));
+        uint32_t sessionId = leaderSession;
+        leaderMonitor.Reset();
+
+        /*
+         * Do not wait for the link timeout of the routing node: tear down the
+         * session and handle it as lost so that the election starts right away
+         */
+        bus.LeaveSessionAsync(sessionId);
+        sessionLostList.push_back(sessionId);
+        bus.Wake();
+    }
+    electionMutex.Unlock();
+}
+
+bool ElectionStateMachine::OnHeartbeat(uint32_t sessionId, const char* sender)
+{
+    electionMutex.Lock();
+    bool fromLeader = leaderSession && (sessionId == leaderSession) && (currentLeader.busName == sender);
+    if (fromLeader) {
+        leaderMonitor.Heartbeat(clock.GetTimestampInMs());
+    }
+    electionMutex.Unlock();
+    return fromLeader;
+}
+
+bool ElectionStateMachine::IsLeader(void)
+{
+    electionMutex.Lock();
+    bool leader = isLeader;
+    electionMutex.Unlock();
+    return leader;
+}
+
+bool ElectionStateMachine::IsElectionPending(void)
+{
+    electionMutex.Lock();
+    bool pending = startElection;
+    electionMutex.Unlock();
+    return pending;
+}
+
+bool ElectionStateMachine::IsOverthrowing(void)
+{
+    electionMutex.Lock();
+    bool overthrowing = !outGoingLeader.busName.empty();
+    electionMutex.Unlock();
+    return overthrowing;
+}
+
+void ElectionStateMachine::GetCurrentLeader(ControllerEntry& leader, uint32_t& sessionId)
+{
+    electionMutex.Lock();
+    leader = currentLeader;
+    sessionId = leaderSession;
+    electionMutex.Unlock();
+}
+
+uint32_t ElectionStateMachine::GetNumControllers(void)
+{
+    electionMutex.Lock();
+    uint32_t numControllers = controllersMap.size();
+    electionMutex.Unlock();
+    return numControllers;
+}
+
+void ElectionStateMachine::BecomeLeader(void)
+{
+    QCC_DbgPrintf(("%s: Announcing self as leader", __func__));
+    bus.ConnectToLamps();
+    bus.SetAllowUpdates(true);
+    bus.SetIsLeader(true);
+    isLeader = true;
+    okToSetAlarm = false;
+    takeoverDeadline = 0;
+    bus.SetAlarmInMs(0);
+}
+
+void ElectionStateMachine::StepDown(void)
+{
+    bus.LeaveSession();
+    bus.DisconnectFromLamps();
+    bus.SetAllowUpdates(false);
+    bus.SetIsLeader(false);
+    isLeader = false;
+    upComingLeader.Clear();
+    bus.SetAlarmInMs(0);
+}
+
+void ElectionStateMachine::ClearCurrentLeader(void)
+{
+    currentLeader.Clear();
+    if (leaderSession) {
+        leaderSession = 0;
+        bus.OnLeaderSessionCleared();
+    }
+}
+
+void ElectionStateMachine::EraseLeaderEntry(ControllerEntry& entry)
+{
+    ControllersMap::iterator it = controllersMap.find(entry.rank);
+    if ((it != controllersMap.end()) && (it->second.isLeader) && (it->second.announcementTimestamp == entry.announcementTimestamp)) {
+        QCC_DbgPrintf(("%s: Removed leader with rank %s from controllersMap", __func__, entry.rank.c_str()));
+        controllersMap.erase(it);
+    }
+}
+
+void ElectionStateMachine::CompleteOverthrow(void)
+{
+    uint32_t sessionId = leaderSession;
+    ClearCurrentLeader();
+    if (sessionId) {
+        QCC_DbgPrintf(("%s: Tearing down session with current leader", __func__));
+        bus.LeaveSessionAsync(sessionId);
+    }
+
+    EraseLeaderEntry(outGoingLeader);
+    outGoingLeader.Clear();
+    BecomeLeader();
+}
+
+void ElectionStateMachine::UpdateHotStandby(void)
+{
+    bool standby = false;
+
+#if OEM_CS_LAMP_HOT_STANDBY
+    /*
+     * controllersMap only tracks the leaders and the Controller Services that rank
+     * higher than us, so we are the highest-ranked follower if it only has our leader
+     */
+    standby = currentLeader.rank.IsInitialized() && (controllersMap.size() == 1) && (controllersMap.begin()->first == currentLeader.rank);
+#endif
+
+    bus.UpdateHotStandby(standby);
+}
+
+void ElectionStateMachine::StartTakeoverWait(void)
+{
+    uint32_t candidates = 0;
+    for (ControllersMap::iterator it = controllersMap.begin(); it != controllersMap.end(); it++) {
+        if (!it->second.isLeader) {
+            candidates++;
+        }
+    }
+
+    leaderLostTimestamp = clock.GetTimestampInMs();
+    takeoverDeadline = 0;
+
+    if (candidates) {
+        uint32_t wait = candidates * OEM_CS_LEADER_TAKEOVER_WAIT_MS;
+        QCC_DbgPrintf(("%s: Waiting %u ms for one of %u Controller Services to take over", __func__, wait, candidates));
+        takeoverDeadline = leaderLostTimestamp + wait;
+        bus.SetAlarmInMs(wait);
+    }
+}
+
+uint32_t ElectionStateMachine::GetTakeoverWaitLeft(void)
+{
+    if (!takeoverDeadline) {
+        return 0;
+    }
+
+    uint64_t now = clock.GetTimestampInMs();
+    return (takeoverDeadline > now) ? static_cast<uint32_t>(takeoverDeadline - now) : 1;
+}
+
+void ElectionStateMachine::ExpireControllers(void)
+{
+    if (!takeoverDeadline || (clock.GetTimestampInMs() < takeoverDeadline)) {
+        return;
+    }
+    takeoverDeadline = 0;
+
+    bool haveLeader = currentLeader.rank.IsInitialized();
+    ControllersMap::iterator it = controllersMap.begin();
+    while (it != controllersMap.end()) {
+        if (!it->second.isLeader && (it->second.announcementTimestamp < leaderLostTimestamp) && (!haveLeader || (it->first > currentLeader.rank))) {
+            QCC_DbgPrintf(("%s: Removed Controller Service with rank %s that did not take over", __func__, it->first.c_str()));
+            controllersMap.erase(it++);
+        } else {
+            it++;
+        }
+    }
+}
+
+void ElectionStateMachine::Shutdown(void)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    electionMutex.Lock();
+
+    /*
+     * Announce self as non-leader before going away
+     */
+    if (isLeader) {
+        bus.LeaveSession();
+        bus.DisconnectFromLamps();
+        bus.SetAllowUpdates(false);
+        bus.SetIsLeader(false);
+        isLeader = false;
+    } else {
+        uint32_t sessionId = leaderSession;
+        ClearCurrentLeader();
+        if (sessionId) {
+            QCC_DbgPrintf(("%s: Tearing down session with current leader", __func__));
+            bus.LeaveSessionAsync(sessionId);
+        }
+        bus.UpdateHotStandby(false);
+    }
+
+    /* Clean up all the stale data */
+    overThrowList.clear();
+    upComingLeader.Clear();
+    bus.SetAlarmInMs(0);
+    controllersMap.clear();
+
+    alarmTriggered = false;
+    gotOverthrowReply = false;
+    okToSetAlarm = true;
+    startElection = true;
+    leaderLostTimestamp = 0;
+    takeoverDeadline = 0;
+
+    ClearCurrentLeader();
+    outGoingLeader.Clear();
+    failedJoinSessions.clear();
+    sessionAlreadyJoinedReplies.clear();
+    successfulJoinSessions.clear();
+    sessionLostList.clear();
+    sessionMemberRemoved.clear();
+
+    electionMutex.Unlock();
+}
+
+void ElectionStateMachine::Run(void)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    electionMutex.Lock();
+
+    bool loopBack = true;
+
+    while (loopBack) {
+        loopBack = false;
+        ExpireControllers();
+        if (isLeader) {
+            QCC_DbgPrintf(("%s: I am the leader", __func__));
+            RunAsLeader(loopBack);
+        } else if (gotOverthrowReply && outGoingLeader.rank.IsInitialized()) {
+            QCC_DbgPrintf(("%s: gotOverthrowReply", __func__));
+            gotOverthrowReply = false;
+            /*
+             * Coup was successful. Take over as leader
+             */
+            CompleteOverthrow();
+            /*
+             * Loopback in case a leader with a higher rank showed up during the coup
+             */
+            loopBack = true;
+        } else if (startElection) {
+            QCC_DbgPrintf(("%s: startElection", __func__));
+            startElection = false;
+            QCC_DbgPrintf(("%s: Announcing self as non-leader", __func__));
+            bus.SetAllowUpdates(false);
+            bus.DisconnectFromLamps();
+            bus.SetIsLeader(false);
+            bus.SetAlarmInMs(ELECTION_INTERVAL_IN_M_SEC);
+        } else if (!currentLeader.rank.IsInitialized()) {
+            QCC_DbgPrintf(("%s: lookingForALeader", __func__));
+            LookForALeader();
+        } else if (!leaderSession) {
+            QCC_DbgPrintf(("%s: connectingToLeader", __func__));
+            ConnectToLeader(loopBack);
+        } else {
+            QCC_DbgPrintf(("%s: connectedToLeader", __func__));
+            CheckLeader(loopBack);
+        }
+    }
+
+    electionMutex.Unlock();
+}
+
+void ElectionStateMachine::RunAsLeader(bool& loopBack)
+{
+    bool overThrown = false;
+    bool leaderFound = false;
+
+    OverThrowList overThrowListCopy;
+    overThrowListCopy.swap(overThrowList);
+    ControllerEntry upcomingLeaderCopy = upComingLeader;
+
+    while (overThrowListCopy.size()) {
+        bool accepted = false;
+        if (overThrowListCopy.front().first == upcomingLeaderCopy.busName) {
+            accepted = true;
+            overThrown = true;
+            QCC_DbgPrintf(("%s: Announcing self as non-leader after a successful overthrow", __func__));
+            StepDown();
+            /*
+             * Give the new leader time to announce itself before we look for one
+             */
+            StartTakeoverWait();
+            /*
+             * Loopback so that we now become a follower to the new leader
+             */
+            loopBack = true;
+        }
+        bus.SendOverthrowReply(overThrowListCopy.front().second, accepted);
+        overThrowListCopy.pop_front();
+    }
+
+    if (overThrown) {
+        return;
+    }
+
+    /*
+     * Check to see if we found another leader announcement
+     */
+    ControllerEntry controllerDetails;
+    for (ControllersMap::reverse_iterator rit = controllersMap.rbegin(); rit != controllersMap.rend(); rit++) {
+        if (rit->second.isLeader) {
+            leaderFound = true;
+            controllerDetails = rit->second;
+            break;
+        }
+    }
+
+    if (leaderFound && (myRank < controllerDetails.rank)) {
+        /*
+         * We are being overthrown but we did not know about it as the new leader was probably not
+         * successful in connecting to us. Tear down our session and announce as a non-leader
+         */
+        QCC_DbgPrintf(("%s: Announcing self as non-leader because I saw another leader announcement", __func__));
+        StepDown();
+        /*
+         * Loopback so that we now become a follower to the new leader
+         */
+        loopBack = true;
+    } else {
+        /*
+         * Check if some one is in the process of performing a coup on us
+         */
+        for (ControllersMap::reverse_iterator rit = controllersMap.rbegin(); rit != controllersMap.rend(); rit++) {
+            if ((rit->second.rank > myRank) && (upComingLeader.busName != rit->second.busName)) {
+                upComingLeader = rit->second;
+                bus.SetAllowUpdates(false);
+                /*
+                 * Set an alarm to take necessary action if the coup does not go through
+                 */
+                QCC_DbgPrintf(("%s: Identified upcoming leader %s", __func__, upComingLeader.busName.c_str()));
+                bus.SetAlarmInMs(OVERTHROW_TIMEOUT_IN_M_SEC);
+                break;
+            }
+        }
+    }
+
+    if (alarmTriggered) {
+        alarmTriggered = false;
+        if (!leaderFound) {
+            QCC_DbgPrintf(("%s: Upcoming leader %s failed to take over", __func__, upComingLeader.busName.c_str()));
+            ControllersMap::iterator it = controllersMap.find(upComingLeader.rank);
+            if (it != controllersMap.end()) {
+                if (it->second.isLeader) {
+                    /*
+                     * The leader announcement came through just as we were going to timeout.
+                     * So loopback
+                     */
+                    loopBack = true;
+                } else {
+                    if (upComingLeader.announcementTimestamp == it->second.announcementTimestamp) {
+                        controllersMap.erase(it);
+                    }
+                    upComingLeader.Clear();
+                    bus.SetAllowUpdates(true);
+                }
+            }
+        }
+    }
+}
+
+void ElectionStateMachine::LookForALeader(void)
+{
+    /*
+     * Check to see if we found a leader
+     */
+    ControllerEntry controllerDetails;
+    bool leaderFound = false;
+    for (ControllersMap::reverse_iterator rit = controllersMap.rbegin(); rit != controllersMap.rend(); rit++) {
+        if (rit->second.isLeader) {
+            leaderFound = true;
+            controllerDetails = rit->second;
+            break;
+        }
+    }
+
+    if (leaderFound) {
+        QCC_DbgPrintf(("%s: Found an entry with rank=%s and leader bit set", __func__, controllerDetails.rank.c_str()));
+        /*
+         * Check if we need to perform a coup. A coup on a previous leader
+         * is dropped, or we would take over from a higher ranked leader
+         */
+        if (myRank > controllerDetails.rank) {
+            outGoingLeader = controllerDetails;
+        } else {
+            outGoingLeader.Clear();
+        }
+        /*
+         * We found a leader. Try to join its session and turn off the alarm
+         * if the join could be started
+         */
+        okToSetAlarm = false;
+        ClearCurrentLeader();
+        currentLeader = controllerDetails;
+
+        if (!bus.JoinSession(controllerDetails)) {
+            QCC_LogError(ER_FAIL, ("%s: JoinSession failed", __func__));
+            ControllersMap::iterator fit = controllersMap.find(controllerDetails.rank);
+            if ((fit != controllersMap.end()) && (controllerDetails.announcementTimestamp == fit->second.announcementTimestamp)) {
+                controllersMap.erase(fit);
+            }
+            ClearCurrentLeader();
+        } else {
+            QCC_DbgPrintf(("%s: JoinSession started", __func__));
+            /*
+             * Keep the alarm that ends the takeover wait, if any
+             */
+            bus.SetAlarmInMs(GetTakeoverWaitLeft());
+        }
+    } else if (controllersMap.empty() || (!takeoverDeadline && (controllersMap.size() == 1) && (!((controllersMap.begin())->second.isLeader)))) {
+        /*
+         * If controllersMap is empty, we are the highest ranking Controller Service or
+         * if controllersMap has only one entry which does not have the leader bit set,
+         * we need to take over as the leader. After losing a leader, that entry is
+         * given the takeover wait first
+         */
+        controllersMap.clear();
+        alarmTriggered = false;
+        BecomeLeader();
+    }
+}
+
+void ElectionStateMachine::ConnectToLeader(bool& loopBack)
+{
+    /*
+     * Go through all the JoinSession replies
+     */
+    FailedJoinSessionReplies failedJoinSessionsCopy;
+    failedJoinSessionsCopy.swap(failedJoinSessions);
+
+    FailedJoinSessionReplies sessionAlreadyJoinedRepliesCopy;
+    sessionAlreadyJoinedRepliesCopy.swap(sessionAlreadyJoinedReplies);
+
+    SuccessfulJoinSessionReplies successfulJoinSessionsCopy;
+    successfulJoinSessionsCopy.swap(successfulJoinSessions);
+
+    ControllerEntry failedConnectToLeader;
+    for (FailedJoinSessionReplies::iterator it = failedJoinSessionsCopy.begin(); it != failedJoinSessionsCopy.end(); it++) {
+        if ((it->rank == currentLeader.rank) && (it->announcementTimestamp == currentLeader.announcementTimestamp)) {
+            QCC_DbgPrintf(("%s: JoinSession failed with current leader", __func__));
+            failedConnectToLeader = currentLeader;
+            ClearCurrentLeader();
+            break;
+        }
+    }
+
+    if (failedConnectToLeader.rank.IsInitialized()) {
+        if (!outGoingLeader.busName.empty()) {
+            /*
+             * We are performing a coup but could not successfully talk to the
+             * outgoing leader. So forcefully take over as the leader now
+             */
+            EraseLeaderEntry(outGoingLeader);
+            outGoingLeader.Clear();
+            BecomeLeader();
+        }
+
+        /*
+         * We should delete the entry from controllersMap only if the leader bit is
+         * set. Otherwise it means that someone took over from this leader when
+         * we were trying to JoinSession
+         */
+        EraseLeaderEntry(failedConnectToLeader);
+
+        /*
+         * Loop back to see if we have any other leader in the controllersMap
+         */
+        loopBack = true;
+        return;
+    }
+
+    if (!sessionAlreadyJoinedRepliesCopy.empty()) {
+        /*
+         * Loop back to re-attempt a connect to the leader that returned session_already_joined error
+         */
+        loopBack = true;
+        return;
+    }
+
+    for (SuccessfulJoinSessionReplies::iterator it = successfulJoinSessionsCopy.begin(); it != successfulJoinSessionsCopy.end(); it++) {
+        if ((it->first == currentLeader.rank) && (it->second.first.announcementTimestamp == currentLeader.announcementTimestamp)) {
+            QCC_DbgPrintf(("%s: JoinSession successful with current leader", __func__));
+            leaderSession = it->second.second;
+            leaderMonitor.Reset();
+            successfulJoinSessionsCopy.erase(it);
+
+            bool overthrow = !outGoingLeader.busName.empty();
+            if (!bus.OnLeaderSessionJoined(currentLeader, leaderSession, overthrow) && overthrow) {
+                /*
+                 * Could not get the current state from the outgoing leader. Forcefully
+                 * take over as leader after tearing down the session with it
+                 */
+                CompleteOverthrow();
+            }
+            break;
+        }
+    }
+
+    /*
+     * Cleaning up the remaining stray sessions
+     */
+    for (SuccessfulJoinSessionReplies::iterator it = successfulJoinSessionsCopy.begin(); it != successfulJoinSessionsCopy.end(); it++) {
+        QCC_DbgPrintf(("%s: Leaving stray session %u", __func__, it->second.second));
+        bus.LeaveSessionAsync(it->second.second);
+    }
+
+    UpdateHotStandby();
+}
+
+void ElectionStateMachine::CheckLeader(bool& loopBack)
+{
+    /*
+     * Check if we have lost our session with the leader or if the leader has left the session
+     */
+    SessionLostList sessionLostListCopy;
+    sessionLostListCopy.swap(sessionLostList);
+
+    SessionMemberRemovedMap sessionMemberRemovedCopy;
+    sessionMemberRemovedCopy.swap(sessionMemberRemoved);
+
+    bool lostSessionWithLeader = false;
+
+    if (std::find(sessionLostListCopy.begin(), sessionLostListCopy.end(), leaderSession) != sessionLostListCopy.end()) {
+        QCC_DbgPrintf(("%s: Lost Session with the current leader", __func__));
+        lostSessionWithLeader = true;
+    } else {
+        SessionMemberRemovedMap::iterator it = sessionMemberRemovedCopy.find(leaderSession);
+        if ((it != sessionMemberRemovedCopy.end()) && (it->second == currentLeader.busName)) {
+            QCC_DbgPrintf(("%s: Current Leader left the session", __func__));
+            bus.LeaveSessionAsync(leaderSession);
+            lostSessionWithLeader = true;
+        }
+    }
+
+    if (lostSessionWithLeader) {
+        QCC_DbgPrintf(("%s: Cleared current leader with rank %s", __func__, currentLeader.rank.c_str()));
+        ControllerEntry failedConnectToLeader = currentLeader;
+        ClearCurrentLeader();
+        /*
+         * We should delete the entry from controllersMap only if the leader bit is
+         * set and announcement timestamp is the same.
+         */
+        EraseLeaderEntry(failedConnectToLeader);
+        StartTakeoverWait();
+
+        /*
+         * Loop Back to find and connect to a new leader who may have come up or
+         * take over as the leader
+         */
+        loopBack = true;
+        return;
+    }
+
+    /*
+     * Check if a new leader with rank higher that whom we think is the leader has come up. If so,
+     * leave our current session and join the new leader
+     */
+    ControllerEntry entry;
+    ControllersMap::iterator it = controllersMap.find(currentLeader.rank);
+    if (it != controllersMap.end()) {
+        for (ControllersMap::reverse_iterator rit = controllersMap.rbegin(); rit != controllersMap.rend(); rit++) {
+            if ((rit->second.rank > currentLeader.rank) && (rit->second.isLeader)) {
+                QCC_DbgPrintf(("%s: Found a leader that has higher rank than current leader", __func__));
+                entry = rit->second;
+                break;
+            }
+        }
+    }
+
+    if (entry.rank.IsInitialized()) {
+        if ((it->second.isLeader) && (it->second.announcementTimestamp == currentLeader.announcementTimestamp)) {
+            QCC_DbgPrintf(("%s: Removing current leader %s entry from controllersMap", __func__, currentLeader.rank.c_str()));
+            controllersMap.erase(it);
+        }
+
+        uint32_t sessionId = leaderSession;
+        ClearCurrentLeader();
+        bus.LeaveSessionAsync(sessionId);
+        loopBack = true;
+    } else {
+        UpdateHotStandby();
+    }
+}
@@ -0,0 +1,93 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <FailureDetector.h>
+
+#include <math.h>
+
+using namespace lsf;
+
+const uint32_t FailureDetector::SAMPLE_WINDOW;
+
+FailureDetector::FailureDetector(uint32_t intervalMs, uint32_t missedThreshold, double phiThreshold)
+    : intervalMs(intervalMs ? intervalMs : 1),
+    missedThreshold(missedThreshold ? missedThreshold : 1),
+    phiThreshold(phiThreshold)
+{
+    Reset();
+}
+
+void FailureDetector::Reset(void)
+{
+    lastHeartbeat = 0;
+    numSamples = 0;
+    nextSample = 0;
+    samplesSum = 0;
+}
+
+void FailureDetector::Heartbeat(uint64_t now)
+{
+    if (lastHeartbeat && (now >= lastHeartbeat)) {
+        uint64_t sample = now - lastHeartbeat;
+        if (numSamples == SAMPLE_WINDOW) {
+            samplesSum -= samples[nextSample];
+        } else {
+            numSamples++;
+        }
+        samples[nextSample] = sample;
+        samplesSum += sample;
+        nextSample = (nextSample + 1) % SAMPLE_WINDOW;
+    }
+    lastHeartbeat = now;
+}
+
+uint64_t FailureDetector::GetElapsed(uint64_t now) const
+{
+    if (!lastHeartbeat || (now < lastHeartbeat)) {
+        return 0;
+    }
+    return now - lastHeartbeat;
+}
+
+double FailureDetector::GetPhi(uint64_t now) const
+{
+    /*
+     * Until enough samples come in, the mean is the configured interval
+     */
+    double mean = (numSamples) ? (static_cast<double>(samplesSum) / numSamples) : intervalMs;
+    if (mean < 1) {
+        mean = 1;
+    }
+    /*
+     * With exponentially distributed intervals, the probability that the next
+     * heartbeat comes later than elapsed is e^(-elapsed / mean), and
+     * phi = -log10 of that probability
+     */
+    return (static_cast<double>(GetElapsed(now)) / mean) * M_LOG10E;
+}
+
+bool FailureDetector::IsSuspected(uint64_t now) const
+{
+    if (!IsArmed()) {
+        return false;
+    }
+
+    if (phiThreshold > 0) {
+        return (GetPhi(now) > phiThreshold);
+    }
+
+    return (GetElapsed(now) > (static_cast<uint64_t>(intervalMs) * missedThreshold));
+}
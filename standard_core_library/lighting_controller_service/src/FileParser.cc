@@ -48,17 +48,14 @@ std::string ParseString(std::istream& stream)
     std::string name;
     stream >> name;
 
-    if (name[0] == '"') {
-        name = name.substr(1, std::string::npos);
-
-        while (name[name.length() - 1] != '"') {
-            std::string s;
-            stream >> s;
-            name += ' ' + s;
-        }
-
-        if (name[name.length() - 1] == '"') {
-            name = name.substr(0, name.length() - 1);
+    if (!name.empty() && (name[0] == '"')) {
+        if ((name.length() > 1) && (name[name.length() - 1] == '"')) {
+            name = name.substr(1, name.length() - 2);
+        } else {
+            // read the rest of the quoted string up to the closing quote in one pass
+            std::string rest;
+            std::getline(stream, rest, '"');
+            name = name.substr(1, std::string::npos) + rest;
         }
     }
 
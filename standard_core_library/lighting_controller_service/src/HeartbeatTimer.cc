@@ -0,0 +1,101 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+
+#include <qcc/Debug.h>
+#include <HeartbeatTimer.h>
+#include <LeaderElectionObject.h>
+#include <LSFTypes.h>
+
+using namespace lsf;
+
+#define QCC_MODULE "HEARTBEAT_TIMER"
+
+#define HEARTBEAT_EVENT_TICK 0x1
+
+HeartbeatTimer::HeartbeatTimer(LeaderElectionObject& elector, uint32_t intervalMs, Reactor& reactor)
+    : elector(elector),
+    intervalMs(intervalMs ? intervalMs : 1),
+    reactor(reactor),
+    timer(reactor, this, HEARTBEAT_EVENT_TICK),
+    running(false),
+    runningLock("HeartbeatTimer.runningLock"),
+    nextTick(0)
+{
+    QCC_DbgTrace(("%s", __func__));
+}
+
+HeartbeatTimer::~HeartbeatTimer()
+{
+    QCC_DbgTrace(("%s", __func__));
+    Stop();
+    Join();
+}
+
+QStatus HeartbeatTimer::Start(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    runningLock.Lock();
+    running = true;
+    nextTick = GetTimestampInMs() + intervalMs;
+    timer.SetInMs(intervalMs);
+    runningLock.Unlock();
+    return ER_OK;
+}
+
+void HeartbeatTimer::Stop(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    runningLock.Lock();
+    running = false;
+    timer.SetInMs(0);
+    runningLock.Unlock();
+    reactor.Cancel(this);
+}
+
+void HeartbeatTimer::Join(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    reactor.WaitIdle(this);
+}
+
+void HeartbeatTimer::HandleEvents(uint32_t events)
+{
+    runningLock.Lock();
+    bool tick = running;
+    runningLock.Unlock();
+
+    if (!tick) {
+        return;
+    }
+
+    elector.OnHeartbeatTimer();
+
+    runningLock.Lock();
+    if (running) {
+        /*
+         * Keep the ticks on a fixed schedule, but do not try to catch up
+         * on ticks missed while the process was not scheduled
+         */
+        uint64_t now = GetTimestampInMs();
+        nextTick += intervalMs;
+        if (nextTick <= now) {
+            nextTick = now + intervalMs;
+        }
+        timer.SetInMs(static_cast<uint32_t>(nextTick - now));
+    }
+    runningLock.Unlock();
+}
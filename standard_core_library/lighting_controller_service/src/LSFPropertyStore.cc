@@ -29,6 +29,11 @@
 
 #define QCC_MODULE "LSF_PROPSTORE"
 
+/*
+ * Posted when asyncTasks is set
+ */
+#define PROPERTY_STORE_EVENT_TASK 0x1
+
 using namespace ajn;
 using namespace services;
 using namespace lsf;
@@ -44,6 +49,7 @@ LSFPropertyStore::LSFPropertyStore(const std::string& factoryConfigFile, const s
     : isInitialized(false),
     configFileName(configFile),
     factoryConfigFileName(factoryConfigFile),
+    reactor(Reactor::GetShared()),
     asyncTasks(doNothing),
     running(true),
     usingThread(true)
@@ -51,14 +57,13 @@ LSFPropertyStore::LSFPropertyStore(const std::string& factoryConfigFile, const s
     QCC_DbgTrace(("%s", __func__));
 
     setProperty(AJ_SOFTWARE_VERSION, ajn::GetVersion(), true, false, false);
-
-    Start();
 }
 
 LSFPropertyStore::LSFPropertyStore()
     : isInitialized(true),
     configFileName(),
     factoryConfigFileName(),
+    reactor(Reactor::GetShared()),
     asyncTasks(doNothing),
     running(false),
     usingThread(false)
@@ -69,6 +74,8 @@ LSFPropertyStore::LSFPropertyStore()
 LSFPropertyStore::~LSFPropertyStore()
 {
     QCC_DbgTrace(("%s", __func__));
+    reactor.Cancel(this);
+    reactor.WaitIdle(this);
 }
 
 void LSFPropertyStore::Initialize()
@@ -105,7 +112,7 @@ void LSFPropertyStore::ReadFactoryConfiguration()
             propsLock.Lock();
             asyncTasks = writetoOEMConfig;
             propsLock.Unlock();
-            propsCond.Signal();
+            reactor.Post(this, PROPERTY_STORE_EVENT_TASK);
             return;
         }
     }
@@ -213,7 +220,7 @@ QStatus LSFPropertyStore::Reset()
     propsLock.Lock();
     asyncTasks = removeConfigFile;
     propsLock.Unlock();
-    propsCond.Signal();
+    reactor.Post(this, PROPERTY_STORE_EVENT_TASK);
     return ER_OK;
 }
 
@@ -425,7 +432,7 @@ QStatus LSFPropertyStore::Update(const char* name, const char* languageTag, cons
         if (usingThread) {
             asyncTasks = writetoConfig;
             propsLock.Unlock();
-            propsCond.Signal();
+            reactor.Post(this, PROPERTY_STORE_EVENT_TASK);
         } else {
             propsLock.Unlock();
             AboutService* aboutService = AboutServiceApi::getInstance();
@@ -524,7 +531,7 @@ QStatus LSFPropertyStore::Delete(const char* name, const char* languageTag)
         if (usingThread) {
             asyncTasks = writetoConfig;
             propsLock.Unlock();
-            propsCond.Signal();
+            reactor.Post(this, PROPERTY_STORE_EVENT_TASK);
         } else {
             propsLock.Unlock();
             AboutService* aboutService = AboutServiceApi::getInstance();
@@ -610,51 +617,45 @@ QStatus LSFPropertyStore::FillStringMapWithProperties(StringMap& fileOutput, Pro
     return ER_OK;
 }
 
-void LSFPropertyStore::Run()
+void LSFPropertyStore::HandleEvents(uint32_t events)
 {
     QCC_DbgTrace(("%s", __func__));
-    while (running) {
-        propsLock.Lock();
-        while (asyncTasks == doNothing && running) {
-            propsCond.Wait(propsLock);
-        }
-
-        if (!running) {
-            propsLock.Unlock();
-            break;
-        }
-
-        // make a copy to minimize the critical section
-        PropertyMap toWrite = properties;
-        AsyncTasks localAsyncTasks = asyncTasks;
-        asyncTasks = doNothing;
+    propsLock.Lock();
+    if (!running || (asyncTasks == doNothing)) {
         propsLock.Unlock();
+        return;
+    }
 
-        if (localAsyncTasks == removeConfigFile) {
-            if (remove(configFileName.c_str()) != 0) {
-                QCC_DbgHLPrintf(("ERROR - Error deleting config file !!!"));
-            } else {
-                QCC_DbgPrintf(("Config file deleted !!!"));
-            }
-            continue;
+    // make a copy to minimize the critical section
+    PropertyMap toWrite = properties;
+    AsyncTasks localAsyncTasks = asyncTasks;
+    asyncTasks = doNothing;
+    propsLock.Unlock();
+
+    if (localAsyncTasks == removeConfigFile) {
+        if (remove(configFileName.c_str()) != 0) {
+            QCC_DbgHLPrintf(("ERROR - Error deleting config file !!!"));
+        } else {
+            QCC_DbgPrintf(("Config file deleted !!!"));
         }
+        return;
+    }
 
-        StringMap fileOutput;
-        FillStringMapWithProperties(fileOutput, toWrite, localAsyncTasks == writetoConfig);
+    StringMap fileOutput;
+    FillStringMapWithProperties(fileOutput, toWrite, localAsyncTasks == writetoConfig);
 
-        // these are the new Properties if and only if the data
-        // was successfully written to the user config file.
-        if (localAsyncTasks == writetoConfig) {
-            if (PropertyParser::WriteFile(configFileName, fileOutput)) {
-                // send the announcement!
-                AboutService* aboutService = AboutServiceApi::getInstance();
-                if (aboutService) {
-                    aboutService->Announce();
-                }
+    // these are the new Properties if and only if the data
+    // was successfully written to the user config file.
+    if (localAsyncTasks == writetoConfig) {
+        if (PropertyParser::WriteFile(configFileName, fileOutput)) {
+            // send the announcement!
+            AboutService* aboutService = AboutServiceApi::getInstance();
+            if (aboutService) {
+                aboutService->Announce();
             }
-        } else if (localAsyncTasks == writetoOEMConfig) {
-            PropertyParser::WriteFile(factoryConfigFileName, fileOutput);
         }
+    } else if (localAsyncTasks == writetoOEMConfig) {
+        PropertyParser::WriteFile(factoryConfigFileName, fileOutput);
     }
 }
 
@@ -662,13 +663,13 @@ void LSFPropertyStore::Stop()
 {
     QCC_DbgTrace(("%s", __func__));
     running = false;
-    propsCond.Signal();
+    reactor.Cancel(this);
 }
 
 void LSFPropertyStore::Join()
 {
     QCC_DbgTrace(("%s", __func__));
-    Thread::Join();
+    reactor.WaitIdle(this);
 }
 
 QStatus LSFPropertyStore::isLanguageSupported(const char* language)
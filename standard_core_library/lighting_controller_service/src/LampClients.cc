@@ -19,6 +19,7 @@
 #include <alljoyn/AllJoynStd.h>
 #include <qcc/Debug.h>
 #include <algorithm>
+#include <stdio.h>
 #include <ControllerService.h>
 #include <OEM_CS_Config.h>
 
@@ -122,13 +123,21 @@ void LampClients::GetAllLamps(LampNameMap& lamps)
 
 LampClients::LampClients(ControllerService& controllerSvc)
     : Manager(controllerSvc),
+    Thread("LampClients"),
+    responseLock("LampClients.responseLock"),
     serviceHandler(new ServiceHandler(*this)),
+    queueLock("LampClients.queueLock"),
     isRunning(false),
     lampStateChangedSignalHandlerRegistered(false),
+    lampStateCacheLock("LampClients.lampStateCacheLock"),
     connectToLamps(false),
+    standbyForLamps(false),
     disconnectFromLampsTimestamp(0),
     alarmTriggered(false),
-    retryAlarm(this)
+    retryAlarm(this),
+    connectedLampCount(0),
+    blacklistedLampCount(0),
+    retryingLampCount(0)
 {
     QCC_DbgTrace(("%s", __func__));
     keyListener.SetPassCode(INITIAL_PASSCODE);
@@ -139,6 +148,8 @@ LampClients::LampClients(ControllerService& controllerSvc)
     joinSessionCBList.clear();
     lostSessionList.clear();
     getAllLampIDsRequests.clear();
+    lampStatesRequests.clear();
+    lampStateCache.clear();
 }
 
 LampClients::~LampClients()
@@ -171,6 +182,12 @@ LampClients::~LampClients()
     lostSessionListLock.Lock();
     lostSessionList.clear();
     lostSessionListLock.Unlock();
+
+    lampStatesRequestsLock.Lock();
+    lampStatesRequests.clear();
+    lampStatesRequestsLock.Unlock();
+
+    ClearLampStateCache();
 }
 
 static const char* interfaces[] =
@@ -273,6 +290,7 @@ void LampClients::ConnectToLamps(void)
 {
     QCC_DbgTrace(("%s", __func__));
     connectToLamps = true;
+    standbyForLamps = false;
     wakeUp.Post();
 }
 
@@ -281,6 +299,15 @@ void LampClients::DisconnectFromLamps(void)
     QCC_DbgTrace(("%s", __func__));
     disconnectFromLampsTimestamp = GetTimestampInSeconds();
     connectToLamps = false;
+    standbyForLamps = false;
+    wakeUp.Post();
+}
+
+void LampClients::StandbyForLamps(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    standbyForLamps = true;
+    connectToLamps = false;
     wakeUp.Post();
 }
 
@@ -298,8 +325,8 @@ void LampClients::JoinSessionCB(QStatus status, SessionId sessionId, const Sessi
 
     QStatus tempStatus = ER_OK;
 
-    if (!connectToLamps) {
-        QCC_DbgPrintf(("%s: connectToLamps is false", __func__));
+    if (!MaintainsLampSessions()) {
+        QCC_DbgPrintf(("%s: Not maintaining lamp sessions", __func__));
         tempStatus = ER_FAIL;
     } else {
         if (status != ER_OK) {
@@ -351,8 +378,8 @@ void LampClients::SessionLost(SessionId sessionId, SessionLostReason reason)
 {
     QCC_DbgPrintf(("%s: sessionId=0x%x reason=0x%x\n", __func__, sessionId, reason));
 
-    if (!connectToLamps) {
-        QCC_DbgPrintf(("%s: connectToLamps is false", __func__));
+    if (!MaintainsLampSessions()) {
+        QCC_DbgPrintf(("%s: Not maintaining lamp sessions", __func__));
         return;
     }
 
@@ -374,27 +401,29 @@ void LampClients::SendMethodReply(LSFResponseCode responseCode, ajn::Message msg
     QCC_DbgPrintf(("%s\n", __func__));
     size_t numArgs = stdArgs.size() + custArgs.size() + 1;
     QCC_DbgPrintf(("%s: NumArgs = %d", __func__, numArgs));
-    MsgArg* args = new MsgArg[numArgs];
-    if (args) {
-        args[0] = MsgArg("u", responseCode);
-        args[0].SetOwnershipFlags(MsgArg::OwnsData | MsgArg::OwnsArgs, true);
-        uint8_t index = 1;
-        while (stdArgs.size()) {
-            args[index] = stdArgs.front();
-            args[index].SetOwnershipFlags(MsgArg::OwnsData | MsgArg::OwnsArgs, true);
-            stdArgs.pop_front();
-            index++;
-        }
-        while (custArgs.size()) {
-            args[index] = custArgs.front();
-            args[index].SetOwnershipFlags(MsgArg::OwnsData | MsgArg::OwnsArgs, true);
-            custArgs.pop_front();
-            index++;
-        }
-        controllerService.SendMethodReply(msg, args, numArgs);
+
+    /*
+     * Replies to the lamp methods have a handful of arguments: marshal them
+     * from the stack and only go to the heap for an unusual reply
+     */
+    MsgArg stackArgs[LAMP_METHOD_REPLY_STACK_ARGS];
+    MsgArg* args = (numArgs <= LAMP_METHOD_REPLY_STACK_ARGS) ? stackArgs : new MsgArg[numArgs];
+
+    args[0].Set("u", responseCode);
+    size_t index = 1;
+    for (std::list<ajn::MsgArg>::const_iterator it = stdArgs.begin(); it != stdArgs.end(); ++it, ++index) {
+        args[index] = *it;
+    }
+    for (std::list<ajn::MsgArg>::const_iterator it = custArgs.begin(); it != custArgs.end(); ++it, ++index) {
+        args[index] = *it;
+    }
+    stdArgs.clear();
+    custArgs.clear();
+
+    controllerService.SendMethodReply(msg, args, numArgs);
+
+    if (args != stackArgs) {
         delete [] args;
-    } else {
-        QCC_LogError(ER_OUT_OF_MEMORY, ("%s: Failed to allocate enough memory", __func__));
     }
 }
 
@@ -423,6 +452,7 @@ void LampClients::QueueLampMethod(QueuedMethodCall* queuedCall)
 
                 QCC_DbgPrintf(("%s: Queuing Method call %s with method call count %u", __func__, queuedCall->inMsg->GetMemberName(), queuedCall->methodCallCount));
 
+                queuedCall->traceQueued = queuedCall->traceStart ? GetTimestampInUs() : 0;
                 methodQueue.push_back(queuedCall);
             } else {
                 responseCode = LSF_ERR_NO_SLOT;
@@ -452,6 +482,24 @@ void LampClients::QueueLampMethod(QueuedMethodCall* queuedCall)
     }
 }
 
+LampClients::QueuedMethodCall::~QueuedMethodCall()
+{
+    if (traceStart) {
+        char name[LSF_TRACE_NAME_LEN];
+        snprintf(name, sizeof(name), "%s request", inMsg->GetMemberName());
+        Tracer::Record(traceId, name, traceStart, GetTimestampInUs(), responseCounter.total);
+    }
+}
+
+LampClients::QueuedMethodCallContext::~QueuedMethodCallContext()
+{
+    if (traceSent) {
+        char name[LSF_TRACE_NAME_LEN];
+        snprintf(name, sizeof(name), "%s %s", method.c_str(), lampID.c_str());
+        Tracer::Record(traceId, name, traceSent, GetTimestampInUs());
+    }
+}
+
 LSFResponseCode LampClients::DoMethodCallAsync(QueuedMethodCall* queuedCall)
 {
     QCC_DbgPrintf(("%s", __func__));
@@ -478,7 +526,7 @@ LSFResponseCode LampClients::DoMethodCallAsync(QueuedMethodCall* queuedCall)
                         QCC_LogError(ER_FAIL, ("%s: Unable to allocate memory for context", __func__));
                         status = ER_FAIL;
                     } else {
-                        ctx->timeSent = GetTimestampInMs();
+                        ctx->SetTimeSent();
                         ctx->method = element.method;
                         if (0 == strcmp(element.interface.c_str(), ConfigServiceInterfaceName)) {
                             QCC_DbgPrintf(("%s: Config Call", __func__));
@@ -508,6 +556,20 @@ LSFResponseCode LampClients::DoMethodCallAsync(QueuedMethodCall* queuedCall)
                                 ctx,
                                 OEM_CS_LAMP_METHOD_CALL_TIMEOUT
                                 );
+                        } else if (lit->second->packedState && !element.packedArgs.empty()) {
+                            QCC_DbgPrintf(("%s: LampService Packed State Call", __func__));
+                            QCC_DbgPrintf(("%s: Calling %s on lamp %s for method call %s and count %u", __func__,
+                                           element.method.c_str(), (*it).c_str(), queuedCall->inMsg->GetMemberName(), queuedCall->methodCallCount));
+                            status = lit->second->object.MethodCallAsync(
+                                LampServicePackedStateInterfaceName,
+                                element.method.c_str(),
+                                this,
+                                queuedCall->replyFunc,
+                                &element.packedArgs[0],
+                                element.packedArgs.size(),
+                                ctx,
+                                OEM_CS_LAMP_METHOD_CALL_TIMEOUT
+                                );
                         } else {
                             QCC_DbgPrintf(("%s: LampService Call", __func__));
                             QCC_DbgPrintf(("%s: Calling %s on lamp %s for method call %s and count %u", __func__,
@@ -567,18 +629,32 @@ LSFResponseCode LampClients::DoGetLampState(QueuedMethodCallContext* ctx)
     if (lit != activeLamps.end()) {
         QCC_DbgPrintf(("%s: Found Lamp", __func__));
         if (lit->second->IsConnected()) {
-            ctx->timeSent = GetTimestampInMs();
-            QCC_DbgPrintf(("%s: LampService Call", __func__));
-            status = lit->second->object.MethodCallAsync(
-                org::freedesktop::DBus::Properties::InterfaceName,
-                "GetAll",
-                this,
-                static_cast<MessageReceiver::ReplyHandler>(&LampClients::HandleGetLampStateReply),
-                &arg,
-                1,
-                ctx,
-                OEM_CS_LAMP_METHOD_CALL_TIMEOUT
-                );
+            ctx->SetTimeSent();
+            if (lit->second->packedState) {
+                QCC_DbgPrintf(("%s: LampService Packed State Call", __func__));
+                status = lit->second->object.MethodCallAsync(
+                    LampServicePackedStateInterfaceName,
+                    "GetLampState",
+                    this,
+                    static_cast<MessageReceiver::ReplyHandler>(&LampClients::HandleGetLampStateReply),
+                    NULL,
+                    0,
+                    ctx,
+                    OEM_CS_LAMP_METHOD_CALL_TIMEOUT
+                    );
+            } else {
+                QCC_DbgPrintf(("%s: LampService Call", __func__));
+                status = lit->second->object.MethodCallAsync(
+                    org::freedesktop::DBus::Properties::InterfaceName,
+                    "GetAll",
+                    this,
+                    static_cast<MessageReceiver::ReplyHandler>(&LampClients::HandleGetLampStateReply),
+                    &arg,
+                    1,
+                    ctx,
+                    OEM_CS_LAMP_METHOD_CALL_TIMEOUT
+                    );
+            }
         } else {
             QCC_DbgPrintf(("%s:Not connected to lamp", __func__));
             status = ER_FAIL;
@@ -618,8 +694,16 @@ void LampClients::HandleGetLampStateReply(ajn::Message& message, void* context)
         message->GetArgs(numArgs, args);
 
         if (numArgs == 1) {
-            LampState state(args[0]);
-            controllerService.SendStateChangedSignal(ControllerServiceLampInterfaceName, "LampStateChanged", ctx->lampID, state);
+            LampState state;
+            if (args[0].typeId == ALLJOYN_STRUCT) {
+                state.SetPacked(args[0]);
+            } else {
+                state.Set(args[0]);
+            }
+            UpdateLampStateCache(ctx->lampID, state);
+            if (connectToLamps) {
+                controllerService.QueueLampStateChangedSignal(ctx->lampID, state);
+            }
         } else {
             QCC_LogError(ER_BAD_ARG_COUNT, ("%s: Did not receive the expected number of arguments in the method reply", __func__));
         }
@@ -644,6 +728,180 @@ void LampClients::GetLampState(const LSFString& lampID, Message& inMsg)
     QueueLampMethod(queuedCall);
 }
 
+void LampClients::GetAllLampStates(Message& inMsg)
+{
+    QCC_DbgTrace(("%s", __func__));
+    LSFStringList lampList;
+    LampStatesRequest request(inMsg, lampList, true);
+    QueueLampStatesRequest(request);
+}
+
+void LampClients::GetLampStates(const LSFStringList& lampIDs, Message& inMsg)
+{
+    QCC_DbgTrace(("%s", __func__));
+    LampStatesRequest request(inMsg, lampIDs, false);
+    QueueLampStatesRequest(request);
+}
+
+void LampClients::QueueLampStatesRequest(LampStatesRequest& request)
+{
+    QCC_DbgTrace(("%s", __func__));
+
+    LSFResponseCode responseCode = LSF_OK;
+
+    if (!connectToLamps) {
+        responseCode = LSF_ERR_REJECTED;
+    } else {
+        QStatus status = lampStatesRequestsLock.Lock();
+        if (ER_OK != status) {
+            QCC_LogError(ER_FAIL, ("%s: Failed to lock mutex", __func__));
+            responseCode = LSF_ERR_FAILURE;
+        } else {
+            lampStatesRequests.push_back(request);
+
+            status = lampStatesRequestsLock.Unlock();
+            if (ER_OK != status) {
+                QCC_LogError(ER_FAIL, ("%s: Failed to unlock mutex", __func__));
+            }
+            wakeUp.Post();
+        }
+    }
+
+    if (LSF_OK != responseCode) {
+        std::list<MsgArg> stdArgs;
+        std::list<MsgArg> custArgs;
+        custArgs.push_back(MsgArg("a{sa{sv}}", 0, NULL));
+        SendMethodReply(responseCode, request.inMsg, stdArgs, custArgs);
+    }
+}
+
+void LampClients::DoGetLampStates(LampStatesRequest& request)
+{
+    QCC_DbgTrace(("%s", __func__));
+
+    LSFStringList lampList;
+    if (request.allLamps) {
+        for (LampMap::const_iterator it = activeLamps.begin(); it != activeLamps.end(); ++it) {
+            if (it->second->IsConnected()) {
+                lampList.push_back(it->first);
+            }
+        }
+    } else {
+        CreateUniqueList(lampList, request.lamps);
+    }
+
+    QueuedMethodCall* queuedCall = new QueuedMethodCall(request.inMsg, static_cast<MessageReceiver::ReplyHandler>(&LampClients::HandleGetLampStatesReply));
+    if (!queuedCall) {
+        QCC_LogError(ER_FAIL, ("%s: Unable to allocate memory for call", __func__));
+        return;
+    }
+
+    /*
+     * Serve the connected lamps whose state is known from the cache and only
+     * query the rest
+     */
+    LSFStringList uncachedLamps;
+    lampStateCacheLock.Lock();
+    for (LSFStringList::const_iterator it = lampList.begin(); it != lampList.end(); ++it) {
+        LampMap::const_iterator lit = activeLamps.find(*it);
+        LampStateMap::const_iterator cit = lampStateCache.find(*it);
+        if ((lit != activeLamps.end()) && lit->second->IsConnected() && (cit != lampStateCache.end())) {
+            queuedCall->responseCounter.lampStates.insert(*cit);
+        } else {
+            uncachedLamps.push_back(*it);
+        }
+    }
+    lampStateCacheLock.Unlock();
+
+    uint32_t numCached = queuedCall->responseCounter.lampStates.size();
+    QCC_DbgPrintf(("%s: %u lamp states served from cache, %u lamps to query", __func__, numCached, uncachedLamps.size()));
+
+    if (uncachedLamps.empty()) {
+        LSFResponseCode responseCode = (lampList.empty() && !request.allLamps) ? LSF_ERR_INVALID_ARGS : LSF_OK;
+        MsgArg arg;
+        CreateLampStateMapArg(queuedCall->responseCounter.lampStates, arg);
+        queuedCall->responseCounter.customReplyArgs.push_back(arg);
+        SendMethodReply(responseCode, request.inMsg, queuedCall->responseCounter.standardReplyArgs, queuedCall->responseCounter.customReplyArgs);
+        delete queuedCall;
+        return;
+    }
+
+    QueuedMethodCallElement element = QueuedMethodCallElement(uncachedLamps, org::freedesktop::DBus::Properties::InterfaceName, "GetAll");
+    element.args.push_back(MsgArg("s", LampServiceStateInterfaceName));
+    queuedCall->AddMethodCallElement(element);
+
+    queuedCall->responseCounter.total += numCached;
+    queuedCall->responseCounter.successCount += numCached;
+    queuedCall->responseCounter.aggregateLampStates = true;
+    queuedCall->responseCounter.customReplyArgs.push_back(MsgArg("a{sa{sv}}", 0, NULL));
+    QueueLampMethod(queuedCall);
+}
+
+void LampClients::HandleGetLampStatesReply(ajn::Message& message, void* context)
+{
+    QCC_DbgPrintf(("%s: Method Reply %s", __func__, (MESSAGE_METHOD_RET == message->GetType()) ? message->ToString().c_str() : "ERROR"));
+    controllerService.GetBusAttachment().EnableConcurrentCallbacks();
+    QueuedMethodCallContext* ctx = static_cast<QueuedMethodCallContext*>(context);
+
+    if (ctx == NULL) {
+        QCC_LogError(ER_FAIL, ("%s: Received NULL context", __func__));
+        return;
+    }
+
+    QueuedMethodCall* queuedCall = ctx->queuedCallPtr;
+
+    QCC_DbgTrace(("%s: Received reply to call %s on lamp %s in %lu msec", __func__,
+                  ctx->method.c_str(), ctx->lampID.c_str(), (GetTimestampInMs() - ctx->timeSent)));
+
+    if (MESSAGE_METHOD_RET == message->GetType()) {
+        size_t numArgs;
+        const MsgArg* args;
+        message->GetArgs(numArgs, args);
+
+        if (numArgs == 1) {
+            LampState state(args[0]);
+            UpdateLampStateCache(ctx->lampID, state);
+
+            responseLock.Lock();
+            ResponseMap::iterator it = responseMap.find(queuedCall->responseID);
+            if (it != responseMap.end()) {
+                it->second.lampStates[ctx->lampID] = state;
+            }
+            responseLock.Unlock();
+
+            DecrementWaitingAndSendResponse(queuedCall, 1, 0, 0);
+        } else {
+            QCC_LogError(ER_BAD_ARG_COUNT, ("%s: Did not receive the expected number of arguments in the method reply", __func__));
+            DecrementWaitingAndSendResponse(queuedCall, 0, 1, 0);
+        }
+    } else {
+        DecrementWaitingAndSendResponse(queuedCall, 0, 1, 0);
+    }
+
+    delete ctx;
+}
+
+void LampClients::UpdateLampStateCache(const LSFString& lampID, const LampState& state)
+{
+    lampStateCacheLock.Lock();
+    lampStateCache[lampID] = state;
+    lampStateCacheLock.Unlock();
+}
+
+void LampClients::InvalidateLampStateCache(const LSFString& lampID)
+{
+    lampStateCacheLock.Lock();
+    lampStateCache.erase(lampID);
+    lampStateCacheLock.Unlock();
+}
+
+void LampClients::ClearLampStateCache(void)
+{
+    lampStateCacheLock.Lock();
+    lampStateCache.clear();
+    lampStateCacheLock.Unlock();
+}
+
 void LampClients::GetLampStateField(const LSFString& lampID, const LSFString& field, Message& inMsg)
 {
     QCC_DbgTrace(("%s", __func__));
@@ -792,6 +1050,7 @@ void LampClients::ChangeLampState(const ajn::Message& inMsg, bool groupOperation
         element.args.push_back(MsgArg("t", transitionStateFieldParam.timestamp));
         element.args.push_back(MsgArg("a{sv}", 1, arrayVals));
         element.args.push_back(MsgArg("u", transitionStateFieldParam.period));
+        element.PackLampStates();
         queuedCall->AddMethodCallElement(element);
 
         transitionStateFieldparams.pop_front();
@@ -813,6 +1072,7 @@ void LampClients::ChangeLampState(const ajn::Message& inMsg, bool groupOperation
         element.args.push_back(MsgArg("t", transitionStateParam.timestamp));
         element.args.push_back(transitionStateParam.state);
         element.args.push_back(MsgArg("u", transitionStateParam.period));
+        element.PackLampStates();
         queuedCall->AddMethodCallElement(element);
 
         transitionStateParams.pop_front();
@@ -837,6 +1097,7 @@ void LampClients::ChangeLampState(const ajn::Message& inMsg, bool groupOperation
         element.args.push_back(MsgArg("u", pulseParam.duration));
         element.args.push_back(MsgArg("u", pulseParam.numPulses));
         element.args.push_back(MsgArg("t", pulseParam.timestamp));
+        element.PackLampStates();
         queuedCall->AddMethodCallElement(element);
 
         pulseParams.pop_front();
@@ -850,6 +1111,33 @@ void LampClients::ChangeLampState(const ajn::Message& inMsg, bool groupOperation
     QueueLampMethod(queuedCall);
 }
 
+void LampClients::TransitionLampsToStates(const ajn::Message& inMsg, TransitionStateParamsList& transitionStateParams)
+{
+    QCC_DbgTrace(("%s", __func__));
+    QueuedMethodCall* queuedCall = new QueuedMethodCall(inMsg, static_cast<MessageReceiver::ReplyHandler>(&LampClients::HandleReplyWithLampResponseCode));
+
+    if (!queuedCall) {
+        QCC_LogError(ER_FAIL, ("%s: Unable to allocate memory for call", __func__));
+        return;
+    }
+
+    while (transitionStateParams.size()) {
+        TransitionStateParams transitionStateParam = transitionStateParams.front();
+
+        QueuedMethodCallElement element = QueuedMethodCallElement(transitionStateParam.lamps, LampServiceStateInterfaceName, "TransitionLampState");
+
+        element.args.push_back(MsgArg("t", transitionStateParam.timestamp));
+        element.args.push_back(transitionStateParam.state);
+        element.args.push_back(MsgArg("u", transitionStateParam.period));
+        element.PackLampStates();
+        queuedCall->AddMethodCallElement(element);
+
+        transitionStateParams.pop_front();
+    }
+
+    QueueLampMethod(queuedCall);
+}
+
 void LampClients::DecrementWaitingAndSendResponse(QueuedMethodCall* queuedCall, uint32_t success, uint32_t failure, uint32_t notFound, const ajn::MsgArg* arg)
 {
     QCC_DbgPrintf(("%s: responseID=%s ", __func__, queuedCall->responseID.c_str()));
@@ -875,6 +1163,14 @@ void LampClients::DecrementWaitingAndSendResponse(QueuedMethodCall* queuedCall,
         }
 
         if (it->second.numWaiting == 0) {
+            if (it->second.aggregateLampStates) {
+                MsgArg lampStatesArg;
+                CreateLampStateMapArg(it->second.lampStates, lampStatesArg);
+                lampStatesArg.Stabilize();
+                it->second.customReplyArgs.clear();
+                it->second.customReplyArgs.push_back(lampStatesArg);
+            }
+
             if (it->second.notFoundCount == it->second.total) {
                 responseCode = LSF_ERR_NOT_FOUND;
                 QCC_DbgPrintf(("%s: Response is LSF_ERR_NOT_FOUND for method %s", __func__, queuedCall->inMsg->GetMemberName()));
@@ -1069,6 +1365,11 @@ void LampClients::LampStateChangedSignalHandler(const InterfaceDescription::Memb
     const char* uniqueId;
     args[0].Get("s", &uniqueId);
 
+    /*
+     * The cached state is stale until the GetAll below completes
+     */
+    InvalidateLampStateCache(LSFString(uniqueId));
+
     QueuedMethodCallContext* ctx = new QueuedMethodCallContext(uniqueId, "GetAll");
     if (!ctx) {
         QCC_LogError(ER_FAIL, ("%s: Unable to allocate memory for call", __func__));
@@ -1216,8 +1517,8 @@ void LampClients::IntrospectCB(QStatus status, ajn::ProxyBusObject* obj, void* c
 
     LampConnection* connection = static_cast<LampConnection*>(context);
 
-    if (!connectToLamps) {
-        QCC_DbgPrintf(("%s: connectToLamps is false", __func__));
+    if (!MaintainsLampSessions()) {
+        QCC_DbgPrintf(("%s: Not maintaining lamp sessions", __func__));
         return;
     }
 
@@ -1251,6 +1552,9 @@ void LampClients::IntrospectCB(QStatus status, ajn::ProxyBusObject* obj, void* c
     }
 
     if (ER_OK == tempStatus) {
+        connection->packedState = connection->object.ImplementsInterface(LampServicePackedStateInterfaceName);
+        QCC_DbgPrintf(("%s: Lamp %s packed state=%d", __func__, connection->lampId.c_str(), connection->packedState));
+
         intf = controllerService.GetBusAttachment().GetInterface(AboutInterfaceName);
         tempStatus = connection->aboutObject.AddInterface(*intf);
         QCC_DbgPrintf(("%s: connection->aboutObject.AddInterface returns %s\n", __func__, QCC_StatusText(tempStatus)));
@@ -1323,6 +1627,49 @@ void LampClients::AlarmTriggered(void)
     wakeUp.Post();
 }
 
+void LampClients::ClearQueuedRequests(void)
+{
+    QStatus status = queueLock.Lock();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: queueLock.Lock() failed", __func__));
+    } else {
+        while (methodQueue.size()) {
+            QueuedMethodCall* queuedCall = methodQueue.front();
+            delete queuedCall;
+            methodQueue.pop_front();
+        }
+        QCC_DbgPrintf(("%s: Cleared methodQueue", __func__));
+        status = queueLock.Unlock();
+        if (status != ER_OK) {
+            QCC_LogError(status, ("%s: queueLock.Unlock() failed", __func__));
+        }
+    }
+
+    status = getAllLampIDsLock.Lock();
+    if (ER_OK != status) {
+        QCC_LogError(ER_FAIL, ("%s: getAllLampIDsLock.Lock() failed", __func__));
+    } else {
+        getAllLampIDsRequests.clear();
+        QCC_DbgPrintf(("%s: Cleared getAllLampIDsRequests", __func__));
+        status = getAllLampIDsLock.Unlock();
+        if (ER_OK != status) {
+            QCC_LogError(ER_FAIL, ("%s: getAllLampIDsLock.Unlock() failed", __func__));
+        }
+    }
+
+    status = lampStatesRequestsLock.Lock();
+    if (ER_OK != status) {
+        QCC_LogError(ER_FAIL, ("%s: lampStatesRequestsLock.Lock() failed", __func__));
+    } else {
+        lampStatesRequests.clear();
+        QCC_DbgPrintf(("%s: Cleared lampStatesRequests", __func__));
+        status = lampStatesRequestsLock.Unlock();
+        if (ER_OK != status) {
+            QCC_LogError(ER_FAIL, ("%s: lampStatesRequestsLock.Unlock() failed", __func__));
+        }
+    }
+}
+
 void LampClients::Run(void)
 {
     QCC_DbgTrace(("%s", __func__));
@@ -1338,14 +1685,25 @@ void LampClients::Run(void)
         QCC_DbgPrintf(("%s: Waiting on wakeUp", __func__));
         wakeUp.Wait();
         QStatus status = ER_OK;
+        bool usefulWakeup = false;
 
-        if (connectToLamps) {
+        if (MaintainsLampSessions()) {
             QCC_DbgPrintf(("%s: In the ConnectToLamps loop", __func__));
 
+            /*
+             * In hot standby, the sessions are kept warm but only the leader
+             * serves requests and sends signals to the apps
+             */
+            bool serving = connectToLamps;
+
             if (oneTimeCleanupDone) {
                 oneTimeCleanupDone = false;
             }
 
+            if (!serving) {
+                ClearQueuedRequests();
+            }
+
             /*
              * Handle all the lost sessions
              */
@@ -1361,6 +1719,7 @@ void LampClients::Run(void)
              */
             tempLostSessionList = lostSessionList;
             lostSessionList.clear();
+            usefulWakeup = usefulWakeup || !tempLostSessionList.empty();
             status = lostSessionListLock.Unlock();
             if (ER_OK != status) {
                 QCC_LogError(status, ("%s: lostSessionListLock.Unlock() failed", __func__));
@@ -1376,6 +1735,7 @@ void LampClients::Run(void)
                         it->second->ClearSessionAndObjects();
                         it->second->connectionState = BLACKLISTED;
                         lostLamps.push_back(it->second->lampId);
+                        InvalidateLampStateCache(it->second->lampId);
                     }
                 }
             }
@@ -1383,7 +1743,7 @@ void LampClients::Run(void)
             /*
              * Send the lost lamps signal if required
              */
-            if (lostLamps.size()) {
+            if (serving && lostLamps.size()) {
                 controllerService.SendSignal(ControllerServiceLampInterfaceName, "LampsLost", lostLamps);
             }
 
@@ -1398,6 +1758,7 @@ void LampClients::Run(void)
             } else {
                 tempGetAllLampIDsRequests = getAllLampIDsRequests;
                 getAllLampIDsRequests.clear();
+                usefulWakeup = usefulWakeup || !tempGetAllLampIDsRequests.empty();
                 status = getAllLampIDsLock.Unlock();
                 if (ER_OK != status) {
                     QCC_LogError(ER_FAIL, ("%s: getAllLampIDsLock.Unlock() failed", __func__));
@@ -1442,6 +1803,7 @@ void LampClients::Run(void)
                  */
                 tempAboutList = aboutsList;
                 aboutsList.clear();
+                usefulWakeup = usefulWakeup || !tempAboutList.empty();
                 status = aboutsListLock.Unlock();
                 if (ER_OK != status) {
                     QCC_LogError(status, ("%s: aboutsListLock.Unlock() failed", __func__));
@@ -1463,7 +1825,7 @@ void LampClients::Run(void)
                         if (conn->name != newConn->name) {
                             conn->name = newConn->name;
                         }
-                        if (conn->IsConnected()) {
+                        if (serving && conn->IsConnected()) {
                             nameChangedList.insert(std::make_pair(conn->lampId, conn->name));
                         }
                         QCC_DbgPrintf(("%s: Name Changed for %s", __func__, newConn->lampId.c_str()));
@@ -1473,6 +1835,7 @@ void LampClients::Run(void)
                          * old session and setup a new session with the lamp
                          */
                         LampConnectionState backup = conn->connectionState;
+                        InvalidateLampStateCache(conn->lampId);
                         if (conn->sessionID) {
                             controllerService.DoLeaveSessionAsync(conn->sessionID);
                         }
@@ -1520,6 +1883,7 @@ void LampClients::Run(void)
                 }
             }
 
+            usefulWakeup = usefulWakeup || alarmTriggered;
             if (alarmTriggered) {
                 alarmSet = false;
                 alarmTriggered = false;
@@ -1543,6 +1907,7 @@ void LampClients::Run(void)
                  */
                 tempJoinList = joinSessionCBList;
                 joinSessionCBList.clear();
+                usefulWakeup = usefulWakeup || !tempJoinList.empty();
                 status = joinSessionCBListLock.Unlock();
                 if (ER_OK != status) {
                     QCC_LogError(status, ("%s: joinSessionCBListLock.Unlock() failed", __func__));
@@ -1586,8 +1951,19 @@ void LampClients::Run(void)
             /*
              * Send the found lamps signal if required
              */
-            if (foundLamps.size()) {
+            if (serving && foundLamps.size()) {
                 controllerService.SendSignal(ControllerServiceLampInterfaceName, "LampsFound", foundLamps);
+            } else if (!serving) {
+                /*
+                 * Mirror the state of the new lamps so that the cache is warm when we are promoted.
+                 * LampStateChanged signals keep it up to date afterwards
+                 */
+                for (LSFStringList::const_iterator it = foundLamps.begin(); it != foundLamps.end(); ++it) {
+                    QueuedMethodCallContext* ctx = new QueuedMethodCallContext(*it, "GetAll");
+                    if (ctx) {
+                        DoGetLampState(ctx);
+                    }
+                }
             }
 
             if (retryJoinSession) {
@@ -1622,6 +1998,7 @@ void LampClients::Run(void)
             getLampStateListLock.Lock();
             getLampStateListCopy = getLampStateList;
             getLampStateList.clear();
+            usefulWakeup = usefulWakeup || !getLampStateListCopy.empty();
             getLampStateListLock.Unlock();
 
             while (getLampStateListCopy.size()) {
@@ -1631,6 +2008,28 @@ void LampClients::Run(void)
                 getLampStateListCopy.pop_front();
             }
 
+            /*
+             * Handle all GetAllLampStates and GetLampStates requests
+             */
+            std::list<LampStatesRequest> tempLampStatesRequests;
+            status = lampStatesRequestsLock.Lock();
+            if (ER_OK != status) {
+                QCC_LogError(ER_FAIL, ("%s: lampStatesRequestsLock.Lock() failed", __func__));
+            } else {
+                tempLampStatesRequests = lampStatesRequests;
+                lampStatesRequests.clear();
+                usefulWakeup = usefulWakeup || !tempLampStatesRequests.empty();
+                status = lampStatesRequestsLock.Unlock();
+                if (ER_OK != status) {
+                    QCC_LogError(ER_FAIL, ("%s: lampStatesRequestsLock.Unlock() failed", __func__));
+                }
+            }
+
+            while (tempLampStatesRequests.size()) {
+                DoGetLampStates(tempLampStatesRequests.front());
+                tempLampStatesRequests.pop_front();
+            }
+
             /*
              * Handle all the incoming method requests
              */
@@ -1645,6 +2044,7 @@ void LampClients::Run(void)
                  */
                 tempMethodQueue = methodQueue;
                 methodQueue.clear();
+                usefulWakeup = usefulWakeup || !tempMethodQueue.empty();
                 status = queueLock.Unlock();
                 if (status != ER_OK) {
                     QCC_LogError(status, ("%s: queueLock.Unlock() failed", __func__));
@@ -1654,27 +2054,21 @@ void LampClients::Run(void)
             while (tempMethodQueue.size()) {
                 QueuedMethodCall* queuedCall = tempMethodQueue.front();
                 QCC_DbgPrintf(("%s: Calling DoMethodCallAsync with tempMethodQueue.size() %d", __func__, tempMethodQueue.size()));
+                /*
+                 * The replies of the lamps may delete the call before DoMethodCallAsync returns
+                 */
+                TraceContext traceContext(queuedCall->traceId, queuedCall->traceStart);
+                if (queuedCall->traceQueued) {
+                    Tracer::Record(queuedCall->traceId, "LampClients queue", queuedCall->traceQueued, GetTimestampInUs(), tempMethodQueue.size());
+                }
+                TraceSpan traceSpan("LampClients::DoMethodCallAsync", queuedCall->responseCounter.total);
                 DoMethodCallAsync(queuedCall);
                 tempMethodQueue.pop_front();
             }
         } else {
             QCC_DbgPrintf(("%s: In the DisconnectFromLamps loop", __func__));
             if (!oneTimeCleanupDone) {
-                status = queueLock.Lock();
-                if (status != ER_OK) {
-                    QCC_LogError(status, ("%s: queueLock.Lock() failed", __func__));
-                } else {
-                    while (methodQueue.size()) {
-                        QueuedMethodCall* queuedCall = methodQueue.front();
-                        delete queuedCall;
-                        methodQueue.pop_front();
-                    }
-                    QCC_DbgPrintf(("%s: Cleared methodQueue", __func__));
-                    status = queueLock.Unlock();
-                    if (status != ER_OK) {
-                        QCC_LogError(status, ("%s: queueLock.Unlock() failed", __func__));
-                    }
-                }
+                ClearQueuedRequests();
 
                 for (LampMap::iterator it = activeLamps.begin(); it != activeLamps.end(); ++it) {
                     LampConnection* conn = it->second;
@@ -1709,18 +2103,9 @@ void LampClients::Run(void)
                     QCC_LogError(status, ("%s: lostSessionListLock.Unlock() failed", __func__));
                 }
 
-                status = getAllLampIDsLock.Lock();
-                if (ER_OK != status) {
-                    QCC_LogError(ER_FAIL, ("%s: getAllLampIDsLock.Lock() failed", __func__));
-                } else {
-                    getAllLampIDsRequests.clear();
-                    QCC_DbgPrintf(("%s: Cleared getAllLampIDsRequests", __func__));
-                    status = getAllLampIDsLock.Unlock();
-                    if (ER_OK != status) {
-                        QCC_LogError(ER_FAIL, ("%s: getAllLampIDsLock.Unlock() failed", __func__));
-                    }
-                }
+                ClearLampStateCache();
                 oneTimeCleanupDone = true;
+                usefulWakeup = true;
             } else {
                 /*
                  * Handle announcements
@@ -1737,6 +2122,7 @@ void LampClients::Run(void)
                      */
                     tempAboutList = aboutsList;
                     aboutsList.clear();
+                    usefulWakeup = usefulWakeup || !tempAboutList.empty();
                     status = aboutsListLock.Unlock();
                     if (ER_OK != status) {
                         QCC_LogError(status, ("%s: aboutsListLock.Unlock() failed", __func__));
@@ -1769,6 +2155,55 @@ void LampClients::Run(void)
             }
         }
 
+        UpdateLampCounts();
+        Thread::RecordWakeup(usefulWakeup || !isRunning);
+
         QCC_DbgPrintf(("%s: Exited", __func__));
     }
 }
+
+void LampClients::UpdateLampCounts(void)
+{
+    uint32_t connected = 0;
+    uint32_t blacklisted = 0;
+    uint32_t retrying = 0;
+
+    for (LampMap::const_iterator it = activeLamps.begin(); it != activeLamps.end(); ++it) {
+        switch (it->second->connectionState) {
+        case CONNECTED:
+            connected++;
+            break;
+
+        case BLACKLISTED:
+            blacklisted++;
+            break;
+
+        case JOIN_SESSION_IN_PROGRESS:
+        case RETRY_JOIN_SESSION:
+            retrying++;
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    connectedLampCount = connected;
+    blacklistedLampCount = blacklisted;
+    retryingLampCount = retrying;
+}
+
+void LampClients::GetDiagnostics(LampClientsDiagnostics& diagnostics)
+{
+    queueLock.Lock();
+    diagnostics.queueDepth = methodQueue.size();
+    queueLock.Unlock();
+
+    responseLock.Lock();
+    diagnostics.pendingResponses = responseMap.size();
+    responseLock.Unlock();
+
+    diagnostics.connectedLamps = connectedLampCount;
+    diagnostics.blacklistedLamps = blacklistedLampCount;
+    diagnostics.retryingLamps = retryingLampCount;
+}
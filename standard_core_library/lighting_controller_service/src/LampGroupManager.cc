@@ -21,6 +21,7 @@
 #include <SceneManager.h>
 #include <OEM_CS_Config.h>
 #include <FileParser.h>
+#include <Trace.h>
 
 #include <sstream>
 #include <streambuf>
@@ -32,7 +33,7 @@ using namespace ajn;
 #define QCC_MODULE "LAMP_GROUP_MANAGER"
 
 LampGroupManager::LampGroupManager(ControllerService& controllerSvc, LampManager& lampMgr, SceneManager* sceneMgrPtr, const std::string& lampGroupFile) :
-    Manager(controllerSvc, lampGroupFile), lampManager(lampMgr), sceneManagerPtr(sceneMgrPtr), blobLength(0)
+    Manager(controllerSvc, lampGroupFile), lampGroupsLock("LampGroupManager.lampGroupsLock"), lampManager(lampMgr), sceneManagerPtr(sceneMgrPtr), blobLength(0)
 {
     QCC_DbgTrace(("%s", __func__));
     lampGroups.clear();
@@ -258,7 +259,7 @@ void LampGroupManager::SetLampGroupName(Message& message)
                         it->second.first = newName;
                         responseCode = LSF_OK;
                         nameChanged = true;
-                        ScheduleFileWrite();
+                        ScheduleEntityWrite(lampGroupID, GetString(it->second.first, lampGroupID, it->second.second));
                     } else {
                         responseCode = LSF_ERR_RESOURCES;
                     }
@@ -334,7 +335,7 @@ void LampGroupManager::CreateLampGroup(Message& message)
                     lampGroups[lampGroupID].first = name;
                     lampGroups[lampGroupID].second = lampGroup;
                     created = true;
-                    ScheduleFileWrite();
+                    ScheduleEntityWrite(lampGroupID, newGroupStr);
                 } else {
                     responseCode = LSF_ERR_RESOURCES;
                 }
@@ -410,7 +411,7 @@ void LampGroupManager::UpdateLampGroup(Message& message)
                     it->second.second = lampGroup;
                     responseCode = LSF_OK;
                     updated = true;
-                    ScheduleFileWrite();
+                    ScheduleEntityWrite(lampGroupID, GetString(it->second.first, lampGroupID, lampGroup));
                 } else {
                     responseCode = LSF_ERR_RESOURCES;
                 }
@@ -470,7 +471,7 @@ void LampGroupManager::DeleteLampGroup(Message& message)
 
                 lampGroups.erase(it);
                 deleted = true;
-                ScheduleFileWrite();
+                ScheduleEntityDelete(lampGroupID);
             } else {
                 responseCode = LSF_ERR_NOT_FOUND;
             }
@@ -537,6 +538,76 @@ void LampGroupManager::GetLampGroup(Message& message)
     controllerService.SendMethodReply(message, outArgs, 4);
 }
 
+void LampGroupManager::GetAllLampGroups(Message& message)
+{
+    QCC_DbgPrintf(("%s: %s", __func__, message->ToString().c_str()));
+
+    LSFResponseCode responseCode = LSF_OK;
+    LampGroupMap lampGroupMap;
+
+    MsgArg outArgs[3];
+
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerService.CheckNumArgsInMessage(numArgs, 1)  != LSF_OK) {
+        return;
+    }
+
+    const char* language;
+    args[0].Get("s", &language);
+
+    if (0 != strcmp("en", language)) {
+        QCC_LogError(ER_FAIL, ("%s: Language %s not supported", __func__, language));
+        responseCode = LSF_ERR_INVALID_ARGS;
+    } else {
+        responseCode = GetAllLampGroups(lampGroupMap);
+    }
+
+    size_t numLampGroups = (LSF_OK == responseCode) ? lampGroupMap.size() : 0;
+    if (numLampGroups) {
+        MsgArg* lampGroupArray = new MsgArg[numLampGroups];
+        size_t i = 0;
+        for (LampGroupMap::const_iterator it = lampGroupMap.begin(); it != lampGroupMap.end(); it++, i++) {
+            const LampGroup& lampGroup = it->second.second;
+
+            size_t numLamps = lampGroup.lamps.size();
+            const char** lampList = NULL;
+            if (numLamps) {
+                lampList = new const char*[numLamps];
+                size_t j = 0;
+                for (LSFStringList::const_iterator nit = lampGroup.lamps.begin(); nit != lampGroup.lamps.end(); nit++) {
+                    lampList[j++] = nit->c_str();
+                }
+            }
+
+            size_t numLampGroupIDs = lampGroup.lampGroups.size();
+            const char** lampGroupList = NULL;
+            if (numLampGroupIDs) {
+                lampGroupList = new const char*[numLampGroupIDs];
+                size_t j = 0;
+                for (LSFStringList::const_iterator nit = lampGroup.lampGroups.begin(); nit != lampGroup.lampGroups.end(); nit++) {
+                    lampGroupList[j++] = nit->c_str();
+                }
+            }
+
+            lampGroupArray[i].Set("(ssasas)", it->first.c_str(), it->second.first.c_str(), numLamps, lampList, numLampGroupIDs, lampGroupList);
+            delete [] lampList;
+            delete [] lampGroupList;
+        }
+        outArgs[2].Set("a(ssasas)", numLampGroups, lampGroupArray);
+        outArgs[2].SetOwnershipFlags(MsgArg::OwnsArgs, true);
+    } else {
+        outArgs[2].Set("a(ssasas)", 0, NULL);
+    }
+
+    outArgs[0].Set("u", responseCode);
+    outArgs[1].Set("s", language);
+
+    controllerService.SendMethodReply(message, outArgs, 3);
+}
+
 void LampGroupManager::ResetLampGroupState(Message& message)
 {
     QCC_DbgPrintf(("%s: %s", __func__, message->ToString().c_str()));
@@ -807,6 +878,7 @@ LSFResponseCode LampGroupManager::ChangeLampGroupStateAndField(Message& message,
                                                                bool groupOperation, LSFString sceneOrMasterSceneID)
 {
     QCC_DbgTrace(("%s", __func__));
+    TraceSpan traceSpan("LampGroupManager::ChangeLampGroupStateAndField");
     LSFResponseCode responseCode = LSF_OK;
 
     LampsAndStateList transitionToStateList;
@@ -965,8 +1037,8 @@ LSFResponseCode LampGroupManager::GetAllGroupLampsInternal(LSFStringList& lampGr
 void LampGroupManager::ReadSavedData()
 {
     QCC_DbgTrace(("%s", __func__));
-    std::istringstream stream;
-    if (!ValidateFileAndRead(stream)) {
+    StoreFile file;
+    if (!ValidateFileAndRead(file)) {
         /*
          * If there is no file present / CRC check failed on the file create a new
          * file with initialState entry
@@ -977,14 +1049,33 @@ void LampGroupManager::ReadSavedData()
         return;
     }
 
-    blobLength = stream.str().size();
+    blobLength = file.GetPayloadLength();
+    MemoryStreamBuf buffer(file.GetPayload(), file.GetPayloadLength());
+    std::istream stream(&buffer);
     ReplaceMap(stream);
+
+    ReplayJournal();
+}
+
+void LampGroupManager::ApplyJournalRecord(const StoreJournalRecord& record)
+{
+    QCC_DbgPrintf(("%s: type=%c id=%s", __func__, record.type, record.id.c_str()));
+    LampGroupMap::iterator it = lampGroups.find(record.id);
+    if (it != lampGroups.end()) {
+        blobLength -= GetString(it->second.first, it->first, it->second.second).length();
+        lampGroups.erase(it);
+    }
+    if (record.type == StoreJournal::RECORD_UPDATE) {
+        blobLength += record.data.length();
+        std::istringstream stream(record.data);
+        ReplaceMap(stream, true);
+    }
 }
 
-void LampGroupManager::ReplaceMap(std::istringstream& stream)
+void LampGroupManager::ReplaceMap(std::istream& stream, bool merge)
 {
     QCC_DbgTrace(("%s", __func__));
-    bool firstIteration = true;
+    bool firstIteration = !merge;
     while (!stream.eof()) {
         std::string token = ParseString(stream);
 
@@ -1074,30 +1165,34 @@ std::string LampGroupManager::GetString(const LampGroupMap& items)
     return stream.str();
 }
 
-bool LampGroupManager::GetString(std::string& output, uint32_t& checksum, uint64_t& timestamp)
+bool LampGroupManager::GetString(std::string& output, StoreChangeSet& changes, uint32_t& checksum, uint64_t& timestamp)
 {
     QCC_DbgTrace(("%s", __func__));
     LampGroupMap mapCopy;
     mapCopy.clear();
     bool ret = false;
+    bool snapshot = false;
     output.clear();
 
     lampGroupsLock.Lock();
     // we can't hold this lock for the entire time!
     if (updated) {
-        mapCopy = lampGroups;
+        snapshot = TakeStoreChanges(changes);
+        if (snapshot) {
+            mapCopy = lampGroups;
+        }
         updated = false;
         ret = true;
     }
     lampGroupsLock.Unlock();
 
     if (ret) {
-        output = GetString(mapCopy);
+        if (snapshot) {
+            output = GetString(mapCopy);
+        }
         lampGroupsLock.Lock();
         if (blobUpdateCycle) {
-            checksum = checkSum;
             timestamp = timeStamp;
-            blobUpdateCycle = false;
         } else {
             if (initialState) {
                 timeStamp = timestamp = 0UL;
@@ -1105,8 +1200,20 @@ bool LampGroupManager::GetString(std::string& output, uint32_t& checksum, uint64
             } else {
                 timeStamp = timestamp = GetTimestampInMs();
             }
+        }
+        if (!snapshot) {
+            /*
+             * Only the changes are journalled; the store is checksummed when it is next serialized
+             */
+            checksum = changes.checksum;
+            checkSumValid = false;
+        } else if (blobUpdateCycle && checkSumValid) {
+            checksum = checkSum;
+        } else {
             checkSum = checksum = GetChecksum(output);
+            checkSumValid = true;
         }
+        blobUpdateCycle = false;
         lampGroupsLock.Unlock();
     }
 
@@ -1118,16 +1225,66 @@ void LampGroupManager::HandleReceivedBlob(const std::string& blob, uint32_t chec
     QCC_DbgPrintf(("%s", __func__));
     uint64_t currentTimestamp = GetTimestampInMs();
     lampGroupsLock.Lock();
-    if (((timeStamp == 0) || ((currentTimestamp - timeStamp) > timestamp)) && (checkSum != checksum)) {
+    if (AcceptReceivedBlob(checksum, timestamp)) {
         std::istringstream stream(blob.c_str());
         ReplaceMap(stream);
         timeStamp = currentTimestamp;
         checkSum = checksum;
+        checkSumValid = true;
         ScheduleFileWrite(true);
     }
     lampGroupsLock.Unlock();
 }
 
+void LampGroupManager::HandleReceivedDelta(const StoreChangeSet& changes, uint32_t checksum)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    lampGroupsLock.Lock();
+    bool inSync = ApplyStoreChanges(changes);
+    if (inSync) {
+        inSync = CompleteStoreChanges(checksum);
+    }
+    lampGroupsLock.Unlock();
+
+    if (!inSync) {
+        controllerService.GetLeaderElectionObj().RequestBlob(LSF_LAMP_GROUP);
+    }
+}
+
+void LampGroupManager::HandleReconciledEntities(const StoreJournalRecordList& records)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    lampGroupsLock.Lock();
+    ApplyReconciledEntities(records);
+    CompleteStoreChanges(hashTree.GetFoldedRootHash());
+    lampGroupsLock.Unlock();
+}
+
+void LampGroupManager::BuildHashTree(void)
+{
+    if (hashTree.IsBuilt()) {
+        return;
+    }
+
+    QCC_DbgPrintf(("%s: %u entities", __func__, (uint32_t) lampGroups.size()));
+    hashTree.Reset();
+    for (LampGroupMap::const_iterator it = lampGroups.begin(); it != lampGroups.end(); ++it) {
+        hashTree.Update(it->first, GetString(it->second.first, it->first, it->second.second));
+    }
+}
+
+void LampGroupManager::GetEntityRecords(const LSFStringList& ids, StoreJournalRecordList& records)
+{
+    records.clear();
+    for (LSFStringList::const_iterator id = ids.begin(); id != ids.end(); ++id) {
+        LampGroupMap::const_iterator it = lampGroups.find(*id);
+        if (it != lampGroups.end()) {
+            StoreJournalRecord record = { StoreJournal::RECORD_UPDATE, it->first, GetString(it->second.first, it->first, it->second.second), 0, 0, 0 };
+            records.push_back(record);
+        }
+    }
+}
+
 void LampGroupManager::ReadWriteFile()
 {
     QCC_DbgPrintf(("%s", __func__));
@@ -1137,17 +1294,22 @@ void LampGroupManager::ReadWriteFile()
     }
 
     std::string output;
+    StoreChangeSet changes;
     uint32_t checksum;
     uint64_t timestamp;
     bool status = false;
 
-    status = GetString(output, checksum, timestamp);
+    status = GetString(output, changes, checksum, timestamp);
 
+    bool sendBlob = false;
     if (status) {
-        WriteFileWithChecksumAndTimestamp(output, checksum, timestamp);
+        if (!CommitToStore(output, changes, checksum, timestamp)) {
+            lampGroupsLock.Lock();
+            ScheduleFileWrite(true);
+            lampGroupsLock.Unlock();
+        }
         if (timestamp != 0UL) {
-            uint64_t currentTime = GetTimestampInMs();
-            controllerService.SendBlobUpdate(LSF_LAMP_GROUP, output, checksum, (currentTime - timestamp));
+            sendBlob = !SendBlobUpdate(LSF_LAMP_GROUP, output, changes, checksum, timestamp);
         }
     }
 
@@ -1161,11 +1323,22 @@ void LampGroupManager::ReadWriteFile()
     }
     readMutex.Unlock();
 
-    if ((tempMessageList.size() || sendUpdate) && !status) {
-        std::istringstream stream;
-        status = ValidateFileAndReadInternal(checksum, timestamp, stream);
+    if ((tempMessageList.size() || sendUpdate || sendBlob) && output.empty() && !journal.IsEmpty()) {
+        /*
+         * The snapshot on disk does not include the journal
+         */
+        lampGroupsLock.Lock();
+        LampGroupMap mapCopy = lampGroups;
+        timestamp = timeStamp;
+        lampGroupsLock.Unlock();
+        output = GetString(mapCopy);
+        checksum = GetChecksum(output);
+        status = true;
+    } else if ((tempMessageList.size() || sendUpdate || sendBlob) && output.empty()) {
+        StoreFile file;
+        status = ValidateFileAndReadInternal(checksum, timestamp, file);
         if (status) {
-            output = stream.str();
+            output.assign(file.GetPayload(), file.GetPayloadLength());
         } else {
             QCC_LogError(ER_FAIL, ("%s: Lamp Group persistent store corrupted", __func__));
         }
@@ -1179,6 +1352,11 @@ void LampGroupManager::ReadWriteFile()
         }
     }
 
+    if (sendBlob && status) {
+        uint64_t currentTime = GetTimestampInMs();
+        controllerService.SendBlobUpdate(LSF_LAMP_GROUP, output, checksum, (currentTime - timestamp));
+    }
+
     if (sendUpdate) {
         sendUpdate = false;
         uint64_t currentTime = GetTimestampInMs();
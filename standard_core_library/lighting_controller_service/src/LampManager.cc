@@ -19,6 +19,7 @@
 #include <OEM_CS_Config.h>
 
 #include <ControllerService.h>
+#include <Trace.h>
 
 #include <alljoyn/Status.h>
 #include <qcc/Debug.h>
@@ -271,6 +272,33 @@ void LampManager::GetLampState(ajn::Message& message)
     lampClients.GetLampState(lampID, message);
 }
 
+void LampManager::GetAllLampStates(ajn::Message& message)
+{
+    QCC_DbgPrintf(("%s: %s", __func__, message->ToString().c_str()));
+    lampClients.GetAllLampStates(message);
+}
+
+void LampManager::GetLampStates(ajn::Message& message)
+{
+    QCC_DbgPrintf(("%s: %s", __func__, message->ToString().c_str()));
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerService.CheckNumArgsInMessage(numArgs, 1)  != LSF_OK) {
+        return;
+    }
+
+    MsgArg* idsArray;
+    size_t idsSize;
+    args[0].Get("as", &idsSize, &idsArray);
+
+    LSFStringList lampIDs;
+    CreateUniqueList(lampIDs, idsArray, idsSize);
+
+    lampClients.GetLampStates(lampIDs, message);
+}
+
 void LampManager::GetLampStateField(ajn::Message& message)
 {
     QCC_DbgPrintf(("%s: %s", __func__, message->ToString().c_str()));
@@ -502,6 +530,7 @@ void LampManager::ChangeLampStateAndField(Message& message,
     LSFResponseCode responseCode = LSF_ERR_FAILURE;
 
     QCC_DbgPrintf(("%s", __func__));
+    TraceSpan traceSpan("LampManager::ChangeLampStateAndField");
 
     uint64_t timestamp = 0;
     OEM_CS_GetSyncTimeStamp(timestamp);
@@ -653,6 +682,69 @@ void LampManager::TransitionLampState(ajn::Message& message)
     }
 }
 
+void LampManager::TransitionLampsToStates(ajn::Message& message)
+{
+    QCC_DbgPrintf(("%s: %s", __func__, message->ToString().c_str()));
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerService.CheckNumArgsInMessage(numArgs, 1)  != LSF_OK) {
+        return;
+    }
+
+    MsgArg* transitions;
+    size_t numTransitions;
+    args[0].Get("a(sa{sv}u)", &numTransitions, &transitions);
+
+    LSFResponseCode responseCode = LSF_OK;
+    if (numTransitions == 0) {
+        QCC_LogError(ER_FAIL, ("%s: Transition list cannot be empty", __func__));
+        responseCode = LSF_ERR_INVALID_ARGS;
+    }
+
+    uint64_t timestamp = 0;
+    OEM_CS_GetSyncTimeStamp(timestamp);
+
+    TransitionStateParamsList stateParamsList;
+    stateParamsList.clear();
+
+    for (size_t i = 0; (i < numTransitions) && (LSF_OK == responseCode); i++) {
+        char* lampID;
+        MsgArg* stateArgs;
+        size_t stateArgsSize;
+        uint32_t transitionPeriod;
+        transitions[i].Get("(sa{sv}u)", &lampID, &stateArgsSize, &stateArgs, &transitionPeriod);
+
+        MsgArg stateArg;
+        stateArg.Set("a{sv}", stateArgsSize, stateArgs);
+        LampState state(stateArg);
+        QCC_DbgPrintf(("lampID=%s state=%s transitionPeriod=%d", lampID, state.c_str(), transitionPeriod));
+
+        if (state.nullState) {
+            QCC_LogError(ER_FAIL, ("%s: State for lamp %s cannot be NULL", __func__, lampID));
+            responseCode = LSF_ERR_INVALID_ARGS;
+        } else {
+            LSFStringList lampList;
+            lampList.push_back(LSFString(lampID));
+            MsgArg lampState;
+            state.Get(&lampState, true);
+            /*
+             * All the transitions share one timestamp so that the lamps start together
+             */
+            TransitionStateParams params(lampList, timestamp, lampState, transitionPeriod);
+            stateParamsList.push_back(params);
+        }
+    }
+
+    if (LSF_OK != responseCode) {
+        MsgArg replyArg("u", responseCode);
+        controllerService.SendMethodReply(message, &replyArg, 1);
+    } else {
+        lampClients.TransitionLampsToStates(message, stateParamsList);
+    }
+}
+
 void LampManager::PulseLampWithState(ajn::Message& message)
 {
     QCC_DbgPrintf(("%s: %s", __func__, message->ToString().c_str()));
@@ -0,0 +1,119 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/Debug.h>
+#include <LampStateSignalBatcher.h>
+#include <ControllerService.h>
+
+using namespace lsf;
+
+#define QCC_MODULE "LAMP_STATE_SIGNAL_BATCHER"
+
+LampStateSignalBatcher::LampStateSignalBatcher(ControllerService& service, uint32_t windowMs)
+    : service(service),
+    window(windowMs),
+    alarm(this)
+{
+    QCC_DbgTrace(("%s", __func__));
+}
+
+LampStateSignalBatcher::~LampStateSignalBatcher()
+{
+    QCC_DbgTrace(("%s", __func__));
+}
+
+void LampStateSignalBatcher::LampStateChanged(const LSFString& lampID, const LampState& state)
+{
+    QCC_DbgTrace(("%s: lampID=%s", __func__, lampID.c_str()));
+    bool flush = false;
+
+    pendingLock.Lock();
+    if (pendingStates.empty() && window) {
+        alarm.SetAlarmInMs(window);
+    }
+    pendingStates[lampID] = state;
+    /*
+     * Keep the signal well below the maximum AllJoyn message length
+     */
+    flush = (window == 0) || (pendingStates.size() >= OEM_CS_LAMP_STATE_SIGNAL_BATCH_MAX_LAMPS);
+    pendingLock.Unlock();
+
+    if (flush) {
+        Flush();
+    }
+}
+
+void LampStateSignalBatcher::SetWindow(uint32_t windowMs)
+{
+    QCC_DbgPrintf(("%s: windowMs=%u", __func__, windowMs));
+    pendingLock.Lock();
+    window = windowMs;
+    pendingLock.Unlock();
+
+    Flush();
+}
+
+void LampStateSignalBatcher::AlarmTriggered(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    Flush();
+}
+
+void LampStateSignalBatcher::Flush(void)
+{
+    LampStateMap states;
+
+    /*
+     * Flushes are serialized so that the batches go out in order
+     */
+    flushLock.Lock();
+    pendingLock.Lock();
+    states.swap(pendingStates);
+    pendingLock.Unlock();
+
+    if (states.empty()) {
+        flushLock.Unlock();
+        return;
+    }
+
+    QCC_DbgPrintf(("%s: Sending the state of %u lamps", __func__, (uint32_t) states.size()));
+
+    /*
+     * The batch goes first: an app that receives it ignores the per-lamp
+     * signals that follow
+     */
+    service.SendLampsStateChangedSignal(states);
+
+#if OEM_CS_SEND_PER_LAMP_STATE_SIGNAL
+    for (LampStateMap::const_iterator it = states.begin(); it != states.end(); ++it) {
+        service.SendStateChangedSignal(ControllerServiceLampInterfaceName, "LampStateChanged", it->first, it->second);
+    }
+#endif
+    flushLock.Unlock();
+}
+
+void LampStateSignalBatcher::Stop(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    alarm.Stop();
+    Flush();
+}
+
+void LampStateSignalBatcher::Join(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    alarm.Join();
+}
@@ -23,16 +23,11 @@
 #include <Thread.h>
 #include <LSFSemaphore.h>
 
+#include <map>
+#include <set>
 
-#define QCC_MODULE "LEADER_ELECTION"
-
-#define ELECTION_INTERVAL_IN_SECONDS 1
-
-#define LEADER_ANNOUNCEMENT_WAIT_INTERVAL_IN_SECONDS 2
-
-#define OVERTHROW_TIMEOUT_IN_SEC 5
 
-#define OVERTHROW_TIMEOUT_IN_M_SEC 5000
+#define QCC_MODULE "LEADER_ELECTION"
 
 bool g_IsLeader = false;
 
@@ -46,7 +41,9 @@ static const char* ControllerServiceInterface[] = {
 class LeaderElectionObject::Handler : public ajn::services::AnnounceHandler,
     public BusAttachment::JoinSessionAsyncCB,
     public BusAttachment::SetLinkTimeoutAsyncCB,
-    public SessionListener {
+    public SessionListener,
+    public ElectionStateMachine::Bus,
+    public ElectionStateMachine::Clock {
   public:
     Handler(LeaderElectionObject& elector) : elector(elector) { }
 
@@ -77,9 +74,110 @@ class LeaderElectionObject::Handler : public ajn::services::AnnounceHandler,
         elector.OnSessionLost(sessionId);
     }
 
+    virtual void SetIsLeader(bool isLeader) {
+        elector.controller.SetIsLeader(isLeader);
+        g_IsLeader = isLeader;
+    }
+
+    virtual void SetAllowUpdates(bool allow) {
+        elector.controller.SetAllowUpdates(allow);
+    }
+
+    virtual void ConnectToLamps(void) {
+        elector.controller.GetLampManager().ConnectToLamps();
+    }
+
+    virtual void DisconnectFromLamps(void) {
+        elector.controller.GetLampManager().DisconnectFromLamps();
+    }
+
+    virtual void UpdateHotStandby(bool standby);
+
+    virtual void LeaveSession(void) {
+        elector.controller.LeaveSession();
+    }
+
+    virtual bool JoinSession(const ElectionStateMachine::ControllerEntry& leader);
+
+    virtual void LeaveSessionAsync(uint32_t sessionId) {
+        elector.controller.DoLeaveSessionAsync(static_cast<ajn::SessionId>(sessionId));
+    }
+
+    virtual bool OnLeaderSessionJoined(const ElectionStateMachine::ControllerEntry& leader, uint32_t sessionId, bool overthrow) {
+        return elector.StartStateSync(leader, static_cast<ajn::SessionId>(sessionId), overthrow);
+    }
+
+    virtual void OnLeaderSessionCleared(void) {
+        elector.currentLeaderMutex.Lock();
+        elector.leaderProxy = ProxyBusObject();
+        elector.currentLeaderMutex.Unlock();
+    }
+
+    virtual void SendOverthrowReply(uint32_t callId, bool accepted);
+
+    virtual void SetAlarmInMs(uint32_t timeInMs) {
+        elector.electionAlarmMutex.Lock();
+        elector.electionAlarm.SetAlarmInMs(timeInMs);
+        elector.electionAlarmMutex.Unlock();
+    }
+
+    virtual void Wake(void) {
+        elector.wakeSem.Post();
+    }
+
+    virtual void SendHeartbeat(void) {
+        elector.controller.SendHeartbeat();
+    }
+
+    virtual uint64_t GetTimestampInMs(void) {
+        return lsf::GetTimestampInMs();
+    }
+
     LeaderElectionObject& elector;
 };
 
+void LeaderElectionObject::Handler::UpdateHotStandby(bool standby)
+{
+    LampManager& lampManager = elector.controller.GetLampManager();
+    if (standby && !lampManager.IsInStandby()) {
+        QCC_DbgPrintf(("%s: Entering hot standby", __func__));
+        lampManager.StandbyForLamps();
+    } else if (!standby && lampManager.IsInStandby()) {
+        QCC_DbgPrintf(("%s: Leaving hot standby", __func__));
+        lampManager.DisconnectFromLamps();
+    }
+}
+
+bool LeaderElectionObject::Handler::JoinSession(const ElectionStateMachine::ControllerEntry& leader)
+{
+    ElectionStateMachine::ControllerEntry* ctx = new ElectionStateMachine::ControllerEntry(leader);
+    SessionOpts opts;
+    opts.isMultipoint = true;
+    QStatus status = elector.bus.JoinSessionAsync(leader.busName.c_str(), leader.port, this, opts, this, ctx);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: JoinSessionAsync failed", __func__));
+        delete ctx;
+        return false;
+    }
+    return true;
+}
+
+void LeaderElectionObject::Handler::SendOverthrowReply(uint32_t callId, bool accepted)
+{
+    elector.overThrowListMutex.Lock();
+    std::map<uint32_t, ajn::Message>::iterator it = elector.overThrowCalls.find(callId);
+    if (it == elector.overThrowCalls.end()) {
+        elector.overThrowListMutex.Unlock();
+        return;
+    }
+    ajn::Message msg = it->second;
+    elector.overThrowCalls.erase(it);
+    elector.overThrowListMutex.Unlock();
+
+    MsgArg arg("b", accepted);
+    elector.controller.SendMethodReply(msg, &arg, 1);
+}
+
 void LeaderElectionObject::Handler::Announce(
     uint16_t version,
     uint16_t port,
@@ -131,33 +229,30 @@ void LeaderElectionObject::Handler::Announce(
         }
         ait->second.Get("b", &isLeader);
 
-        if ((rank > elector.GetRank()) || isLeader) {
-            QCC_DbgPrintf(("%s: Received a potential leader or existent leader announcement", __func__, busName, port));
-            elector.OnAnnounced(port, busName, rank, isLeader, deviceId);
-        }
+        elector.OnAnnounced(port, busName, rank, isLeader, deviceId);
     }
 }
 
 LeaderElectionObject::LeaderElectionObject(ControllerService& controller)
     : BusObject(LeaderElectionAndStateSyncObjectPath),
+    Thread("LeaderElection"),
     controller(controller),
     bus(controller.GetBusAttachment()),
     handler(new Handler(*this)),
-    myRank(),
+    election(*handler, *handler),
+    storesSynchronized(false),
+    heartbeatTimer(*this, OEM_CS_LEADER_HEARTBEAT_INTERVAL_MS),
+    heartbeatSequence(0),
+    nextOverthrowCallId(0),
     isRunning(false),
     blobChangedSignal(NULL),
-    electionAlarm(this),
-    alarmTriggered(false),
-    isLeader(false),
-    startElection(true),
-    okToSetAlarm(true),
-    gotOverthrowReply(false)
+    blobDeltaSignal(NULL),
+    blobChunkSignal(NULL),
+    heartbeatSignal(NULL),
+    nextTransferId(0),
+    electionAlarm(this)
 {
     QCC_DbgTrace(("%s", __func__));
-    currentLeader.Clear();
-    controllersMap.clear();
-    outGoingLeader.Clear();
-    upComingLeader.Clear();
     controller.SetAllowUpdates(false);
 }
 
@@ -174,6 +269,33 @@ LeaderElectionObject::~LeaderElectionObject()
         QCC_LogError(status, ("%s: Failed to unregister BlobChanged Handler", __func__));
     }
 
+    status = bus.UnregisterSignalHandler(
+        this,
+        static_cast<MessageReceiver::SignalHandler>(&LeaderElectionObject::OnBlobDelta),
+        blobDeltaSignal,
+        LeaderElectionAndStateSyncObjectPath);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to unregister BlobDelta Handler", __func__));
+    }
+
+    status = bus.UnregisterSignalHandler(
+        this,
+        static_cast<MessageReceiver::SignalHandler>(&LeaderElectionObject::OnBlobChunk),
+        blobChunkSignal,
+        LeaderElectionAndStateSyncObjectPath);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to unregister BlobChunk Handler", __func__));
+    }
+
+    status = bus.UnregisterSignalHandler(
+        this,
+        static_cast<MessageReceiver::SignalHandler>(&LeaderElectionObject::OnHeartbeat),
+        heartbeatSignal,
+        LeaderElectionAndStateSyncObjectPath);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to unregister Heartbeat Handler", __func__));
+    }
+
     electionAlarmMutex.Lock();
     electionAlarm.Stop();
     electionAlarm.Join();
@@ -187,57 +309,23 @@ LeaderElectionObject::~LeaderElectionObject()
 
 void LeaderElectionObject::OnAnnounced(ajn::SessionPort port, const char* busName, Rank rank, bool isLeader, const char* deviceId)
 {
-    QCC_DbgPrintf(("%s: (%u, %s, %s, %s)", __func__, port, busName, (isLeader ? "true" : "false"), rank.c_str()));
-
-    ControllerEntry newEntry;
-    newEntry.busName = busName;
-    newEntry.deviceId = deviceId;
-    newEntry.isLeader = isLeader;
-    newEntry.port = port;
-    newEntry.rank = rank;
-    newEntry.announcementTimestamp = GetTimestampInMs();
-
-    Rank lastTrackedRank = myRank;
-
-    controllersMapMutex.Lock();
-    if (controllersMap.size()) {
-        lastTrackedRank = (controllersMap.rbegin())->first;
-        QCC_DbgPrintf(("%s: Last tracked rank set to %s", __func__, lastTrackedRank.c_str()));
-    }
-    std::pair<ControllersMap::iterator, bool> ins = controllersMap.insert(std::make_pair(rank, newEntry));
-    if (ins.second == false) {
-        ins.first->second = newEntry;
-    }
-    controllersMapMutex.Unlock();
-
-    if (okToSetAlarm && (!isLeader)) {
-        if ((rank > lastTrackedRank) || (rank == lastTrackedRank)) {
-            electionAlarmMutex.Lock();
-            QCC_DbgPrintf(("%s: Reloading alarm", __func__));
-            electionAlarm.SetAlarm(LEADER_ANNOUNCEMENT_WAIT_INTERVAL_IN_SECONDS);
-            electionAlarmMutex.Unlock();
-        }
-    } else {
-        wakeSem.Post();
-    }
+    ElectionStateMachine::ControllerEntry entry;
+    entry.busName = busName;
+    entry.deviceId = deviceId;
+    entry.isLeader = isLeader;
+    entry.port = port;
+    entry.rank = rank;
+    election.OnAnnounced(entry);
 }
 
 void LeaderElectionObject::OnSessionLost(SessionId sessionId)
 {
-    QCC_DbgTrace(("%s: (%u)", __func__, sessionId));
-    sessionLostMutex.Lock();
-    sessionLostList.push_back(static_cast<uint32_t>(sessionId));
-    sessionLostMutex.Unlock();
-    wakeSem.Post();
+    election.OnSessionLost(static_cast<uint32_t>(sessionId));
 }
 
 void LeaderElectionObject::OnSessionMemberRemoved(SessionId sessionId, const char* uniqueName)
 {
-    QCC_DbgTrace(("%s: (%u, %s)", __func__, sessionId, uniqueName));
-    sessionMemberRemovedMutex.Lock();
-    sessionMemberRemoved.insert(std::make_pair(static_cast<uint32_t>(sessionId), uniqueName));
-    sessionMemberRemovedMutex.Unlock();
-    wakeSem.Post();
+    election.OnSessionMemberRemoved(static_cast<uint32_t>(sessionId), uniqueName);
 }
 
 void LeaderElectionObject::OnGetBlobReply(ajn::Message& message, void* context)
@@ -256,53 +344,301 @@ void LeaderElectionObject::OnGetBlobReply(ajn::Message& message, void* context)
             return;
         }
 
+        /*
+         * An empty blob is either an empty store or a blob that follows in BlobChunk signals
+         */
         if (args[1].v_string.len) {
-            switch (args[0].v_uint32) {
-            case LSF_PRESET:
-                controller.GetPresetManager().HandleReceivedBlob(args[1].v_string.str, args[2].v_uint32, args[3].v_uint64);
-                break;
-
-            case LSF_MASTER_SCENE:
-                controller.GetMasterSceneManager().HandleReceivedBlob(args[1].v_string.str, args[2].v_uint32, args[3].v_uint64);
-                break;
+            HandleReceivedBlob(static_cast<LSFBlobType>(args[0].v_uint32), args[1].v_string.str, args[2].v_uint32, args[3].v_uint64);
+        }
+    }
 
-            case LSF_LAMP_GROUP:
-                controller.GetLampGroupManager().HandleReceivedBlob(args[1].v_string.str, args[2].v_uint32, args[3].v_uint64);
-                break;
+    FinishSynchronization(static_cast<Synchronization*>(context));
+}
 
-            case LSF_SCENE:
-                controller.GetSceneManager().HandleReceivedBlob(args[1].v_string.str, args[2].v_uint32, args[3].v_uint64);
-                break;
-            }
-        }
+void LeaderElectionObject::FinishSynchronization(Synchronization* sync)
+{
+    /*
+     * No synchronization context for a blob requested after a missed delta
+     */
+    if (!sync) {
+        return;
     }
 
-    Synchronization* sync = static_cast<Synchronization*>(context);
     if (0 == qcc::DecrementAndFetch(&sync->numWaiting)) {
         // we're finished synchronizing!
         QCC_DbgPrintf(("Finished synchronizing!"));
         delete sync;
 
-        ControllerEntry outGoingLeaderCopy;
-        outGoingLeaderMutex.Lock();
-        outGoingLeaderCopy = outGoingLeader;
-        outGoingLeaderMutex.Unlock();
+        currentLeaderMutex.Lock();
+        storesSynchronized = true;
+        currentLeaderMutex.Unlock();
+
+        if (election.IsOverthrowing()) {
+            if (CallLeaderMethod("Overthrow", static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnOverthrowReply), NULL, 0, NULL) != ER_OK) {
+                election.OnOverthrowReply();
+            }
+        }
+    }
+}
 
-        if (!outGoingLeaderCopy.busName.empty()) {
-            QStatus status = currentLeader.proxyObj.MethodCallAsync(
-                LeaderElectionAndStateSyncInterfaceName,
-                "Overthrow",
-                this,
-                static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnOverthrowReply),
-                NULL, 0, NULL, OVERTHROW_TIMEOUT_IN_M_SEC);
+QStatus LeaderElectionObject::CallLeaderMethod(const char* method, MessageReceiver::ReplyHandler handler, const MsgArg* args, size_t numArgs, void* context)
+{
+    QCC_DbgTrace(("%s: %s", __func__, method));
+    QStatus status = ER_FAIL;
 
-            if (status != ER_OK) {
-                QCC_LogError(status, ("%s: MethodCallAsync for Overthrow failed", __func__));
-                gotOverthrowReply = true;
-                wakeSem.Post();
+    currentLeaderMutex.Lock();
+    if (leaderProxy.IsValid()) {
+        status = leaderProxy.MethodCallAsync(
+            LeaderElectionAndStateSyncInterfaceName,
+            method,
+            this,
+            handler,
+            args,
+            numArgs,
+            context,
+            OVERTHROW_TIMEOUT_IN_M_SEC);
+    }
+    currentLeaderMutex.Unlock();
+
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: MethodCallAsync for %s failed", __func__, method));
+    }
+    return status;
+}
+
+QStatus LeaderElectionObject::StartReconciliation(LSFBlobType type, Synchronization* sync)
+{
+    QCC_DbgPrintf(("%s: type=%d", __func__, type));
+    Reconciliation* reconciliation = new Reconciliation();
+    reconciliation->type = type;
+    reconciliation->sync = sync;
+    reconciliation->level = 0;
+    reconciliation->nodes.push_back(0);
+
+    QStatus status = ContinueReconciliation(reconciliation);
+    if (status != ER_OK) {
+        delete reconciliation;
+    }
+    return status;
+}
+
+QStatus LeaderElectionObject::ContinueReconciliation(Reconciliation* reconciliation)
+{
+    QCC_DbgPrintf(("%s: type=%d level=%u nodes=%u", __func__, reconciliation->type, reconciliation->level, (uint32_t) reconciliation->nodes.size()));
+    const std::vector<uint32_t>& nodes = reconciliation->nodes;
+
+    if (reconciliation->level < StoreHashTree::DEPTH) {
+        MsgArg args[3];
+        args[0].Set("u", static_cast<uint32_t>(reconciliation->type));
+        args[1].Set("u", reconciliation->level);
+        args[2].Set("au", nodes.size(), &nodes[0]);
+        return CallLeaderMethod("GetHashTreeNodes", static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnGetHashTreeNodesReply),
+                                args, 3, reconciliation);
+    }
+
+    MsgArg args[2];
+    args[0].Set("u", static_cast<uint32_t>(reconciliation->type));
+    args[1].Set("au", nodes.size(), &nodes[0]);
+    return CallLeaderMethod("GetEntityHashes", static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnGetEntityHashesReply),
+                            args, 2, reconciliation);
+}
+
+void LeaderElectionObject::OnGetHashTreeNodesReply(ajn::Message& message, void* context)
+{
+    QCC_DbgTrace(("%s", __func__));
+    bus.EnableConcurrentCallbacks();
+    Reconciliation* reconciliation = static_cast<Reconciliation*>(context);
+
+    if (message->GetType() != ajn::MESSAGE_METHOD_RET) {
+        QCC_LogError(ER_FAIL, ("%s: GetHashTreeNodes failed", __func__));
+        FinishReconciliation(reconciliation, true);
+        return;
+    }
+
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controller.CheckNumArgsInMessage(numArgs, 3)  != LSF_OK) {
+        FinishReconciliation(reconciliation, true);
+        return;
+    }
+
+    uint64_t* hashes;
+    size_t numHashes;
+    args[2].Get("at", &numHashes, &hashes);
+
+    const std::vector<uint32_t>& nodes = reconciliation->nodes;
+    if ((args[0].v_uint32 != static_cast<uint32_t>(reconciliation->type)) || (args[1].v_uint32 != reconciliation->level) ||
+        (numHashes != (nodes.size() * StoreHashTree::FANOUT))) {
+        QCC_LogError(ER_FAIL, ("%s: Unexpected reply", __func__));
+        FinishReconciliation(reconciliation, true);
+        return;
+    }
+
+    std::vector<uint64_t> myHashes;
+    GetLocalHashTreeNodes(reconciliation->type, reconciliation->level, nodes, myHashes);
+
+    std::vector<uint32_t> children;
+    for (size_t i = 0; i < numHashes; i++) {
+        if (hashes[i] != myHashes[i]) {
+            children.push_back((nodes[i / StoreHashTree::FANOUT] * StoreHashTree::FANOUT) + (i % StoreHashTree::FANOUT));
+        }
+    }
+
+    if (children.empty()) {
+        QCC_DbgPrintf(("%s: Stores of type %d are in sync", __func__, reconciliation->type));
+        FinishReconciliation(reconciliation, false);
+        return;
+    }
+
+    reconciliation->nodes.swap(children);
+    reconciliation->level++;
+    if (ContinueReconciliation(reconciliation) != ER_OK) {
+        FinishReconciliation(reconciliation, true);
+    }
+}
+
+void LeaderElectionObject::OnGetEntityHashesReply(ajn::Message& message, void* context)
+{
+    QCC_DbgTrace(("%s", __func__));
+    bus.EnableConcurrentCallbacks();
+    Reconciliation* reconciliation = static_cast<Reconciliation*>(context);
+
+    if (message->GetType() != ajn::MESSAGE_METHOD_RET) {
+        QCC_LogError(ER_FAIL, ("%s: GetEntityHashes failed", __func__));
+        FinishReconciliation(reconciliation, true);
+        return;
+    }
+
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if ((controller.CheckNumArgsInMessage(numArgs, 2)  != LSF_OK) || (args[0].v_uint32 != static_cast<uint32_t>(reconciliation->type))) {
+        FinishReconciliation(reconciliation, true);
+        return;
+    }
+
+    StoreEntityHashList myEntities;
+    GetLocalEntityHashes(reconciliation->type, reconciliation->nodes, myEntities);
+    std::map<std::string, uint64_t> myHashes(myEntities.begin(), myEntities.end());
+
+    MsgArg* entityArray;
+    size_t numEntities;
+    args[1].Get("a(st)", &numEntities, &entityArray);
+
+    for (size_t i = 0; i < numEntities; i++) {
+        char* id;
+        uint64_t hash;
+        entityArray[i].Get("(st)", &id, &hash);
+
+        std::map<std::string, uint64_t>::iterator it = myHashes.find(id);
+        if (it == myHashes.end()) {
+            reconciliation->ids.push_back(id);
+        } else {
+            if (it->second != hash) {
+                reconciliation->ids.push_back(id);
             }
+            myHashes.erase(it);
+        }
+    }
+
+    for (std::map<std::string, uint64_t>::iterator it = myHashes.begin(); it != myHashes.end(); ++it) {
+        StoreJournalRecord record = { StoreJournal::RECORD_DELETE, it->first, std::string(), 0, 0, 0 };
+        reconciliation->deletes.push_back(record);
+    }
+
+    QCC_DbgPrintf(("%s: type=%d buckets=%u fetch=%u delete=%u", __func__, reconciliation->type, (uint32_t) reconciliation->nodes.size(),
+                   (uint32_t) reconciliation->ids.size(), (uint32_t) reconciliation->deletes.size()));
+
+    if (reconciliation->ids.empty()) {
+        HandleReconciledEntities(reconciliation->type, reconciliation->deletes);
+        FinishReconciliation(reconciliation, false);
+        return;
+    }
+
+    std::vector<const char*> ids;
+    ids.reserve(reconciliation->ids.size());
+    for (LSFStringList::const_iterator it = reconciliation->ids.begin(); it != reconciliation->ids.end(); ++it) {
+        ids.push_back(it->c_str());
+    }
+
+    MsgArg outArgs[2];
+    outArgs[0].Set("u", static_cast<uint32_t>(reconciliation->type));
+    outArgs[1].Set("as", ids.size(), &ids[0]);
+    if (CallLeaderMethod("GetEntities", static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnGetEntitiesReply),
+                         outArgs, 2, reconciliation) != ER_OK) {
+        FinishReconciliation(reconciliation, true);
+    }
+}
+
+void LeaderElectionObject::OnGetEntitiesReply(ajn::Message& message, void* context)
+{
+    QCC_DbgTrace(("%s", __func__));
+    bus.EnableConcurrentCallbacks();
+    Reconciliation* reconciliation = static_cast<Reconciliation*>(context);
+
+    if (message->GetType() != ajn::MESSAGE_METHOD_RET) {
+        QCC_LogError(ER_FAIL, ("%s: GetEntities failed", __func__));
+        FinishReconciliation(reconciliation, true);
+        return;
+    }
+
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if ((controller.CheckNumArgsInMessage(numArgs, 2)  != LSF_OK) || (args[0].v_uint32 != static_cast<uint32_t>(reconciliation->type))) {
+        FinishReconciliation(reconciliation, true);
+        return;
+    }
+
+    MsgArg* entityArray;
+    size_t numEntities;
+    args[1].Get("a(ss)", &numEntities, &entityArray);
+
+    StoreJournalRecordList records;
+    std::set<std::string> fetched;
+    for (size_t i = 0; i < numEntities; i++) {
+        char* id;
+        char* data;
+        entityArray[i].Get("(ss)", &id, &data);
+        StoreJournalRecord record = { StoreJournal::RECORD_UPDATE, id, data, 0, 0, 0 };
+        records.push_back(record);
+        fetched.insert(record.id);
+    }
+
+    /*
+     * An entity deleted on the leader since GetEntityHashes is deleted here too
+     */
+    for (LSFStringList::const_iterator it = reconciliation->ids.begin(); it != reconciliation->ids.end(); ++it) {
+        if (fetched.find(*it) == fetched.end()) {
+            StoreJournalRecord record = { StoreJournal::RECORD_DELETE, *it, std::string(), 0, 0, 0 };
+            records.push_back(record);
+        }
+    }
+    records.insert(records.end(), reconciliation->deletes.begin(), reconciliation->deletes.end());
+
+    HandleReconciledEntities(reconciliation->type, records);
+    FinishReconciliation(reconciliation, false);
+}
+
+void LeaderElectionObject::FinishReconciliation(Reconciliation* reconciliation, bool fetchBlob)
+{
+    LSFBlobType type = reconciliation->type;
+    Synchronization* sync = reconciliation->sync;
+    delete reconciliation;
+
+    if (fetchBlob) {
+        QCC_DbgPrintf(("%s: Fetching the whole blob of type %d", __func__, type));
+        MsgArg arg("u", type);
+        if (CallLeaderMethod("GetBlob", static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnGetBlobReply), &arg, 1, sync) == ER_OK) {
+            return;
         }
     }
+
+    FinishSynchronization(sync);
 }
 
 void LeaderElectionObject::OnGetChecksumAndModificationTimestampReply(ajn::Message& message, void* context)
@@ -357,19 +693,21 @@ void LeaderElectionObject::OnGetChecksumAndModificationTimestampReply(ajn::Messa
             QCC_DbgPrintf(("%s: type=%d checksum=%u timestamp=%llu", __func__, type, checksum, timestamp));
             QCC_DbgPrintf(("%s: type=%d myChecksum=%u myTimestamp=%llu GetTimestampInMs=%llu", __func__, type, myChecksum, myTimestamp, currentTimeStamp));
 
-            if ((myTimestamp != 0) && ((timestamp == 0) || ((currentTimeStamp - myTimestamp) < timestamp)) && (myChecksum != 0)) {
+            /*
+             * The checksums are the roots of the hash trees of the stores: equal
+             * stores are left alone whatever their ages, and when the ages tie the
+             * store of the leader wins so that the stores do not flip-flop
+             */
+            if (myChecksum == checksum) {
+                QCC_DbgPrintf(("%s: Stores are in sync", __func__));
+            } else if ((myTimestamp != 0) && ((timestamp == 0) || ((currentTimeStamp - myTimestamp) < timestamp))) {
                 QCC_DbgPrintf(("%s: Need to send a blob!", __func__));
                 storesToSend.push_back(type);
-            } else {
-                QCC_DbgPrintf(("%s: No need to send blob!", __func__));
-            }
-
-            myTimestamp = currentTimeStamp - myTimestamp;
-            if ((timestamp != 0) && (myTimestamp > timestamp) && (checksum != 0)) {
-                QCC_DbgPrintf(("%s: Need to fetch blob!", __func__));
+            } else if (timestamp != 0) {
+                QCC_DbgPrintf(("%s: Need to reconcile the store!", __func__));
                 storesToFetch.push_back(type);
             } else {
-                QCC_DbgPrintf(("%s: No need to fetch blob!", __func__));
+                QCC_DbgPrintf(("%s: No need to send or fetch blob!", __func__));
             }
         }
 
@@ -415,26 +753,7 @@ void LeaderElectionObject::OnGetChecksumAndModificationTimestampReply(ajn::Messa
             uint8_t methodCallFailCount = 0;
 
             for (std::list<LSFBlobType>::iterator it = storesToFetch.begin(); it != storesToFetch.end(); ++it) {
-                LSFBlobType type = *it;
-                MsgArg arg("u", type);
-
-                QStatus status = ER_OK;
-
-                currentLeaderMutex.Lock();
-                if (currentLeader.proxyObj.IsValid()) {
-                    status = currentLeader.proxyObj.MethodCallAsync(
-                        LeaderElectionAndStateSyncInterfaceName,
-                        "GetBlob",
-                        this,
-                        static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnGetBlobReply),
-                        &arg,
-                        1,
-                        sync,
-                        OVERTHROW_TIMEOUT_IN_M_SEC);
-                } else {
-                    status = ER_FAIL;
-                }
-                currentLeaderMutex.Unlock();
+                QStatus status = StartReconciliation(*it, sync);
                 if (status != ER_OK) {
                     methodCallFailCount++;
                     qcc::DecrementAndFetch(&sync->numWaiting);
@@ -445,26 +764,25 @@ void LeaderElectionObject::OnGetChecksumAndModificationTimestampReply(ajn::Messa
             if (methodCallFailCount == storesToFetch.size()) {
                 QCC_LogError(ER_FAIL, ("%s: All Method Call Asyncs failed", __func__));
                 delete sync;
-                gotOverthrowReply = true;
-                wakeSem.Post();
+                election.OnOverthrowReply();
             }
         } else {
             QCC_DbgTrace(("%s: Nothing to fetch", __func__));
-            gotOverthrowReply = true;
-            wakeSem.Post();
+            currentLeaderMutex.Lock();
+            storesSynchronized = true;
+            currentLeaderMutex.Unlock();
+            election.OnOverthrowReply();
         }
     } else {
         QCC_DbgTrace(("%s: GetChecksumAndModificationTimestamp method call timed out", __func__));
-        gotOverthrowReply = true;
-        wakeSem.Post();
+        election.OnOverthrowReply();
     }
 }
 
 void LeaderElectionObject::AlarmTriggered(void)
 {
     QCC_DbgPrintf(("%s", __func__));
-    alarmTriggered = true;
-    wakeSem.Post();
+    election.AlarmTriggered();
 }
 
 void LeaderElectionObject::Connected(void)
@@ -489,6 +807,11 @@ void LeaderElectionObject::Connected(void)
         if (status != ER_OK) {
             isRunning = false;
             QCC_LogError(status, ("%s: Unable to start Run() thread", __func__));
+        } else {
+            status = heartbeatTimer.Start();
+            if (status != ER_OK) {
+                QCC_LogError(status, ("%s: Unable to start the heartbeat timer. Leader failures will only be detected by the link timeout", __func__));
+            }
         }
     }
     wakeSem.Post();
@@ -510,59 +833,48 @@ void LeaderElectionObject::Disconnected(void)
     connectionStateMutex.Unlock();
 }
 
-void LeaderElectionObject::ClearState(void)
+bool LeaderElectionObject::StartStateSync(const ElectionStateMachine::ControllerEntry& leader, ajn::SessionId sessionId, bool overthrow)
 {
-    QCC_DbgPrintf(("%s", __func__));
-
-    /* Clean up all the stale data */
-    overThrowListMutex.Lock();
-    overThrowList.clear();
-    overThrowListMutex.Unlock();
-
-    upComingLeaderMutex.Lock();
-    upComingLeader.Clear();
-    upComingLeaderMutex.Unlock();
-
-    electionAlarmMutex.Lock();
-    electionAlarm.SetAlarm(0);
-    electionAlarmMutex.Unlock();
-
-    controllersMapMutex.Lock();
-    controllersMap.clear();
-    controllersMapMutex.Unlock();
-
-    alarmTriggered = false;
-    gotOverthrowReply = false;
-    okToSetAlarm = true;
-    startElection = true;
+    QCC_DbgPrintf(("%s: (sessionId=%u, overthrow=%d)", __func__, sessionId, overthrow));
+    QStatus status = ER_OK;
 
     currentLeaderMutex.Lock();
-    currentLeader.Clear();
-    currentLeaderMutex.Unlock();
-
-    outGoingLeaderMutex.Lock();
-    outGoingLeader.Clear();
-    outGoingLeaderMutex.Unlock();
-
-    failedJoinSessionMutex.Lock();
-    failedJoinSessions.clear();
-    failedJoinSessionMutex.Unlock();
-
-    sessionAlreadyJoinedRepliesMutex.Lock();
-    sessionAlreadyJoinedReplies.clear();
-    sessionAlreadyJoinedRepliesMutex.Unlock();
+    leaderProxy = ProxyBusObject(bus, leader.busName.c_str(), LeaderElectionAndStateSyncObjectPath, sessionId);
+    const InterfaceDescription* stateSyncInterface = bus.GetInterface(LeaderElectionAndStateSyncInterfaceName);
+    leaderProxy.AddInterface(*stateSyncInterface);
+    storesSynchronized = false;
 
-    successfulJoinSessionMutex.Lock();
-    successfulJoinSessions.clear();
-    successfulJoinSessionMutex.Unlock();
+    if (overthrow) {
+        /*
+         * Try to get current state from outgoing leader
+         */
+        status = leaderProxy.MethodCallAsync(
+            LeaderElectionAndStateSyncInterfaceName,
+            "GetChecksumAndModificationTimestamp",
+            this,
+            static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnGetChecksumAndModificationTimestampReply),
+            NULL, 0, NULL, OVERTHROW_TIMEOUT_IN_M_SEC);
+    } else {
+        // we don't need to wait for this
+        status = bus.SetLinkTimeoutAsync(sessionId, LSF_MIN_LINK_TIMEOUT_IN_SECONDS, handler, NULL);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("%s: SetLinkTimeoutAsync failed", __func__));
+        }
 
-    sessionLostMutex.Lock();
-    sessionLostList.clear();
-    sessionLostMutex.Unlock();
+        status = leaderProxy.MethodCallAsync(
+            LeaderElectionAndStateSyncInterfaceName,
+            "GetChecksumAndModificationTimestamp",
+            this,
+            static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnGetChecksumAndModificationTimestampReply),
+            NULL,
+            0);
+    }
+    currentLeaderMutex.Unlock();
 
-    sessionMemberRemovedMutex.Lock();
-    sessionMemberRemoved.clear();
-    sessionMemberRemovedMutex.Unlock();
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: MethodCallAsync for GetChecksumAndModificationTimestamp failed", __func__));
+    }
+    return (status == ER_OK);
 }
 
 void LeaderElectionObject::Run(void)
@@ -573,695 +885,35 @@ void LeaderElectionObject::Run(void)
         wakeSem.Wait();
         QCC_DbgPrintf(("%s: wakeSem posted", __func__));
 
+        /*
+         * Each post is an event that the election has to look at
+         */
+        Thread::RecordWakeup(true);
+
         /*
          * We are shutting down. So announce self as non-leader before going away
          */
         if (!isRunning) {
-            if (isLeader) {
-                controller.LeaveSession();
-                controller.GetLampManager().DisconnectFromLamps();
-                controller.SetAllowUpdates(false);
-                controller.SetIsLeader(false);
-                isLeader = false;
-                g_IsLeader = false;
-            } else {
-                ajn::SessionId sessionId = 0;
-                currentLeaderMutex.Lock();
-                sessionId = currentLeader.proxyObj.GetSessionId();
-                currentLeader.Clear();
-                currentLeaderMutex.Unlock();
-
-                if (sessionId) {
-                    QCC_DbgPrintf(("%s: Tearing down session with current leader", __func__));
-                    controller.DoLeaveSessionAsync(sessionId);
-                }
-            }
-
-            ClearState();
+            election.Shutdown();
 
-            goto _Exit;
+            overThrowListMutex.Lock();
+            overThrowCalls.clear();
+            overThrowListMutex.Unlock();
+            break;
         }
 
-        bool loopBack = true;
-
-        while (loopBack) {
-            loopBack = false;
-            if (isLeader) {
-                QCC_DbgPrintf(("%s: I am the leader", __func__));
-
-                bool overThrown = false;
-                bool leaderFound = false;
-
-                OverThrowList overThrowListCopy;
-                overThrowListMutex.Lock();
-                overThrowListCopy = overThrowList;
-                overThrowList.clear();
-                overThrowListMutex.Unlock();
-
-                ControllerEntry upcomingLeaderCopy;
-                upComingLeaderMutex.Lock();
-                upcomingLeaderCopy = upComingLeader;
-                upComingLeaderMutex.Unlock();
-
-                MsgArg arg;
-                while (overThrowListCopy.size()) {
-                    if ((0 == strcmp(overThrowListCopy.front()->GetSender(), upcomingLeaderCopy.busName.c_str()))) {
-                        arg.Set("b", true);
-                        overThrown = true;
-                        controller.LeaveSession();
-                        QCC_DbgPrintf(("%s: Announcing self as non-leader after a successful overthrow", __func__));
-                        controller.GetLampManager().DisconnectFromLamps();
-                        controller.SetAllowUpdates(false);
-                        controller.SetIsLeader(false);
-                        isLeader = false;
-                        g_IsLeader = false;
-
-                        upComingLeaderMutex.Lock();
-                        upComingLeader.Clear();
-                        upComingLeaderMutex.Unlock();
-
-                        electionAlarmMutex.Lock();
-                        electionAlarm.SetAlarm(0);
-                        electionAlarmMutex.Unlock();
-                        /*
-                         * Loopback so that we now become a follower to the new leader
-                         */
-                        loopBack = true;
-                    } else {
-                        arg.Set("b", false);
-                    }
-                    controller.SendMethodReply(overThrowListCopy.front(), &arg, 1);
-                    overThrowListCopy.pop_front();
-                }
-
-                if (!overThrown) {
-                    ControllersMap::reverse_iterator rit;
-                    /*
-                     * Check to see if we found another leader announcement
-                     */
-                    ControllerEntry controllerDetails;
-                    controllersMapMutex.Lock();
-                    for (rit = controllersMap.rbegin(); rit != controllersMap.rend(); rit++) {
-                        if (rit->second.isLeader) {
-                            leaderFound = true;
-                            controllerDetails = rit->second;
-                            break;
-                        }
-                    }
-                    controllersMapMutex.Unlock();
-
-                    if (leaderFound && (myRank < controllerDetails.rank)) {
-                        /*
-                         * We are being overthrown but we did not know about it as the new leader was probably not
-                         * successful in connecting to us. Tear down our session and announce as a non-leader
-                         */
-                        controller.LeaveSession();
-                        QCC_DbgPrintf(("%s: Announcing self as non-leader because I saw another leader announcement", __func__));
-                        controller.GetLampManager().DisconnectFromLamps();
-                        controller.SetAllowUpdates(false);
-                        controller.SetIsLeader(false);
-                        isLeader = false;
-                        g_IsLeader = false;
-
-                        upComingLeaderMutex.Lock();
-                        upComingLeader.Clear();
-                        upComingLeaderMutex.Unlock();
-
-                        electionAlarmMutex.Lock();
-                        electionAlarm.SetAlarm(0);
-                        electionAlarmMutex.Unlock();
-                        /*
-                         * Loopback so that we now become a follower to the new leader
-                         */
-                        loopBack = true;
-                    } else {
-                        /*
-                         * Check if some one is in the process of performing a coup on us
-                         */
-                        ControllerEntry upcomingLeaderCopy;
-                        upComingLeaderMutex.Lock();
-                        upcomingLeaderCopy = upComingLeader;
-                        upComingLeaderMutex.Unlock();
-
-                        controllersMapMutex.Lock();
-                        for (rit = controllersMap.rbegin(); rit != controllersMap.rend(); rit++) {
-                            if ((rit->second.rank > myRank) && (0 != strcmp(upcomingLeaderCopy.busName.c_str(), rit->second.busName.c_str()))) {
-                                upComingLeaderMutex.Lock();
-                                upComingLeader = rit->second;
-                                upComingLeaderMutex.Unlock();
-                                controller.SetAllowUpdates(false);
-                                /*
-                                 * Set an alarm to take necessary action if the coup does not go through
-                                 */
-                                electionAlarmMutex.Lock();
-                                QCC_DbgPrintf(("%s: Extended overthrow alarm", __func__));
-                                electionAlarm.SetAlarm(OVERTHROW_TIMEOUT_IN_SEC);
-                                electionAlarmMutex.Unlock();
-                                QCC_DbgPrintf(("%s: Identified upcoming leader %s", __func__, upComingLeader.busName.c_str()));
-                                break;
-                            }
-                        }
-                        controllersMapMutex.Unlock();
-                    }
-
-                    if (alarmTriggered) {
-                        alarmTriggered = false;
-                        if (!overThrown && !leaderFound) {
-                            QCC_DbgPrintf(("%s: Upcoming leader %s failed to take over", __func__, upComingLeader.busName.c_str()));
-                            controllersMapMutex.Lock();
-                            ControllersMap::iterator it = controllersMap.find(upComingLeader.rank);
-                            if (it != controllersMap.end()) {
-                                if (it->second.isLeader) {
-                                    /*
-                                     * The leader announcement came through just as we were going to timeout.
-                                     * So loopback
-                                     */
-                                    loopBack = true;
-                                } else {
-                                    if (upComingLeader.announcementTimestamp == it->second.announcementTimestamp) {
-                                        controllersMap.erase(it);
-                                    }
-                                    upComingLeaderMutex.Lock();
-                                    upComingLeader.Clear();
-                                    upComingLeaderMutex.Unlock();
-
-                                    controller.SetAllowUpdates(true);
-                                }
-                            }
-                            controllersMapMutex.Unlock();
-                        }
-                    }
-                }
-            } else {
-                if (gotOverthrowReply && (outGoingLeader.rank.IsInitialized())) {
-                    QCC_DbgPrintf(("%s: gotOverthrowReply", __func__));
-                    gotOverthrowReply = false;
-
-                    ajn::SessionId sessionId = 0;
-                    currentLeaderMutex.Lock();
-                    sessionId = currentLeader.proxyObj.GetSessionId();
-                    currentLeader.Clear();
-                    currentLeaderMutex.Unlock();
-
-                    if (sessionId) {
-                        QCC_DbgPrintf(("%s: Tearing down session with current leader", __func__));
-                        controller.DoLeaveSessionAsync(sessionId);
-                    }
-                    /*
-                     * Coup was successful. Take over as leader
-                     */
-                    controllersMapMutex.Lock();
-                    ControllersMap::iterator it = controllersMap.find(outGoingLeader.rank);
-                    if ((it != controllersMap.end()) && (it->second.isLeader) && (it->second.announcementTimestamp == outGoingLeader.announcementTimestamp)) {
-                        QCC_DbgPrintf(("%s: Removed outgoing leader with rank %s from controllersMap", __func__, outGoingLeader.rank.c_str()));
-                        controllersMap.erase(it);
-                    }
-                    controllersMapMutex.Unlock();
-
-                    outGoingLeaderMutex.Lock();
-                    outGoingLeader.Clear();
-                    outGoingLeaderMutex.Unlock();
-
-                    QCC_DbgPrintf(("%s: Announcing self as leader", __func__));
-                    controller.GetLampManager().ConnectToLamps();
-                    controller.SetAllowUpdates(true);
-                    controller.SetIsLeader(true);
-                    isLeader = true;
-                    g_IsLeader = true;
-                    okToSetAlarm = false;
-                    electionAlarmMutex.Lock();
-                    electionAlarm.SetAlarm(0);
-                    electionAlarmMutex.Unlock();
-                } else if (startElection) {
-                    QCC_DbgPrintf(("%s: startElection", __func__));
-                    startElection = false;
-                    QCC_DbgPrintf(("%s: Announcing self as non-leader", __func__));
-                    controller.SetAllowUpdates(false);
-                    controller.GetLampManager().DisconnectFromLamps();
-                    controller.SetIsLeader(false);
-                    electionAlarmMutex.Lock();
-                    electionAlarm.SetAlarm(ELECTION_INTERVAL_IN_SECONDS);
-                    electionAlarmMutex.Unlock();
-                } else {
-                    QCC_DbgPrintf(("%s: Third loop", __func__));
-                    bool connectingToLeader = false;
-                    bool lookingForALeader = false;
-
-                    /*
-                     * Find out if we are already connected to or trying to connect to a
-                     * Leader
-                     */
-                    currentLeaderMutex.Lock();
-                    if (!(currentLeader.controllerDetails.rank.IsInitialized())) {
-                        lookingForALeader = true;
-                    } else {
-                        if (!(currentLeader.proxyObj.IsValid())) {
-                            connectingToLeader = true;
-                        }
-                    }
-                    currentLeaderMutex.Unlock();
-
-                    if (lookingForALeader) {
-                        QCC_DbgPrintf(("%s: lookingForALeader", __func__));
-                        ControllersMap::reverse_iterator rit;
-                        /*
-                         * Check to see if we found a leader
-                         */
-                        ControllerEntry controllerDetails;
-                        bool leaderFound = false;
-                        controllersMapMutex.Lock();
-                        for (rit = controllersMap.rbegin(); rit != controllersMap.rend(); rit++) {
-                            if (rit->second.isLeader) {
-                                leaderFound = true;
-                                controllerDetails = rit->second;
-                                break;
-                            }
-                        }
-                        controllersMapMutex.Unlock();
-
-                        if (leaderFound) {
-                            QCC_DbgPrintf(("%s: Found an entry with rank=%s and leader bit set", __func__, rit->second.rank.c_str()));
-                            /*
-                             * Check if we need to perform a coup
-                             */
-                            if (myRank > controllerDetails.rank) {
-                                outGoingLeaderMutex.Lock();
-                                outGoingLeader = controllerDetails;
-                                outGoingLeaderMutex.Unlock();
-                            }
-                            /*
-                             * We found a leader. Try JoinSessionAsync with the leader
-                             * and turn off the alarm if the call is successful
-                             */
-                            okToSetAlarm = false;
-
-                            currentLeaderMutex.Lock();
-                            currentLeader.Clear();
-                            currentLeader.controllerDetails = controllerDetails;
-                            currentLeaderMutex.Unlock();
-
-                            ControllerEntry* ctx = new ControllerEntry();
-                            *ctx = controllerDetails;
-                            SessionOpts opts;
-                            opts.isMultipoint = true;
-                            QStatus status = bus.JoinSessionAsync(controllerDetails.busName.c_str(), controllerDetails.port, handler, opts, handler, ctx);
-                            if (status != ER_OK) {
-                                QCC_LogError(status, ("%s: JoinSessionAsync failed", __func__));
-                                delete ctx;
-
-                                controllersMapMutex.Lock();
-                                ControllersMap::iterator fit = controllersMap.find(controllerDetails.rank);
-                                if (controllerDetails.announcementTimestamp == fit->second.announcementTimestamp) {
-                                    controllersMap.erase(fit);
-                                }
-                                controllersMapMutex.Unlock();
-
-                                currentLeaderMutex.Lock();
-                                currentLeader.Clear();
-                                currentLeaderMutex.Unlock();
-                            } else {
-                                QCC_DbgPrintf(("%s: JoinSessionAsync successful", __func__));
-                                electionAlarmMutex.Lock();
-                                electionAlarm.SetAlarm(0);
-                                electionAlarmMutex.Unlock();
-                            }
-                        } else {
-                            bool takeOverAsLeader = false;
-                            /*
-                             * Check if we need to take over as the leader
-                             */
-                            controllersMapMutex.Lock();
-                            /*
-                             * If controllersMap is empty, we are the highest ranking Controller Service or
-                             * if controllersMap has only one entry which does not have the leader bit set,
-                             * we need to take over as the leader
-                             */
-                            if (controllersMap.empty() || ((controllersMap.size() == 1) && (!((controllersMap.begin())->second.isLeader)))) {
-                                takeOverAsLeader = true;
-                                controllersMap.clear();
-                                alarmTriggered = false;
-                            }
-                            controllersMapMutex.Unlock();
-
-                            if (takeOverAsLeader) {
-                                QCC_DbgPrintf(("%s: Announcing self as leader", __func__));
-                                controller.GetLampManager().ConnectToLamps();
-                                controller.SetAllowUpdates(true);
-                                controller.SetIsLeader(true);
-                                isLeader = true;
-                                g_IsLeader = true;
-                                okToSetAlarm = false;
-                                electionAlarmMutex.Lock();
-                                electionAlarm.SetAlarm(0);
-                                electionAlarmMutex.Unlock();
-                            }
-                        }
-                    } else if (connectingToLeader) {
-                        QCC_DbgPrintf(("%s: connectingToLeader", __func__));
-                        /*
-                         * Go through all the JoinSession replies
-                         */
-                        FailedJoinSessionReplies failedJoinSessionsCopy;
-                        failedJoinSessionMutex.Lock();
-                        failedJoinSessionsCopy = failedJoinSessions;
-                        failedJoinSessions.clear();
-                        failedJoinSessionMutex.Unlock();
-
-                        FailedJoinSessionReplies sessionAlreadyJoinedRepliesCopy;
-                        sessionAlreadyJoinedRepliesMutex.Lock();
-                        sessionAlreadyJoinedRepliesCopy = sessionAlreadyJoinedReplies;
-                        sessionAlreadyJoinedReplies.clear();
-                        sessionAlreadyJoinedRepliesMutex.Unlock();
-
-                        SuccessfulJoinSessionReplies successfulJoinSessionsCopy;
-                        successfulJoinSessionMutex.Lock();
-                        successfulJoinSessionsCopy = successfulJoinSessions;
-                        successfulJoinSessions.clear();
-                        successfulJoinSessionMutex.Unlock();
-
-                        ControllerEntry failedConnectToLeader;
-
-                        currentLeaderMutex.Lock();
-                        while (failedJoinSessionsCopy.size()) {
-                            if ((static_cast<ControllerEntry>(failedJoinSessionsCopy.front()).rank == currentLeader.controllerDetails.rank)
-                                && (static_cast<ControllerEntry>(failedJoinSessionsCopy.front()).announcementTimestamp == currentLeader.controllerDetails.announcementTimestamp)) {
-                                QCC_DbgPrintf(("%s: JoinSession failed with current leader", __func__));
-                                failedConnectToLeader = currentLeader.controllerDetails;
-                                currentLeader.Clear();
-                                break;
-                            }
-                            failedJoinSessionsCopy.pop_front();
-                        }
-                        currentLeaderMutex.Unlock();
-
-                        ControllerEntry outGoingLeaderCopy;
-                        outGoingLeaderMutex.Lock();
-                        outGoingLeaderCopy = outGoingLeader;
-                        outGoingLeaderMutex.Unlock();
-
-                        if (failedConnectToLeader.rank.IsInitialized()) {
-                            if (!outGoingLeaderCopy.busName.empty()) {
-                                /*
-                                 * We are performing a coup but could not successfully talk to the
-                                 * outgoing leader. So forcefully take over as the leader now
-                                 */
-                                controllersMapMutex.Lock();
-                                ControllersMap::iterator it = controllersMap.find(outGoingLeader.rank);
-                                if ((it != controllersMap.end()) && (it->second.isLeader) && (it->second.announcementTimestamp == outGoingLeader.announcementTimestamp)) {
-                                    QCC_DbgPrintf(("%s: Removed outgoing leader with rank %s from controllersMap", __func__, outGoingLeader.rank.c_str()));
-                                    controllersMap.erase(it);
-                                }
-                                controllersMapMutex.Unlock();
-
-                                outGoingLeaderMutex.Lock();
-                                outGoingLeader.Clear();
-                                outGoingLeaderMutex.Unlock();
-
-                                QCC_DbgPrintf(("%s: Announcing self as leader", __func__));
-                                controller.GetLampManager().ConnectToLamps();
-                                controller.SetAllowUpdates(true);
-                                controller.SetIsLeader(true);
-                                isLeader = true;
-                                g_IsLeader = true;
-                                okToSetAlarm = false;
-                                electionAlarmMutex.Lock();
-                                electionAlarm.SetAlarm(0);
-                                electionAlarmMutex.Unlock();
-                            }
-
-                            controllersMapMutex.Lock();
-                            ControllersMap::iterator it = controllersMap.find(failedConnectToLeader.rank);
-                            /*
-                             * We should delete the entry from controllersMap only if the leader bit is
-                             * set. Otherwise it means that someone took over from this leader when
-                             * we were trying to JoinSession
-                             */
-                            if ((it != controllersMap.end()) && (it->second.isLeader) && (it->second.announcementTimestamp == failedConnectToLeader.announcementTimestamp)) {
-                                controllersMap.erase(it);
-                            }
-                            controllersMapMutex.Unlock();
-
-                            /*
-                             * Loop back to see if we have any other leader in the controllersMap
-                             */
-                            loopBack = true;
-                        } else if (!sessionAlreadyJoinedRepliesCopy.empty()) {
-                            /*
-                             * Loop back to re-attempt a connect to the leader that returned session_already_joined error
-                             */
-                            loopBack = true;
-                        } else {
-                            currentLeaderMutex.Lock();
-                            for (SuccessfulJoinSessionReplies::iterator it = successfulJoinSessionsCopy.begin(); it != successfulJoinSessionsCopy.end(); it++) {
-                                if (((it->first) == currentLeader.controllerDetails.rank) && ((it->second.first.announcementTimestamp) == currentLeader.controllerDetails.announcementTimestamp)) {
-                                    ajn::SessionId sessionId = static_cast<ajn::SessionId>(it->second.second);
-                                    QCC_DbgPrintf(("%s: JoinSession successful with current leader", __func__));
-                                    currentLeader.proxyObj = ProxyBusObject(bus, currentLeader.controllerDetails.busName.c_str(), LeaderElectionAndStateSyncObjectPath, sessionId);
-
-                                    const InterfaceDescription* stateSyncInterface = bus.GetInterface(LeaderElectionAndStateSyncInterfaceName);
-                                    currentLeader.proxyObj.AddInterface(*stateSyncInterface);
-
-                                    ControllerEntry outGoingLeaderCopy;
-                                    outGoingLeaderMutex.Lock();
-                                    outGoingLeaderCopy = outGoingLeader;
-                                    outGoingLeaderMutex.Unlock();
-
-                                    if (!outGoingLeaderCopy.busName.empty()) {
-                                        /*
-                                         * Try to get current state from outgoing leader
-                                         */
-                                        QStatus status = currentLeader.proxyObj.MethodCallAsync(
-                                            LeaderElectionAndStateSyncInterfaceName,
-                                            "GetChecksumAndModificationTimestamp",
-                                            this,
-                                            static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnGetChecksumAndModificationTimestampReply),
-                                            NULL, 0, NULL, OVERTHROW_TIMEOUT_IN_M_SEC);
-
-                                        if (status != ER_OK) {
-                                            QCC_LogError(status, ("%s: MethodCallAsync for GetChecksumAndModificationTimestamp failed", __func__));
-                                            /*
-                                             * Sending OverThrow failed. Forcefully take over as leader after tearing down
-                                             * the session with the leader
-                                             */
-                                            ajn::SessionId sessionId = 0;
-                                            currentLeaderMutex.Lock();
-                                            sessionId = currentLeader.proxyObj.GetSessionId();
-                                            currentLeader.Clear();
-                                            currentLeaderMutex.Unlock();
-
-                                            if (sessionId) {
-                                                QCC_DbgPrintf(("%s: Tearing down session with current leader", __func__));
-                                                controller.DoLeaveSessionAsync(sessionId);
-                                            }
-
-                                            controllersMapMutex.Lock();
-                                            ControllersMap::iterator it = controllersMap.find(outGoingLeader.rank);
-                                            if ((it != controllersMap.end()) && (it->second.isLeader) && (it->second.announcementTimestamp == outGoingLeader.announcementTimestamp)) {
-                                                QCC_DbgPrintf(("%s: Removed outgoing leader with rank %s from controllersMap", __func__, outGoingLeader.rank.c_str()));
-                                                controllersMap.erase(it);
-                                            }
-                                            controllersMapMutex.Unlock();
-
-                                            outGoingLeaderMutex.Lock();
-                                            outGoingLeader.Clear();
-                                            outGoingLeaderMutex.Unlock();
-
-                                            QCC_DbgPrintf(("%s: Announcing self as leader", __func__));
-                                            controller.GetLampManager().ConnectToLamps();
-                                            controller.SetAllowUpdates(true);
-                                            controller.SetIsLeader(true);
-                                            isLeader = true;
-                                            g_IsLeader = true;
-                                            okToSetAlarm = false;
-                                            electionAlarmMutex.Lock();
-                                            electionAlarm.SetAlarm(0);
-                                            electionAlarmMutex.Unlock();
-                                        }
-                                    } else {
-                                        // we don't need to wait for this
-                                        QStatus status = bus.SetLinkTimeoutAsync(sessionId, LSF_MIN_LINK_TIMEOUT_IN_SECONDS, handler, NULL);
-                                        if (status != ER_OK) {
-                                            QCC_LogError(status, ("%s: SetLinkTimeoutAsync failed", __func__));
-                                        }
-
-                                        status = currentLeader.proxyObj.MethodCallAsync(
-                                            LeaderElectionAndStateSyncInterfaceName,
-                                            "GetChecksumAndModificationTimestamp",
-                                            this,
-                                            static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnGetChecksumAndModificationTimestampReply),
-                                            NULL,
-                                            0);
-                                        if (status != ER_OK) {
-                                            QCC_LogError(status, ("%s: MethodCallAsync for GetChecksumAndModificationTimestamp failed", __func__));
-                                        }
-                                    }
-
-                                    successfulJoinSessionsCopy.erase(it);
-                                    break;
-                                }
-                            }
-                            currentLeaderMutex.Unlock();
-
-                            /*
-                             * Cleaning up the remaining stray sessions
-                             */
-                            for (SuccessfulJoinSessionReplies::iterator it = successfulJoinSessionsCopy.begin(); it != successfulJoinSessionsCopy.end(); it++) {
-                                QCC_DbgPrintf(("%s: DoLeaveSessionAsync on stray session %d", __func__, it->second.second));
-                                controller.DoLeaveSessionAsync(static_cast<ajn::SessionId>(it->second.second));
-                            }
-                        }
-                    } else {
-                        QCC_DbgPrintf(("%s: connectedToLeader", __func__));
-                        /*
-                         * Check if we have lost our session with the leader or if the leader has left the session
-                         */
-                        SessionLostList sessionLostListCopy;
-                        sessionLostMutex.Lock();
-                        sessionLostListCopy = sessionLostList;
-                        sessionLostList.clear();
-                        sessionLostMutex.Unlock();
-
-                        QCC_DbgPrintf(("%s: Made sessionLostList copy", __func__));
-
-                        SessionMemberRemovedMap sessionMemberRemovedCopy;
-                        sessionMemberRemovedMutex.Lock();
-                        sessionMemberRemovedCopy = sessionMemberRemoved;
-                        sessionMemberRemoved.clear();
-                        sessionMemberRemovedMutex.Unlock();
-
-                        QCC_DbgPrintf(("%s: Made sessionMemberRemoved copy", __func__));
-
-                        bool lostSessionWithLeader = false;
-                        ajn::SessionId sessionId = 0;
-                        const char* leaderUniqueName = NULL;
-
-                        currentLeaderMutex.Lock();
-                        sessionId = static_cast<uint32_t>(currentLeader.proxyObj.GetSessionId());
-                        leaderUniqueName = currentLeader.controllerDetails.busName.c_str();
-                        currentLeaderMutex.Unlock();
-
-                        QCC_DbgPrintf(("%s: Made copy of current leader details", __func__));
-
-                        SessionLostList::iterator it = std::find(sessionLostListCopy.begin(), sessionLostListCopy.end(), static_cast<uint32_t>(sessionId));
-                        if (it != sessionLostListCopy.end()) {
-                            QCC_DbgPrintf(("%s: Lost Session with the current leader", __func__));
-                            lostSessionWithLeader = true;
-                        }
-
-                        if (!lostSessionWithLeader) {
-                            QCC_DbgPrintf(("%s: No useful session losts. Looking at sessionMemberRemovedCopy", __func__));
-                            SessionMemberRemovedMap::iterator it = sessionMemberRemovedCopy.find(static_cast<uint32_t>(currentLeader.proxyObj.GetSessionId()));
-                            if ((it != sessionMemberRemovedCopy.end()) && (0 == strcmp(it->second, leaderUniqueName))) {
-                                QCC_DbgPrintf(("%s: Current Leader left the session", __func__));
-                                controller.DoLeaveSessionAsync(sessionId);
-                                lostSessionWithLeader = true;
-                            }
-                        }
-
-                        if (lostSessionWithLeader) {
-                            QCC_DbgPrintf(("%s: SessionLost", __func__));
-                            ControllerEntry failedConnectToLeader;
-
-                            currentLeaderMutex.Lock();
-                            QCC_DbgPrintf(("%s: Cleared current leader with rank %s", __func__, currentLeader.controllerDetails.rank.c_str()));
-                            failedConnectToLeader = currentLeader.controllerDetails;
-                            currentLeader.Clear();
-                            currentLeaderMutex.Unlock();
-
-                            controllersMapMutex.Lock();
-                            ControllersMap::iterator it = controllersMap.find(failedConnectToLeader.rank);
-                            /*
-                             * We should delete the entry from controllersMap only if the leader bit is
-                             * set and announcement timestamp is the same.
-                             */
-                            if ((it != controllersMap.end()) && (it->second.isLeader) && (it->second.announcementTimestamp == failedConnectToLeader.announcementTimestamp)) {
-                                QCC_DbgPrintf(("%s: Removing entry with rank %s from controllersMap", __func__, it->second.rank.c_str()));
-                                controllersMap.erase(it);
-                            }
-                            controllersMapMutex.Unlock();
-
-                            /*
-                             * Loop Back to find and connect to a new leader who may have come up or
-                             * take over as the leader
-                             */
-                            loopBack = true;
-                        } else {
-                            QCC_DbgPrintf(("%s: No SessionLost", __func__));
-                            /*
-                             * Check if a new leader with rank higher that whom we think is the leader has come up. If so,
-                             * leave our current session and join the new leader
-                             */
-                            ControllerEntry currentLeaderCopy;
-                            currentLeaderMutex.Lock();
-                            currentLeaderCopy = currentLeader.controllerDetails;
-                            currentLeaderMutex.Unlock();
-
-                            ControllerEntry entry;
-                            entry.Clear();
-                            controllersMapMutex.Lock();
-                            ControllersMap::iterator it = controllersMap.find(currentLeaderCopy.rank);
-                            if (it != controllersMap.end()) {
-                                for (ControllersMap::reverse_iterator rit = controllersMap.rbegin(); rit != controllersMap.rend(); rit++) {
-                                    if ((rit->second.rank > currentLeaderCopy.rank) && (rit->second.isLeader)) {
-                                        QCC_DbgPrintf(("%s: Found a leader that has higher rank than current leader", __func__));
-                                        entry = rit->second;
-                                        break;
-                                    }
-                                }
-                            }
-                            if ((entry.rank.IsInitialized()) && (it->second.isLeader) && (it->second.announcementTimestamp == currentLeaderCopy.announcementTimestamp)) {
-                                QCC_DbgPrintf(("%s: Removing current leader %s entry from controllersMap", __func__, currentLeaderCopy.rank.c_str()));
-                                controllersMap.erase(it);
-                            }
-                            controllersMapMutex.Unlock();
-
-                            if (entry.rank.IsInitialized()) {
-                                ajn::SessionId session = 0;
-                                currentLeaderMutex.Lock();
-                                session = currentLeader.proxyObj.GetSessionId();
-                                currentLeader.Clear();
-                                currentLeaderMutex.Unlock();
-
-                                if (session) {
-                                    controller.DoLeaveSessionAsync(session);
-                                    loopBack = true;
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
+        election.Run();
     }
 
-_Exit:
     QCC_DbgPrintf(("%s: Exiting", __func__));
 }
 
 // called when we join another controller's session
 void LeaderElectionObject::OnSessionJoined(QStatus status, SessionId sessionId, void* context)
 {
-    ControllerEntry* ctx = static_cast<ControllerEntry*>(context);
-    QCC_DbgPrintf(("%s: (status=%s sessionId=%u rank=%s)", __func__, QCC_StatusText(status), sessionId, (*ctx).rank.c_str()));
-
-    if (status == ER_OK) {
-        successfulJoinSessionMutex.Lock();
-        successfulJoinSessions.insert(std::make_pair((*ctx).rank, std::make_pair((*ctx), static_cast<uint32_t>(sessionId))));
-        successfulJoinSessionMutex.Unlock();
-    } else {
-        if (status == ER_ALLJOYN_JOINSESSION_REPLY_ALREADY_JOINED) {
-            sessionAlreadyJoinedRepliesMutex.Lock();
-            sessionAlreadyJoinedReplies.push_back(*ctx);
-            sessionAlreadyJoinedRepliesMutex.Unlock();
-        } else {
-            failedJoinSessionMutex.Lock();
-            failedJoinSessions.push_back(*ctx);
-            failedJoinSessionMutex.Unlock();
-        }
-    }
-
+    ElectionStateMachine::ControllerEntry* ctx = static_cast<ElectionStateMachine::ControllerEntry*>(context);
+    election.OnSessionJoined(status, static_cast<uint32_t>(sessionId), *ctx);
     delete ctx;
-    wakeSem.Post();
 }
 
 QStatus LeaderElectionObject::Start(Rank& rank)
@@ -1269,7 +921,7 @@ QStatus LeaderElectionObject::Start(Rank& rank)
     QCC_DbgTrace(("%s", __func__));
 
     // can't get this in c'tor because it might not be initialized yet
-    myRank = rank;
+    election.SetRank(rank);
 
     QStatus status;
     status = bus.CreateInterfacesFromXml(LeaderElectionAndStateSyncDescription.c_str());
@@ -1290,6 +942,9 @@ QStatus LeaderElectionObject::Start(Rank& rank)
     const MethodEntry methodEntries[] = {
         { stateSyncInterface->GetMember("GetChecksumAndModificationTimestamp"), static_cast<MessageReceiver::MethodHandler>(&LeaderElectionObject::GetChecksumAndModificationTimestamp) },
         { stateSyncInterface->GetMember("GetBlob"), static_cast<MessageReceiver::MethodHandler>(&LeaderElectionObject::GetBlob) },
+        { stateSyncInterface->GetMember("GetHashTreeNodes"), static_cast<MessageReceiver::MethodHandler>(&LeaderElectionObject::GetHashTreeNodes) },
+        { stateSyncInterface->GetMember("GetEntityHashes"), static_cast<MessageReceiver::MethodHandler>(&LeaderElectionObject::GetEntityHashes) },
+        { stateSyncInterface->GetMember("GetEntities"), static_cast<MessageReceiver::MethodHandler>(&LeaderElectionObject::GetEntities) },
         { stateSyncInterface->GetMember("Overthrow"), static_cast<MessageReceiver::MethodHandler>(&LeaderElectionObject::Overthrow) }
     };
 
@@ -1310,7 +965,40 @@ QStatus LeaderElectionObject::Start(Rank& rank)
         return status;
     }
 
-    status = bus.RegisterBusObject(*this);
+    blobDeltaSignal = stateSyncInterface->GetSignal("BlobDelta");
+    status = bus.RegisterSignalHandler(
+        this,
+        static_cast<MessageReceiver::SignalHandler>(&LeaderElectionObject::OnBlobDelta),
+        blobDeltaSignal,
+        LeaderElectionAndStateSyncObjectPath);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to register BlobDelta signal handler", __func__));
+        return status;
+    }
+
+    blobChunkSignal = stateSyncInterface->GetSignal("BlobChunk");
+    status = bus.RegisterSignalHandler(
+        this,
+        static_cast<MessageReceiver::SignalHandler>(&LeaderElectionObject::OnBlobChunk),
+        blobChunkSignal,
+        LeaderElectionAndStateSyncObjectPath);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to register BlobChunk signal handler", __func__));
+        return status;
+    }
+
+    heartbeatSignal = stateSyncInterface->GetSignal("Heartbeat");
+    status = bus.RegisterSignalHandler(
+        this,
+        static_cast<MessageReceiver::SignalHandler>(&LeaderElectionObject::OnHeartbeat),
+        heartbeatSignal,
+        LeaderElectionAndStateSyncObjectPath);
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Failed to register Heartbeat signal handler", __func__));
+        return status;
+    }
+
+    status = bus.RegisterBusObject(*this);
     if (status != ER_OK) {
         QCC_LogError(status, ("%s: Failed to register BusObject for the Leader Object", __func__));
         return status;
@@ -1337,12 +1025,14 @@ void LeaderElectionObject::Stop()
             QCC_LogError(status, ("%s: Failed to UnRegisterAnnounceHandler", __func__));
         }
 
+        heartbeatTimer.Stop();
         wakeSem.Post();
     }
 }
 
 void LeaderElectionObject::Join()
 {
+    heartbeatTimer.Join();
     Thread::Join();
 }
 
@@ -1350,23 +1040,12 @@ void LeaderElectionObject::Overthrow(const InterfaceDescription::Member* member,
 {
     QCC_DbgTrace(("%s", __func__));
 
-    ControllerEntry upcomingLeaderCopy;
-    upComingLeaderMutex.Lock();
-    upcomingLeaderCopy = upComingLeader;
-    upComingLeaderMutex.Unlock();
-
-    if (0 == strcmp(msg->GetSender(), upcomingLeaderCopy.busName.c_str())) {
-        electionAlarmMutex.Lock();
-        QCC_DbgPrintf(("%s: Extended overthrow alarm", __func__));
-        electionAlarm.SetAlarm(OVERTHROW_TIMEOUT_IN_SEC);
-        electionAlarmMutex.Unlock();
-    }
-
     overThrowListMutex.Lock();
-    overThrowList.push_back(msg);
+    uint32_t callId = nextOverthrowCallId++;
+    overThrowCalls.insert(std::make_pair(callId, msg));
     overThrowListMutex.Unlock();
 
-    wakeSem.Post();
+    election.OnOverthrow(msg->GetSender(), callId);
 }
 
 void LeaderElectionObject::OnOverthrowReply(Message& message, void* context)
@@ -1390,44 +1069,47 @@ void LeaderElectionObject::OnOverthrowReply(Message& message, void* context)
         QCC_DbgTrace(("%s: Overthrow method call timed out", __func__));
     }
 
-    gotOverthrowReply = true;
-    wakeSem.Post();
+    election.OnOverthrowReply();
 }
 
-QStatus LeaderElectionObject::SendBlobUpdate(SessionId session, LSFBlobType type, std::string blob, uint32_t checksum, uint64_t timestamp)
+QStatus LeaderElectionObject::SendBlobUpdate(SessionId session, LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp)
 {
     if (!controller.IsLeader()) {
         return ER_OK;
     }
 
     QCC_DbgTrace(("%s: Signal(session=%u)", __func__, session));
+    if (blob.length() > BlobTransfer::INLINE_BLOB_LEN) {
+        return SendBlobChunks(NULL, session, type, blob, checksum, timestamp);
+    }
+
     MsgArg args[4];
     args[0].Set("u", static_cast<uint32_t>(type));
-    args[1].Set("s", strdupnew(blob.c_str()));
-    args[1].SetOwnershipFlags(MsgArg::OwnsData);
+    args[1].Set("s", blob.c_str());
     args[2].Set("u", checksum);
     args[3].Set("t", timestamp);
 
     return Signal(NULL, session, *blobChangedSignal, args, 4);
 }
 
-QStatus LeaderElectionObject::SendBlobUpdate(LSFBlobType type, std::string blob, uint32_t checksum, uint64_t timestamp)
+QStatus LeaderElectionObject::SendBlobUpdate(LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp)
 {
     QCC_DbgTrace(("%s", __func__));
 
     ajn::SessionId session = 0;
 
     currentLeaderMutex.Lock();
-    if (currentLeader.proxyObj.IsValid()) {
-        session = currentLeader.proxyObj.GetSessionId();
+    if (leaderProxy.IsValid()) {
+        session = leaderProxy.GetSessionId();
     }
     currentLeaderMutex.Unlock();
 
-    if (session) {
+    if (session && (blob.length() > BlobTransfer::INLINE_BLOB_LEN)) {
+        return SendBlobChunks(NULL, session, type, blob, checksum, timestamp);
+    } else if (session) {
         MsgArg args[4];
         args[0].Set("u", static_cast<uint32_t>(type));
-        args[1].Set("s", strdupnew(blob.c_str()));
-        args[1].SetOwnershipFlags(MsgArg::OwnsData);
+        args[1].Set("s", blob.c_str());
         args[2].Set("u", checksum);
         args[3].Set("t", timestamp);
         QCC_DbgTrace(("%s: Signal(session=%u)", __func__, session));
@@ -1437,17 +1119,220 @@ QStatus LeaderElectionObject::SendBlobUpdate(LSFBlobType type, std::string blob,
     return ER_FAIL;
 }
 
-void LeaderElectionObject::SendGetBlobReply(ajn::Message& message, LSFBlobType type, std::string blob, uint32_t checksum, uint64_t timestamp)
+QStatus LeaderElectionObject::SendBlobDelta(SessionId session, LSFBlobType type, const StoreChangeSet& changes, uint32_t checksum, uint64_t timestamp)
+{
+    if (!controller.IsLeader()) {
+        return ER_OK;
+    }
+
+    QCC_DbgTrace(("%s: Signal(session=%u)", __func__, session));
+    size_t numChanges = changes.records.size();
+    MsgArg* changeArray = new MsgArg[numChanges];
+    size_t i = 0;
+    for (StoreJournalRecordList::const_iterator it = changes.records.begin(); it != changes.records.end(); ++it, ++i) {
+        changeArray[i].Set("(yssu)", static_cast<uint8_t>(it->type), it->id.c_str(), it->data.c_str(), it->version);
+    }
+
+    MsgArg args[7];
+    args[0].Set("u", static_cast<uint32_t>(type));
+    args[1].Set("u", changes.fromSequence);
+    args[2].Set("u", changes.toSequence);
+    args[3].Set("u", changes.baseChecksum);
+    args[4].Set("a(yssu)", numChanges, changeArray);
+    args[4].SetOwnershipFlags(MsgArg::OwnsArgs, true);
+    args[5].Set("u", checksum);
+    args[6].Set("t", timestamp);
+
+    return Signal(NULL, session, *blobDeltaSignal, args, 7);
+}
+
+QStatus LeaderElectionObject::SendHeartbeat(SessionId session)
+{
+    if (!controller.IsLeader()) {
+        return ER_OK;
+    }
+
+    uint32_t sequence = static_cast<uint32_t>(qcc::IncrementAndFetch(&heartbeatSequence));
+
+    /*
+     * The followers compare their stores with the last change sent to them,
+     * which tells them how far behind the leader they are
+     */
+    uint32_t storeSequences[4];
+    uint32_t storeHashes[4];
+    controller.GetPresetManager().GetStoreSequence(storeSequences[0], storeHashes[0]);
+    controller.GetLampGroupManager().GetStoreSequence(storeSequences[1], storeHashes[1]);
+    controller.GetSceneManager().GetStoreSequence(storeSequences[2], storeHashes[2]);
+    controller.GetMasterSceneManager().GetStoreSequence(storeSequences[3], storeHashes[3]);
+
+    MsgArg* storeArray = new MsgArg[4];
+    storeArray[0].Set("(uuu)", static_cast<uint32_t>(LSF_PRESET), storeSequences[0], storeHashes[0]);
+    storeArray[1].Set("(uuu)", static_cast<uint32_t>(LSF_LAMP_GROUP), storeSequences[1], storeHashes[1]);
+    storeArray[2].Set("(uuu)", static_cast<uint32_t>(LSF_SCENE), storeSequences[2], storeHashes[2]);
+    storeArray[3].Set("(uuu)", static_cast<uint32_t>(LSF_MASTER_SCENE), storeSequences[3], storeHashes[3]);
+
+    MsgArg args[2];
+    args[0].Set("u", sequence);
+    args[1].Set("a(uuu)", 4, storeArray);
+    args[1].SetOwnershipFlags(MsgArg::OwnsArgs, true);
+
+    /*
+     * A heartbeat that is older than the failure detection timeout is useless,
+     * so it must not be queued behind a backlog of signals
+     */
+    uint16_t timeToLive = static_cast<uint16_t>(OEM_CS_LEADER_HEARTBEAT_INTERVAL_MS * OEM_CS_LEADER_HEARTBEAT_MISSED_THRESHOLD);
+    return Signal(NULL, session, *heartbeatSignal, args, 2, timeToLive);
+}
+
+bool LeaderElectionObject::GetReplicaStaleness(uint32_t& staleness, qcc::String& leaderBusName)
+{
+    bool synchronized = false;
+    staleness = ReadReplicaUnsynchronized;
+
+    ElectionStateMachine::ControllerEntry leader;
+    uint32_t sessionId;
+    election.GetCurrentLeader(leader, sessionId);
+    leaderBusName = leader.busName;
+
+    currentLeaderMutex.Lock();
+    synchronized = leaderProxy.IsValid() && storesSynchronized;
+    currentLeaderMutex.Unlock();
+    if (!synchronized) {
+        return false;
+    }
+
+    uint64_t ages[4];
+    synchronized = controller.GetPresetManager().GetReplicaAge(ages[0]) &&
+                   controller.GetLampGroupManager().GetReplicaAge(ages[1]) &&
+                   controller.GetSceneManager().GetReplicaAge(ages[2]) &&
+                   controller.GetMasterSceneManager().GetReplicaAge(ages[3]);
+    if (!synchronized) {
+        return false;
+    }
+
+    uint64_t elapsed = 0;
+    for (size_t i = 0; i < 4; i++) {
+        if (ages[i] > elapsed) {
+            elapsed = ages[i];
+        }
+    }
+
+    /*
+     * The leader only sends a change once it is committed, so it may have
+     * accepted changes up to a debounce window before the heartbeat was sent
+     */
+    elapsed += OEM_CS_PERSISTENCE_DEBOUNCE_WINDOW_MS;
+    staleness = (elapsed < ReadReplicaUnsynchronized) ? static_cast<uint32_t>(elapsed) : (ReadReplicaUnsynchronized - 1);
+    return true;
+}
+
+void LeaderElectionObject::GetElectionState(ElectionState& state)
+{
+    state.isLeader = election.IsLeader();
+    state.electionPending = election.IsElectionPending();
+
+    state.storesSynchronized = GetReplicaStaleness(state.replicaStaleness, state.leaderBusName);
+
+    ElectionStateMachine::ControllerEntry leader;
+    uint32_t sessionId;
+    election.GetCurrentLeader(leader, sessionId);
+    state.leaderRankHigherBits = leader.rank.GetHigherOrderBits();
+    state.leaderRankLowerBits = leader.rank.GetLowerOrderBits();
+
+    state.knownControllers = election.GetNumControllers();
+}
+
+void LeaderElectionObject::OnHeartbeatTimer(void)
+{
+    election.OnHeartbeatTimer();
+}
+
+QStatus LeaderElectionObject::RequestBlob(LSFBlobType type)
+{
+    QCC_DbgTrace(("%s: type=%d", __func__, type));
+    if (controller.IsLeader()) {
+        return ER_OK;
+    }
+
+    MsgArg arg("u", type);
+    QStatus status = ER_FAIL;
+
+    currentLeaderMutex.Lock();
+    if (leaderProxy.IsValid()) {
+        status = leaderProxy.MethodCallAsync(
+            LeaderElectionAndStateSyncInterfaceName,
+            "GetBlob",
+            this,
+            static_cast<MessageReceiver::ReplyHandler>(&LeaderElectionObject::OnGetBlobReply),
+            &arg,
+            1,
+            NULL,
+            OVERTHROW_TIMEOUT_IN_M_SEC);
+    }
+    currentLeaderMutex.Unlock();
+
+    if (status != ER_OK) {
+        QCC_LogError(status, ("%s: Method Call Async failed", __func__));
+    }
+    return status;
+}
+
+void LeaderElectionObject::SendGetBlobReply(ajn::Message& message, LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp)
 {
     QCC_DbgTrace(("%s", __func__));
+    /*
+     * A long blob is sent in BlobChunk signals that follow an empty reply
+     */
+    bool chunked = (blob.length() > BlobTransfer::INLINE_BLOB_LEN);
+
     MsgArg args[4];
     args[0].Set("u", static_cast<uint32_t>(type));
-    args[1].Set("s", strdupnew(blob.c_str()));
-    args[1].SetOwnershipFlags(MsgArg::OwnsData);
+    args[1].Set("s", chunked ? "" : blob.c_str());
     args[2].Set("u", checksum);
     args[3].Set("t", timestamp);
 
     controller.SendMethodReply(message, args, 4);
+
+    if (chunked) {
+        SendBlobChunks(message->GetSender(), message->GetSessionId(), type, blob, checksum, timestamp);
+    }
+}
+
+QStatus LeaderElectionObject::SendBlobChunks(const char* destination, SessionId session, LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp)
+{
+    std::string compressed;
+    BlobTransfer::Compress(blob, compressed);
+
+    uint32_t transferId = static_cast<uint32_t>(qcc::IncrementAndFetch(&nextTransferId));
+    uint32_t numChunks = BlobTransfer::GetNumChunks(compressed.length());
+    QCC_DbgPrintf(("%s: type=%d transfer=%u len=%u compressed=%u chunks=%u", __func__, type, transferId,
+                   (uint32_t) blob.length(), (uint32_t) compressed.length(), numChunks));
+
+    QStatus status = ER_OK;
+    for (uint32_t i = 0; (i < numChunks) && (status == ER_OK); i++) {
+        size_t offset = i * BlobTransfer::CHUNK_LEN;
+        size_t len = compressed.length() - offset;
+        if (len > BlobTransfer::CHUNK_LEN) {
+            len = BlobTransfer::CHUNK_LEN;
+        }
+
+        MsgArg args[8];
+        args[0].Set("u", static_cast<uint32_t>(type));
+        args[1].Set("u", transferId);
+        args[2].Set("u", i);
+        args[3].Set("u", numChunks);
+        args[4].Set("u", static_cast<uint32_t>(blob.length()));
+        args[5].Set("ay", len, reinterpret_cast<const uint8_t*>(compressed.data()) + offset);
+        args[6].Set("u", checksum);
+        args[7].Set("t", timestamp);
+
+        status = Signal(destination, session, *blobChunkSignal, args, 8);
+        if (status != ER_OK) {
+            QCC_LogError(status, ("%s: Failed to send chunk %u of %u", __func__, i, numChunks));
+        }
+    }
+
+    return status;
 }
 
 void LeaderElectionObject::GetChecksumAndModificationTimestamp(const ajn::InterfaceDescription::Member* member, ajn::Message& message)
@@ -1457,17 +1342,7 @@ void LeaderElectionObject::GetChecksumAndModificationTimestamp(const ajn::Interf
     const MsgArg* args;
     message->GetArgs(numArgs, args);
 
-    ControllerEntry upcomingLeaderCopy;
-    upComingLeaderMutex.Lock();
-    upcomingLeaderCopy = upComingLeader;
-    upComingLeaderMutex.Unlock();
-
-    if (0 == strcmp(message->GetSender(), upcomingLeaderCopy.busName.c_str())) {
-        electionAlarmMutex.Lock();
-        QCC_DbgPrintf(("%s: Extended overthrow alarm", __func__));
-        electionAlarm.SetAlarm(OVERTHROW_TIMEOUT_IN_SEC);
-        electionAlarmMutex.Unlock();
-    }
+    election.ExtendOverthrowAlarm(message->GetSender());
 
     MsgArg outArg;
     MsgArg* out = new MsgArg[4];
@@ -1526,17 +1401,7 @@ void LeaderElectionObject::GetBlob(const ajn::InterfaceDescription::Member* memb
         return;
     }
 
-    ControllerEntry upcomingLeaderCopy;
-    upComingLeaderMutex.Lock();
-    upcomingLeaderCopy = upComingLeader;
-    upComingLeaderMutex.Unlock();
-
-    if (0 == strcmp(message->GetSender(), upcomingLeaderCopy.busName.c_str())) {
-        electionAlarmMutex.Lock();
-        QCC_DbgPrintf(("%s: Extended overthrow alarm", __func__));
-        electionAlarm.SetAlarm(OVERTHROW_TIMEOUT_IN_SEC);
-        electionAlarmMutex.Unlock();
-    }
+    election.ExtendOverthrowAlarm(message->GetSender());
 
     switch (static_cast<LSFBlobType>(args[0].v_uint32)) {
     case LSF_PRESET:
@@ -1561,6 +1426,258 @@ void LeaderElectionObject::GetBlob(const ajn::InterfaceDescription::Member* memb
     }
 }
 
+void LeaderElectionObject::GetHashTreeNodes(const ajn::InterfaceDescription::Member* member, ajn::Message& message)
+{
+    QCC_DbgTrace(("%s", __func__));
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controller.CheckNumArgsInMessage(numArgs, 3)  != LSF_OK) {
+        MethodReply(message, ER_BAD_ARG_COUNT);
+        return;
+    }
+
+    election.ExtendOverthrowAlarm(message->GetSender());
+
+    LSFBlobType type = static_cast<LSFBlobType>(args[0].v_uint32);
+    uint32_t level = args[1].v_uint32;
+    uint32_t* nodeArray;
+    size_t numNodes;
+    args[2].Get("au", &numNodes, &nodeArray);
+    std::vector<uint32_t> nodes(nodeArray, nodeArray + numNodes);
+
+    std::vector<uint64_t> hashes;
+    if ((level >= StoreHashTree::DEPTH) || !GetLocalHashTreeNodes(type, level, nodes, hashes)) {
+        MethodReply(message, ER_FAIL);
+        return;
+    }
+
+    MsgArg outArgs[3];
+    outArgs[0].Set("u", static_cast<uint32_t>(type));
+    outArgs[1].Set("u", level);
+    outArgs[2].Set("at", hashes.size(), hashes.empty() ? NULL : &hashes[0]);
+    MethodReply(message, outArgs, 3);
+}
+
+void LeaderElectionObject::GetEntityHashes(const ajn::InterfaceDescription::Member* member, ajn::Message& message)
+{
+    QCC_DbgTrace(("%s", __func__));
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controller.CheckNumArgsInMessage(numArgs, 2)  != LSF_OK) {
+        MethodReply(message, ER_BAD_ARG_COUNT);
+        return;
+    }
+
+    election.ExtendOverthrowAlarm(message->GetSender());
+
+    LSFBlobType type = static_cast<LSFBlobType>(args[0].v_uint32);
+    uint32_t* bucketArray;
+    size_t numBuckets;
+    args[1].Get("au", &numBuckets, &bucketArray);
+    std::vector<uint32_t> buckets(bucketArray, bucketArray + numBuckets);
+
+    StoreEntityHashList entities;
+    if (!GetLocalEntityHashes(type, buckets, entities)) {
+        MethodReply(message, ER_FAIL);
+        return;
+    }
+
+    /*
+     * The caller fetches the whole blob if the hashes do not fit in one message
+     */
+    size_t replyLength = 0;
+    for (StoreEntityHashList::const_iterator it = entities.begin(); it != entities.end(); ++it) {
+        replyLength += it->first.length() + sizeof(uint64_t);
+    }
+    if (replyLength > BlobTransfer::INLINE_BLOB_LEN) {
+        QCC_DbgPrintf(("%s: %u entity hashes are too long to send", __func__, (uint32_t) entities.size()));
+        MethodReply(message, ER_FAIL);
+        return;
+    }
+
+    MsgArg* entityArray = new MsgArg[entities.size()];
+    size_t i = 0;
+    for (StoreEntityHashList::const_iterator it = entities.begin(); it != entities.end(); ++it, ++i) {
+        entityArray[i].Set("(st)", it->first.c_str(), it->second);
+    }
+
+    MsgArg outArgs[2];
+    outArgs[0].Set("u", static_cast<uint32_t>(type));
+    outArgs[1].Set("a(st)", entities.size(), entityArray);
+    outArgs[1].SetOwnershipFlags(MsgArg::OwnsArgs, true);
+    MethodReply(message, outArgs, 2);
+}
+
+void LeaderElectionObject::GetEntities(const ajn::InterfaceDescription::Member* member, ajn::Message& message)
+{
+    QCC_DbgTrace(("%s", __func__));
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controller.CheckNumArgsInMessage(numArgs, 2)  != LSF_OK) {
+        MethodReply(message, ER_BAD_ARG_COUNT);
+        return;
+    }
+
+    election.ExtendOverthrowAlarm(message->GetSender());
+
+    LSFBlobType type = static_cast<LSFBlobType>(args[0].v_uint32);
+    MsgArg* idArray;
+    size_t numIds;
+    args[1].Get("as", &numIds, &idArray);
+
+    LSFStringList ids;
+    for (size_t i = 0; i < numIds; i++) {
+        char* id;
+        idArray[i].Get("s", &id);
+        ids.push_back(id);
+    }
+
+    StoreJournalRecordList records;
+    if (!GetLocalEntities(type, ids, records)) {
+        MethodReply(message, ER_FAIL);
+        return;
+    }
+
+    /*
+     * The caller fetches the whole blob, in chunks if need be, if the entities
+     * do not fit in one message
+     */
+    size_t replyLength = 0;
+    for (StoreJournalRecordList::const_iterator it = records.begin(); it != records.end(); ++it) {
+        replyLength += it->id.length() + it->data.length();
+    }
+    if (replyLength > BlobTransfer::INLINE_BLOB_LEN) {
+        QCC_DbgPrintf(("%s: %u entities are too long to send", __func__, (uint32_t) records.size()));
+        MethodReply(message, ER_FAIL);
+        return;
+    }
+
+    MsgArg* entityArray = new MsgArg[records.size()];
+    size_t i = 0;
+    for (StoreJournalRecordList::const_iterator it = records.begin(); it != records.end(); ++it, ++i) {
+        entityArray[i].Set("(ss)", it->id.c_str(), it->data.c_str());
+    }
+
+    MsgArg outArgs[2];
+    outArgs[0].Set("u", static_cast<uint32_t>(type));
+    outArgs[1].Set("a(ss)", records.size(), entityArray);
+    outArgs[1].SetOwnershipFlags(MsgArg::OwnsArgs, true);
+    MethodReply(message, outArgs, 2);
+}
+
+bool LeaderElectionObject::GetLocalHashTreeNodes(LSFBlobType type, uint32_t level, const std::vector<uint32_t>& nodes, std::vector<uint64_t>& hashes)
+{
+    switch (type) {
+    case LSF_PRESET:
+        controller.GetPresetManager().GetHashTreeNodes(level, nodes, hashes);
+        break;
+
+    case LSF_LAMP_GROUP:
+        controller.GetLampGroupManager().GetHashTreeNodes(level, nodes, hashes);
+        break;
+
+    case LSF_SCENE:
+        controller.GetSceneManager().GetHashTreeNodes(level, nodes, hashes);
+        break;
+
+    case LSF_MASTER_SCENE:
+        controller.GetMasterSceneManager().GetHashTreeNodes(level, nodes, hashes);
+        break;
+
+    default:
+        QCC_LogError(ER_FAIL, ("%s: Unsupported blob type requested", __func__));
+        return false;
+    }
+    return true;
+}
+
+bool LeaderElectionObject::GetLocalEntityHashes(LSFBlobType type, const std::vector<uint32_t>& buckets, StoreEntityHashList& entities)
+{
+    switch (type) {
+    case LSF_PRESET:
+        controller.GetPresetManager().GetEntityHashes(buckets, entities);
+        break;
+
+    case LSF_LAMP_GROUP:
+        controller.GetLampGroupManager().GetEntityHashes(buckets, entities);
+        break;
+
+    case LSF_SCENE:
+        controller.GetSceneManager().GetEntityHashes(buckets, entities);
+        break;
+
+    case LSF_MASTER_SCENE:
+        controller.GetMasterSceneManager().GetEntityHashes(buckets, entities);
+        break;
+
+    default:
+        QCC_LogError(ER_FAIL, ("%s: Unsupported blob type requested", __func__));
+        return false;
+    }
+    return true;
+}
+
+bool LeaderElectionObject::GetLocalEntities(LSFBlobType type, const LSFStringList& ids, StoreJournalRecordList& records)
+{
+    switch (type) {
+    case LSF_PRESET:
+        controller.GetPresetManager().GetEntities(ids, records);
+        break;
+
+    case LSF_LAMP_GROUP:
+        controller.GetLampGroupManager().GetEntities(ids, records);
+        break;
+
+    case LSF_SCENE:
+        controller.GetSceneManager().GetEntities(ids, records);
+        break;
+
+    case LSF_MASTER_SCENE:
+        controller.GetMasterSceneManager().GetEntities(ids, records);
+        break;
+
+    default:
+        QCC_LogError(ER_FAIL, ("%s: Unsupported blob type requested", __func__));
+        return false;
+    }
+    return true;
+}
+
+void LeaderElectionObject::HandleReconciledEntities(LSFBlobType type, const StoreJournalRecordList& records)
+{
+    if (records.empty()) {
+        return;
+    }
+
+    switch (type) {
+    case LSF_PRESET:
+        controller.GetPresetManager().HandleReconciledEntities(records);
+        break;
+
+    case LSF_LAMP_GROUP:
+        controller.GetLampGroupManager().HandleReconciledEntities(records);
+        break;
+
+    case LSF_SCENE:
+        controller.GetSceneManager().HandleReconciledEntities(records);
+        break;
+
+    case LSF_MASTER_SCENE:
+        controller.GetMasterSceneManager().HandleReconciledEntities(records);
+        break;
+
+    default:
+        QCC_LogError(ER_FAIL, ("%s: Unsupported blob type requested", __func__));
+        break;
+    }
+}
+
 void LeaderElectionObject::OnBlobChanged(const InterfaceDescription::Member* member, const char* sourcePath, Message& message)
 {
     QCC_DbgTrace(("%s", __func__));
@@ -1573,11 +1690,39 @@ void LeaderElectionObject::OnBlobChanged(const InterfaceDescription::Member* mem
         return;
     }
 
-    LSFBlobType type = static_cast<LSFBlobType>(args[0].v_uint32);
-    std::string blob = args[1].v_string.str;
-    uint32_t checksum = args[2].v_uint32;
-    uint64_t timestamp = args[3].v_uint64;
+    HandleReceivedBlob(static_cast<LSFBlobType>(args[0].v_uint32), args[1].v_string.str, args[2].v_uint32, args[3].v_uint64);
+}
+
+void LeaderElectionObject::OnBlobChunk(const InterfaceDescription::Member* member, const char* sourcePath, Message& message)
+{
+    QCC_DbgTrace(("%s", __func__));
+    bus.EnableConcurrentCallbacks();
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controller.CheckNumArgsInMessage(numArgs, 8)  != LSF_OK) {
+        return;
+    }
+
+    BlobChunk chunk;
+    chunk.type = args[0].v_uint32;
+    chunk.transferId = args[1].v_uint32;
+    chunk.index = args[2].v_uint32;
+    chunk.numChunks = args[3].v_uint32;
+    chunk.blobLength = args[4].v_uint32;
+    args[5].Get("ay", &chunk.dataLength, &chunk.data);
+    chunk.checksum = args[6].v_uint32;
+    chunk.timestamp = args[7].v_uint64;
+
+    std::string blob;
+    if (blobReassembler.AddChunk(message->GetSender(), chunk, blob)) {
+        HandleReceivedBlob(static_cast<LSFBlobType>(chunk.type), blob, chunk.checksum, chunk.timestamp);
+    }
+}
 
+void LeaderElectionObject::HandleReceivedBlob(LSFBlobType type, const std::string& blob, uint32_t checksum, uint64_t timestamp)
+{
     switch (type) {
     case LSF_PRESET:
         controller.GetPresetManager().HandleReceivedBlob(blob, checksum, timestamp);
@@ -1600,3 +1745,120 @@ void LeaderElectionObject::OnBlobChanged(const InterfaceDescription::Member* mem
         break;
     }
 }
+
+void LeaderElectionObject::OnBlobDelta(const InterfaceDescription::Member* member, const char* sourcePath, Message& message)
+{
+    QCC_DbgTrace(("%s", __func__));
+    bus.EnableConcurrentCallbacks();
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controller.CheckNumArgsInMessage(numArgs, 7)  != LSF_OK) {
+        return;
+    }
+
+    LSFBlobType type = static_cast<LSFBlobType>(args[0].v_uint32);
+    StoreChangeSet changes;
+    changes.fromSequence = args[1].v_uint32;
+    changes.toSequence = args[2].v_uint32;
+    changes.baseChecksum = args[3].v_uint32;
+    uint32_t checksum = args[5].v_uint32;
+    changes.checksum = checksum;
+
+    MsgArg* changeArray;
+    size_t numChanges;
+    args[4].Get("a(yssu)", &numChanges, &changeArray);
+
+    for (size_t i = 0; i < numChanges; i++) {
+        uint8_t changeType;
+        char* id;
+        char* data;
+        StoreJournalRecord record;
+        changeArray[i].Get("(yssu)", &changeType, &id, &data, &record.version);
+        record.type = static_cast<char>(changeType);
+        record.id = id;
+        record.data = data;
+        record.checksum = 0;
+        record.timestamp = 0;
+        if ((record.type != StoreJournal::RECORD_UPDATE) && (record.type != StoreJournal::RECORD_DELETE)) {
+            QCC_LogError(ER_FAIL, ("%s: Unsupported change type %c", __func__, record.type));
+            return;
+        }
+        changes.records.push_back(record);
+    }
+
+    QCC_DbgPrintf(("%s: type=%d sequence=%u-%u changes=%u timestamp=%llu", __func__, type, changes.fromSequence, changes.toSequence,
+                   (uint32_t) numChanges, args[6].v_uint64));
+
+    switch (type) {
+    case LSF_PRESET:
+        controller.GetPresetManager().HandleReceivedDelta(changes, checksum);
+        break;
+
+    case LSF_LAMP_GROUP:
+        controller.GetLampGroupManager().HandleReceivedDelta(changes, checksum);
+        break;
+
+    case LSF_SCENE:
+        controller.GetSceneManager().HandleReceivedDelta(changes, checksum);
+        break;
+
+    case LSF_MASTER_SCENE:
+        controller.GetMasterSceneManager().HandleReceivedDelta(changes, checksum);
+        break;
+
+    default:
+        QCC_LogError(ER_FAIL, ("%s: Unsupported blob type requested", __func__));
+        break;
+    }
+}
+
+void LeaderElectionObject::OnHeartbeat(const InterfaceDescription::Member* member, const char* sourcePath, Message& message)
+{
+    bus.EnableConcurrentCallbacks();
+    if (!election.OnHeartbeat(static_cast<uint32_t>(message->GetSessionId()), message->GetSender())) {
+        return;
+    }
+
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controller.CheckNumArgsInMessage(numArgs, 2)  != LSF_OK) {
+        return;
+    }
+
+    MsgArg* storeArray;
+    size_t numStores;
+    args[1].Get("a(uuu)", &numStores, &storeArray);
+
+    for (size_t i = 0; i < numStores; i++) {
+        uint32_t type;
+        uint32_t sequence;
+        uint32_t checksum;
+        storeArray[i].Get("(uuu)", &type, &sequence, &checksum);
+
+        switch (type) {
+        case LSF_PRESET:
+            controller.GetPresetManager().HandleLeaderStore(sequence, checksum);
+            break;
+
+        case LSF_LAMP_GROUP:
+            controller.GetLampGroupManager().HandleLeaderStore(sequence, checksum);
+            break;
+
+        case LSF_SCENE:
+            controller.GetSceneManager().HandleLeaderStore(sequence, checksum);
+            break;
+
+        case LSF_MASTER_SCENE:
+            controller.GetMasterSceneManager().HandleLeaderStore(sequence, checksum);
+            break;
+
+        default:
+            QCC_LogError(ER_FAIL, ("%s: Unsupported blob type %u", __func__, type));
+            break;
+        }
+    }
+}
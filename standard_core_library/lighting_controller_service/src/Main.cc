@@ -24,6 +24,7 @@
 #include <fstream>
 #include <sstream>
 #include <OEM_CS_Config.h>
+#include <Trace.h>
 
 #define QCC_MODULE "MAIN"
 
@@ -31,6 +32,7 @@
 static pid_t g_child_process = 0;
 static volatile sig_atomic_t g_running = true;
 static volatile sig_atomic_t isRunning = false;
+static volatile sig_atomic_t g_write_trace = false;
 
 static void SigIntHandler(int sig)
 {
@@ -48,6 +50,14 @@ static void SigTermHandler(int sig)
     }
 }
 
+static void SigUsr1Handler(int sig)
+{
+    g_write_trace = true;
+    if (g_child_process) {
+        kill(g_child_process, SIGUSR1);
+    }
+}
+
 static std::string factoryConfigFile = "OEMConfig.ini";
 static std::string configFile = "Config.ini";
 static std::string lampGroupFile = "LampGroups.lsf";
@@ -65,6 +75,11 @@ static std::string storeFilePath = storeFile;
 static std::string storeLocation;
 static bool runForeground = false;
 static bool disableBackgroundLogging = true;
+static std::string diagnosticsFile;
+static uint32_t diagnosticsIntervalMs = OEM_CS_DIAGNOSTICS_DUMP_INTERVAL_MS;
+static std::string traceFile;
+static bool profileLocks = false;
+static uint32_t threadCpuMask = OEM_CS_THREAD_CPU_AFFINITY_MASK;
 
 static void usage(int argc, char** argv)
 {
@@ -76,6 +91,11 @@ static void usage(int argc, char** argv)
     printf("   -k <absolute_directory_path>   = The absolute path to a directory required to store the AllJoyn KeyStore, Persistent Store and read/write the Config FilePaths\n\n");
     printf("   -v                    = Print the version number and exit\n");
     printf("   -l                    = Enable background logging\n");
+    printf("   -d <file>             = Periodically write the diagnostics of the Controller Service to a file\n");
+    printf("   -i <seconds>          = Time between two writes of the diagnostics file\n");
+    printf("   -t <file>             = Trace the requests. The trace is written to the file in the Chrome trace format on SIGUSR1 and on exit\n");
+    printf("   -a <cpu mask>         = Run the threads of the Controller Service on the CPUs of the mask, e.g. 0x3 for CPUs 0 and 1\n");
+    printf("   -c                    = Profile the lock contention. The stats are added to the diagnostics file. Requires a build with LSF_LOCK_PROFILING\n");
     printf("Default:\n");
     printf("    %s\n", argv[0]);
 }
@@ -115,6 +135,43 @@ static void parseCommandLine(int argc, char** argv)
             runForeground = true;
         } else if (0 == strcmp("-l", argv[i])) {
             disableBackgroundLogging = false;
+        } else if (0 == strcmp("-a", argv[i])) {
+            ++i;
+            if (i == argc) {
+                printf("option %s requires a parameter\n", argv[i - 1]);
+                usage(argc, argv);
+                exit(1);
+            } else {
+                threadCpuMask = strtoul(argv[i], NULL, 0);
+            }
+        } else if (0 == strcmp("-c", argv[i])) {
+            profileLocks = true;
+        } else if (0 == strcmp("-t", argv[i])) {
+            ++i;
+            if (i == argc) {
+                printf("option %s requires a parameter\n", argv[i - 1]);
+                usage(argc, argv);
+                exit(1);
+            } else {
+                traceFile = argv[i];
+            }
+        } else if (0 == strcmp("-d", argv[i]) || 0 == strcmp("-i", argv[i])) {
+            ++i;
+            if (i == argc) {
+                printf("option %s requires a parameter\n", argv[i - 1]);
+                usage(argc, argv);
+                exit(1);
+            } else if (0 == strcmp("-d", argv[i - 1])) {
+                diagnosticsFile = argv[i];
+            } else {
+                uint32_t seconds = strtoul(argv[i], NULL, 10);
+                if (seconds == 0) {
+                    printf("option %s requires a positive number of seconds\n", argv[i - 1]);
+                    usage(argc, argv);
+                    exit(1);
+                }
+                diagnosticsIntervalMs = seconds * 1000;
+            }
         } else {
             printf("Unknown option %s\n", argv[i]);
             usage(argc, argv);
@@ -140,6 +197,17 @@ void RunService(bool listenToInterrupts)
         signal(SIGTERM, SigTermHandler);
     }
 
+    if (!traceFile.empty()) {
+        signal(SIGUSR1, SigUsr1Handler);
+        lsf::Tracer::Enable(true);
+    }
+
+    lsf::Thread::SetDefaultAffinity(threadCpuMask);
+
+    if (profileLocks) {
+        lsf::LockProfiler::Enable(true);
+    }
+
 
     lsf::ControllerServiceManager* controllerSvcManagerPtr =
         new lsf::ControllerServiceManager(factoryConfigFilePath, configFilePath, lampGroupFilePath, presetFilePath, sceneFilePath, masterSceneFilePath);
@@ -153,9 +221,20 @@ void RunService(bool listenToInterrupts)
 
     isRunning = true;
 
+    if ((status == ER_OK) && !diagnosticsFile.empty()) {
+        QStatus dumpStatus = controllerSvcManagerPtr->GetControllerService().StartDiagnosticsDump(diagnosticsFile, diagnosticsIntervalMs);
+        if (dumpStatus != ER_OK) {
+            QCC_LogError(dumpStatus, ("%s: Failed to write the diagnostics to %s", __func__, diagnosticsFile.c_str()));
+        }
+    }
+
     if (status == ER_OK) {
         while (g_running && controllerSvcManagerPtr->IsRunning()) {
             lsf_Sleep(OEM_CS_TIMEOUT_MS_CONNECTED_TO_ROUTING_NODE);
+            if (g_write_trace) {
+                g_write_trace = false;
+                lsf::Tracer::WriteChromeTrace(traceFile);
+            }
         }
     }
 
@@ -169,6 +248,10 @@ void RunService(bool listenToInterrupts)
         QCC_DbgPrintf(("%s: After delete controllerSvcManagerPtr", __func__));
     }
 
+    if (!traceFile.empty()) {
+        lsf::Tracer::WriteChromeTrace(traceFile);
+    }
+
     isRunning = false;
 }
 
@@ -184,6 +267,9 @@ void RunAndMonitor()
 
     signal(SIGINT, SigIntHandler);
     signal(SIGTERM, SigTermHandler);
+    if (!traceFile.empty()) {
+        signal(SIGUSR1, SigUsr1Handler);
+    }
 
     while (g_running) {
         pid_t pid = fork();
@@ -15,14 +15,13 @@
  ******************************************************************************/
 
 #include <Manager.h>
+#include <BlobTransfer.h>
 
 #include <qcc/StringUtil.h>
 #include <qcc/Debug.h>
 
 #include <string>
-#include <fstream>
 #include <sstream>
-#include <streambuf>
 
 #include <ControllerService.h>
 
@@ -36,69 +35,62 @@ Manager::Manager(ControllerService& controllerSvc, const std::string& filePath)
     read(false),
     filePath(filePath),
     checkSum(0),
+    checkSumValid(false),
     timeStamp(0),
     blobUpdateCycle(false),
     initialState(false),
-    sendUpdate(false)
+    sendUpdate(false),
+    journal(filePath.empty() ? filePath : filePath + ".journal"),
+    snapshotRequired(false),
+    blobSequence(0),
+    blobSequenceValid(false),
+    resyncRequested(false),
+    storeHash(0),
+    syncedTimestamp(0)
 {
     QCC_DbgTrace(("%s", __func__));
     readBlobMessages.clear();
 }
 
-static uint32_t GetAdler32Checksum(const uint8_t* data, size_t len) {
-    QCC_DbgTrace(("%s: len = %d", __func__, len));
-    uint32_t adler = 1;
-    uint32_t adlerPrime = 65521;
-    uint32_t a = adler & 0xFFFF;
-    uint32_t b = adler >> 16;
-    while (data && len) {
-        a = (a + *data++) % adlerPrime;
-        b = (b + a) % adlerPrime;
-        len--;
-    }
-    adler = (b << 16) | a;
-    QCC_DbgTrace(("%s: adler=0x%x", __func__, adler));
-    return adler;
-}
-
 uint32_t Manager::GetChecksum(const std::string& str)
 {
     QCC_DbgTrace(("%s", __func__));
     return GetAdler32Checksum((uint8_t*) str.c_str(), str.length());
 }
 
-void Manager::WriteFileWithChecksumAndTimestamp(const std::string& str, uint32_t checksum, uint64_t timestamp)
+bool Manager::WriteFileWithChecksumAndTimestamp(const std::string& str, uint32_t checksum, uint64_t timestamp)
 {
     QCC_DbgTrace(("%s", __func__));
-    std::ofstream fstream(filePath.c_str(), std::ios_base::out);
-    if (!fstream.is_open()) {
-        QCC_LogError(ER_FAIL, ("File not found: %s\n", filePath.c_str()));
-        return;
-    }
-
-    fstream << timestamp << std::endl;
-    fstream << checksum << std::endl;
-    fstream << str;
-    fstream.close();
+    return StoreFile::Write(filePath, str, checksum, timestamp);
 }
 
-bool Manager::ValidateFileAndRead(std::istringstream& filestream)
+bool Manager::ValidateFileAndRead(StoreFile& file)
 {
     QCC_DbgTrace(("%s", __func__));
     uint32_t checksum;
     uint64_t timestamp;
 
-    bool b = ValidateFileAndReadInternal(checksum, timestamp, filestream);
+    hashTree.Invalidate();
+    bool b = ValidateFileAndReadInternal(checksum, timestamp, file);
 
     if (b) {
         checkSum = checksum;
+        checkSumValid = true;
         timeStamp = timestamp;
+
+        if (file.IsLegacyFormat()) {
+            QCC_DbgPrintf(("%s: Migrating %s to the binary store format", __func__, filePath.c_str()));
+            std::string data(file.GetPayload(), file.GetPayloadLength());
+            if (!WriteFileWithChecksumAndTimestamp(data, checksum, timestamp)) {
+                QCC_LogError(ER_FAIL, ("%s: Failed to migrate %s, keeping the text format", __func__, filePath.c_str()));
+            }
+        }
     }
 
     return b;
 }
 
-bool Manager::ValidateFileAndReadInternal(uint32_t& checksum, uint64_t& timestamp, std::istringstream& filestream)
+bool Manager::ValidateFileAndReadInternal(uint32_t& checksum, uint64_t& timestamp, StoreFile& file)
 {
     QCC_DbgPrintf(("%s: filePath=%s", __func__, filePath.c_str()));
 
@@ -106,34 +98,20 @@ bool Manager::ValidateFileAndReadInternal(uint32_t& checksum, uint64_t& timestam
         return false;
     }
 
-    std::ifstream stream(filePath.c_str());
-
-    if (!stream.is_open()) {
-        QCC_LogError(ER_FAIL, ("File not found: %s\n", filePath.c_str()));
+    if (!file.Open(filePath)) {
         return false;
     }
 
-    stream >> timestamp;
+    timestamp = file.GetTimestamp();
+    checksum = file.GetChecksum();
 
     uint64_t currenttime = GetTimestampInMs();
     QCC_DbgPrintf(("%s: timestamp=%llu", __func__, timestamp));
     QCC_DbgPrintf(("%s: Updated %llu ticks ago", __func__, (currenttime - timestamp)));
-
-    stream >> checksum;
-
     QCC_DbgPrintf(("%s: checksum=%u", __func__, checksum));
 
-    // put the rest of the file into the filestream
-    std::stringbuf rest;
-    stream >> &rest;
-    std::string data = rest.str();
-    filestream.str(data);
-
     // check the adler checksum
-    uint32_t adler = GetChecksum(data);
-
-    stream.close();
-    return adler == checksum;
+    return file.IsValid();
 }
 
 LSFString Manager::GenerateUniqueID(const LSFString& prefix) const
@@ -147,19 +125,264 @@ LSFString Manager::GenerateUniqueID(const LSFString& prefix) const
 void Manager::ScheduleFileWrite(bool blobUpdate, bool initState)
 {
     QCC_DbgTrace(("%s", __func__));
+    snapshotRequired = true;
+    pendingChanges.clear();
+    hashTree.Invalidate();
     updated = true;
     blobUpdateCycle = blobUpdate;
     initialState = initState;
     controllerService.ScheduleFileReadWrite(this);
 }
 
+void Manager::ScheduleEntityWrite(const LSFString& id, const std::string& entity)
+{
+    QCC_DbgTrace(("%s: id=%s", __func__, id.c_str()));
+    if (!snapshotRequired) {
+        StoreJournalRecord record = { StoreJournal::RECORD_UPDATE, id, entity, 0, 0, 0 };
+        pendingChanges.push_back(record);
+    }
+    hashTree.Update(id, entity);
+    updated = true;
+    blobUpdateCycle = false;
+    initialState = false;
+    controllerService.ScheduleFileReadWrite(this);
+}
+
+void Manager::ScheduleEntityDelete(const LSFString& id)
+{
+    QCC_DbgTrace(("%s: id=%s", __func__, id.c_str()));
+    if (!snapshotRequired) {
+        StoreJournalRecord record = { StoreJournal::RECORD_DELETE, id, std::string(), 0, 0, 0 };
+        pendingChanges.push_back(record);
+    }
+    hashTree.Remove(id);
+    updated = true;
+    blobUpdateCycle = false;
+    initialState = false;
+    controllerService.ScheduleFileReadWrite(this);
+}
+
+bool Manager::TakeStoreChanges(StoreChangeSet& changes)
+{
+    changes.records.clear();
+    if (!snapshotRequired) {
+        changes.records.swap(pendingChanges);
+    }
+    pendingChanges.clear();
+    snapshotRequired = false;
+
+    /*
+     * Only rebuilt after the whole store was replaced, which is written as a snapshot anyway
+     */
+    BuildHashTree();
+    changes.baseChecksum = storeHash;
+    storeHash = changes.checksum = hashTree.GetFoldedRootHash();
+    changes.fromSequence = blobSequence;
+    if (!blobUpdateCycle) {
+        /*
+         * A local change. Changes received from the leader keep their versions
+         */
+        blobSequence++;
+        for (StoreJournalRecordList::iterator it = changes.records.begin(); it != changes.records.end(); ++it) {
+            it->version = blobSequence;
+            if (it->type == StoreJournal::RECORD_DELETE) {
+                entityVersions.erase(it->id);
+            } else {
+                entityVersions[it->id] = blobSequence;
+            }
+        }
+    }
+    changes.toSequence = blobSequence;
+
+    if (changes.records.empty() || !journal.IsOpen()) {
+        return true;
+    }
+    if (journal.GetLength() >= JOURNAL_COMPACTION_THRESHOLD) {
+        QCC_DbgPrintf(("%s: Compacting the journal of %s", __func__, filePath.c_str()));
+        return true;
+    }
+    return false;
+}
+
+bool Manager::CommitToStore(const std::string& str, const StoreChangeSet& changes, uint32_t checksum, uint64_t timestamp)
+{
+    QCC_DbgTrace(("%s", __func__));
+    if (str.empty()) {
+        std::string journalRecords;
+        for (StoreJournalRecordList::const_iterator it = changes.records.begin(); it != changes.records.end(); ++it) {
+            StoreJournal::EncodeRecord(journalRecords, it->type, it->id, it->data);
+        }
+        StoreJournal::EncodeCommit(journalRecords, changes.checksum, timestamp);
+        if (!journal.Append(journalRecords)) {
+            QCC_LogError(ER_FAIL, ("%s: Failed to journal the changes of %s", __func__, filePath.c_str()));
+            return false;
+        }
+        return true;
+    }
+
+    /*
+     * The journal only moves onto the new snapshot once the snapshot is on
+     * disk, so a failed write leaves the old snapshot and its journal intact
+     */
+    if (!WriteFileWithChecksumAndTimestamp(str, checksum, timestamp)) {
+        QCC_LogError(ER_FAIL, ("%s: Failed to write the snapshot of %s", __func__, filePath.c_str()));
+        return false;
+    }
+    if (!journal.Reset(checksum, timestamp)) {
+        QCC_LogError(ER_FAIL, ("%s: Failed to reset the journal of %s", __func__, filePath.c_str()));
+        return false;
+    }
+    return true;
+}
+
+bool Manager::SendBlobUpdate(LSFBlobType type, const std::string& str, const StoreChangeSet& changes, uint32_t checksum, uint64_t timestamp)
+{
+    QCC_DbgTrace(("%s", __func__));
+    size_t deltaLength = 0;
+    for (StoreJournalRecordList::const_iterator it = changes.records.begin(); it != changes.records.end(); ++it) {
+        deltaLength += it->id.length() + it->data.length();
+    }
+
+    uint64_t currentTime = GetTimestampInMs();
+    if (!changes.records.empty() && (str.empty() || (deltaLength < str.length())) && (deltaLength < BlobTransfer::INLINE_BLOB_LEN)) {
+        controllerService.SendBlobDelta(type, changes, changes.checksum, (currentTime - timestamp));
+    } else if (str.empty()) {
+        return false;
+    } else {
+        controllerService.SendBlobUpdate(type, str, checksum, (currentTime - timestamp));
+    }
+    return true;
+}
+
+bool Manager::ApplyStoreChanges(const StoreChangeSet& changes)
+{
+    QCC_DbgPrintf(("%s: sequence=%u valid=%d delta=%u-%u", __func__, blobSequence, blobSequenceValid, changes.fromSequence, changes.toSequence));
+    BuildHashTree();
+    if (blobSequenceValid ? (changes.fromSequence != blobSequence) : (changes.baseChecksum != hashTree.GetFoldedRootHash())) {
+        QCC_DbgPrintf(("%s: Missed a change of %s", __func__, filePath.c_str()));
+        blobSequenceValid = false;
+        resyncRequested = true;
+        return false;
+    }
+
+    for (StoreJournalRecordList::const_iterator it = changes.records.begin(); it != changes.records.end(); ++it) {
+        std::map<LSFString, uint32_t>::iterator version = entityVersions.find(it->id);
+        if ((version != entityVersions.end()) && (version->second >= it->version)) {
+            continue;
+        }
+
+        ApplyJournalRecord(*it);
+        if (it->type == StoreJournal::RECORD_DELETE) {
+            entityVersions.erase(it->id);
+            hashTree.Remove(it->id);
+        } else {
+            entityVersions[it->id] = it->version;
+            hashTree.Update(it->id, it->data);
+        }
+
+        if (!snapshotRequired) {
+            pendingChanges.push_back(*it);
+        }
+    }
+
+    blobSequence = changes.toSequence;
+    blobSequenceValid = true;
+    return true;
+}
+
+bool Manager::CompleteStoreChanges(uint32_t checksum)
+{
+    QCC_DbgTrace(("%s", __func__));
+    BuildHashTree();
+    if (hashTree.GetFoldedRootHash() != checksum) {
+        QCC_LogError(ER_FAIL, ("%s: %s diverged from the leader", __func__, filePath.c_str()));
+        blobSequenceValid = false;
+        resyncRequested = true;
+        snapshotRequired = true;
+        pendingChanges.clear();
+        return false;
+    }
+
+    timeStamp = GetTimestampInMs();
+    checkSumValid = false;
+    updated = true;
+    blobUpdateCycle = true;
+    initialState = false;
+    controllerService.ScheduleFileReadWrite(this);
+    return true;
+}
+
+bool Manager::AcceptReceivedBlob(uint32_t checksum, uint64_t timestamp)
+{
+    uint64_t currentTimestamp = GetTimestampInMs();
+    bool accept = (resyncRequested || (timeStamp == 0) || ((currentTimestamp - timeStamp) > timestamp)) && (!checkSumValid || (checkSum != checksum));
+    resyncRequested = false;
+    if (accept) {
+        /*
+         * Deltas apply on top of this blob until they carry a sequence number again
+         */
+        blobSequenceValid = false;
+        entityVersions.clear();
+    }
+    return accept;
+}
+
+void Manager::ApplyReconciledEntities(const StoreJournalRecordList& records)
+{
+    QCC_DbgPrintf(("%s: %u entities of %s", __func__, (uint32_t) records.size(), filePath.c_str()));
+    for (StoreJournalRecordList::const_iterator it = records.begin(); it != records.end(); ++it) {
+        ApplyJournalRecord(*it);
+        entityVersions.erase(it->id);
+        if (it->type == StoreJournal::RECORD_DELETE) {
+            hashTree.Remove(it->id);
+        } else {
+            hashTree.Update(it->id, it->data);
+        }
+
+        if (!snapshotRequired) {
+            pendingChanges.push_back(*it);
+        }
+    }
+
+    blobSequenceValid = false;
+    resyncRequested = false;
+}
+
+bool Manager::ReplayJournal(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    StoreJournalRecordList records;
+    bool replayed = false;
+    if (journal.Replay(checkSum, timeStamp, records)) {
+        for (StoreJournalRecordList::const_iterator it = records.begin(); it != records.end(); ++it) {
+            if (it->type == StoreJournal::RECORD_COMMIT) {
+                timeStamp = it->timestamp;
+            } else {
+                ApplyJournalRecord(*it);
+                replayed = true;
+            }
+        }
+    } else {
+        journal.Reset(checkSum, timeStamp);
+    }
+
+    /*
+     * checkSum is the one of the snapshot; the replayed store is only
+     * serialized and checksummed again when it is next sent or compacted
+     */
+    checkSumValid = !replayed;
+    BuildHashTree();
+    storeHash = hashTree.GetFoldedRootHash();
+    return replayed;
+}
+
 void Manager::ScheduleFileRead(Message& message)
 {
     QCC_DbgTrace(("%s", __func__));
     readMutex.Lock();
     readBlobMessages.push_back(message);
     read = true;
-    controllerService.ScheduleFileReadWrite(this);
+    controllerService.ScheduleFileReadWrite(this, true);
     readMutex.Unlock();
 }
 
@@ -167,14 +390,57 @@ void Manager::TriggerUpdate(void)
 {
     QCC_DbgTrace(("%s", __func__));
     sendUpdate = true;
-    controllerService.ScheduleFileReadWrite(this);
+    controllerService.ScheduleFileReadWrite(this, true);
 }
 
 void Manager::GetBlobInfoInternal(uint32_t& checksum, uint64_t& timestamp)
 {
     QCC_DbgTrace(("%s", __func__));
-    checksum = checkSum;
+    checksum = hashTree.GetFoldedRootHash();
     timestamp = timeStamp;
 }
 
+void Manager::GetStoreSequenceInternal(uint32_t& sequence, uint32_t& checksum)
+{
+    sequence = blobSequence;
+    checksum = storeHash;
+}
+
+void Manager::CheckLeaderStore(uint32_t sequence, uint32_t checksum)
+{
+    if (resyncRequested) {
+        return;
+    }
+
+    BuildHashTree();
+    if (hashTree.GetFoldedRootHash() != checksum) {
+        return;
+    }
+
+    if (!blobSequenceValid) {
+        /*
+         * The whole blob matches the store of the leader, so the next delta
+         * starts at the sequence number of the leader
+         */
+        blobSequence = sequence;
+        blobSequenceValid = true;
+    }
+
+    /*
+     * A delta of the leader may still be on its way when the sequence numbers differ
+     */
+    if (blobSequence == sequence) {
+        syncedTimestamp = GetTimestampInMs();
+    }
+}
+
+bool Manager::GetReplicaAgeInternal(uint64_t& age)
+{
+    if (resyncRequested || !blobSequenceValid || (syncedTimestamp == 0)) {
+        return false;
+    }
+    age = GetTimestampInMs() - syncedTimestamp;
+    return true;
+}
+
 };
@@ -26,7 +26,7 @@ using namespace ajn;
 #define QCC_MODULE "MASTER_SCENE_MANAGER"
 
 MasterSceneManager::MasterSceneManager(ControllerService& controllerSvc, SceneManager& sceneMgr, const std::string& masterSceneFile) :
-    Manager(controllerSvc, masterSceneFile), sceneManager(sceneMgr), blobLength(0)
+    Manager(controllerSvc, masterSceneFile), masterScenesLock("MasterSceneManager.masterScenesLock"), sceneManager(sceneMgr), blobLength(0)
 {
     QCC_DbgTrace(("%s", __func__));
     masterScenes.clear();
@@ -260,7 +260,7 @@ void MasterSceneManager::SetMasterSceneName(Message& message)
                         it->second.first = newName;
                         responseCode = LSF_OK;
                         nameChanged = true;
-                        ScheduleFileWrite();
+                        ScheduleEntityWrite(masterSceneID, GetString(it->second.first, masterSceneID, it->second.second));
                     } else {
                         responseCode = LSF_ERR_RESOURCES;
                     }
@@ -339,7 +339,7 @@ void MasterSceneManager::CreateMasterScene(Message& message)
                     masterScenes[masterSceneID].first = name;
                     masterScenes[masterSceneID].second = masterScene;
                     created = true;
-                    ScheduleFileWrite();
+                    ScheduleEntityWrite(masterSceneID, newMasterSceneStr);
                 } else {
                     responseCode = LSF_ERR_RESOURCES;
                 }
@@ -415,7 +415,7 @@ void MasterSceneManager::UpdateMasterScene(Message& message)
                     masterScenes[masterSceneID].second = masterScene;
                     responseCode = LSF_OK;
                     updated = true;
-                    ScheduleFileWrite();
+                    ScheduleEntityWrite(masterSceneID, GetString(it->second.first, masterSceneID, masterScene));
                 } else {
                     responseCode = LSF_ERR_RESOURCES;
                 }
@@ -474,7 +474,7 @@ void MasterSceneManager::DeleteMasterScene(Message& message)
 
             responseCode = LSF_OK;
             deleted = true;
-            ScheduleFileWrite();
+            ScheduleEntityDelete(masterSceneID);
         }
         status = masterScenesLock.Unlock();
         if (ER_OK != status) {
@@ -537,6 +537,65 @@ void MasterSceneManager::GetMasterScene(Message& message)
     controllerService.SendMethodReply(message, outArgs, 3);
 }
 
+void MasterSceneManager::GetAllMasterScenes(Message& message)
+{
+    QCC_DbgPrintf(("%s: %s", __func__, message->ToString().c_str()));
+
+    LSFResponseCode responseCode = LSF_OK;
+    MasterSceneMap masterSceneMap;
+
+    MsgArg outArgs[3];
+
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerService.CheckNumArgsInMessage(numArgs, 1)  != LSF_OK) {
+        return;
+    }
+
+    const char* language;
+    args[0].Get("s", &language);
+
+    if (0 != strcmp("en", language)) {
+        QCC_LogError(ER_FAIL, ("%s: Language %s not supported", __func__, language));
+        responseCode = LSF_ERR_INVALID_ARGS;
+    } else {
+        responseCode = GetAllMasterScenes(masterSceneMap);
+    }
+
+    size_t numMasterScenes = (LSF_OK == responseCode) ? masterSceneMap.size() : 0;
+    if (numMasterScenes) {
+        MsgArg* masterSceneArray = new MsgArg[numMasterScenes];
+        size_t i = 0;
+        for (MasterSceneMap::const_iterator it = masterSceneMap.begin(); it != masterSceneMap.end(); it++, i++) {
+            const LSFStringList& scenes = it->second.second.scenes;
+
+            size_t numScenes = scenes.size();
+            const char** sceneList = NULL;
+            if (numScenes) {
+                sceneList = new const char*[numScenes];
+                size_t j = 0;
+                for (LSFStringList::const_iterator nit = scenes.begin(); nit != scenes.end(); nit++) {
+                    sceneList[j++] = nit->c_str();
+                }
+            }
+
+            masterSceneArray[i].Set("(ssas)", it->first.c_str(), it->second.first.c_str(), numScenes, sceneList);
+            delete [] sceneList;
+        }
+        outArgs[2].Set("a(ssas)", numMasterScenes, masterSceneArray);
+        outArgs[2].SetOwnershipFlags(MsgArg::OwnsArgs, true);
+    } else {
+        outArgs[2].Set("a(ssas)", 0, NULL);
+    }
+
+    outArgs[0].Set("u", responseCode);
+    outArgs[1].Set("s", language);
+
+    controllerService.SendMethodReply(message, outArgs, 3);
+}
+
 void MasterSceneManager::ApplyMasterScene(ajn::Message& message)
 {
     QCC_DbgPrintf(("%s: %s", __func__, message->ToString().c_str()));
@@ -589,8 +648,8 @@ void MasterSceneManager::ApplyMasterScene(ajn::Message& message)
 void MasterSceneManager::ReadSavedData()
 {
     QCC_DbgTrace(("%s", __func__));
-    std::istringstream stream;
-    if (!ValidateFileAndRead(stream)) {
+    StoreFile file;
+    if (!ValidateFileAndRead(file)) {
         /*
          * If there is no file present / CRC check failed on the file create a new
          * file with initialState entry
@@ -601,14 +660,33 @@ void MasterSceneManager::ReadSavedData()
         return;
     }
 
-    blobLength = stream.str().size();
+    blobLength = file.GetPayloadLength();
+    MemoryStreamBuf buffer(file.GetPayload(), file.GetPayloadLength());
+    std::istream stream(&buffer);
     ReplaceMap(stream);
+
+    ReplayJournal();
 }
 
-void MasterSceneManager::ReplaceMap(std::istringstream& stream)
+void MasterSceneManager::ApplyJournalRecord(const StoreJournalRecord& record)
+{
+    QCC_DbgPrintf(("%s: type=%c id=%s", __func__, record.type, record.id.c_str()));
+    MasterSceneMap::iterator it = masterScenes.find(record.id);
+    if (it != masterScenes.end()) {
+        blobLength -= GetString(it->second.first, it->first, it->second.second).length();
+        masterScenes.erase(it);
+    }
+    if (record.type == StoreJournal::RECORD_UPDATE) {
+        blobLength += record.data.length();
+        std::istringstream stream(record.data);
+        ReplaceMap(stream, true);
+    }
+}
+
+void MasterSceneManager::ReplaceMap(std::istream& stream, bool merge)
 {
     QCC_DbgTrace(("%s", __func__));
-    bool firstIteration = true;
+    bool firstIteration = !merge;
     while (!stream.eof()) {
         std::string token = ParseString(stream);
 
@@ -689,30 +767,34 @@ std::string MasterSceneManager::GetString(const MasterSceneMap& items)
     return stream.str();
 }
 
-bool MasterSceneManager::GetString(std::string& output, uint32_t& checksum, uint64_t& timestamp)
+bool MasterSceneManager::GetString(std::string& output, StoreChangeSet& changes, uint32_t& checksum, uint64_t& timestamp)
 {
     QCC_DbgTrace(("%s", __func__));
     MasterSceneMap mapCopy;
     mapCopy.clear();
     bool ret = false;
+    bool snapshot = false;
     output.clear();
 
     masterScenesLock.Lock();
     // we can't hold this lock for the entire time!
     if (updated) {
-        mapCopy = masterScenes;
+        snapshot = TakeStoreChanges(changes);
+        if (snapshot) {
+            mapCopy = masterScenes;
+        }
         updated = false;
         ret = true;
     }
     masterScenesLock.Unlock();
 
     if (ret) {
-        output = GetString(mapCopy);
+        if (snapshot) {
+            output = GetString(mapCopy);
+        }
         masterScenesLock.Lock();
         if (blobUpdateCycle) {
-            checksum = checkSum;
             timestamp = timeStamp;
-            blobUpdateCycle = false;
         } else {
             if (initialState) {
                 timeStamp = timestamp = 0UL;
@@ -720,8 +802,20 @@ bool MasterSceneManager::GetString(std::string& output, uint32_t& checksum, uint
             } else {
                 timeStamp = timestamp = GetTimestampInMs();
             }
+        }
+        if (!snapshot) {
+            /*
+             * Only the changes are journalled; the store is checksummed when it is next serialized
+             */
+            checksum = changes.checksum;
+            checkSumValid = false;
+        } else if (blobUpdateCycle && checkSumValid) {
+            checksum = checkSum;
+        } else {
             checkSum = checksum = GetChecksum(output);
+            checkSumValid = true;
         }
+        blobUpdateCycle = false;
         masterScenesLock.Unlock();
     }
 
@@ -733,16 +827,66 @@ void MasterSceneManager::HandleReceivedBlob(const std::string& blob, uint32_t ch
     QCC_DbgPrintf(("%s", __func__));
     uint64_t currentTimestamp = GetTimestampInMs();
     masterScenesLock.Lock();
-    if (((timeStamp == 0) || ((currentTimestamp - timeStamp) > timestamp)) && (checkSum != checksum)) {
+    if (AcceptReceivedBlob(checksum, timestamp)) {
         std::istringstream stream(blob.c_str());
         ReplaceMap(stream);
         timeStamp = currentTimestamp;
         checkSum = checksum;
+        checkSumValid = true;
         ScheduleFileWrite(true);
     }
     masterScenesLock.Unlock();
 }
 
+void MasterSceneManager::HandleReceivedDelta(const StoreChangeSet& changes, uint32_t checksum)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    masterScenesLock.Lock();
+    bool inSync = ApplyStoreChanges(changes);
+    if (inSync) {
+        inSync = CompleteStoreChanges(checksum);
+    }
+    masterScenesLock.Unlock();
+
+    if (!inSync) {
+        controllerService.GetLeaderElectionObj().RequestBlob(LSF_MASTER_SCENE);
+    }
+}
+
+void MasterSceneManager::HandleReconciledEntities(const StoreJournalRecordList& records)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    masterScenesLock.Lock();
+    ApplyReconciledEntities(records);
+    CompleteStoreChanges(hashTree.GetFoldedRootHash());
+    masterScenesLock.Unlock();
+}
+
+void MasterSceneManager::BuildHashTree(void)
+{
+    if (hashTree.IsBuilt()) {
+        return;
+    }
+
+    QCC_DbgPrintf(("%s: %u entities", __func__, (uint32_t) masterScenes.size()));
+    hashTree.Reset();
+    for (MasterSceneMap::const_iterator it = masterScenes.begin(); it != masterScenes.end(); ++it) {
+        hashTree.Update(it->first, GetString(it->second.first, it->first, it->second.second));
+    }
+}
+
+void MasterSceneManager::GetEntityRecords(const LSFStringList& ids, StoreJournalRecordList& records)
+{
+    records.clear();
+    for (LSFStringList::const_iterator id = ids.begin(); id != ids.end(); ++id) {
+        MasterSceneMap::const_iterator it = masterScenes.find(*id);
+        if (it != masterScenes.end()) {
+            StoreJournalRecord record = { StoreJournal::RECORD_UPDATE, it->first, GetString(it->second.first, it->first, it->second.second), 0, 0, 0 };
+            records.push_back(record);
+        }
+    }
+}
+
 void MasterSceneManager::ReadWriteFile()
 {
     QCC_DbgPrintf(("%s", __func__));
@@ -752,17 +896,22 @@ void MasterSceneManager::ReadWriteFile()
     }
 
     std::string output;
+    StoreChangeSet changes;
     uint32_t checksum;
     uint64_t timestamp;
     bool status = false;
 
-    status = GetString(output, checksum, timestamp);
+    status = GetString(output, changes, checksum, timestamp);
 
+    bool sendBlob = false;
     if (status) {
-        WriteFileWithChecksumAndTimestamp(output, checksum, timestamp);
+        if (!CommitToStore(output, changes, checksum, timestamp)) {
+            masterScenesLock.Lock();
+            ScheduleFileWrite(true);
+            masterScenesLock.Unlock();
+        }
         if (timestamp != 0UL) {
-            uint64_t currentTime = GetTimestampInMs();
-            controllerService.SendBlobUpdate(LSF_MASTER_SCENE, output, checksum, (currentTime - timestamp));
+            sendBlob = !SendBlobUpdate(LSF_MASTER_SCENE, output, changes, checksum, timestamp);
         }
     }
 
@@ -776,11 +925,22 @@ void MasterSceneManager::ReadWriteFile()
     }
     readMutex.Unlock();
 
-    if ((tempMessageList.size() || sendUpdate) && !status) {
-        std::istringstream stream;
-        status = ValidateFileAndReadInternal(checksum, timestamp, stream);
+    if ((tempMessageList.size() || sendUpdate || sendBlob) && output.empty() && !journal.IsEmpty()) {
+        /*
+         * The snapshot on disk does not include the journal
+         */
+        masterScenesLock.Lock();
+        MasterSceneMap mapCopy = masterScenes;
+        timestamp = timeStamp;
+        masterScenesLock.Unlock();
+        output = GetString(mapCopy);
+        checksum = GetChecksum(output);
+        status = true;
+    } else if ((tempMessageList.size() || sendUpdate || sendBlob) && output.empty()) {
+        StoreFile file;
+        status = ValidateFileAndReadInternal(checksum, timestamp, file);
         if (status) {
-            output = stream.str();
+            output.assign(file.GetPayload(), file.GetPayloadLength());
         } else {
             QCC_LogError(ER_FAIL, ("%s: MasterScene persistent store corrupted", __func__));
         }
@@ -794,6 +954,11 @@ void MasterSceneManager::ReadWriteFile()
         }
     }
 
+    if (sendBlob && status) {
+        uint64_t currentTime = GetTimestampInMs();
+        controllerService.SendBlobUpdate(LSF_MASTER_SCENE, output, checksum, (currentTime - timestamp));
+    }
+
     if (sendUpdate) {
         sendUpdate = false;
         uint64_t currentTime = GetTimestampInMs();
@@ -0,0 +1,242 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/Debug.h>
+#include <MethodExecutor.h>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace lsf;
+
+#define QCC_MODULE "METHOD_EXECUTOR"
+
+MethodExecutor::MethodExecutor(uint32_t numThreads)
+    : lock("MethodExecutor.lock"),
+    running(false),
+    numThreads(numThreads)
+{
+    QCC_DbgTrace(("%s", __func__));
+    for (uint32_t i = 0; i < METHOD_LANE_LAST_VALUE; i++) {
+        memset(&lanes[i].metrics, 0, sizeof(lanes[i].metrics));
+    }
+    SetLaneLimits(METHOD_LANE_LAMP_CONTROL, OEM_CS_LAMP_CONTROL_LANE_CONCURRENCY, OEM_CS_LAMP_CONTROL_LANE_QUEUE_DEPTH);
+    SetLaneLimits(METHOD_LANE_SCENE_APPLY, OEM_CS_SCENE_APPLY_LANE_CONCURRENCY, OEM_CS_SCENE_APPLY_LANE_QUEUE_DEPTH);
+    SetLaneLimits(METHOD_LANE_CONFIG, OEM_CS_CONFIG_LANE_CONCURRENCY, OEM_CS_CONFIG_LANE_QUEUE_DEPTH);
+}
+
+MethodExecutor::~MethodExecutor()
+{
+    QCC_DbgTrace(("%s", __func__));
+    Stop();
+    Join();
+}
+
+void MethodExecutor::SetLaneLimits(MethodLane lane, uint32_t concurrency, uint32_t queueDepth)
+{
+    QCC_DbgPrintf(("%s: lane=%d concurrency=%u queueDepth=%u", __func__, lane, concurrency, queueDepth));
+    if (lane >= METHOD_LANE_LAST_VALUE) {
+        return;
+    }
+
+    lock.Lock();
+    /*
+     * A lane that may not run any call would never empty its queue
+     */
+    lanes[lane].concurrency = concurrency ? concurrency : 1;
+    lanes[lane].queueDepth = queueDepth;
+    condition.Broadcast();
+    lock.Unlock();
+}
+
+QStatus MethodExecutor::Start(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+
+    lock.Lock();
+    if (running) {
+        lock.Unlock();
+        return ER_OK;
+    }
+    running = true;
+    for (uint32_t i = 0; i < METHOD_LANE_LAST_VALUE; i++) {
+        memset(&lanes[i].metrics, 0, sizeof(lanes[i].metrics));
+    }
+    lock.Unlock();
+
+    for (uint32_t i = 0; i < numThreads; i++) {
+        WorkerThread* worker = new WorkerThread(*this);
+        char name[LSF_THREAD_NAME_LEN];
+        snprintf(name, sizeof(name), "MethodWorker%u", i);
+        worker->SetName(name);
+        if (OEM_CS_METHOD_EXECUTOR_THREAD_NICE) {
+            worker->SetPriority(OEM_CS_METHOD_EXECUTOR_THREAD_NICE);
+        }
+        if (worker->Start() != ER_OK) {
+            delete worker;
+            QCC_LogError(ER_FAIL, ("%s: Failed to start worker thread %u", __func__, i));
+            break;
+        }
+        workers.push_back(worker);
+    }
+
+    if (workers.empty()) {
+        lock.Lock();
+        running = false;
+        lock.Unlock();
+        return ER_FAIL;
+    }
+
+    /*
+     * Run with the workers that started
+     */
+    return ER_OK;
+}
+
+bool MethodExecutor::Submit(MethodLane lane, Handler* handler, const ajn::Message& msg)
+{
+    if (lane >= METHOD_LANE_LAST_VALUE) {
+        lane = METHOD_LANE_CONFIG;
+    }
+
+    lock.Lock();
+    Lane& queue = lanes[lane];
+    if (!running || queue.queue.size() >= queue.queueDepth) {
+        queue.metrics.rejected++;
+        QCC_DbgPrintf(("%s: Rejected a call on lane %d with %u calls queued", __func__, lane, queue.metrics.queueDepth));
+        lock.Unlock();
+        return false;
+    }
+
+    queue.queue.push_back(QueuedCall(handler, msg));
+    queue.metrics.submitted++;
+    queue.metrics.queueDepth++;
+    if (queue.metrics.queueDepth > queue.metrics.peakQueueDepth) {
+        queue.metrics.peakQueueDepth = queue.metrics.queueDepth;
+    }
+    condition.Signal();
+    lock.Unlock();
+    return true;
+}
+
+MethodLane MethodExecutor::GetNextLane(void)
+{
+    for (uint32_t i = 0; i < METHOD_LANE_LAST_VALUE; i++) {
+        if (!lanes[i].queue.empty() && (lanes[i].metrics.running < lanes[i].concurrency)) {
+            return static_cast<MethodLane>(i);
+        }
+    }
+    return METHOD_LANE_LAST_VALUE;
+}
+
+void MethodExecutor::RunWorker(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    std::list<QueuedCall> call;
+
+    lock.Lock();
+    while (running) {
+        MethodLane next = GetNextLane();
+        if (next == METHOD_LANE_LAST_VALUE) {
+            condition.Wait(lock);
+            Thread::RecordWakeup(!running || (GetNextLane() != METHOD_LANE_LAST_VALUE));
+            continue;
+        }
+
+        Lane& lane = lanes[next];
+        call.splice(call.begin(), lane.queue, lane.queue.begin());
+        lane.metrics.queueDepth--;
+        lane.metrics.running++;
+
+        uint32_t queueTime = static_cast<uint32_t>(GetTimestampInMs() - call.front().timestamp);
+        lane.metrics.totalQueueTime += queueTime;
+        if (queueTime > lane.metrics.maxQueueTime) {
+            lane.metrics.maxQueueTime = queueTime;
+        }
+        lock.Unlock();
+
+        QueuedCall& queued = call.front();
+        {
+            TraceContext traceContext(queued.traceId, queued.traceStart);
+            if (queued.traceId) {
+                Tracer::Record(queued.traceId, "MethodExecutor queue", queued.traceQueued, GetTimestampInUs(), next);
+            }
+            TraceSpan traceSpan(queued.msg->GetMemberName());
+            queued.handler->Handle(queued.msg);
+        }
+        call.clear();
+
+        lock.Lock();
+        lane.metrics.running--;
+        lane.metrics.completed++;
+        /*
+         * The lane is under its limit again: a waiting worker may run its next call
+         */
+        if (!lane.queue.empty()) {
+            condition.Signal();
+        }
+    }
+    lock.Unlock();
+    QCC_DbgPrintf(("%s: Exited", __func__));
+}
+
+void MethodExecutor::Stop(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    std::list<QueuedCall> dropped;
+
+    lock.Lock();
+    running = false;
+    for (uint32_t i = 0; i < METHOD_LANE_LAST_VALUE; i++) {
+        LaneMetrics& metrics = lanes[i].metrics;
+        QCC_DbgPrintf(("%s: lane=%d submitted=%u rejected=%u completed=%u peakQueueDepth=%u maxQueueTime=%u dropped=%u", __func__, i,
+                       metrics.submitted, metrics.rejected, metrics.completed, metrics.peakQueueDepth, metrics.maxQueueTime, metrics.queueDepth));
+        metrics.rejected += metrics.queueDepth;
+        metrics.queueDepth = 0;
+        dropped.splice(dropped.end(), lanes[i].queue);
+    }
+    condition.Broadcast();
+    lock.Unlock();
+
+    /*
+     * Reply outside of the lock, as the workers do
+     */
+    for (std::list<QueuedCall>::iterator it = dropped.begin(); it != dropped.end(); ++it) {
+        it->handler->Reject(it->msg);
+    }
+}
+
+void MethodExecutor::Join(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    for (std::vector<WorkerThread*>::iterator it = workers.begin(); it != workers.end(); ++it) {
+        (*it)->Join();
+        delete *it;
+    }
+    workers.clear();
+}
+
+void MethodExecutor::GetLaneMetrics(MethodLane lane, LaneMetrics& metrics)
+{
+    if (lane >= METHOD_LANE_LAST_VALUE) {
+        memset(&metrics, 0, sizeof(metrics));
+        return;
+    }
+
+    lock.Lock();
+    metrics = lanes[lane].metrics;
+    lock.Unlock();
+}
@@ -18,57 +18,179 @@
 #include <PersistenceThread.h>
 #include <ControllerService.h>
 
+#include <algorithm>
+#include <string.h>
+
 using namespace lsf;
 
 #define QCC_MODULE "PERSISTED_THREAD"
 
-PersistenceThread::PersistenceThread(ControllerService& service)
+/*
+ * Events of the PersistenceThread
+ */
+#define PERSISTENCE_EVENT_DIRTY             0x1 /* A manager signalled a change, or the debounce window changed */
+#define PERSISTENCE_EVENT_DEBOUNCE_EXPIRED  0x2 /* The debounce window of the pending changes is over */
+
+PersistenceThread::PersistenceThread(ControllerService& service, uint32_t debounceWindowMs, Reactor& reactor)
     : service(service),
-    running(true)
+    reactor(reactor),
+    debounceTimer(reactor, this, PERSISTENCE_EVENT_DEBOUNCE_EXPIRED),
+    running(false),
+    dirtyLock("PersistenceThread.dirtyLock"),
+    urgent(false),
+    firstChangeTimestamp(0),
+    debounceWindow(debounceWindowMs),
+    numSignals(0),
+    numCommits(0)
 {
     QCC_DbgTrace(("%s", __func__));
+    memset(&metrics, 0, sizeof(metrics));
 }
 
 PersistenceThread::~PersistenceThread()
 {
     QCC_DbgTrace(("%s", __func__));
+    debounceTimer.SetInMs(0);
+    reactor.Cancel(this);
+    reactor.WaitIdle(this);
 }
 
-
-void PersistenceThread::Run()
+QStatus PersistenceThread::Start(void)
 {
     QCC_DbgTrace(("%s", __func__));
-    while (running) {
-        // wait!
-        semaphore.Wait();
-
-        if (running) {
-            service.GetLampGroupManager().ReadWriteFile();
-            service.GetMasterSceneManager().ReadWriteFile();
-            service.GetPresetManager().ReadWriteFile();
-            service.GetSceneManager().ReadWriteFile();
+    dirtyLock.Lock();
+    running = true;
+    bool dirty = !dirtyManagers.empty();
+    dirtyLock.Unlock();
+
+    if (dirty) {
+        reactor.Post(this, PERSISTENCE_EVENT_DIRTY);
+    }
+    return ER_OK;
+}
+
+void PersistenceThread::HandleEvents(uint32_t events)
+{
+    QCC_DbgTrace(("%s: events=0x%x", __func__, events));
+    dirtyLock.Lock();
+    if (!running || dirtyManagers.empty()) {
+        dirtyLock.Unlock();
+        return;
+    }
+
+    /*
+     * Let a burst of changes accumulate so that it is committed once
+     */
+    if (!urgent && debounceWindow) {
+        uint64_t elapsed = GetTimestampInMs() - firstChangeTimestamp;
+        if (elapsed < debounceWindow) {
+            debounceTimer.SetInMs(static_cast<uint32_t>(debounceWindow - elapsed));
+            dirtyLock.Unlock();
+            return;
         }
     }
-    QCC_DbgPrintf(("%s: Exited", __func__));
+    dirtyLock.Unlock();
+
+    CommitDirtyManagers();
 }
 
-void PersistenceThread::SignalReadWrite()
+void PersistenceThread::CommitDirtyManagers(void)
+{
+    std::list<Manager*> managers;
+    uint32_t signals;
+
+    commitLock.Lock();
+    dirtyLock.Lock();
+    managers.swap(dirtyManagers);
+    urgent = false;
+    signals = numSignals;
+    numSignals = 0;
+    dirtyLock.Unlock();
+
+    uint64_t start = GetTimestampInMs();
+    for (std::list<Manager*>::iterator it = managers.begin(); it != managers.end(); ++it) {
+        (*it)->ReadWriteFile();
+    }
+
+    if (!managers.empty()) {
+        uint32_t commitTime = static_cast<uint32_t>(GetTimestampInMs() - start);
+        dirtyLock.Lock();
+        metrics.writes += managers.size();
+        metrics.commits++;
+        metrics.totalCommitTime += commitTime;
+        metrics.lastCommitTime = commitTime;
+        if (commitTime > metrics.maxCommitTime) {
+            metrics.maxCommitTime = commitTime;
+        }
+        dirtyLock.Unlock();
+    }
+
+    numCommits += managers.size();
+    QCC_DbgPrintf(("%s: Committed %u stores for %u signals, %u commits so far", __func__, (uint32_t) managers.size(), signals, numCommits));
+    commitLock.Unlock();
+}
+
+void PersistenceThread::SignalReadWrite(Manager* manager, bool urgentRequest)
 {
     QCC_DbgTrace(("%s", __func__));
-    // signal
-    semaphore.Post();
+    dirtyLock.Lock();
+    /*
+     * Once the window of the first change is armed, later changes only join the commit
+     */
+    bool post = running && (dirtyManagers.empty() || (urgentRequest && !urgent));
+    if (dirtyManagers.empty()) {
+        firstChangeTimestamp = GetTimestampInMs();
+    }
+    if (std::find(dirtyManagers.begin(), dirtyManagers.end(), manager) == dirtyManagers.end()) {
+        dirtyManagers.push_back(manager);
+    }
+    urgent = urgent || urgentRequest;
+    numSignals++;
+    metrics.signals++;
+    dirtyLock.Unlock();
+
+    if (post) {
+        reactor.Post(this, PERSISTENCE_EVENT_DIRTY);
+    }
+}
+
+void PersistenceThread::SetDebounceWindow(uint32_t debounceWindowMs)
+{
+    QCC_DbgPrintf(("%s: debounceWindowMs=%u", __func__, debounceWindowMs));
+    dirtyLock.Lock();
+    debounceWindow = debounceWindowMs;
+    bool post = running;
+    dirtyLock.Unlock();
+
+    if (post) {
+        reactor.Post(this, PERSISTENCE_EVENT_DIRTY);
+    }
 }
 
 void PersistenceThread::Stop()
 {
     QCC_DbgTrace(("%s", __func__));
+    dirtyLock.Lock();
     running = false;
-    SignalReadWrite();
+    dirtyLock.Unlock();
+    debounceTimer.SetInMs(0);
+    reactor.Cancel(this);
+
+    /*
+     * Do not lose the changes that are still inside the debounce window
+     */
+    CommitDirtyManagers();
 }
 
 void PersistenceThread::Join()
 {
     QCC_DbgTrace(("%s", __func__));
-    Thread::Join();
+    reactor.WaitIdle(this);
 }
 
+void PersistenceThread::GetMetrics(PersistenceMetrics& persistenceMetrics)
+{
+    dirtyLock.Lock();
+    persistenceMetrics = metrics;
+    dirtyLock.Unlock();
+}
@@ -29,7 +29,7 @@ using namespace ajn;
 LSFString defaultLampStateID = "DefaultLampState";
 
 PresetManager::PresetManager(ControllerService& controllerSvc, SceneManager* sceneMgrPtr, const std::string& presetFile) :
-    Manager(controllerSvc, presetFile), sceneManagerPtr(sceneMgrPtr), blobLength(0)
+    Manager(controllerSvc, presetFile), presetsLock("PresetManager.presetsLock"), sceneManagerPtr(sceneMgrPtr), blobLength(0)
 {
     QCC_DbgTrace(("%s", __func__));
     presets.clear();
@@ -114,6 +114,7 @@ LSFResponseCode PresetManager::ResetDefaultState(void)
         QCC_DbgPrintf(("%s: Removing the default lamp state entry", __func__));
         blobLength -= GetString(it->second.first, defaultLampStateID, it->second.second).length();
         presets.erase(it);
+        hashTree.Remove(defaultLampStateID);
         erased = true;
     }
     presetsLock.Unlock();
@@ -284,7 +285,7 @@ void PresetManager::SetPresetName(Message& msg)
                         it->second.first = newName;
                         responseCode = LSF_OK;
                         nameChanged = true;
-                        ScheduleFileWrite();
+                        ScheduleEntityWrite(presetID, GetString(it->second.first, presetID, it->second.second));
                     } else {
                         responseCode = LSF_ERR_RESOURCES;
                     }
@@ -361,7 +362,7 @@ void PresetManager::CreatePreset(Message& msg)
                     presets[presetID].first = name;
                     presets[presetID].second = preset;
                     created = true;
-                    ScheduleFileWrite();
+                    ScheduleEntityWrite(presetID, newPresetStr);
                 } else {
                     responseCode = LSF_ERR_RESOURCES;
                 }
@@ -437,7 +438,7 @@ void PresetManager::UpdatePreset(Message& msg)
                     presets[presetID].second = preset;
                     responseCode = LSF_OK;
                     updated = true;
-                    ScheduleFileWrite();
+                    ScheduleEntityWrite(presetID, GetString(it->second.first, presetID, preset));
                 } else {
                     responseCode = LSF_ERR_RESOURCES;
                 }
@@ -496,7 +497,7 @@ void PresetManager::DeletePreset(Message& msg)
                 blobLength -= GetString(it->second.first, presetId, it->second.second).length();
                 presets.erase(it);
                 deleted = true;
-                ScheduleFileWrite();
+                ScheduleEntityDelete(presetID);
             } else {
                 responseCode = LSF_ERR_NOT_FOUND;
             }
@@ -539,11 +540,12 @@ void PresetManager::GetPreset(Message& msg)
     args[0].Get("s", &presetId);
 
     LampState preset;
+    LampStateMsgArgs presetArgs;
 
     responseCode = GetPresetInternal(presetId, preset);
 
     if (LSF_OK == responseCode) {
-        preset.Get(&outArgs[2]);
+        preset.Get(&outArgs[2], presetArgs);
     } else {
         outArgs[2].Set("a{sv}", 0, NULL);
     }
@@ -554,17 +556,71 @@ void PresetManager::GetPreset(Message& msg)
     controllerService.SendMethodReply(msg, outArgs, 3);
 }
 
+void PresetManager::GetAllPresets(Message& msg)
+{
+    QCC_DbgPrintf(("%s: %s", __func__, msg->ToString().c_str()));
+
+    LSFResponseCode responseCode = LSF_OK;
+    PresetMap presetMap;
+
+    MsgArg outArgs[3];
+
+    size_t numArgs;
+    const MsgArg* args;
+    msg->GetArgs(numArgs, args);
+
+    if (controllerService.CheckNumArgsInMessage(numArgs, 1)  != LSF_OK) {
+        return;
+    }
+
+    const char* language;
+    args[0].Get("s", &language);
+
+    if (0 != strcmp("en", language)) {
+        QCC_LogError(ER_FAIL, ("%s: Language %s not supported", __func__, language));
+        responseCode = LSF_ERR_INVALID_ARGS;
+    } else {
+        responseCode = GetAllPresets(presetMap);
+    }
+
+    size_t numPresets = (LSF_OK == responseCode) ? presetMap.size() : 0;
+    if (numPresets) {
+        MsgArg* presetArray = new MsgArg[numPresets];
+        size_t i = 0;
+        for (PresetMap::const_iterator it = presetMap.begin(); it != presetMap.end(); it++, i++) {
+            size_t stateArgsSize;
+            MsgArg* stateArgs;
+            MsgArg stateArg;
+
+            it->second.second.Get(&stateArg);
+            stateArg.Get("a{sv}", &stateArgsSize, &stateArgs);
+
+            presetArray[i].Set("(ssa{sv})", it->first.c_str(), it->second.first.c_str(), stateArgsSize, stateArgs);
+        }
+        outArgs[2].Set("a(ssa{sv})", numPresets, presetArray);
+        outArgs[2].SetOwnershipFlags(MsgArg::OwnsArgs, true);
+    } else {
+        outArgs[2].Set("a(ssa{sv})", 0, NULL);
+    }
+
+    outArgs[0].Set("u", responseCode);
+    outArgs[1].Set("s", language);
+
+    controllerService.SendMethodReply(msg, outArgs, 3);
+}
+
 void PresetManager::GetDefaultLampState(Message& msg)
 {
     QCC_DbgPrintf(("%s: %s", __func__, msg->ToString().c_str()));
 
     LSFResponseCode responseCode = LSF_ERR_BUSY;
     LampState preset;
+    LampStateMsgArgs presetArgs;
 
     MsgArg outArgs[2];
 
     if (LSF_OK == GetDefaultLampStateInternal(preset)) {
-        preset.Get(&outArgs[1]);
+        preset.Get(&outArgs[1], presetArgs);
         responseCode = LSF_OK;
     } else {
         outArgs[1].Set("a{sv}", 0, NULL);
@@ -634,7 +690,7 @@ LSFResponseCode PresetManager::SetDefaultLampStateInternal(LampState& preset)
             if (newlen < MAX_FILE_LEN) {
                 blobLength = newlen;
                 it->second.second = preset;
-                ScheduleFileWrite();
+                ScheduleEntityWrite(presetID, GetString(it->second.first, presetID, preset));
             } else {
                 responseCode = LSF_ERR_RESOURCES;
             }
@@ -644,7 +700,7 @@ LSFResponseCode PresetManager::SetDefaultLampStateInternal(LampState& preset)
             if (newlen < MAX_FILE_LEN) {
                 blobLength = newlen;
                 presets[presetID] = std::make_pair(presetID, preset);
-                ScheduleFileWrite();
+                ScheduleEntityWrite(presetID, GetString(presetID, presetID, preset));
             } else {
                 responseCode = LSF_ERR_RESOURCES;
             }
@@ -679,8 +735,8 @@ LSFResponseCode PresetManager::SetDefaultLampStateInternal(LampState& preset)
 void PresetManager::ReadSavedData(void)
 {
     QCC_DbgTrace(("%s", __func__));
-    std::istringstream stream;
-    if (!ValidateFileAndRead(stream)) {
+    StoreFile file;
+    if (!ValidateFileAndRead(file)) {
         /*
          * If there is no file present / CRC check failed on the file create a new
          * file with initialState entry
@@ -691,8 +747,27 @@ void PresetManager::ReadSavedData(void)
         return;
     }
 
-    blobLength = stream.str().size();
+    blobLength = file.GetPayloadLength();
+    MemoryStreamBuf buffer(file.GetPayload(), file.GetPayloadLength());
+    std::istream stream(&buffer);
     ReplaceMap(stream);
+
+    ReplayJournal();
+}
+
+void PresetManager::ApplyJournalRecord(const StoreJournalRecord& record)
+{
+    QCC_DbgPrintf(("%s: type=%c id=%s", __func__, record.type, record.id.c_str()));
+    PresetMap::iterator it = presets.find(record.id);
+    if (it != presets.end()) {
+        blobLength -= GetString(it->second.first, it->first, it->second.second).length();
+        presets.erase(it);
+    }
+    if (record.type == StoreJournal::RECORD_UPDATE) {
+        blobLength += record.data.length();
+        std::istringstream stream(record.data);
+        ReplaceMap(stream, true);
+    }
 }
 
 void PresetManager::HandleReceivedBlob(const std::string& blob, uint32_t checksum, uint64_t timestamp)
@@ -700,20 +775,70 @@ void PresetManager::HandleReceivedBlob(const std::string& blob, uint32_t checksu
     QCC_DbgPrintf(("%s", __func__));
     uint64_t currentTimestamp = GetTimestampInMs();
     presetsLock.Lock();
-    if (((timeStamp == 0) || ((currentTimestamp - timeStamp) > timestamp)) && (checkSum != checksum)) {
+    if (AcceptReceivedBlob(checksum, timestamp)) {
         std::istringstream stream(blob.c_str());
         ReplaceMap(stream);
         timeStamp = currentTimestamp;
         checkSum = checksum;
+        checkSumValid = true;
         ScheduleFileWrite(true);
     }
     presetsLock.Unlock();
 }
 
-void PresetManager::ReplaceMap(std::istringstream& stream)
+void PresetManager::HandleReceivedDelta(const StoreChangeSet& changes, uint32_t checksum)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    presetsLock.Lock();
+    bool inSync = ApplyStoreChanges(changes);
+    if (inSync) {
+        inSync = CompleteStoreChanges(checksum);
+    }
+    presetsLock.Unlock();
+
+    if (!inSync) {
+        controllerService.GetLeaderElectionObj().RequestBlob(LSF_PRESET);
+    }
+}
+
+void PresetManager::HandleReconciledEntities(const StoreJournalRecordList& records)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    presetsLock.Lock();
+    ApplyReconciledEntities(records);
+    CompleteStoreChanges(hashTree.GetFoldedRootHash());
+    presetsLock.Unlock();
+}
+
+void PresetManager::BuildHashTree(void)
+{
+    if (hashTree.IsBuilt()) {
+        return;
+    }
+
+    QCC_DbgPrintf(("%s: %u entities", __func__, (uint32_t) presets.size()));
+    hashTree.Reset();
+    for (PresetMap::const_iterator it = presets.begin(); it != presets.end(); ++it) {
+        hashTree.Update(it->first, GetString(it->second.first, it->first, it->second.second));
+    }
+}
+
+void PresetManager::GetEntityRecords(const LSFStringList& ids, StoreJournalRecordList& records)
+{
+    records.clear();
+    for (LSFStringList::const_iterator id = ids.begin(); id != ids.end(); ++id) {
+        PresetMap::const_iterator it = presets.find(*id);
+        if (it != presets.end()) {
+            StoreJournalRecord record = { StoreJournal::RECORD_UPDATE, it->first, GetString(it->second.first, it->first, it->second.second), 0, 0, 0 };
+            records.push_back(record);
+        }
+    }
+}
+
+void PresetManager::ReplaceMap(std::istream& stream, bool merge)
 {
     QCC_DbgTrace(("%s", __func__));
-    bool firstIteration = true;
+    bool firstIteration = !merge;
     while (!stream.eof()) {
         std::string token = ParseString(stream);
 
@@ -794,29 +919,33 @@ std::string PresetManager::GetString(const PresetMap& items)
     return stream.str();
 }
 
-bool PresetManager::GetString(std::string& output, uint32_t& checksum, uint64_t& timestamp)
+bool PresetManager::GetString(std::string& output, StoreChangeSet& changes, uint32_t& checksum, uint64_t& timestamp)
 {
     PresetMap mapCopy;
     mapCopy.clear();
     bool ret = false;
+    bool snapshot = false;
     output.clear();
 
     presetsLock.Lock();
     // we can't hold this lock for the entire time!
     if (updated) {
-        mapCopy = presets;
+        snapshot = TakeStoreChanges(changes);
+        if (snapshot) {
+            mapCopy = presets;
+        }
         updated = false;
         ret = true;
     }
     presetsLock.Unlock();
 
     if (ret) {
-        output = GetString(mapCopy);
+        if (snapshot) {
+            output = GetString(mapCopy);
+        }
         presetsLock.Lock();
         if (blobUpdateCycle) {
-            checksum = checkSum;
             timestamp = timeStamp;
-            blobUpdateCycle = false;
         } else {
             if (initialState) {
                 timeStamp = timestamp = 0UL;
@@ -824,8 +953,20 @@ bool PresetManager::GetString(std::string& output, uint32_t& checksum, uint64_t&
             } else {
                 timeStamp = timestamp = GetTimestampInMs();
             }
+        }
+        if (!snapshot) {
+            /*
+             * Only the changes are journalled; the store is checksummed when it is next serialized
+             */
+            checksum = changes.checksum;
+            checkSumValid = false;
+        } else if (blobUpdateCycle && checkSumValid) {
+            checksum = checkSum;
+        } else {
             checkSum = checksum = GetChecksum(output);
+            checkSumValid = true;
         }
+        blobUpdateCycle = false;
         presetsLock.Unlock();
     }
 
@@ -841,17 +982,22 @@ void PresetManager::ReadWriteFile()
     }
 
     std::string output;
+    StoreChangeSet changes;
     uint32_t checksum;
     uint64_t timestamp;
     bool status = false;
 
-    status = GetString(output, checksum, timestamp);
+    status = GetString(output, changes, checksum, timestamp);
 
+    bool sendBlob = false;
     if (status) {
-        WriteFileWithChecksumAndTimestamp(output, checksum, timestamp);
+        if (!CommitToStore(output, changes, checksum, timestamp)) {
+            presetsLock.Lock();
+            ScheduleFileWrite(true);
+            presetsLock.Unlock();
+        }
         if (timestamp != 0UL) {
-            uint64_t currentTime = GetTimestampInMs();
-            controllerService.SendBlobUpdate(LSF_PRESET, output, checksum, (currentTime - timestamp));
+            sendBlob = !SendBlobUpdate(LSF_PRESET, output, changes, checksum, timestamp);
         }
     }
 
@@ -865,11 +1011,22 @@ void PresetManager::ReadWriteFile()
     }
     readMutex.Unlock();
 
-    if ((tempMessageList.size() || sendUpdate) && !status) {
-        std::istringstream stream;
-        status = ValidateFileAndReadInternal(checksum, timestamp, stream);
+    if ((tempMessageList.size() || sendUpdate || sendBlob) && output.empty() && !journal.IsEmpty()) {
+        /*
+         * The snapshot on disk does not include the journal
+         */
+        presetsLock.Lock();
+        PresetMap mapCopy = presets;
+        timestamp = timeStamp;
+        presetsLock.Unlock();
+        output = GetString(mapCopy);
+        checksum = GetChecksum(output);
+        status = true;
+    } else if ((tempMessageList.size() || sendUpdate || sendBlob) && output.empty()) {
+        StoreFile file;
+        status = ValidateFileAndReadInternal(checksum, timestamp, file);
         if (status) {
-            output = stream.str();
+            output.assign(file.GetPayload(), file.GetPayloadLength());
         } else {
             QCC_LogError(ER_FAIL, ("%s: Preset persistent store corrupted", __func__));
         }
@@ -883,6 +1040,11 @@ void PresetManager::ReadWriteFile()
         }
     }
 
+    if (sendBlob && status) {
+        uint64_t currentTime = GetTimestampInMs();
+        controllerService.SendBlobUpdate(LSF_PRESET, output, checksum, (currentTime - timestamp));
+    }
+
     if (sendUpdate) {
         sendUpdate = false;
         uint64_t currentTime = GetTimestampInMs();
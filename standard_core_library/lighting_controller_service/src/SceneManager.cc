@@ -21,6 +21,7 @@
 #include <MasterSceneManager.h>
 #include <OEM_CS_Config.h>
 #include <FileParser.h>
+#include <Trace.h>
 
 using namespace lsf;
 using namespace ajn;
@@ -155,7 +156,7 @@ void SceneObject::ObjectRegistered(void)
 }
 
 SceneManager::SceneManager(ControllerService& controllerSvc, LampGroupManager& lampGroupMgr, MasterSceneManager* masterSceneMgr, const std::string& sceneFile) :
-    Manager(controllerSvc, sceneFile), lampGroupManager(lampGroupMgr), masterSceneManager(masterSceneMgr), blobLength(0)
+    Manager(controllerSvc, sceneFile), scenesLock("SceneManager.scenesLock"), lampGroupManager(lampGroupMgr), masterSceneManager(masterSceneMgr), blobLength(0)
 {
     QCC_DbgPrintf(("%s", __func__));
     scenes.clear();
@@ -436,7 +437,7 @@ void SceneManager::SetSceneName(Message& message)
                         it->second->sceneNameMutex.Unlock();
                         responseCode = LSF_OK;
                         nameChanged = true;
-                        ScheduleFileWrite();
+                        ScheduleEntityWrite(sceneID, GetString(newName, sceneID, it->second->scene));
                     } else {
                         it->second->sceneNameMutex.Unlock();
                         responseCode = LSF_ERR_RESOURCES;
@@ -515,7 +516,7 @@ void SceneManager::CreateScene(Message& message)
                         blobLength = newlen;
                         scenes.insert(std::make_pair(sceneID, newObj));
                         created = true;
-                        ScheduleFileWrite();
+                        ScheduleEntityWrite(sceneID, newSceneStr);
                     } else {
                         QCC_LogError(ER_FAIL, ("%s: Could not allocate memory for new SceneObject", __func__));
                         responseCode = LSF_ERR_RESOURCES;
@@ -594,7 +595,7 @@ void SceneManager::UpdateScene(Message& message)
                     it->second->scene = scene;
                     responseCode = LSF_OK;
                     updated = true;
-                    ScheduleFileWrite();
+                    ScheduleEntityWrite(sceneID, GetString(it->second->sceneName, sceneID, scene));
                 } else {
                     responseCode = LSF_ERR_RESOURCES;
                 }
@@ -656,7 +657,7 @@ void SceneManager::DeleteScene(Message& message)
                 sceneObjPtr = it->second;
                 scenes.erase(it);
                 deleted = true;
-                ScheduleFileWrite();
+                ScheduleEntityDelete(sceneID);
             } else {
                 responseCode = LSF_ERR_NOT_FOUND;
             }
@@ -728,6 +729,75 @@ void SceneManager::GetScene(Message& message)
     controllerService.SendMethodReply(message, outArgs, 6);
 }
 
+void SceneManager::GetAllScenes(Message& message)
+{
+    QCC_DbgPrintf(("%s: %s", __func__, message->ToString().c_str()));
+
+    LSFResponseCode responseCode = LSF_OK;
+    SceneMap sceneMap;
+
+    MsgArg outArgs[3];
+
+    size_t numArgs;
+    const MsgArg* args;
+    message->GetArgs(numArgs, args);
+
+    if (controllerService.CheckNumArgsInMessage(numArgs, 1)  != LSF_OK) {
+        return;
+    }
+
+    const char* language;
+    args[0].Get("s", &language);
+
+    if (0 != strcmp("en", language)) {
+        QCC_LogError(ER_FAIL, ("%s: Language %s not supported", __func__, language));
+        responseCode = LSF_ERR_INVALID_ARGS;
+    } else {
+        responseCode = GetAllScenes(sceneMap);
+    }
+
+    size_t numScenes = (LSF_OK == responseCode) ? sceneMap.size() : 0;
+    if (numScenes) {
+        MsgArg* sceneArray = new MsgArg[numScenes];
+        size_t i = 0;
+        for (SceneMap::const_iterator it = sceneMap.begin(); it != sceneMap.end(); it++, i++) {
+            MsgArg transitionToStateComponentList;
+            MsgArg transitionToPresetComponentList;
+            MsgArg pulseWithStateComponentList;
+            MsgArg pulseWithPresetComponentList;
+            it->second.second.Get(&transitionToStateComponentList, &transitionToPresetComponentList, &pulseWithStateComponentList, &pulseWithPresetComponentList);
+
+            size_t transitionToStateSize, transitionToPresetSize, pulseWithStateSize, pulseWithPresetSize;
+            MsgArg* transitionToState;
+            MsgArg* transitionToPreset;
+            MsgArg* pulseWithState;
+            MsgArg* pulseWithPreset;
+            transitionToStateComponentList.Get("a(asasa{sv}u)", &transitionToStateSize, &transitionToState);
+            transitionToPresetComponentList.Get("a(asassu)", &transitionToPresetSize, &transitionToPreset);
+            pulseWithStateComponentList.Get("a(asasa{sv}a{sv}uuu)", &pulseWithStateSize, &pulseWithState);
+            pulseWithPresetComponentList.Get("a(asasssuuu)", &pulseWithPresetSize, &pulseWithPreset);
+
+            sceneArray[i].Set("(ssa(asasa{sv}u)a(asassu)a(asasa{sv}a{sv}uuu)a(asasssuuu))", it->first.c_str(), it->second.first.c_str(),
+                              transitionToStateSize, transitionToState, transitionToPresetSize, transitionToPreset,
+                              pulseWithStateSize, pulseWithState, pulseWithPresetSize, pulseWithPreset);
+            /*
+             * The component lists are owned by the temporaries above,
+             * so take a private copy before they go out of scope
+             */
+            sceneArray[i].Stabilize();
+        }
+        outArgs[2].Set("a(ssa(asasa{sv}u)a(asassu)a(asasa{sv}a{sv}uuu)a(asasssuuu))", numScenes, sceneArray);
+        outArgs[2].SetOwnershipFlags(MsgArg::OwnsArgs);
+    } else {
+        outArgs[2].Set("a(ssa(asasa{sv}u)a(asassu)a(asasa{sv}a{sv}uuu)a(asasssuuu))", 0, NULL);
+    }
+
+    outArgs[0].Set("u", responseCode);
+    outArgs[1].Set("s", language);
+
+    controllerService.SendMethodReply(message, outArgs, 3);
+}
+
 void SceneManager::SendSceneOrMasterSceneAppliedSignal(LSFString& sceneorMasterSceneId)
 {
     QCC_DbgPrintf(("%s: %s", __func__, sceneorMasterSceneId.c_str()));
@@ -787,6 +857,7 @@ void SceneManager::ApplyScene(ajn::Message& message)
 LSFResponseCode SceneManager::ApplySceneInternal(ajn::Message message, LSFStringList& sceneList, LSFString sceneOrMasterSceneId)
 {
     QCC_DbgPrintf(("%s: sceneList.size() = %d", __func__, sceneList.size()));
+    TraceSpan traceSpan("SceneManager::ApplySceneInternal", sceneList.size());
     LSFResponseCode responseCode = LSF_OK;
     bool invokeChangeState = false;
 
@@ -863,8 +934,8 @@ LSFResponseCode SceneManager::ApplySceneInternal(ajn::Message message, LSFString
 void SceneManager::ReadSavedData()
 {
     QCC_DbgTrace(("%s", __func__));
-    std::istringstream stream;
-    if (!ValidateFileAndRead(stream)) {
+    StoreFile file;
+    if (!ValidateFileAndRead(file)) {
         /*
          * If there is no file present / CRC check failed on the file create a new
          * file with initialState entry
@@ -875,14 +946,34 @@ void SceneManager::ReadSavedData()
         return;
     }
 
-    blobLength = stream.str().size();
+    blobLength = file.GetPayloadLength();
+    MemoryStreamBuf buffer(file.GetPayload(), file.GetPayloadLength());
+    std::istream stream(&buffer);
     ReplaceMap(stream);
+
+    ReplayJournal();
+}
+
+void SceneManager::ApplyJournalRecord(const StoreJournalRecord& record)
+{
+    QCC_DbgPrintf(("%s: type=%c id=%s", __func__, record.type, record.id.c_str()));
+    SceneObjectMap::iterator it = scenes.find(record.id);
+    if (it != scenes.end()) {
+        blobLength -= GetString(it->second->sceneName, it->first, it->second->scene).length();
+        delete it->second;
+        scenes.erase(it);
+    }
+    if (record.type == StoreJournal::RECORD_UPDATE) {
+        blobLength += record.data.length();
+        std::istringstream stream(record.data);
+        ReplaceMap(stream, true);
+    }
 }
 
-void SceneManager::ReplaceMap(std::istringstream& stream)
+void SceneManager::ReplaceMap(std::istream& stream, bool merge)
 {
     QCC_DbgTrace(("%s", __func__));
-    bool firstIteration = true;
+    bool firstIteration = !merge;
     while (!stream.eof()) {
         std::string token;
         std::string id;
@@ -1144,29 +1235,33 @@ std::string SceneManager::GetString(const SceneObjectMap& items)
     return stream.str();
 }
 
-bool SceneManager::GetString(std::string& output, uint32_t& checksum, uint64_t& timestamp)
+bool SceneManager::GetString(std::string& output, StoreChangeSet& changes, uint32_t& checksum, uint64_t& timestamp)
 {
     SceneObjectMap mapCopy;
     mapCopy.clear();
     bool ret = false;
+    bool snapshot = false;
     output.clear();
 
     scenesLock.Lock();
     // we can't hold this lock for the entire time!
     if (updated) {
-        mapCopy = scenes;
+        snapshot = TakeStoreChanges(changes);
+        if (snapshot) {
+            mapCopy = scenes;
+        }
         updated = false;
         ret = true;
     }
     scenesLock.Unlock();
 
     if (ret) {
-        output = GetString(mapCopy);
+        if (snapshot) {
+            output = GetString(mapCopy);
+        }
         scenesLock.Lock();
         if (blobUpdateCycle) {
-            checksum = checkSum;
             timestamp = timeStamp;
-            blobUpdateCycle = false;
         } else {
             if (initialState) {
                 timeStamp = timestamp = 0UL;
@@ -1174,8 +1269,20 @@ bool SceneManager::GetString(std::string& output, uint32_t& checksum, uint64_t&
             } else {
                 timeStamp = timestamp = GetTimestampInMs();
             }
+        }
+        if (!snapshot) {
+            /*
+             * Only the changes are journalled; the store is checksummed when it is next serialized
+             */
+            checksum = changes.checksum;
+            checkSumValid = false;
+        } else if (blobUpdateCycle && checkSumValid) {
+            checksum = checkSum;
+        } else {
             checkSum = checksum = GetChecksum(output);
+            checkSumValid = true;
         }
+        blobUpdateCycle = false;
         scenesLock.Unlock();
     }
 
@@ -1187,16 +1294,66 @@ void SceneManager::HandleReceivedBlob(const std::string& blob, uint32_t checksum
     QCC_DbgPrintf(("%s", __func__));
     uint64_t currentTimestamp = GetTimestampInMs();
     scenesLock.Lock();
-    if (((timeStamp == 0) || ((currentTimestamp - timeStamp) > timestamp)) && (checkSum != checksum)) {
+    if (AcceptReceivedBlob(checksum, timestamp)) {
         std::istringstream stream(blob.c_str());
         ReplaceMap(stream);
         timeStamp = currentTimestamp;
         checkSum = checksum;
+        checkSumValid = true;
         ScheduleFileWrite(true);
     }
     scenesLock.Unlock();
 }
 
+void SceneManager::HandleReceivedDelta(const StoreChangeSet& changes, uint32_t checksum)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    scenesLock.Lock();
+    bool inSync = ApplyStoreChanges(changes);
+    if (inSync) {
+        inSync = CompleteStoreChanges(checksum);
+    }
+    scenesLock.Unlock();
+
+    if (!inSync) {
+        controllerService.GetLeaderElectionObj().RequestBlob(LSF_SCENE);
+    }
+}
+
+void SceneManager::HandleReconciledEntities(const StoreJournalRecordList& records)
+{
+    QCC_DbgPrintf(("%s", __func__));
+    scenesLock.Lock();
+    ApplyReconciledEntities(records);
+    CompleteStoreChanges(hashTree.GetFoldedRootHash());
+    scenesLock.Unlock();
+}
+
+void SceneManager::BuildHashTree(void)
+{
+    if (hashTree.IsBuilt()) {
+        return;
+    }
+
+    QCC_DbgPrintf(("%s: %u entities", __func__, (uint32_t) scenes.size()));
+    hashTree.Reset();
+    for (SceneObjectMap::const_iterator it = scenes.begin(); it != scenes.end(); ++it) {
+        hashTree.Update(it->first, GetString(it->second->sceneName, it->first, it->second->scene));
+    }
+}
+
+void SceneManager::GetEntityRecords(const LSFStringList& ids, StoreJournalRecordList& records)
+{
+    records.clear();
+    for (LSFStringList::const_iterator id = ids.begin(); id != ids.end(); ++id) {
+        SceneObjectMap::const_iterator it = scenes.find(*id);
+        if (it != scenes.end()) {
+            StoreJournalRecord record = { StoreJournal::RECORD_UPDATE, it->first, GetString(it->second->sceneName, it->first, it->second->scene), 0, 0, 0 };
+            records.push_back(record);
+        }
+    }
+}
+
 void SceneManager::ReadWriteFile()
 {
     QCC_DbgPrintf(("%s", __func__));
@@ -1206,17 +1363,22 @@ void SceneManager::ReadWriteFile()
     }
 
     std::string output;
+    StoreChangeSet changes;
     uint32_t checksum;
     uint64_t timestamp;
     bool status = false;
 
-    status = GetString(output, checksum, timestamp);
+    status = GetString(output, changes, checksum, timestamp);
 
+    bool sendBlob = false;
     if (status) {
-        WriteFileWithChecksumAndTimestamp(output, checksum, timestamp);
+        if (!CommitToStore(output, changes, checksum, timestamp)) {
+            scenesLock.Lock();
+            ScheduleFileWrite(true);
+            scenesLock.Unlock();
+        }
         if (timestamp != 0UL) {
-            uint64_t currentTime = GetTimestampInMs();
-            controllerService.SendBlobUpdate(LSF_SCENE, output, checksum, (currentTime - timestamp));
+            sendBlob = !SendBlobUpdate(LSF_SCENE, output, changes, checksum, timestamp);
         }
     }
 
@@ -1230,11 +1392,22 @@ void SceneManager::ReadWriteFile()
     }
     readMutex.Unlock();
 
-    if ((tempMessageList.size() || sendUpdate) && !status) {
-        std::istringstream stream;
-        status = ValidateFileAndReadInternal(checksum, timestamp, stream);
+    if ((tempMessageList.size() || sendUpdate || sendBlob) && output.empty() && !journal.IsEmpty()) {
+        /*
+         * The snapshot on disk does not include the journal
+         */
+        scenesLock.Lock();
+        SceneObjectMap mapCopy = scenes;
+        timestamp = timeStamp;
+        scenesLock.Unlock();
+        output = GetString(mapCopy);
+        checksum = GetChecksum(output);
+        status = true;
+    } else if ((tempMessageList.size() || sendUpdate || sendBlob) && output.empty()) {
+        StoreFile file;
+        status = ValidateFileAndReadInternal(checksum, timestamp, file);
         if (status) {
-            output = stream.str();
+            output.assign(file.GetPayload(), file.GetPayloadLength());
         } else {
             QCC_LogError(ER_FAIL, ("%s: Scene persistent store corrupted", __func__));
         }
@@ -1248,6 +1421,11 @@ void SceneManager::ReadWriteFile()
         }
     }
 
+    if (sendBlob && status) {
+        uint64_t currentTime = GetTimestampInMs();
+        controllerService.SendBlobUpdate(LSF_SCENE, output, checksum, (currentTime - timestamp));
+    }
+
     if (sendUpdate) {
         sendUpdate = false;
         uint64_t currentTime = GetTimestampInMs();
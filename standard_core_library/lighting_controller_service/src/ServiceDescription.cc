@@ -30,6 +30,11 @@ const std::string ControllerServiceDescription =
     "    <method name='GetControllerServiceVersion'>"
     "      <arg name='version' type='u' direction='out'/>"
     "    </method>"
+    "    <method name='GetReadReplicaStaleness'>"
+    "      <arg name='responseCode' type='u' direction='out'/>"
+    "      <arg name='isLeader' type='b' direction='out'/>"
+    "      <arg name='staleness' type='u' direction='out'/>"
+    "    </method>"
     "    <signal name='ControllerServiceLightingReset'>"
     "    </signal>"
     "  </interface>"
@@ -99,6 +104,15 @@ const std::string ControllerServiceLampDescription =
     "      <arg name='lampID' type='s' direction='out'/>"
     "      <arg name='lampState' type='a{sv}' direction='out'/>"
     "    </method>"
+    "    <method name='GetAllLampStates'>"
+    "      <arg name='responseCode' type='u' direction='out'/>"
+    "      <arg name='lampStates' type='a{sa{sv}}' direction='out'/>"
+    "    </method>"
+    "    <method name='GetLampStates'>"
+    "      <arg name='lampIDs' type='as' direction='in'/>"
+    "      <arg name='responseCode' type='u' direction='out'/>"
+    "      <arg name='lampStates' type='a{sa{sv}}' direction='out'/>"
+    "    </method>"
     "    <method name='GetLampStateField'>"
     "      <arg name='lampID' type='s' direction='in'/>"
     "      <arg name='lampStateFieldName' type='s' direction='in'/>"
@@ -114,6 +128,10 @@ const std::string ControllerServiceLampDescription =
     "      <arg name='responseCode' type='u' direction='out'/>"
     "      <arg name='lampID' type='s' direction='out'/>"
     "    </method>"
+    "    <method name='TransitionLampsToStates'>"
+    "      <arg name='lampTransitions' type='a(sa{sv}u)' direction='in'/>"
+    "      <arg name='responseCode' type='u' direction='out'/>"
+    "    </method>"
     "    <method name='PulseLampWithState'>"
     "      <arg name='lampID' type='s' direction='in'/>"
     "      <arg name='fromLampState' type='a{sv}' direction='in'/>"
@@ -189,6 +207,9 @@ const std::string ControllerServiceLampDescription =
     "      <arg name='lampID' type='s' direction='out'/>"
     "      <arg name='lampState' type='a{sv}' direction='out'/>"
     "    </signal>"
+    "    <signal name='LampsStateChanged'>"
+    "      <arg name='lampStates' type='a{sa{sv}}' direction='out'/>"
+    "    </signal>"
     "    <signal name='LampsFound'>"
     "      <arg name='lampIDs' type='as' direction='out'/>"
     "    </signal>"
@@ -249,6 +270,12 @@ const std::string ControllerServiceLampGroupDescription =
     "      <arg name='lampIDs' type='as' direction='out'/>"
     "      <arg name='lampGroupIDs' type='as' direction='out'/>"
     "    </method>"
+    "    <method name='GetAllLampGroups'>"
+    "      <arg name='language' type='s' direction='in'/>"
+    "      <arg name='responseCode' type='u' direction='out'/>"
+    "      <arg name='language' type='s' direction='out'/>"
+    "      <arg name='lampGroups' type='a(ssasas)' direction='out'/>"
+    "    </method>"
     "    <method name='TransitionLampGroupState'>"
     "      <arg name='lampGroupID' type='s' direction='in'/>"
     "      <arg name='lampState' type='a{sv}' direction='in'/>"
@@ -375,6 +402,12 @@ const std::string ControllerServicePresetDescription =
     "      <arg name='presetID' type='s' direction='out'/>"
     "      <arg name='lampState' type='a{sv}' direction='out'/>"
     "    </method>"
+    "    <method name='GetAllPresets'>"
+    "      <arg name='language' type='s' direction='in'/>"
+    "      <arg name='responseCode' type='u' direction='out'/>"
+    "      <arg name='language' type='s' direction='out'/>"
+    "      <arg name='presets' type='a(ssa{sv})' direction='out'/>"
+    "    </method>"
     "    <signal name='DefaultLampStateChanged'>"
     "    </signal>"
     "    <signal name='PresetsNameChanged'>"
@@ -449,6 +482,12 @@ const std::string ControllerServiceSceneDescription =
     "      <arg name='pulselampsLampGroupsWithState' type='a(asasa{sv}a{sv}uuu)' direction='out'/>"
     "      <arg name='pulselampsLampGroupsWithPreset' type='a(asasssuuu)' direction='out'/>"
     "    </method>"
+    "    <method name='GetAllScenes'>"
+    "      <arg name='language' type='s' direction='in'/>"
+    "      <arg name='responseCode' type='u' direction='out'/>"
+    "      <arg name='language' type='s' direction='out'/>"
+    "      <arg name='scenes' type='a(ssa(asasa{sv}u)a(asassu)a(asasa{sv}a{sv}uuu)a(asasssuuu))' direction='out'/>"
+    "    </method>"
     "    <method name='ApplyScene'>"
     "      <arg name='sceneID' type='s' direction='in'/>"
     "      <arg name='responseCode' type='u' direction='out'/>"
@@ -520,6 +559,12 @@ const std::string ControllerServiceMasterSceneDescription =
     "      <arg name='masterSceneID' type='s' direction='out'/>"
     "      <arg name='scenes' type='as' direction='out'/>"
     "    </method>"
+    "    <method name='GetAllMasterScenes'>"
+    "      <arg name='language' type='s' direction='in'/>"
+    "      <arg name='responseCode' type='u' direction='out'/>"
+    "      <arg name='language' type='s' direction='out'/>"
+    "      <arg name='masterScenes' type='a(ssas)' direction='out'/>"
+    "    </method>"
     "    <method name='ApplyMasterScene'>"
     "      <arg name='masterSceneID' type='s' direction='in'/>"
     "      <arg name='responseCode' type='u' direction='out'/>"
@@ -543,6 +588,17 @@ const std::string ControllerServiceMasterSceneDescription =
     "  </interface>"
     "</node>";
 
+const std::string ControllerServiceDiagnosticsDescription =
+    "<node>"
+    "  <interface name='org.allseen.LSF.ControllerService.Diagnostics'>"
+    "  <property name='Version' type='u' access='read'/>"
+    "    <method name='GetDiagnostics'>"
+    "      <arg name='responseCode' type='u' direction='out'/>"
+    "      <arg name='diagnostics' type='a{sv}' direction='out'/>"
+    "    </method>"
+    "  </interface>"
+    "</node>";
+
 const std::string LeaderElectionAndStateSyncDescription =
     "<node>"
     "  <interface name='org.allseen.LeaderElectionAndStateSync'>"
@@ -557,6 +613,26 @@ const std::string LeaderElectionAndStateSyncDescription =
     "      <arg name='checksum' type='u' direction='out'/>"
     "      <arg name='timestamp' type='t' direction='out'/>"
     "    </method>"
+    "    <method name='GetHashTreeNodes'>"
+    "      <arg name='blobType' type='u' direction='in'/>"
+    "      <arg name='level' type='u' direction='in'/>"
+    "      <arg name='nodes' type='au' direction='in'/>"
+    "      <arg name='blobType' type='u' direction='out'/>"
+    "      <arg name='level' type='u' direction='out'/>"
+    "      <arg name='childHashes' type='at' direction='out'/>"
+    "    </method>"
+    "    <method name='GetEntityHashes'>"
+    "      <arg name='blobType' type='u' direction='in'/>"
+    "      <arg name='buckets' type='au' direction='in'/>"
+    "      <arg name='blobType' type='u' direction='out'/>"
+    "      <arg name='entityHashes' type='a(st)' direction='out'/>"
+    "    </method>"
+    "    <method name='GetEntities'>"
+    "      <arg name='blobType' type='u' direction='in'/>"
+    "      <arg name='entityIDs' type='as' direction='in'/>"
+    "      <arg name='blobType' type='u' direction='out'/>"
+    "      <arg name='entities' type='a(ss)' direction='out'/>"
+    "    </method>"
     "    <method name='Overthrow'>"
     "      <arg name='success' type='b' direction='out'/>"
     "    </method>"
@@ -566,6 +642,29 @@ const std::string LeaderElectionAndStateSyncDescription =
     "      <arg name='checksum' type='u' direction='out'/>"
     "      <arg name='timestamp' type='t' direction='out'/>"
     "    </signal>"
+    "    <signal name='BlobDelta'>"
+    "      <arg name='blobType' type='u' direction='out'/>"
+    "      <arg name='fromSequence' type='u' direction='out'/>"
+    "      <arg name='toSequence' type='u' direction='out'/>"
+    "      <arg name='baseChecksum' type='u' direction='out'/>"
+    "      <arg name='changes' type='a(yssu)' direction='out'/>"
+    "      <arg name='checksum' type='u' direction='out'/>"
+    "      <arg name='timestamp' type='t' direction='out'/>"
+    "    </signal>"
+    "    <signal name='BlobChunk'>"
+    "      <arg name='blobType' type='u' direction='out'/>"
+    "      <arg name='transferId' type='u' direction='out'/>"
+    "      <arg name='chunkIndex' type='u' direction='out'/>"
+    "      <arg name='numChunks' type='u' direction='out'/>"
+    "      <arg name='blobLength' type='u' direction='out'/>"
+    "      <arg name='chunk' type='ay' direction='out'/>"
+    "      <arg name='checksum' type='u' direction='out'/>"
+    "      <arg name='timestamp' type='t' direction='out'/>"
+    "    </signal>"
+    "    <signal name='Heartbeat'>"
+    "      <arg name='sequence' type='u' direction='out'/>"
+    "      <arg name='stores' type='a(uuu)' direction='out'/>"
+    "    </signal>"
     "  </interface>"
     "</node>";
 }
@@ -0,0 +1,380 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <StoreFile.h>
+
+#include <alljoyn/Status.h>
+#include <qcc/Debug.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+
+#define QCC_MODULE "STORE_FILE"
+
+namespace lsf {
+
+const uint32_t StoreFileFormatVersion = 1;
+
+static const char storeFileMagic[4] = { 'L', 'S', 'F', 'B' };
+
+/*
+ * Offsets of the fields in the binary header
+ */
+static const size_t MAGIC_OFFSET = 0;
+static const size_t VERSION_OFFSET = 4;
+static const size_t HEADER_LENGTH_OFFSET = 8;
+static const size_t NUM_RECORDS_OFFSET = 12;
+static const size_t PAYLOAD_LENGTH_OFFSET = 16;
+static const size_t TIMESTAMP_OFFSET = 20;
+static const size_t CHECKSUM_OFFSET = 28;
+static const size_t HEADER_CHECKSUM_OFFSET = 32;
+static const size_t HEADER_LENGTH = 36;
+
+uint32_t GetAdler32Checksum(const uint8_t* data, size_t len) {
+    QCC_DbgTrace(("%s: len = %d", __func__, len));
+    uint32_t adler = 1;
+    uint32_t adlerPrime = 65521;
+    uint32_t a = adler & 0xFFFF;
+    uint32_t b = adler >> 16;
+    /*
+     * 5552 is the largest number of bytes that can be summed before b overflows
+     * 32 bits, so the modulo is only taken once per block
+     */
+    while (data && len) {
+        size_t block = (len < 5552) ? len : 5552;
+        len -= block;
+        while (block--) {
+            a += *data++;
+            b += a;
+        }
+        a %= adlerPrime;
+        b %= adlerPrime;
+    }
+    adler = (b << 16) | a;
+    QCC_DbgTrace(("%s: adler=0x%x", __func__, adler));
+    return adler;
+}
+
+bool WriteToFile(int fd, const char* data, size_t len)
+{
+    while (len) {
+        ssize_t written = write(fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        len -= written;
+    }
+    return true;
+}
+
+bool SyncParentDirectory(const std::string& path)
+{
+    size_t slash = path.rfind('/');
+    std::string directory = (slash == std::string::npos) ? "." : ((slash == 0) ? "/" : path.substr(0, slash));
+
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd < 0) {
+        QCC_LogError(ER_FAIL, ("%s: Failed to open %s", __func__, directory.c_str()));
+        return false;
+    }
+
+    bool ret = (fsync(fd) == 0);
+    close(fd);
+    if (!ret) {
+        QCC_LogError(ER_FAIL, ("%s: Failed to sync %s", __func__, directory.c_str()));
+    }
+    return ret;
+}
+
+template <typename T>
+static T ReadField(const char* buffer, size_t offset)
+{
+    T value;
+    memcpy(&value, buffer + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+static void WriteField(char* buffer, size_t offset, T value)
+{
+    memcpy(buffer + offset, &value, sizeof(T));
+}
+
+StoreFile::StoreFile() :
+    mapping(NULL),
+    mappingLength(0),
+    payload(NULL),
+    payloadLength(0),
+    timestamp(0),
+    checksum(0),
+    legacyFormat(false)
+{
+}
+
+StoreFile::~StoreFile()
+{
+    Close();
+}
+
+void StoreFile::Close(void)
+{
+    if (mapping) {
+        munmap(const_cast<char*>(mapping), mappingLength);
+    }
+    mapping = NULL;
+    mappingLength = 0;
+    payload = NULL;
+    payloadLength = 0;
+    timestamp = 0;
+    checksum = 0;
+    legacyFormat = false;
+    recordOffsets.clear();
+}
+
+bool StoreFile::Open(const std::string& path)
+{
+    QCC_DbgPrintf(("%s: path=%s", __func__, path.c_str()));
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        QCC_LogError(ER_FAIL, ("File not found: %s\n", path.c_str()));
+        return false;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size <= 0)) {
+        QCC_LogError(ER_FAIL, ("%s: Empty or unreadable file %s", __func__, path.c_str()));
+        close(fd);
+        return false;
+    }
+
+    void* addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        QCC_LogError(ER_FAIL, ("%s: mmap failed for %s", __func__, path.c_str()));
+        return false;
+    }
+
+    mapping = static_cast<const char*>(addr);
+    mappingLength = st.st_size;
+
+    bool ret;
+    if ((mappingLength >= HEADER_LENGTH) && (0 == memcmp(mapping + MAGIC_OFFSET, storeFileMagic, sizeof(storeFileMagic)))) {
+        ret = ParseBinary();
+    } else {
+        ret = ParseLegacy();
+    }
+
+    if (!ret) {
+        QCC_LogError(ER_FAIL, ("%s: Malformed store file %s", __func__, path.c_str()));
+        Close();
+    }
+
+    return ret;
+}
+
+bool StoreFile::ParseBinary(void)
+{
+    uint32_t version = ReadField<uint32_t>(mapping, VERSION_OFFSET);
+    uint32_t headerLength = ReadField<uint32_t>(mapping, HEADER_LENGTH_OFFSET);
+    uint32_t numRecords = ReadField<uint32_t>(mapping, NUM_RECORDS_OFFSET);
+    uint32_t length = ReadField<uint32_t>(mapping, PAYLOAD_LENGTH_OFFSET);
+    uint32_t headerChecksum = ReadField<uint32_t>(mapping, HEADER_CHECKSUM_OFFSET);
+
+    if (version > StoreFileFormatVersion) {
+        QCC_LogError(ER_FAIL, ("%s: Unsupported store file version %u", __func__, version));
+        return false;
+    }
+
+    if ((headerLength < HEADER_LENGTH) || (headerLength > mappingLength)) {
+        return false;
+    }
+
+    if (headerChecksum != GetAdler32Checksum((const uint8_t*) mapping, HEADER_CHECKSUM_OFFSET)) {
+        QCC_LogError(ER_FAIL, ("%s: Header checksum mismatch", __func__));
+        return false;
+    }
+
+    uint64_t expectedLength = (uint64_t) headerLength + ((uint64_t) numRecords * sizeof(uint32_t)) + length;
+    if (expectedLength != mappingLength) {
+        QCC_LogError(ER_FAIL, ("%s: File length %u does not match the header", __func__, mappingLength));
+        return false;
+    }
+
+    timestamp = ReadField<uint64_t>(mapping, TIMESTAMP_OFFSET);
+    checksum = ReadField<uint32_t>(mapping, CHECKSUM_OFFSET);
+    payload = mapping + headerLength + (numRecords * sizeof(uint32_t));
+    payloadLength = length;
+
+    recordOffsets.reserve(numRecords + 1);
+    size_t offset = 0;
+    for (uint32_t i = 0; i < numRecords; i++) {
+        recordOffsets.push_back(offset);
+        offset += ReadField<uint32_t>(mapping, headerLength + (i * sizeof(uint32_t)));
+        if (offset > payloadLength) {
+            return false;
+        }
+    }
+
+    if (offset != payloadLength) {
+        return false;
+    }
+
+    QCC_DbgPrintf(("%s: version=%u records=%u payloadLength=%u timestamp=%llu checksum=%u", __func__,
+                   version, numRecords, payloadLength, timestamp, checksum));
+    legacyFormat = false;
+    return true;
+}
+
+static bool ParseDecimal(const char*& pos, const char* end, uint64_t& value)
+{
+    while ((pos < end) && isspace(*pos)) {
+        pos++;
+    }
+
+    if ((pos == end) || !isdigit(*pos)) {
+        return false;
+    }
+
+    value = 0;
+    while ((pos < end) && isdigit(*pos)) {
+        value = (value * 10) + (*pos - '0');
+        pos++;
+    }
+
+    return true;
+}
+
+bool StoreFile::ParseLegacy(void)
+{
+    const char* pos = mapping;
+    const char* end = mapping + mappingLength;
+    uint64_t value;
+
+    if (!ParseDecimal(pos, end, timestamp)) {
+        return false;
+    }
+
+    if (!ParseDecimal(pos, end, value)) {
+        return false;
+    }
+    checksum = static_cast<uint32_t>(value);
+
+    while ((pos < end) && isspace(*pos)) {
+        pos++;
+    }
+
+    payload = pos;
+    payloadLength = end - pos;
+    legacyFormat = true;
+
+    QCC_DbgPrintf(("%s: payloadLength=%u timestamp=%llu checksum=%u", __func__, payloadLength, timestamp, checksum));
+    return true;
+}
+
+bool StoreFile::IsValid(void) const
+{
+    if (!mapping) {
+        return false;
+    }
+
+    return (GetAdler32Checksum((const uint8_t*) payload, payloadLength) == checksum);
+}
+
+bool StoreFile::GetRecord(uint32_t index, const char*& record, size_t& length) const
+{
+    if (index >= recordOffsets.size()) {
+        return false;
+    }
+
+    size_t next = ((index + 1) < recordOffsets.size()) ? recordOffsets[index + 1] : payloadLength;
+    record = payload + recordOffsets[index];
+    length = next - recordOffsets[index];
+    return true;
+}
+
+bool StoreFile::Write(const std::string& path, const std::string& data, uint32_t checksum, uint64_t timestamp)
+{
+    QCC_DbgPrintf(("%s: path=%s", __func__, path.c_str()));
+
+    /*
+     * One record per line
+     */
+    std::vector<uint32_t> recordLengths;
+    size_t start = 0;
+    while (start < data.length()) {
+        size_t newline = data.find('\n', start);
+        size_t next = (newline == std::string::npos) ? data.length() : (newline + 1);
+        recordLengths.push_back(static_cast<uint32_t>(next - start));
+        start = next;
+    }
+
+    char header[HEADER_LENGTH];
+    memcpy(header + MAGIC_OFFSET, storeFileMagic, sizeof(storeFileMagic));
+    WriteField<uint32_t>(header, VERSION_OFFSET, StoreFileFormatVersion);
+    WriteField<uint32_t>(header, HEADER_LENGTH_OFFSET, HEADER_LENGTH);
+    WriteField<uint32_t>(header, NUM_RECORDS_OFFSET, static_cast<uint32_t>(recordLengths.size()));
+    WriteField<uint32_t>(header, PAYLOAD_LENGTH_OFFSET, static_cast<uint32_t>(data.length()));
+    WriteField<uint64_t>(header, TIMESTAMP_OFFSET, timestamp);
+    WriteField<uint32_t>(header, CHECKSUM_OFFSET, checksum);
+    WriteField<uint32_t>(header, HEADER_CHECKSUM_OFFSET, GetAdler32Checksum((const uint8_t*) header, HEADER_CHECKSUM_OFFSET));
+
+    std::string tempPath = path + ".tmp";
+    int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        QCC_LogError(ER_FAIL, ("File not found: %s\n", tempPath.c_str()));
+        return false;
+    }
+
+    bool ret = WriteToFile(fd, header, HEADER_LENGTH);
+    if (ret && !recordLengths.empty()) {
+        ret = WriteToFile(fd, reinterpret_cast<const char*>(&recordLengths[0]), recordLengths.size() * sizeof(uint32_t));
+    }
+    ret = ret && WriteToFile(fd, data.data(), data.length());
+    ret = ret && (fsync(fd) == 0);
+    ret = (close(fd) == 0) && ret;
+
+    if (!ret) {
+        QCC_LogError(ER_FAIL, ("%s: Failed to write %s", __func__, tempPath.c_str()));
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    if (rename(tempPath.c_str(), path.c_str()) != 0) {
+        QCC_LogError(ER_FAIL, ("%s: Failed to rename %s to %s", __func__, tempPath.c_str(), path.c_str()));
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    /*
+     * The rename is only durable once the directory entry is
+     */
+    return SyncParentDirectory(path);
+}
+
+}
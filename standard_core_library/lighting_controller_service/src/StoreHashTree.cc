@@ -0,0 +1,183 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <StoreHashTree.h>
+
+#include <algorithm>
+
+#include <qcc/Debug.h>
+
+#define QCC_MODULE "STORE_HASH_TREE"
+
+namespace lsf {
+
+const uint32_t StoreHashTree::FANOUT;
+const uint32_t StoreHashTree::DEPTH;
+const uint32_t StoreHashTree::NUM_BUCKETS;
+
+static const uint32_t BUCKET_BITS = 12;
+
+static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+static const uint64_t FNV_PRIME = 1099511628211ULL;
+
+static uint64_t HashBytes(uint64_t hash, const char* data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/*
+ * Spread the bits of an FNV-1a hash so that the sums of the node hashes do
+ * not cancel out on similar entities
+ */
+static uint64_t Mix(uint64_t hash)
+{
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+StoreHashTree::StoreHashTree() : built(false)
+{
+    uint32_t width = 1;
+    for (uint32_t level = 0; level <= DEPTH; level++) {
+        levels[level].resize(width, 0);
+        width *= FANOUT;
+    }
+}
+
+void StoreHashTree::Invalidate(void)
+{
+    Reset();
+    built = false;
+}
+
+void StoreHashTree::Reset(void)
+{
+    for (uint32_t level = 0; level <= DEPTH; level++) {
+        std::fill(levels[level].begin(), levels[level].end(), 0);
+    }
+    entities.clear();
+    built = true;
+}
+
+void StoreHashTree::Add(uint32_t bucket, uint64_t hash, bool remove)
+{
+    uint32_t node = bucket;
+    for (int32_t level = DEPTH; level >= 0; level--) {
+        if (remove) {
+            levels[level][node] -= hash;
+        } else {
+            levels[level][node] += hash;
+        }
+        node /= FANOUT;
+    }
+}
+
+void StoreHashTree::Update(const std::string& id, const std::string& entity)
+{
+    if (!built) {
+        return;
+    }
+
+    uint32_t bucket = GetBucket(id);
+    uint64_t hash = GetEntityHash(id, entity);
+    std::map<std::string, uint64_t>::iterator it = entities.find(id);
+    if (it != entities.end()) {
+        Add(bucket, it->second, true);
+        it->second = hash;
+    } else {
+        entities.insert(std::make_pair(id, hash));
+    }
+    Add(bucket, hash, false);
+}
+
+void StoreHashTree::Remove(const std::string& id)
+{
+    if (!built) {
+        return;
+    }
+
+    std::map<std::string, uint64_t>::iterator it = entities.find(id);
+    if (it != entities.end()) {
+        Add(GetBucket(id), it->second, true);
+        entities.erase(it);
+    }
+}
+
+uint32_t StoreHashTree::GetFoldedRootHash(void) const
+{
+    uint64_t root = GetRootHash();
+    return static_cast<uint32_t>(root ^ (root >> 32));
+}
+
+void StoreHashTree::GetChildHashes(uint32_t level, const std::vector<uint32_t>& nodes, std::vector<uint64_t>& hashes) const
+{
+    hashes.clear();
+    hashes.reserve(nodes.size() * FANOUT);
+    for (std::vector<uint32_t>::const_iterator it = nodes.begin(); it != nodes.end(); it++) {
+        for (uint32_t child = 0; child < FANOUT; child++) {
+            uint64_t hash = 0;
+            if ((level < DEPTH) && (*it < levels[level].size())) {
+                hash = levels[level + 1][(*it * FANOUT) + child];
+            }
+            hashes.push_back(hash);
+        }
+    }
+}
+
+void StoreHashTree::GetEntityHashes(const std::vector<uint32_t>& buckets, StoreEntityHashList& hashes) const
+{
+    hashes.clear();
+    if (buckets.empty()) {
+        return;
+    }
+
+    std::vector<bool> wanted(NUM_BUCKETS, false);
+    for (std::vector<uint32_t>::const_iterator it = buckets.begin(); it != buckets.end(); it++) {
+        if (*it < NUM_BUCKETS) {
+            wanted[*it] = true;
+        }
+    }
+
+    for (std::map<std::string, uint64_t>::const_iterator it = entities.begin(); it != entities.end(); it++) {
+        if (wanted[GetBucket(it->first)]) {
+            hashes.push_back(*it);
+        }
+    }
+}
+
+uint32_t StoreHashTree::GetBucket(const std::string& id)
+{
+    uint64_t hash = Mix(HashBytes(FNV_OFFSET_BASIS, id.data(), id.length()));
+    return static_cast<uint32_t>(hash >> (64 - BUCKET_BITS));
+}
+
+uint64_t StoreHashTree::GetEntityHash(const std::string& id, const std::string& entity)
+{
+    uint64_t hash = HashBytes(FNV_OFFSET_BASIS, id.data(), id.length());
+    hash = HashBytes(hash, "", 1);
+    hash = HashBytes(hash, entity.data(), entity.length());
+    return Mix(hash);
+}
+
+}
@@ -0,0 +1,328 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <StoreJournal.h>
+#include <StoreFile.h>
+
+#include <alljoyn/Status.h>
+#include <qcc/Debug.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#define QCC_MODULE "STORE_JOURNAL"
+
+namespace lsf {
+
+const char StoreJournal::RECORD_UPDATE;
+const char StoreJournal::RECORD_DELETE;
+const char StoreJournal::RECORD_COMMIT;
+
+static const uint32_t StoreJournalFormatVersion = 1;
+
+static const char storeJournalMagic[4] = { 'L', 'S', 'F', 'J' };
+
+/*
+ * Offsets of the fields in the journal header
+ */
+static const size_t MAGIC_OFFSET = 0;
+static const size_t VERSION_OFFSET = 4;
+static const size_t BASE_CHECKSUM_OFFSET = 8;
+static const size_t BASE_TIMESTAMP_OFFSET = 12;
+static const size_t HEADER_CHECKSUM_OFFSET = 20;
+static const size_t HEADER_LENGTH = 24;
+
+/*
+ * Each record is prefixed by the length and the checksum of its body
+ */
+static const size_t RECORD_PREFIX_LENGTH = 8;
+
+/*
+ * Smallest body: type and id length
+ */
+static const size_t RECORD_MIN_BODY_LENGTH = 5;
+
+/*
+ * Data of a commit record: checksum and timestamp
+ */
+static const size_t COMMIT_DATA_LENGTH = 12;
+
+template <typename T>
+static T ReadField(const char* buffer, size_t offset)
+{
+    T value;
+    memcpy(&value, buffer + offset, sizeof(T));
+    return value;
+}
+
+template <typename T>
+static void AppendField(std::string& output, T value)
+{
+    output.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+StoreJournal::StoreJournal(const std::string& path) :
+    path(path),
+    open(false),
+    length(0),
+    numRecords(0)
+{
+}
+
+bool StoreJournal::Replay(uint32_t baseChecksum, uint64_t baseTimestamp, StoreJournalRecordList& records)
+{
+    QCC_DbgPrintf(("%s: path=%s", __func__, path.c_str()));
+    records.clear();
+    open = false;
+    length = 0;
+    numRecords = 0;
+
+    if (path.empty()) {
+        return false;
+    }
+
+    std::string contents;
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        QCC_DbgPrintf(("%s: No journal found", __func__));
+        return false;
+    }
+
+    char buffer[4096];
+    ssize_t numRead;
+    while ((numRead = read(fd, buffer, sizeof(buffer))) != 0) {
+        if (numRead < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            QCC_LogError(ER_FAIL, ("%s: Failed to read %s", __func__, path.c_str()));
+            close(fd);
+            return false;
+        }
+        contents.append(buffer, numRead);
+    }
+    close(fd);
+
+    const char* data = contents.data();
+    if ((contents.length() < HEADER_LENGTH) ||
+        (0 != memcmp(data + MAGIC_OFFSET, storeJournalMagic, sizeof(storeJournalMagic))) ||
+        (ReadField<uint32_t>(data, VERSION_OFFSET) != StoreJournalFormatVersion) ||
+        (ReadField<uint32_t>(data, HEADER_CHECKSUM_OFFSET) != GetAdler32Checksum((const uint8_t*) data, HEADER_CHECKSUM_OFFSET))) {
+        QCC_LogError(ER_FAIL, ("%s: Malformed journal header in %s", __func__, path.c_str()));
+        return false;
+    }
+
+    if ((ReadField<uint32_t>(data, BASE_CHECKSUM_OFFSET) != baseChecksum) ||
+        (ReadField<uint64_t>(data, BASE_TIMESTAMP_OFFSET) != baseTimestamp)) {
+        QCC_DbgPrintf(("%s: Journal does not apply to the current snapshot", __func__));
+        return false;
+    }
+
+    StoreJournalRecordList batch;
+    uint32_t batchRecords = 0;
+    size_t committedLength = HEADER_LENGTH;
+    size_t offset = HEADER_LENGTH;
+
+    while ((offset + RECORD_PREFIX_LENGTH) <= contents.length()) {
+        uint32_t bodyLength = ReadField<uint32_t>(data, offset);
+        uint32_t bodyChecksum = ReadField<uint32_t>(data, offset + sizeof(uint32_t));
+        const char* body = data + offset + RECORD_PREFIX_LENGTH;
+
+        if ((bodyLength < RECORD_MIN_BODY_LENGTH) || (bodyLength > (contents.length() - offset - RECORD_PREFIX_LENGTH))) {
+            break;
+        }
+
+        if (bodyChecksum != GetAdler32Checksum((const uint8_t*) body, bodyLength)) {
+            break;
+        }
+
+        uint32_t idLength = ReadField<uint32_t>(body, 1);
+        if (idLength > (bodyLength - RECORD_MIN_BODY_LENGTH)) {
+            break;
+        }
+
+        StoreJournalRecord record;
+        record.type = body[0];
+        record.id.assign(body + RECORD_MIN_BODY_LENGTH, idLength);
+        record.data.assign(body + RECORD_MIN_BODY_LENGTH + idLength, bodyLength - RECORD_MIN_BODY_LENGTH - idLength);
+        record.checksum = 0;
+        record.timestamp = 0;
+        record.version = 0;
+
+        offset += RECORD_PREFIX_LENGTH + bodyLength;
+
+        if (record.type == RECORD_COMMIT) {
+            if (record.data.length() != COMMIT_DATA_LENGTH) {
+                break;
+            }
+            record.checksum = ReadField<uint32_t>(record.data.data(), 0);
+            record.timestamp = ReadField<uint64_t>(record.data.data(), sizeof(uint32_t));
+            record.data.clear();
+            batch.push_back(record);
+            records.splice(records.end(), batch);
+            numRecords += batchRecords + 1;
+            batchRecords = 0;
+            committedLength = offset;
+        } else if ((record.type == RECORD_UPDATE) || (record.type == RECORD_DELETE)) {
+            batch.push_back(record);
+            batchRecords++;
+        } else {
+            break;
+        }
+    }
+
+    length = contents.length();
+    open = true;
+
+    if (committedLength != contents.length()) {
+        QCC_LogError(ER_FAIL, ("%s: Discarding %u bytes of uncommitted or corrupted journal records", __func__,
+                               (uint32_t) (contents.length() - committedLength)));
+        if (!Truncate(committedLength)) {
+            open = false;
+            records.clear();
+            return false;
+        }
+    }
+
+    QCC_DbgPrintf(("%s: Replaying %u records", __func__, numRecords));
+    return true;
+}
+
+bool StoreJournal::Reset(uint32_t baseChecksum, uint64_t baseTimestamp)
+{
+    QCC_DbgPrintf(("%s: path=%s checksum=%u timestamp=%llu", __func__, path.c_str(), baseChecksum, baseTimestamp));
+    open = false;
+    length = 0;
+    numRecords = 0;
+
+    if (path.empty()) {
+        return false;
+    }
+
+    std::string header;
+    header.append(storeJournalMagic, sizeof(storeJournalMagic));
+    AppendField<uint32_t>(header, StoreJournalFormatVersion);
+    AppendField<uint32_t>(header, baseChecksum);
+    AppendField<uint64_t>(header, baseTimestamp);
+    AppendField<uint32_t>(header, GetAdler32Checksum((const uint8_t*) header.data(), header.length()));
+
+    std::string tempPath = path + ".tmp";
+    int fd = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        QCC_LogError(ER_FAIL, ("File not found: %s\n", tempPath.c_str()));
+        return false;
+    }
+
+    bool ret = WriteToFile(fd, header.data(), header.length()) && (fsync(fd) == 0);
+    ret = (close(fd) == 0) && ret;
+
+    if (ret && (rename(tempPath.c_str(), path.c_str()) == 0)) {
+        open = true;
+        length = header.length();
+        /*
+         * The journal is empty on disk either way, but the caller only moves
+         * on to the new snapshot once the rename is durable
+         */
+        ret = SyncParentDirectory(path);
+    } else {
+        QCC_LogError(ER_FAIL, ("%s: Failed to write %s", __func__, path.c_str()));
+        unlink(tempPath.c_str());
+        ret = false;
+    }
+
+    return ret;
+}
+
+bool StoreJournal::Append(const std::string& records)
+{
+    QCC_DbgTrace(("%s: len=%u", __func__, (uint32_t) records.length()));
+
+    if (!open) {
+        return false;
+    }
+
+    int fd = ::open(path.c_str(), O_WRONLY | O_APPEND);
+    if (fd < 0) {
+        QCC_LogError(ER_FAIL, ("File not found: %s\n", path.c_str()));
+        open = false;
+        return false;
+    }
+
+    bool ret = WriteToFile(fd, records.data(), records.length()) && (fsync(fd) == 0);
+    ret = (close(fd) == 0) && ret;
+
+    if (!ret) {
+        /*
+         * Drop the partial batch so the journal can still be appended to
+         */
+        QCC_LogError(ER_FAIL, ("%s: Failed to append to %s", __func__, path.c_str()));
+        if (!Truncate(length)) {
+            open = false;
+        }
+        return false;
+    }
+
+    /*
+     * Count the records to know whether the journal is empty
+     */
+    size_t offset = 0;
+    while ((offset + RECORD_PREFIX_LENGTH) <= records.length()) {
+        offset += RECORD_PREFIX_LENGTH + ReadField<uint32_t>(records.data(), offset);
+        numRecords++;
+    }
+
+    length += records.length();
+    return true;
+}
+
+bool StoreJournal::Truncate(size_t newLength)
+{
+    if (truncate(path.c_str(), newLength) != 0) {
+        QCC_LogError(ER_FAIL, ("%s: Failed to truncate %s", __func__, path.c_str()));
+        return false;
+    }
+    length = newLength;
+    return true;
+}
+
+void StoreJournal::EncodeRecord(std::string& output, char type, const std::string& id, const std::string& data)
+{
+    std::string body;
+    body.reserve(RECORD_MIN_BODY_LENGTH + id.length() + data.length());
+    body.push_back(type);
+    AppendField<uint32_t>(body, static_cast<uint32_t>(id.length()));
+    body.append(id);
+    body.append(data);
+
+    AppendField<uint32_t>(output, static_cast<uint32_t>(body.length()));
+    AppendField<uint32_t>(output, GetAdler32Checksum((const uint8_t*) body.data(), body.length()));
+    output.append(body);
+}
+
+void StoreJournal::EncodeCommit(std::string& output, uint32_t checksum, uint64_t timestamp)
+{
+    std::string data;
+    AppendField<uint32_t>(data, checksum);
+    AppendField<uint64_t>(data, timestamp);
+    EncodeRecord(output, RECORD_COMMIT, std::string(), data);
+}
+
+}
@@ -0,0 +1,65 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+#include <qcc/Debug.h>
+#include <StoreLoaderThread.h>
+#include <Manager.h>
+
+using namespace lsf;
+
+#define QCC_MODULE "STORE_LOADER_THREAD"
+
+StoreLoaderThread::StoreLoaderThread(Manager& manager)
+    : Thread("StoreLoader"),
+    manager(manager),
+    started(false),
+    loadTime(0)
+{
+    QCC_DbgTrace(("%s", __func__));
+}
+
+StoreLoaderThread::~StoreLoaderThread()
+{
+    QCC_DbgTrace(("%s", __func__));
+}
+
+void StoreLoaderThread::StartLoading(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    started = (Start() == ER_OK);
+    if (!started) {
+        QCC_LogError(ER_FAIL, ("%s: Failed to start the loader thread of %s, loading it now", __func__, manager.filePath.c_str()));
+        Run();
+    }
+}
+
+uint32_t StoreLoaderThread::WaitUntilLoaded(void)
+{
+    QCC_DbgTrace(("%s", __func__));
+    if (started) {
+        Join();
+        started = false;
+    }
+    return loadTime;
+}
+
+void StoreLoaderThread::Run()
+{
+    uint64_t start = GetTimestampInMs();
+    manager.ReadSavedData();
+    loadTime = static_cast<uint32_t>(GetTimestampInMs() - start);
+    QCC_DbgPrintf(("%s: Loaded %s in %u ms", __func__, manager.filePath.c_str(), loadTime));
+}
@@ -0,0 +1,140 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Blob transfer benchmark. \n
+ * Builds Scene stores of growing size and reports, for each one:
+ *   - the time to compress and split the blob on the sender
+ *   - the time to reassemble, decompress and verify it on the receiver
+ *   - the compressed size and the number of chunks
+ *   - the time to put the blob on a link of the given rate, uncompressed in one
+ *     string argument as before, and compressed in chunks
+ * A blob longer than the maximum AllJoyn message cannot be sent uncompressed.
+ *
+ * Usage: blob_transfer_benchmark [linkRateKBps] [iterations]
+ */
+
+#include <BlobTransfer.h>
+#include <StoreFile.h>
+#include <LSFTypes.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+
+using namespace lsf;
+
+/*
+ * ALLJOYN_MAX_PACKET_LEN
+ */
+static const size_t MAX_MESSAGE_LEN = 1024 * 128;
+
+static std::string GetSceneString(uint32_t index)
+{
+    char id[32];
+    snprintf(id, sizeof(id), "SCENE%08x", index);
+    std::ostringstream stream;
+    stream << "Scene " << id << " \"Benchmark Scene " << index << "\"\n";
+    stream << "\tTransitionLampsLampGroupsToState\n";
+    for (uint32_t i = 0; i < 4; i++) {
+        stream << "\t\tLamp " << "LAMP" << ((index * 7) + i) % 256 << '\n';
+    }
+    stream << "\t\tLampGroup LAMP_GROUP" << (index % 32) << '\n';
+    stream << "\t\tLampState 0 1 " << ((index * 2654435761U) % 4294967295U) << ' ' << (index * 1000) << ' '
+           << (2700 + (index % 4000)) << ' ' << ((index * 40503U) % 4294967295U) << '\n';
+    stream << "\t\tPeriod " << (index % 10) * 100 << '\n';
+    stream << "\tEndTransitionLampsLampGroupsToState\n";
+    stream << "\tPulseLampsLampGroupsWithPreset\n";
+    stream << "\t\tLampGroup LAMP_GROUP" << ((index + 1) % 32) << '\n';
+    stream << "\t\tFromState PRESET" << (index % 64) << "\n\t\tToState PRESET" << ((index + 5) % 64)
+           << "\n\t\tPeriod 1000\n\t\tDuration 500\n\t\tPulses " << (index % 5) + 1 << '\n';
+    stream << "\tEndPulseLampsLampGroupsWithPreset\n";
+    stream << "EndScene\n";
+    return stream.str();
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t linkRate = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000;
+    uint32_t iterations = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10;
+    const size_t sizes[] = { 1024 * 127, 1024 * 512, 1024 * 1024, 1024 * 1024 * 4 };
+
+    printf("link=%u KB/s iterations=%u\n", linkRate, iterations);
+    printf("%-9s %-9s %-6s %-6s %-12s %-12s %-14s %-14s\n", "blob", "packed", "ratio", "chunks", "encode us", "decode us", "plain wire ms", "chunked wire ms");
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        std::string blob;
+        for (uint32_t i = 0; blob.length() < sizes[s]; i++) {
+            blob += GetSceneString(i);
+        }
+        uint32_t checksum = GetAdler32Checksum((const uint8_t*) blob.data(), blob.length());
+
+        uint64_t encodeUs = 0;
+        uint64_t decodeUs = 0;
+        size_t compressedLength = 0;
+        uint32_t numChunks = 0;
+
+        for (uint32_t n = 0; n < iterations; n++) {
+            uint64_t start = lsf::GetTimestampInUs();
+            std::string compressed;
+            BlobTransfer::Compress(blob, compressed);
+            numChunks = BlobTransfer::GetNumChunks(compressed.length());
+            compressedLength = compressed.length();
+            encodeUs += lsf::GetTimestampInUs() - start;
+
+            start = lsf::GetTimestampInUs();
+            BlobReassembler reassembler;
+            std::string received;
+            bool complete = false;
+            for (uint32_t i = 0; i < numChunks; i++) {
+                size_t offset = i * BlobTransfer::CHUNK_LEN;
+                BlobChunk chunk;
+                chunk.type = 0;
+                chunk.transferId = n;
+                chunk.index = i;
+                chunk.numChunks = numChunks;
+                chunk.blobLength = blob.length();
+                chunk.checksum = checksum;
+                chunk.timestamp = 0;
+                chunk.data = (const uint8_t*) compressed.data() + offset;
+                chunk.dataLength = std::min(BlobTransfer::CHUNK_LEN, compressed.length() - offset);
+                complete = reassembler.AddChunk(":benchmark.1", chunk, received);
+            }
+            decodeUs += lsf::GetTimestampInUs() - start;
+
+            if (!complete || (received != blob)) {
+                printf("Transfer of %u bytes failed\n", (uint32_t) blob.length());
+                return 1;
+            }
+        }
+
+        char plainWire[32];
+        if (blob.length() < MAX_MESSAGE_LEN) {
+            snprintf(plainWire, sizeof(plainWire), "%.1f", (double) blob.length() / linkRate);
+        } else {
+            snprintf(plainWire, sizeof(plainWire), "too long");
+        }
+
+        printf("%-9u %-9u %-6.2f %-6u %-12llu %-12llu %-14s %-14.1f\n", (uint32_t) blob.length(), (uint32_t) compressedLength,
+               (double) blob.length() / compressedLength, numChunks, (unsigned long long) (encodeUs / iterations),
+               (unsigned long long) (decodeUs / iterations), plainWire, (double) compressedLength / linkRate);
+    }
+
+    return 0;
+}
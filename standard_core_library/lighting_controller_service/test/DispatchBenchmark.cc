@@ -0,0 +1,190 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Method dispatch benchmark. \n
+ * Runs the handler lookup of the Controller Service method dispatcher from a
+ * growing number of concurrent callers and reports, for each count, the
+ * dispatches per second and the average time per dispatch of:
+ *   - the former dispatcher: a mutex-protected call counter and a lookup of the
+ *     member name in a std::map protected by another mutex
+ *   - the dispatch table: an atomic call counter and a lock-free lookup of the
+ *     member in the sealed MethodDispatchTable
+ * The members are stand-ins for the interface members of the Controller Service.
+ *
+ * Usage: dispatch_benchmark [maxThreads] [dispatchesPerThread]
+ */
+
+#include <MethodDispatchTable.h>
+#include <Mutex.h>
+#include <LSFTypes.h>
+
+#include <qcc/atomic.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace lsf;
+
+/*
+ * Number of methods the Controller Service registers
+ */
+static const size_t METHOD_COUNT = 69;
+
+struct Member {
+    std::string name;
+};
+
+struct Handler {
+    Handler(uint32_t id) : id(id) { }
+    uint32_t id;
+};
+
+typedef MethodDispatchTable<const Member*, Handler> DispatchTable;
+typedef std::map<std::string, Handler*> DispatcherMap;
+
+static std::vector<Member*> members;
+
+static DispatchTable dispatchTable;
+static volatile int32_t tableCallCount = 0;
+
+static DispatcherMap dispatcherMap;
+static Mutex dispatcherMapLock;
+static Mutex mapCallCountLock;
+static uint32_t mapCallCount = 0;
+
+struct Caller {
+    bool useTable;
+    uint32_t dispatches;
+    uint32_t seed;
+    uint64_t checksum;
+};
+
+static void* CallerThread(void* arg)
+{
+    Caller* caller = static_cast<Caller*>(arg);
+    uint64_t checksum = 0;
+    uint32_t seed = caller->seed;
+
+    for (uint32_t i = 0; i < caller->dispatches; i++) {
+        seed = seed * 1103515245 + 12345;
+        const Member* member = members[(seed >> 16) % members.size()];
+        Handler* handler = NULL;
+
+        if (caller->useTable) {
+            checksum += static_cast<uint32_t>(qcc::IncrementAndFetch(&tableCallCount));
+            handler = dispatchTable.Find(member);
+        } else {
+            mapCallCountLock.Lock();
+            mapCallCount++;
+            checksum += mapCallCount;
+            mapCallCountLock.Unlock();
+
+            dispatcherMapLock.Lock();
+            DispatcherMap::iterator it = dispatcherMap.find(member->name);
+            if (it != dispatcherMap.end()) {
+                handler = it->second;
+            }
+            dispatcherMapLock.Unlock();
+        }
+
+        if (!handler) {
+            fprintf(stderr, "No handler for %s\n", member->name.c_str());
+            exit(1);
+        }
+        checksum += handler->id;
+    }
+
+    caller->checksum = checksum;
+    return NULL;
+}
+
+static uint64_t RunCallers(bool useTable, uint32_t threads, uint32_t dispatchesPerThread)
+{
+    std::vector<pthread_t> tids(threads);
+    std::vector<Caller> callers(threads);
+
+    uint64_t start = lsf::GetTimestampInUs();
+    for (uint32_t i = 0; i < threads; i++) {
+        callers[i].useTable = useTable;
+        callers[i].dispatches = dispatchesPerThread;
+        callers[i].seed = i + 1;
+        callers[i].checksum = 0;
+        if (pthread_create(&tids[i], NULL, CallerThread, &callers[i]) != 0) {
+            fprintf(stderr, "Unable to start caller thread %u\n", i);
+            exit(1);
+        }
+    }
+    for (uint32_t i = 0; i < threads; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    return lsf::GetTimestampInUs() - start;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t maxThreads = (argc > 1) ? atoi(argv[1]) : 16;
+    uint32_t dispatchesPerThread = (argc > 2) ? atoi(argv[2]) : 1000000;
+
+    if (maxThreads == 0 || dispatchesPerThread == 0) {
+        fprintf(stderr, "Usage: %s [maxThreads] [dispatchesPerThread]\n", argv[0]);
+        return 1;
+    }
+
+    for (size_t i = 0; i < METHOD_COUNT; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "ControllerServiceMethod%02u", (unsigned int) i);
+        Member* member = new Member();
+        member->name = name;
+        members.push_back(member);
+        dispatchTable.Add(member, new Handler(i));
+        dispatcherMap.insert(std::make_pair(member->name, new Handler(i)));
+    }
+    dispatchTable.Seal();
+
+    printf("%zu methods, %u dispatches per thread\n", members.size(), dispatchesPerThread);
+    printf("%8s %16s %12s %16s %12s %8s\n", "threads", "map calls/s", "map ns/call", "table calls/s", "table ns/call", "speedup");
+
+    for (uint32_t threads = 1; threads <= maxThreads; threads <<= 1) {
+        uint64_t total = (uint64_t) threads * dispatchesPerThread;
+        uint64_t mapUs = RunCallers(false, threads, dispatchesPerThread);
+        uint64_t tableUs = RunCallers(true, threads, dispatchesPerThread);
+        if (mapUs == 0) {
+            mapUs = 1;
+        }
+        if (tableUs == 0) {
+            tableUs = 1;
+        }
+
+        printf("%8u %16.0f %12.1f %16.0f %12.1f %7.1fx\n", threads,
+               total * 1000000.0 / mapUs, mapUs * 1000.0 / total,
+               total * 1000000.0 / tableUs, tableUs * 1000.0 / total,
+               (double) mapUs / tableUs);
+    }
+
+    for (DispatcherMap::iterator it = dispatcherMap.begin(); it != dispatcherMap.end(); ++it) {
+        delete it->second;
+    }
+    for (size_t i = 0; i < members.size(); i++) {
+        delete members[i];
+    }
+    return 0;
+}
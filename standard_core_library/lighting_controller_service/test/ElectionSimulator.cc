@@ -0,0 +1,1077 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Leader election simulator. \n
+ * Drives the ElectionStateMachine of N simulated Controller Services, the
+ * same election rules as LeaderElectionObject, on a virtual clock and a
+ * simulated bus, so that a run only depends on its seed. The heartbeats use
+ * the OEM_CS_LEADER_HEARTBEAT settings. \n
+ * The bus delivers About announcements with a delay and a jitter, replays the
+ * cached announcements to a controller that starts or that a partition heals
+ * towards, and reports a session with a crashed or partitioned controller as
+ * lost after the link timeout. Stores are found to differ on half of the
+ * coups, so that both the plain coup and the Overthrow handshake are run. \n
+ * For each scenario and run, reports:
+ *   - the convergence time: from the disruption until every partition has
+ *     exactly one leader that all its other controllers are connected to,
+ *     for good
+ *   - the split-brains: the number and duration of the periods where more than
+ *     one controller of a partition was the leader
+ *   - the number of announcements
+ *   - whether the highest-ranked follower of every partition, and only it,
+ *     is in hot standby at the end of the run
+ * A run that has not converged after HORIZON_MS is reported as such. \n
+ * Fails if a run of a scenario does not converge, converges later than the
+ * bound of the scenario or ends with the wrong followers in hot standby.
+ *
+ * Usage: election_simulator [numControllers] [runs] [seed]
+ */
+
+#include <ElectionStateMachine.h>
+#include <OEM_CS_Config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <vector>
+
+using namespace lsf;
+
+static const uint32_t LINK_DELAY_MS = 5; /* one-way delay of a message in a session */
+static const uint32_t ANNOUNCEMENT_DELAY_MS = 20; /* delay of an About announcement */
+static const uint32_t JOIN_SESSION_TIMEOUT_MS = 3000; /* time for a JoinSession with an unreachable controller to fail */
+static const uint32_t FETCH_STORES_MS = 50; /* time to fetch the stores of the outgoing leader */
+static const uint32_t SESSION_LOST_MS = LSF_MIN_LINK_TIMEOUT_IN_SECONDS * 1000; /* link timeout */
+static const uint64_t HORIZON_MS = 60000; /* length of a measured phase */
+static const uint64_t SETTLE_MS = 10000; /* time between two disruptions */
+static const uint64_t START_TIME_MS = 1000; /* FailureDetector takes a 0 time for no heartbeat */
+
+/*
+ * xorshift64*, so that the runs do not depend on the C library
+ */
+class Random {
+  public:
+    Random(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ULL) { }
+
+    uint64_t Next(void)
+    {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    uint32_t Below(uint32_t n)
+    {
+        return n ? static_cast<uint32_t>(Next() % n) : 0;
+    }
+
+  private:
+    uint64_t state;
+};
+
+typedef ElectionStateMachine::ControllerEntry ControllerEntry;
+
+/*
+ * The bus name of a simulated controller is its index
+ */
+static qcc::String BusName(uint32_t id)
+{
+    char name[16];
+    snprintf(name, sizeof(name), ":%u", id);
+    return qcc::String(name);
+}
+
+static uint32_t GetId(const qcc::String& busName)
+{
+    return strtoul(busName.c_str() + 1, NULL, 10);
+}
+
+enum EventType {
+    EVENT_START,            /* controller starts */
+    EVENT_WAKE,             /* wakeSem posted */
+    EVENT_ALARM,            /* election alarm fired */
+    EVENT_ANNOUNCE,         /* About announcement received */
+    EVENT_JOIN_REPLY,       /* JoinSessionAsync completed */
+    EVENT_SYNC_REPLY,       /* GetChecksumAndModificationTimestamp reply during a coup */
+    EVENT_FETCH_DONE,       /* stores fetched from the outgoing leader */
+    EVENT_OVERTHROW,        /* Overthrow method call received */
+    EVENT_OVERTHROW_REPLY,  /* Overthrow reply or timeout */
+    EVENT_SESSION_LOST,     /* session lost or leader left the session */
+    EVENT_HEARTBEAT_TICK,   /* HeartbeatTimer tick */
+    EVENT_HEARTBEAT         /* Heartbeat signal received */
+};
+
+struct Event {
+    uint64_t time;
+    uint64_t seq;
+    EventType type;
+    uint32_t target;
+    uint32_t incarnation; /* incarnation of the target the event is for */
+    uint32_t from;
+    uint32_t value; /* alarm generation, session ID or call ID */
+    bool flag; /* isLeader or success */
+    ControllerEntry entry; /* context of a JoinSession */
+};
+
+struct EventLater {
+    bool operator()(const Event& a, const Event& b) const
+    {
+        return (a.time != b.time) ? (a.time > b.time) : (a.seq > b.seq);
+    }
+};
+
+struct Session {
+    uint32_t host;
+    uint32_t hostIncarnation;
+    uint32_t member;
+};
+
+struct Call {
+    uint32_t caller;
+    uint32_t callee;
+    bool pending;
+};
+
+class Simulator;
+
+/*
+ * What the election of a simulated controller does to the simulated bus
+ */
+class SimBus : public ElectionStateMachine::Bus {
+  public:
+    SimBus(Simulator& sim, uint32_t id) : sim(sim), id(id) { }
+
+    virtual void SetIsLeader(bool isLeader);
+    virtual void SetAllowUpdates(bool allow) { }
+    virtual void ConnectToLamps(void) { }
+    virtual void DisconnectFromLamps(void) { }
+    virtual void UpdateHotStandby(bool standby);
+    virtual void LeaveSession(void);
+    virtual bool JoinSession(const ControllerEntry& leader);
+    virtual void LeaveSessionAsync(uint32_t sessionId);
+    virtual bool OnLeaderSessionJoined(const ControllerEntry& leader, uint32_t sessionId, bool overthrow);
+    virtual void OnLeaderSessionCleared(void) { }
+    virtual void SendOverthrowReply(uint32_t callId, bool accepted);
+    virtual void SetAlarmInMs(uint32_t timeInMs);
+    virtual void Wake(void);
+    virtual void SendHeartbeat(void);
+
+  private:
+    Simulator& sim;
+    uint32_t id;
+};
+
+struct SimController {
+    uint64_t rank;
+    bool up;
+    uint32_t incarnation;
+    bool announcedLeader; /* IsLeader of the About data */
+    bool hotStandby;
+    uint32_t alarmGeneration;
+    bool wakePending;
+    SimBus* bus;
+    ElectionStateMachine* election; /* replaced on every start */
+};
+
+struct SimConfig {
+    uint32_t numControllers;
+    uint32_t announcementJitterMs;
+    bool heartbeats;
+};
+
+struct PhaseResult {
+    bool converged;
+    uint64_t convergenceMs;
+    uint32_t splitBrains;
+    uint64_t splitBrainMs;
+    uint32_t announcements;
+    bool hotStandby; /* the right followers are in hot standby */
+};
+
+class Simulator : public ElectionStateMachine::Clock {
+  public:
+
+    friend class SimBus;
+
+    Simulator(const SimConfig& config, uint64_t seed)
+        : config(config), random(seed), now(START_TIME_MS), nextSeq(0), nextSessionId(1),
+        wasConverged(false), convergedAt(0), inSplitBrain(false), splitBrainStart(0)
+    {
+        std::vector<uint64_t> ranks;
+        while (ranks.size() < config.numControllers) {
+            uint64_t rank = random.Next();
+            if (rank && (std::find(ranks.begin(), ranks.end(), rank) == ranks.end())) {
+                ranks.push_back(rank);
+            }
+        }
+        for (uint32_t i = 0; i < config.numControllers; i++) {
+            SimController c;
+            c.rank = ranks[i];
+            c.up = false;
+            c.incarnation = 0;
+            c.announcedLeader = false;
+            c.hotStandby = false;
+            c.alarmGeneration = 0;
+            c.wakePending = false;
+            c.bus = new SimBus(*this, i);
+            c.election = new ElectionStateMachine(*c.bus, *this);
+            controllers.push_back(c);
+            group.push_back(0);
+        }
+        lastAnnouncement.resize(config.numControllers * config.numControllers, 0);
+        ResetMetrics();
+    }
+
+    ~Simulator()
+    {
+        for (uint32_t i = 0; i < controllers.size(); i++) {
+            delete controllers[i].election;
+            delete controllers[i].bus;
+        }
+    }
+
+    virtual uint64_t GetTimestampInMs(void)
+    {
+        return now;
+    }
+
+    Random& GetRandom(void) { return random; }
+
+    uint64_t Now(void) const { return now; }
+
+    /*
+     * Start a controller in delay ms
+     */
+    void ScheduleStart(uint32_t id, uint32_t delay)
+    {
+        Schedule(delay, EVENT_START, id, id);
+    }
+
+    /*
+     * Crash a controller. The sessions it hosts are reported as lost after the link timeout
+     */
+    void Crash(uint32_t id)
+    {
+        SimController& c = controllers[id];
+        c.up = false;
+        c.hotStandby = false;
+        c.incarnation++;
+        for (std::map<uint32_t, Session>::iterator it = sessions.begin(); it != sessions.end();) {
+            if (it->second.host == id) {
+                Schedule(SESSION_LOST_MS, EVENT_SESSION_LOST, it->second.member, id, it->first);
+                ++it;
+            } else if (it->second.member == id) {
+                sessions.erase(it++);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    /*
+     * Split the controllers in partitions. The sessions across partitions are
+     * reported as lost after the link timeout, unless the partition heals before
+     */
+    void Partition(const std::vector<uint32_t>& groups)
+    {
+        group = groups;
+        for (std::map<uint32_t, Session>::iterator it = sessions.begin(); it != sessions.end(); ++it) {
+            if (group[it->second.host] != group[it->second.member]) {
+                Schedule(SESSION_LOST_MS, EVENT_SESSION_LOST, it->second.member, it->second.host, it->first);
+            }
+        }
+    }
+
+    /*
+     * Heal all partitions. The controllers that can reach each other again get
+     * the announcements of each other
+     */
+    void Heal(void)
+    {
+        std::vector<uint32_t> before = group;
+        std::fill(group.begin(), group.end(), 0);
+        for (uint32_t a = 0; a < controllers.size(); a++) {
+            for (uint32_t b = 0; b < controllers.size(); b++) {
+                if ((a != b) && (before[a] != before[b]) && controllers[a].up && controllers[b].up) {
+                    SendAnnouncement(a, b);
+                }
+            }
+        }
+    }
+
+    /*
+     * Highest ranked controller that is up and the leader, -1 if none
+     */
+    int GetLeader(void) const
+    {
+        int leader = -1;
+        for (uint32_t i = 0; i < controllers.size(); i++) {
+            if (controllers[i].up && controllers[i].election->IsLeader() && ((leader < 0) || (controllers[i].rank > controllers[leader].rank))) {
+                leader = i;
+            }
+        }
+        return leader;
+    }
+
+    /*
+     * Controllers by decreasing rank
+     */
+    std::vector<uint32_t> GetControllersByRank(void) const
+    {
+        std::vector<std::pair<uint64_t, uint32_t> > ranked;
+        for (uint32_t i = 0; i < controllers.size(); i++) {
+            ranked.push_back(std::make_pair(controllers[i].rank, i));
+        }
+        std::sort(ranked.rbegin(), ranked.rend());
+        std::vector<uint32_t> ids;
+        for (uint32_t i = 0; i < ranked.size(); i++) {
+            ids.push_back(ranked[i].second);
+        }
+        return ids;
+    }
+
+    /*
+     * Run the simulation for length ms
+     */
+    void RunFor(uint64_t length)
+    {
+        uint64_t end = now + length;
+        while (!events.empty() && (events.top().time <= end)) {
+            Event event = events.top();
+            events.pop();
+            now = event.time;
+            Dispatch(event);
+            Evaluate();
+        }
+        now = end;
+    }
+
+    /*
+     * Run the simulation for HORIZON_MS and measure how the controllers converge
+     */
+    PhaseResult Measure(void)
+    {
+        uint64_t start = now;
+        ResetMetrics();
+        RunFor(HORIZON_MS);
+        if (inSplitBrain) {
+            splitBrainMs += now - splitBrainStart;
+            inSplitBrain = false;
+        }
+
+        PhaseResult result;
+        result.converged = wasConverged;
+        result.convergenceMs = wasConverged ? (convergedAt - start) : 0;
+        result.splitBrains = splitBrains;
+        result.splitBrainMs = splitBrainMs;
+        result.announcements = announcements;
+        result.hotStandby = wasConverged && CheckHotStandby();
+        return result;
+    }
+
+  private:
+
+    void Schedule(uint64_t delay, EventType type, uint32_t target, uint32_t from, uint32_t value = 0, bool flag = false)
+    {
+        Event event;
+        event.time = now + delay;
+        event.seq = nextSeq++;
+        event.type = type;
+        event.target = target;
+        event.incarnation = controllers[target].incarnation;
+        event.from = from;
+        event.value = value;
+        event.flag = flag;
+        events.push(event);
+    }
+
+    void ScheduleJoinReply(uint64_t delay, uint32_t target, const ControllerEntry& entry, uint32_t sessionId, bool success)
+    {
+        Event event;
+        event.time = now + delay;
+        event.seq = nextSeq++;
+        event.type = EVENT_JOIN_REPLY;
+        event.target = target;
+        event.incarnation = controllers[target].incarnation;
+        event.from = GetId(entry.busName);
+        event.value = sessionId;
+        event.flag = success;
+        event.entry = entry;
+        events.push(event);
+    }
+
+    bool Reachable(uint32_t a, uint32_t b) const
+    {
+        return (controllers[a].up && controllers[b].up && (group[a] == group[b]));
+    }
+
+    bool IsConnected(const Session& session) const
+    {
+        return (Reachable(session.host, session.member) && (controllers[session.host].incarnation == session.hostIncarnation));
+    }
+
+    /*
+     * Bus
+     */
+
+    /*
+     * The announcements of a controller are received in the order they were sent
+     */
+    void SendAnnouncement(uint32_t from, uint32_t to)
+    {
+        announcements++;
+        uint64_t& last = lastAnnouncement[(from * controllers.size()) + to];
+        last = std::max(last, now + ANNOUNCEMENT_DELAY_MS + random.Below(config.announcementJitterMs + 1));
+        Schedule(last - now, EVENT_ANNOUNCE, to, from, 0, controllers[from].announcedLeader);
+    }
+
+    void Announce(uint32_t id)
+    {
+        for (uint32_t i = 0; i < controllers.size(); i++) {
+            if ((i != id) && Reachable(id, i)) {
+                SendAnnouncement(id, i);
+            }
+        }
+    }
+
+    /*
+     * The Controller Service only accepts joiners while it is the leader
+     */
+    void JoinSession(uint32_t id, const ControllerEntry& leader)
+    {
+        uint32_t host = GetId(leader.busName);
+        if (!Reachable(id, host)) {
+            ScheduleJoinReply(JOIN_SESSION_TIMEOUT_MS, id, leader, 0, false);
+        } else if (!controllers[host].announcedLeader) {
+            ScheduleJoinReply(2 * LINK_DELAY_MS, id, leader, 0, false);
+        } else {
+            uint32_t sessionId = nextSessionId++;
+            Session session;
+            session.host = host;
+            session.hostIncarnation = controllers[host].incarnation;
+            session.member = id;
+            sessions[sessionId] = session;
+            ScheduleJoinReply(2 * LINK_DELAY_MS, id, leader, sessionId, true);
+        }
+    }
+
+    /*
+     * ControllerService::LeaveSession. The members are told that the host left;
+     * the ones that cannot be reached already wait for the link timeout
+     */
+    void LeaveSession(uint32_t id)
+    {
+        for (std::map<uint32_t, Session>::iterator it = sessions.begin(); it != sessions.end();) {
+            if (it->second.host == id) {
+                if (IsConnected(it->second)) {
+                    Schedule(LINK_DELAY_MS, EVENT_SESSION_LOST, it->second.member, id, it->first, true);
+                    sessions.erase(it++);
+                } else {
+                    ++it;
+                }
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void DoLeaveSessionAsync(uint32_t sessionId)
+    {
+        sessions.erase(sessionId);
+    }
+
+    uint32_t CallMethod(uint32_t caller, uint32_t callee, EventType type)
+    {
+        uint32_t callId = calls.size();
+        Call call;
+        call.caller = caller;
+        call.callee = callee;
+        call.pending = true;
+        calls.push_back(call);
+        if (Reachable(caller, callee)) {
+            Schedule(LINK_DELAY_MS, type, callee, caller, callId);
+        }
+        return callId;
+    }
+
+    void SetAlarmInMs(uint32_t id, uint32_t ms)
+    {
+        SimController& c = controllers[id];
+        c.alarmGeneration++;
+        if (ms) {
+            Schedule(ms, EVENT_ALARM, id, id, c.alarmGeneration);
+        }
+    }
+
+    void Wake(uint32_t id)
+    {
+        SimController& c = controllers[id];
+        if (!c.wakePending) {
+            c.wakePending = true;
+            Schedule(0, EVENT_WAKE, id, id);
+        }
+    }
+
+    void SetIsLeader(uint32_t id, bool isLeader)
+    {
+        controllers[id].announcedLeader = isLeader;
+        Announce(id);
+    }
+
+    void SetHotStandby(uint32_t id, bool standby)
+    {
+        controllers[id].hotStandby = standby;
+    }
+
+    /*
+     * Stores that differ are fetched before the Overthrow call, so the reply
+     * to GetChecksumAndModificationTimestamp is only awaited during a coup
+     */
+    void StartStateSync(uint32_t id, uint32_t leader, bool overthrow)
+    {
+        if (overthrow) {
+            bool reachable = Reachable(id, leader);
+            Schedule(reachable ? (2 * LINK_DELAY_MS) : OVERTHROW_TIMEOUT_IN_M_SEC, EVENT_SYNC_REPLY, id, leader, 0, reachable);
+        }
+    }
+
+    void SendOverthrowReply(uint32_t id, uint32_t callId)
+    {
+        if (Reachable(id, calls[callId].caller)) {
+            Schedule(LINK_DELAY_MS, EVENT_OVERTHROW_REPLY, calls[callId].caller, id, callId);
+        }
+    }
+
+    void SendHeartbeat(uint32_t id)
+    {
+        for (std::map<uint32_t, Session>::iterator it = sessions.begin(); it != sessions.end(); ++it) {
+            if ((it->second.host == id) && IsConnected(it->second)) {
+                Schedule(LINK_DELAY_MS, EVENT_HEARTBEAT, it->second.member, id, it->first);
+            }
+        }
+    }
+
+    /*
+     * Events
+     */
+
+    void Dispatch(const Event& event)
+    {
+        SimController& c = controllers[event.target];
+        if (event.type == EVENT_START) {
+            Start(event.target);
+            return;
+        }
+        if (!c.up || (event.incarnation != c.incarnation)) {
+            return;
+        }
+
+        switch (event.type) {
+        case EVENT_WAKE:
+            c.wakePending = false;
+            c.election->Run();
+            break;
+
+        case EVENT_ALARM:
+            if (event.value == c.alarmGeneration) {
+                c.election->AlarmTriggered();
+            }
+            break;
+
+        case EVENT_ANNOUNCE:
+            if (Reachable(event.from, event.target)) {
+                ControllerEntry entry;
+                entry.busName = BusName(event.from);
+                entry.rank = Rank(0, controllers[event.from].rank);
+                entry.isLeader = event.flag;
+                c.election->OnAnnounced(entry);
+            }
+            break;
+
+        case EVENT_JOIN_REPLY:
+            c.election->OnSessionJoined(event.flag ? ER_OK : ER_FAIL, event.value, event.entry);
+            break;
+
+        case EVENT_SYNC_REPLY:
+            /*
+             * Stores that differ are fetched before the Overthrow call. A timed out
+             * reply or stores in sync complete the coup right away
+             */
+            if (event.flag && random.Below(2)) {
+                Schedule(FETCH_STORES_MS, EVENT_FETCH_DONE, event.target, event.from);
+            } else {
+                c.election->OnOverthrowReply();
+            }
+            break;
+
+        case EVENT_FETCH_DONE:
+            if (c.election->IsOverthrowing()) {
+                ControllerEntry leader;
+                uint32_t leaderSession;
+                c.election->GetCurrentLeader(leader, leaderSession);
+                if (leaderSession) {
+                    uint32_t callId = CallMethod(event.target, GetId(leader.busName), EVENT_OVERTHROW);
+                    Schedule(OVERTHROW_TIMEOUT_IN_M_SEC, EVENT_OVERTHROW_REPLY, event.target, GetId(leader.busName), callId);
+                } else {
+                    c.election->OnOverthrowReply();
+                }
+            }
+            break;
+
+        case EVENT_OVERTHROW:
+            if (Reachable(event.from, event.target)) {
+                c.election->OnOverthrow(BusName(event.from).c_str(), event.value);
+            }
+            break;
+
+        case EVENT_OVERTHROW_REPLY:
+            if (calls[event.value].pending) {
+                calls[event.value].pending = false;
+                c.election->OnOverthrowReply();
+            }
+            break;
+
+        case EVENT_SESSION_LOST:
+            /*
+             * The link timeout only expires for a session that was not left and is still broken
+             */
+            if (!event.flag) {
+                std::map<uint32_t, Session>::iterator it = sessions.find(event.value);
+                if ((it == sessions.end()) || IsConnected(it->second)) {
+                    break;
+                }
+                sessions.erase(it);
+            }
+            c.election->OnSessionLost(event.value);
+            break;
+
+        case EVENT_HEARTBEAT_TICK:
+            c.election->OnHeartbeatTimer();
+            Schedule(OEM_CS_LEADER_HEARTBEAT_INTERVAL_MS, EVENT_HEARTBEAT_TICK, event.target, event.target);
+            break;
+
+        case EVENT_HEARTBEAT:
+            if (Reachable(event.from, event.target)) {
+                c.election->OnHeartbeat(event.value, BusName(event.from).c_str());
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void Start(uint32_t id)
+    {
+        SimController& c = controllers[id];
+        if (c.up) {
+            return;
+        }
+        c.up = true;
+        c.incarnation++;
+        c.announcedLeader = false;
+        c.hotStandby = false;
+        c.alarmGeneration++;
+        c.wakePending = false;
+        delete c.election;
+        c.election = new ElectionStateMachine(*c.bus, *this);
+        c.election->SetRank(Rank(0, c.rank));
+
+        /*
+         * Announce self and get the cached announcements of the others
+         */
+        Announce(id);
+        for (uint32_t i = 0; i < controllers.size(); i++) {
+            if ((i != id) && Reachable(id, i)) {
+                SendAnnouncement(i, id);
+            }
+        }
+        if (config.heartbeats) {
+            Schedule(1 + random.Below(OEM_CS_LEADER_HEARTBEAT_INTERVAL_MS), EVENT_HEARTBEAT_TICK, id, id);
+        }
+        Wake(id);
+    }
+
+    /*
+     * Metrics
+     */
+
+    void ResetMetrics(void)
+    {
+        splitBrains = 0;
+        splitBrainMs = 0;
+        announcements = 0;
+        inSplitBrain = false;
+        wasConverged = false;
+        convergedAt = now;
+        Evaluate();
+    }
+
+    /*
+     * Converged when every partition has exactly one leader and all its other
+     * controllers are in a session with that leader
+     */
+    void Evaluate(void)
+    {
+        bool converged = true;
+        bool splitBrain = false;
+
+        std::map<uint32_t, std::vector<uint32_t> > leaders;
+        for (uint32_t i = 0; i < controllers.size(); i++) {
+            if (controllers[i].up) {
+                std::vector<uint32_t>& groupLeaders = leaders[group[i]];
+                if (controllers[i].election->IsLeader()) {
+                    groupLeaders.push_back(i);
+                }
+            }
+        }
+        for (std::map<uint32_t, std::vector<uint32_t> >::iterator it = leaders.begin(); it != leaders.end(); it++) {
+            if (it->second.size() != 1) {
+                converged = false;
+                splitBrain = splitBrain || (it->second.size() > 1);
+            }
+        }
+        for (uint32_t i = 0; converged && (i < controllers.size()); i++) {
+            const SimController& c = controllers[i];
+            if (c.up && !c.election->IsLeader()) {
+                uint32_t leader = leaders[group[i]][0];
+                ControllerEntry currentLeader;
+                uint32_t leaderSession;
+                c.election->GetCurrentLeader(currentLeader, leaderSession);
+                std::map<uint32_t, Session>::const_iterator sit = sessions.find(leaderSession);
+                if ((currentLeader.busName != BusName(leader)) || (sit == sessions.end()) || (sit->second.host != leader) || !IsConnected(sit->second)) {
+                    converged = false;
+                }
+            }
+        }
+
+        if (converged && !wasConverged) {
+            convergedAt = now;
+        }
+        wasConverged = converged;
+
+        if (splitBrain && !inSplitBrain) {
+            splitBrains++;
+            splitBrainStart = now;
+        } else if (!splitBrain && inSplitBrain) {
+            splitBrainMs += now - splitBrainStart;
+        }
+        inSplitBrain = splitBrain;
+    }
+
+    /*
+     * Only the highest-ranked follower of each partition is in hot standby
+     */
+    bool CheckHotStandby(void) const
+    {
+        std::map<uint32_t, int> highest;
+        for (uint32_t i = 0; i < controllers.size(); i++) {
+            if (controllers[i].up && !controllers[i].election->IsLeader()) {
+                std::map<uint32_t, int>::iterator it = highest.find(group[i]);
+                if ((it == highest.end()) || (controllers[i].rank > controllers[it->second].rank)) {
+                    highest[group[i]] = i;
+                }
+            }
+        }
+        for (uint32_t i = 0; i < controllers.size(); i++) {
+            if (controllers[i].up && !controllers[i].election->IsLeader()) {
+                if (controllers[i].hotStandby != (highest[group[i]] == static_cast<int>(i))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    SimConfig config;
+    Random random;
+    uint64_t now;
+    uint64_t nextSeq;
+    std::priority_queue<Event, std::vector<Event>, EventLater> events;
+    std::vector<SimController> controllers;
+    std::vector<uint32_t> group;
+    std::vector<uint64_t> lastAnnouncement;
+    std::map<uint32_t, Session> sessions;
+    uint32_t nextSessionId;
+    std::vector<Call> calls;
+
+    bool wasConverged;
+    uint64_t convergedAt;
+    bool inSplitBrain;
+    uint64_t splitBrainStart;
+    uint32_t splitBrains;
+    uint64_t splitBrainMs;
+    uint32_t announcements;
+};
+
+void SimBus::SetIsLeader(bool isLeader)
+{
+    sim.SetIsLeader(id, isLeader);
+}
+
+void SimBus::UpdateHotStandby(bool standby)
+{
+    sim.SetHotStandby(id, standby);
+}
+
+void SimBus::LeaveSession(void)
+{
+    sim.LeaveSession(id);
+}
+
+bool SimBus::JoinSession(const ControllerEntry& leader)
+{
+    sim.JoinSession(id, leader);
+    return true;
+}
+
+void SimBus::LeaveSessionAsync(uint32_t sessionId)
+{
+    sim.DoLeaveSessionAsync(sessionId);
+}
+
+bool SimBus::OnLeaderSessionJoined(const ControllerEntry& leader, uint32_t sessionId, bool overthrow)
+{
+    sim.StartStateSync(id, GetId(leader.busName), overthrow);
+    return true;
+}
+
+void SimBus::SendOverthrowReply(uint32_t callId, bool accepted)
+{
+    sim.SendOverthrowReply(id, callId);
+}
+
+void SimBus::SetAlarmInMs(uint32_t timeInMs)
+{
+    sim.SetAlarmInMs(id, timeInMs);
+}
+
+void SimBus::Wake(void)
+{
+    sim.Wake(id);
+}
+
+void SimBus::SendHeartbeat(void)
+{
+    sim.SendHeartbeat(id);
+}
+
+/*
+ * Scenarios. Each one runs on a fresh simulator and returns the measured phase
+ */
+
+static void StartAll(Simulator& sim, uint32_t numControllers)
+{
+    for (uint32_t i = 0; i < numControllers; i++) {
+        sim.ScheduleStart(i, sim.GetRandom().Below(1000));
+    }
+}
+
+static void WarmUp(Simulator& sim, uint32_t numControllers)
+{
+    StartAll(sim, numControllers);
+    sim.Measure();
+    sim.RunFor(SETTLE_MS);
+}
+
+static PhaseResult ColdStart(Simulator& sim, uint32_t numControllers)
+{
+    StartAll(sim, numControllers);
+    return sim.Measure();
+}
+
+static PhaseResult LeaderCrash(Simulator& sim, uint32_t numControllers)
+{
+    WarmUp(sim, numControllers);
+    int leader = sim.GetLeader();
+    if (leader >= 0) {
+        sim.Crash(leader);
+    }
+    return sim.Measure();
+}
+
+static PhaseResult Partition(Simulator& sim, uint32_t numControllers)
+{
+    WarmUp(sim, numControllers);
+    std::vector<uint32_t> groups(numControllers, 0);
+    for (uint32_t i = 0; i < numControllers; i++) {
+        groups[i] = sim.GetRandom().Below(2);
+    }
+    sim.Partition(groups);
+    return sim.Measure();
+}
+
+static PhaseResult PartitionHeal(Simulator& sim, uint32_t numControllers)
+{
+    Partition(sim, numControllers);
+    sim.RunFor(SETTLE_MS);
+    sim.Heal();
+    return sim.Measure();
+}
+
+static PhaseResult HighestRankRestart(Simulator& sim, uint32_t numControllers)
+{
+    WarmUp(sim, numControllers);
+    uint32_t highest = sim.GetControllersByRank()[0];
+    sim.Crash(highest);
+    sim.RunFor(SETTLE_MS);
+    sim.ScheduleStart(highest, 0);
+    return sim.Measure();
+}
+
+static PhaseResult CascadeCrash(Simulator& sim, uint32_t numControllers)
+{
+    WarmUp(sim, numControllers);
+    std::vector<uint32_t> ranked = sim.GetControllersByRank();
+    for (uint32_t i = 1; (i < 3) && (i + 1 < ranked.size()); i++) {
+        sim.Crash(ranked[i]);
+    }
+    sim.RunFor(SETTLE_MS);
+    int leader = sim.GetLeader();
+    if (leader >= 0) {
+        sim.Crash(leader);
+    }
+    return sim.Measure();
+}
+
+struct Scenario {
+    const char* name;
+    PhaseResult (*run)(Simulator& sim, uint32_t numControllers);
+    uint32_t announcementJitterMs;
+    bool heartbeats;
+    uint64_t maxConvergenceMs; /* 0 for no bound */
+    bool checkHotStandby;
+};
+
+/*
+ * With heartbeats, the failovers are bound to a second however many
+ * followers there are: the cascade crash leaves two crashed followers above
+ * the one that takes over. The hot standby is not checked:
+ *   - after a partition, as the followers keep the controllers of the other
+ *     partition in their controllersMap: nothing tells them that a follower
+ *     went away while their leader is up
+ *   - with announcements that are late by more than the election intervals,
+ *     as a controller that took over by mistake forgets the followers that
+ *     rank higher than it when it steps down
+ * The other scenarios keep the jitter of the announcements below
+ * OEM_CS_LEADER_TAKEOVER_WAIT_MS
+ */
+static const Scenario scenarios[] = {
+    { "cold start", ColdStart, 0, true, 0, true },
+    { "cold start, jitter", ColdStart, 1500, true, 0, false },
+    { "leader crash", LeaderCrash, 0, true, 1000, true },
+    { "leader crash, no hb", LeaderCrash, 0, false, 0, true },
+    { "partition", Partition, 100, true, 0, false },
+    { "partition heal", PartitionHeal, 100, true, 0, true },
+    { "highest restart", HighestRankRestart, 100, true, 0, true },
+    { "cascade crash", CascadeCrash, 0, true, 1000, true },
+};
+
+static uint64_t Percentile(std::vector<uint64_t>& values, uint32_t percent)
+{
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min<size_t>(values.size() - 1, (values.size() * percent) / 100)];
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t numControllers = (argc > 1) ? strtoul(argv[1], NULL, 10) : 8;
+    uint32_t runs = (argc > 2) ? strtoul(argv[2], NULL, 10) : 100;
+    uint64_t seed = (argc > 3) ? strtoull(argv[3], NULL, 10) : 1;
+
+    if (numControllers < 2) {
+        printf("At least 2 controllers are needed\n");
+        return 1;
+    }
+
+    printf("controllers=%u runs=%u seed=%llu heartbeat=%u ms x %u\n", numControllers, runs, (unsigned long long) seed,
+           OEM_CS_LEADER_HEARTBEAT_INTERVAL_MS, OEM_CS_LEADER_HEARTBEAT_MISSED_THRESHOLD);
+    printf("%-20s %-9s %-9s %-9s %-9s %-9s %-12s %-14s %-9s %-9s\n", "scenario", "converged", "mean ms", "p50 ms", "p99 ms", "max ms",
+           "split runs", "split mean ms", "announces", "standby");
+
+    uint32_t failures = 0;
+
+    for (size_t s = 0; s < sizeof(scenarios) / sizeof(scenarios[0]); s++) {
+        SimConfig config;
+        config.numControllers = numControllers;
+        config.announcementJitterMs = scenarios[s].announcementJitterMs;
+        config.heartbeats = scenarios[s].heartbeats;
+
+        std::vector<uint64_t> convergence;
+        uint64_t convergenceSum = 0;
+        uint32_t splitRuns = 0;
+        uint64_t splitMs = 0;
+        uint64_t announcements = 0;
+        uint32_t hotStandby = 0;
+
+        for (uint32_t r = 0; r < runs; r++) {
+            Simulator sim(config, (seed * 0x9E3779B97F4A7C15ULL) + (s << 20) + r);
+            PhaseResult result = scenarios[s].run(sim, numControllers);
+            if (result.converged) {
+                convergence.push_back(result.convergenceMs);
+                convergenceSum += result.convergenceMs;
+            }
+            if (result.splitBrains) {
+                splitRuns++;
+                splitMs += result.splitBrainMs;
+            }
+            announcements += result.announcements;
+            if (result.hotStandby) {
+                hotStandby++;
+            }
+        }
+
+        char converged[16];
+        snprintf(converged, sizeof(converged), "%u/%u", (uint32_t) convergence.size(), runs);
+        uint64_t mean = convergence.empty() ? 0 : (convergenceSum / convergence.size());
+        uint64_t p50 = Percentile(convergence, 50);
+        uint64_t p99 = Percentile(convergence, 99);
+        uint64_t max = convergence.empty() ? 0 : *std::max_element(convergence.begin(), convergence.end());
+
+        char standby[16];
+        snprintf(standby, sizeof(standby), "%u/%u", hotStandby, runs);
+
+        printf("%-20s %-9s %-9llu %-9llu %-9llu %-9llu %-12u %-14llu %-9llu %-9s\n", scenarios[s].name, converged,
+               (unsigned long long) mean, (unsigned long long) p50, (unsigned long long) p99, (unsigned long long) max,
+               splitRuns, (unsigned long long) (splitRuns ? (splitMs / splitRuns) : 0), (unsigned long long) (announcements / (runs ? runs : 1)),
+               standby);
+
+        if (convergence.size() != runs) {
+            printf("FAIL: %s: %u runs did not converge\n", scenarios[s].name, runs - (uint32_t) convergence.size());
+            failures++;
+        }
+        if (scenarios[s].maxConvergenceMs && (max > scenarios[s].maxConvergenceMs)) {
+            printf("FAIL: %s: converged in %llu ms, more than %llu ms\n", scenarios[s].name, (unsigned long long) max,
+                   (unsigned long long) scenarios[s].maxConvergenceMs);
+            failures++;
+        }
+        if (scenarios[s].checkHotStandby && (hotStandby != runs)) {
+            printf("FAIL: %s: %u runs ended with the wrong followers in hot standby\n", scenarios[s].name, runs - hotStandby);
+            failures++;
+        }
+    }
+
+    printf("%s\n", failures ? "FAILED" : "PASSED");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,225 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Lamp State encoding benchmark. \n
+ * Compares the two encodings of the Lamp State the Controller Service
+ * exchanges with the lamps:
+ *   - the a{sv} dictionary of org.allseen.LSF.LampState
+ *   - the LAMP_STATE_PACKED_SIGNATURE struct of org.allseen.LSF.LampStatePacked
+ * and reports, for each of them, the average time to marshal a Lamp State
+ * into a MsgArg, the average time to read it back into a LampState, and the
+ * size of the marshalled body of a whole state, of a single field and of a
+ * TransitionLampState call. The sizes follow the D-Bus alignment rules, with
+ * the body starting on an 8 byte boundary.
+ *
+ * Usage: lamp_state_encoding_benchmark [messages]
+ */
+
+#include <LSFTypes.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace lsf;
+
+static size_t Align(size_t offset, size_t alignment)
+{
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+static size_t Alignment(AllJoynTypeId typeId)
+{
+    switch (typeId) {
+    case ALLJOYN_BYTE:
+    case ALLJOYN_VARIANT:
+    case ALLJOYN_SIGNATURE:
+        return 1;
+
+    case ALLJOYN_UINT64:
+    case ALLJOYN_STRUCT:
+    case ALLJOYN_STRUCT_OPEN:
+    case ALLJOYN_DICT_ENTRY:
+    case ALLJOYN_DICT_ENTRY_OPEN:
+        return 8;
+
+    default:
+        return 4;
+    }
+}
+
+/*
+ * Offset past arg once it is marshalled at offset
+ */
+static size_t WireEnd(const MsgArg& arg, size_t offset)
+{
+    offset = Align(offset, Alignment(arg.typeId));
+
+    switch (arg.typeId) {
+    case ALLJOYN_BYTE:
+        return offset + 1;
+
+    case ALLJOYN_UINT64:
+        return offset + 8;
+
+    case ALLJOYN_STRING:
+        return offset + 4 + arg.v_string.len + 1;
+
+    case ALLJOYN_VARIANT:
+        offset += 1 + arg.v_variant.val->Signature().size() + 1;
+        return WireEnd(*arg.v_variant.val, offset);
+
+    case ALLJOYN_STRUCT:
+        for (size_t i = 0; i < arg.v_struct.numMembers; i++) {
+            offset = WireEnd(arg.v_struct.members[i], offset);
+        }
+        return offset;
+
+    case ALLJOYN_DICT_ENTRY:
+        offset = WireEnd(*arg.v_dictEntry.key, offset);
+        return WireEnd(*arg.v_dictEntry.val, offset);
+
+    case ALLJOYN_ARRAY:
+        {
+            /*
+             * The length is followed by the padding to the first element
+             * even when the array is empty
+             */
+            offset += 4;
+            offset = Align(offset, Alignment(static_cast<AllJoynTypeId>(arg.v_array.GetElemSig()[0])));
+            const MsgArg* elements = arg.v_array.GetElements();
+            for (size_t i = 0; i < arg.v_array.GetNumElements(); i++) {
+                offset = WireEnd(elements[i], offset);
+            }
+            return offset;
+        }
+
+    default:
+        return offset + 4;
+    }
+}
+
+static size_t WireSize(const MsgArg* args, size_t numArgs)
+{
+    size_t offset = 0;
+    for (size_t i = 0; i < numArgs; i++) {
+        offset = WireEnd(args[i], offset);
+    }
+    return offset;
+}
+
+static size_t checksum = 0;
+
+static void Consume(const LampState& state)
+{
+    checksum += state.hue + state.brightness + state.onOff;
+}
+
+struct Result {
+    double marshalNs;
+    double unmarshalNs;
+    size_t stateBytes;
+    size_t fieldBytes;
+    size_t callBytes;
+};
+
+static Result Run(bool packed, uint32_t messages, const LampState& state)
+{
+    Result result;
+    LampStateMsgArgs storage;
+    MsgArg arg;
+
+    uint64_t start = lsf::GetTimestampInUs();
+    for (uint32_t i = 0; i < messages; i++) {
+        LampState next(state);
+        next.hue += i;
+        if (packed) {
+            next.GetPacked(&arg);
+        } else {
+            next.Get(&arg, storage);
+        }
+        checksum += arg.typeId;
+    }
+    result.marshalNs = (lsf::GetTimestampInUs() - start) * 1000.0 / messages;
+
+    /*
+     * Read back from a copy, as the lamp replies are owned by their message
+     */
+    MsgArg received;
+    if (packed) {
+        state.GetPacked(&received);
+    } else {
+        state.Get(&received, true);
+    }
+
+    start = lsf::GetTimestampInUs();
+    for (uint32_t i = 0; i < messages; i++) {
+        LampState read;
+        if (packed) {
+            read.SetPacked(received);
+        } else {
+            read.Set(received);
+        }
+        Consume(read);
+    }
+    result.unmarshalNs = (lsf::GetTimestampInUs() - start) * 1000.0 / messages;
+
+    result.stateBytes = WireSize(&received, 1);
+
+    MsgArg* field = new MsgArg[1];
+    field[0].Set("{sv}", "Brightness", new MsgArg("u", state.brightness));
+    field[0].SetOwnershipFlags(MsgArg::OwnsArgs);
+    MsgArg fieldDict("a{sv}", 1, field);
+    fieldDict.SetOwnershipFlags(MsgArg::OwnsArgs);
+    MsgArg packedField;
+    CreatePackedLampStateArg(fieldDict, packedField);
+    result.fieldBytes = WireSize(packed ? &packedField : &fieldDict, 1);
+
+    MsgArg call[3];
+    call[0].Set("t", (uint64_t) 1000);
+    call[1] = received;
+    call[2].Set("u", 1000);
+    result.callBytes = WireSize(call, 3);
+
+    return result;
+}
+
+static void Print(const char* name, const Result& result)
+{
+    printf("%-12s %12.1f %14.1f %12u %12u %12u\n", name, result.marshalNs, result.unmarshalNs,
+           (unsigned) result.stateBytes, (unsigned) result.fieldBytes, (unsigned) result.callBytes);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t messages = (argc > 1) ? atoi(argv[1]) : 1000000;
+
+    if (messages == 0) {
+        fprintf(stderr, "Usage: %s [messages]\n", argv[0]);
+        return 1;
+    }
+
+    LampState state(true, 100, 200, 300, 400);
+
+    printf("%u messages\n", messages);
+    printf("%-12s %12s %14s %12s %12s %12s\n", "encoding", "marshal ns", "unmarshal ns", "state bytes", "field bytes", "call bytes");
+
+    Print("a{sv}", Run(false, messages, state));
+    Print(LAMP_STATE_PACKED_SIGNATURE, Run(true, messages, state));
+
+    printf("checksum %zu\n", checksum);
+    return 0;
+}
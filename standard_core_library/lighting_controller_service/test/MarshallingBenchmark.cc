@@ -0,0 +1,314 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Marshalling benchmark. \n
+ * Builds the arguments of the most frequent replies and signals of the
+ * Controller Service and reports, for each of them, the heap allocations and
+ * the average time per message of:
+ *   - the former helpers, reproduced here: a Lamp State dictionary allocated
+ *     entry by entry, a temporary array of the IDs of a list, a copy and a
+ *     strdupnew of a blob, and a lamp method reply copied through a heap array
+ *   - the current helpers: LampState::Get into LampStateMsgArgs,
+ *     CreateStringListArg, a blob referenced in place, and a lamp method reply
+ *     marshalled from the stack
+ * The allocations are counted by replacing the global operator new, so they
+ * include the ones made inside AllJoyn while setting the MsgArgs.
+ *
+ * Usage: marshalling_benchmark [messages] [idsPerList]
+ */
+
+#include <LSFTypes.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+
+using namespace lsf;
+
+static uint64_t allocations = 0;
+
+void* operator new(size_t size) throw(std::bad_alloc)
+{
+    allocations++;
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) throw(std::bad_alloc)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) throw()
+{
+    free(ptr);
+}
+
+void operator delete[](void* ptr) throw()
+{
+    free(ptr);
+}
+
+/*
+ * Number of arguments of a TransitionLampState reply: response code and lamp ID
+ */
+static const size_t LAMP_REPLY_ARGS = 2;
+
+/*
+ * Number of arguments marshalled from the stack by LampClients::SendMethodReply
+ */
+static const size_t LAMP_REPLY_STACK_ARGS = 8;
+
+static size_t checksum = 0;
+
+static void Consume(const MsgArg* args, size_t numArgs)
+{
+    for (size_t i = 0; i < numArgs; i++) {
+        checksum += args[i].typeId;
+    }
+}
+
+static void LegacyLampState(const LampState& state)
+{
+    MsgArg args[2];
+    args[0].Set("s", "0123456789abcdef");
+    state.Get(&args[1], true);
+    Consume(args, 2);
+}
+
+static void LampStateWithStorage(const LampState& state)
+{
+    MsgArg args[2];
+    LampStateMsgArgs stateArgs;
+    args[0].Set("s", "0123456789abcdef");
+    state.Get(&args[1], stateArgs);
+    Consume(args, 2);
+}
+
+static void LegacyIDList(const LSFStringList& idList)
+{
+    MsgArg args[2];
+    args[0].Set("u", LSF_OK);
+    size_t arraySize = idList.size();
+    if (arraySize) {
+        const char** ids = new const char*[arraySize];
+        size_t i = 0;
+        for (LSFStringList::const_iterator it = idList.begin(); it != idList.end(); ++it, ++i) {
+            ids[i] = it->c_str();
+        }
+        args[1].Set("as", arraySize, ids);
+        delete [] ids;
+    } else {
+        args[1].Set("as", 0, NULL);
+    }
+    Consume(args, 2);
+}
+
+static void IDListFromStack(const LSFStringList& idList)
+{
+    MsgArg args[2];
+    args[0].Set("u", LSF_OK);
+    CreateStringListArg(idList, args[1]);
+    Consume(args, 2);
+}
+
+static void LegacyBlob(std::string blob)
+{
+    MsgArg args[4];
+    args[0].Set("u", static_cast<uint32_t>(LSF_PRESET));
+    args[1].Set("s", strdupnew(blob.c_str()));
+    args[1].SetOwnershipFlags(MsgArg::OwnsData);
+    args[2].Set("u", 0x12345678);
+    args[3].Set("t", (uint64_t) 1000);
+    Consume(args, 4);
+}
+
+static void BlobInPlace(const std::string& blob)
+{
+    MsgArg args[4];
+    args[0].Set("u", static_cast<uint32_t>(LSF_PRESET));
+    args[1].Set("s", blob.c_str());
+    args[2].Set("u", 0x12345678);
+    args[3].Set("t", (uint64_t) 1000);
+    Consume(args, 4);
+}
+
+static void LegacyLampReply(std::list<MsgArg>& stdArgs)
+{
+    size_t numArgs = stdArgs.size() + 1;
+    MsgArg* args = new MsgArg[numArgs];
+    args[0] = MsgArg("u", LSF_OK);
+    args[0].SetOwnershipFlags(MsgArg::OwnsData | MsgArg::OwnsArgs, true);
+    uint8_t index = 1;
+    while (stdArgs.size()) {
+        args[index] = stdArgs.front();
+        args[index].SetOwnershipFlags(MsgArg::OwnsData | MsgArg::OwnsArgs, true);
+        stdArgs.pop_front();
+        index++;
+    }
+    Consume(args, numArgs);
+    delete [] args;
+}
+
+static void LampReplyFromStack(std::list<MsgArg>& stdArgs)
+{
+    size_t numArgs = stdArgs.size() + 1;
+    MsgArg stackArgs[LAMP_REPLY_STACK_ARGS];
+    MsgArg* args = (numArgs <= LAMP_REPLY_STACK_ARGS) ? stackArgs : new MsgArg[numArgs];
+    args[0].Set("u", LSF_OK);
+    size_t index = 1;
+    for (std::list<MsgArg>::const_iterator it = stdArgs.begin(); it != stdArgs.end(); ++it, ++index) {
+        args[index] = *it;
+    }
+    stdArgs.clear();
+    Consume(args, numArgs);
+    if (args != stackArgs) {
+        delete [] args;
+    }
+}
+
+struct Result {
+    double allocationsPerMessage;
+    double nsPerMessage;
+};
+
+/*
+ * The reply arguments are queued outside of the measurement: both versions
+ * receive them the same way from the lamps
+ */
+static Result RunLampReplies(bool legacy, uint32_t messages)
+{
+    uint64_t elapsed = 0;
+    uint64_t allocated = 0;
+    std::list<MsgArg> stdArgs;
+
+    for (uint32_t i = 0; i < messages; i++) {
+        for (size_t j = 1; j < LAMP_REPLY_ARGS; j++) {
+            stdArgs.push_back(MsgArg("s", "0123456789abcdef"));
+        }
+
+        uint64_t before = allocations;
+        uint64_t start = lsf::GetTimestampInUs();
+        if (legacy) {
+            LegacyLampReply(stdArgs);
+        } else {
+            LampReplyFromStack(stdArgs);
+        }
+        elapsed += lsf::GetTimestampInUs() - start;
+        allocated += allocations - before;
+    }
+
+    Result result;
+    result.allocationsPerMessage = (double) allocated / messages;
+    result.nsPerMessage = elapsed * 1000.0 / messages;
+    return result;
+}
+
+typedef enum _Case {
+    CASE_LAMP_STATE,
+    CASE_ID_LIST,
+    CASE_BLOB,
+    CASE_LAST_VALUE
+} Case;
+
+static Result Run(Case which, bool legacy, uint32_t messages, const LampState& state, const LSFStringList& idList, const std::string& blob)
+{
+    uint64_t before = allocations;
+    uint64_t start = lsf::GetTimestampInUs();
+
+    for (uint32_t i = 0; i < messages; i++) {
+        switch (which) {
+        case CASE_LAMP_STATE:
+            if (legacy) {
+                LegacyLampState(state);
+            } else {
+                LampStateWithStorage(state);
+            }
+            break;
+
+        case CASE_ID_LIST:
+            if (legacy) {
+                LegacyIDList(idList);
+            } else {
+                IDListFromStack(idList);
+            }
+            break;
+
+        default:
+            if (legacy) {
+                LegacyBlob(blob);
+            } else {
+                BlobInPlace(blob);
+            }
+            break;
+        }
+    }
+
+    uint64_t elapsed = lsf::GetTimestampInUs() - start;
+    Result result;
+    result.allocationsPerMessage = (double) (allocations - before) / messages;
+    result.nsPerMessage = elapsed * 1000.0 / messages;
+    return result;
+}
+
+static void Print(const char* name, const Result& legacy, const Result& current)
+{
+    printf("%-24s %14.2f %12.1f %14.2f %12.1f\n", name,
+           legacy.allocationsPerMessage, legacy.nsPerMessage,
+           current.allocationsPerMessage, current.nsPerMessage);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t messages = (argc > 1) ? atoi(argv[1]) : 1000000;
+    uint32_t idsPerList = (argc > 2) ? atoi(argv[2]) : 20;
+
+    if (messages == 0) {
+        fprintf(stderr, "Usage: %s [messages] [idsPerList]\n", argv[0]);
+        return 1;
+    }
+
+    LampState state(true, 100, 200, 300, 400);
+    LSFStringList idList;
+    for (uint32_t i = 0; i < idsPerList; i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "%016x", i);
+        idList.push_back(id);
+    }
+    std::string blob(1024, 'x');
+
+    printf("%u messages, %u IDs per list\n", messages, idsPerList);
+    printf("%-24s %14s %12s %14s %12s\n", "message", "former allocs", "former ns", "current allocs", "current ns");
+
+    static const char* names[CASE_LAST_VALUE] = { "LampStateChanged", "ID list reply", "Blob update" };
+    for (uint32_t i = 0; i < CASE_LAST_VALUE; i++) {
+        Case which = static_cast<Case>(i);
+        Result legacy = Run(which, true, messages, state, idList, blob);
+        Result current = Run(which, false, messages, state, idList, blob);
+        Print(names[i], legacy, current);
+    }
+
+    Result legacy = RunLampReplies(true, messages);
+    Result current = RunLampReplies(false, messages);
+    Print("Lamp method reply", legacy, current);
+
+    printf("checksum %zu\n", checksum);
+    return 0;
+}
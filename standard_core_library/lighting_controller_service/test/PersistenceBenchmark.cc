@@ -0,0 +1,194 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Write amplification benchmark for the persistent store. \n
+ * Replays a script that creates a number of Lamp Groups one after the other and
+ * reports the number of commits, fsyncs and bytes written to flash for:
+ *   - the original path: a full in-place rewrite of the store per change
+ *   - a full snapshot (temp file, fsync, rename, directory fsync) per change
+ *   - a journal append per change
+ *   - a journal append per debounce window
+ * Write amplification is the number of bytes written divided by the size of the
+ * serialized entities that changed.
+ *
+ * Usage: persistence_benchmark [numChanges] [changeIntervalMs] [debounceWindowMs] [directory]
+ */
+
+#include <StoreFile.h>
+#include <StoreJournal.h>
+#include <LSFTypes.h>
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace lsf;
+
+typedef struct _BenchmarkResult {
+    uint32_t commits;
+    uint32_t fsyncs;
+    uint64_t bytesWritten;
+    uint64_t elapsedUs;
+} BenchmarkResult;
+
+static std::string GetLampGroupString(uint32_t index)
+{
+    char id[32];
+    snprintf(id, sizeof(id), "LAMP_GROUP%08x", index);
+    std::ostringstream stream;
+    stream << "LampGroup " << id << " \"Benchmark Group " << index << "\"";
+    for (uint32_t i = 0; i < 4; i++) {
+        stream << " Lamp " << "LAMP" << ((index * 4) + i);
+    }
+    stream << " EndLampGroup\n";
+    return stream.str();
+}
+
+static size_t GetFileSize(const std::string& path)
+{
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0) ? st.st_size : 0;
+}
+
+static void PrintResult(const char* name, const BenchmarkResult& result, uint64_t logicalBytes)
+{
+    printf("%-28s commits=%-5u fsyncs=%-5u bytes=%-9llu amplification=%-8.1f time=%llu us\n", name, result.commits, result.fsyncs,
+           (unsigned long long) result.bytesWritten, logicalBytes ? ((double) result.bytesWritten / logicalBytes) : 0.0,
+           (unsigned long long) result.elapsedUs);
+}
+
+/*
+ * The path used before the binary store format: the whole store rewritten in place
+ */
+static BenchmarkResult RunInPlaceRewrite(const std::vector<std::string>& entities, const std::string& path)
+{
+    BenchmarkResult result = { 0, 0, 0, 0 };
+    std::string blob;
+    uint64_t start = lsf::GetTimestampInUs();
+    for (size_t i = 0; i < entities.size(); i++) {
+        blob += entities[i];
+        std::ostringstream stream;
+        stream << GetTimestampInMs() << std::endl;
+        stream << GetAdler32Checksum((const uint8_t*) blob.data(), blob.length()) << std::endl;
+        stream << blob;
+        std::string contents = stream.str();
+
+        std::ofstream fstream(path.c_str(), std::ios_base::out);
+        fstream << contents;
+        fstream.close();
+
+        result.commits++;
+        result.bytesWritten += contents.length();
+    }
+    result.elapsedUs = lsf::GetTimestampInUs() - start;
+    unlink(path.c_str());
+    return result;
+}
+
+static BenchmarkResult RunSnapshotPerChange(const std::vector<std::string>& entities, const std::string& path)
+{
+    BenchmarkResult result = { 0, 0, 0, 0 };
+    std::string blob;
+    uint64_t start = lsf::GetTimestampInUs();
+    for (size_t i = 0; i < entities.size(); i++) {
+        blob += entities[i];
+        StoreFile::Write(path, blob, GetAdler32Checksum((const uint8_t*) blob.data(), blob.length()), GetTimestampInMs());
+        result.commits++;
+        result.fsyncs += 2; /* the file, then its directory after the rename */
+        result.bytesWritten += GetFileSize(path);
+    }
+    result.elapsedUs = lsf::GetTimestampInUs() - start;
+    unlink(path.c_str());
+    return result;
+}
+
+static BenchmarkResult RunJournal(const std::vector<std::string>& entities, const std::string& path, uint32_t batchSize)
+{
+    BenchmarkResult result = { 0, 0, 0, 0 };
+    StoreJournal journal(path);
+    journal.Reset(0, 0);
+    result.fsyncs += 2;
+    result.bytesWritten += journal.GetLength();
+
+    std::string blob;
+    std::string batch;
+    uint32_t pending = 0;
+    uint64_t start = lsf::GetTimestampInUs();
+    for (size_t i = 0; i < entities.size(); i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "LAMP_GROUP%08x", (uint32_t) i);
+        blob += entities[i];
+        StoreJournal::EncodeRecord(batch, StoreJournal::RECORD_UPDATE, id, entities[i]);
+        pending++;
+
+        if ((pending == batchSize) || ((i + 1) == entities.size())) {
+            StoreJournal::EncodeCommit(batch, GetAdler32Checksum((const uint8_t*) blob.data(), blob.length()), GetTimestampInMs());
+            size_t before = journal.GetLength();
+            journal.Append(batch);
+            result.bytesWritten += journal.GetLength() - before;
+            result.commits++;
+            result.fsyncs++;
+            batch.clear();
+            pending = 0;
+        }
+    }
+    result.elapsedUs = lsf::GetTimestampInUs() - start;
+    unlink(path.c_str());
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t numChanges = (argc > 1) ? strtoul(argv[1], NULL, 10) : 200;
+    uint32_t changeInterval = (argc > 2) ? strtoul(argv[2], NULL, 10) : 5;
+    uint32_t debounceWindow = (argc > 3) ? strtoul(argv[3], NULL, 10) : 100;
+    std::string directory = (argc > 4) ? argv[4] : "/tmp";
+
+    /*
+     * Number of changes of the script that fall in one debounce window
+     */
+    uint32_t batchSize = 1;
+    if (changeInterval && (debounceWindow > changeInterval)) {
+        batchSize = debounceWindow / changeInterval;
+    } else if (!changeInterval) {
+        batchSize = numChanges;
+    }
+
+    std::vector<std::string> entities;
+    uint64_t logicalBytes = 0;
+    for (uint32_t i = 0; i < numChanges; i++) {
+        entities.push_back(GetLampGroupString(i));
+        logicalBytes += entities.back().length();
+    }
+
+    std::string storePath = directory + "/LampGroupsBenchmark.lsf";
+    std::string journalPath = storePath + ".journal";
+
+    printf("changes=%u interval=%u ms debounce=%u ms (%u changes per commit) logical bytes=%llu\n",
+           numChanges, changeInterval, debounceWindow, batchSize, (unsigned long long) logicalBytes);
+    PrintResult("in-place rewrite per change", RunInPlaceRewrite(entities, storePath), logicalBytes);
+    PrintResult("snapshot per change", RunSnapshotPerChange(entities, storePath), logicalBytes);
+    PrintResult("journal per change", RunJournal(entities, journalPath, 1), logicalBytes);
+    PrintResult("journal per debounce window", RunJournal(entities, journalPath, batchSize), logicalBytes);
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+
+/*
+ * Load-time benchmark for the persistent store formats. \n
+ * Generates a Presets store with a large number of entries, writes it in the legacy
+ * text format and in the binary format and reports the time it takes to validate
+ * and parse each of them.
+ *
+ * Usage: store_file_benchmark [numEntities] [iterations] [directory]
+ */
+
+#include <StoreFile.h>
+#include <FileParser.h>
+#include <LSFTypes.h>
+
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <sstream>
+#include <streambuf>
+
+using namespace lsf;
+
+static std::string GeneratePresets(uint32_t numEntities)
+{
+    std::ostringstream stream;
+    for (uint32_t i = 0; i < numEntities; i++) {
+        char id[32];
+        snprintf(id, sizeof(id), "PRESET%08x", i);
+        stream << "Preset " << id << " \"Benchmark Preset " << i << "\" "
+               << 0 << ' ' << (i & 1) << ' ' << (i * 7) << ' ' << (i * 11) << ' '
+               << (2700 + i) << ' ' << (i * 13) << '\n';
+    }
+    return stream.str();
+}
+
+static size_t ParsePresets(std::istream& stream)
+{
+    PresetMap presets;
+    while (!stream.eof()) {
+        std::string token = ParseString(stream);
+        if (token == "Preset") {
+            std::string presetId = ParseString(stream);
+            std::string presetName = ParseString(stream);
+            LampState state;
+            ParseLampState(stream, state);
+            presets[presetId] = std::make_pair(presetName, state);
+        }
+    }
+    return presets.size();
+}
+
+/*
+ * The load path used before the binary store format was introduced
+ */
+static size_t LoadLegacy(const std::string& path)
+{
+    std::ifstream stream(path.c_str());
+    uint64_t timestamp;
+    uint32_t checksum;
+    stream >> timestamp;
+    stream >> checksum;
+
+    std::stringbuf rest;
+    stream >> &rest;
+    std::string data = rest.str();
+    std::istringstream filestream;
+    filestream.str(data);
+
+    if (GetAdler32Checksum((const uint8_t*) data.c_str(), data.length()) != checksum) {
+        return 0;
+    }
+
+    return ParsePresets(filestream);
+}
+
+static size_t LoadBinary(const std::string& path)
+{
+    StoreFile file;
+    if (!file.Open(path) || !file.IsValid()) {
+        return 0;
+    }
+
+    MemoryStreamBuf buffer(file.GetPayload(), file.GetPayloadLength());
+    std::istream stream(&buffer);
+    return ParsePresets(stream);
+}
+
+static size_t GetFileSize(const std::string& path)
+{
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0) ? st.st_size : 0;
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t numEntities = (argc > 1) ? strtoul(argv[1], NULL, 10) : 10000;
+    uint32_t iterations = (argc > 2) ? strtoul(argv[2], NULL, 10) : 10;
+    std::string directory = (argc > 3) ? argv[3] : "/tmp";
+
+    if (iterations == 0) {
+        iterations = 1;
+    }
+
+    std::string legacyPath = directory + "/PresetsBenchmark.txt.lsf";
+    std::string binaryPath = directory + "/PresetsBenchmark.bin.lsf";
+
+    std::string data = GeneratePresets(numEntities);
+    uint32_t checksum = GetAdler32Checksum((const uint8_t*) data.c_str(), data.length());
+    uint64_t timestamp = GetTimestampInMs();
+
+    std::ofstream legacy(legacyPath.c_str(), std::ios_base::out);
+    legacy << timestamp << std::endl;
+    legacy << checksum << std::endl;
+    legacy << data;
+    legacy.close();
+
+    if (!StoreFile::Write(binaryPath, data, checksum, timestamp)) {
+        printf("Failed to write %s\n", binaryPath.c_str());
+        return 1;
+    }
+
+    uint64_t legacyTotal = 0;
+    uint64_t binaryTotal = 0;
+    size_t legacyCount = 0;
+    size_t binaryCount = 0;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        uint64_t start = lsf::GetTimestampInUs();
+        legacyCount = LoadLegacy(legacyPath);
+        legacyTotal += lsf::GetTimestampInUs() - start;
+
+        start = lsf::GetTimestampInUs();
+        binaryCount = LoadBinary(binaryPath);
+        binaryTotal += lsf::GetTimestampInUs() - start;
+    }
+
+    printf("entities=%u iterations=%u\n", numEntities, iterations);
+    printf("legacy text: size=%u bytes loaded=%u avg=%llu us\n", (uint32_t) GetFileSize(legacyPath), (uint32_t) legacyCount,
+           (unsigned long long) (legacyTotal / iterations));
+    printf("binary:      size=%u bytes loaded=%u avg=%llu us\n", (uint32_t) GetFileSize(binaryPath), (uint32_t) binaryCount,
+           (unsigned long long) (binaryTotal / iterations));
+
+    unlink(legacyPath.c_str());
+    unlink(binaryPath.c_str());
+
+    return ((legacyCount == numEntities) && (binaryCount == numEntities)) ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <ClientRateLimiter.h>
+
+#include <unistd.h>
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+
+using namespace lsf;
+
+/*
+ * A token every 100 ms, so that the tests tolerate a few ms between two calls
+ */
+static const uint32_t TEST_RATE_PER_SEC = 10;
+static const uint32_t TEST_BURST = 3;
+
+class ClientRateLimiterTest : public testing::Test {
+  public:
+    ClientRateLimiterTest() : limiter(4) { }
+
+    virtual void SetUp() {
+        limiter.SetLaneRate(METHOD_LANE_LAMP_CONTROL, TEST_RATE_PER_SEC, TEST_BURST);
+        limiter.SetLaneRate(METHOD_LANE_SCENE_APPLY, TEST_RATE_PER_SEC, TEST_BURST);
+        limiter.SetLaneRate(METHOD_LANE_CONFIG, 0, TEST_BURST);
+    }
+
+    uint32_t AdmitAll(const char* sender, MethodLane lane, uint32_t numCalls) {
+        uint32_t admitted = 0;
+        for (uint32_t i = 0; i < numCalls; i++) {
+            if (limiter.Admit(sender, lane)) {
+                admitted++;
+            }
+        }
+        return admitted;
+    }
+
+    ClientRateLimiter limiter;
+};
+
+TEST_F(ClientRateLimiterTest, Client_Rate_Limiter_Burst) {
+    EXPECT_EQ(TEST_BURST, AdmitAll(":app.1", METHOD_LANE_LAMP_CONTROL, TEST_BURST + 5));
+
+    ClientRateLimiter::ClientUsageMap usage;
+    limiter.GetClientUsage(usage);
+    ASSERT_EQ((size_t) 1, usage.size());
+    const ClientRateLimiter::ClientUsage& app = usage[":app.1"];
+    EXPECT_EQ(TEST_BURST, app.admitted[METHOD_LANE_LAMP_CONTROL]);
+    EXPECT_EQ((uint32_t) 5, app.rejected[METHOD_LANE_LAMP_CONTROL]);
+    EXPECT_EQ((uint32_t) 0, app.admitted[METHOD_LANE_SCENE_APPLY]);
+    EXPECT_NE((uint64_t) 0, app.firstCallTimestamp);
+    EXPECT_LE(app.firstCallTimestamp, app.lastCallTimestamp);
+}
+
+TEST_F(ClientRateLimiterTest, Client_Rate_Limiter_Token_Refill) {
+    EXPECT_EQ(TEST_BURST, AdmitAll(":app.1", METHOD_LANE_LAMP_CONTROL, TEST_BURST));
+    EXPECT_FALSE(limiter.Admit(":app.1", METHOD_LANE_LAMP_CONTROL));
+
+    /*
+     * One and a half tokens come back: one call, and the half token is kept
+     */
+    usleep(150 * 1000);
+    EXPECT_TRUE(limiter.Admit(":app.1", METHOD_LANE_LAMP_CONTROL));
+    EXPECT_FALSE(limiter.Admit(":app.1", METHOD_LANE_LAMP_CONTROL));
+    usleep(60 * 1000);
+    EXPECT_TRUE(limiter.Admit(":app.1", METHOD_LANE_LAMP_CONTROL));
+
+    /*
+     * The bucket refills up to the burst only
+     */
+    usleep(1000 * 1000);
+    EXPECT_EQ(TEST_BURST, AdmitAll(":app.1", METHOD_LANE_LAMP_CONTROL, TEST_BURST + 2));
+}
+
+TEST_F(ClientRateLimiterTest, Client_Rate_Limiter_Buckets_Per_Client_And_Lane) {
+    EXPECT_EQ(TEST_BURST, AdmitAll(":app.1", METHOD_LANE_LAMP_CONTROL, TEST_BURST + 1));
+
+    /*
+     * Neither another lane of the app nor another app is held back
+     */
+    EXPECT_EQ(TEST_BURST, AdmitAll(":app.1", METHOD_LANE_SCENE_APPLY, TEST_BURST));
+    EXPECT_EQ(TEST_BURST, AdmitAll(":app.2", METHOD_LANE_LAMP_CONTROL, TEST_BURST));
+
+    /*
+     * A lane without a rate is not limited
+     */
+    EXPECT_EQ((uint32_t) 100, AdmitAll(":app.1", METHOD_LANE_CONFIG, 100));
+}
+
+TEST_F(ClientRateLimiterTest, Client_Rate_Limiter_Unknown_Caller) {
+    EXPECT_EQ((uint32_t) 10, AdmitAll(NULL, METHOD_LANE_LAMP_CONTROL, 10));
+    EXPECT_TRUE(limiter.Admit(":app.1", METHOD_LANE_LAST_VALUE));
+
+    ClientRateLimiter::ClientUsageMap usage;
+    limiter.GetClientUsage(usage);
+    EXPECT_TRUE(usage.empty());
+}
+
+TEST_F(ClientRateLimiterTest, Client_Rate_Limiter_Remove_Client) {
+    EXPECT_EQ(TEST_BURST, AdmitAll(":app.1", METHOD_LANE_LAMP_CONTROL, TEST_BURST + 1));
+
+    /*
+     * An app that comes back starts with full buckets
+     */
+    limiter.RemoveClient(":app.1");
+    EXPECT_EQ(TEST_BURST, AdmitAll(":app.1", METHOD_LANE_LAMP_CONTROL, TEST_BURST + 1));
+
+    limiter.Reset();
+    ClientRateLimiter::ClientUsageMap usage;
+    limiter.GetClientUsage(usage);
+    EXPECT_TRUE(usage.empty());
+}
+
+TEST_F(ClientRateLimiterTest, Client_Rate_Limiter_Forgets_Least_Recent_Client) {
+    ClientRateLimiter small(2);
+    small.SetLaneRate(METHOD_LANE_LAMP_CONTROL, TEST_RATE_PER_SEC, TEST_BURST);
+
+    EXPECT_TRUE(small.Admit(":app.1", METHOD_LANE_LAMP_CONTROL));
+    usleep(5 * 1000);
+    EXPECT_TRUE(small.Admit(":app.2", METHOD_LANE_LAMP_CONTROL));
+    usleep(5 * 1000);
+    EXPECT_TRUE(small.Admit(":app.1", METHOD_LANE_LAMP_CONTROL));
+    usleep(5 * 1000);
+    EXPECT_TRUE(small.Admit(":app.3", METHOD_LANE_LAMP_CONTROL));
+
+    ClientRateLimiter::ClientUsageMap usage;
+    small.GetClientUsage(usage);
+    ASSERT_EQ((size_t) 2, usage.size());
+    EXPECT_TRUE(usage.find(":app.1") != usage.end());
+    EXPECT_TRUE(usage.find(":app.2") == usage.end());
+    EXPECT_TRUE(usage.find(":app.3") != usage.end());
+    EXPECT_EQ((uint32_t) 2, usage[":app.1"].admitted[METHOD_LANE_LAMP_CONTROL]);
+}
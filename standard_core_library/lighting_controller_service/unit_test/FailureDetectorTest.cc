@@ -0,0 +1,150 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <FailureDetector.h>
+
+#include <math.h>
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+
+using namespace lsf;
+
+static const uint32_t TEST_INTERVAL_MS = 100;
+static const uint32_t TEST_MISSED_THRESHOLD = 3;
+static const double TEST_PHI_THRESHOLD = 8.0;
+
+/*
+ * The detector takes 0 as no heartbeat, so the test clock starts later
+ */
+static const uint64_t TEST_START = 1000;
+
+/**
+ * Send heartbeats at a fixed interval
+ * @return time of the last heartbeat
+ */
+static uint64_t SendHeartbeats(FailureDetector& detector, uint64_t start, uint32_t interval, uint32_t count)
+{
+    uint64_t now = start;
+    for (uint32_t i = 0; i < count; i++) {
+        detector.Heartbeat(now);
+        now += interval;
+    }
+    return now - interval;
+}
+
+TEST(FailureDetectorTest, Failure_Detector_Not_Armed) {
+    FailureDetector detector(TEST_INTERVAL_MS, TEST_MISSED_THRESHOLD);
+    EXPECT_FALSE(detector.IsArmed());
+    EXPECT_FALSE(detector.IsSuspected(TEST_START + 1000000));
+    EXPECT_EQ((uint64_t) 0, detector.GetElapsed(TEST_START));
+    EXPECT_EQ(0.0, detector.GetPhi(TEST_START));
+
+    /*
+     * A controller that stopped sending heartbeats is not suspected after a Reset
+     */
+    detector.Heartbeat(TEST_START);
+    EXPECT_TRUE(detector.IsArmed());
+    detector.Reset();
+    EXPECT_FALSE(detector.IsArmed());
+    EXPECT_FALSE(detector.IsSuspected(TEST_START + 1000000));
+}
+
+TEST(FailureDetectorTest, Failure_Detector_Missed_Threshold) {
+    FailureDetector detector(TEST_INTERVAL_MS, TEST_MISSED_THRESHOLD);
+    uint64_t last = SendHeartbeats(detector, TEST_START, TEST_INTERVAL_MS, 5);
+
+    uint64_t timeout = TEST_INTERVAL_MS * TEST_MISSED_THRESHOLD;
+    EXPECT_EQ(timeout, detector.GetElapsed(last + timeout));
+    EXPECT_FALSE(detector.IsSuspected(last + timeout));
+    EXPECT_TRUE(detector.IsSuspected(last + timeout + 1));
+
+    /*
+     * A late heartbeat clears the suspicion
+     */
+    detector.Heartbeat(last + timeout + 50);
+    EXPECT_FALSE(detector.IsSuspected(last + timeout + 51));
+}
+
+TEST(FailureDetectorTest, Failure_Detector_Phi_Before_Samples) {
+    FailureDetector detector(TEST_INTERVAL_MS, TEST_MISSED_THRESHOLD, TEST_PHI_THRESHOLD);
+    detector.Heartbeat(TEST_START);
+
+    /*
+     * Without intervals yet, the mean is the configured interval
+     */
+    EXPECT_NEAR(M_LOG10E, detector.GetPhi(TEST_START + TEST_INTERVAL_MS), 1e-9);
+    EXPECT_NEAR(2 * M_LOG10E, detector.GetPhi(TEST_START + 2 * TEST_INTERVAL_MS), 1e-9);
+}
+
+TEST(FailureDetectorTest, Failure_Detector_Phi_Threshold) {
+    FailureDetector detector(TEST_INTERVAL_MS, TEST_MISSED_THRESHOLD, TEST_PHI_THRESHOLD);
+    uint64_t last = SendHeartbeats(detector, TEST_START, TEST_INTERVAL_MS, 10);
+
+    /*
+     * phi = elapsed / mean * log10(e) goes above 8 after 1842 ms with a mean of 100 ms
+     */
+    uint64_t timeout = static_cast<uint64_t>(TEST_PHI_THRESHOLD / M_LOG10E * TEST_INTERVAL_MS);
+    EXPECT_EQ((uint64_t) 1842, timeout);
+    EXPECT_FALSE(detector.IsSuspected(last + timeout));
+    EXPECT_TRUE(detector.IsSuspected(last + timeout + 1));
+
+    /*
+     * The missed threshold does not apply when phi is used
+     */
+    EXPECT_FALSE(detector.IsSuspected(last + TEST_INTERVAL_MS * TEST_MISSED_THRESHOLD + 1));
+}
+
+TEST(FailureDetectorTest, Failure_Detector_Phi_Adapts_To_Intervals) {
+    FailureDetector detector(TEST_INTERVAL_MS, TEST_MISSED_THRESHOLD, TEST_PHI_THRESHOLD);
+    uint64_t last = SendHeartbeats(detector, TEST_START, 2 * TEST_INTERVAL_MS, 10);
+
+    /*
+     * Heartbeats twice as far apart double the time to suspicion
+     */
+    EXPECT_FALSE(detector.IsSuspected(last + 3684));
+    EXPECT_TRUE(detector.IsSuspected(last + 3685));
+}
+
+TEST(FailureDetectorTest, Failure_Detector_Sample_Window) {
+    FailureDetector detector(TEST_INTERVAL_MS, TEST_MISSED_THRESHOLD, TEST_PHI_THRESHOLD);
+    uint64_t last = SendHeartbeats(detector, TEST_START, TEST_INTERVAL_MS, FailureDetector::SAMPLE_WINDOW + 1);
+
+    /*
+     * A full window of slower intervals replaces all the older ones
+     */
+    last = SendHeartbeats(detector, last + 3 * TEST_INTERVAL_MS, 3 * TEST_INTERVAL_MS, FailureDetector::SAMPLE_WINDOW);
+    EXPECT_NEAR(M_LOG10E, detector.GetPhi(last + 3 * TEST_INTERVAL_MS), 1e-9);
+
+    /*
+     * Half a window of faster intervals brings the mean halfway back
+     */
+    last = SendHeartbeats(detector, last + TEST_INTERVAL_MS, TEST_INTERVAL_MS, FailureDetector::SAMPLE_WINDOW / 2);
+    EXPECT_NEAR(M_LOG10E, detector.GetPhi(last + 2 * TEST_INTERVAL_MS), 1e-9);
+}
+
+TEST(FailureDetectorTest, Failure_Detector_Clock_Going_Back) {
+    FailureDetector detector(TEST_INTERVAL_MS, TEST_MISSED_THRESHOLD, TEST_PHI_THRESHOLD);
+    uint64_t last = SendHeartbeats(detector, TEST_START, TEST_INTERVAL_MS, 10);
+
+    EXPECT_EQ((uint64_t) 0, detector.GetElapsed(last - 50));
+    EXPECT_FALSE(detector.IsSuspected(last - 50));
+
+    /*
+     * A heartbeat from the past adds no interval but restarts the wait
+     */
+    detector.Heartbeat(last - 50);
+    EXPECT_NEAR(M_LOG10E, detector.GetPhi(last - 50 + TEST_INTERVAL_MS), 1e-9);
+}
@@ -0,0 +1,142 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <MethodDispatchTable.h>
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+
+using namespace lsf;
+
+/**
+ * Stands in for an interface member: the table only uses its address
+ */
+typedef struct _TestMember {
+    int id;
+} TestMember;
+
+/**
+ * Counts the handlers deleted by the table
+ */
+class TestHandler {
+  public:
+    TestHandler(int id, int& numDeleted) : id(id), numDeleted(numDeleted) { }
+    ~TestHandler() { numDeleted++; }
+    int id;
+  private:
+    int& numDeleted;
+};
+
+typedef MethodDispatchTable<const TestMember*, TestHandler> TestDispatchTable;
+
+class MethodDispatchTableTest : public testing::Test {
+  public:
+    MethodDispatchTableTest() : numDeleted(0) { }
+
+    virtual void SetUp() {
+        for (int i = 0; i < NUM_MEMBERS; i++) {
+            members[i].id = i;
+        }
+    }
+
+    static const int NUM_MEMBERS = 200;
+
+    TestMember members[NUM_MEMBERS];
+    int numDeleted;
+};
+
+TEST_F(MethodDispatchTableTest, Method_Dispatch_Table_Lookup) {
+    TestDispatchTable table;
+    for (int i = 0; i < NUM_MEMBERS; i++) {
+        ASSERT_TRUE(table.Add(&members[i], new TestHandler(i, numDeleted)));
+    }
+    EXPECT_EQ((size_t) NUM_MEMBERS, table.Size());
+
+    /*
+     * Nothing is found until the table is sealed
+     */
+    EXPECT_FALSE(table.IsSealed());
+    EXPECT_TRUE(NULL == table.Find(&members[0]));
+
+    table.Seal();
+    EXPECT_TRUE(table.IsSealed());
+
+    /*
+     * Adjacent members differ in their low bits only, so they also exercise the probing
+     */
+    for (int i = 0; i < NUM_MEMBERS; i++) {
+        TestHandler* handler = table.Find(&members[i]);
+        ASSERT_TRUE(NULL != handler);
+        EXPECT_EQ(i, handler->id);
+        EXPECT_EQ(&members[i], table.GetMember(i));
+    }
+
+    TestMember unknown;
+    EXPECT_TRUE(NULL == table.Find(&unknown));
+    EXPECT_TRUE(NULL == table.Find(NULL));
+}
+
+TEST_F(MethodDispatchTableTest, Method_Dispatch_Table_Empty) {
+    TestDispatchTable table;
+    table.Seal();
+    EXPECT_TRUE(table.IsSealed());
+    EXPECT_EQ((size_t) 0, table.Size());
+    EXPECT_TRUE(NULL == table.Find(&members[0]));
+}
+
+TEST_F(MethodDispatchTableTest, Method_Dispatch_Table_Replace_Handler) {
+    TestDispatchTable table;
+    ASSERT_TRUE(table.Add(&members[0], new TestHandler(1, numDeleted)));
+    ASSERT_TRUE(table.Add(&members[0], new TestHandler(2, numDeleted)));
+    EXPECT_EQ(1, numDeleted);
+    EXPECT_EQ((size_t) 1, table.Size());
+
+    table.Seal();
+    ASSERT_TRUE(NULL != table.Find(&members[0]));
+    EXPECT_EQ(2, table.Find(&members[0])->id);
+}
+
+TEST_F(MethodDispatchTableTest, Method_Dispatch_Table_Sealed_Rejects_Add) {
+    TestDispatchTable table;
+    ASSERT_TRUE(table.Add(&members[0], new TestHandler(0, numDeleted)));
+    table.Seal();
+
+    /*
+     * The table takes ownership of the handler it turns away
+     */
+    EXPECT_FALSE(table.Add(&members[1], new TestHandler(1, numDeleted)));
+    EXPECT_EQ(1, numDeleted);
+    EXPECT_EQ((size_t) 1, table.Size());
+    EXPECT_TRUE(NULL == table.Find(&members[1]));
+
+    /*
+     * Sealing again keeps the table as it is
+     */
+    table.Seal();
+    ASSERT_TRUE(NULL != table.Find(&members[0]));
+    EXPECT_EQ(0, table.Find(&members[0])->id);
+}
+
+TEST_F(MethodDispatchTableTest, Method_Dispatch_Table_Owns_Handlers) {
+    {
+        TestDispatchTable table;
+        for (int i = 0; i < 10; i++) {
+            table.Add(&members[i], new TestHandler(i, numDeleted));
+        }
+        table.Seal();
+        EXPECT_EQ(0, numDeleted);
+    }
+    EXPECT_EQ(10, numDeleted);
+}
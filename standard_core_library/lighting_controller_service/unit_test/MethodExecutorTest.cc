@@ -0,0 +1,279 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <MethodExecutor.h>
+#include <Mutex.h>
+#include <Condition.h>
+
+#include <alljoyn/BusAttachment.h>
+#include <alljoyn/Message.h>
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+
+using namespace ajn;
+using namespace lsf;
+
+/*
+ * Longest time a test waits for the workers, in ms
+ */
+static const uint32_t WAIT_TIMEOUT_MS = 5000;
+
+/**
+ * Records the calls it handles and rejects. The handlers of a test share a
+ * gate that the calls block on until the test opens it
+ */
+class CallLog {
+  public:
+    CallLog() : lock("CallLog.lock"), open(false), running(0) { }
+
+    void Open(void) {
+        lock.Lock();
+        open = true;
+        condition.Broadcast();
+        lock.Unlock();
+    }
+
+    void Enter(int call) {
+        lock.Lock();
+        started.push_back(call);
+        running++;
+        condition.Broadcast();
+        while (!open) {
+            condition.Wait(lock);
+        }
+        running--;
+        handled.push_back(call);
+        condition.Broadcast();
+        lock.Unlock();
+    }
+
+    void Reject(int call) {
+        lock.Lock();
+        rejected.push_back(call);
+        lock.Unlock();
+    }
+
+    bool WaitForRunning(uint32_t numRunning) {
+        lock.Lock();
+        bool ok = true;
+        while (ok && (running != numRunning)) {
+            ok = condition.TimedWait(lock, WAIT_TIMEOUT_MS);
+        }
+        lock.Unlock();
+        return ok;
+    }
+
+    bool WaitForHandled(size_t numHandled) {
+        lock.Lock();
+        bool ok = true;
+        while (ok && (handled.size() != numHandled)) {
+            ok = condition.TimedWait(lock, WAIT_TIMEOUT_MS);
+        }
+        lock.Unlock();
+        return ok;
+    }
+
+    std::vector<int> GetStarted(void) {
+        lock.Lock();
+        std::vector<int> calls = started;
+        lock.Unlock();
+        return calls;
+    }
+
+    std::vector<int> GetRejected(void) {
+        lock.Lock();
+        std::vector<int> calls = rejected;
+        lock.Unlock();
+        return calls;
+    }
+
+  private:
+    Mutex lock;
+    Condition condition;
+    bool open;
+    uint32_t running;
+    std::vector<int> started;
+    std::vector<int> handled;
+    std::vector<int> rejected;
+};
+
+class TestCallHandler : public MethodExecutor::Handler {
+  public:
+    TestCallHandler(CallLog& log, int call) : log(log), call(call) { }
+
+    virtual void Handle(Message& msg) {
+        log.Enter(call);
+    }
+
+    virtual void Reject(Message& msg) {
+        log.Reject(call);
+    }
+
+  private:
+    CallLog& log;
+    int call;
+};
+
+class MethodExecutorTest : public testing::Test {
+  public:
+    BusAttachment bus;
+
+    MethodExecutorTest() : bus("LSFServiceUnitTest", true), msg(bus) { }
+
+    virtual void TearDown() {
+        for (std::vector<TestCallHandler*>::iterator it = handlers.begin(); it != handlers.end(); ++it) {
+            delete *it;
+        }
+        handlers.clear();
+    }
+
+    bool Submit(MethodExecutor& executor, MethodLane lane, int call) {
+        TestCallHandler* handler = new TestCallHandler(log, call);
+        handlers.push_back(handler);
+        return executor.Submit(lane, handler, msg);
+    }
+
+    Message msg;
+    CallLog log;
+    std::vector<TestCallHandler*> handlers;
+};
+
+TEST_F(MethodExecutorTest, Method_Executor_Lane_Saturation) {
+    MethodExecutor executor(1);
+    executor.SetLaneLimits(METHOD_LANE_CONFIG, 1, 2);
+    ASSERT_EQ(ER_OK, executor.Start());
+
+    ASSERT_TRUE(Submit(executor, METHOD_LANE_CONFIG, 1));
+    ASSERT_TRUE(log.WaitForRunning(1));
+
+    /*
+     * The worker is busy: two calls fill the queue of the lane and the next one is turned away
+     */
+    EXPECT_TRUE(Submit(executor, METHOD_LANE_CONFIG, 2));
+    EXPECT_TRUE(Submit(executor, METHOD_LANE_CONFIG, 3));
+    EXPECT_FALSE(Submit(executor, METHOD_LANE_CONFIG, 4));
+
+    /*
+     * A full lane does not fill the queues of the other lanes
+     */
+    EXPECT_TRUE(Submit(executor, METHOD_LANE_LAMP_CONTROL, 5));
+
+    MethodExecutor::LaneMetrics metrics;
+    executor.GetLaneMetrics(METHOD_LANE_CONFIG, metrics);
+    EXPECT_EQ((uint32_t) 2, metrics.queueDepth);
+    EXPECT_EQ((uint32_t) 2, metrics.peakQueueDepth);
+    EXPECT_EQ((uint32_t) 1, metrics.running);
+    EXPECT_EQ((uint32_t) 3, metrics.submitted);
+    EXPECT_EQ((uint32_t) 1, metrics.rejected);
+
+    log.Open();
+    ASSERT_TRUE(log.WaitForHandled(4));
+
+    /*
+     * The lamp control call runs before the config calls that were queued first
+     */
+    std::vector<int> started = log.GetStarted();
+    ASSERT_EQ((size_t) 4, started.size());
+    EXPECT_EQ(1, started[0]);
+    EXPECT_EQ(5, started[1]);
+    EXPECT_EQ(2, started[2]);
+    EXPECT_EQ(3, started[3]);
+
+    executor.Stop();
+    executor.Join();
+
+    executor.GetLaneMetrics(METHOD_LANE_CONFIG, metrics);
+    EXPECT_EQ((uint32_t) 0, metrics.queueDepth);
+    EXPECT_EQ((uint32_t) 3, metrics.completed);
+    EXPECT_TRUE(log.GetRejected().empty());
+}
+
+TEST_F(MethodExecutorTest, Method_Executor_Lane_Concurrency) {
+    MethodExecutor executor(3);
+    executor.SetLaneLimits(METHOD_LANE_SCENE_APPLY, 1, 4);
+    ASSERT_EQ(ER_OK, executor.Start());
+
+    ASSERT_TRUE(Submit(executor, METHOD_LANE_SCENE_APPLY, 1));
+    ASSERT_TRUE(Submit(executor, METHOD_LANE_SCENE_APPLY, 2));
+    ASSERT_TRUE(Submit(executor, METHOD_LANE_CONFIG, 3));
+    ASSERT_TRUE(log.WaitForRunning(2));
+
+    /*
+     * The second scene call waits for the first one although a worker is free
+     */
+    MethodExecutor::LaneMetrics metrics;
+    executor.GetLaneMetrics(METHOD_LANE_SCENE_APPLY, metrics);
+    EXPECT_EQ((uint32_t) 1, metrics.running);
+    EXPECT_EQ((uint32_t) 1, metrics.queueDepth);
+
+    log.Open();
+    ASSERT_TRUE(log.WaitForHandled(3));
+
+    executor.Stop();
+    executor.Join();
+}
+
+TEST_F(MethodExecutorTest, Method_Executor_Stop_Rejects_Queued_Calls) {
+    MethodExecutor executor(1);
+    ASSERT_EQ(ER_OK, executor.Start());
+
+    ASSERT_TRUE(Submit(executor, METHOD_LANE_CONFIG, 1));
+    ASSERT_TRUE(log.WaitForRunning(1));
+    ASSERT_TRUE(Submit(executor, METHOD_LANE_CONFIG, 2));
+    ASSERT_TRUE(Submit(executor, METHOD_LANE_LAMP_CONTROL, 3));
+
+    /*
+     * The queued calls are rejected on this thread; the running one completes
+     */
+    executor.Stop();
+    std::vector<int> rejected = log.GetRejected();
+    ASSERT_EQ((size_t) 2, rejected.size());
+    EXPECT_EQ(3, rejected[0]);
+    EXPECT_EQ(2, rejected[1]);
+
+    EXPECT_FALSE(Submit(executor, METHOD_LANE_CONFIG, 4));
+
+    log.Open();
+    ASSERT_TRUE(log.WaitForHandled(1));
+    executor.Join();
+
+    MethodExecutor::LaneMetrics metrics;
+    executor.GetLaneMetrics(METHOD_LANE_CONFIG, metrics);
+    EXPECT_EQ((uint32_t) 0, metrics.queueDepth);
+    EXPECT_EQ((uint32_t) 1, metrics.completed);
+    EXPECT_EQ((uint32_t) 2, metrics.rejected);
+    EXPECT_EQ((size_t) 1, log.GetStarted().size());
+}
+
+TEST_F(MethodExecutorTest, Method_Executor_Restart) {
+    MethodExecutor executor(2);
+    ASSERT_EQ(ER_OK, executor.Start());
+    executor.Stop();
+    executor.Join();
+
+    /*
+     * Start resets the metrics
+     */
+    ASSERT_EQ(ER_OK, executor.Start());
+    log.Open();
+    ASSERT_TRUE(Submit(executor, METHOD_LANE_CONFIG, 1));
+    ASSERT_TRUE(log.WaitForHandled(1));
+
+    MethodExecutor::LaneMetrics metrics;
+    executor.GetLaneMetrics(METHOD_LANE_CONFIG, metrics);
+    EXPECT_EQ((uint32_t) 1, metrics.submitted);
+    EXPECT_EQ((uint32_t) 0, metrics.rejected);
+}
@@ -0,0 +1,216 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <StoreHashTree.h>
+
+#include <stdio.h>
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+
+using namespace lsf;
+
+static std::string EntityId(uint32_t index)
+{
+    char id[32];
+    snprintf(id, sizeof(id), "preset%u", index);
+    return id;
+}
+
+static std::string EntityData(uint32_t index)
+{
+    char data[32];
+    snprintf(data, sizeof(data), "on %u", index * 7);
+    return data;
+}
+
+static void BuildTree(StoreHashTree& tree, uint32_t numEntities)
+{
+    tree.Reset();
+    for (uint32_t i = 0; i < numEntities; i++) {
+        tree.Update(EntityId(i), EntityData(i));
+    }
+}
+
+TEST(StoreHashTreeTest, Store_Hash_Tree_Empty) {
+    StoreHashTree tree;
+    EXPECT_FALSE(tree.IsBuilt());
+    tree.Reset();
+    EXPECT_TRUE(tree.IsBuilt());
+    EXPECT_EQ((uint64_t) 0, tree.GetRootHash());
+    EXPECT_EQ((uint32_t) 0, tree.GetFoldedRootHash());
+}
+
+TEST(StoreHashTreeTest, Store_Hash_Tree_Root_Folding) {
+    StoreHashTree tree;
+    tree.Reset();
+    tree.Update("preset1", "on 100");
+
+    uint64_t root = StoreHashTree::GetEntityHash("preset1", "on 100");
+    EXPECT_EQ(root, tree.GetRootHash());
+    EXPECT_EQ(static_cast<uint32_t>(root ^ (root >> 32)), tree.GetFoldedRootHash());
+
+    /*
+     * The root is the sum of the hashes of the entities
+     */
+    tree.Update("preset2", "off");
+    root += StoreHashTree::GetEntityHash("preset2", "off");
+    EXPECT_EQ(root, tree.GetRootHash());
+    EXPECT_EQ(static_cast<uint32_t>(root ^ (root >> 32)), tree.GetFoldedRootHash());
+}
+
+TEST(StoreHashTreeTest, Store_Hash_Tree_Root_Independent_Of_Order) {
+    StoreHashTree forward;
+    BuildTree(forward, 100);
+
+    StoreHashTree backward;
+    backward.Reset();
+    for (uint32_t i = 100; i > 0; i--) {
+        backward.Update(EntityId(i - 1), EntityData(i - 1));
+    }
+
+    EXPECT_NE((uint64_t) 0, forward.GetRootHash());
+    EXPECT_EQ(forward.GetRootHash(), backward.GetRootHash());
+    EXPECT_EQ(forward.GetFoldedRootHash(), backward.GetFoldedRootHash());
+}
+
+TEST(StoreHashTreeTest, Store_Hash_Tree_Update_And_Remove) {
+    StoreHashTree tree;
+    BuildTree(tree, 10);
+    uint64_t root = tree.GetRootHash();
+
+    tree.Update(EntityId(3), "changed");
+    EXPECT_NE(root, tree.GetRootHash());
+    tree.Update(EntityId(3), EntityData(3));
+    EXPECT_EQ(root, tree.GetRootHash());
+
+    tree.Update("extra", "data");
+    EXPECT_NE(root, tree.GetRootHash());
+    tree.Remove("extra");
+    EXPECT_EQ(root, tree.GetRootHash());
+
+    /*
+     * Unknown IDs are ignored
+     */
+    tree.Remove("unknown");
+    EXPECT_EQ(root, tree.GetRootHash());
+
+    for (uint32_t i = 0; i < 10; i++) {
+        tree.Remove(EntityId(i));
+    }
+    EXPECT_EQ((uint64_t) 0, tree.GetRootHash());
+}
+
+TEST(StoreHashTreeTest, Store_Hash_Tree_Ignores_Changes_While_Unbuilt) {
+    StoreHashTree tree;
+    BuildTree(tree, 10);
+    tree.Invalidate();
+    EXPECT_FALSE(tree.IsBuilt());
+    EXPECT_EQ((uint64_t) 0, tree.GetRootHash());
+
+    tree.Update("preset1", "on 100");
+    EXPECT_EQ((uint64_t) 0, tree.GetRootHash());
+}
+
+TEST(StoreHashTreeTest, Store_Hash_Tree_Levels_Sum_To_Root) {
+    StoreHashTree tree;
+    BuildTree(tree, 500);
+
+    std::vector<uint32_t> nodes(1, 0);
+    std::vector<uint64_t> hashes;
+    for (uint32_t level = 0; level < StoreHashTree::DEPTH; level++) {
+        tree.GetChildHashes(level, nodes, hashes);
+        ASSERT_EQ(nodes.size() * StoreHashTree::FANOUT, hashes.size());
+
+        uint64_t sum = 0;
+        for (size_t i = 0; i < hashes.size(); i++) {
+            sum += hashes[i];
+        }
+        EXPECT_EQ(tree.GetRootHash(), sum);
+
+        std::vector<uint32_t> children;
+        for (size_t node = 0; node < nodes.size(); node++) {
+            for (uint32_t child = 0; child < StoreHashTree::FANOUT; child++) {
+                children.push_back((nodes[node] * StoreHashTree::FANOUT) + child);
+            }
+        }
+        nodes.swap(children);
+    }
+    EXPECT_EQ(StoreHashTree::NUM_BUCKETS, nodes.size());
+}
+
+TEST(StoreHashTreeTest, Store_Hash_Tree_Finds_Differing_Entity) {
+    StoreHashTree mine;
+    BuildTree(mine, 200);
+    StoreHashTree theirs;
+    BuildTree(theirs, 200);
+    theirs.Update(EntityId(42), "changed");
+    ASSERT_NE(mine.GetRootHash(), theirs.GetRootHash());
+
+    /*
+     * Descend into the differing nodes only, as two Controller Services do
+     */
+    std::vector<uint32_t> nodes(1, 0);
+    for (uint32_t level = 0; level < StoreHashTree::DEPTH; level++) {
+        std::vector<uint64_t> myHashes;
+        std::vector<uint64_t> theirHashes;
+        mine.GetChildHashes(level, nodes, myHashes);
+        theirs.GetChildHashes(level, nodes, theirHashes);
+
+        std::vector<uint32_t> differing;
+        for (size_t i = 0; i < myHashes.size(); i++) {
+            if (myHashes[i] != theirHashes[i]) {
+                differing.push_back((nodes[i / StoreHashTree::FANOUT] * StoreHashTree::FANOUT) + (i % StoreHashTree::FANOUT));
+            }
+        }
+        ASSERT_EQ((size_t) 1, differing.size());
+        nodes.swap(differing);
+    }
+
+    EXPECT_EQ(StoreHashTree::GetBucket(EntityId(42)), nodes[0]);
+
+    StoreEntityHashList myEntities;
+    StoreEntityHashList theirEntities;
+    mine.GetEntityHashes(nodes, myEntities);
+    theirs.GetEntityHashes(nodes, theirEntities);
+    ASSERT_EQ(myEntities.size(), theirEntities.size());
+
+    uint32_t numDiffering = 0;
+    for (StoreEntityHashList::const_iterator m = myEntities.begin(), t = theirEntities.begin(); m != myEntities.end(); ++m, ++t) {
+        EXPECT_EQ(m->first, t->first);
+        if (m->second != t->second) {
+            EXPECT_EQ(EntityId(42), m->first);
+            numDiffering++;
+        }
+    }
+    EXPECT_EQ((uint32_t) 1, numDiffering);
+}
+
+TEST(StoreHashTreeTest, Store_Hash_Tree_Out_Of_Range_Nodes) {
+    StoreHashTree tree;
+    BuildTree(tree, 10);
+
+    std::vector<uint32_t> nodes(1, StoreHashTree::NUM_BUCKETS);
+    std::vector<uint64_t> hashes;
+    tree.GetChildHashes(StoreHashTree::DEPTH, nodes, hashes);
+    ASSERT_EQ((size_t) StoreHashTree::FANOUT, hashes.size());
+    for (size_t i = 0; i < hashes.size(); i++) {
+        EXPECT_EQ((uint64_t) 0, hashes[i]);
+    }
+
+    StoreEntityHashList entities;
+    tree.GetEntityHashes(nodes, entities);
+    EXPECT_TRUE(entities.empty());
+}
@@ -0,0 +1,221 @@
+/******************************************************************************
+ * Copyright AllSeen Alliance. All rights reserved.
+ *
+ *    Permission to use, copy, modify, and/or distribute this software for any
+ *    purpose with or without fee is hereby granted, provided that the above
+ *    copyright notice and this permission notice appear in all copies.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ ******************************************************************************/
+#include <StoreJournal.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+
+/* Header files included for Google Test Framework */
+#include <gtest/gtest.h>
+
+using namespace lsf;
+
+static const uint32_t BASE_CHECKSUM = 0x12345678;
+static const uint64_t BASE_TIMESTAMP = 1000;
+
+class StoreJournalTest : public testing::Test {
+  public:
+    std::string path;
+
+    virtual void SetUp() {
+        char name[] = "/tmp/lsfStoreJournalTestXXXXXX";
+        int fd = mkstemp(name);
+        ASSERT_NE(-1, fd);
+        close(fd);
+        path = name;
+    }
+
+    virtual void TearDown() {
+        unlink(path.c_str());
+        unlink((path + ".tmp").c_str());
+    }
+
+    size_t GetFileLength(void) {
+        struct stat st;
+        return (stat(path.c_str(), &st) == 0) ? st.st_size : 0;
+    }
+
+    void AppendRaw(const std::string& bytes) {
+        int fd = open(path.c_str(), O_WRONLY | O_APPEND);
+        ASSERT_NE(-1, fd);
+        ASSERT_EQ((ssize_t) bytes.length(), write(fd, bytes.data(), bytes.length()));
+        close(fd);
+    }
+
+    static std::string EncodeBatch(const std::string& id, const std::string& data, uint32_t checksum, uint64_t timestamp) {
+        std::string batch;
+        StoreJournal::EncodeRecord(batch, StoreJournal::RECORD_UPDATE, id, data);
+        StoreJournal::EncodeCommit(batch, checksum, timestamp);
+        return batch;
+    }
+};
+
+TEST_F(StoreJournalTest, Store_Journal_Replay_Committed_Batches) {
+    StoreJournal journal(path);
+    ASSERT_TRUE(journal.Reset(BASE_CHECKSUM, BASE_TIMESTAMP));
+    EXPECT_TRUE(journal.IsOpen());
+    EXPECT_TRUE(journal.IsEmpty());
+
+    std::string batch;
+    StoreJournal::EncodeRecord(batch, StoreJournal::RECORD_UPDATE, "preset1", "on 100");
+    StoreJournal::EncodeRecord(batch, StoreJournal::RECORD_DELETE, "preset2");
+    StoreJournal::EncodeCommit(batch, 0xCAFE, 2000);
+    ASSERT_TRUE(journal.Append(batch));
+    ASSERT_TRUE(journal.Append(EncodeBatch("preset3", "off", 0xBEEF, 3000)));
+    EXPECT_FALSE(journal.IsEmpty());
+    EXPECT_EQ(GetFileLength(), journal.GetLength());
+
+    StoreJournal replayed(path);
+    StoreJournalRecordList records;
+    ASSERT_TRUE(replayed.Replay(BASE_CHECKSUM, BASE_TIMESTAMP, records));
+    EXPECT_TRUE(replayed.IsOpen());
+    ASSERT_EQ((size_t) 5, records.size());
+
+    StoreJournalRecordList::const_iterator it = records.begin();
+    EXPECT_EQ(StoreJournal::RECORD_UPDATE, it->type);
+    EXPECT_EQ("preset1", it->id);
+    EXPECT_EQ("on 100", it->data);
+    ++it;
+    EXPECT_EQ(StoreJournal::RECORD_DELETE, it->type);
+    EXPECT_EQ("preset2", it->id);
+    EXPECT_TRUE(it->data.empty());
+    ++it;
+    EXPECT_EQ(StoreJournal::RECORD_COMMIT, it->type);
+    EXPECT_EQ((uint32_t) 0xCAFE, it->checksum);
+    EXPECT_EQ((uint64_t) 2000, it->timestamp);
+    ++it;
+    EXPECT_EQ("preset3", it->id);
+    ++it;
+    EXPECT_EQ(StoreJournal::RECORD_COMMIT, it->type);
+    EXPECT_EQ((uint32_t) 0xBEEF, it->checksum);
+    EXPECT_EQ((uint64_t) 3000, it->timestamp);
+}
+
+TEST_F(StoreJournalTest, Store_Journal_Replay_Drops_Uncommitted_Batch) {
+    StoreJournal journal(path);
+    ASSERT_TRUE(journal.Reset(BASE_CHECKSUM, BASE_TIMESTAMP));
+    ASSERT_TRUE(journal.Append(EncodeBatch("scene1", "data", 1, 2000)));
+    size_t committedLength = GetFileLength();
+
+    std::string uncommitted;
+    StoreJournal::EncodeRecord(uncommitted, StoreJournal::RECORD_UPDATE, "scene2", "data");
+    AppendRaw(uncommitted);
+
+    StoreJournal replayed(path);
+    StoreJournalRecordList records;
+    ASSERT_TRUE(replayed.Replay(BASE_CHECKSUM, BASE_TIMESTAMP, records));
+    ASSERT_EQ((size_t) 2, records.size());
+    EXPECT_EQ("scene1", records.front().id);
+    EXPECT_EQ(committedLength, GetFileLength());
+    EXPECT_EQ(committedLength, replayed.GetLength());
+}
+
+TEST_F(StoreJournalTest, Store_Journal_Replay_Truncates_Torn_Tail) {
+    StoreJournal journal(path);
+    ASSERT_TRUE(journal.Reset(BASE_CHECKSUM, BASE_TIMESTAMP));
+    ASSERT_TRUE(journal.Append(EncodeBatch("group1", "lamps", 1, 2000)));
+    size_t committedLength = GetFileLength();
+
+    std::string torn = EncodeBatch("group2", "more lamps", 2, 3000);
+    AppendRaw(torn.substr(0, torn.length() / 2));
+
+    StoreJournal replayed(path);
+    StoreJournalRecordList records;
+    ASSERT_TRUE(replayed.Replay(BASE_CHECKSUM, BASE_TIMESTAMP, records));
+    ASSERT_EQ((size_t) 2, records.size());
+    EXPECT_EQ("group1", records.front().id);
+    EXPECT_EQ(committedLength, GetFileLength());
+
+    /*
+     * The journal is appended to after the truncated tail
+     */
+    ASSERT_TRUE(replayed.Append(EncodeBatch("group3", "lamps", 3, 4000)));
+    StoreJournal again(path);
+    ASSERT_TRUE(again.Replay(BASE_CHECKSUM, BASE_TIMESTAMP, records));
+    ASSERT_EQ((size_t) 4, records.size());
+    EXPECT_EQ("group3", (++(++records.begin()))->id);
+}
+
+TEST_F(StoreJournalTest, Store_Journal_Replay_Stops_At_Corrupted_Record) {
+    StoreJournal journal(path);
+    ASSERT_TRUE(journal.Reset(BASE_CHECKSUM, BASE_TIMESTAMP));
+    ASSERT_TRUE(journal.Append(EncodeBatch("scene1", "data", 1, 2000)));
+    size_t committedLength = GetFileLength();
+    ASSERT_TRUE(journal.Append(EncodeBatch("scene2", "data", 2, 3000)));
+
+    /*
+     * Flip the last byte of the data of the second update
+     */
+    int fd = open(path.c_str(), O_RDWR);
+    ASSERT_NE(-1, fd);
+    off_t offset = committedLength + 8 + 5 + 6 + 3;
+    char byte;
+    ASSERT_EQ(1, pread(fd, &byte, 1, offset));
+    byte ^= 0xFF;
+    ASSERT_EQ(1, pwrite(fd, &byte, 1, offset));
+    close(fd);
+
+    StoreJournal replayed(path);
+    StoreJournalRecordList records;
+    ASSERT_TRUE(replayed.Replay(BASE_CHECKSUM, BASE_TIMESTAMP, records));
+    ASSERT_EQ((size_t) 2, records.size());
+    EXPECT_EQ("scene1", records.front().id);
+    EXPECT_EQ(committedLength, GetFileLength());
+}
+
+TEST_F(StoreJournalTest, Store_Journal_Replay_Base_Mismatch) {
+    StoreJournal journal(path);
+    ASSERT_TRUE(journal.Reset(BASE_CHECKSUM, BASE_TIMESTAMP));
+    ASSERT_TRUE(journal.Append(EncodeBatch("preset1", "data", 1, 2000)));
+    size_t length = GetFileLength();
+
+    StoreJournalRecordList records;
+    StoreJournal otherChecksum(path);
+    EXPECT_FALSE(otherChecksum.Replay(BASE_CHECKSUM + 1, BASE_TIMESTAMP, records));
+    EXPECT_FALSE(otherChecksum.IsOpen());
+    EXPECT_TRUE(records.empty());
+
+    StoreJournal otherTimestamp(path);
+    EXPECT_FALSE(otherTimestamp.Replay(BASE_CHECKSUM, BASE_TIMESTAMP + 1, records));
+    EXPECT_FALSE(otherTimestamp.IsOpen());
+    EXPECT_TRUE(records.empty());
+
+    /*
+     * A journal of another snapshot is left alone until it is reset
+     */
+    EXPECT_EQ(length, GetFileLength());
+    EXPECT_FALSE(otherTimestamp.Append(EncodeBatch("preset2", "data", 2, 3000)));
+}
+
+TEST_F(StoreJournalTest, Store_Journal_Replay_Malformed_Header) {
+    AppendRaw("LSFJ garbage that is not a journal header");
+
+    StoreJournal journal(path);
+    StoreJournalRecordList records;
+    EXPECT_FALSE(journal.Replay(BASE_CHECKSUM, BASE_TIMESTAMP, records));
+    EXPECT_FALSE(journal.IsOpen());
+}
+
+TEST_F(StoreJournalTest, Store_Journal_Disabled_Without_Path) {
+    StoreJournal journal("");
+    StoreJournalRecordList records;
+    EXPECT_FALSE(journal.Replay(BASE_CHECKSUM, BASE_TIMESTAMP, records));
+    EXPECT_FALSE(journal.Reset(BASE_CHECKSUM, BASE_TIMESTAMP));
+    EXPECT_FALSE(journal.Append(EncodeBatch("preset1", "data", 1, 2000)));
+}
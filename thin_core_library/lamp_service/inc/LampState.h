@@ -95,6 +95,27 @@ LampResponseCode LAMP_UnmarshalState(LampStateContainer* state, AJ_Message* msg)
  */
 LampResponseCode LAMP_MarshalState(LampState* state, AJ_Message* msg);
 
+/**
+ * Unmarshal a packed (ybuuuu) LampState from a message. The leading byte
+ * is a mask of LAMP_STATE_*_FIELD_INDICATOR bits naming the fields that
+ * carry valid values; the others are present on the wire but ignored.
+ *
+ * @param[out] state The lamp state container to read into
+ * @param[in]  msg   The message to read from
+ * @return Status of the operation
+ */
+LampResponseCode LAMP_UnmarshalPackedState(LampStateContainer* state, AJ_Message* msg);
+
+/**
+ * Serialize the Lamp's current state as a packed (ybuuuu) struct with
+ * every field marked valid
+ *
+ * @param state The state to marshal
+ * @param msg   The msg to serialize data into
+ * @return Status of the operation
+ */
+LampResponseCode LAMP_MarshalPackedState(LampState* state, AJ_Message* msg);
+
 /**
  * Initialize the LampState by reading it from NVRAM
  *
@@ -112,7 +112,7 @@ static const char* const LSF_Details_Interface[] = {
 };
 
 static const char LSF_State_Interface_Name[] = "org.allseen.LSF.LampState";
-static const uint32_t LSF_State_Interface_Version = 1;
+static const uint32_t LSF_State_Interface_Version = 2;
 static const char* const LSF_State_Interface[] = {
     LSF_State_Interface_Name,
     "@Version>u",
@@ -127,12 +127,31 @@ static const char* const LSF_State_Interface[] = {
     NULL
 };
 
+/*
+ * Companion to LampState that carries the state as a fixed-layout struct
+ * instead of a dictionary: a field mask (LAMP_STATE_*_FIELD_INDICATOR)
+ * followed by OnOff, Hue, Saturation, ColorTemp and Brightness. A
+ * controller that finds this interface on the lamp object uses it; older
+ * controllers keep talking to LampState.
+ */
+static const char LSF_PackedState_Interface_Name[] = "org.allseen.LSF.LampStatePacked";
+static const uint32_t LSF_PackedState_Interface_Version = 1;
+static const char* const LSF_PackedState_Interface[] = {
+    LSF_PackedState_Interface_Name,
+    "@Version>u",
+    "?TransitionLampState Timestamp<t NewState<(ybuuuu) TransitionPeriod<u LampResponseCode>u",
+    "?ApplyPulseEffect FromState<(ybuuuu) ToState<(ybuuuu) period<u duration<u numPulses<u timestamp<t LampResponseCode>u",
+    "?GetLampState LampState>(ybuuuu)",
+    NULL
+};
+
 static const AJ_InterfaceDescription LSF_Interfaces[] = {
     AJ_PropertiesIface,
     LSF_Interface,
     LSF_Parameters_Interface,
     LSF_Details_Interface,
     LSF_State_Interface,
+    LSF_PackedState_Interface,
     NULL
 };
 
@@ -156,6 +175,7 @@ uint32_t LAMP_GetServiceVersion(void)
 #define LSF_IFACE_PARAMS 2
 #define LSF_IFACE_DETAILS 3
 #define LSF_IFACE_STATE 4
+#define LSF_IFACE_PACKED_STATE 5
 
 #define APP_SET_PROP        AJ_APP_MESSAGE_ID(0, LSF_PROP_IFACE, AJ_PROP_SET)
 #define APP_GET_PROP        AJ_APP_MESSAGE_ID(0, LSF_PROP_IFACE, AJ_PROP_GET)
@@ -206,6 +226,12 @@ uint32_t LAMP_GetServiceVersion(void)
 #define LSF_PROP_STATE_TEMP     AJ_APP_PROPERTY_ID(0, LSF_IFACE_STATE, 7)
 #define LSF_PROP_STATE_BRIGHT   AJ_APP_PROPERTY_ID(0, LSF_IFACE_STATE, 8)
 
+// Run-time Lamp State, packed encoding
+#define LSF_PROP_PACKED_STATE_VERSION           AJ_APP_PROPERTY_ID(0, LSF_IFACE_PACKED_STATE, 0)
+#define LSF_METHOD_PACKED_STATE_SETSTATE        AJ_APP_MESSAGE_ID(0, LSF_IFACE_PACKED_STATE, 1)
+#define LSF_METHOD_PACKED_APPLY_PULSE           AJ_APP_MESSAGE_ID(0, LSF_IFACE_PACKED_STATE, 2)
+#define LSF_METHOD_PACKED_STATE_GETSTATE        AJ_APP_MESSAGE_ID(0, LSF_IFACE_PACKED_STATE, 3)
+
 static uint32_t MyBusAuthPwdCB(uint8_t* buf, uint32_t bufLen)
 {
     const char* myPwd = "000000";
@@ -646,7 +672,7 @@ static AJ_Status ClearLampFault(AJ_Message* msg)
     return AJ_OK;
 }
 
-static AJ_Status TransitionLampState(AJ_Message* msg)
+static AJ_Status TransitionLampState(AJ_Message* msg, uint8_t packed)
 {
     LampResponseCode responseCode = LAMP_OK;
     LampStateContainer newState;
@@ -657,7 +683,11 @@ static AJ_Status TransitionLampState(AJ_Message* msg)
     AJ_MarshalReplyMsg(msg, &reply);
 
     AJ_UnmarshalArgs(msg, "t", &timestamp);
-    LAMP_UnmarshalState(&newState, msg);
+    if (packed) {
+        LAMP_UnmarshalPackedState(&newState, msg);
+    } else {
+        LAMP_UnmarshalState(&newState, msg);
+    }
     AJ_UnmarshalArgs(msg, "u", &TransitionPeriod);
 
     // apply the new state
@@ -682,7 +712,7 @@ static AJ_Status TransitionLampState(AJ_Message* msg)
  * is specified as NULL, the Lamp Service sets the state to the current state of
  * the Lamp and passes it on the OEM layer.
  */
-static AJ_Status ApplyPulseEffect(AJ_Message* msg)
+static AJ_Status ApplyPulseEffect(AJ_Message* msg, uint8_t packed)
 {
     LampResponseCode responseCode = LAMP_OK;
     LampStateContainer FromState, ToState;
@@ -694,8 +724,13 @@ static AJ_Status ApplyPulseEffect(AJ_Message* msg)
     AJ_Message reply;
     AJ_MarshalReplyMsg(msg, &reply);
 
-    LAMP_UnmarshalState(&FromState, msg);
-    LAMP_UnmarshalState(&ToState, msg);
+    if (packed) {
+        LAMP_UnmarshalPackedState(&FromState, msg);
+        LAMP_UnmarshalPackedState(&ToState, msg);
+    } else {
+        LAMP_UnmarshalState(&FromState, msg);
+        LAMP_UnmarshalState(&ToState, msg);
+    }
     AJ_UnmarshalArgs(msg, "uuut", &period, &duration, &numPulses, &timestamp);
 
     // apply the new state
@@ -713,6 +748,23 @@ static AJ_Status ApplyPulseEffect(AJ_Message* msg)
     return AJ_OK;
 }
 
+/*
+ * The packed interface has no per-field properties; the whole state is
+ * returned in one fixed-layout struct.
+ */
+static AJ_Status GetPackedLampState(AJ_Message* msg)
+{
+    LampState state;
+    AJ_Message reply;
+
+    AJ_MarshalReplyMsg(msg, &reply);
+    LAMP_GetState(&state);
+    LAMP_MarshalPackedState(&state, &reply);
+    AJ_DeliverMsg(&reply);
+    AJ_CloseMsg(&reply);
+    return AJ_OK;
+}
+
 static AJ_Status MarshalStateField(AJ_Message* replyMsg, uint32_t propId)
 {
     LampState state;
@@ -947,6 +999,11 @@ static AJ_Status PropGetHandler(AJ_Message* replyMsg, uint32_t propId, void* con
     case LSF_PROP_STATE_BRIGHT:
         return MarshalStateField(replyMsg, propId);
 
+    // LampStatePacked properties
+    case LSF_PROP_PACKED_STATE_VERSION:
+        AJ_InfoPrintf(("LSF_PROP_PACKED_STATE_VERSION: %u\n", LSF_PackedState_Interface_Version));
+        return AJ_MarshalArgs(replyMsg, "u", LSF_PackedState_Interface_Version);
+
     default:
         return AJ_ERR_UNEXPECTED;
     }
@@ -992,6 +1049,8 @@ static AJ_Status GetAllProps(AJ_Message* msg)
         LampState state;
         LAMP_GetState(&state);
         LAMP_MarshalState(&state, &reply);
+    } else if (0 == strcmp(iface, LSF_PackedState_Interface_Name)) {
+        AJ_MarshalArgs(&reply, "{sv}", "Version", "u", LSF_PackedState_Interface_Version);
     }
 
     AJ_MarshalCloseContainer(&reply, &array1);
@@ -1024,11 +1083,23 @@ static AJSVC_ServiceStatus LAMP_HandleMessage(AJ_Message* msg, AJ_Status* status
         break;
 
     case LSF_METHOD_STATE_SETSTATE:
-        *status = TransitionLampState(msg);
+        *status = TransitionLampState(msg, FALSE);
         break;
 
     case LSF_METHOD_APPLY_PULSE:
-        *status = ApplyPulseEffect(msg);
+        *status = ApplyPulseEffect(msg, FALSE);
+        break;
+
+    case LSF_METHOD_PACKED_STATE_SETSTATE:
+        *status = TransitionLampState(msg, TRUE);
+        break;
+
+    case LSF_METHOD_PACKED_APPLY_PULSE:
+        *status = ApplyPulseEffect(msg, TRUE);
+        break;
+
+    case LSF_METHOD_PACKED_STATE_GETSTATE:
+        *status = GetPackedLampState(msg);
         break;
 
     default:
@@ -144,6 +144,47 @@ LampResponseCode LAMP_UnmarshalState(LampStateContainer* state, AJ_Message* msg)
     return responseCode;
 }
 
+LampResponseCode LAMP_MarshalPackedState(LampState* state, AJ_Message* msg)
+{
+    AJ_InfoPrintf(("%s\n", __func__));
+    AJ_Status status = AJ_MarshalArgs(msg, "(ybuuuu)", (uint8_t) LAMP_STATE_ALL_FIELDS_INDICATOR,
+                                      (state->onOff ? TRUE : FALSE), state->hue, state->saturation,
+                                      state->colorTemp, state->brightness);
+    if (status != AJ_OK) {
+        return LAMP_ERR_MESSAGE;
+    }
+
+    return LAMP_OK;
+}
+
+LampResponseCode LAMP_UnmarshalPackedState(LampStateContainer* state, AJ_Message* msg)
+{
+    uint8_t fields;
+    uint32_t onoff;
+
+    // initialize
+    memset(state, 0, sizeof(LampStateContainer));
+
+    AJ_Status status = AJ_UnmarshalArgs(msg, "(ybuuuu)", &fields, &onoff, &state->state.hue,
+                                        &state->state.saturation, &state->state.colorTemp,
+                                        &state->state.brightness);
+    if (status != AJ_OK) {
+        AJ_ErrPrintf(("AJ_UnmarshalArgs: %s\n", AJ_StatusText(status)));
+        memset(state, 0, sizeof(LampStateContainer));
+        return LAMP_ERR_MESSAGE;
+    }
+
+    if (fields & ~LAMP_STATE_ALL_FIELDS_INDICATOR) {
+        AJ_ErrPrintf(("Unknown field mask: 0x%x\n", fields));
+        state->stateFieldIndicators = 0;
+        return LAMP_ERR_MESSAGE;
+    }
+
+    state->state.onOff = onoff ? TRUE : FALSE;
+    state->stateFieldIndicators = fields;
+    return LAMP_OK;
+}
+
 #define LAMP_STATE_FD AJ_NVRAM_ID_FOR_APPS + 1
 
 void LAMP_InitializeState(void)